@@ -1,4 +1,5 @@
 graphicsUtils = require("graphicsUtils")
+drawBuffer = require("drawBuffer")
 
 function defaultFontXOffset(numChars, scale)  --works with default font only
     return numChars * 6 * scale;
@@ -14,6 +15,7 @@ diff = 0;
 running = false;
 reset = true;
 sumPaused = 0;
+draw = drawBuffer.new();
 
 function setup()
     print("Started stop watch")
@@ -40,24 +42,24 @@ function loop()
         end
     end
 
-    hal:getCanvas():fillScreen(0);
-    hal:getCanvas():setTextColor(graphicsUtils.rgb565(255, 255, 255));
+    draw:fill(0);
+    draw:textColor(graphicsUtils.rgb565(255, 255, 255));
 
-    hal:getCanvas():setTextSize(2);
+    draw:textSize(2);
     if (reset == true) then
-        hal:getCanvas():setCursor(220 - defaultFontXOffset(5, 2), 42);
-        hal:getCanvas():print("Start");
+        draw:textCursor(220 - defaultFontXOffset(5, 2), 42);
+        draw:print("Start");
     elseif (running == false) then
-        hal:getCanvas():setCursor(220 - defaultFontXOffset(8, 2), 42);
-        hal:getCanvas():print("Continue");
+        draw:textCursor(220 - defaultFontXOffset(8, 2), 42);
+        draw:print("Continue");
     end
 
     if (running == true) then
-        hal:getCanvas():setCursor(220 - defaultFontXOffset(4, 2), 182);
-        hal:getCanvas():print("Stop");
+        draw:textCursor(220 - defaultFontXOffset(4, 2), 182);
+        draw:print("Stop");
     elseif (reset == false) then
-        hal:getCanvas():setCursor(220 - defaultFontXOffset(5, 2), 182);
-        hal:getCanvas():print("Reset");
+        draw:textCursor(220 - defaultFontXOffset(5, 2), 182);
+        draw:print("Reset");
     end
 
     if (running == true) then
@@ -70,17 +72,18 @@ function loop()
     deltaHours = (total / 60 // 60) % 24;
     deltaDays = total / 60 / 60 // 24;
 
-    hal:getCanvas():setTextSize(4);
+    draw:textSize(4);
 
     if (deltaDays > 0) then
-        hal:getCanvas():setCursor(120 - defaultFontXOffset(deltaDays < 10 and 1 or 2, 4),
-                                    120 - defaultFontYOffset(1, 4) * 1.5);
-        hal:getCanvas():print(string.format("%dd", deltaDays));
+        draw:textCursor(120 - defaultFontXOffset(deltaDays < 10 and 1 or 2, 4),
+                        120 - defaultFontYOffset(1, 4) * 1.5);
+        draw:print(string.format("%dd", deltaDays));
     end
 
-    hal:getCanvas():setCursor(defaultFontXOffset(1, 4), 120 - defaultFontYOffset(1, 4) / 2);
-    hal:getCanvas():print(string.format("%02d:%02d:%02d", deltaHours, deltaMinutes, deltaSeconds))
+    draw:textCursor(defaultFontXOffset(1, 4), 120 - defaultFontYOffset(1, 4) / 2);
+    draw:print(string.format("%02d:%02d:%02d", deltaHours, deltaMinutes, deltaSeconds))
 
+    draw:submit()
     hal:flushCanvas()
 end
 
@@ -0,0 +1,64 @@
+-- Batched drawing: collect the draw calls of a frame and submit them with a single call into the firmware.
+-- The command table is reused between frames, so drawing does not produce any garbage.
+--
+--   local draw = drawBuffer.new()
+--   draw:fill(0); draw:textCursor(10, 20); draw:print("Hello")
+--   draw:submit(); hal:flushCanvas()
+local drawBuffer = {}
+drawBuffer.__index = drawBuffer
+
+function drawBuffer.new()
+    return setmetatable({ commands = {}, count = 0 }, drawBuffer)
+end
+
+local function push2(self, a, b)
+    local c, n = self.commands, self.count
+    c[n + 1] = a; c[n + 2] = b
+    self.count = n + 2
+end
+
+local function push3(self, a, b, d)
+    local c, n = self.commands, self.count
+    c[n + 1] = a; c[n + 2] = b; c[n + 3] = d
+    self.count = n + 3
+end
+
+local function push4(self, a, b, d, e)
+    local c, n = self.commands, self.count
+    c[n + 1] = a; c[n + 2] = b; c[n + 3] = d; c[n + 4] = e
+    self.count = n + 4
+end
+
+local function push5(self, a, b, d, e, f)
+    local c, n = self.commands, self.count
+    c[n + 1] = a; c[n + 2] = b; c[n + 3] = d; c[n + 4] = e; c[n + 5] = f
+    self.count = n + 5
+end
+
+local function push6(self, a, b, d, e, f, g)
+    local c, n = self.commands, self.count
+    c[n + 1] = a; c[n + 2] = b; c[n + 3] = d; c[n + 4] = e; c[n + 5] = f; c[n + 6] = g
+    self.count = n + 6
+end
+
+function drawBuffer:fill(color) push2(self, osw.DRAWCMD_FILL, color) end
+function drawBuffer:pixel(x, y, color) push4(self, osw.DRAWCMD_PIXEL, x, y, color) end
+function drawBuffer:line(x1, y1, x2, y2, color) push6(self, osw.DRAWCMD_LINE, x1, y1, x2, y2, color) end
+function drawBuffer:hline(x, y, w, color) push5(self, osw.DRAWCMD_HLINE, x, y, w, color) end
+function drawBuffer:vline(x, y, h, color) push5(self, osw.DRAWCMD_VLINE, x, y, h, color) end
+function drawBuffer:frame(x, y, w, h, color) push6(self, osw.DRAWCMD_FRAME, x, y, w, h, color) end
+function drawBuffer:fillFrame(x, y, w, h, color) push6(self, osw.DRAWCMD_FILL_FRAME, x, y, w, h, color) end
+function drawBuffer:circle(x, y, r, color) push5(self, osw.DRAWCMD_CIRCLE, x, y, r, color) end
+function drawBuffer:fillCircle(x, y, r, color) push5(self, osw.DRAWCMD_FILL_CIRCLE, x, y, r, color) end
+function drawBuffer:textColor(color, background) push3(self, osw.DRAWCMD_TEXT_COLOR, color, background or color) end
+function drawBuffer:textSize(size) push2(self, osw.DRAWCMD_TEXT_SIZE, size) end
+function drawBuffer:textCursor(x, y) push3(self, osw.DRAWCMD_TEXT_CURSOR, x, y) end
+function drawBuffer:print(text) push2(self, osw.DRAWCMD_PRINT, tostring(text)) end
+
+-- Draws all collected commands and starts a new (empty) frame
+function drawBuffer:submit()
+    osw.submitDrawCommands(self.commands, self.count)
+    self.count = 0
+end
+
+return drawBuffer
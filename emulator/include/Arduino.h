@@ -2,6 +2,7 @@
 #include "Defines.h"
 
 unsigned long millis();
+unsigned long micros();
 long random(int howbig);
 long random(int howsmall, int howbig);
 void delay(long millis);
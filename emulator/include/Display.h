@@ -1,6 +1,8 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <SDL2/SDL.h>
 
@@ -28,6 +30,12 @@ class FakeDisplay : public Arduino_G {
     void draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t* bitmap, int16_t w, int16_t h) override;
     void draw24bitRGBBitmap(int16_t x, int16_t y, uint8_t* bitmap, int16_t w, int16_t h) override;
 
+    /**
+     * Uploads the pixels drawn since the last call into the texture. Drawing only touches a shadow framebuffer (so
+     * it is also possible from other threads, like the real display bus), but SDL must be used on the main thread.
+     */
+    void present();
+
     SDL_Texture* getTexture() const {
         return this->mainTexture;
     };
@@ -38,6 +46,11 @@ class FakeDisplay : public Arduino_G {
     SDL_Renderer* mainRenderer;
     SDL_Texture* mainTexture = nullptr;
     bool mIsEnabled = false;
+    std::mutex framebufferLock;
+    std::vector<Uint32> framebuffer; // RGBA8888, like the texture
+    bool framebufferDirty = false;
+
+    static Uint32 toRGBA8888(uint16_t color);
 };
 
 extern std::unique_ptr<FakeDisplay> fakeDisplayInstance;
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <variant>
 #include <list>
 #include <map>
+#include <memory>
 #include <hal/buttons.h>
 #include <osw_pins.h> // for button definitions
 
@@ -16,6 +17,8 @@
 void setup();
 void loop();
 
+class SensorReplay;
+
 class OswEmulator {
   public:
     class EmulatorSleep {
@@ -48,6 +51,11 @@ class OswEmulator {
 
     void run();
     void exit();
+    /**
+     * Replays the sensor trace into the virtual device, with a deterministic clock - in headless mode the emulator
+     * exits at the end of the trace
+     */
+    bool startReplay(const std::string& path, bool realTime);
 
     void setButton(Button id, bool state);
     bool getButton(Button id);
@@ -58,8 +66,10 @@ class OswEmulator {
     void reboot();
     bool fromDeepSleep();
     BootReason getBootReason();
+    unsigned getBootCount(); // How often the OS was set up, light sleeps do not count
     void requestSleep(RequestSleepState state);
     CPUState getCpuState();
+    long getLastWakeLatency(); // Milliseconds from the last wakeup until its first frame reached the display (-1 while pending)
 
     // Following functions are only used by the emulator / OS main loop itself
     void scheduleWakeupAfterSleep(unsigned long microseconds);
@@ -72,6 +82,7 @@ class OswEmulator {
     std::atomic_bool running = true;
     std::array<std::atomic_bool, BTN_NUMBER> buttons;
     std::array<bool, BTN_NUMBER> buttonCheckboxes; // These are just state caches of the buttons for their respective checkboxes!
+    const std::array<SDL_Keycode, BTN_NUMBER> buttonKeys = {SDLK_RETURN, SDLK_UP, SDLK_DOWN}; // Keyboard shortcuts, in the order of the Button ids
     bool buttonResetAfterMultiPress = true;
     uint8_t batRaw = 0;
     bool charging = true;
@@ -85,6 +96,7 @@ class OswEmulator {
     unsigned long selfWakeUpInMicroseconds = 0;
     time_t selfWakeUpAtTimestamp = 0;
     BootReason bootReason = BootReason::undefined;
+    unsigned bootCount = 0;
 
     // ImGui and window style / sizes
     const float guiPadding = 10;
@@ -92,9 +104,17 @@ class OswEmulator {
 
     // Timings
     std::array<float, 128> timesLoop{0.0f};
+    std::array<float, 32> timesWakeLatency{0.0f};
+    unsigned long wakeStartedAt = 0;
+    unsigned int wakeUiFlush = 0;
+    long lastWakeLatency = -1;
+    bool wakeFromLightSleep = false;
+    bool wakeLatencyPending = false;
     std::array<float, 129> frameCountsEmulator{0.0f}; // One more frame count to not count current value
     std::array<float, 129> frameCountsOsw{0.0f};
     time_t frameCountsLastUpdate = 0;
+    unsigned long memoryLastSample = 0;
+    std::unique_ptr<SensorReplay> replay;
 
     std::string configPath;
     std::string imguiPath;
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <ctime>
+
+/**
+ * Replaces the wall clock of millis(), micros() and the virtual RTC by one which only advances when told to - so a
+ * replayed sensor trace produces exactly the same timestamps on every run, no matter how fast the host is.
+ */
+namespace FakeClock {
+/**
+ * Starts the clock at 0, with the RTC at utc
+ */
+void enable(time_t utc);
+void disable();
+bool isEnabled();
+void advance(unsigned long microseconds);
+unsigned long long getMicros();
+time_t getUTCTime();
+/**
+ * The RTC was at utc, when the clock was at atMicros
+ */
+void setUTCTime(time_t utc, unsigned long long atMicros);
+};
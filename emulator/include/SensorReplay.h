@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+#include <OswSensorTrace.h>
+#include <devices/virtual.h>
+#include <hal/buttons.h>
+
+/**
+ * Plays a sensor trace into the virtual device, while driving the FakeClock: every step() advances the clock by
+ * the same amount of trace time, so the OS sees exactly the same timestamps and values on every run. In real time
+ * mode step() waits for the wall clock to catch up, otherwise it returns immediately (for benchmarks and tests).
+ */
+class SensorReplay {
+  public:
+    SensorReplay(const std::string& path, bool realTime, unsigned long stepMs = 10);
+    ~SensorReplay();
+    SensorReplay(const SensorReplay&) = delete;
+    SensorReplay& operator=(const SensorReplay&) = delete;
+
+    bool isOpen() const {
+        return this->opened;
+    };
+    /**
+     * All samples of the trace were applied
+     */
+    bool isFinished() const {
+        return !this->hasPending;
+    };
+
+    /**
+     * Advances the clock by one step and applies all samples up to the new time
+     *
+     * @param onButton Called for every button sample
+     */
+    void step(OswDevices::Virtual::VirtualValues& values, const std::function<void(Button, bool)>& onButton);
+    uint32_t getTraceTime() const {
+        return this->traceTime;
+    };
+    uint32_t getAppliedSamples() const {
+        return this->applied;
+    };
+    /**
+     * Samples for which the emulator has no sensor (e.g. GPS fixes)
+     */
+    uint32_t getIgnoredSamples() const {
+        return this->ignored;
+    };
+    void logStats();
+
+  private:
+    const bool realTime;
+    const unsigned long stepMs;
+    bool opened = false;
+    OswSensorTraceReader reader;
+    OswSensorTrace::Sample pending;
+    bool hasPending = false;
+    uint32_t traceTime = 0;
+    uint32_t steps = 0;
+    uint32_t applied = 0;
+    uint32_t ignored = 0;
+    std::chrono::steady_clock::time_point startedAt;
+
+    void apply(const OswSensorTrace::Sample& sample, OswDevices::Virtual::VirtualValues& values, const std::function<void(Button, bool)>& onButton);
+};
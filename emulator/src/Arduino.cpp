@@ -1,5 +1,7 @@
 #include "Arduino.h"
+#include "FakeClock.h"
 
+#include <atomic>
 #include <thread>
 #include <chrono>
 #include <stdint.h>
@@ -8,11 +10,57 @@
 
 std::mt19937_64 gen(std::random_device{}());
 
+static std::atomic_bool fakeClockEnabled = false;
+static std::atomic<unsigned long long> fakeClockMicros = 0;
+static std::atomic<time_t> fakeClockUtc = 0; // At fakeClockUtcMicros
+static std::atomic<unsigned long long> fakeClockUtcMicros = 0;
+
+void FakeClock::enable(time_t utc) {
+    // Always the same start, so the timestamps are the same on every run
+    fakeClockMicros = 0;
+    FakeClock::setUTCTime(utc, 0);
+    fakeClockEnabled = true;
+}
+
+void FakeClock::setUTCTime(time_t utc, unsigned long long atMicros) {
+    fakeClockUtc = utc;
+    fakeClockUtcMicros = atMicros;
+}
+
+void FakeClock::disable() {
+    fakeClockEnabled = false;
+}
+
+bool FakeClock::isEnabled() {
+    return fakeClockEnabled;
+}
+
+void FakeClock::advance(unsigned long microseconds) {
+    fakeClockMicros += microseconds;
+}
+
+unsigned long long FakeClock::getMicros() {
+    return fakeClockMicros;
+}
+
+time_t FakeClock::getUTCTime() {
+    return fakeClockUtc + (time_t) (((long long) fakeClockMicros - (long long) fakeClockUtcMicros) / 1000000);
+}
+
 unsigned long millis() {
+    if(fakeClockEnabled)
+        return fakeClockMicros / 1000;
     auto duration = std::chrono::system_clock::now().time_since_epoch();
     return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
 }
 
+unsigned long micros() {
+    if(fakeClockEnabled)
+        return fakeClockMicros;
+    auto duration = std::chrono::system_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
 long random(int howbig) {
     uint32_t x = gen();
     uint64_t m = uint64_t(x) * uint64_t(howbig);
@@ -1,13 +1,16 @@
 #include "../include/CPU.h"
+#include <atomic>
 #include <OswLogger.h>
 
-void setCpuFrequencyMhz(unsigned int) {
-    // I mean... How? And why?!
-    OSW_EMULATOR_THIS_IS_NOT_IMPLEMENTED;
+// There is no clock to change here, but remembering the request allows to test everyone deciding about it
+static std::atomic<unsigned int> cpuFrequencyMhz = 240;
+
+void setCpuFrequencyMhz(unsigned int mhz) {
+    if(mhz != cpuFrequencyMhz)
+        OSW_LOG_D("CPU frequency requested: ", mhz, " MHz");
+    cpuFrequencyMhz = mhz;
 }
 
 unsigned int getCpuFrequencyMhz() {
-    // I mean... How? And why?!
-    OSW_EMULATOR_THIS_IS_NOT_IMPLEMENTED;
-    return 0;
-}
\ No newline at end of file
+    return cpuFrequencyMhz;
+}
@@ -4,8 +4,9 @@
 
 std::unique_ptr<FakeDisplay> fakeDisplayInstance;
 
-FakeDisplay::FakeDisplay(int width, int height, SDL_Renderer* renderer) : Arduino_G(width, height), width(width), height(height), mainRenderer(renderer) {
-    this->mainTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+FakeDisplay::FakeDisplay(int width, int height, SDL_Renderer* renderer) : Arduino_G(width, height), width(width), height(height), mainRenderer(renderer),
+    framebuffer(width * height, SDL_ALPHA_OPAQUE) {
+    this->mainTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, width, height);
     assert(this->mainTexture != nullptr && "Failed to create texture for fake display");
 }
 
@@ -33,20 +34,41 @@ void FakeDisplay::draw24bitRGBBitmap(int16_t x, int16_t y, uint8_t* bitmap, int1
     OSW_EMULATOR_THIS_IS_NOT_IMPLEMENTED;
 }
 
-void FakeDisplay::drawPixel(int32_t x, int32_t y, uint16_t color) {
+Uint32 FakeDisplay::toRGBA8888(uint16_t color) {
     // color is in rgb565 (r=5 bit, g=6 bit, b=5 bit)
     const Uint8 r =  ((color >> 8) & 0b11111000);
     const Uint8 g = ((color >> 3) & 0b11111100);
     const Uint8 b = ((color << 3));
-    SDL_SetRenderDrawColor(this->mainRenderer, r, g, b, SDL_ALPHA_OPAQUE);
-    SDL_RenderDrawPoint(this->mainRenderer, x, y);
+    return (r << 24) | (g << 16) | (b << 8) | SDL_ALPHA_OPAQUE;
+}
+
+void FakeDisplay::drawPixel(int32_t x, int32_t y, uint16_t color) {
+    if(x < 0 or y < 0 or x >= this->width or y >= this->height)
+        return;
+    std::lock_guard<std::mutex> guard(this->framebufferLock);
+    this->framebuffer[y * this->width + x] = toRGBA8888(color);
+    this->framebufferDirty = true;
 }
 
 void FakeDisplay::draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t* bitmap, int16_t w, int16_t h) {
-    // On a real CPU we can just iterate over the givenbitmap and render every pixel by itself
-    for(int16_t currW = 0; currW < w; ++currW)
-        for(int16_t currH = 0; currH < h; ++currH)
-            this->drawPixel(x + currW, y + currH, bitmap[currH * w + currW]);
+    std::lock_guard<std::mutex> guard(this->framebufferLock);
+    for(int16_t currH = 0; currH < h; ++currH) {
+        if(y + currH < 0 or y + currH >= this->height)
+            continue;
+        for(int16_t currW = 0; currW < w; ++currW)
+            if(x + currW >= 0 and x + currW < this->width)
+                this->framebuffer[(y + currH) * this->width + x + currW] = toRGBA8888(bitmap[currH * w + currW]);
+    }
+    this->framebufferDirty = true;
+}
+
+void FakeDisplay::present() {
+    std::lock_guard<std::mutex> guard(this->framebufferLock);
+    if(!this->framebufferDirty)
+        return;
+    int res = SDL_UpdateTexture(this->mainTexture, nullptr, this->framebuffer.data(), this->width * sizeof(Uint32));
+    assert(res >= 0 && "Failed to upload the fake display framebuffer");
+    this->framebufferDirty = false;
 }
 
 void FakeDisplay::displayOn() {
@@ -11,11 +11,13 @@
 
 #include "../include/Display.h"
 #include "../include/Emulator.hpp"
+#include "../include/SensorReplay.h"
 
 #include "globals.h"
 #include "osw_ui.h"
 #include "osw_config.h"
 #include "osw_config_keys.h"
+#include "OswMemoryTracker.h"
 #include "services/OswServiceManager.h"
 
 OswEmulator* OswEmulator::instance = nullptr;
@@ -146,6 +148,24 @@ void OswEmulator::run() {
                 this->running = false;
                 break;
             }
+            if((event.type == SDL_KEYDOWN or event.type == SDL_KEYUP) and !event.key.repeat and !this->isHeadless and !ImGui::GetIO().WantCaptureKeyboard)
+                for(size_t buttonId = 0; buttonId < this->buttonKeys.size(); ++buttonId)
+                    if(event.key.keysym.sym == this->buttonKeys.at(buttonId))
+                        this->setButton((Button) buttonId, event.type == SDL_KEYDOWN);
+        }
+
+        // Feed the next step of the sensor trace (this also advances the clock)
+        if(this->replay) {
+            static OswDevices::Virtual::VirtualValues unused; // While there is no virtual device (yet)
+            OswHal* hal = OswHal::getInstance();
+            const bool hasDevice = this->cpustate == CPUState::active and hal->devices() and hal->devices()->virtualDevice;
+            const bool wasFinished = this->replay->isFinished();
+            this->replay->step(hasDevice ? hal->devices()->virtualDevice->values : unused, [this](Button id, bool down) {
+                this->buttonCheckboxes.at(id) = down;
+                this->setButton(id, down);
+            });
+            if(!wasFinished and this->replay->isFinished() and this->isHeadless)
+                this->running = false;
         }
 
         // Prepare ImGUI for the next frame
@@ -166,10 +186,20 @@ void OswEmulator::run() {
                 this->bootReason = BootReason::byTimer;
             else
                 this->bootReason = BootReason::undefined; // Should never happen...
+            const bool fromLightSleep = this->cpustate == CPUState::light;
             this->cpustate = CPUState::active;
             this->manualWakeUp = false;
             this->selfWakeUpAtTimestamp = 0;
-            setup();
+            this->wakeStartedAt = millis();
+            this->wakeFromLightSleep = fromLightSleep;
+            if(!fromLightSleep) {
+                ++this->bootCount;
+                setup();
+            }
+            // Otherwise the OS just continues its loop(), which resumes from the light sleep (like the real hardware)
+            this->wakeLatencyPending = true;
+            this->lastWakeLatency = -1;
+            this->wakeUiFlush = OswUI::getInstance()->getLastFlush();
 
             /**
              * At the first startup - prepare the key value cache dynamically
@@ -223,9 +253,6 @@ void OswEmulator::run() {
 
         // Next OS step
         if(this->cpustate == CPUState::active) {
-            // Let the renderer now draw to the FakeDisplays surface
-            int res = SDL_SetRenderTarget(this->mainRenderer, fakeDisplayInstance->getTexture());
-            assert(res >= 0 && "Failed to set render target to fake display texture");
             try {
                 // Run the next OS iteration
                 std::chrono::time_point start = std::chrono::system_clock::now();
@@ -234,6 +261,16 @@ void OswEmulator::run() {
                 for(size_t keyId = 1; keyId < this->timesLoop.size(); ++keyId)
                     this->timesLoop.at(this->timesLoop.size() - keyId) = this->timesLoop.at(this->timesLoop.size() - keyId - 1);
                 this->timesLoop.front() = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+                // Measure the time from the wakeup until the first frame reached the display
+                const unsigned int uiFlush = OswUI::getInstance()->getLastFlush();
+                if(this->wakeLatencyPending and uiFlush != this->wakeUiFlush and OswUI::getLastFlushDone() >= uiFlush) {
+                    this->wakeLatencyPending = false;
+                    this->lastWakeLatency = OswUI::getLastFlushDone() - this->wakeStartedAt;
+                    for(size_t i = 1; i < this->timesWakeLatency.size(); ++i)
+                        this->timesWakeLatency.at(this->timesWakeLatency.size() - i) = this->timesWakeLatency.at(this->timesWakeLatency.size() - i - 1);
+                    this->timesWakeLatency.front() = this->lastWakeLatency;
+                    OSW_LOG_I("Wake-to-first-frame latency (", this->wakeFromLightSleep ? "light" : "deep", " sleep): ", this->lastWakeLatency, " ms");
+                }
                 // Track the amount of flushing loops per second
                 if(this->lastUiFlush != OswUI::getInstance()->getLastFlush()) {
                     this->lastUiFlush = OswUI::getInstance()->getLastFlush();
@@ -255,11 +292,11 @@ void OswEmulator::run() {
             } catch(EmulatorSleep& e) {
                 // Ignore it :P
             }
-            // And restore emulator surface render target
-            res = SDL_SetRenderTarget(this->mainRenderer, nullptr); // nullptr = back to window surface
-            assert(res >= 0 && "Failed to set render target to window surface");
         }
 
+        // Show whatever reached the display until now (the display bus may still be sending the rest of the frame)
+        fakeDisplayInstance->present();
+
         // Present the fake-display texture as an ImGUI window
         if(!this->isHeadless) {
             ImGui::Begin(LANG_IMGUI_DISPLAY "###display");
@@ -367,7 +404,8 @@ void OswEmulator::requestSleep(RequestSleepState state) {
 
 void OswEmulator::setButton(Button id, bool state) {
     this->buttonCheckboxes.at(id) = state;
-    this->buttons.at(id) = state;
+    if(this->buttons.at(id).exchange(state) != state)
+        OswButtonQueue::getInstance().push(id, state, millis()); // Like the GPIO interrupt of the real hardware
 };
 
 bool OswEmulator::getButton(Button id) {
@@ -386,6 +424,10 @@ bool OswEmulator::fromDeepSleep() {
     return this->cpustate == CPUState::deep;
 }
 
+unsigned OswEmulator::getBootCount() {
+    return this->bootCount;
+}
+
 OswEmulator::BootReason OswEmulator::getBootReason() {
     return this->bootReason;
 }
@@ -409,6 +451,8 @@ void OswEmulator::renderGUIFrameEmulator() {
     ImGui::PlotLines("FPS Emulator", (float*) this->frameCountsEmulator.data() + 1, this->frameCountsEmulator.size() - 1);
     ImGui::PlotLines("FPS OSW-UI", (float*) this->frameCountsOsw.data() + 1, this->frameCountsOsw.size() - 1);
     ImGui::PlotLines("loop()", (float*) this->timesLoop.data(), this->timesLoop.size());
+    ImGui::PlotLines("Wake -> frame", (float*) this->timesWakeLatency.data(), this->timesWakeLatency.size());
+    ImGui::Text("Last wake -> frame: %ld ms", this->lastWakeLatency);
     ImGui::Separator();
     ImGui::Checkbox(LANG_EMULATOR_WAKELOCK, &this->autoWakeUp);
     this->addGUIHelp(LANG_EMULATOR_WAKELOCK_HELP);
@@ -443,6 +487,7 @@ void OswEmulator::renderGUIFrameEmulator() {
     }
     ImGui::Checkbox(LANG_EMULATOR_MBTN, &this->buttonResetAfterMultiPress);
     this->addGUIHelp(LANG_EMULATOR_MBTN_HELP);
+    ImGui::TextDisabled(LANG_EMULATOR_BTN_KEYS);
     ImGui::End();
 
     // Virtual Sensors
@@ -484,6 +529,46 @@ void OswEmulator::renderGUIFrameEmulator() {
         ImGui::Text(LANG_IMGUI_VIRTUAL_SENSORS_NOPE);
     ImGui::End();
 
+    // Memory (there is no memory monitor in the emulator, so the history is sampled here)
+    OswMemoryTracker& memory = OswMemoryTracker::getInstance();
+    if(millis() - this->memoryLastSample >= 1000) {
+        this->memoryLastSample = millis();
+        memory.sampleHeap();
+    }
+    ImGui::Begin(LANG_IMGUI_MEMORY "###memory");
+    if(ImGui::BeginTable("##memory_tags", 5)) {
+        ImGui::TableSetupColumn("Tag");
+        ImGui::TableSetupColumn("Current");
+        ImGui::TableSetupColumn("Peak");
+        ImGui::TableSetupColumn("Allocs");
+        ImGui::TableSetupColumn("Frees");
+        ImGui::TableHeadersRow();
+        for(size_t i = 0; i < (size_t) OswMemoryTag::COUNT; ++i) {
+            const OswMemoryTracker::TagStats stats = memory.getStats((OswMemoryTag) i);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", OswMemoryTracker::getTagName((OswMemoryTag) i));
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu B", stats.current);
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu B", stats.peak);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", stats.allocations);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", stats.frees);
+        }
+        ImGui::EndTable();
+    }
+    std::array<OswMemoryTracker::HeapSample, OswMemoryTracker::historyLength> samples;
+    std::array<float, OswMemoryTracker::historyLength> tracked{0.0f};
+    const size_t sampleCount = memory.getHistory(samples.data(), samples.size());
+    for(size_t i = 0; i < sampleCount; ++i)
+        tracked.at(i) = samples.at(i).tracked / 1024.0f;
+    ImGui::PlotLines("Tracked (KiB)", tracked.data(), sampleCount);
+    if(ImGui::Button("Reset peaks"))
+        memory.resetPeaks();
+    ImGui::End();
+
     ImGui::Begin(LANG_IMGUI_CONFIGURATION "###configuration");
     if(this->configValuesCache.size()) {
         for(auto& [label, keyIds] : this->configSectionsToIdCache) {
@@ -588,6 +673,19 @@ void OswEmulator::renderGUIFrameEmulator() {
     ImGui::End();
 }
 
+bool OswEmulator::startReplay(const std::string& path, bool realTime) {
+    this->replay = std::make_unique<SensorReplay>(path, realTime);
+    if(!this->replay->isOpen()) {
+        this->replay.reset();
+        return false;
+    }
+    return true;
+}
+
 OswEmulator::CPUState OswEmulator::getCpuState() {
     return this->cpustate;
 }
+
+long OswEmulator::getLastWakeLatency() {
+    return this->lastWakeLatency;
+}
@@ -0,0 +1,50 @@
+#include <new>
+
+#include <OswMemoryTracker.h>
+
+// Every allocation of the emulator goes through the tracker, so the allocations inside of an OswMemoryScope (containers,
+// Strings, objects, ...) are accounted to its tag and everything else to OTHER. On the device only the explicitly
+// tagged allocators are tracked, as replacing the operators there would cost a header on every allocation.
+
+void* operator new(std::size_t size) {
+    void* block = OswMemoryTracker::allocate(size, OswMemoryTracker::getCurrentTag());
+    if(block == nullptr)
+        throw std::bad_alloc();
+    return block;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return OswMemoryTracker::allocate(size, OswMemoryTracker::getCurrentTag());
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return OswMemoryTracker::allocate(size, OswMemoryTracker::getCurrentTag());
+}
+
+void operator delete(void* block) noexcept {
+    OswMemoryTracker::release(block);
+}
+
+void operator delete[](void* block) noexcept {
+    OswMemoryTracker::release(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    OswMemoryTracker::release(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept {
+    OswMemoryTracker::release(block);
+}
+
+void operator delete(void* block, const std::nothrow_t&) noexcept {
+    OswMemoryTracker::release(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept {
+    OswMemoryTracker::release(block);
+}
@@ -0,0 +1,99 @@
+#include <thread>
+
+#include <OswLogger.h>
+#include <osw_pins.h>
+
+#include "../include/FakeClock.h"
+#include "../include/SensorReplay.h"
+
+static constexpr time_t defaultReplayUtc = 1700000000; // Used if the trace starts without its own time
+
+SensorReplay::SensorReplay(const std::string& path, bool realTime, unsigned long stepMs) : realTime(realTime), stepMs(stepMs > 0 ? stepMs : 1) {
+    this->opened = this->reader.open(path.c_str());
+    if(!this->opened) {
+        OSW_LOG_E("Failed to open the sensor trace ", path);
+        return;
+    }
+    this->hasPending = this->reader.next(this->pending);
+    // A fixed start (and no wall clock) makes the replay deterministic
+    FakeClock::enable(this->hasPending and this->pending.kind == OswSensorTrace::Kind::UTC ? (time_t) this->pending.values[0] : defaultReplayUtc);
+    this->startedAt = std::chrono::steady_clock::now();
+    OSW_LOG_I("Replaying the sensor trace ", path, this->realTime ? " in real time" : " as fast as possible");
+}
+
+SensorReplay::~SensorReplay() {
+    if(this->opened)
+        FakeClock::disable();
+}
+
+void SensorReplay::step(OswDevices::Virtual::VirtualValues& values, const std::function<void(Button, bool)>& onButton) {
+    if(!this->opened)
+        return;
+    this->traceTime += this->stepMs;
+    ++this->steps;
+    FakeClock::advance(this->stepMs * 1000);
+    while(this->hasPending and this->pending.time <= this->traceTime) {
+        this->apply(this->pending, values, onButton);
+        this->hasPending = this->reader.next(this->pending);
+        if(!this->hasPending)
+            this->logStats();
+    }
+
+    if(this->realTime) {
+        const std::chrono::steady_clock::time_point due = this->startedAt + std::chrono::milliseconds(this->traceTime);
+        std::this_thread::sleep_until(due);
+    }
+}
+
+void SensorReplay::apply(const OswSensorTrace::Sample& sample, OswDevices::Virtual::VirtualValues& values, const std::function<void(Button, bool)>& onButton) {
+    ++this->applied;
+    switch(sample.kind) {
+    case OswSensorTrace::Kind::UTC:
+        FakeClock::setUTCTime((time_t) sample.values[0], (unsigned long long) sample.time * 1000); // The clock started with the trace
+        break;
+    case OswSensorTrace::Kind::ACCELERATION:
+        values.accelerationX = sample.values[0];
+        values.accelerationY = sample.values[1];
+        values.accelerationZ = sample.values[2];
+        break;
+    case OswSensorTrace::Kind::STEPS:
+        values.steps = (uint32_t) sample.values[0];
+        break;
+    case OswSensorTrace::Kind::ACTIVITY:
+        values.activityMode = (OswAccelerationProvider::ActivityMode) sample.values[0];
+        break;
+    case OswSensorTrace::Kind::PRESSURE:
+        values.pressure = sample.values[0];
+        break;
+    case OswSensorTrace::Kind::TEMPERATURE:
+        values.temperature = sample.values[0];
+        break;
+    case OswSensorTrace::Kind::HUMIDITY:
+        values.humidity = sample.values[0];
+        break;
+    case OswSensorTrace::Kind::MAGNETOMETER:
+        values.magnetometerX = (int) sample.values[0];
+        values.magnetometerY = (int) sample.values[1];
+        values.magnetometerZ = (int) sample.values[2];
+        values.magnetometerAzimuth = (int) sample.values[3];
+        break;
+    case OswSensorTrace::Kind::BUTTON:
+        if(sample.values[0] >= 0 and sample.values[0] < BTN_NUMBER) {
+            onButton((Button) sample.values[0], sample.values[1] != 0);
+            break;
+        }
+        [[fallthrough]];
+    default:
+        // There is no GPS in the emulator
+        --this->applied;
+        ++this->ignored;
+        break;
+    }
+}
+
+void SensorReplay::logStats() {
+    const long long wallMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - this->startedAt).count();
+    OSW_LOG_I("Sensor trace replayed: ", this->applied, " samples (", this->ignored, " ignored, ", this->reader.getSkippedLines(),
+              " malformed lines) over ", this->traceTime, " ms in ", this->steps, " steps, took ", wallMs, " ms (",
+              wallMs > 0 ? (float) this->traceTime / wallMs : 0.0f, "x real time)");
+}
@@ -27,11 +27,15 @@ int main(int argc, char** argv) {
     const std::string argUiTests = "ui_tests";
     const std::string argHeadless = "headless";
     const std::string argSoftwareRenderer = "software_renderer";
+    const std::string argReplay = "replay";
+    const std::string argReplayFast = "replay_fast";
     a.add(argRunUnitTests, '\0', "run the unit test framework");
     a.add(argListAllTests, '\0', "list all unit and UI tests, one per line");
     a.add(argUiTests, '\0', "run emulator with UI tests window");
     a.add(argHeadless, '\0', "do not open a window; also implies --software_renderer"); // Warning: This parameter name is also used in the unit-tests!
     a.add(argSoftwareRenderer, '\0', "use software-rendering only");
+    a.add<std::string>(argReplay, '\0', "replay a sensor trace (see OswSensorTrace.h) into the virtual device, with a deterministic clock; exits at its end if headless", false, "");
+    a.add(argReplayFast, '\0', "replay the sensor trace as fast as possible, instead of in real time");
     a.parse_check(argc, argv);
 
     // Initialize SDL
@@ -65,7 +69,10 @@ int main(int argc, char** argv) {
         // Create and run the emulator
         std::unique_ptr<OswEmulator> oswEmu = std::make_unique<OswEmulator>(a.exist(argSoftwareRenderer) or a.exist(argHeadless), a.exist(argHeadless));
         OswEmulator::instance = oswEmu.get();
-        oswEmu->run();
+        if(!a.get<std::string>(argReplay).empty() and !oswEmu->startReplay(a.get<std::string>(argReplay), !a.exist(argReplayFast)))
+            returnval = EXIT_FAILURE;
+        else
+            oswEmu->run();
         OswEmulator::instance = nullptr;
     }
 
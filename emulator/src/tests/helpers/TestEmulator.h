@@ -81,9 +81,6 @@ class TestEmulator {
     }
 
     static void drawEmulator() {
-        // Let the renderer now draw to the FakeDisplays surface
-        int res = SDL_SetRenderTarget(OswEmulator::instance->mainRenderer, fakeDisplayInstance->getTexture());
-        assert(res >= 0 && "Failed to set render target to fake display texture");
         try {
             // Run the next OS iteration
             std::chrono::time_point start = std::chrono::system_clock::now();
@@ -100,9 +97,7 @@ class TestEmulator {
         } catch (OswEmulator::EmulatorSleep& e) {
             // Ignore it :P
         }
-        // And restore emulator surface render target
-        res = SDL_SetRenderTarget(OswEmulator::instance->mainRenderer, nullptr); // nullptr = back to window surface
-        assert(res >= 0 && "Failed to set render target to window surface");
+        fakeDisplayInstance->present();
 
         // Present the fake-display texture as an ImGUI window
         if(!OswEmulator::instance->isHeadless) {
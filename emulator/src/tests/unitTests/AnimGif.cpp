@@ -0,0 +1,217 @@
+#include <vector>
+
+#include "utest.h"
+
+#include <OswLogger.h>
+#include "../../../include/animations/anim_gif.h"
+#include "../../../include/gfx_2d.h"
+#include "../../../include/assets/mwdu.h"
+
+struct TestFrame {
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    uint8_t disposal;
+    int16_t transparent;
+    std::vector<uint8_t> pixels;
+};
+
+static const uint16_t testColors[] = {rgb565(0, 0, 0), rgb565(255, 0, 0), rgb565(0, 255, 0), rgb565(0, 0, 255)};
+
+/**
+ * Writes a GIF with the four testColors (and the first one as background). The pixels are not compressed: every one
+ * is a literal code and the table is cleared before its codes would become wider.
+ */
+static std::vector<uint8_t> makeGif(uint16_t width, uint16_t height, const std::vector<TestFrame>& frames) {
+    std::vector<uint8_t> gif = {'G', 'I', 'F', '8', '9', 'a'};
+    auto word = [&](uint16_t value) {
+        gif.push_back(value & 0xFF);
+        gif.push_back(value >> 8);
+    };
+    word(width);
+    word(height);
+    gif.insert(gif.end(), {0x81, 0, 0});
+    gif.insert(gif.end(), {0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255});
+    for (const TestFrame& frame : frames) {
+        gif.insert(gif.end(), {0x21, 0xF9, 4, (uint8_t)((frame.disposal << 2) | (frame.transparent >= 0)), 10, 0, (uint8_t)(frame.transparent >= 0 ? frame.transparent : 0), 0});
+        gif.push_back(0x2C);
+        word(frame.x);
+        word(frame.y);
+        word(frame.width);
+        word(frame.height);
+        gif.push_back(0);
+
+        std::vector<uint16_t> codes = {4};
+        for (size_t i = 0; i < frame.pixels.size(); i++) {
+            if (i > 0 && i % 2 == 0)
+                codes.push_back(4);
+            codes.push_back(frame.pixels[i]);
+        }
+        codes.push_back(5);
+        std::vector<uint8_t> bytes;
+        uint32_t bits = 0;
+        uint8_t count = 0;
+        for (uint16_t code : codes) {
+            bits |= code << count;
+            count += 3;
+            while (count >= 8) {
+                bytes.push_back(bits & 0xFF);
+                bits >>= 8;
+                count -= 8;
+            }
+        }
+        if (count > 0)
+            bytes.push_back(bits);
+        gif.push_back(2);
+        for (size_t i = 0; i < bytes.size(); i += 255) {
+            size_t length = std::min<size_t>(255, bytes.size() - i);
+            gif.push_back(length);
+            gif.insert(gif.end(), bytes.begin() + i, bytes.begin() + i + length);
+        }
+        gif.push_back(0);
+    }
+    gif.push_back(0x3B);
+    return gif;
+}
+
+UTEST(animGif, should_decode_lzw) {
+    // The 10x10 sample from "What's in a GIF" (Matthew Flickinger), compressed with a growing code size
+    const uint8_t sample[] = {
+        0x47, 0x49, 0x46, 0x38, 0x39, 0x61, 0x0A, 0x00, 0x0A, 0x00, 0x91, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x00,
+        0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x21, 0xF9, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2C, 0x00, 0x00,
+        0x00, 0x00, 0x0A, 0x00, 0x0A, 0x00, 0x00, 0x02, 0x16, 0x8C, 0x2D, 0x99, 0x87, 0x2A, 0x1C, 0xDC, 0x33, 0xA0,
+        0x02, 0x75, 0xEC, 0x95, 0xFA, 0xA8, 0xDE, 0x60, 0x8C, 0x04, 0x91, 0x4C, 0x01, 0x00, 0x3B
+    };
+    const char* expected[] = {
+        "1111122222", "1111122222", "1111122222", "1110000222", "1110000222",
+        "2220000111", "2220000111", "2222211111", "2222211111", "2222211111"
+    };
+
+    GifDecoder decoder;
+    ASSERT_TRUE(decoder.open(sample, sizeof(sample)));
+    EXPECT_EQ(decoder.getWidth(), 10);
+    EXPECT_EQ(decoder.getHeight(), 10);
+    GifDecoder::Frame frame;
+    ASSERT_TRUE(decoder.nextFrame(frame));
+    EXPECT_EQ(decoder.getPalette()[1], rgb565(255, 0, 0));
+
+    int rows = 0;
+    int mismatches = 0;
+    EXPECT_TRUE(decoder.decodeFrame([&](uint16_t row, const uint8_t* indices) {
+        ++rows;
+        for (int x = 0; x < 10; x++)
+            if (indices[x] != expected[row][x] - '0')
+                ++mismatches;
+    }));
+    EXPECT_EQ(rows, 10);
+    EXPECT_EQ(mismatches, 0);
+    EXPECT_FALSE(decoder.nextFrame(frame));
+
+    // Broken files are rejected
+    EXPECT_FALSE(decoder.open(sample, 10));
+}
+
+UTEST(animGif, should_dispose_frames) {
+    std::vector<uint8_t> gif = makeGif(4, 4, {
+        {0, 0, 4, 4, 1, -1, std::vector<uint8_t>(16, 1)},
+        {1, 1, 2, 2, 2, 3, {2, 2, 2, 3}}, // Restore to background, with a transparent pixel
+        {0, 0, 1, 1, 3, -1, {3}}, // Restore to previous
+        {3, 3, 1, 1, 0, -1, {2}}
+    });
+    AnimGif anim(gif.data(), gif.size());
+    ASSERT_TRUE(anim.isValid());
+    Graphics2D gfx(4, 4, 2);
+    auto expectDirty = [&](uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+        EXPECT_EQ(anim.getDirtyRect().x, x);
+        EXPECT_EQ(anim.getDirtyRect().y, y);
+        EXPECT_EQ(anim.getDirtyRect().width, width);
+        EXPECT_EQ(anim.getDirtyRect().height, height);
+    };
+    unsigned long now = 0;
+
+    EXPECT_TRUE(anim.update(now += 1000));
+    expectDirty(0, 0, 4, 4);
+    anim.draw(&gfx, 0, 0);
+    EXPECT_EQ(gfx.getPixel(1, 1), testColors[1]);
+
+    EXPECT_TRUE(anim.update(now += 1000));
+    expectDirty(1, 1, 2, 2);
+    anim.draw(&gfx, 0, 0, true);
+    EXPECT_EQ(gfx.getPixel(1, 1), testColors[2]);
+    EXPECT_EQ(gfx.getPixel(2, 2), testColors[1]);
+
+    EXPECT_TRUE(anim.update(now += 1000));
+    expectDirty(0, 0, 3, 3);
+    anim.draw(&gfx, 0, 0, true);
+    EXPECT_EQ(gfx.getPixel(0, 0), testColors[3]);
+    EXPECT_EQ(gfx.getPixel(1, 1), testColors[0]);
+
+    EXPECT_TRUE(anim.update(now += 1000));
+    expectDirty(0, 0, 4, 4);
+    anim.draw(&gfx, 0, 0, true);
+    EXPECT_EQ(gfx.getPixel(0, 0), testColors[1]);
+    EXPECT_EQ(gfx.getPixel(3, 3), testColors[2]);
+
+    // And the loop starts over
+    EXPECT_TRUE(anim.update(now += 1000));
+    expectDirty(0, 0, 4, 4);
+    anim.draw(&gfx, 0, 0, true);
+    EXPECT_EQ(gfx.getPixel(1, 1), testColors[1]);
+    EXPECT_EQ(gfx.getPixel(3, 3), testColors[1]);
+}
+
+UTEST(animGif, should_keep_the_frame_delays) {
+    std::vector<uint8_t> gif = makeGif(2, 2, {
+        {0, 0, 2, 2, 0, -1, {1, 1, 1, 1}},
+        {0, 0, 1, 1, 0, -1, {2}}
+    });
+    AnimGif anim(gif.data(), gif.size());
+    EXPECT_TRUE(anim.update(1000));
+    // Every frame is shown for 100 ms
+    EXPECT_FALSE(anim.update(1050));
+    EXPECT_EQ(anim.getDirtyRect().width, 0);
+    EXPECT_TRUE(anim.update(1110));
+    // A late frame does not shorten the next one...
+    EXPECT_FALSE(anim.update(1199));
+    EXPECT_TRUE(anim.update(1200));
+    // ...unless it is more than a frame late
+    EXPECT_TRUE(anim.update(5000));
+    EXPECT_FALSE(anim.update(5099));
+    EXPECT_EQ(anim.getFrameCount(), 4U);
+}
+
+UTEST(animGif, cache_should_replay_the_decoded_frames) {
+    AnimGif decoded(mwdu_gif, sizeof(mwdu_gif));
+    AnimGif cached(mwdu_gif, sizeof(mwdu_gif));
+    ASSERT_TRUE(decoded.isValid());
+    ASSERT_TRUE(cached.isValid());
+    EXPECT_FALSE(cached.enableCache(1024)); // Too small
+    EXPECT_FALSE(cached.hasCache());
+    ASSERT_TRUE(cached.enableCache(8 * 1024 * 1024));
+    EXPECT_TRUE(cached.hasCache());
+
+    Graphics2D decodedGfx(decoded.getWidth(), decoded.getHeight(), 3);
+    Graphics2D cachedGfx(cached.getWidth(), cached.getHeight(), 3);
+    decoded.draw(&decodedGfx, 0, 0);
+    cached.draw(&cachedGfx, 0, 0);
+
+    // Two loops, to also cover the first frame replayed after the last one
+    unsigned long now = 0;
+    int mismatches = 0;
+    for (int frame = 0; frame < 100; frame++) {
+        now += 1000;
+        decoded.update(now);
+        cached.update(now);
+        decoded.draw(&decodedGfx, 0, 0, true);
+        cached.draw(&cachedGfx, 0, 0, true);
+        for (uint16_t chunk = 0; chunk < cachedGfx.getNumChunks(); chunk++)
+            for (int i = 0; i < cachedGfx.getChunkWidth(chunk) << cachedGfx.getChunkHeightLd(); i++)
+                if (cachedGfx.getChunk(chunk)[i] != decodedGfx.getChunk(chunk)[i])
+                    ++mismatches;
+    }
+    EXPECT_EQ(mismatches, 0);
+
+    OSW_LOG_I("GIF ", decoded.getWidth(), "x", decoded.getHeight(), ": ", decoded.getAverageFrameTime(), " us per decoded frame, ",
+              cached.getAverageFrameTime(), " us per cached frame (cache uses ", cached.getCacheSize(), " bytes)");
+}
@@ -0,0 +1,99 @@
+#include "utest.h"
+
+#include "../../../include/animations/anim_particles.h"
+#include "../../../include/gfx_2d.h"
+
+UTEST(animParticles, should_move_and_die) {
+    ParticleSystem particles(4);
+    particles.gravityY = ParticleSystem::toFixed(10);
+    EXPECT_TRUE(particles.spawn(ParticleSystem::toFixed(10), ParticleSystem::toFixed(20), ParticleSystem::toFixed(100), 0, 500));
+    EXPECT_TRUE(particles.spawn(0, 0, 0, 0, 1500));
+    EXPECT_EQ(particles.getCount(), 2);
+
+    // 100 px/s for a second, while falling faster and faster
+    for (int i = 0; i < 10; i++)
+        particles.update(100);
+    EXPECT_EQ(particles.getCount(), 1);
+    EXPECT_EQ(particles.getAge(0), 1000);
+    EXPECT_NEAR(ParticleSystem::toInt(particles.getSpeedY(0) * 10), 100, 1);
+    particles.update(500);
+    EXPECT_EQ(particles.getCount(), 0);
+
+    // Full
+    for (int i = 0; i < 4; i++)
+        EXPECT_TRUE(particles.spawn(0, 0, 0, 0, 0));
+    EXPECT_FALSE(particles.spawn(0, 0, 0, 0, 0));
+}
+
+UTEST(animParticles, should_handle_the_edges) {
+    ParticleSystem particles(2);
+    particles.bounds = {0, 0, 100, 50};
+    particles.edges = ParticleSystem::Edges::WRAP;
+    particles.spawn(ParticleSystem::toFixed(95), ParticleSystem::toFixed(10), ParticleSystem::toFixed(10), 0, 0);
+    particles.update(1000);
+    EXPECT_EQ(ParticleSystem::toInt(particles.getX(0)), 5);
+
+    particles.edges = ParticleSystem::Edges::KILL;
+    particles.update(1000);
+    EXPECT_EQ(particles.getCount(), 1);
+    particles.reset(0, ParticleSystem::toFixed(10), ParticleSystem::toFixed(45), 0, ParticleSystem::toFixed(10));
+    particles.update(1000);
+    EXPECT_EQ(particles.getCount(), 0);
+}
+
+UTEST(animParticles, should_emit_with_the_rate) {
+    ParticleSystem particles(100);
+    ParticleSystem::Emitter emitter = {};
+    emitter.x = ParticleSystem::toFixed(50);
+    emitter.y = ParticleSystem::toFixed(50);
+    emitter.angleFrom = 0;
+    emitter.angleTo = 360;
+    emitter.speedFrom = ParticleSystem::toFixed(10);
+    emitter.speedTo = ParticleSystem::toFixed(20);
+    emitter.lifeFrom = 1000;
+    emitter.lifeTo = 1000;
+    emitter.rate = 30;
+    particles.addEmitter(emitter);
+
+    // 30 per second, even if the steps are uneven
+    for (int i = 0; i < 7; i++)
+        particles.update(i % 2 == 0 ? 33 : 67);
+    particles.update(649);
+    EXPECT_EQ(particles.getCount(), 29);
+    for (uint16_t i = 0; i < particles.getCount(); i++) {
+        const int32_t speedX = particles.getSpeedX(i) >> 8;
+        const int32_t speedY = particles.getSpeedY(i) >> 8;
+        const int32_t speed = speedX * speedX + speedY * speedY; // In 8.8 squared
+        EXPECT_GE(speed, (9 * 9) << 16);
+        EXPECT_LE(speed, (21 * 21) << 16);
+    }
+}
+
+UTEST(animParticles, should_fade_with_the_ramp) {
+    Graphics2D gfx(120, 120, 3);
+    gfx.fillBuffer(rgb565(0, 0, 0));
+    ParticleSystem particles(2, 1, 4);
+    particles.setFadeRamp(0, rgb565(255, 255, 255), rgb565(0, 0, 0));
+    particles.spawn(ParticleSystem::toFixed(10), ParticleSystem::toFixed(20), 0, 0, 1000);
+    particles.spawn(ParticleSystem::toFixed(30), ParticleSystem::toFixed(5), 0, 0, 3000);
+
+    particles.draw(&gfx, 1, 2);
+    EXPECT_EQ(gfx.getPixel(11, 22), rgb565(255, 255, 255));
+    EXPECT_EQ(gfx.getPixel(31, 7), rgb565(255, 255, 255));
+    EXPECT_EQ(particles.getDrawnBounds().x, 11);
+    EXPECT_EQ(particles.getDrawnBounds().y, 7);
+    EXPECT_EQ(particles.getDrawnBounds().width, 21);
+    EXPECT_EQ(particles.getDrawnBounds().height, 16);
+
+    // A third of the life is the second of the four colors
+    particles.update(1000);
+    particles.draw(&gfx, 1, 2);
+    EXPECT_EQ(gfx.getPixel(31, 7), blend(rgb565(255, 255, 255), rgb565(0, 0, 0), (uint8_t) 85));
+
+    // The trails fade to black, but nothing else
+    gfx.drawPixel(100, 100, rgb565(255, 255, 255));
+    for (int i = 0; i < 10; i++)
+        particles.fadeTrails(&gfx, 32);
+    EXPECT_EQ(gfx.getPixel(11, 22), rgb565(0, 0, 0));
+    EXPECT_EQ(gfx.getPixel(100, 100), rgb565(255, 255, 255));
+}
@@ -0,0 +1,169 @@
+#include "utest.h"
+
+#include "../../../include/apps/games/OswAppGame.h"
+#include "../../../include/apps/games/snake_game.h"
+
+class TestGame : public OswAppGame {
+  public:
+    TestGame(): OswAppGame(20) {};
+
+    const char* getAppId() override {
+        return "osw.test.game";
+    }
+    const char* getAppName() override {
+        return "Test Game";
+    }
+
+    uint32_t ticked = 0;
+    bool changes = true;
+
+  protected:
+    bool onTick() override {
+        ++this->ticked;
+        return this->changes;
+    }
+    void onRender(float alpha) override {}
+    void sampleTilt() override {} // No accelerometer in here
+};
+
+// This is a friend class of OswAppSnakeGame. It is needed to play the game without a screen or buttons
+class TestSnakeGame {
+  public:
+    static void start(OswAppSnakeGame& game, uint32_t seed) {
+        game.rng.seed(seed);
+        game.layer.setTiles(0, 0, OswAppSnakeGame::gameWidth, OswAppSnakeGame::gameWidth, OswAppSnakeGame::cellSize, OswAppSnakeGame::cellSize);
+        game.resetGame();
+        game.buttonControllerMode = true;
+        press(game, BUTTON_UP);
+        game.onTick();
+        game.layer.commit();
+    }
+
+    static void press(OswAppSnakeGame& game, Button button) {
+        game.pressed[button] = true;
+    }
+
+    static bool tick(OswAppSnakeGame& game) {
+        return game.onTick();
+    }
+
+    static bool isRunning(OswAppSnakeGame& game) {
+        return game.state == OswAppSnakeGame::State::RUNNING;
+    }
+
+    static std::pair<int, int> getHead(OswAppSnakeGame& game) {
+        return {game.snake[0][0], game.snake[0][1]};
+    }
+
+    static std::pair<int, int> getMeal(OswAppSnakeGame& game) {
+        return {game.mealXCoord, game.mealYCoord};
+    }
+
+    static OswGameLayer& getLayer(OswAppSnakeGame& game) {
+        return game.layer;
+    }
+};
+
+UTEST(appGame, random_should_be_deterministic) {
+    OswGameRandom a(42);
+    OswGameRandom b(42);
+    OswGameRandom c(43);
+    bool differs = false;
+    for (int i = 0; i < 100; i++) {
+        const long value = a.random(3, 9);
+        EXPECT_EQ(value, b.random(3, 9));
+        EXPECT_GE(value, 3);
+        EXPECT_LT(value, 9);
+        differs = differs or value != c.random(3, 9);
+    }
+    EXPECT_TRUE(differs);
+
+    // A zero seed would get stuck
+    OswGameRandom zero(0);
+    EXPECT_NE(zero.next(), 0U);
+}
+
+UTEST(appGame, should_tick_in_fixed_steps) {
+    TestGame game;
+    EXPECT_EQ(game.advance(10), 0);
+    EXPECT_NEAR(game.getAlpha(), 0.5f, 0.001f);
+    EXPECT_EQ(game.advance(15), 1);
+    EXPECT_NEAR(game.getAlpha(), 0.25f, 0.001f);
+    EXPECT_EQ(game.advance(35), 2);
+    EXPECT_EQ(game.ticked, 3U);
+    EXPECT_NEAR(game.getAlpha(), 0.0f, 0.001f);
+
+    // A stalled loop does not make the game race afterwards
+    EXPECT_EQ(game.advance(10000 + 5), OswAppGame::maxTicksPerLoop);
+    EXPECT_NEAR(game.getAlpha(), 0.25f, 0.001f);
+    EXPECT_EQ(game.advance(15), 1);
+}
+
+UTEST(appGame, layer_should_track_dirty_areas) {
+    OswGameLayer layer;
+    const size_t sprite = layer.addSprite();
+    layer.setTiles(0, 100, 4, 2, 10, 10);
+    EXPECT_TRUE(layer.isAllDirty());
+    layer.placeSprite(sprite, {10, 10, 5, 5});
+    layer.commit();
+    EXPECT_FALSE(layer.isAllDirty());
+
+    // Unchanged
+    layer.placeSprite(sprite, {10, 10, 5, 5});
+    layer.setTile(1, 1, 0);
+    EXPECT_TRUE(layer.getDirty().isEmpty());
+    layer.commit();
+
+    // Moved: old and new position
+    layer.placeSprite(sprite, {20, 12, 5, 5});
+    OswGameLayer::Rect dirty = layer.getDirty();
+    EXPECT_EQ(dirty.y, 10);
+    EXPECT_EQ(dirty.height, 7);
+    EXPECT_EQ(dirty.x, 10);
+    EXPECT_EQ(dirty.width, 15);
+    layer.commit();
+
+    // Hidden: old position and a changed tile
+    layer.setTile(2, 1, 7);
+    EXPECT_EQ(layer.getTile(2, 1), 7);
+    dirty = layer.getDirty();
+    EXPECT_EQ(dirty.y, 12);
+    EXPECT_EQ(dirty.y + dirty.height, 120);
+    layer.commit();
+    EXPECT_TRUE(layer.getDirty().isEmpty());
+}
+
+UTEST(appGame, snake_should_replay_the_same_game) {
+    OswAppSnakeGame a;
+    OswAppSnakeGame b;
+    TestSnakeGame::start(a, 1234);
+    TestSnakeGame::start(b, 1234);
+    ASSERT_TRUE(TestSnakeGame::isRunning(a));
+    EXPECT_TRUE(TestSnakeGame::getMeal(a) == TestSnakeGame::getMeal(b));
+
+    // The snake (with a score of 1) moves one cell down every second, only the tiles it left and entered change
+    auto head = TestSnakeGame::getHead(a);
+    int ticks = 0;
+    while (!TestSnakeGame::tick(a))
+        ++ticks;
+    EXPECT_EQ(ticks + 1, 50);
+    EXPECT_EQ(TestSnakeGame::getHead(a).first, head.first);
+    EXPECT_EQ(TestSnakeGame::getHead(a).second, head.second + 1);
+    const OswGameLayer::Rect dirty = TestSnakeGame::getLayer(a).getDirty();
+    EXPECT_EQ(dirty.y, head.second * 10);
+    EXPECT_EQ(dirty.height, 20);
+
+    // Same input, same game
+    for (int i = 0; i < 50; i++)
+        TestSnakeGame::tick(b);
+    for (int i = 0; i < 3000; i++) {
+        if (i % 170 == 0) {
+            TestSnakeGame::press(a, BUTTON_DOWN);
+            TestSnakeGame::press(b, BUTTON_DOWN);
+        }
+        TestSnakeGame::tick(a);
+        TestSnakeGame::tick(b);
+        EXPECT_TRUE(TestSnakeGame::getHead(a) == TestSnakeGame::getHead(b));
+        EXPECT_TRUE(TestSnakeGame::getMeal(a) == TestSnakeGame::getMeal(b));
+    }
+}
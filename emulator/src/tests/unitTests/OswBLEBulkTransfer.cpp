@@ -0,0 +1,264 @@
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "utest.h"
+
+#include <OswBLEBulkTransfer.h>
+
+using Opcode = OswBLEBulkTransfer::Opcode;
+using Status = OswBLEBulkTransfer::Status;
+
+/**
+ * Connects the transfer to a phone in the same process: every step of the test is one connection event, which carries
+ * a limited number of notifications to the phone (and its writes back, one step later)
+ */
+class LoopbackTransport : public OswBLEBulkTransfer::Transport {
+  public:
+    size_t notificationSize = 182; // ATT MTU 185
+    size_t framesPerEvent = 6;
+    std::deque<std::vector<uint8_t>> data;
+    std::deque<std::vector<uint8_t>> control;
+
+    virtual size_t getMaxNotificationSize() override {
+        return this->notificationSize;
+    };
+    virtual bool sendData(const uint8_t* data, size_t length) override {
+        if(this->sentThisEvent >= this->framesPerEvent)
+            return false;
+        ++this->sentThisEvent;
+        this->data.emplace_back(data, data + length);
+        return true;
+    };
+    virtual void sendControl(const uint8_t* data, size_t length) override {
+        this->control.emplace_back(data, data + length);
+    };
+    void nextEvent() {
+        this->sentThisEvent = 0;
+    };
+
+  private:
+    size_t sentThisEvent = 0;
+};
+
+/**
+ * What scripts/ble/syncFile.py does on the phone: acknowledges every half window and asks for the first missing (or
+ * broken) frame again
+ */
+class FakePhone {
+  public:
+    std::vector<uint8_t> received;
+    uint8_t window = 8;
+    bool done = false;
+    Status status = Status::OK;
+    uint32_t size = 0;
+    unsigned int dropEvery = 0; // Loses every n-th notification
+    unsigned int corruptEvery = 0; // Flips a bit in every n-th notification
+    bool connected = true;
+
+    std::vector<uint8_t> open(const std::string& name, uint32_t offset) {
+        std::vector<uint8_t> request = {(uint8_t) Opcode::OPEN, (uint8_t) offset, (uint8_t) (offset >> 8), (uint8_t) (offset >> 16), (uint8_t) (offset >> 24), this->window};
+        request.insert(request.end(), name.begin(), name.end());
+        this->done = false;
+        this->expected = 0;
+        this->unacked = 0;
+        this->rewound = false;
+        return request;
+    };
+
+    /**
+     * Handles everything the watch sent in the last event, returns the writes to the control point
+     */
+    std::vector<std::vector<uint8_t>> receive(LoopbackTransport& transport) {
+        std::vector<std::vector<uint8_t>> writes;
+        for(; !transport.control.empty(); transport.control.pop_front()) {
+            const std::vector<uint8_t>& reply = transport.control.front();
+            if(!this->connected)
+                continue;
+            if(reply[0] == (uint8_t) Opcode::OPENED) {
+                this->status = (Status) reply[1];
+                this->size = reply[2] | (reply[3] << 8) | (reply[4] << 16) | (reply[5] << 24);
+                this->done = this->status != Status::OK;
+            } else if(reply[0] == (uint8_t) Opcode::DONE) {
+                this->status = (Status) reply[1];
+                this->done = true;
+            }
+        }
+        for(; !transport.data.empty(); transport.data.pop_front()) {
+            std::vector<uint8_t> frame = transport.data.front();
+            ++this->notifications;
+            if(!this->connected or (this->dropEvery and this->notifications % this->dropEvery == 0))
+                continue;
+            if(this->corruptEvery and this->notifications % this->corruptEvery == 0)
+                frame[3] ^= 0x10;
+            const uint16_t seq = frame[0] | (frame[1] << 8);
+            const uint16_t crc = frame[frame.size() - 2] | (frame[frame.size() - 1] << 8);
+            const bool valid = crc == OswBLEBulkTransfer::crc16(frame.data(), frame.size() - 2);
+            if(seq != (uint16_t) this->expected or !valid) {
+                if(!this->rewound) {
+                    writes.push_back(this->command(Opcode::REWIND, (uint16_t) this->expected));
+                    this->rewound = true; // Once, until the frame arrives
+                }
+                continue;
+            }
+            this->rewound = false;
+            this->received.insert(this->received.end(), frame.begin() + 2, frame.end() - 2);
+            ++this->expected;
+            if(++this->unacked >= this->window / 2 or this->received.size() == this->size) {
+                writes.push_back(this->command(Opcode::ACK, (uint16_t) (this->expected - 1)));
+                this->unacked = 0;
+            }
+        }
+        return writes;
+    };
+
+  private:
+    uint32_t expected = 0;
+    unsigned int unacked = 0;
+    unsigned int notifications = 0;
+    bool rewound = false;
+
+    std::vector<uint8_t> command(Opcode opcode, uint16_t seq) {
+        return {(uint8_t) opcode, (uint8_t) seq, (uint8_t) (seq >> 8)};
+    };
+};
+
+static const unsigned long connectionInterval = 15; // ms
+
+static std::string writeTestFile(const char* name, size_t size) {
+    const std::string path = std::string("/tmp/") + name;
+    FILE* file = fopen(path.c_str(), "wb");
+    for(size_t i = 0; i < size; i++)
+        fputc((int) ((i * 7 + i / 251) & 0xFF), file);
+    fclose(file);
+    return path;
+}
+
+static std::vector<uint8_t> readTestFile(const std::string& path) {
+    std::vector<uint8_t> content;
+    FILE* file = fopen(path.c_str(), "rb");
+    for(int c = fgetc(file); c != EOF; c = fgetc(file))
+        content.push_back((uint8_t) c);
+    fclose(file);
+    return content;
+}
+
+/**
+ * Runs connection events until the phone got the DONE (or the time is up)
+ */
+static unsigned long run(OswBLEBulkTransfer& transfer, LoopbackTransport& transport, FakePhone& phone, unsigned long now, unsigned long duration = 60000) {
+    for(unsigned long end = now + duration; now < end and !phone.done; now += connectionInterval) {
+        transport.nextEvent();
+        transfer.loop(now);
+        for(const std::vector<uint8_t>& write : phone.receive(transport))
+            transfer.onControl(write.data(), write.size(), now);
+    }
+    return now;
+}
+
+UTEST(bleBulkTransfer, should_stream_the_whole_file) {
+    const std::string path = writeTestFile("osw_bulk_whole.bin", 50000);
+    LoopbackTransport transport;
+    OswBLEBulkTransfer transfer(transport);
+    transfer.addFile("log", path);
+    FakePhone phone;
+
+    const std::vector<uint8_t> open = phone.open("log", 0);
+    transfer.onControl(open.data(), open.size(), 0);
+    const unsigned long end = run(transfer, transport, phone, 0);
+    ASSERT_TRUE(phone.done);
+    EXPECT_EQ((int) phone.status, (int) Status::OK);
+    EXPECT_FALSE(transfer.isActive());
+    EXPECT_TRUE(phone.received == readTestFile(path));
+
+    const OswBLEBulkTransfer::Stats stats = transfer.getStats(end);
+    EXPECT_EQ(stats.bytes, 50000u);
+    EXPECT_EQ(stats.retransmissions, 0u);
+    EXPECT_EQ(stats.frames, (50000u + 177) / 178);
+    // Six notifications per 15 ms are about 71 kB/s - the acknowledgements must not stall the pipeline
+    EXPECT_GT(stats.bytes * 1000ul / stats.duration, 60000ul);
+    remove(path.c_str());
+}
+
+UTEST(bleBulkTransfer, should_recover_lost_and_broken_frames) {
+    const std::string path = writeTestFile("osw_bulk_lossy.bin", 30000);
+    LoopbackTransport transport;
+    OswBLEBulkTransfer transfer(transport);
+    transfer.addFile("log", path);
+    FakePhone phone;
+    phone.dropEvery = 23;
+    phone.corruptEvery = 37;
+
+    const std::vector<uint8_t> open = phone.open("log", 0);
+    transfer.onControl(open.data(), open.size(), 0);
+    const unsigned long end = run(transfer, transport, phone, 0);
+    ASSERT_TRUE(phone.done);
+    EXPECT_EQ((int) phone.status, (int) Status::OK);
+    EXPECT_TRUE(phone.received == readTestFile(path));
+    EXPECT_GT(transfer.getStats(end).retransmissions, 0u);
+    remove(path.c_str());
+}
+
+UTEST(bleBulkTransfer, should_resume_after_a_disconnect) {
+    const std::string path = writeTestFile("osw_bulk_resume.bin", 40000);
+    LoopbackTransport transport;
+    OswBLEBulkTransfer transfer(transport);
+    transfer.addFile("log", path);
+    FakePhone phone;
+
+    std::vector<uint8_t> open = phone.open("log", 0);
+    transfer.onControl(open.data(), open.size(), 0);
+    unsigned long now = run(transfer, transport, phone, 0, 20 * connectionInterval);
+    ASSERT_FALSE(phone.done);
+    const size_t before = phone.received.size();
+    ASSERT_GT(before, 0u);
+
+    // The phone is gone: the watch gives up after its retries
+    phone.connected = false;
+    now = run(transfer, transport, phone, now, (OswBLEBulkTransfer::maxRetries + 2) * OswBLEBulkTransfer::ackTimeout);
+    EXPECT_FALSE(transfer.isActive());
+    EXPECT_EQ((int) transfer.getStats(now).status, (int) Status::TIMEOUT);
+
+    // ...and it continues where it left off
+    phone.connected = true;
+    open = phone.open("log", (uint32_t) before);
+    transfer.onControl(open.data(), open.size(), now);
+    now = run(transfer, transport, phone, now);
+    ASSERT_TRUE(phone.done);
+    EXPECT_EQ((int) phone.status, (int) Status::OK);
+    EXPECT_TRUE(phone.received == readTestFile(path));
+    EXPECT_EQ(transfer.getStats(now).offset, (uint32_t) before);
+    EXPECT_EQ(transfer.getStats(now).bytes, (uint32_t) (40000 - before));
+    remove(path.c_str());
+}
+
+UTEST(bleBulkTransfer, should_refuse_bad_requests) {
+    const std::string path = writeTestFile("osw_bulk_small.bin", 100);
+    LoopbackTransport transport;
+    OswBLEBulkTransfer transfer(transport);
+    transfer.addFile("log", path);
+    FakePhone phone;
+
+    std::vector<uint8_t> open = phone.open("/etc/passwd", 0);
+    transfer.onControl(open.data(), open.size(), 0);
+    phone.receive(transport);
+    EXPECT_EQ((int) phone.status, (int) Status::NOT_FOUND);
+    open = phone.open("log", 101);
+    transfer.onControl(open.data(), open.size(), 0);
+    phone.receive(transport);
+    EXPECT_EQ((int) phone.status, (int) Status::BAD_OFFSET);
+    EXPECT_FALSE(transfer.isActive());
+
+    // Resuming a complete file is done right away
+    open = phone.open("log", 100);
+    transfer.onControl(open.data(), open.size(), 0);
+    phone.receive(transport);
+    EXPECT_TRUE(phone.done);
+    EXPECT_EQ((int) phone.status, (int) Status::OK);
+    EXPECT_FALSE(transfer.isActive());
+
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    EXPECT_EQ(OswBLEBulkTransfer::crc16(check, sizeof(check)), 0x29B1); // CRC-16/CCITT-FALSE
+    remove(path.c_str());
+}
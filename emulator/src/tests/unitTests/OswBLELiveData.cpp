@@ -0,0 +1,118 @@
+#include <vector>
+
+#include "utest.h"
+
+#include <OswBLELiveData.h>
+
+using Channel = OswBLELiveData::Channel;
+
+struct Notification {
+    Channel channel;
+    std::vector<uint8_t> data;
+};
+
+static std::vector<Notification> flush(OswBLELiveData& liveData, unsigned long now) {
+    std::vector<Notification> notifications;
+    liveData.flush(now, [&](Channel channel, const uint8_t* data, size_t length) {
+        notifications.push_back({channel, std::vector<uint8_t>(data, data + length)});
+    });
+    return notifications;
+}
+
+UTEST(bleLiveData, should_encode_like_the_characteristics) {
+    uint8_t out[OswBLELiveData::maxPayload];
+    OswBLELiveData::Values values;
+    values.batteryPercent = 42;
+    EXPECT_EQ(OswBLELiveData::encodeBatteryLevel(values, out), 1u);
+    EXPECT_EQ(out[0], 42);
+    EXPECT_EQ(OswBLELiveData::encodeBatteryLevelStatus(values, out), 4u);
+    EXPECT_EQ(out[0], 0b00000010);
+    EXPECT_EQ(out[1], 0b01000001); // Present, discharging
+    EXPECT_EQ(out[2], 0b00000001); // Low
+    EXPECT_EQ(out[3], 42);
+
+    values.charging = true;
+    EXPECT_EQ(OswBLELiveData::encodeBatteryLevel(values, out), 1u);
+    EXPECT_EQ(out[0], 0xFF);
+    EXPECT_EQ(OswBLELiveData::encodeBatteryLevelStatus(values, out), 3u);
+    EXPECT_EQ(out[0], 0b00000000);
+    EXPECT_EQ(out[1], 0b00100011); // Present, external power, charging
+
+    values.hasSteps = true;
+    values.stepsToday = 0x01020304;
+    values.stepsTotal = 0xA0B0C0D0;
+    EXPECT_EQ(OswBLELiveData::encodeLiveStatus(values, out), OswBLELiveData::liveStatusSize);
+    EXPECT_EQ(out[0], OswBLELiveData::liveStatusVersion);
+    EXPECT_EQ(out[1], 0b11);
+    EXPECT_EQ(out[2], 42);
+    EXPECT_EQ(out[3], 0x04);
+    EXPECT_EQ(out[6], 0x01);
+    EXPECT_EQ(out[11], 0xD0);
+    EXPECT_EQ(out[14], 0xA0);
+}
+
+UTEST(bleLiveData, should_only_notify_changes_within_the_window) {
+    OswBLELiveData liveData(1000);
+    OswBLELiveData::Values values;
+    values.batteryPercent = 80;
+    liveData.update(values);
+    EXPECT_EQ(flush(liveData, 0).size(), 0u); // Nobody subscribed
+
+    liveData.setSubscribed(Channel::BATTERY_LEVEL, true);
+    auto notifications = flush(liveData, 10); // The current value right away
+    ASSERT_EQ(notifications.size(), 1u);
+    EXPECT_EQ((int) notifications[0].channel, (int) Channel::BATTERY_LEVEL);
+    EXPECT_EQ(notifications[0].data[0], 80);
+
+    liveData.update(values);
+    EXPECT_EQ(flush(liveData, 2000).size(), 0u); // Same value
+
+    // The first change after a quiet window goes out at once, the following ones are coalesced
+    values.batteryPercent = 79;
+    liveData.update(values);
+    notifications = flush(liveData, 2100);
+    ASSERT_EQ(notifications.size(), 1u);
+    EXPECT_EQ(notifications[0].data[0], 79);
+    for(uint8_t percent = 78; percent > 70; percent--) {
+        values.batteryPercent = percent;
+        liveData.update(values);
+        EXPECT_EQ(flush(liveData, 2100 + (80 - percent) * 100).size(), 0u);
+    }
+    notifications = flush(liveData, 3100);
+    ASSERT_EQ(notifications.size(), 1u);
+    EXPECT_EQ(notifications[0].data[0], 71);
+
+    // A change which is reverted within the window is not notified at all
+    values.batteryPercent = 70;
+    liveData.update(values);
+    values.batteryPercent = 71;
+    liveData.update(values);
+    EXPECT_EQ(flush(liveData, 4200).size(), 0u);
+
+    liveData.setSubscribed(Channel::BATTERY_LEVEL, false);
+    values.batteryPercent = 60;
+    liveData.update(values);
+    EXPECT_EQ(flush(liveData, 5300).size(), 0u);
+    uint8_t out[OswBLELiveData::maxPayload];
+    ASSERT_EQ(liveData.get(Channel::BATTERY_LEVEL, out), 1u);
+    EXPECT_EQ(out[0], 60); // Still available for reads
+}
+
+UTEST(bleLiveData, should_follow_the_workload) {
+    OswBLELiveData liveData;
+    EXPECT_EQ((int) liveData.getWorkload(0), (int) OswBLELiveData::Workload::IDLE);
+    liveData.setSubscribed(Channel::LIVE_STATUS, true);
+    EXPECT_EQ((int) liveData.getWorkload(0), (int) OswBLELiveData::Workload::LIVE);
+    liveData.noteSyncActivity(1000);
+    EXPECT_EQ((int) liveData.getWorkload(1000 + OswBLELiveData::syncHold - 1), (int) OswBLELiveData::Workload::SYNC);
+    EXPECT_EQ((int) liveData.getWorkload(1000 + OswBLELiveData::syncHold), (int) OswBLELiveData::Workload::LIVE);
+
+    const auto sync = OswBLELiveData::getConnectionParameters(OswBLELiveData::Workload::SYNC);
+    const auto idle = OswBLELiveData::getConnectionParameters(OswBLELiveData::Workload::IDLE);
+    EXPECT_LT(sync.maxInterval, idle.minInterval);
+    for(const auto& parameters : {sync, idle, OswBLELiveData::getConnectionParameters(OswBLELiveData::Workload::LIVE)}) {
+        EXPECT_LE(parameters.minInterval, parameters.maxInterval);
+        // The supervision timeout has to cover two effective intervals (see the Bluetooth core specification)
+        EXPECT_GT(parameters.timeout * 10ul * 4, (1ul + parameters.latency) * parameters.maxInterval * 5 * 2);
+    }
+}
@@ -0,0 +1,86 @@
+#include <vector>
+
+#include "utest.h"
+
+#include "../../../include/OswButtonQueue.h"
+
+static std::vector<OswButtonQueue::Edge> drain(OswButtonQueue& queue, unsigned long now) {
+    std::vector<OswButtonQueue::Edge> edges(OswButtonQueue::capacity);
+    edges.resize(queue.drain(now, edges.data(), edges.size()));
+    return edges;
+}
+
+UTEST(buttonQueue, should_keep_taps_shorter_than_a_frame) {
+    OswButtonQueue queue;
+    queue.reset({});
+    queue.push(BUTTON_SELECT, true, 1000);
+    queue.push(BUTTON_SELECT, false, 1040);
+    queue.push(BUTTON_SELECT, true, 1100);
+    queue.push(BUTTON_SELECT, false, 1150);
+
+    // All of that happened during one (slow) frame
+    auto edges = drain(queue, 1200);
+    ASSERT_EQ(edges.size(), (size_t) 4);
+    const unsigned long timestamps[] = {1000, 1040, 1100, 1150};
+    for(size_t i = 0; i < edges.size(); i++) {
+        EXPECT_EQ(edges[i].timestamp, timestamps[i]);
+        EXPECT_EQ(edges[i].down, i % 2 == 0);
+    }
+    EXPECT_FALSE(queue.isDown(BUTTON_SELECT));
+}
+
+UTEST(buttonQueue, should_debounce_on_timestamps) {
+    OswButtonQueue queue;
+    queue.reset({});
+    // Bouncing contact, settles down at 1003
+    queue.push(BUTTON_UP, true, 1000);
+    queue.push(BUTTON_UP, false, 1001);
+    queue.push(BUTTON_UP, true, 1003);
+
+    // Not stable for long enough yet
+    EXPECT_EQ(drain(queue, 1010).size(), (size_t) 0);
+    EXPECT_TRUE(queue.isPending(BUTTON_UP));
+    EXPECT_FALSE(queue.isDown(BUTTON_UP));
+
+    auto edges = drain(queue, 1003 + OswButtonQueue::debounceTime);
+    ASSERT_EQ(edges.size(), (size_t) 1);
+    EXPECT_EQ(edges[0].timestamp, 1003UL);
+    EXPECT_TRUE(edges[0].down);
+    EXPECT_TRUE(queue.isDown(BUTTON_UP));
+
+    // A glitch while held is ignored completely
+    queue.push(BUTTON_UP, false, 2000);
+    queue.push(BUTTON_UP, true, 2002);
+    EXPECT_EQ(drain(queue, 3000).size(), (size_t) 0);
+    EXPECT_TRUE(queue.isDown(BUTTON_UP));
+}
+
+UTEST(buttonQueue, should_keep_the_order_across_buttons) {
+    OswButtonQueue queue;
+    queue.reset({});
+    queue.push(BUTTON_DOWN, true, 1000);
+    queue.push(BUTTON_SELECT, true, 1005);
+    queue.push(BUTTON_SELECT, false, 1100);
+
+    auto edges = drain(queue, 2000);
+    ASSERT_EQ(edges.size(), (size_t) 3);
+    EXPECT_EQ(edges[0].button, BUTTON_DOWN);
+    EXPECT_EQ(edges[1].button, BUTTON_SELECT);
+    EXPECT_TRUE(edges[1].down);
+    EXPECT_EQ(edges[2].button, BUTTON_SELECT);
+    EXPECT_FALSE(edges[2].down);
+}
+
+UTEST(buttonQueue, should_count_dropped_edges) {
+    OswButtonQueue queue;
+    queue.reset({});
+    for(size_t i = 0; i < OswButtonQueue::capacity + 3; i++)
+        queue.push(BUTTON_SELECT, i % 2 == 0, 1000 + i * 100);
+    EXPECT_EQ(queue.getDropped(), 3U);
+    EXPECT_EQ(drain(queue, 10000).size(), OswButtonQueue::capacity);
+
+    // There is room again
+    queue.push(BUTTON_SELECT, true, 20000);
+    EXPECT_EQ(drain(queue, 30000).size(), (size_t) 1);
+    EXPECT_EQ(queue.getDropped(), 3U);
+}
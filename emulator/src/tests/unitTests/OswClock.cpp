@@ -0,0 +1,95 @@
+#include <cstdlib>
+#include <ctime>
+
+#include "utest.h"
+
+#include <OswClock.h>
+
+static OswClock::Sample makeSample(time_t utc, int64_t at, bool atSecondEdge = false) {
+    OswClock::Sample sample;
+    sample.utc = utc;
+    sample.at = at;
+    sample.atSecondEdge = atSecondEdge;
+    return sample;
+}
+
+UTEST(clock, should_break_down_like_gmtime) {
+    const time_t interesting[] = {0, 951782400 /* 2000-02-29 */, 4107542400 /* 2100-03-01 */, 1700000000, 2147483647, -86401};
+    for(time_t time : interesting) {
+        OswClock::BrokenDownTime ours;
+        OswClock::breakDown(time, ours);
+        std::tm theirs;
+        gmtime_r(&time, &theirs);
+        EXPECT_EQ(ours.year, theirs.tm_year + 1900);
+        EXPECT_EQ(ours.month, theirs.tm_mon + 1);
+        EXPECT_EQ(ours.day, theirs.tm_mday);
+        EXPECT_EQ(ours.weekDay, theirs.tm_wday);
+        EXPECT_EQ(ours.hour, theirs.tm_hour);
+        EXPECT_EQ(ours.minute, theirs.tm_min);
+        EXPECT_EQ(ours.second, theirs.tm_sec);
+    }
+    srand(42);
+    for(int i = 0; i < 10000; i++) {
+        const time_t time = ((time_t) rand() << 8) % 4102444800; // Until 2100
+        OswClock::BrokenDownTime ours;
+        OswClock::breakDown(time, ours);
+        std::tm theirs;
+        gmtime_r(&time, &theirs);
+        ASSERT_EQ(ours.day, theirs.tm_mday);
+        ASSERT_EQ(ours.month, theirs.tm_mon + 1);
+        ASSERT_EQ(ours.weekDay, theirs.tm_wday);
+        ASSERT_EQ(ours.second, theirs.tm_sec);
+    }
+}
+
+UTEST(clock, should_lock_onto_the_second_edges) {
+    OswClock clock;
+    EXPECT_FALSE(clock.isSynchronized());
+    // The provider's seconds start at timer values of x.3 seconds
+    const int64_t phase = 300000;
+    auto providerAt = [&](int64_t at) -> time_t { return 1700000000 + (at - phase) / 1000000; };
+
+    EXPECT_TRUE(clock.discipline(makeSample(providerAt(5000000), 5000000)));
+    EXPECT_TRUE(clock.isSynchronized());
+    EXPECT_EQ(clock.getUncertainty(), 999999ll);
+    for(int64_t at = 6000000; at < 60000000; at += 1013000) // Sampling at different phases narrows it down
+        EXPECT_FALSE(clock.discipline(makeSample(providerAt(at), at)));
+    EXPECT_LT(clock.getUncertainty(), 20000ll);
+    const int64_t now = 60000000;
+    EXPECT_NEAR((double) clock.getUTCMicros(now), (double) (1700000000ll * 1000000 + now - phase), 10000.0);
+    EXPECT_EQ(clock.getUTCTime(now), providerAt(now));
+    EXPECT_EQ(clock.getSteps(), 1u);
+
+    // A provider which jumped steps the clock
+    EXPECT_TRUE(clock.discipline(makeSample(1800000000, 61000000, true)));
+    EXPECT_EQ(clock.getUTCTime(61500000), (time_t) 1800000000);
+    EXPECT_EQ(clock.getSteps(), 2u);
+    EXPECT_FALSE(clock.discipline(makeSample(1700000060, 60500000))); // Stale samples are ignored
+}
+
+UTEST(clock, should_track_the_drift) {
+    OswClock clock;
+    // The timer runs 80 ppm slow: 1 provider second takes only 999920 µs on it
+    auto timerAt = [](int64_t second) -> int64_t { return second * 999920; };
+    int64_t lastReturned = 0;
+    for(int64_t second = 0; second <= 4 * 3600; second += 60) {
+        clock.discipline(makeSample(1700000000 + second, timerAt(second), true));
+        const int64_t returned = clock.getUTCMicros(timerAt(second) + 500000);
+        EXPECT_GE(returned, lastReturned);
+        lastReturned = returned;
+    }
+    EXPECT_EQ(clock.getSteps(), 1u);
+    EXPECT_NEAR(clock.getDrift(), 80.0f, 5.0f);
+    // Even a minute after the last sample the second boundary is hit within a millisecond
+    const int64_t at = timerAt(4 * 3600 + 60);
+    EXPECT_NEAR((double) clock.getUTCMicros(at), (double) ((1700000000ll + 4 * 3600 + 60) * 1000000), 1000.0);
+}
+
+UTEST(clock, should_cache_the_broken_down_time) {
+    OswClock clock;
+    const OswClock::BrokenDownTime primary = clock.getBrokenDown(1700000000);
+    const OswClock::BrokenDownTime secondary = clock.getBrokenDown(1700000000 + 3600);
+    EXPECT_EQ(primary.hour + 1, secondary.hour);
+    EXPECT_EQ(clock.getBrokenDown(1700000000).time, (time_t) 1700000000);
+    EXPECT_EQ(clock.getBrokenDown(1700000001).second, (uint8_t) (primary.second + 1));
+}
@@ -0,0 +1,301 @@
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "utest.h"
+
+#include <OswCommunication.h>
+
+using MessageType = OswCommunication::MessageType;
+using Priority = OswCommunication::Priority;
+using Result = OswCommunication::Transport::Result;
+
+/**
+ * Inflates what OswGzip produces (a single block with the fixed codes) - enough to check it without a zlib
+ */
+static std::string gunzip(const std::vector<uint8_t>& gzip) {
+    size_t position = OswGzip::headerSize * 8;
+    auto bits = [&](uint8_t count) {
+        uint32_t value = 0;
+        for(uint8_t i = 0; i < count; i++, position++)
+            value |= ((gzip[position / 8] >> (position % 8)) & 1) << i;
+        return value;
+    };
+    auto code = [&](uint8_t count) { // Starting with the most significant bit
+        uint32_t value = 0;
+        for(uint8_t i = 0; i < count; i++, position++)
+            value = (value << 1) | ((gzip[position / 8] >> (position % 8)) & 1);
+        return value;
+    };
+    auto symbol = [&]() -> uint16_t {
+        uint32_t value = code(7);
+        if(value <= 0x17)
+            return (uint16_t) (256 + value);
+        value = (value << 1) | code(1);
+        if(value >= 0x30 and value <= 0xBF)
+            return (uint16_t) (value - 0x30);
+        if(value >= 0xC0 and value <= 0xC7)
+            return (uint16_t) (280 + value - 0xC0);
+        return (uint16_t) (144 + ((value << 1) | code(1)) - 0x190);
+    };
+    static const uint16_t lengthBase[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const uint16_t distanceBase[] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+
+    std::string out;
+    if(bits(1) != 1 or bits(2) != 1)
+        return "not a single fixed block";
+    for(uint16_t next = symbol(); next != 256; next = symbol()) {
+        if(next < 256) {
+            out += (char) next;
+            continue;
+        }
+        const uint16_t lengthCode = next - 257;
+        const size_t length = lengthBase[lengthCode] + bits(lengthCode >= 8 and lengthCode < 28 ? (lengthCode - 4) / 4 : 0);
+        const uint32_t distanceCode = code(5);
+        const size_t distance = distanceBase[distanceCode] + bits(distanceCode >= 4 ? (distanceCode - 2) / 2 : 0);
+        for(size_t i = 0; i < length; i++)
+            out += out[out.size() - distance];
+    }
+    const size_t trailer = (position + 7) / 8;
+    const uint32_t crc = gzip[trailer] | (gzip[trailer + 1] << 8) | (gzip[trailer + 2] << 16) | ((uint32_t) gzip[trailer + 3] << 24);
+    if(crc != OswGzip::crc32((const uint8_t*) out.data(), out.size()))
+        return "wrong checksum";
+    return out;
+}
+
+/**
+ * A radio which comes up after a while, and a server which answers as told
+ */
+class FakeTransport : public OswCommunication::Transport {
+  public:
+    unsigned long* now;
+    unsigned long connectDelay = 500;
+    std::vector<Result> results; // Taken one by one, OK once empty...
+    unsigned int failEvery = 0; // ...except for every n-th request
+    std::vector<std::string> batches; // As the server saw them
+    unsigned int bringUps = 0;
+    bool up = false;
+
+    FakeTransport(unsigned long* now) : now(now) {};
+    virtual const char* getName() const override {
+        return "fake";
+    };
+    virtual void bringUp() override {
+        ++this->bringUps;
+        this->upAt = *this->now + this->connectDelay;
+        this->up = true;
+    };
+    virtual void bringDown() override {
+        this->up = false;
+    };
+    virtual bool isUp() override {
+        return this->up and *this->now >= this->upAt;
+    };
+    virtual Result send(const uint8_t* data, size_t length, bool compressed) override {
+        const std::vector<uint8_t> body(data, data + length);
+        this->batches.push_back(compressed ? gunzip(body) : std::string(body.begin(), body.end()));
+        if(this->results.empty())
+            return this->failEvery and this->batches.size() % this->failEvery == 0 ? Result::RETRY : Result::OK;
+        const Result result = this->results.front();
+        this->results.erase(this->results.begin());
+        return result;
+    };
+
+  private:
+    unsigned long upAt = 0;
+};
+
+static bool enqueue(OswCommunication& communication, Priority priority, int value, unsigned long now) {
+    const std::string data = "{\"value\":" + std::to_string(value) + "}";
+    return communication.enqueue(MessageType::SENSOR_DATA, priority, data.c_str(), data.size(), 1700000000, now);
+}
+
+/**
+ * Runs the loop every step ms - now is the clock of the transports, too
+ */
+static void run(OswCommunication& communication, unsigned long& now, unsigned long duration, unsigned long step = 50) {
+    for(unsigned long end = now + duration; now < end; now += step)
+        communication.loop(now);
+}
+
+UTEST(communication, should_raise_the_radio_only_when_worth_it) {
+    static OswCommunication::Storage storage = {};
+    unsigned long now = 0;
+    FakeTransport transport(&now);
+    OswCommunication communication(storage);
+    communication.addTransport(transport);
+    communication.setDeviceId("OSW \"1\"");
+
+    // Some sensor data waits for its delay...
+    for(int value = 0; value < 5; value++)
+        ASSERT_TRUE(enqueue(communication, Priority::NORMAL, value, now));
+    run(communication, now, 60000);
+    EXPECT_EQ(transport.bringUps, 0u);
+    EXPECT_EQ(communication.getIdleTime(now), 5 * 60000ul - 60000);
+
+    // ...until something urgent takes it along - more important messages first
+    ASSERT_TRUE(enqueue(communication, Priority::URGENT, 99, now));
+    run(communication, now, 2000);
+    EXPECT_EQ(transport.bringUps, 1u);
+    EXPECT_FALSE(transport.up); // Down again right after
+    ASSERT_EQ(transport.batches.size(), 1u);
+    const std::string& batch = transport.batches[0];
+    EXPECT_EQ(batch.rfind("{\"device_id\":\"OSW1\",\"messages\":[{\"message_id\":6,\"type\":0,\"priority\":3,\"timestamp\":1700000000,\"data\":{\"value\":99}}", 0), 0u);
+    EXPECT_LT(batch.find("\"value\":0"), batch.find("\"value\":4"));
+    EXPECT_EQ(communication.getQueueSize(), 0u);
+    OswCommunication::Stats stats = communication.getStats();
+    EXPECT_EQ(stats.sent, 6u);
+    EXPECT_EQ(stats.radioTime, 500ul); // Sent as soon as it was up
+
+    // Enough bytes are worth it by themselves, and an open connection is used along
+    for(int value = 0; value < 60; value++)
+        ASSERT_TRUE(enqueue(communication, Priority::BACKGROUND, value, now));
+    run(communication, now, 2000);
+    EXPECT_EQ(transport.bringUps, 2u);
+    EXPECT_EQ(communication.getQueueSize(), 0u);
+    transport.up = true;
+    ASSERT_TRUE(enqueue(communication, Priority::BACKGROUND, 1, now));
+    run(communication, now, 100);
+    EXPECT_EQ(communication.getQueueSize(), 0u);
+    EXPECT_EQ(transport.bringUps, 2u);
+    EXPECT_TRUE(transport.up); // Not ours to bring down
+}
+
+UTEST(communication, should_back_off_exponentially) {
+    static OswCommunication::Storage storage = {};
+    unsigned long now = 0;
+    FakeTransport transport(&now);
+    transport.connectDelay = 0;
+    transport.results = {Result::RETRY, Result::RETRY, Result::RETRY, Result::OK};
+    OswCommunication communication(storage);
+    communication.addTransport(transport);
+    OswCommunication::Policy policy;
+    policy.minBackoff = 1000;
+    policy.maxBackoff = 3000;
+    communication.setPolicy(policy);
+
+    ASSERT_TRUE(enqueue(communication, Priority::URGENT, 1, now));
+    std::vector<unsigned long> attempts;
+    for(; now < 20000; now += 10) {
+        const size_t before = transport.batches.size();
+        communication.loop(now);
+        if(transport.batches.size() > before)
+            attempts.push_back(now);
+    }
+    ASSERT_EQ(attempts.size(), 4u);
+    EXPECT_EQ(attempts[1] - attempts[0], 1000ul);
+    EXPECT_EQ(attempts[2] - attempts[1], 2000ul);
+    EXPECT_EQ(attempts[3] - attempts[2], 3000ul); // Capped
+    EXPECT_EQ(communication.getQueueSize(), 0u);
+    EXPECT_EQ(communication.getStats().failures, 3u);
+
+    // Refused batches are not sent again
+    transport.results = {Result::REJECTED};
+    ASSERT_TRUE(enqueue(communication, Priority::URGENT, 2, now));
+    run(communication, now, 5000);
+    EXPECT_EQ(communication.getQueueSize(), 0u);
+    EXPECT_EQ(communication.getStats().dropped, 1u);
+    EXPECT_EQ(transport.batches.size(), 5u);
+}
+
+UTEST(communication, should_keep_the_queue_across_the_deep_sleep) {
+    static OswCommunication::Storage storage = {};
+    unsigned long now = 0;
+    FakeTransport transport(&now);
+    {
+        OswCommunication communication(storage);
+        for(int value = 0; value < 3; value++)
+            ASSERT_TRUE(enqueue(communication, Priority::IMPORTANT, value, now));
+        run(communication, now, 10000);
+    }
+    // "Wakes up" with millis() starting again - the sleep counts to the waiting time
+    now = 0;
+    OswCommunication communication(storage);
+    communication.addTransport(transport);
+    EXPECT_EQ(communication.getQueueSize(), 3u);
+    communication.advanceClock(15000);
+    run(communication, now, 4000);
+    EXPECT_EQ(transport.bringUps, 0u);
+    run(communication, now, 2000); // IMPORTANT waits 30 s
+    EXPECT_EQ(transport.bringUps, 1u);
+    run(communication, now, 1000);
+    EXPECT_EQ(communication.getQueueSize(), 0u);
+    ASSERT_EQ(transport.batches.size(), 1u);
+    EXPECT_NE(transport.batches[0].find("\"message_id\":3,"), std::string::npos);
+
+    // Garbage (like after a cold boot without zeroed memory) is an empty queue
+    memset(&storage, 0x5A, sizeof(storage));
+    storage.magic = 0x4F435131;
+    OswCommunication broken(storage);
+    EXPECT_EQ(broken.getQueueSize(), 0u);
+}
+
+UTEST(communication, should_make_room_for_more_important_messages) {
+    static OswCommunication::Storage storage = {};
+    unsigned long now = 0;
+    OswCommunication communication(storage);
+    const std::string large(1000, ' ');
+    auto enqueueLarge = [&](Priority priority) {
+        return communication.enqueue(MessageType::SYSTEM_STATUS, priority, large.c_str(), large.size(), 0, now);
+    };
+    ASSERT_TRUE(enqueueLarge(Priority::NORMAL));
+    ASSERT_TRUE(enqueueLarge(Priority::IMPORTANT));
+    EXPECT_FALSE(enqueueLarge(Priority::BACKGROUND)); // Nothing as unimportant to drop
+    EXPECT_TRUE(enqueueLarge(Priority::NORMAL)); // Newer data replaces the older one
+    EXPECT_TRUE(enqueueLarge(Priority::IMPORTANT)); // Drops the NORMAL one
+    EXPECT_FALSE(enqueueLarge(Priority::NORMAL));
+    EXPECT_FALSE(communication.enqueue(MessageType::SYSTEM_STATUS, Priority::URGENT, large.c_str(), OswCommunication::maxPayloadSize + 1, 0, now));
+    const OswCommunication::Stats stats = communication.getStats();
+    EXPECT_EQ(stats.evicted, 2u);
+    EXPECT_EQ(stats.refused, 3u);
+    EXPECT_EQ(communication.getQueueSize(), 2u);
+}
+
+UTEST(communication, should_stand_a_long_run_against_a_flaky_server) {
+    static OswCommunication::Storage storage = {};
+    unsigned long now = 0;
+    FakeTransport wifi(&now);
+    FakeTransport fallback(&now);
+    wifi.connectDelay = 3000;
+    fallback.connectDelay = 200;
+    OswCommunication communication(storage);
+    communication.addTransport(wifi);
+    communication.addTransport(fallback);
+    OswCommunication::Policy policy;
+    policy.connectTimeout = 2000; // The WiFi never makes it, the fallback does
+    communication.setPolicy(policy);
+
+    // Two hours of sensor data every 2 s, the odd alarm, and a server failing every third request
+    fallback.failEvery = 3;
+    std::mt19937 random(3);
+    uint32_t refused = 0;
+    for(unsigned long second = 0; second < 2 * 3600; second++) {
+        if(second % 2 == 0 and !enqueue(communication, Priority::NORMAL, (int) second, now))
+            ++refused;
+        if(random() % 900 == 0 and !enqueue(communication, Priority::URGENT, -1, now))
+            ++refused;
+        run(communication, now, 1000, 100);
+    }
+    run(communication, now, 3600000, 1000);
+
+    const OswCommunication::Stats stats = communication.getStats();
+    EXPECT_EQ(refused, 0u);
+    EXPECT_EQ(communication.getQueueSize(), 0u);
+    EXPECT_EQ(stats.queued, stats.sent + stats.dropped + stats.evicted);
+    EXPECT_EQ(stats.dropped + stats.evicted, 0u);
+    EXPECT_EQ(wifi.bringUps, fallback.bringUps);
+    // Batched: far fewer attempts than messages, and the radio was mostly off
+    EXPECT_LT((stats.batches + stats.failures) * 10, stats.sent);
+    EXPECT_LT(stats.radioTime * 10, now);
+    // Compressed (and still the same content)
+    EXPECT_LT(stats.bytes * 2, stats.rawBytes);
+    size_t messages = 0;
+    for(const std::string& batch : fallback.batches) {
+        EXPECT_EQ(batch.rfind("{\"device_id\":\"OSW\",\"messages\":[{\"message_id\":", 0), 0u);
+        EXPECT_EQ(batch.substr(batch.size() - 3), "}]}");
+        for(size_t at = batch.find("\"message_id\""); at != std::string::npos; at = batch.find("\"message_id\"", at + 1))
+            ++messages;
+    }
+    EXPECT_GE(messages, (size_t) stats.sent);
+}
@@ -0,0 +1,178 @@
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "utest.h"
+
+#include <OswCompanionMessage.h>
+#include <OswMemoryTracker.h>
+
+using Field = OswCompanionReceiver::Field;
+
+static std::vector<uint8_t> encode(OswCompanionMessage::Type type, uint32_t uid, uint32_t timestamp, const std::vector<std::pair<Field, std::string>>& fields) {
+    std::vector<uint8_t> message = {OswCompanionReceiver::magic, 0, 0, (uint8_t) type};
+    for(uint32_t value : {uid, timestamp})
+        for(int shift = 0; shift < 32; shift += 8)
+            message.push_back((uint8_t) (value >> shift));
+    for(const auto& [tag, text] : fields) {
+        message.push_back((uint8_t) tag);
+        message.push_back((uint8_t) text.size());
+        message.insert(message.end(), text.begin(), text.end());
+    }
+    message[1] = (uint8_t) (message.size() - 3);
+    message[2] = (uint8_t) ((message.size() - 3) >> 8);
+    return message;
+}
+
+static std::vector<uint8_t> chatMessage(uint32_t uid) {
+    return encode(OswCompanionMessage::Type::NOTIFICATION, uid, 1700000000 + uid, {
+        {Field::APP, "Chat"}, {Field::TITLE, "Alice"}, {Field::CONTENTS, "Are you there? " + std::to_string(uid)},
+        {Field::ACTION, "Reply"}, {Field::ACTION, "Mute"}
+    });
+}
+
+UTEST(companionMessage, should_parse_binary_messages_in_place) {
+    OswCompanionReceiver receiver;
+    std::vector<OswCompanionMessage> messages;
+    const std::vector<uint8_t> data = chatMessage(42);
+    receiver.feed(data.data(), data.size(), [&](const OswCompanionMessage& message) {
+        messages.push_back(message);
+        EXPECT_EQ(message.uid, 42u);
+        EXPECT_EQ(message.timestamp, 1700000042u);
+        EXPECT_TRUE(message.app == "Chat");
+        EXPECT_TRUE(message.title == "Alice");
+        EXPECT_TRUE(message.contents == "Are you there? 42");
+        ASSERT_EQ(message.actionCount, 2);
+        EXPECT_TRUE(message.actions[1] == "Mute");
+    });
+    EXPECT_EQ(messages.size(), 1u);
+
+    // Limits, unknown tags and a multi-byte character at the cut
+    const std::string longTitle = std::string(63, 'x') + "\xC3\xA4" + "yyy";
+    const std::vector<uint8_t> bounded = encode(OswCompanionMessage::Type::NOTIFICATION, 1, 0, {
+        {Field::TITLE, longTitle}, {(Field) 99, "from the future"}, {Field::ACTION, "1"}, {Field::ACTION, "2"}, {Field::ACTION, "3"}, {Field::ACTION, "4"}
+    });
+    OswCompanionMessage message;
+    ASSERT_TRUE(OswCompanionReceiver::parse(bounded.data(), bounded.size(), message));
+    EXPECT_EQ(message.title.size(), 63u);
+    EXPECT_EQ(message.actionCount, OswCompanionMessage::maxActions);
+    EXPECT_TRUE(message.app.empty());
+
+    // A field running past the end
+    std::vector<uint8_t> broken = chatMessage(1);
+    broken[broken.size() - 5] = 200;
+    EXPECT_FALSE(OswCompanionReceiver::parse(broken.data(), broken.size(), message));
+}
+
+UTEST(companionMessage, should_reassemble_split_and_batched_writes) {
+    OswCompanionReceiver receiver;
+    std::vector<uint8_t> stream;
+    for(uint32_t uid = 0; uid < 20; uid++) {
+        const std::vector<uint8_t> message = chatMessage(uid);
+        stream.insert(stream.end(), message.begin(), message.end());
+    }
+    // One too large for the buffer in between, it must not take the following ones along
+    std::vector<uint8_t> large = encode(OswCompanionMessage::Type::NOTIFICATION, 999, 0, {});
+    large.resize(OswCompanionReceiver::bufferSize + 100, 0);
+    large[1] = (uint8_t) (large.size() - 3);
+    large[2] = (uint8_t) ((large.size() - 3) >> 8);
+    stream.insert(stream.begin() + chatMessage(0).size() * 10, large.begin(), large.end());
+
+    std::vector<uint32_t> uids;
+    std::mt19937 random(1);
+    for(size_t position = 0; position < stream.size();) {
+        const size_t length = std::min<size_t>(1 + random() % 200, stream.size() - position);
+        receiver.feed(stream.data() + position, length, [&](const OswCompanionMessage& message) {
+            uids.push_back(message.uid);
+        });
+        position += length;
+    }
+    ASSERT_EQ(uids.size(), 20u);
+    for(uint32_t uid = 0; uid < 20; uid++)
+        EXPECT_EQ(uids[uid], uid);
+    EXPECT_EQ(receiver.getStats().messages, 20u);
+    EXPECT_EQ(receiver.getStats().dropped, 1u);
+}
+
+UTEST(companionMessage, should_understand_the_json_of_old_clients) {
+    OswCompanionReceiver receiver;
+    const std::string json = "{\"uid\":7,\"app\":\"Mail\",\"contents\":\"Hello\",\"unknown\":[1,2,3],\"actions\":[\"Archive\"]}";
+    bool received = false;
+    receiver.feed((const uint8_t*) json.data(), json.size(), [&](const OswCompanionMessage& message) {
+        received = true;
+        EXPECT_EQ(message.uid, 7u);
+        EXPECT_TRUE(message.app == "Mail");
+        EXPECT_TRUE(message.contents == "Hello");
+        EXPECT_TRUE(message.title.empty());
+        ASSERT_EQ(message.actionCount, 1);
+        EXPECT_TRUE(message.actions[0] == "Archive");
+    });
+    EXPECT_TRUE(received);
+
+    // ...and a binary message right after still works
+    const std::vector<uint8_t> data = chatMessage(8);
+    received = false;
+    receiver.feed(data.data(), data.size(), [&](const OswCompanionMessage& message) {
+        received = message.uid == 8;
+    });
+    EXPECT_TRUE(received);
+}
+
+UTEST(companionMessage, should_survive_fuzzed_input_without_allocating) {
+    OswCompanionReceiver receiver;
+    std::mt19937 random(2);
+    std::vector<std::vector<uint8_t>> inputs;
+    for(int i = 0; i < 5000; i++) {
+        std::vector<uint8_t> input = chatMessage(i);
+        switch(i % 4) {
+        case 0: // Random bytes, some starting like a message
+            input.resize(random() % 300);
+            for(uint8_t& byte : input)
+                byte = (uint8_t) random();
+            if(!input.empty() and i % 8 == 0)
+                input[0] = OswCompanionReceiver::magic;
+            break;
+        case 1: // Flipped bytes
+            for(int flips = 1 + random() % 4; flips > 0; flips--)
+                input[random() % input.size()] ^= (uint8_t) (1 + random() % 255);
+            break;
+        case 2: // Truncated
+            input.resize(random() % input.size());
+            break;
+        default: // Intact
+            break;
+        }
+        inputs.push_back(input);
+    }
+
+    const uint8_t* const low = (const uint8_t*) &receiver;
+    const uint8_t* const high = low + sizeof(receiver);
+    auto inside = [&](std::string_view text) {
+        return text.empty() or ((const uint8_t*) text.data() >= low and (const uint8_t*) text.data() + text.size() <= high);
+    };
+    size_t bytes = 0;
+    uint32_t delivered = 0;
+    OswMemoryTracker& tracker = OswMemoryTracker::getInstance();
+    const uint32_t allocationsBefore = tracker.getStats(OswMemoryTag::NOTIFICATIONS).allocations;
+    const auto start = std::chrono::steady_clock::now();
+    {
+        OswMemoryScope scope(OswMemoryTag::NOTIFICATIONS);
+        for(const std::vector<uint8_t>& input : inputs) {
+            bytes += input.size();
+            receiver.feed(input.data(), input.size(), [&](const OswCompanionMessage& message) {
+                ++delivered;
+                EXPECT_TRUE(inside(message.app) and message.app.size() <= OswCompanionReceiver::maxAppLength);
+                EXPECT_TRUE(inside(message.title) and message.title.size() <= OswCompanionReceiver::maxTitleLength);
+                EXPECT_TRUE(inside(message.contents) and message.contents.size() <= OswCompanionReceiver::maxContentsLength);
+                EXPECT_LE(message.actionCount, OswCompanionMessage::maxActions);
+            });
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(tracker.getStats(OswMemoryTag::NOTIFICATIONS).allocations, allocationsBefore);
+    EXPECT_GT(delivered, 0u);
+    EXPECT_EQ(receiver.getStats().messages, delivered);
+    // BLE delivers at most ~100 kB/s - the parser has to keep up with it by far, even in a debug build
+    EXPECT_GT(bytes / seconds, 10.0 * 100 * 1000);
+}
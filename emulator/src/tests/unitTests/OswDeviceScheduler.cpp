@@ -0,0 +1,197 @@
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "utest.h"
+
+#include <Arduino.h>
+#include <devices/OswDeviceScheduler.h>
+
+#include "../../../include/FakeClock.h"
+
+class FakeDevice : public OswDevice {
+  public:
+    FakeDevice(const char* name, unsigned long interval, unsigned int cost) : name(name), interval(interval), cost(cost) {};
+    unsigned int updates = 0;
+
+    virtual void setup() override {};
+    virtual void update() override {
+        ++this->updates;
+    };
+    virtual void reset() override {};
+    virtual void stop() override {};
+    virtual const char* getName() override {
+        return this->name;
+    };
+    virtual unsigned long getUpdateInterval() override {
+        return this->interval;
+    };
+    virtual unsigned int getUpdateCost() override {
+        return this->cost;
+    };
+
+  private:
+    const char* name;
+    const unsigned long interval;
+    const unsigned int cost;
+};
+
+/**
+ * Fake device on a bus, which notices when it is talked to from two sides at once
+ */
+class BusDevice : public FakeDevice {
+  public:
+    BusDevice() : FakeDevice("FakeBus", 0, 0) {};
+    std::atomic<unsigned int> collisions = 0;
+
+    virtual void update() override {
+        FakeDevice::update();
+        this->transfer();
+    };
+    // Like BMA400::resetStepCount(), called from outside of the scheduler
+    void command() {
+        this->transfer();
+    };
+
+  private:
+    std::atomic<bool> busy = false;
+
+    void transfer() {
+        if(this->busy.exchange(true))
+            ++this->collisions;
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+        this->busy = false;
+    };
+};
+
+/**
+ * Fake device with two interfaces, so it is registered twice (like the DS3231MZ as time and temperature provider)
+ */
+class FakeFirstInterface : public OswDevice {};
+class FakeSecondInterface : public OswDevice {};
+class FakeTwoInterfaceDevice : public FakeFirstInterface, public FakeSecondInterface {
+  public:
+    unsigned int updates = 0;
+
+    virtual void setup() override {};
+    virtual void update() override {
+        ++this->updates;
+    };
+    virtual void reset() override {};
+    virtual void stop() override {};
+    virtual const char* getName() override {
+        return "FakeTwoInterfaces";
+    };
+};
+
+UTEST(deviceScheduler, should_update_at_the_device_interval) {
+    FakeDevice slow("FakeSlow", 100, 0);
+    FakeDevice fast("FakeFast", 0, 0);
+    OswDeviceScheduler scheduler;
+
+    scheduler.updateDue(1000); // Never updated devices are due right away
+    EXPECT_EQ(slow.updates, 1u);
+    EXPECT_EQ(fast.updates, 1u);
+    EXPECT_EQ(slow.getLastUpdate(), 1000ul);
+    scheduler.updateDue(1050);
+    EXPECT_EQ(slow.updates, 1u);
+    EXPECT_EQ(fast.updates, 2u);
+    scheduler.updateDue(1105);
+    EXPECT_EQ(slow.updates, 2u);
+    scheduler.updateDue(1200); // Keeps the cadence, even if the last update was late
+    EXPECT_EQ(slow.updates, 3u);
+    scheduler.updateDue(1650); // ...but does not try to catch up on missed updates
+    scheduler.updateDue(1700);
+    EXPECT_EQ(slow.updates, 4u);
+
+    scheduler.updateAll(1710);
+    EXPECT_EQ(slow.updates, 5u);
+    EXPECT_EQ(fast.updates, 7u);
+}
+
+UTEST(deviceScheduler, should_spread_updates_over_the_budget) {
+    FakeDevice a("FakeA", 100, 600);
+    FakeDevice b("FakeB", 100, 600);
+    FakeDevice c("FakeC", 100, 600);
+    auto total = [&]() -> unsigned int { return a.updates + b.updates + c.updates; };
+    OswDeviceScheduler scheduler(1000);
+
+    scheduler.updateDue(0);
+    EXPECT_EQ(total(), 3u);
+    EXPECT_EQ(scheduler.updateDue(100), 0ul); // The deferred ones are due already
+    EXPECT_EQ(total(), 4u);
+    EXPECT_EQ(scheduler.getDeferredUpdates(), 2u);
+    scheduler.updateDue(110);
+    scheduler.updateDue(120);
+    EXPECT_EQ(total(), 6u);
+    EXPECT_EQ(a.updates, 2u);
+    EXPECT_EQ(b.updates, 2u);
+    EXPECT_EQ(c.updates, 2u);
+
+    // Everything late by a whole interval ignores the budget
+    scheduler.updateDue(400);
+    EXPECT_EQ(total(), 9u);
+}
+
+UTEST(deviceScheduler, should_boost_temporarily) {
+    FakeClock::enable(0);
+    FakeDevice compass("FakeCompass", 1000, 0);
+    OswDeviceScheduler scheduler;
+    scheduler.updateDue(millis());
+    EXPECT_EQ(compass.updates, 1u);
+    EXPECT_EQ(scheduler.updateDue(millis()), 1000ul);
+
+    compass.boost(50, 200);
+    EXPECT_EQ(OswDeviceScheduler::getInterval(&compass, millis()), 50ul);
+    EXPECT_EQ(scheduler.updateDue(millis()), 50ul);
+    while(millis() < 200) {
+        FakeClock::advance(10 * 1000);
+        scheduler.updateDue(millis());
+    }
+    EXPECT_EQ(compass.updates, 4u); // At 0, 50, 100 and 150 - the boost ended at 200
+    EXPECT_EQ(OswDeviceScheduler::getInterval(&compass, millis()), 1000ul);
+    FakeClock::advance(500 * 1000);
+    scheduler.updateDue(millis());
+    EXPECT_EQ(compass.updates, 4u);
+    FakeClock::disable();
+}
+
+UTEST(deviceScheduler, should_keep_the_bus_for_others_holding_its_lock) {
+    BusDevice device;
+    OswDeviceScheduler scheduler;
+    std::atomic<bool> running = true;
+    std::thread task([&]() {
+        // As the task on core 0 does
+        for(unsigned long now = 0; running; ++now)
+            scheduler.updateDue(now);
+    });
+    while(device.updates == 0)
+        std::this_thread::yield();
+    for(int i = 0; i < 50; i++) {
+        std::lock_guard<std::mutex> guard(scheduler.getBusLock());
+        device.command();
+    }
+    running = false;
+    task.join();
+    EXPECT_GT(device.updates, 0u);
+    EXPECT_EQ(device.collisions, 0u);
+}
+
+UTEST(deviceScheduler, should_tell_devices_apart_by_object) {
+    FakeDevice first("FakeTwin", 1000, 0);
+    FakeDevice second("FakeTwin", 1000, 0);
+    FakeTwoInterfaceDevice both;
+    OswDeviceScheduler scheduler;
+
+    scheduler.updateDue(0);
+    EXPECT_EQ(first.updates, 1u); // Same name, but still two devices
+    EXPECT_EQ(second.updates, 1u);
+    EXPECT_EQ(both.updates, 1u); // Two registrations, but only one device
+
+    first.boost(50, 200);
+    EXPECT_EQ(OswDeviceScheduler::getInterval(&first, 0), 50ul);
+    EXPECT_EQ(OswDeviceScheduler::getInterval(&second, 0), 1000ul);
+    static_cast<FakeSecondInterface&>(both).boost(50, 200);
+    EXPECT_EQ(OswDeviceScheduler::getInterval(static_cast<FakeFirstInterface*>(&both), 0), 50ul);
+}
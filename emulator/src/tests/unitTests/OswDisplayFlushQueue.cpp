@@ -0,0 +1,189 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "utest.h"
+
+#include "../../../include/OswDisplayFlushQueue.h"
+
+/**
+ * Fake display bus, which takes its time for every transfer and records what it received - while held, transfers do
+ * not complete until released
+ */
+class SlowDisplay : public Arduino_G {
+  public:
+    struct Received {
+        int16_t y;
+        uint16_t firstPixel;
+        bool intact; // All pixels of the transfer still had the same value after the "transfer"
+    };
+
+    std::mutex lock;
+    std::vector<Received> received;
+    std::atomic<int> busy = 0;
+    const std::chrono::milliseconds transferTime;
+    bool held = false;
+    std::condition_variable released;
+
+    SlowDisplay(std::chrono::milliseconds transferTime = std::chrono::milliseconds(5)) : Arduino_G(4, 4), transferTime(transferTime) {};
+
+    void begin(int32_t speed = 0) override {};
+    void drawBitmap(int16_t x, int16_t y, uint8_t* bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg) override {};
+    void drawIndexedBitmap(int16_t x, int16_t y, uint8_t* bitmap, uint16_t* color_index, int16_t w, int16_t h) override {};
+    void draw3bitRGBBitmap(int16_t x, int16_t y, uint8_t* bitmap, int16_t w, int16_t h) override {};
+    void draw24bitRGBBitmap(int16_t x, int16_t y, uint8_t* bitmap, int16_t w, int16_t h) override {};
+    void draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t* bitmap, int16_t w, int16_t h) override {
+        ++this->busy;
+        const uint16_t first = bitmap[0];
+        std::this_thread::sleep_for(this->transferTime);
+        std::unique_lock<std::mutex> guard(this->lock);
+        this->released.wait(guard, [this]() {
+            return !this->held;
+        });
+        bool intact = true;
+        for(int i = 0; i < w * h; i++)
+            intact = intact and bitmap[i] == first;
+        this->received.push_back({y, first, intact});
+        --this->busy;
+    };
+
+    void hold() {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->held = true;
+    };
+    void release() {
+        {
+            std::lock_guard<std::mutex> guard(this->lock);
+            this->held = false;
+        }
+        this->released.notify_all();
+    };
+    size_t getReceived() {
+        std::lock_guard<std::mutex> guard(this->lock);
+        return this->received.size();
+    };
+};
+
+static void submitChunk(OswDisplayFlushQueue& queue, int16_t y, uint16_t color, bool endOfFrame) {
+    uint16_t* buffer = queue.acquire();
+    for(int i = 0; i < 4; i++)
+        buffer[i] = color;
+    queue.submit(buffer, 0, y, 4, 1, endOfFrame);
+}
+
+UTEST(displayFlushQueue, should_transfer_chunks_in_order) {
+    SlowDisplay display;
+    {
+        OswDisplayFlushQueue queue(&display, 2, 4);
+        for(int16_t y = 0; y < 4; y++)
+            submitChunk(queue, y, y, y == 3);
+        queue.waitIdle();
+        EXPECT_EQ(queue.getFramesDone(), 1U);
+    }
+
+    ASSERT_EQ(display.received.size(), (size_t) 4);
+    for(int16_t y = 0; y < 4; y++) {
+        EXPECT_EQ(display.received[y].y, y);
+        EXPECT_EQ(display.received[y].firstPixel, (uint16_t) y);
+    }
+}
+
+UTEST(displayFlushQueue, should_not_reuse_buffers_in_flight) {
+    SlowDisplay display;
+    OswDisplayFlushQueue queue(&display, 2, 4);
+    // Rendering is way faster than the display, so acquire() must block until a buffer was sent
+    for(int16_t y = 0; y < 16; y++)
+        submitChunk(queue, y % 4, 0x1000 + y, y % 4 == 3);
+    queue.waitIdle();
+
+    ASSERT_EQ(display.received.size(), (size_t) 16);
+    for(int16_t y = 0; y < 16; y++) {
+        EXPECT_TRUE(display.received[y].intact);
+        EXPECT_EQ(display.received[y].firstPixel, (uint16_t) (0x1000 + y));
+    }
+    EXPECT_EQ(queue.getFramesDone(), 4U);
+}
+
+UTEST(displayFlushQueue, should_render_while_transferring) {
+    SlowDisplay display(std::chrono::milliseconds(0));
+    display.hold();
+    OswDisplayFlushQueue queue(&display, 2, 4);
+    // Both submits return while the first transfer can not complete, as the second buffer is free for the next chunk
+    submitChunk(queue, 0, 1, false);
+    submitChunk(queue, 1, 2, true);
+    EXPECT_EQ(display.getReceived(), (size_t) 0);
+    EXPECT_EQ(queue.getFramesDone(), 0U);
+    display.release();
+
+    queue.waitIdle();
+    EXPECT_EQ(display.busy.load(), 0);
+    EXPECT_EQ(display.received.size(), (size_t) 2);
+}
+
+UTEST(displayFlushQueue, should_signal_completed_frames) {
+    SlowDisplay display;
+    std::atomic<int> framesSignalled = 0;
+    size_t receivedAtSignal = 0;
+    OswDisplayFlushQueue queue(&display, 2, 4);
+    queue.setFrameDoneCallback([&]() {
+        ++framesSignalled;
+        std::lock_guard<std::mutex> guard(display.lock);
+        receivedAtSignal = display.received.size();
+    });
+
+    for(int16_t y = 0; y < 4; y++)
+        submitChunk(queue, y, 0, y == 3);
+    queue.waitIdle();
+
+    EXPECT_EQ(framesSignalled.load(), 1);
+    EXPECT_EQ(receivedAtSignal, (size_t) 4); // Only after the last chunk reached the display
+}
+
+UTEST(displayFlushQueue, should_signal_frames_without_pixels) {
+    SlowDisplay display;
+    std::atomic<int> framesSignalled = 0;
+    OswDisplayFlushQueue queue(&display, 2, 4);
+    queue.setFrameDoneCallback([&]() {
+        ++framesSignalled;
+    });
+
+    // E.g. a flush limited to no rows at all: still in order with the transfers before
+    submitChunk(queue, 0, 0, false);
+    queue.submitFrameEnd();
+    queue.waitIdle();
+
+    EXPECT_EQ(framesSignalled.load(), 1);
+    EXPECT_EQ(queue.getFramesDone(), 1U);
+    EXPECT_EQ(display.getReceived(), (size_t) 1);
+}
+
+UTEST(displayFlushQueue, should_queue_unowned_frames_at_once) {
+    SlowDisplay display(std::chrono::milliseconds(0));
+    display.hold();
+    OswDisplayFlushQueue queue(&display, 2, 4, 6);
+    // Like the front frame of a double buffered canvas: no copies and no waiting for the transfers
+    uint16_t frame[6][4];
+    for(int16_t y = 0; y < 6; y++) {
+        for(int i = 0; i < 4; i++)
+            frame[y][i] = 0x2000 + y;
+        queue.submitUnowned(frame[y], 0, y, 4, 1, y == 5);
+    }
+    EXPECT_EQ(display.getReceived(), (size_t) 0); // All queued, none transferred yet
+    display.release();
+
+    // The own buffers were never handed out, so they are still both free
+    submitChunk(queue, 6, 0x3000, true);
+    submitChunk(queue, 7, 0x3001, true);
+    queue.waitIdle();
+
+    ASSERT_EQ(display.received.size(), (size_t) 8);
+    for(int16_t y = 0; y < 6; y++) {
+        EXPECT_EQ(display.received[y].y, y);
+        EXPECT_EQ(display.received[y].firstPixel, (uint16_t) (0x2000 + y));
+    }
+    EXPECT_EQ(display.received[7].firstPixel, 0x3001);
+    EXPECT_EQ(queue.getFramesDone(), 3U);
+}
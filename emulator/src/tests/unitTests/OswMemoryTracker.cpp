@@ -0,0 +1,73 @@
+#include "utest.h"
+
+#include "../../../include/OswMemoryTracker.h"
+
+UTEST(memoryTracker, should_account_tagged_blocks) {
+    OswMemoryTracker& tracker = OswMemoryTracker::getInstance();
+    const OswMemoryTracker::TagStats before = tracker.getStats(OswMemoryTag::TILES);
+
+    void* block = OswMemoryTracker::allocate(1000, OswMemoryTag::TILES);
+    ASSERT_TRUE(block != nullptr);
+    EXPECT_EQ(tracker.getStats(OswMemoryTag::TILES).current, before.current + 1000);
+    EXPECT_EQ(tracker.getStats(OswMemoryTag::TILES).allocations, before.allocations + 1);
+
+    // The tag and size come with the block
+    block = OswMemoryTracker::reallocate(block, 3000);
+    ASSERT_TRUE(block != nullptr);
+    memset(block, 0xAB, 3000);
+    EXPECT_EQ(tracker.getStats(OswMemoryTag::TILES).current, before.current + 3000);
+    block = OswMemoryTracker::reallocate(block, 500);
+    EXPECT_EQ(tracker.getStats(OswMemoryTag::TILES).current, before.current + 500);
+    EXPECT_GE(tracker.getStats(OswMemoryTag::TILES).peak, before.current + 3000);
+
+    OswMemoryTracker::release(block);
+    EXPECT_EQ(tracker.getStats(OswMemoryTag::TILES).current, before.current);
+    OswMemoryTracker::release(nullptr);
+    EXPECT_EQ(tracker.getStats(OswMemoryTag::TILES).frees, before.frees + 3);
+
+    tracker.resetPeaks();
+    EXPECT_EQ(tracker.getStats(OswMemoryTag::TILES).peak, before.current);
+}
+
+UTEST(memoryTracker, should_nest_scopes) {
+    EXPECT_EQ(OswMemoryTracker::getCurrentTag(), OswMemoryTag::OTHER);
+    EXPECT_EQ(OswMemoryTracker::getCurrentTag(OswMemoryTag::DISPLAY), OswMemoryTag::DISPLAY);
+    {
+        OswMemoryScope outer(OswMemoryTag::NOTIFICATIONS);
+        EXPECT_EQ(OswMemoryTracker::getCurrentTag(OswMemoryTag::DISPLAY), OswMemoryTag::NOTIFICATIONS);
+        {
+            OswMemoryScope inner(OswMemoryTag::TILES);
+            EXPECT_EQ(OswMemoryTracker::getCurrentTag(), OswMemoryTag::TILES);
+        }
+        EXPECT_EQ(OswMemoryTracker::getCurrentTag(), OswMemoryTag::NOTIFICATIONS);
+    }
+    EXPECT_EQ(OswMemoryTracker::getCurrentTag(), OswMemoryTag::OTHER);
+}
+
+UTEST(memoryTracker, should_account_json_documents) {
+    OswMemoryTracker& tracker = OswMemoryTracker::getInstance();
+    const size_t before = tracker.getStats(OswMemoryTag::JSON).current;
+    {
+        OswJsonDocument doc(512);
+        doc["hello"] = "world";
+        EXPECT_GE(tracker.getStats(OswMemoryTag::JSON).current, before + 512);
+    }
+    EXPECT_EQ(tracker.getStats(OswMemoryTag::JSON).current, before);
+}
+
+UTEST(memoryTracker, should_keep_the_latest_samples) {
+    OswMemoryTracker::HeapSample sample;
+    sample.free = 1000;
+    sample.largestBlock = 250;
+    EXPECT_EQ(OswMemoryTracker::getFragmentation(sample), 75);
+    sample.free = 0;
+    EXPECT_EQ(OswMemoryTracker::getFragmentation(sample), 0);
+
+    OswMemoryTracker& tracker = OswMemoryTracker::getInstance();
+    for(size_t i = 0; i < OswMemoryTracker::historyLength + 3; ++i)
+        tracker.sampleHeap();
+    OswMemoryTracker::HeapSample samples[OswMemoryTracker::historyLength + 3];
+    EXPECT_EQ(tracker.getHistory(samples, OswMemoryTracker::historyLength + 3), OswMemoryTracker::historyLength);
+    EXPECT_EQ(tracker.getHistory(samples, 2), (size_t) 2);
+    EXPECT_GE(samples[1].time, samples[0].time);
+}
@@ -0,0 +1,100 @@
+#include <string>
+
+#include "utest.h"
+
+#include "../../../include/OswNotificationStore.h"
+
+typedef OswNotificationStore<4, 32, 8, 10> TestStore;
+
+UTEST(notificationStore, should_keep_texts_and_insertion_order) {
+    TestStore store;
+    auto first = store.add(100, "pub", "first");
+    auto second = store.add(50, "", "second");
+
+    ASSERT_NE(first, TestStore::NONE);
+    ASSERT_NE(second, TestStore::NONE);
+    EXPECT_EQ(store.size(), 2U);
+    EXPECT_TRUE(store.getPublisher(first) == "pub");
+    EXPECT_TRUE(store.getMessage(first) == "first");
+    EXPECT_TRUE(store.getMessage(second) == "second");
+    EXPECT_EQ(store.first(), first);
+    EXPECT_EQ(store.next(first), second);
+    EXPECT_EQ(store.next(second), TestStore::NONE);
+    EXPECT_EQ(store.find(store[second].id), second);
+}
+
+UTEST(notificationStore, should_reject_entries_when_full) {
+    TestStore store;
+    for (int i = 0; i < 4; ++i)
+        ASSERT_NE(store.add(i, "", ""), TestStore::NONE);
+
+    EXPECT_TRUE(store.full());
+    EXPECT_EQ(store.add(42, "", ""), TestStore::NONE);
+
+    store.remove(store.first());
+    EXPECT_NE(store.add(42, "", ""), TestStore::NONE);
+}
+
+UTEST(notificationStore, should_compact_arena_when_out_of_space) {
+    TestStore store;
+    auto a = store.add(0, "", "aaaaaaaaaa");
+    auto b = store.add(0, "", "bbbbbbbbbb");
+    store.add(0, "", "cccccccccc");
+    store.remove(a);
+    store.remove(b);
+
+    // Only fits after the gaps of "a" and "b" were closed
+    auto d = store.add(0, "", "dddddddddddddddddddd");
+    ASSERT_NE(d, TestStore::NONE);
+    EXPECT_TRUE(store.getMessage(store.first()) == "cccccccccc");
+    EXPECT_TRUE(store.getMessage(d) == "dddddddddddddddddddd");
+    EXPECT_EQ(store.getFreeText(), 2U);
+}
+
+UTEST(notificationStore, should_truncate_texts_exceeding_the_arena) {
+    TestStore store;
+    auto index = store.add(0, "publisher", std::string(64, 'x'));
+
+    ASSERT_NE(index, TestStore::NONE);
+    EXPECT_TRUE(store.getPublisher(index) == "publisher");
+    EXPECT_EQ(store.getMessage(index).size(), 32U - 9U);
+    EXPECT_EQ(store.getFreeText(), 0U);
+}
+
+UTEST(notificationStore, should_return_due_entries_in_time_order) {
+    TestStore store;
+    store.getDue(0); // Start the wheel
+    auto late = store.add(250, "", "late");
+    auto early = store.add(35, "", "early");
+    auto later = store.add(1000, "", "later"); // Shares a bucket with "early", but one revolution later
+
+    EXPECT_EQ(store.getDue(34), TestStore::NONE);
+    EXPECT_EQ(store.getDue(40), early);
+    store.remove(early);
+    EXPECT_EQ(store.getDue(249), TestStore::NONE);
+    EXPECT_EQ(store.getDue(300), late);
+    store.remove(late);
+    EXPECT_EQ(store.getDue(999), TestStore::NONE);
+    EXPECT_EQ(store.getDue(1000), later);
+}
+
+UTEST(notificationStore, should_fire_overdue_entries_immediately) {
+    TestStore store;
+    store.getDue(1000);
+    auto overdue = store.add(5, "", "overdue");
+
+    EXPECT_EQ(store.getDue(1000), overdue);
+}
+
+UTEST(notificationStore, should_find_rescheduled_entries_at_their_new_time) {
+    TestStore store;
+    store.getDue(0);
+    auto index = store.add(20, "", "repeating");
+    const auto id = store[index].id;
+
+    EXPECT_EQ(store.getDue(25), index);
+    store.reschedule(index, 500);
+    EXPECT_EQ(store.getDue(30), TestStore::NONE);
+    EXPECT_EQ(store.getDue(500), index);
+    EXPECT_EQ(store[index].id, id);
+}
@@ -0,0 +1,260 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utest.h"
+
+#include <OswOta.h>
+
+static std::string toHex(const OswSha256::Digest& digest) {
+    static const char digits[] = "0123456789abcdef";
+    std::string text;
+    for(uint8_t byte : digest) {
+        text += digits[byte >> 4];
+        text += digits[byte & 0xf];
+    }
+    return text;
+}
+
+static std::vector<uint8_t> randomImage(size_t size) {
+    std::mt19937 random(42);
+    std::vector<uint8_t> image(size);
+    for(uint8_t& byte : image)
+        byte = (uint8_t) random();
+    return image;
+}
+
+static OswOta::Manifest manifestOf(const std::vector<uint8_t>& image, const std::string& key) {
+    OswOta::Manifest manifest;
+    std::string text = std::to_string(image.size()) + ";" + toHex(OswSha256::hash(image.data(), image.size()));
+    if(!key.empty())
+        text += ";" + toHex(OswSha256::hmac((const uint8_t*) key.data(), key.size(), (const uint8_t*) text.data(), text.size()));
+    manifest.parse(text);
+    return manifest;
+}
+
+/**
+ * Fake flash, which takes its time for every write and keeps what it got
+ */
+class FakeFlash : public OswOta::Sink {
+  public:
+    std::mutex lock;
+    std::vector<uint8_t> data;
+    std::chrono::milliseconds writeTime = std::chrono::milliseconds(0);
+    std::atomic<bool> inWrite = false;
+    int failAfter = -1; // Writes which succeed before all fail
+    int writes = 0;
+    bool begun = false;
+    size_t size = 0; // As announced to begin()
+    bool committed = false;
+    int aborts = 0;
+
+    bool begin(size_t size) override {
+        this->begun = true;
+        this->size = size;
+        return true;
+    };
+    bool write(const uint8_t* data, size_t length) override {
+        this->inWrite = true;
+        std::this_thread::sleep_for(this->writeTime);
+        this->inWrite = false;
+        std::lock_guard<std::mutex> guard(this->lock);
+        if(this->failAfter >= 0 and this->writes >= this->failAfter)
+            return false;
+        ++this->writes;
+        this->data.insert(this->data.end(), data, data + length);
+        return true;
+    };
+    bool commit() override {
+        this->committed = true;
+        return true;
+    };
+    void abort() override {
+        ++this->aborts;
+    };
+    std::string getError() override {
+        return "flash broken";
+    };
+};
+
+/**
+ * Fake download, which takes its time for every read - and notices if the flash wrote meanwhile
+ */
+class FakeDownload : public OswOta::Source {
+  public:
+    const std::vector<uint8_t>& image;
+    const FakeFlash& flash;
+    size_t position = 0;
+    std::chrono::milliseconds readTime;
+    bool overlapped = false; // A read() ran while the flash was in write()
+
+    FakeDownload(const std::vector<uint8_t>& image, const FakeFlash& flash, std::chrono::milliseconds readTime) : image(image), flash(flash), readTime(readTime) {};
+    int read(uint8_t* buffer, size_t length) override {
+        if(this->position == this->image.size())
+            return -1;
+        this->overlapped |= this->flash.inWrite;
+        std::this_thread::sleep_for(this->readTime);
+        this->overlapped |= this->flash.inWrite;
+        length = std::min(length, this->image.size() - this->position);
+        memcpy(buffer, this->image.data() + this->position, length);
+        this->position += length;
+        return (int) length;
+    };
+};
+
+UTEST(ota, should_hash_like_sha256) {
+    const char* abc = "abc";
+    EXPECT_STREQ("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", toHex(OswSha256::hash((const uint8_t*) abc, 3)).c_str());
+    EXPECT_STREQ("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855", toHex(OswSha256::hash(nullptr, 0)).c_str());
+
+    // Fed in odd pieces, across the block boundaries
+    const std::vector<uint8_t> image = randomImage(1000);
+    OswSha256 sha;
+    for(size_t position = 0, piece = 1; position < image.size(); position += piece, piece = piece * 3 % 97 + 1)
+        sha.update(image.data() + position, std::min(piece, image.size() - position));
+    EXPECT_TRUE(OswSha256::equals(OswSha256::hash(image.data(), image.size()), sha.finish()));
+
+    // RFC 4231, test case 2
+    const char* key = "Jefe";
+    const char* data = "what do ya want for nothing?";
+    EXPECT_STREQ("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+                 toHex(OswSha256::hmac((const uint8_t*) key, strlen(key), (const uint8_t*) data, strlen(data))).c_str());
+}
+
+UTEST(ota, should_receive_while_the_flash_writes) {
+    const std::vector<uint8_t> image = randomImage(64 * OswOta::defaultBufferSize + 123);
+    FakeFlash flash;
+    flash.writeTime = std::chrono::milliseconds(3);
+    FakeDownload download(image, flash, std::chrono::milliseconds(3));
+    OswOta ota(flash);
+    ASSERT_TRUE(ota.begin(manifestOf(image, "secret"), "secret"));
+    while(!ota.isComplete())
+        ASSERT_TRUE(ota.receive(download, 20));
+    ASSERT_TRUE(ota.finish());
+
+    EXPECT_TRUE(flash.committed);
+    EXPECT_TRUE(flash.data == image);
+    const OswOta::Progress progress = ota.getProgress();
+    EXPECT_EQ(OswOta::State::COMMITTED, progress.state);
+    EXPECT_EQ(image.size(), progress.written);
+    EXPECT_GT(progress.getThroughput(), 0u);
+    EXPECT_TRUE(download.overlapped); // Both stages ran side by side
+}
+
+UTEST(ota, should_refuse_a_wrong_signature_before_touching_the_flash) {
+    const std::vector<uint8_t> image = randomImage(10000);
+    FakeFlash flash;
+    OswOta ota(flash);
+    EXPECT_FALSE(ota.begin(manifestOf(image, "guessed"), "secret"));
+    EXPECT_STREQ("Wrong signature.", ota.getError().c_str());
+    EXPECT_FALSE(ota.begin(manifestOf(image, ""), "secret"));
+    EXPECT_STREQ("Unsigned update.", ota.getError().c_str());
+    EXPECT_FALSE(flash.begun);
+
+    OswOta::Manifest manifest;
+    EXPECT_FALSE(manifest.parse("10000;abc"));
+    EXPECT_FALSE(manifest.parse("-1"));
+    EXPECT_TRUE(manifest.parse("10000"));
+    EXPECT_FALSE(manifest.hasHash);
+    EXPECT_TRUE(ota.begin(manifest, "")); // Without a key anything goes
+}
+
+UTEST(ota, should_take_the_size_of_the_source_for_a_manifest_without_one) {
+    const std::vector<uint8_t> image = randomImage(10000);
+    const std::string text = "0;" + toHex(OswSha256::hash(image.data(), image.size()));
+    OswOta::Manifest manifest;
+    ASSERT_TRUE(manifest.parse(text + ";" + toHex(OswSha256::hmac((const uint8_t*) "secret", 6, (const uint8_t*) text.data(), text.size()))));
+    FakeFlash flash;
+    OswOta ota(flash);
+    // Signed as it is, the size of the source does not change that
+    ASSERT_TRUE(ota.begin(manifest, "secret", image.size()));
+    EXPECT_EQ(image.size(), flash.size);
+    EXPECT_EQ(image.size(), ota.getProgress().total);
+    ASSERT_TRUE(ota.write(image.data(), image.size()));
+    EXPECT_TRUE(ota.finish());
+    EXPECT_TRUE(flash.committed);
+
+    // A size in the manifest has to match the one of the source
+    EXPECT_FALSE(ota.begin(manifestOf(image, "secret"), "secret", image.size() + 1));
+    EXPECT_STREQ("Size differs from the manifest.", ota.getError().c_str());
+}
+
+UTEST(ota, should_refuse_a_tampered_image_before_commit) {
+    std::vector<uint8_t> image = randomImage(3 * OswOta::defaultBufferSize);
+    const OswOta::Manifest manifest = manifestOf(image, "secret");
+    image[5000] ^= 1;
+    FakeFlash flash;
+    OswOta ota(flash);
+    ASSERT_TRUE(ota.begin(manifest, "secret"));
+    for(size_t position = 0; position < image.size(); position += 1000)
+        ASSERT_TRUE(ota.write(image.data() + position, std::min((size_t) 1000, image.size() - position)));
+    EXPECT_FALSE(ota.finish());
+    EXPECT_STREQ("SHA-256 mismatch.", ota.getError().c_str());
+    EXPECT_FALSE(flash.committed);
+    EXPECT_EQ(1, flash.aborts);
+
+    // Neither more nor less than announced
+    ASSERT_TRUE(ota.begin(manifest, "secret"));
+    EXPECT_FALSE(ota.write(image.data(), image.size() + 1));
+    ASSERT_TRUE(ota.begin(manifest, "secret"));
+    ASSERT_TRUE(ota.write(image.data(), image.size() - 1));
+    EXPECT_FALSE(ota.finish());
+    EXPECT_STREQ("Image incomplete.", ota.getError().c_str());
+    EXPECT_EQ(3, flash.aborts);
+}
+
+UTEST(ota, should_stop_once_the_flash_fails) {
+    const std::vector<uint8_t> image = randomImage(10 * OswOta::defaultBufferSize);
+    FakeFlash flash;
+    flash.failAfter = 2;
+    OswOta ota(flash);
+    ASSERT_TRUE(ota.begin(manifestOf(image, ""), ""));
+    bool accepted = true;
+    for(size_t position = 0; accepted and position < image.size(); position += 1000)
+        accepted = ota.write(image.data() + position, std::min((size_t) 1000, image.size() - position));
+    EXPECT_FALSE(accepted);
+    EXPECT_FALSE(ota.finish());
+    EXPECT_STREQ("Write failed: flash broken", ota.getError().c_str());
+    EXPECT_EQ(2 * OswOta::defaultBufferSize, ota.getProgress().written);
+    EXPECT_FALSE(flash.committed);
+    EXPECT_EQ(1, flash.aborts);
+}
+
+UTEST(ota, should_stream_a_local_file) {
+    const std::vector<uint8_t> image = randomImage(1024 * 1024 + 77);
+    const std::string from = "/tmp/osw_ota_image.bin";
+    const std::string to = "/tmp/osw_ota_flashed.bin";
+    FILE* file = fopen(from.c_str(), "wb");
+    ASSERT_TRUE(file != nullptr);
+    fwrite(image.data(), 1, image.size(), file);
+    fclose(file);
+    remove(to.c_str());
+
+    {
+        OswOtaFileSource source(from);
+        OswOtaFileSink sink(to);
+        ASSERT_TRUE(source.isOpen());
+        OswOta::Manifest manifest;
+        ASSERT_TRUE(manifest.parse("0;" + toHex(OswSha256::hash(image.data(), image.size())))); // Streamed until the source ends
+        OswOta ota(sink);
+        ASSERT_TRUE(ota.begin(manifest, ""));
+        while(!ota.isComplete())
+            ASSERT_TRUE(ota.receive(source, 20));
+        ASSERT_TRUE(ota.finish());
+        EXPECT_GT(ota.getProgress().getThroughput(), 0u);
+    }
+
+    std::vector<uint8_t> flashed(image.size() + 1);
+    file = fopen(to.c_str(), "rb");
+    ASSERT_TRUE(file != nullptr);
+    flashed.resize(fread(flashed.data(), 1, flashed.size(), file));
+    fclose(file);
+    EXPECT_TRUE(flashed == image);
+    remove(from.c_str());
+    remove(to.c_str());
+}
@@ -0,0 +1,119 @@
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+#include "utest.h"
+
+#include <Arduino.h>
+#include <OswSensorTrace.h>
+
+#include "../../../include/FakeClock.h"
+#include "../../../include/SensorReplay.h"
+
+static std::string writeTraceFile(const char* content) {
+    const std::string path = (std::filesystem::temp_directory_path() / ("osw_trace_" + std::to_string(rand()) + ".trace")).string();
+    FILE* file = fopen(path.c_str(), "w");
+    fputs(content, file);
+    fclose(file);
+    return path;
+}
+
+UTEST(sensorTrace, should_format_and_parse_lines) {
+    OswSensorTrace::Sample sample;
+    sample.time = 1234;
+    sample.kind = OswSensorTrace::Kind::MAGNETOMETER;
+    sample.values = {-12, 34, 5, 271};
+    char line[64];
+    ASSERT_GT(OswSensorTrace::format(sample, line, sizeof(line)), (size_t) 0);
+    EXPECT_STREQ(line, "1234 mag -12 34 5 271\n");
+
+    sample.kind = OswSensorTrace::Kind::GPS;
+    sample.values = {50.1234567, 8.7654321, 112.5, 0};
+    OswSensorTrace::format(sample, line, sizeof(line));
+    OswSensorTrace::Sample parsed;
+    ASSERT_TRUE(OswSensorTrace::parse(line, parsed));
+    EXPECT_EQ(parsed.time, (uint32_t) 1234);
+    EXPECT_EQ(parsed.kind, OswSensorTrace::Kind::GPS);
+    EXPECT_NEAR(parsed.values[0], 50.1234567, 1e-7);
+    EXPECT_NEAR(parsed.values[1], 8.7654321, 1e-7);
+
+    EXPECT_EQ(OswSensorTrace::format(sample, line, 10), (size_t) 0);
+    EXPECT_FALSE(OswSensorTrace::parse("# comment", parsed));
+    EXPECT_FALSE(OswSensorTrace::parse("", parsed));
+    EXPECT_FALSE(OswSensorTrace::parse("10 gyro 1 2 3", parsed));
+    EXPECT_FALSE(OswSensorTrace::parse("10 acc 1 2", parsed));
+    EXPECT_FALSE(OswSensorTrace::parse("acc 1 2 3", parsed));
+}
+
+UTEST(sensorTrace, should_write_only_changes) {
+    const std::string path = writeTraceFile("");
+    OswSensorTraceWriter writer;
+    ASSERT_TRUE(writer.open(path.c_str()));
+    EXPECT_TRUE(writer.write(5000, OswSensorTrace::Kind::STEPS, 10));
+    EXPECT_FALSE(writer.write(5020, OswSensorTrace::Kind::STEPS, 10));
+    EXPECT_TRUE(writer.write(5020, OswSensorTrace::Kind::TEMPERATURE, 21.5));
+    EXPECT_TRUE(writer.write(5040, OswSensorTrace::Kind::STEPS, 11));
+    EXPECT_TRUE(writer.write(5060, OswSensorTrace::Kind::STEPS, 11, 0, 0, 0, true));
+    EXPECT_EQ(writer.getWrittenSamples(), (uint32_t) 4);
+    writer.close();
+
+    OswSensorTraceReader reader;
+    ASSERT_TRUE(reader.open(path.c_str()));
+    std::vector<OswSensorTrace::Sample> samples;
+    OswSensorTrace::Sample sample;
+    while(reader.next(sample))
+        samples.push_back(sample);
+    ASSERT_EQ(samples.size(), (size_t) 4);
+    EXPECT_EQ(samples[0].time, (uint32_t) 0); // Relative to the first sample
+    EXPECT_EQ(samples[1].kind, OswSensorTrace::Kind::TEMPERATURE);
+    EXPECT_NEAR(samples[1].values[0], 21.5, 1e-6);
+    EXPECT_EQ(samples[3].time, (uint32_t) 60);
+    EXPECT_EQ(reader.getSkippedLines(), (uint32_t) 0);
+    std::filesystem::remove(path);
+}
+
+UTEST(sensorTrace, should_replay_deterministically) {
+    const std::string path = writeTraceFile("# OSW sensor trace 1\n"
+                                            "0 utc 1700000000\n"
+                                            "0 acc 1 2 -9.5\n"
+                                            "25 steps 4321\n"
+                                            "30 button 1 1\n"
+                                            "this is no sample\n"
+                                            "40 gps 50 8 100\n"
+                                            "2000 temp 30\n");
+    OswDevices::Virtual::VirtualValues values;
+    std::vector<std::pair<Button, bool>> buttons;
+    auto onButton = [&buttons](Button id, bool down) {
+        buttons.push_back({id, down});
+    };
+    {
+        SensorReplay replay(path, false);
+        ASSERT_TRUE(replay.isOpen());
+        EXPECT_TRUE(FakeClock::isEnabled());
+        EXPECT_EQ(millis(), 0ul);
+
+        replay.step(values, onButton);
+        EXPECT_EQ(millis(), 10ul);
+        EXPECT_EQ(FakeClock::getUTCTime(), (time_t) 1700000000);
+        EXPECT_NEAR(values.accelerationZ, -9.5f, 1e-6f);
+        EXPECT_NE(values.steps, (uint32_t) 4321);
+
+        replay.step(values, onButton);
+        replay.step(values, onButton);
+        EXPECT_EQ(values.steps, (uint32_t) 4321);
+        ASSERT_EQ(buttons.size(), (size_t) 1);
+        EXPECT_EQ(buttons[0].first, Button::BUTTON_UP);
+        EXPECT_TRUE(buttons[0].second);
+
+        while(!replay.isFinished())
+            replay.step(values, onButton);
+        EXPECT_EQ(replay.getTraceTime(), (uint32_t) 2000);
+        EXPECT_EQ(millis(), 2000ul);
+        EXPECT_EQ(FakeClock::getUTCTime(), (time_t) 1700000002);
+        EXPECT_NEAR(values.temperature, 30.0f, 1e-6f);
+        EXPECT_EQ(replay.getAppliedSamples(), (uint32_t) 5);
+        EXPECT_EQ(replay.getIgnoredSamples(), (uint32_t) 1);
+    }
+    EXPECT_FALSE(FakeClock::isEnabled());
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,102 @@
+#include "utest.h"
+
+#include <Arduino.h>
+#include <services/OswServiceManager.h>
+
+#include "../../../include/FakeClock.h"
+
+class FakeTask : public OswServiceTask {
+  public:
+    unsigned int loops = 0;
+    unsigned long sleep = 0; // ms to sleep after every loop(), 0 to stay due
+    bool sleepForever = false;
+    unsigned long work = 0; // µs every loop() takes
+
+    virtual void loop() override {
+        ++this->loops;
+        FakeClock::advance(this->work);
+        if(this->sleepForever)
+            this->sleepUntilWoken();
+        else if(this->sleep)
+            this->sleepFor(this->sleep);
+    };
+};
+
+UTEST(serviceManager, should_only_run_due_tasks) {
+    FakeClock::enable(0);
+    FakeTask busy;
+    FakeTask periodic;
+    periodic.sleep = 100;
+    FakeTask waiting;
+    waiting.sleepForever = true;
+    FakeTask stopped;
+    OswServiceTask* const tasks[] = {&busy, &periodic, &waiting, &stopped, nullptr};
+    busy.setup();
+    periodic.setup();
+    waiting.setup();
+    OswServiceManager& manager = OswServiceManager::getInstance();
+
+    EXPECT_EQ(manager.loop(tasks, 5, millis()), 0ul); // The busy one is always due
+    EXPECT_EQ(busy.loops, 1u);
+    EXPECT_EQ(periodic.loops, 1u);
+    EXPECT_EQ(waiting.loops, 1u);
+    EXPECT_EQ(stopped.loops, 0u);
+    for(int i = 0; i < 9; i++) {
+        FakeClock::advance(10 * 1000);
+        manager.loop(tasks, 5, millis());
+    }
+    EXPECT_EQ(busy.loops, 10u);
+    EXPECT_EQ(periodic.loops, 1u);
+    FakeClock::advance(10 * 1000);
+    manager.loop(tasks, 5, millis());
+    EXPECT_EQ(periodic.loops, 2u);
+    EXPECT_EQ(waiting.loops, 1u);
+
+    // Without the busy one, the worker may pause until the periodic one is due
+    busy.stop();
+    EXPECT_EQ(manager.loop(tasks, 5, millis()), 100ul);
+    waiting.wakeUp();
+    EXPECT_EQ(manager.loop(tasks, 5, millis()), 100ul);
+    EXPECT_EQ(waiting.loops, 2u);
+    periodic.stop();
+    EXPECT_EQ(manager.loop(tasks, 5, millis()), (unsigned long) manager.workerMaxSleep);
+    EXPECT_EQ(waiting.loops, 2u);
+    FakeClock::disable();
+}
+
+UTEST(serviceManager, should_measure_against_the_budget) {
+    FakeClock::enable(0);
+    FakeTask slow;
+    slow.setup();
+    OswServiceTask* const tasks[] = {&slow};
+    OswServiceManager& manager = OswServiceManager::getInstance();
+
+    slow.work = slow.getLoopBudget() / 2;
+    manager.loop(tasks, 1, millis());
+    slow.work = slow.getLoopBudget() * 3;
+    manager.loop(tasks, 1, millis());
+    manager.loop(tasks, 1, millis());
+    const OswServiceTask::Stats& stats = slow.getStats();
+    EXPECT_EQ(stats.loops, 3ul);
+    EXPECT_EQ(stats.overruns, 2ul);
+    EXPECT_EQ(stats.maxTime, slow.getLoopBudget() * 3);
+    EXPECT_EQ(stats.time, slow.getLoopBudget() / 2 + 2 * slow.getLoopBudget() * 3);
+    FakeClock::disable();
+}
+
+UTEST(serviceManager, should_wake_across_the_millis_overflow) {
+    class OverflowTask : public OswServiceTask {
+      public:
+        const unsigned long beforeOverflow = (unsigned long) -50;
+        virtual void loop() override {
+            this->sleepUntil(this->beforeOverflow + 100);
+        };
+    } task;
+    task.setup();
+    OswServiceTask* const tasks[] = {&task};
+    OswServiceManager::getInstance().loop(tasks, 1, task.beforeOverflow);
+    EXPECT_EQ(OswServiceManager::getInstance().loop(tasks, 1, task.beforeOverflow + 10), 90ul);
+    EXPECT_FALSE(task.isDue(task.beforeOverflow + 99));
+    EXPECT_TRUE(task.isDue(task.beforeOverflow + 100));
+    EXPECT_EQ(task.getStats().loops, 1ul);
+}
@@ -0,0 +1,93 @@
+#include <vector>
+
+#include "utest.h"
+
+#include "../../../include/services/OswServiceTaskCpuGovernor.h"
+
+/**
+ * Replays a synthetic load trace: the work of every sample is given in MHz, so the load the governor sees depends on
+ * the clock it chose before (like the time it takes to render a frame does). Returns the clock after every sample.
+ */
+static std::vector<unsigned int> replay(OswServiceTaskCpuGovernor& governor, const std::vector<float>& work, OswServiceTaskCpuGovernor::Sample sample = {}) {
+    static unsigned long now = 0;
+    std::vector<unsigned int> clocks;
+    for(float mhz : work) {
+        now += governor.sampleInterval;
+        sample.uiLoad = std::min(1.0f, mhz / getCpuFrequencyMhz());
+        governor.update(sample, now);
+        clocks.push_back(getCpuFrequencyMhz());
+    }
+    return clocks;
+}
+
+UTEST(cpuGovernor, should_clock_down_only_after_a_while) {
+    setCpuFrequencyMhz(240);
+    OswServiceTaskCpuGovernor governor;
+    const unsigned samplesUntilDown = governor.downDelay / governor.sampleInterval;
+    // A static screen: nearly nothing to do
+    std::vector<unsigned int> clocks = replay(governor, std::vector<float>(samplesUntilDown + 1, 5));
+    EXPECT_EQ(clocks.front(), 240U);
+    EXPECT_EQ(clocks[samplesUntilDown - 1], 240U);
+    EXPECT_EQ(clocks[samplesUntilDown], 80U); // Right to the clock that fits
+}
+
+UTEST(cpuGovernor, should_clock_up_immediately) {
+    setCpuFrequencyMhz(80);
+    OswServiceTaskCpuGovernor governor;
+    // 70 MHz of work is too much for 80 MHz, 150 MHz is too much for 160 MHz
+    EXPECT_EQ(replay(governor, {70}).back(), 160U);
+    EXPECT_EQ(replay(governor, {150}).back(), 240U);
+    // Everything above is as good as it gets
+    EXPECT_EQ(replay(governor, {400}).back(), 240U);
+}
+
+UTEST(cpuGovernor, should_not_oscillate) {
+    setCpuFrequencyMhz(160);
+    OswServiceTaskCpuGovernor governor;
+    // Noisy load between the thresholds of 80 and 160 MHz
+    std::vector<float> work;
+    for(int i = 0; i < 100; i++)
+        work.push_back(i % 3 == 0 ? 55 : 45);
+    unsigned int changes = 0;
+    unsigned int previous = getCpuFrequencyMhz();
+    for(unsigned int clock : replay(governor, work)) {
+        if(clock != previous)
+            ++changes;
+        previous = clock;
+    }
+    EXPECT_EQ(changes, 0U);
+    EXPECT_EQ(previous, 160U);
+
+    // A short pause must not clock down either
+    EXPECT_EQ(replay(governor, {5, 5, 5, 55, 5, 5, 5}).back(), 160U);
+}
+
+UTEST(cpuGovernor, should_keep_headroom_for_the_radio) {
+    setCpuFrequencyMhz(80);
+    OswServiceTaskCpuGovernor governor;
+    OswServiceTaskCpuGovernor::Sample sample;
+    sample.radioActive = true;
+    EXPECT_EQ(replay(governor, std::vector<float>(20, 5), sample).back(), 160U);
+
+    // Unless the platform can only run it at the lowest clock
+    sample.radioLowPower = true;
+    EXPECT_EQ(replay(governor, {200}, sample).back(), 80U);
+}
+
+UTEST(cpuGovernor, should_respect_the_app) {
+    setCpuFrequencyMhz(240);
+    OswServiceTaskCpuGovernor governor;
+    OswServiceTaskCpuGovernor::Sample sample;
+    sample.appFrequency = 80;
+    EXPECT_EQ(replay(governor, {200}, sample).back(), 80U);
+
+    // Apps without FPS limit always render, so only their lower bound is used
+    sample.appFrequency = 0;
+    sample.viewFlags = OswAppV2::ViewFlags::NO_FPS_LIMIT;
+    EXPECT_EQ(replay(governor, std::vector<float>(20, 200), sample).back(), 160U);
+
+    // ...but the service load still counts
+    sample.serviceLoad = 0.9f;
+    EXPECT_EQ(replay(governor, {200}, sample).back(), 240U);
+    OswHal::resetInstance();
+}
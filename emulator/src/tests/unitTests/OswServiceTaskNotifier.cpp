@@ -1,3 +1,5 @@
+#include <map>
+
 #include "utest.h"
 
 #include "../../../include/services/OswServiceTaskNotifier.h"
@@ -29,12 +31,16 @@ class TestOswServiceTaskNotifier {
         return notifier.readNotifications(publisher);
     }
 
-    static void deleteNotification(unsigned int id, const std::string publisher, OswServiceTaskNotifier& notifier) {
+    static void deleteNotification(unsigned int id, std::string_view publisher, OswServiceTaskNotifier& notifier) {
         notifier.deleteNotification(id, publisher);
     }
 
     static std::multimap<time_point<system_clock, seconds>, const Notification> getScheduler(OswServiceTaskNotifier& notifier) {
-        return notifier.scheduler;
+        std::multimap<time_point<system_clock, seconds>, const Notification> scheduler;
+        for (auto i = notifier.store.first(); i != OswServiceTaskNotifier::Store::NONE; i = notifier.store.next(i)) {
+            scheduler.insert(notifier.toNotificationData(i));
+        }
+        return scheduler;
     }
 };
 
@@ -0,0 +1,151 @@
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <thread>
+
+#include "utest.h"
+
+#include "../lib/date/date.h"
+#include <OswTimezone.h>
+
+// From https://github.com/nayarsystems/posix_tz_db/blob/master/zones.csv
+static const char* const zones[] = {
+    "CET-1CEST,M3.5.0,M10.5.0/3", // Europe/Berlin
+    "GMT0BST,M3.5.0/1,M10.5.0", // Europe/London
+    "WET0WEST,M3.5.0/1,M10.5.0", // Europe/Lisbon
+    "EET-2EEST,M3.5.0/3,M10.5.0/4", // Europe/Athens
+    "MSK-3", // Europe/Moscow
+    "<-01>1<+00>,M3.5.0/0,M10.5.0/1", // Atlantic/Azores
+    "<-02>2<-01>,M3.5.0/-1,M10.5.0/0", // America/Nuuk
+    "EST5EDT,M3.2.0,M11.1.0", // America/New_York
+    "CST6CDT,M3.2.0,M11.1.0", // America/Chicago
+    "MST7", // America/Phoenix
+    "PST8PDT,M3.2.0,M11.1.0", // America/Los_Angeles
+    "AKST9AKDT,M3.2.0,M11.1.0", // America/Anchorage
+    "HST10", // Pacific/Honolulu
+    "NST3:30NDT,M3.2.0,M11.1.0", // America/St_Johns
+    "<-04>4<-03>,M9.1.6/24,M4.1.6/24", // America/Santiago
+    "<-03>3", // America/Sao_Paulo
+    "IST-2IDT,M3.4.4/26,M10.5.0", // Asia/Jerusalem
+    "IST-5:30", // Asia/Kolkata
+    "<+0545>-5:45", // Asia/Kathmandu
+    "CST-8", // Asia/Shanghai
+    "JST-9", // Asia/Tokyo
+    "ACST-9:30ACDT,M10.1.0,M4.1.0/3", // Australia/Adelaide
+    "AEST-10AEDT,M10.1.0,M4.1.0/3", // Australia/Sydney
+    "<+1030>-10:30<+11>-11,M10.1.0,M4.1.0", // Australia/Lord_Howe
+    "NZST-12NZDT,M9.5.0,M4.1.0/3", // Pacific/Auckland
+    "<+13>-13", // Pacific/Tongatapu
+    "<+00>0<+02>-2,M3.5.0/1,M10.5.0/3", // Antarctica/Troll
+    "EST5EDT", // Default rules
+    "UTC0",
+};
+
+static int32_t getLibcOffset(time_t utc) {
+    std::tm local;
+    localtime_r(&utc, &local);
+    return (int32_t) local.tm_gmtoff;
+}
+
+UTEST(timezone, should_parse_posix_strings) {
+    OswTimezone zone;
+    EXPECT_TRUE(zone.update("", 1700000000));
+    EXPECT_TRUE(zone.isValid());
+    EXPECT_EQ(zone.getOffset(1700000000), 0);
+    EXPECT_FALSE(zone.update("", 1700000000)); // Unchanged
+
+    EXPECT_TRUE(zone.update("IST-5:30", 1700000000));
+    EXPECT_FALSE(zone.hasDaylightSavingTime());
+    EXPECT_EQ(zone.getOffset(1700000000), 5 * 3600 + 30 * 60);
+
+    EXPECT_TRUE(zone.update("CET-1CEST,M3.5.0,M10.5.0/3", 1700000000));
+    EXPECT_TRUE(zone.hasDaylightSavingTime());
+
+    const char* const invalid[] = {"X", "CET", "CET-1CEST,M13.1.0,M10.5.0", "CET-1CEST,M3.5.0", "CET-1CEST,M3.5.7,M10.5.0",
+                                   "<+03-3", "CET-1CEST,M3.5.0,M10.5.0/3junk", "CET-25"};
+    for(const char* posix : invalid) {
+        zone.update(posix, 1700000000);
+        EXPECT_FALSE(zone.isValid());
+        EXPECT_EQ(zone.getOffset(1700000000), 0);
+    }
+}
+
+UTEST(timezone, should_match_libc_for_many_zones) {
+    const char* oldTimezone = getenv("TZ");
+    const std::string restore = oldTimezone != nullptr ? oldTimezone : "";
+    const time_t from = 1420070400; // 2015-01-01
+    const time_t until = 2082758400; // 2036-01-01
+    for(const char* posix : zones) {
+        setenv("TZ", posix, 1);
+        tzset();
+        OswTimezone moving; // Like the watch: rebuilt whenever the time leaves its table
+        OswTimezone fixed; // Always built for 2024, so most queries are outside of its table
+        fixed.update(posix, 1704067200);
+        for(time_t utc = from; utc < until; utc += 7 * 3600 + 13 * 60) {
+            moving.update(posix, utc);
+            ASSERT_TRUE(moving.isValid());
+            const int32_t expected = getLibcOffset(utc);
+            ASSERT_EQ(moving.getOffset(utc), expected);
+            ASSERT_EQ(fixed.getOffset(utc), expected);
+        }
+        // Exactly at the transitions (and the ends of the tables)
+        int changes = 0;
+        for(time_t utc = moving.getNextTransition(from); utc < until; utc = moving.getNextTransition(utc)) {
+            moving.update(posix, utc);
+            ASSERT_EQ(moving.getOffset(utc - 1), getLibcOffset(utc - 1));
+            ASSERT_EQ(moving.getOffset(utc), getLibcOffset(utc));
+            if(getLibcOffset(utc - 1) != getLibcOffset(utc))
+                ++changes;
+        }
+        EXPECT_EQ(changes, moving.hasDaylightSavingTime() ? 2 * 21 : 0);
+    }
+    setenv("TZ", restore.c_str(), 1);
+    tzset();
+}
+
+UTEST(timezone, should_transition_like_date_h) {
+    using namespace date;
+    OswTimezone berlin;
+    OswTimezone newYork;
+    for(int y = 2000; y <= 2040; y++) {
+        const time_t january = (time_t) std::chrono::system_clock::to_time_t(sys_days{year{y} / January / 1});
+        berlin.update("CET-1CEST,M3.5.0,M10.5.0/3", january);
+        newYork.update("EST5EDT,M3.2.0,M11.1.0", january);
+
+        // The EU switches at 01:00 UTC on the last Sundays of March and October
+        const sys_seconds berlinStart = sys_days{year{y} / March / Sunday[last]} + std::chrono::hours{1};
+        const sys_seconds berlinEnd = sys_days{year{y} / October / Sunday[last]} + std::chrono::hours{1};
+        EXPECT_EQ(berlin.getNextTransition(january), (time_t) berlinStart.time_since_epoch().count());
+        EXPECT_EQ(berlin.getNextTransition(berlinStart.time_since_epoch().count()), (time_t) berlinEnd.time_since_epoch().count());
+        EXPECT_EQ(berlin.getOffset(berlinStart.time_since_epoch().count()), 7200);
+
+        // The US switches at 02:00 local time on the second Sunday of March and the first one of November
+        const sys_seconds newYorkStart = sys_days{year{y} / March / Sunday[2]} + std::chrono::hours{2 + 5};
+        const sys_seconds newYorkEnd = sys_days{year{y} / November / Sunday[1]} + std::chrono::hours{2 + 4};
+        EXPECT_EQ(newYork.getNextTransition(january), (time_t) newYorkStart.time_since_epoch().count());
+        EXPECT_EQ(newYork.getNextTransition(newYorkStart.time_since_epoch().count()), (time_t) newYorkEnd.time_since_epoch().count());
+        EXPECT_EQ(newYork.getOffset(newYorkEnd.time_since_epoch().count() - 1), -4 * 3600);
+        EXPECT_EQ(newYork.getOffset(newYorkEnd.time_since_epoch().count()), -5 * 3600);
+    }
+}
+
+UTEST(timezone, should_answer_while_another_task_updates) {
+    OswTimezone zone;
+    zone.update("CET-1CEST,M3.5.0,M10.5.0/3", 1700000000);
+    std::atomic<bool> running = true;
+    std::thread updater([&]() {
+        // Like the NTP sync on core 0, which switches between the rules of a changed config
+        for(int i = 0; running; i++)
+            zone.update(i % 2 ? "NZST-12NZDT,M9.5.0,M4.1.0/3" : "CET-1CEST,M3.5.0,M10.5.0/3", 1700000000 + (time_t) (i % 7) * 400 * 86400);
+    });
+    unsigned int wrong = 0;
+    for(int i = 0; i < 20000; i++) {
+        const int32_t offset = zone.getOffset(1700000000); // November: CET or NZDT, nothing in between
+        if(offset != 3600 and offset != 13 * 3600)
+            ++wrong;
+    }
+    running = false;
+    updater.join();
+    EXPECT_EQ(wrong, 0u);
+}
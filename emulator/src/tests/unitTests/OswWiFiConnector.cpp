@@ -0,0 +1,222 @@
+#include <map>
+#include <string>
+
+#include "utest.h"
+
+#include <OswWiFiConnector.h>
+
+/**
+ * Access points which take a fixed time to authenticate and to hand out an address - driven by the test's clock
+ */
+class FakeRadio : public OswWiFiConnector::Radio {
+  public:
+    struct AccessPoint {
+        std::array<uint8_t, 6> bssid = {};
+        uint8_t channel = 1;
+        int32_t rssi = -60;
+        bool hidden = false;
+        bool up = true;
+        bool wrongPassword = false;
+        unsigned long authTime = 800;
+        unsigned long dhcpTime = 300;
+    };
+    std::map<std::string, AccessPoint> accessPoints;
+    unsigned long now = 0;
+    unsigned long scanTime = 1500;
+    unsigned int scans = 0;
+    unsigned int begins = 0;
+    uint8_t lastChannel = 0;
+
+    virtual void begin(const OswWiFiConnector::Network& network, uint8_t channel, const uint8_t* bssid) override {
+        ++this->begins;
+        this->lastChannel = channel;
+        this->ssid = network.ssid.c_str();
+        this->startedAt = this->now;
+        auto ap = this->accessPoints.find(this->ssid);
+        // A connection to a specific access point fails, if it is not that one anymore
+        this->reachable = ap != this->accessPoints.end() and ap->second.up and
+                          (bssid == nullptr or (ap->second.channel == channel and std::equal(ap->second.bssid.begin(), ap->second.bssid.end(), bssid)));
+    };
+    virtual void disconnect() override {
+        this->ssid.clear();
+    };
+    virtual Status getStatus() override {
+        if(this->ssid.empty())
+            return Status::IDLE;
+        if(!this->reachable)
+            return Status::CONNECTING; // Never finds it
+        const AccessPoint& ap = this->accessPoints[this->ssid];
+        if(!ap.up)
+            return Status::IDLE;
+        if(this->now - this->startedAt < ap.authTime)
+            return Status::CONNECTING;
+        if(ap.wrongPassword)
+            return Status::FAILED;
+        if(this->now - this->startedAt < ap.authTime + ap.dhcpTime)
+            return Status::ASSOCIATED;
+        return Status::CONNECTED;
+    };
+    virtual bool getAccessPoint(std::array<uint8_t, 6>& bssid, uint8_t& channel) override {
+        if(this->getStatus() != Status::CONNECTED)
+            return false;
+        bssid = this->accessPoints[this->ssid].bssid;
+        channel = this->accessPoints[this->ssid].channel;
+        return true;
+    };
+    virtual void startScan() override {
+        ++this->scans;
+        this->scanStartedAt = this->now;
+    };
+    virtual bool getScanResults(std::vector<OswWiFiConnector::ScanResult>& results) override {
+        if(this->now - this->scanStartedAt < this->scanTime)
+            return false;
+        for(const auto& [ssid, ap] : this->accessPoints) {
+            if(ap.hidden or !ap.up)
+                continue;
+            OswWiFiConnector::ScanResult result;
+            result.ssid = ssid.c_str();
+            result.bssid = ap.bssid;
+            result.channel = ap.channel;
+            result.rssi = ap.rssi;
+            results.push_back(result);
+        }
+        return true;
+    };
+
+    /**
+     * Loops the connector in steps of 50 ms, until it is done (or the time is up)
+     */
+    void run(OswWiFiConnector& connector, unsigned long duration = 60000) {
+        for(unsigned long end = this->now + duration; this->now < end; this->now += 50) {
+            connector.loop(this->now);
+            if(connector.getState() == OswWiFiConnector::State::CONNECTED or connector.getState() == OswWiFiConnector::State::FAILED)
+                return;
+        }
+    };
+
+  private:
+    std::string ssid;
+    bool reachable = false;
+    unsigned long startedAt = 0;
+    unsigned long scanStartedAt = 0;
+};
+
+UTEST(wifiConnector, should_scan_first_and_connect_fast_afterwards) {
+    FakeRadio radio;
+    radio.accessPoints["Home"].bssid = {1, 2, 3, 4, 5, 6};
+    radio.accessPoints["Home"].channel = 6;
+    OswWiFiConnector::History history = {};
+    OswWiFiConnector connector(radio, history);
+    connector.setNetworks({{"Home", "secret"}, {"", ""}, {"Office", "secret"}});
+
+    connector.connect(radio.now);
+    EXPECT_EQ((int) connector.getState(), (int) OswWiFiConnector::State::SCANNING);
+    radio.run(connector);
+    ASSERT_TRUE(connector.isConnected());
+    EXPECT_STREQ(connector.getNetwork()->ssid.c_str(), "Home");
+    EXPECT_FALSE(connector.getProfile().fast);
+    EXPECT_EQ(connector.getProfile().scan, 1500ul);
+    EXPECT_EQ(connector.getProfile().auth, 800ul);
+    EXPECT_EQ(connector.getProfile().dhcp, 300ul);
+    EXPECT_EQ(connector.getProfile().total, 2600ul);
+    EXPECT_EQ(radio.lastChannel, 6); // Straight to the access point found by the scan
+    radio.now += 2000;
+    connector.noteTimeSynchronized(radio.now);
+    EXPECT_EQ(connector.getProfile().ntp, 2000ul);
+
+    // The next time (e.g. after the deep sleep) it skips the scan
+    connector.disconnect();
+    OswWiFiConnector afterSleep(radio, history);
+    afterSleep.setNetworks({{"Home", "secret"}, {"Office", "secret"}});
+    afterSleep.connect(radio.now);
+    EXPECT_EQ((int) afterSleep.getState(), (int) OswWiFiConnector::State::FAST_CONNECTING);
+    radio.run(afterSleep);
+    ASSERT_TRUE(afterSleep.isConnected());
+    EXPECT_TRUE(afterSleep.getProfile().fast);
+    EXPECT_EQ(afterSleep.getProfile().scan, 0ul);
+    EXPECT_EQ(afterSleep.getProfile().total, 1100ul);
+    EXPECT_EQ(radio.scans, 1u);
+}
+
+UTEST(wifiConnector, should_scan_if_the_access_point_changed) {
+    FakeRadio radio;
+    radio.accessPoints["Home"].channel = 1;
+    OswWiFiConnector::History history = {};
+    OswWiFiConnector connector(radio, history);
+    connector.setNetworks({{"Home", ""}});
+    connector.connect(radio.now);
+    radio.run(connector);
+    ASSERT_TRUE(connector.isConnected());
+
+    radio.accessPoints["Home"].channel = 11; // E.g. the router picked another channel
+    connector.connect(radio.now);
+    radio.run(connector);
+    ASSERT_TRUE(connector.isConnected());
+    EXPECT_EQ(radio.scans, 2u);
+    EXPECT_EQ(connector.getProfile().attempts, 2);
+    // The fast attempt gives up long before the regular timeout
+    EXPECT_LE(connector.getProfile().total, OswWiFiConnector::fastTimeout + 1500 + 1100 + 100);
+    EXPECT_EQ(history.records[0].channel, 11);
+    EXPECT_EQ(history.records[0].failures, 0); // It was the access point, not the network
+}
+
+UTEST(wifiConnector, should_prefer_networks_which_worked_before) {
+    FakeRadio radio;
+    radio.accessPoints["Flaky"].rssi = -40; // Stronger, but the password is wrong
+    radio.accessPoints["Flaky"].wrongPassword = true;
+    radio.accessPoints["Solid"].rssi = -80;
+    radio.accessPoints["Hidden"].hidden = true;
+    OswWiFiConnector::History history = {};
+    OswWiFiConnector connector(radio, history);
+    connector.setNetworks({{"Hidden", "x"}, {"Solid", "x"}, {"Flaky", "x"}});
+
+    connector.connect(radio.now);
+    radio.run(connector);
+    ASSERT_TRUE(connector.isConnected());
+    EXPECT_STREQ(connector.getNetwork()->ssid.c_str(), "Solid"); // The strongest seen one failed, the hidden one is last
+    EXPECT_EQ(connector.getProfile().attempts, 2);
+
+    history.records = {}; // Forget the access points, but not the rates
+    history.records[0].ssidHash = OswWiFiConnector::hash("Flaky");
+    history.records[0].failures = 3;
+    history.records[1].ssidHash = OswWiFiConnector::hash("Solid");
+    history.records[1].successes = 3;
+    connector.connect(radio.now);
+    radio.run(connector);
+    EXPECT_STREQ(connector.getNetwork()->ssid.c_str(), "Solid");
+    EXPECT_EQ(connector.getProfile().attempts, 1);
+
+    // Once only the hidden one is there, it is found without the scan's help
+    radio.accessPoints["Solid"].up = false;
+    radio.accessPoints["Flaky"].up = false;
+    radio.run(connector, 100);
+    EXPECT_NE((int) connector.getState(), (int) OswWiFiConnector::State::CONNECTED); // Lost and reconnecting
+    radio.run(connector);
+    ASSERT_TRUE(connector.isConnected());
+    EXPECT_STREQ(connector.getNetwork()->ssid.c_str(), "Hidden");
+    EXPECT_EQ(radio.lastChannel, 0);
+}
+
+UTEST(wifiConnector, should_adapt_the_timeouts) {
+    FakeRadio radio;
+    radio.accessPoints["Home"].authTime = 400;
+    radio.accessPoints["Home"].dhcpTime = 1500;
+    OswWiFiConnector::History history = {};
+    OswWiFiConnector connector(radio, history);
+    const OswWiFiConnector::Network home = {"Home", "x"};
+    connector.setNetworks({home});
+    EXPECT_EQ(connector.getAuthTimeout(home), OswWiFiConnector::defaultTimeout);
+    connector.connect(radio.now);
+    radio.run(connector);
+    ASSERT_TRUE(connector.isConnected());
+    EXPECT_EQ(connector.getAuthTimeout(home), OswWiFiConnector::minTimeout);
+    EXPECT_EQ(connector.getDhcpTimeout(home), 4500ul);
+
+    // Everything gone: all candidates fail within their (now shorter) timeouts
+    radio.accessPoints["Home"].up = false;
+    connector.connect(radio.now);
+    radio.run(connector);
+    EXPECT_EQ((int) connector.getState(), (int) OswWiFiConnector::State::FAILED);
+    EXPECT_LE(connector.getProfile().total, OswWiFiConnector::minTimeout + 1500 + OswWiFiConnector::minTimeout + 100);
+    EXPECT_EQ(history.records[0].failures, 1);
+}
@@ -10,6 +10,7 @@
 
 #include <osw_hal.h>
 #include <osw_config.h>
+#include <osw_config_keys.h>
 
 extern int emulatorMainArgc;
 extern char** emulatorMainArgv;
@@ -124,6 +125,27 @@ UTEST(emulator, run_headless_wakeupconfig_selectanduse) {
     EXPECT_FALSE(run_headless_test_wakeupconfigs_expired);
 }
 
+UTEST(emulator, run_headless_lightsleep_resume) {
+    CaptureSerialFixture capture;
+    PreferencesFixture prefsFixture;
+    EmulatorFixture runEmu(true);
+    std::this_thread::sleep_for(std::chrono::seconds(1)); // Let the OS boot up
+    OswConfig::getInstance()->enableWrite();
+    OswConfigAllKeys::lightSleepEnabled.set(true);
+    OswConfig::getInstance()->disableWrite();
+    const unsigned boots = runEmu.oswEmu->getBootCount();
+    ASSERT_GE(boots, 1u);
+
+    // The auto wakeup revives the OS right away
+    runEmu.oswEmu->requestSleep(OswEmulator::RequestSleepState::light);
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    EXPECT_TRUE(runEmu.oswEmu->getCpuState() == OswEmulator::CPUState::active);
+    EXPECT_EQ(runEmu.oswEmu->getBootCount(), boots); // Resumed, not set up again
+    EXPECT_LE(std::abs((long) (OswHal::getInstance()->getUTCTime() - time(nullptr))), 1L); // Still on the time of the provider
+    EXPECT_GE(runEmu.oswEmu->getLastWakeLatency(), 0L); // A frame was shown
+    EXPECT_LT(runEmu.oswEmu->getLastWakeLatency(), 1000L);
+}
+
 UTEST(emulator, run_normal) {
     for(int i = 0; i < ::emulatorMainArgc; ++i)
         if(strcmp(::emulatorMainArgv[i], "--headless") == 0)
@@ -1,15 +1,18 @@
 #pragma once
 
 #include <Serial.h>
+#include <OswLogger.h>
 
 class CaptureSerialFixture {
   public:
     CaptureSerialFixture() {
+        OswLogger::getInstance()->flush(); // Do not capture messages queued before
         Serial.setBuffered(true);
         Serial.begin(115200);
         Serial.buffer.clear(); // Tests tend to not like the remains of other runs
     }
     ~CaptureSerialFixture() {
+        OswLogger::getInstance()->flush();
         Serial.setBuffered(false);
         // Clear is already done by the Serial class
     }
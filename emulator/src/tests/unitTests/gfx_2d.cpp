@@ -0,0 +1,268 @@
+#include <cstring>
+
+#include "utest.h"
+
+#include "../../../include/gfx_2d.h"
+
+static void drawScene(Graphics2D& gfx) {
+    gfx.fillBuffer(rgb565(10, 20, 30));
+    gfx.fillFrame(20, 10, 100, 50, rgb565(255, 0, 0));
+    gfx.drawLine(0, 0, 119, 119, rgb565(0, 255, 0));
+    gfx.drawVLine(60, 5, 100, rgb565(0, 0, 255));
+    gfx.fillCircle(60, 60, 30, rgb565(255, 255, 0));
+    gfx.drawCircleAA(60, 60, 40, 3, rgb565(0, 255, 255));
+    gfx.drawThickLineAA(10, 100, 110, 30, 4, rgb565(255, 0, 255));
+    gfx.dim(40);
+    gfx.drawHLine(0, 119, 120, rgb565(255, 255, 255));
+}
+
+/**
+ * Renders all strips and compares them against the reference with a full buffer
+ */
+static int countMismatches(Graphics2D& strips, Graphics2D& reference) {
+    int mismatches = 0;
+    for (uint16_t strip = 0; strip < strips.getNumChunks(); strip += strips.getStripChunks()) {
+        strips.renderStrip(strip);
+        for (uint16_t chunk = strip; chunk < strip + strips.getStripChunks() && chunk < strips.getNumChunks(); chunk++)
+            for (int i = 0; i < strips.getChunkWidth(chunk) << strips.getChunkHeightLd(); i++)
+                if (strips.getChunk(chunk)[i] != reference.getChunk(chunk)[i])
+                    ++mismatches;
+    }
+    return mismatches;
+}
+
+UTEST(gfx2d, strip_buffer_should_match_full_buffer) {
+    Graphics2D reference(120, 120, 3);
+    Graphics2D strips(120, 120, 3);
+    strips.enableStripBuffer(2, 4096);
+    EXPECT_FALSE(strips.hasBuffer());
+    EXPECT_TRUE(strips.hasStripBuffer());
+
+    drawScene(reference);
+    drawScene(strips);
+
+    EXPECT_EQ(strips.getDisplayListOverflows(), 0U);
+    EXPECT_LT(strips.getDisplayListLength(), 4096);
+    EXPECT_EQ(countMismatches(strips, reference), 0);
+}
+
+UTEST(gfx2d, strip_buffer_should_coalesce_runs) {
+    Graphics2D strips(120, 120, 3);
+    strips.enableStripBuffer(1, 64);
+    strips.fill(rgb565(0, 0, 0));
+    strips.fillFrame(10, 10, 20, 20, rgb565(255, 255, 255)); // One run per row
+    strips.drawVLine(5, 0, 120, rgb565(255, 0, 0)); // One run
+
+    EXPECT_EQ(strips.getDisplayListLength(), 21);
+
+    // A new frame discards the previous operations
+    strips.fillBuffer(rgb565(0, 0, 0));
+    EXPECT_EQ(strips.getDisplayListLength(), 0);
+}
+
+UTEST(gfx2d, strip_buffer_should_count_overflows) {
+    Graphics2D reference(120, 120, 3);
+    Graphics2D strips(120, 120, 3);
+    strips.enableStripBuffer(1, 4);
+    for (Graphics2D* gfx : {&reference, &strips}) {
+        gfx->fillBuffer(rgb565(0, 0, 0));
+        for (int i = 0; i < 6; i++)
+            gfx->drawPixel(i * 10, i * 10, rgb565(255, 255, 255));
+    }
+
+    EXPECT_EQ(strips.getDisplayListOverflows(), 2U);
+    EXPECT_EQ(countMismatches(strips, reference), 2); // The last two pixels are missing
+}
+
+/**
+ * Spill of a display, which only keeps what it got
+ */
+class FakeSpill : public DisplayListSpill {
+  public:
+    Graphics2D display = Graphics2D(120, 120, 3);
+    int begun = 0;
+
+    void begin(Graphics2D* gfx) override {
+        ++this->begun;
+        Graphics2D& strips = *gfx;
+        for (uint16_t strip = 0; strip < strips.getNumChunks(); strip += strips.getStripChunks()) {
+            strips.renderStrip(strip);
+            for (uint16_t chunk = strip; chunk < strip + strips.getStripChunks() && chunk < strips.getNumChunks(); chunk++)
+                memcpy(this->display.getChunk(chunk), strips.getChunk(chunk), (strips.getChunkWidth(chunk) << strips.getChunkHeightLd()) * sizeof(uint16_t));
+        }
+    };
+    void drawPixel(int32_t x, int32_t y, uint16_t color) override {
+        this->display.drawPixel(x, y, color);
+    };
+};
+
+UTEST(gfx2d, strip_buffer_should_spill_overflows) {
+    Graphics2D reference(120, 120, 3);
+    Graphics2D strips(120, 120, 3);
+    FakeSpill spill;
+    strips.enableStripBuffer(1, 4);
+    strips.setDisplayListSpill(&spill);
+    for (Graphics2D* gfx : {&reference, &strips}) {
+        gfx->fillBuffer(rgb565(0, 0, 0));
+        for (int i = 0; i < 6; i++)
+            gfx->drawPixel(i * 10, i * 10, rgb565(255, 255, 255));
+        gfx->drawHLine(0, 100, 50, rgb565(255, 0, 0));
+    }
+
+    EXPECT_EQ(spill.begun, 1);
+    EXPECT_TRUE(strips.isDisplayListSpilled());
+    EXPECT_EQ(strips.getDisplayListOverflows(), 52U); // The last two pixels and the line, pixel by pixel
+    for (uint16_t chunk = 0; chunk < reference.getNumChunks(); chunk++)
+        EXPECT_EQ(memcmp(spill.display.getChunk(chunk), reference.getChunk(chunk), (120 << 3) * sizeof(uint16_t)), 0);
+
+    // The next frame is recorded again
+    strips.fillBuffer(rgb565(0, 0, 0));
+    EXPECT_FALSE(strips.isDisplayListSpilled());
+}
+
+UTEST(gfx2d, strip_buffer_should_replay_for_get_pixel) {
+    Graphics2D strips(120, 120, 3);
+    strips.enableStripBuffer(2, 64);
+    strips.fillBuffer(rgb565(0, 0, 255));
+    strips.drawPixel(10, 100, rgb565(255, 0, 0));
+    EXPECT_EQ(strips.getPixel(10, 100), rgb565(255, 0, 0));
+    EXPECT_EQ(strips.getPixel(10, 5), rgb565(0, 0, 255));
+
+    // Also after more was recorded into the strip already replayed
+    strips.drawPixel(11, 5, rgb565(0, 255, 0));
+    EXPECT_EQ(strips.getPixel(11, 5), rgb565(0, 255, 0));
+    strips.fillBuffer(rgb565(0, 0, 0));
+    EXPECT_EQ(strips.getPixel(11, 5), rgb565(0, 0, 0));
+}
+
+UTEST(gfx2d, strip_buffer_should_support_round_displays) {
+    Graphics2D reference(240, 240, 3, true);
+    Graphics2D strips(240, 240, 3, true);
+    strips.enableStripBuffer(2, 4096);
+
+    drawScene(reference);
+    drawScene(strips);
+
+    EXPECT_EQ(countMismatches(strips, reference), 0);
+
+    // And it is possible to switch back
+    strips.enableBuffer();
+    EXPECT_TRUE(strips.hasBuffer());
+    EXPECT_FALSE(strips.hasStripBuffer());
+}
+
+UTEST(gfx2d, span_should_match_pixels) {
+    for (bool round : {false, true}) {
+        Graphics2D reference(240, 240, 3, round);
+        Graphics2D spans(240, 240, 3, round);
+        reference.fillBuffer(rgb565(0, 0, 0));
+        spans.fillBuffer(rgb565(0, 0, 0));
+
+        uint16_t colors[300];
+        for (uint16_t i = 0; i < 300; i++)
+            colors[i] = i * 97;
+        // Partially outside of the screen (and of the chunks of round displays)
+        for (int32_t y = -5; y < 245; y += 7) {
+            for (uint16_t i = 0; i < 300; i++)
+                reference.drawPixel(y - 30 + i, y, colors[i]);
+            spans.drawSpan(y - 30, y, colors, 300);
+        }
+        for (uint16_t chunk = 0; chunk < spans.getNumChunks(); chunk++)
+            for (int i = 0; i < spans.getChunkWidth(chunk) << spans.getChunkHeightLd(); i++)
+                ASSERT_EQ(spans.getChunk(chunk)[i], reference.getChunk(chunk)[i]);
+    }
+}
+
+UTEST(gfx2d, pixels_should_match_single_pixels) {
+    for (bool round : {false, true}) {
+        Graphics2D reference(240, 240, 3, round);
+        Graphics2D pixels(240, 240, 3, round);
+        reference.fillBuffer(rgb565(0, 0, 0));
+        pixels.fillBuffer(rgb565(0, 0, 0));
+
+        // Scattered all over (and beyond) the screen, including the corners round displays do not have
+        int16_t x[500];
+        int16_t y[500];
+        uint16_t colors[500];
+        for (uint16_t i = 0; i < 500; i++) {
+            x[i] = (i * 37) % 260 - 10;
+            y[i] = (i * 53) % 260 - 10;
+            colors[i] = i * 131;
+            reference.drawPixel(x[i], y[i], colors[i]);
+        }
+        pixels.drawPixels(x, y, colors, 500);
+        for (uint16_t chunk = 0; chunk < pixels.getNumChunks(); chunk++)
+            for (int i = 0; i < pixels.getChunkWidth(chunk) << pixels.getChunkHeightLd(); i++)
+                ASSERT_EQ(pixels.getChunk(chunk)[i], reference.getChunk(chunk)[i]);
+    }
+}
+
+UTEST(gfx2d, dim_area_should_only_dim_inside) {
+    Graphics2D gfx(120, 120, 3);
+    gfx.fillBuffer(rgb565(200, 200, 200));
+    gfx.dimArea(-10, 30, 50, 20, 40);
+    EXPECT_EQ(gfx.getPixel(0, 30), dimColor(rgb565(200, 200, 200), 40));
+    EXPECT_EQ(gfx.getPixel(39, 49), dimColor(rgb565(200, 200, 200), 40));
+    EXPECT_EQ(gfx.getPixel(40, 49), rgb565(200, 200, 200));
+    EXPECT_EQ(gfx.getPixel(0, 29), rgb565(200, 200, 200));
+    EXPECT_EQ(gfx.getPixel(0, 50), rgb565(200, 200, 200));
+
+    // The same from the display list of a strip buffer
+    Graphics2D strips(120, 120, 3);
+    strips.enableStripBuffer(2, 4096);
+    strips.fillBuffer(rgb565(200, 200, 200));
+    strips.dimArea(-10, 30, 50, 20, 40);
+    EXPECT_EQ(countMismatches(strips, gfx), 0);
+}
+
+UTEST(gfx2d, frame_should_be_one_aligned_block) {
+    Graphics2D gfx(240, 240, 3, true);
+    // Only as big as the round display, not as the square around it
+    EXPECT_LT(gfx.getFrameMemorySize(), (size_t) 240 * 240 * 2 * 82 / 100);
+    for (uint16_t chunk = 0; chunk < gfx.getNumChunks(); chunk++) {
+        EXPECT_EQ((uintptr_t) gfx.getChunk(chunk) % 4, (uintptr_t) 0);
+        if (chunk > 0) {
+            const uint16_t* previousEnd = gfx.getChunk(chunk - 1) + (gfx.getChunkWidth(chunk - 1) << gfx.getChunkHeightLd());
+            EXPECT_LE(gfx.getChunk(chunk) - previousEnd, 1);
+            EXPECT_GE(gfx.getChunk(chunk) - previousEnd, 0);
+        }
+    }
+}
+
+UTEST(gfx2d, reserved_frame_should_stay_in_place) {
+    Graphics2D gfx(120, 120, 3, true);
+    gfx.setFrameMemoryReserved(true);
+    uint16_t* first = gfx.getChunk(0);
+    const size_t size = gfx.getFrameMemorySize();
+    gfx.enableStripBuffer(2, 64);
+    EXPECT_EQ(gfx.getFrameMemorySize(), size);
+    gfx.disableBuffer(NULL);
+    gfx.enableBuffer();
+    EXPECT_EQ(gfx.getChunk(0), first);
+
+    // Without the reservation it is gone as soon as the buffer is
+    gfx.setFrameMemoryReserved(false);
+    gfx.enableStripBuffer(2, 64);
+    EXPECT_EQ(gfx.getFrameMemorySize(), (size_t) 0);
+}
+
+UTEST(gfx2d, double_buffer_should_swap_frames) {
+    Graphics2D gfx(120, 120, 3);
+    gfx.enableBuffer(true);
+    ASSERT_TRUE(gfx.isDoubleBuffered());
+    gfx.fillBuffer(rgb565(255, 0, 0));
+    gfx.swapBuffers();
+    EXPECT_EQ(gfx.getFrontChunk(0)[0], rgb565(255, 0, 0));
+    gfx.fillBuffer(rgb565(0, 255, 0));
+    EXPECT_EQ(gfx.getFrontChunk(0)[0], rgb565(255, 0, 0));
+    gfx.swapBuffers();
+    EXPECT_EQ(gfx.getFrontChunk(0)[0], rgb565(0, 255, 0));
+    EXPECT_EQ(gfx.getPixel(0, 0), rgb565(255, 0, 0)); // The back frame, until drawn over
+    EXPECT_EQ(gfx.getShownPixel(0, 0), rgb565(0, 255, 0)); // What the display shows
+    EXPECT_EQ(gfx.getShownChunk(0)[0], rgb565(0, 255, 0));
+
+    gfx.enableBuffer();
+    EXPECT_FALSE(gfx.isDoubleBuffered());
+    gfx.fillBuffer(rgb565(0, 0, 255));
+    EXPECT_EQ(gfx.getShownPixel(0, 0), rgb565(0, 0, 255));
+}
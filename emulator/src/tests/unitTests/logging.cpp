@@ -1,3 +1,7 @@
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "utest.h"
 
 #include <OswLogger.h>
@@ -82,4 +86,131 @@ UTEST(logging, newlines) {
     String str("[String&] This is a line.\nThis is another line.");
     OSW_LOG_I(str);
     EXPECT_LASTLINE_MSG("I", "This is another line.");
-}
\ No newline at end of file
+}
+/**
+ * The following tests use their own logger instances, so they can control the buffer size and flushing
+ */
+
+static std::vector<std::string> capturedLines() {
+    std::vector<std::string> lines;
+    for(auto& line : Serial.buffer)
+        lines.push_back(line.str());
+    return lines;
+}
+
+static std::string messageOf(const std::string& line) {
+    return line.substr(line.rfind(": ") + 2);
+}
+
+UTEST(logging, deferred_keeps_order) {
+    CaptureSerialFixture capture;
+    OswLogger logger;
+    logger.setDeferred(true);
+    for(int i = 0; i < 20; i++)
+        logger.info(__FILE__, __LINE__, "Message ", i, i % 2 == 0 ? " (even)" : " (odd)");
+    EXPECT_EQ(Serial.buffer.size(), (size_t) 0); // Nothing printed yet
+    logger.flush();
+
+    const std::vector<std::string> lines = capturedLines();
+    ASSERT_EQ(lines.size(), (size_t) 20);
+    for(int i = 0; i < 20; i++)
+        EXPECT_STREQ(messageOf(lines[i]).c_str(), ("Message " + std::to_string(i) + (i % 2 == 0 ? " (even)" : " (odd)")).c_str());
+    EXPECT_EQ(logger.getDropped(), 0U);
+}
+
+UTEST(logging, deferred_wraps_around) {
+    CaptureSerialFixture capture;
+    OswLogger logger(256);
+    logger.setDeferred(true);
+    // Way more than the ring can hold at once, but it is drained in between
+    for(int i = 0; i < 100; i++) {
+        logger.info(__FILE__, __LINE__, std::string(i % 7, 'x'), i);
+        if(i % 3 == 2)
+            logger.flush();
+    }
+    logger.flush();
+
+    const std::vector<std::string> lines = capturedLines();
+    ASSERT_EQ(lines.size(), (size_t) 100);
+    for(int i = 0; i < 100; i++)
+        EXPECT_STREQ(messageOf(lines[i]).c_str(), (std::string(i % 7, 'x') + std::to_string(i)).c_str());
+    EXPECT_EQ(logger.getDropped(), 0U);
+}
+
+UTEST(logging, overflow_is_counted) {
+    CaptureSerialFixture capture;
+    OswLogger logger(256);
+    logger.setDeferred(true);
+    for(int i = 0; i < 50; i++)
+        logger.info(__FILE__, __LINE__, "Message ", i);
+    const uint32_t dropped = logger.getDropped();
+    EXPECT_GT(dropped, 0U);
+    logger.flush();
+
+    // The first messages made it, followed by a warning about the rest
+    const std::vector<std::string> lines = capturedLines();
+    ASSERT_EQ(lines.size(), (size_t) (50 - dropped + 1));
+    for(size_t i = 0; i < lines.size() - 1; i++)
+        EXPECT_STREQ(messageOf(lines[i]).c_str(), ("Message " + std::to_string(i)).c_str());
+    EXPECT_EQ(lines.back().rfind("W: ", 0), (size_t) 0);
+    EXPECT_NE(lines.back().find("Dropped " + std::to_string(dropped) + " log message(s)"), std::string::npos);
+
+    // Once there is space again, messages are accepted again
+    logger.info(__FILE__, __LINE__, "Recovered");
+    logger.flush();
+    EXPECT_STREQ(messageOf(capturedLines().back()).c_str(), "Recovered");
+    EXPECT_EQ(logger.getDropped(), dropped);
+}
+
+UTEST(logging, oversized_messages_keep_order) {
+    CaptureSerialFixture capture;
+    OswLogger logger(256);
+    logger.setDeferred(true);
+    logger.info(__FILE__, __LINE__, "First");
+    logger.info(__FILE__, __LINE__, std::string(300, 'x')); // Too large for the ring, printed directly
+    logger.info(__FILE__, __LINE__, "Last");
+    logger.flush();
+
+    const std::vector<std::string> lines = capturedLines();
+    ASSERT_EQ(lines.size(), (size_t) 3);
+    EXPECT_STREQ(messageOf(lines[0]).c_str(), "First");
+    EXPECT_STREQ(messageOf(lines[1]).c_str(), std::string(300, 'x').c_str());
+    EXPECT_STREQ(messageOf(lines[2]).c_str(), "Last");
+}
+
+UTEST(logging, multi_threaded_producers) {
+    CaptureSerialFixture capture;
+    constexpr int threads = 4;
+    constexpr int messages = 500;
+    OswLogger logger;
+    logger.startFlusher();
+    {
+        std::vector<std::jthread> producers;
+        for(int t = 0; t < threads; t++)
+            producers.emplace_back([&logger, t]() {
+                for(int i = 0; i < messages; i++)
+                    logger.info(__FILE__, __LINE__, "Thread ", t, " message ", i);
+            });
+    }
+    logger.stopFlusher();
+
+    // Every message appears at most once and in the order of its thread, lost ones are reported
+    int next[threads] = {0};
+    int received = 0;
+    size_t droppedReported = 0;
+    for(const std::string& line : capturedLines()) {
+        int t, i;
+        if(sscanf(messageOf(line).c_str(), "Thread %d message %d", &t, &i) == 2) {
+            ASSERT_TRUE(t >= 0 and t < threads);
+            EXPECT_GE(i, next[t]);
+            next[t] = i + 1;
+            ++received;
+        } else {
+            size_t count = 0;
+            EXPECT_EQ(sscanf(line.substr(line.find("Dropped ")).c_str(), "Dropped %zu", &count), 1);
+            droppedReported += count;
+        }
+    }
+    EXPECT_EQ(received + logger.getDropped(), (uint32_t) (threads * messages));
+    EXPECT_EQ(droppedReported, (size_t) logger.getDropped());
+}
@@ -1,9 +1,12 @@
 #ifndef ArduinoGraphics2DCanvas_H
 #define ArduinoGraphics2DCanvas_H
 
+#include <memory>
+
 #include <Arduino_GFX.h>
 #include <gfx_2d_print.h>
 #include "config_defaults.h"
+#include "OswDisplayFlushQueue.h"
 
 class Arduino_Canvas_Graphics2D : public Graphics2DPrint {
   public:
@@ -25,6 +28,39 @@ class Arduino_Canvas_Graphics2D : public Graphics2DPrint {
 
     void flush();
 
+    /**
+     * Let the next flush() only send the chunks covering the rows y to y + h - 1, as the display still shows the
+     * unchanged rest of the previous frame. The limit is dropped after that flush. With h = 0 nothing is sent, but the
+     * frame is still reported as done.
+     */
+    void limitNextFlush(int16_t y, uint16_t h);
+    void resetFlushLimit();
+    /**
+     * Number of rows sent by the last flush()
+     */
+    uint16_t getLastFlushRows() const {
+        return this->_lastFlushRows;
+    }
+
+    /**
+     * Let flush() only copy the chunks into transfer buffers, which are then sent by a background worker. While the
+     * async flush is enabled, anybody else talking to the output must call waitForFlush() first!
+     *
+     * @param bufferCount Number of chunk sized transfer buffers, two are enough to keep the bus busy
+     */
+    void enableAsyncFlush(uint8_t bufferCount);
+    void disableAsyncFlush();
+    bool asyncFlushEnabled() const {
+        return (bool) this->_flushQueue;
+    }
+    /**
+     * Blocks until all chunks of the previous flush() were sent to the output
+     */
+    void waitForFlush();
+    OswDisplayFlushQueue* getFlushQueue() {
+        return this->_flushQueue.get();
+    }
+
     inline void begin(int32_t speed = GFX_NOT_DEFINED) {
         _output->begin(speed);
         // _output->fillScreen(BLACK);
@@ -43,8 +79,29 @@ class Arduino_Canvas_Graphics2D : public Graphics2DPrint {
   protected:
     Arduino_G* _output;
     int16_t _output_x, _output_y;
+    std::unique_ptr<OswDisplayFlushQueue> _flushQueue;
+    int16_t _flushLimitStart = 0;
+    int16_t _flushLimitEnd = INT16_MAX; // Exclusive
+    uint16_t _lastFlushRows = 0;
 
   private:
+    /**
+     * Sends the strips recorded so far, then draws the rest of the frame pixel by pixel to the output
+     */
+    class OutputSpill : public DisplayListSpill {
+      public:
+        OutputSpill(Arduino_Canvas_Graphics2D* canvas) : canvas(canvas) {};
+        void begin(Graphics2D* gfx) override;
+        void drawPixel(int32_t x, int32_t y, uint16_t color) override;
+
+      private:
+        Arduino_Canvas_Graphics2D* canvas;
+    };
+    OutputSpill _spill;
+
+    void flushStrips(uint16_t firstChunk, uint16_t lastChunk, bool endOfFrame);
+    void flushNothing();
+    void flushChunk(uint8_t chunk, bool lastOfFrame);
 };
 
 #endif
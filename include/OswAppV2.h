@@ -42,6 +42,7 @@ class OswAppV2 {
 #endif
 
     virtual const ViewFlags& getViewFlags();
+    virtual uint8_t getCpuFrequency(); // Fixed CPU clock (in MHz) while this app is shown, 0 lets the governor decide
     virtual bool getNeedsRedraw();
     virtual void resetNeedsRedraw();
   protected:
@@ -69,6 +70,7 @@ class OswAppV2 {
     OswUiProxy ui;
     std::array<ButtonStateNames, BTN_NUMBER> knownButtonStates; // Bitmask of known button states, use this to ignore unhandled button states
     ViewFlags viewFlags = ViewFlags::NONE;
+    uint8_t cpuFrequency = 0;
     bool needsRedraw = false;
     const OswIcon& getDefaultAppIcon();
     void clearKnownButtonStates();
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Streams a file from the storage of the watch to the phone over two characteristics: the phone writes commands to the
+ * control point (and gets the replies as its notifications), the file itself comes as notifications of the data
+ * characteristic. All integers are little endian.
+ *
+ *   OPEN   phone -> watch  u8:0x01 u32:offset u8:window name...
+ *   OPENED watch -> phone  u8:0x81 u8:status u32:size u32:offset u16:payload
+ *   ACK    phone -> watch  u8:0x02 u16:seq          all frames up to (and including) seq arrived
+ *   REWIND phone -> watch  u8:0x03 u16:seq          frame seq is missing or broken, send again from there
+ *   ABORT  phone -> watch  u8:0x04
+ *   DONE   watch -> phone  u8:0x82 u8:status        all frames acknowledged (or the transfer failed)
+ *   frame  watch -> phone  u16:seq payload... u16:crc
+ *
+ * Every frame carries "payload" bytes (the last one less) of the file, frame 0 starts at the offset of the OPEN - so a
+ * transfer is resumed by opening it again at the number of bytes already received. The CRC is the CRC-16/CCITT-FALSE
+ * of the sequence number and the payload. At most "window" frames are unacknowledged at a time, if no acknowledgement
+ * comes in for ackTimeout, the unacknowledged ones are sent again (until maxRetries).
+ *
+ * Only one frame is held in RAM, the rest stays in the file. Only files registered with addFile() can be opened, by
+ * their name. This part does not know NimBLE, it talks to the phone through a Transport.
+ */
+class OswBLEBulkTransfer {
+  public:
+    enum class Opcode : uint8_t { OPEN = 0x01, ACK = 0x02, REWIND = 0x03, ABORT = 0x04, OPENED = 0x81, DONE = 0x82 };
+    enum class Status : uint8_t { OK, NOT_FOUND, BAD_OFFSET, BAD_REQUEST, IO_ERROR, TIMEOUT, ABORTED };
+
+    class Transport {
+      public:
+        virtual ~Transport() {};
+        /**
+         * Largest notification the connection carries (ATT MTU - 3)
+         */
+        virtual size_t getMaxNotificationSize() = 0;
+        /**
+         * @return false if there is no room for the frame right now (it is tried again on the next loop())
+         */
+        virtual bool sendData(const uint8_t* data, size_t length) = 0;
+        virtual void sendControl(const uint8_t* data, size_t length) = 0;
+    };
+
+    struct Stats {
+        uint32_t size = 0; // Bytes of the file at OPEN
+        uint32_t offset = 0; // Bytes skipped by the OPEN (resume)
+        uint32_t bytes = 0; // Bytes acknowledged by the phone
+        uint32_t frames = 0; // Frames sent, including the retransmissions
+        uint32_t retransmissions = 0;
+        unsigned long duration = 0; // ms from OPEN until DONE (or now, while running)
+        Status status = Status::OK;
+    };
+
+    static constexpr size_t maxFrameSize = 244; // The largest notification fitting a single link layer packet (with the data length extension)
+    static constexpr size_t frameOverhead = 4; // Sequence number and CRC
+    static constexpr uint8_t maxWindow = 32;
+    static constexpr unsigned long ackTimeout = 1000; // ms
+    static constexpr uint8_t maxRetries = 5;
+
+    OswBLEBulkTransfer(Transport& transport) : transport(transport) {};
+    ~OswBLEBulkTransfer();
+    OswBLEBulkTransfer(const OswBLEBulkTransfer&) = delete;
+    OswBLEBulkTransfer& operator=(const OswBLEBulkTransfer&) = delete;
+
+    /**
+     * Makes the file at path available to OPEN as name
+     */
+    void addFile(const std::string& name, const std::string& path);
+    /**
+     * A write of the phone to the control point
+     */
+    void onControl(const uint8_t* data, size_t length, unsigned long now);
+    /**
+     * Sends the frames the window allows and handles the timeouts - call this as often as possible while isActive()
+     */
+    void loop(unsigned long now);
+    /**
+     * Stops the transfer without telling the phone (e.g. because it disconnected)
+     */
+    void cancel();
+    bool isActive() const {
+        return this->file != nullptr;
+    };
+    /**
+     * Of the current (or last) transfer
+     */
+    Stats getStats(unsigned long now) const;
+
+    static uint16_t crc16(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+  private:
+    Transport& transport;
+    std::vector<std::pair<std::string, std::string>> files; // name, path
+    FILE* file = nullptr;
+    uint32_t size = 0;
+    uint32_t offset = 0;
+    uint16_t payload = 0;
+    uint8_t window = 0;
+    uint32_t frameCount = 0;
+    uint32_t acked = 0; // Frames the phone has
+    uint32_t next = 0; // Frame to send next
+    uint32_t sentMax = 0; // Frames sent at least once
+    long position = -1; // Of the file, -1 if unknown
+    unsigned long startedAt = 0;
+    unsigned long progressAt = 0; // Last acknowledgement (or retransmission)
+    uint8_t retries = 0;
+    Stats stats;
+    uint8_t frame[maxFrameSize];
+
+    void open(const uint8_t* data, size_t length, unsigned long now);
+    void finish(Status status, unsigned long now);
+    void sendOpened(Status status);
+    /**
+     * The absolute frame number of a sequence number, which has to be in [acked, sentMax]
+     */
+    bool resolve(uint16_t seq, uint32_t& number) const;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * The values the BLE server shares with the phone, encoded once per sample (so reads do not recompute them) and
+ * pushed as notifications to the subscribed characteristics - but only if they changed, and at most once per window:
+ * a change after a quiet window goes out right away, all further ones within the window are coalesced into one
+ * notification with the latest value at its end.
+ *
+ * It also decides the workload of the connection, so the server can ask the phone for fitting connection parameters:
+ * a short interval while syncing, a long one while idle.
+ *
+ * This part does not know NimBLE at all - the server feeds it samples and sends whatever flush() hands out.
+ */
+class OswBLELiveData {
+  public:
+    struct Values {
+        uint8_t batteryPercent = 0;
+        bool charging = false;
+        bool hasSteps = false;
+        uint32_t stepsToday = 0;
+        uint32_t stepsTotalWeek = 0;
+        uint32_t stepsTotal = 0;
+        uint32_t stepsAverage = 0;
+    };
+    enum class Channel : uint8_t { BATTERY_LEVEL, BATTERY_LEVEL_STATUS, STEPS_TODAY, STEPS_TOTAL_WEEK, STEPS_TOTAL, STEPS_AVERAGE, LIVE_STATUS, COUNT };
+    enum class Workload : uint8_t {
+        IDLE, // Nobody listens, only reads now and then
+        LIVE, // Notifications are subscribed
+        SYNC // A lot of data is transferred right now
+    };
+    struct ConnectionParameters {
+        uint16_t minInterval; // 1.25 ms units
+        uint16_t maxInterval; // 1.25 ms units
+        uint16_t latency; // Connection events the watch may skip
+        uint16_t timeout; // 10 ms units
+    };
+
+    static constexpr size_t maxPayload = 20; // Fits into a single notification at the default MTU (23 - 3 bytes header)
+    static constexpr size_t liveStatusSize = 15;
+    static constexpr uint8_t liveStatusVersion = 1;
+    static constexpr unsigned long defaultWindow = 1000; // ms
+    static constexpr unsigned long syncHold = 5000; // ms the sync workload lasts after the last sync activity
+
+    OswBLELiveData(unsigned long window = defaultWindow) : window(window) {};
+
+    /**
+     * Encodes a new sample of all values - only changed ones are notified later on
+     */
+    void update(const Values& values);
+    void setSubscribed(Channel channel, bool subscribed);
+    /**
+     * Calls send(channel, data, length) for every subscribed channel with a changed value whose window passed
+     *
+     * @return The number of notifications
+     */
+    template<typename F> size_t flush(unsigned long now, F send) {
+        size_t sent = 0;
+        for(size_t i = 0; i < (size_t) Channel::COUNT; i++) {
+            Slot& slot = this->slots[i];
+            if(!slot.subscribed or !slot.pending or (slot.hasSent and now - slot.sentAt < this->window))
+                continue;
+            slot.pending = false;
+            slot.hasSent = true;
+            slot.sentAt = now;
+            slot.sentLength = slot.length;
+            slot.sent = slot.value;
+            send((Channel) i, slot.value.data(), slot.length);
+            ++sent;
+        }
+        return sent;
+    };
+    /**
+     * The latest encoding (e.g. for a read), length 0 if there was no sample yet
+     */
+    size_t get(Channel channel, uint8_t* out) const;
+
+    /**
+     * Marks a transfer which needs the fast connection (e.g. a sync of the history)
+     */
+    void noteSyncActivity(unsigned long now);
+    Workload getWorkload(unsigned long now) const;
+    static ConnectionParameters getConnectionParameters(Workload workload);
+
+    static size_t encodeUInt32(uint32_t value, uint8_t* out);
+    static size_t encodeBatteryLevel(const Values& values, uint8_t* out);
+    /**
+     * See the "Battery Level Status" of https://www.bluetooth.com/specifications/specs/battery-service/
+     */
+    static size_t encodeBatteryLevelStatus(const Values& values, uint8_t* out);
+    /**
+     * Version, flags (bit 0 charging, bit 1 steps valid), battery (%), steps today, steps of the week and steps total
+     * (32 bit little endian each) - everything a watch face on the phone needs, in one notification. No time, as that
+     * would change (and be notified) all the time.
+     */
+    static size_t encodeLiveStatus(const Values& values, uint8_t* out);
+
+  private:
+    struct Slot {
+        std::array<uint8_t, maxPayload> value = {};
+        uint8_t length = 0;
+        std::array<uint8_t, maxPayload> sent = {};
+        uint8_t sentLength = 0;
+        bool subscribed = false;
+        bool pending = false; // value differs from sent
+        bool hasSent = false;
+        unsigned long sentAt = 0;
+    };
+
+    const unsigned long window;
+    std::array<Slot, (size_t) Channel::COUNT> slots;
+    bool hasSync = false;
+    unsigned long lastSync = 0;
+
+    void set(Channel channel, const uint8_t* data, size_t length);
+};
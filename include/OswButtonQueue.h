@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#ifdef OSW_EMULATOR
+#include <mutex>
+#else
+#include <Arduino.h> // portMUX_TYPE
+#endif
+
+#include <hal/buttons.h>
+#include <osw_pins.h> // BTN_NUMBER
+
+/**
+ * Button edges are pushed here (by the GPIO interrupts, the emulator or the polling of platforms without them) with
+ * the millis() they happened at. The main loop drains them once per iteration - so the timing of a press does not
+ * depend on how long a frame takes, and a tap shorter than a frame is not lost.
+ *
+ * Debouncing is done on the timestamps while draining: a new level is only accepted after it was stable for
+ * debounceTime, but it is reported with the timestamp of the edge that started it.
+ */
+class OswButtonQueue {
+  public:
+    struct Edge {
+        unsigned long timestamp; // millis()
+        Button button;
+        bool down;
+    };
+
+    static constexpr size_t capacity = 32; // Must be a power of two
+    static constexpr unsigned long debounceTime = 20; // ms
+
+    static OswButtonQueue& getInstance() {
+        return instance;
+    };
+
+    /**
+     * Queues a raw edge (which may be bouncing) - safe to call from an interrupt and the tasks at the same time, drops
+     * the edge if the queue is full
+     */
+    void push(Button button, bool down, unsigned long timestamp);
+    /**
+     * Consumes all queued raw edges and writes the debounced ones (in order) to "edges"
+     *
+     * @return The number of debounced edges written, never more than "max"
+     */
+    size_t drain(unsigned long now, Edge* edges, size_t max);
+    /**
+     * Forgets all queued edges and sets the debounced levels
+     */
+    void reset(const std::array<bool, BTN_NUMBER>& down);
+
+    /**
+     * The debounced level of the button
+     */
+    bool isDown(Button button) const {
+        return this->accepted[button];
+    };
+    /**
+     * The button changed its level, but that is not yet accepted by the debouncing
+     */
+    bool isPending(Button button) const {
+        return this->pending[button];
+    };
+    uint32_t getDropped() const {
+        return this->dropped;
+    };
+
+  private:
+    static OswButtonQueue instance;
+
+    std::array<Edge, capacity> ring = {};
+    std::atomic<uint32_t> head = 0; // Only written by the producer
+    std::atomic<uint32_t> tail = 0; // Only written by the consumer
+    std::atomic<uint32_t> dropped = 0;
+#ifdef OSW_EMULATOR
+    std::mutex producerLock; // The emulator may press buttons from several threads (GUI, tests)
+#else
+    portMUX_TYPE producerLock = portMUX_INITIALIZER_UNLOCKED; // The interrupts and the main task (resync of lost edges)
+#endif
+
+    // Debouncing (only used by the consumer)
+    std::array<bool, BTN_NUMBER> accepted = {};
+    std::array<bool, BTN_NUMBER> pending = {};
+    std::array<unsigned long, BTN_NUMBER> pendingSince = {};
+};
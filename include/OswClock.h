@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+
+/**
+ * A software clock on top of the monotonic microsecond timer, which is disciplined by a (slow and coarse) time
+ * provider every now and then - instead of asking the provider for every single timestamp.
+ *
+ * Every sample of the provider only tells that its second started somewhere in the second before the sample was
+ * taken (or exactly then, if the provider knows its second edges). The clock intersects these intervals over time,
+ * so its phase converges to the real second boundaries - and the remaining width is the uncertainty of the clock.
+ * Samples which do not fit at all step the clock. Long-term differences between the timer and the provider are
+ * tracked as drift and compensated.
+ */
+class OswClock {
+  public:
+    struct Sample {
+        time_t utc = 0; // What the provider said
+        int64_t at = 0; // getMonotonicMicros() when it said so
+        bool atSecondEdge = false; // The second utc started exactly at at, otherwise it started up to one second before
+    };
+    struct BrokenDownTime {
+        time_t time = 0;
+        uint16_t year = 1970;
+        uint8_t month = 1; // 1-12
+        uint8_t day = 1; // 1-31
+        uint8_t weekDay = 4; // 0 = Sunday
+        uint8_t hour = 0;
+        uint8_t minute = 0;
+        uint8_t second = 0;
+    };
+
+    OswClock();
+
+    /**
+     * The timer everything is based on - it never jumps and keeps running during light sleep
+     */
+    static int64_t getMonotonicMicros();
+    /**
+     * Like gmtime(), but without any locale or timezone state (and without a static result)
+     */
+    static void breakDown(time_t time, BrokenDownTime& result);
+
+    /**
+     * @return true if the clock had to step (as it was not synchronized yet or the sample contradicts it)
+     */
+    bool discipline(const Sample& sample);
+    /**
+     * Forgets everything, the next sample steps the clock
+     */
+    void reset();
+    bool isSynchronized() const;
+
+    /**
+     * Never goes backwards, unless the clock is stepped
+     */
+    int64_t getUTCMicros(int64_t now);
+    time_t getUTCTime(int64_t now);
+    /**
+     * Broken-down time of a timestamp, which is only recomputed if it differs from the last ones (e.g. on a new second)
+     */
+    BrokenDownTime getBrokenDown(time_t time);
+
+    /**
+     * Width of the interval the true time is known to be in (µs), as of the last sample
+     */
+    int64_t getUncertainty() const;
+    /**
+     * How much faster (positive) or slower the provider ticks than the timer (ppm)
+     */
+    float getDrift() const;
+    uint32_t getSteps() const;
+
+  private:
+    static constexpr int64_t edgeTolerance = 2000; // µs, interrupt latency
+    static constexpr int64_t driftTolerance = 100; // ppm the drift estimate may be off, widens the interval over time
+    static constexpr int64_t driftWindow = 600000000; // µs, minimal distance between two drift measurements
+    static constexpr int64_t driftMaxUncertainty = 20000; // µs, wider intervals are too coarse to measure the drift
+    static constexpr float driftMax = 500; // ppm, anything larger is no crystal anymore
+    static constexpr float driftSmoothing = 0.25f;
+
+    mutable std::mutex lock;
+    bool synchronized = false;
+    int64_t anchor = 0; // Timer at the last sample
+    int64_t low = 0; // Earliest possible UTC (µs) at anchor
+    int64_t high = 0; // Latest possible UTC (µs) at anchor
+    float drift = 0;
+    bool hasDrift = false;
+    bool hasDriftReference = false;
+    int64_t driftReferenceAt = 0;
+    int64_t driftReferenceUtc = 0;
+    int64_t lastReturned = INT64_MIN;
+    uint32_t steps = 0;
+
+    std::array<BrokenDownTime, 2> cache; // E.g. primary and secondary timezone
+    uint8_t nextCacheSlot = 0;
+
+    void updateDrift(int64_t at, int64_t utc);
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <OswGzip.h>
+
+/**
+ * Sends the messages of the watch to a server - without keeping a radio up for each of them, as the radios are by far
+ * the largest consumers of the watch.
+ *
+ * Messages (JSON values) are queued with a priority in the Storage, which should survive the deep sleep. A radio is
+ * only brought up once the queue is worth it: on an URGENT message, when enough bytes are queued (Policy::flushSize)
+ * or when a message waited its Policy::maxDelay. If another part of the watch has a transport up anyway, the queue is
+ * sent along right away. The queue goes out in batches, the most important messages first, each one a JSON document
+ *
+ *   {"device_id":"...","messages":[{"message_id":1,"type":0,"priority":1,"timestamp":1700000000,"data":{...}},...]}
+ *
+ * which is gzip compressed from Policy::compressSize on. Once the queue is empty, the radio goes down again. Failed
+ * batches are sent again after an exponential backoff, batches the server refuses are dropped. When the queue is full,
+ * the oldest of the least important messages make room - but never for a less important one.
+ *
+ * The transports (e.g. HTTP over WiFi) are only used through the Transport interface, so the whole pipeline can run
+ * against a fake one (or a local server). All methods may be called from any task, loop() from one of them.
+ */
+class OswCommunication {
+  public:
+    enum class MessageType : uint8_t { SENSOR_DATA, SYSTEM_STATUS, COMMAND, RESPONSE, ERROR };
+    enum class Priority : uint8_t { BACKGROUND, NORMAL, IMPORTANT, URGENT };
+    static constexpr size_t priorityCount = 4;
+
+    class Transport {
+      public:
+        enum class Result : uint8_t {
+            OK,
+            RETRY, // Temporary failure (connection lost, timeout, server busy) - the batch is sent again later
+            REJECTED // The server refuses the batch for good - it is dropped
+        };
+        virtual ~Transport() {};
+        virtual const char* getName() const = 0;
+        /**
+         * Starts the radio and the connection, without waiting for it (see isUp())
+         */
+        virtual void bringUp() = 0;
+        virtual void bringDown() = 0;
+        /**
+         * @return true if batches can be sent right now (also if someone else brought the radio up)
+         */
+        virtual bool isUp() = 0;
+        virtual bool acceptsGzip() {
+            return true;
+        };
+        /**
+         * Delivers one batch - may block up to the timeout of the transport
+         */
+        virtual Result send(const uint8_t* data, size_t length, bool compressed) = 0;
+    };
+
+    static constexpr size_t storageSize = 2048;
+    static constexpr size_t recordHeaderSize = 16;
+    static constexpr size_t maxPayloadSize = 1024;
+    static constexpr size_t maxBatchSize = 3072;
+    static constexpr size_t maxDeviceIdLength = 32;
+
+    /**
+     * The queue - plain data without any initializers, so it can be RTC_DATA_ATTR (a zeroed one is empty, and so is
+     * anything inconsistent). The records follow each other in the order they were queued:
+     *
+     *   record := u8:type u8:priority u16:length u32:id u32:queuedAt(clock) u32:timestamp payload(length)
+     */
+    struct Storage {
+        uint32_t magic;
+        uint32_t clock; // ms the queue was running, across the deep sleeps (see advanceClock())
+        uint32_t nextId;
+        uint16_t used; // Bytes of data in use
+        uint16_t count;
+        std::array<uint8_t, storageSize> data;
+    };
+
+    struct Policy {
+        size_t flushSize = 1024; // Queued bytes which are worth bringing a radio up
+        std::array<unsigned long, priorityCount> maxDelay = {15 * 60000, 5 * 60000, 30000, 0}; // ms, per priority
+        unsigned long maxAge = 24 * 3600000; // ms, older messages are dropped (0 = never)
+        unsigned long connectTimeout = 15000; // ms for a transport to come up, before the next one is tried
+        unsigned long minBackoff = 2000; // ms after the first failure, doubled on every further one...
+        unsigned long maxBackoff = 10 * 60000; // ...up to this
+        size_t compressSize = 256; // Batches from this size on are compressed
+    };
+
+    enum class State : uint8_t { IDLE, CONNECTING, SENDING, BACKOFF };
+
+    struct Stats {
+        uint32_t queued = 0;
+        uint32_t sent = 0;
+        uint32_t batches = 0;
+        uint32_t failures = 0; // Batches or connections which failed
+        uint32_t dropped = 0; // Refused by the server or too old
+        uint32_t evicted = 0; // Made room for more important ones
+        uint32_t refused = 0; // Not queued at all: too large or the queue is full of more important ones
+        uint32_t bytes = 0; // Sent, after the compression...
+        uint32_t rawBytes = 0; // ...and before
+        uint32_t radioRaises = 0;
+        unsigned long radioTime = 0; // ms the transports were up because of us
+    };
+
+    OswCommunication(Storage& storage);
+
+    /**
+     * Transports in the order of preference - add them all before the first loop()
+     */
+    void addTransport(Transport& transport);
+    void setPolicy(const Policy& policy);
+    void setDeviceId(const std::string& deviceId);
+
+    /**
+     * @param data a JSON value (usually an object), it is sent as it is
+     * @param timestamp of the message for the server (seconds since the epoch)
+     * @return false if the message was refused
+     */
+    bool enqueue(MessageType type, Priority priority, const char* data, size_t length, uint32_t timestamp, unsigned long now);
+    /**
+     * Sends the whole queue as soon as possible, also if it is not worth it yet
+     */
+    void flush();
+    /**
+     * Time which passed without the loop() running - e.g. the deep sleep - so the messages age accordingly
+     */
+    void advanceClock(unsigned long ms);
+    /**
+     * Drives the transports, call this regularly - sends at most one batch
+     */
+    void loop(unsigned long now);
+    /**
+     * @return ms until the next loop() could do anything (ULONG_MAX if only a new message would)
+     */
+    unsigned long getIdleTime(unsigned long now);
+
+    State getState();
+    /**
+     * Of batches or connections since the last batch which got through
+     */
+    uint32_t getConsecutiveFailures();
+    size_t getQueueSize();
+    Stats getStats();
+
+  private:
+    Storage& storage;
+    std::mutex lock;
+    std::vector<Transport*> transports;
+    Policy policy;
+    std::string deviceId = "OSW";
+    Stats stats;
+    State state = State::IDLE;
+    size_t current = 0; // Index of the transport in use
+    bool raised = false; // We brought the current transport up
+    bool flushRequested = false;
+    bool clockStarted = false;
+    unsigned long lastNow = 0;
+    unsigned long since = 0; // Of the current state
+    unsigned long raisedAt = 0;
+    unsigned long backoff = 0;
+    uint32_t consecutiveFailures = 0;
+    // Only used by loop(), partly without the lock
+    std::array<uint8_t, maxBatchSize> batch;
+    std::array<uint8_t, maxBatchSize> compressed;
+    std::vector<uint32_t> batchIds;
+    OswGzip gzip;
+
+    uint32_t tick(unsigned long now);
+    void clear();
+    bool isConsistent() const;
+    void remove(size_t offset);
+    bool removeId(uint32_t id);
+    void expire(uint32_t clock);
+    bool isWorthFlushing(uint32_t clock) const;
+    size_t buildBatch();
+    void raise(size_t transport, unsigned long now);
+    void lower(unsigned long now);
+    void fail(unsigned long now);
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include <ArduinoJson.h>
+
+/**
+ * A message of the companion app. All texts point into the buffer it was parsed from (see OswCompanionReceiver), so
+ * they are only valid until the next message arrives. They are not null terminated!
+ */
+struct OswCompanionMessage {
+    enum class Type : uint8_t { NOTIFICATION = 1, DISMISS = 2 };
+    static constexpr size_t maxActions = 3;
+
+    Type type = Type::NOTIFICATION;
+    uint32_t uid = 0;
+    uint32_t timestamp = 0; // Seconds since the epoch, 0 if unknown
+    std::string_view app;
+    std::string_view title;
+    std::string_view contents;
+    std::array<std::string_view, maxActions> actions;
+    uint8_t actionCount = 0;
+};
+
+/**
+ * Reassembles and parses the messages of the companion app, which come in as writes of the phone - without any heap
+ * allocation: a message is collected in a fixed buffer and parsed in place.
+ *
+ * The binary messages may span several writes (and a write may carry several of them), all integers are little endian:
+ *
+ *   message := u8:0xC1 u16:length(of everything after it) u8:type u32:uid u32:timestamp field*
+ *   field   := u8:tag u8:length bytes                     tags: 1 app, 2 title, 3 contents, 4 action (repeatable)
+ *
+ * Unknown tags are skipped, texts longer than their limit are cut (at a character boundary), actions beyond
+ * maxActions dropped. Messages larger than the buffer are dropped as a whole.
+ *
+ * For the clients of old, a write starting with '{' is a JSON object on its own: {"uid":1,"app":"...","contents":"..."}
+ * (and optionally "title", "timestamp" and "actions").
+ */
+class OswCompanionReceiver {
+  public:
+    enum class Field : uint8_t { APP = 1, TITLE = 2, CONTENTS = 3, ACTION = 4 };
+
+    static constexpr uint8_t magic = 0xC1;
+    static constexpr size_t headerSize = 12;
+    static constexpr size_t bufferSize = 512;
+    static constexpr size_t maxAppLength = 32;
+    static constexpr size_t maxTitleLength = 64;
+    static constexpr size_t maxContentsLength = 255;
+    static constexpr size_t maxActionLength = 24;
+
+    struct Stats {
+        uint32_t messages = 0;
+        uint32_t dropped = 0; // Malformed or too large
+    };
+
+    OswCompanionReceiver();
+
+    /**
+     * Handles a write of the phone: calls onMessage(const OswCompanionMessage&) for every message completed by it
+     */
+    template<typename F> void feed(const uint8_t* data, size_t length, F onMessage) {
+        if(this->fill == 0 and this->skip == 0 and length > 0 and data[0] == '{') {
+            if(this->parseJson(data, length))
+                onMessage(this->message);
+            return;
+        }
+        while(length > 0) {
+            if(this->skip > 0) {
+                const size_t skipped = this->skip < length ? this->skip : length;
+                this->skip -= skipped;
+                data += skipped;
+                length -= skipped;
+                continue;
+            }
+            if(this->fill == 0 and data[0] != magic) {
+                ++this->stats.dropped; // Out of sync - the rest of this write is of no use either
+                return;
+            }
+            const size_t needed = (this->fill < 3 ? 3 : this->expected) - this->fill;
+            const size_t taken = needed < length ? needed : length;
+            std::copy(data, data + taken, this->buffer.begin() + this->fill);
+            this->fill += taken;
+            data += taken;
+            length -= taken;
+            if(this->fill == 3) {
+                this->expected = 3 + (this->buffer[1] | (this->buffer[2] << 8));
+                if(this->expected > bufferSize) {
+                    ++this->stats.dropped;
+                    this->skip = this->expected - 3;
+                    this->fill = 0;
+                    continue;
+                }
+            }
+            if(this->fill >= 3 and this->fill == this->expected) {
+                this->fill = 0;
+                if(this->parseBuffer())
+                    onMessage(this->message);
+            }
+        }
+    };
+    /**
+     * Forgets a partially received message (e.g. because the phone disconnected)
+     */
+    void reset() {
+        this->fill = 0;
+        this->skip = 0;
+    };
+    const Stats& getStats() const {
+        return this->stats;
+    };
+
+    /**
+     * Parses a complete binary message (including the magic and length)
+     */
+    static bool parse(const uint8_t* data, size_t length, OswCompanionMessage& message);
+
+  private:
+    std::array<uint8_t, bufferSize> buffer;
+    size_t fill = 0;
+    size_t expected = 0; // Length of the current message, once its header is in
+    size_t skip = 0; // Bytes left of a dropped message
+    OswCompanionMessage message;
+    Stats stats;
+    StaticJsonDocument<JSON_OBJECT_SIZE(6)> filter;
+    StaticJsonDocument<JSON_OBJECT_SIZE(6) + JSON_ARRAY_SIZE(8)> json;
+
+    bool parseBuffer();
+    bool parseJson(const uint8_t* data, size_t length);
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include <Arduino.h>
+#ifdef OSW_EMULATOR
+#include <thread>
+#include <Arduino_G.h>
+#else
+#include <Arduino_GFX.h>
+#endif
+
+/**
+ * Pipelines the transfer of finished canvas chunks to the display: the UI copies a chunk into one of a few transfer
+ * buffers and submits it, while a worker on core 0 pushes the previous buffers out through the display bus. A buffer
+ * is only handed back to the UI after its transfer completed, so the pixels on the wire are never mutated.
+ *
+ * All buffers are allocated once (DMA capable on the ESP32), so flushing never touches the heap afterwards.
+ */
+class OswDisplayFlushQueue {
+  public:
+    /**
+     * @param maxPending Transfers which may be queued at once, at least bufferCount - raise it to queue a whole frame
+     *                   with submitUnowned()
+     */
+    OswDisplayFlushQueue(Arduino_G* output, uint8_t bufferCount, size_t bufferPixels, uint8_t maxPending = 0);
+    ~OswDisplayFlushQueue();
+
+    /**
+     * Blocks until a transfer buffer is free and returns it - it must be submitted afterwards!
+     */
+    uint16_t* acquire();
+    /**
+     * Queues the transfer of a buffer previously returned by acquire().
+     *
+     * @param endOfFrame Marks the last chunk of a frame, the frame done callback is invoked after its transfer
+     */
+    void submit(uint16_t* pixels, int16_t x, int16_t y, int16_t w, int16_t h, bool endOfFrame);
+    /**
+     * Queues the transfer of pixels not owned by the queue, e.g. a chunk of the front frame of a double buffered canvas.
+     * They must stay untouched until waitIdle() returned. Blocks while maxPending transfers are queued.
+     */
+    void submitUnowned(uint16_t* pixels, int16_t x, int16_t y, int16_t w, int16_t h, bool endOfFrame);
+    /**
+     * Queues the end of a frame without any pixels, e.g. as none had to be sent - the frame done callback is invoked
+     * once the transfers before are done.
+     */
+    void submitFrameEnd();
+    /**
+     * Blocks until all submitted transfers are done - call this before talking to the display directly.
+     */
+    void waitIdle();
+
+    /**
+     * Called from the worker after the last chunk of a frame was transferred
+     */
+    void setFrameDoneCallback(std::function<void()> callback);
+    uint32_t getFramesDone() const {
+        return this->framesDone;
+    };
+    size_t getBufferPixels() const {
+        return this->bufferPixels;
+    };
+    /**
+     * Least free stack (bytes) of the worker so far - measured after every frame, 0 before (and in the emulator)
+     */
+    uint32_t getWorkerStackHeadroom() const {
+        return this->workerStackHeadroom;
+    };
+
+  private:
+    struct Transfer {
+        uint16_t* pixels;
+        int16_t x;
+        int16_t y;
+        int16_t w;
+        int16_t h;
+        bool endOfFrame;
+        bool owned; // Goes back to the free buffers afterwards
+    };
+
+    Arduino_G* output;
+    const uint8_t bufferCount;
+    const size_t bufferPixels;
+    const uint8_t maxPending;
+    std::unique_ptr<uint16_t*[]> buffers;
+    // Rings of bufferCount and maxPending entries, a buffer is always in exactly one of them (or owned by the UI in between)
+    std::unique_ptr<uint16_t*[]> freeBuffers;
+    std::unique_ptr<Transfer[]> pending;
+    uint8_t freeHead = 0;
+    uint8_t freeCount = 0;
+    uint8_t pendingHead = 0;
+    uint8_t pendingCount = 0;
+    bool transferring = false;
+    bool stopping = false;
+    std::atomic<uint32_t> framesDone = 0;
+    std::atomic<uint32_t> workerStackHeadroom = 0;
+    std::function<void()> frameDoneCallback;
+    std::mutex lock;
+    std::condition_variable changed;
+
+#ifndef OSW_EMULATOR
+    TaskHandle_t worker;
+    bool workerStopped = false;
+    // Only work(), the bus driver down to the SPI transaction and OswUI::onFlushDone() run on it (no logging per
+    // transfer). The headroom is measured after every frame, a new low below the margin is logged as warning.
+    const unsigned workerStackSize = 2048;
+    const unsigned workerStackMargin = 512;
+#else
+    std::unique_ptr<std::jthread> worker;
+#endif
+    void enqueue(const Transfer& transfer);
+    void work();
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * A small gzip (RFC 1952) compressor for the payloads we send to servers - any HTTP server understands it as
+ * "Content-Encoding: gzip". It is made for a few kB of JSON at once: the whole input is the window (up to 32 kB),
+ * matches are found through a single hash table (no chains) and coded with the fixed Huffman codes of deflate.
+ * That gets JSON to about a third of its size, with only the hash table as working memory.
+ */
+class OswGzip {
+  public:
+    static constexpr size_t headerSize = 10;
+    static constexpr size_t trailerSize = 8;
+    static constexpr size_t maxInputSize = 32768;
+
+    /**
+     * @return the size of the gzip data in out, 0 if it did not fit into capacity (or the input is too large)
+     */
+    size_t compress(const uint8_t* data, size_t length, uint8_t* out, size_t capacity);
+
+    static uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc = 0);
+
+  private:
+    static constexpr size_t hashBits = 10;
+
+    class BitWriter {
+      public:
+        BitWriter(uint8_t* out, size_t capacity) : out(out), capacity(capacity) {};
+        void write(uint32_t bits, uint8_t count);
+        /**
+         * Huffman codes go out starting with their most significant bit
+         */
+        void writeCode(uint32_t code, uint8_t length);
+        size_t finish();
+        bool overflowed() const {
+            return this->overflow;
+        };
+
+      private:
+        uint8_t* out;
+        size_t capacity;
+        size_t position = 0;
+        uint32_t buffer = 0;
+        uint8_t used = 0;
+        bool overflow = false;
+    };
+
+    std::array<uint16_t, 1 << hashBits> head; // Last position + 1 of each hash, 0 = none
+
+    static void writeLiteral(BitWriter& writer, uint16_t symbol);
+    static void writeMatch(BitWriter& writer, size_t length, size_t distance);
+};
@@ -1,18 +1,47 @@
 #pragma once
 
+#include <atomic>
 #include <mutex>
 #include <memory>
+#include <cstring>
 #include <Arduino.h>
 #include <OswSerial.h>
 #include <stdarg.h>
 
 #include <WString.h>
+#include <string>
 #include <string_view>
+#include <type_traits>
+#ifdef OSW_EMULATOR
+#include <thread>
+#endif
+
+// Messages below this severity are removed at compile time (0 = debug, 1 = info, 2 = warning, 3 = error, 4 = none)
+#ifndef OSW_LOG_LEVEL
+#ifndef NDEBUG
+#define OSW_LOG_LEVEL 0
+#else
+#define OSW_LOG_LEVEL 1
+#endif
+#endif
 
+// Bytes of the message ring buffer, must be a power of two (and at most 32 KiB)
+#ifndef OSW_LOG_BUFFER_SIZE
+#define OSW_LOG_BUFFER_SIZE 4096
+#endif
+
+/**
+ * Messages are not formatted by the caller: it only serializes its arguments (strings are copied, numbers are kept
+ * in their binary form) together with the severity, origin and timestamp into a compact record. Records are pushed
+ * lock-free into a ring buffer, so any task on any core can log without waiting for the serial port. The ring is
+ * drained by a low-priority flusher task (see startFlusher()) - or right away by the logging call, if there is none.
+ *
+ * If the ring is full, the message is dropped and counted - the flusher reports that with its next output.
+ */
 class OswLogger {
   public:
-    OswLogger() {};
-    ~OswLogger() {};
+    OswLogger(size_t bufferSize = OSW_LOG_BUFFER_SIZE);
+    ~OswLogger();
 
     static inline OswLogger* getInstance() {
         if (instance == nullptr)
@@ -25,27 +54,96 @@ class OswLogger {
 
     template<typename... T>
     inline void error(const char* file, const unsigned int line, T&& ... message) {
-        this->log(file, line, severity_t::E, std::forward<T>(message)...);
+        if constexpr (OSW_LOG_LEVEL <= 3)
+            this->log(file, line, severity_t::E, std::forward<T>(message)...);
     };
 
     template<typename... T>
     inline void warning(const char* file, const unsigned int line, T&& ... message) {
-        this->log(file, line, severity_t::W, std::forward<T>(message)...);
+        if constexpr (OSW_LOG_LEVEL <= 2)
+            this->log(file, line, severity_t::W, std::forward<T>(message)...);
     };
 
     template<typename... T>
     inline void info(const char* file, const unsigned int line, T&& ... message) {
-        this->log(file, line, severity_t::I, std::forward<T>(message)...);
+        if constexpr (OSW_LOG_LEVEL <= 1)
+            this->log(file, line, severity_t::I, std::forward<T>(message)...);
     };
 
     template<typename... T>
     inline void debug(const char* file, const unsigned int line, T&& ... message) {
-        this->log(file, line, severity_t::D, std::forward<T>(message)...);
+        if constexpr (OSW_LOG_LEVEL <= 0)
+            this->log(file, line, severity_t::D, std::forward<T>(message)...);
+    };
+
+    /**
+     * Starts the background task printing the queued messages. Until then (and after stopFlusher()) every logging
+     * call prints its message before returning.
+     */
+    void startFlusher();
+    /**
+     * Stops the background task and prints everything still queued
+     */
+    void stopFlusher();
+    /**
+     * Only queue the messages, without printing them - someone has to call flush() then (startFlusher() does this)
+     */
+    void setDeferred(bool deferred) {
+        this->deferred = deferred;
+    };
+    /**
+     * Prints all queued messages
+     */
+    void flush();
+    /**
+     * Number of messages dropped so far, because the ring buffer was full
+     */
+    uint32_t getDropped() const {
+        return this->dropped;
     };
   private:
     static std::unique_ptr<OswLogger> instance;
-    std::mutex m_lock;
-    enum class severity_t { D, I, W, E };
+    enum class severity_t : uint8_t { D, I, W, E };
+    enum class argument_t : uint8_t { STRING, CHAR, BOOL, SCHAR, UCHAR, SHORT, USHORT, INT, UINT, LONG, ULONG, LLONG, ULLONG, FLOAT, DOUBLE, UNSUPPORTED };
+    static constexpr uint8_t RECORD_SKIP = 0xFF; // Severity of the padding at the end of the ring
+    static constexpr size_t RECORD_ALIGN = 8;
+
+    /**
+     * The first bytes of every record, also used for the padding - which may be shorter than a whole Record
+     */
+    struct RecordTag {
+        uint16_t size; // Including this header and the alignment
+        uint8_t severity;
+        uint8_t committed; // Set by the producer (with release semantics) after the record is complete
+    };
+    struct Record {
+        RecordTag tag;
+        uint16_t argumentsSize; // The serialized arguments directly follow this header
+        uint32_t timestamp;
+        uint32_t line;
+        const char* file;
+    };
+
+    // Positions are counting up forever (and wrap around), the ring offset are their lower bits
+    std::unique_ptr<uint64_t[]> ringMemory;
+    uint8_t* ring;
+    const uint32_t ringSize;
+    std::atomic<uint32_t> head = 0; // Next position to reserve
+    std::atomic<uint32_t> tail = 0; // Next position to print
+    std::atomic<uint32_t> dropped = 0;
+    uint32_t droppedReported = 0;
+    std::atomic<bool> deferred = false;
+    std::mutex m_lock; // Only one consumer at a time, also serializes the direct output
+
+    std::atomic<bool> flusherRunning = false;
+#ifndef OSW_EMULATOR
+    TaskHandle_t flusher = nullptr;
+    std::atomic<bool> flusherStopped = false;
+    const unsigned flusherStackSize = 3072;
+#else
+    std::unique_ptr<std::jthread> flusher;
+#endif
+    const unsigned flusherInterval = 10; // ms
 
     // Used to process the variadic arguments in a type-safe (and aware) manner -> https://stackoverflow.com/a/15711171
     inline void do_in_order() {};
@@ -55,79 +153,169 @@ class OswLogger {
         do_in_order( std::forward<Lambdas>(Ls)... );
     };
 
+    template<typename A>
+    static constexpr bool isString() {
+        using D = std::remove_cv_t<std::remove_reference_t<A>>;
+        return std::is_base_of<String, D>::value or std::is_same<D, std::string>::value or std::is_same<D, std::string_view>::value or
+               std::is_same<D, const char*>::value or std::is_same<D, char*>::value or
+               (std::is_array<D>::value and std::is_same<std::remove_cv_t<std::remove_extent_t<D>>, char>::value);
+    };
+
+    template<typename A>
+    static constexpr argument_t argumentType() {
+        using D = std::remove_cv_t<std::remove_reference_t<A>>;
+        if constexpr (isString<D>())
+            return argument_t::STRING;
+        else if constexpr (std::is_enum<D>::value)
+            return argumentType<std::underlying_type_t<D>>();
+        else if constexpr (std::is_same<D, char>::value)
+            return argument_t::CHAR;
+        else if constexpr (std::is_same<D, bool>::value)
+            return argument_t::BOOL;
+        else if constexpr (std::is_same<D, signed char>::value)
+            return argument_t::SCHAR;
+        else if constexpr (std::is_same<D, unsigned char>::value)
+            return argument_t::UCHAR;
+        else if constexpr (std::is_same<D, short>::value)
+            return argument_t::SHORT;
+        else if constexpr (std::is_same<D, unsigned short>::value)
+            return argument_t::USHORT;
+        else if constexpr (std::is_same<D, int>::value)
+            return argument_t::INT;
+        else if constexpr (std::is_same<D, unsigned int>::value)
+            return argument_t::UINT;
+        else if constexpr (std::is_same<D, long>::value)
+            return argument_t::LONG;
+        else if constexpr (std::is_same<D, unsigned long>::value)
+            return argument_t::ULONG;
+        else if constexpr (std::is_same<D, long long>::value)
+            return argument_t::LLONG;
+        else if constexpr (std::is_same<D, unsigned long long>::value)
+            return argument_t::ULLONG;
+        else if constexpr (std::is_same<D, float>::value)
+            return argument_t::FLOAT;
+        else if constexpr (std::is_same<D, double>::value)
+            return argument_t::DOUBLE;
+        else
+            return argument_t::UNSUPPORTED;
+    };
+
+    template<typename A>
+    static std::string_view toStringView(const A& argument) {
+        using D = std::remove_cv_t<std::remove_reference_t<A>>;
+        if constexpr (std::is_base_of<String, D>::value)
+            return std::string_view(argument.c_str(), argument.length());
+        else if constexpr (std::is_same<D, std::string>::value or std::is_same<D, std::string_view>::value)
+            return std::string_view(argument);
+        else if constexpr (std::is_array<D>::value)
+            return std::string_view(argument);
+        else
+            return argument == nullptr ? std::string_view() : std::string_view(argument);
+    };
+
+    template<typename A>
+    static size_t argumentSize(const A& argument) {
+        if constexpr (argumentType<A>() == argument_t::STRING)
+            return 1 + sizeof(uint16_t) + toStringView(argument).size();
+        else
+            return 1 + sizeof(A);
+    };
+
+    template<typename A>
+    static uint8_t* writeArgument(uint8_t* out, const A& argument) {
+        *out++ = (uint8_t) argumentType<A>();
+        if constexpr (argumentType<A>() == argument_t::STRING) {
+            const std::string_view view = toStringView(argument);
+            const uint16_t length = view.size();
+            memcpy(out, &length, sizeof(length));
+            memcpy(out + sizeof(length), view.data(), length);
+            return out + sizeof(length) + length;
+        } else {
+            memcpy(out, &argument, sizeof(A));
+            return out + sizeof(A);
+        }
+    };
+
     template<typename... T>
     void log(const char* file, const unsigned int line, const severity_t severity, T&& ... message) {
+        const uint32_t timestamp = millis();
+        if constexpr ((... and (argumentType<T>() != argument_t::UNSUPPORTED))) {
+            const size_t argumentsSize = (0 + ... + argumentSize(message));
+            const size_t size = (sizeof(Record) + argumentsSize + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1);
+            if(size <= this->ringSize / 2) {
+                uint8_t* out = this->reserve(size);
+                if(out == nullptr) {
+                    ++this->dropped;
+                } else {
+                    Record* record = (Record*) out;
+                    record->tag.size = size;
+                    record->tag.severity = (uint8_t) severity;
+                    record->argumentsSize = argumentsSize;
+                    record->timestamp = timestamp;
+                    record->line = line;
+                    record->file = file;
+                    out += sizeof(Record);
+                    do_in_order([&]() {
+                        out = writeArgument(out, message);
+                    } ...);
+                    __atomic_store_n(&record->tag.committed, 1, __ATOMIC_RELEASE);
+                }
+                if(!this->deferred)
+                    this->flush();
+                return;
+            }
+        }
+
+        // Types we can not serialize (and oversized messages) are printed directly, after everything queued before
         std::lock_guard<std::mutex> guard(this->m_lock);
+        this->drain();
+        this->logDirect(file, line, severity, timestamp, std::forward<T>(message)...);
+    };
+
+    template<typename... T>
+    void logDirect(const char* file, const unsigned int line, const severity_t severity, const uint32_t timestamp, T&& ... message) {
         OswSerial* serial = OswSerial::getInstance();
-        this->prefix(file, line, severity);
+        this->prefix(file, line, severity, timestamp);
 
         do_in_order([&]() {
-            // If performance is no issue, we could just use String(...) and treat everything the same for the '\n'-iteration...
-            if constexpr (std::is_same<T, String>::value or std::is_same<T, std::string>::value or
-                          std::is_same<T, String&>::value or std::is_same<T, std::string&>::value) {
-                // Iterate over message to find '\n', which trigger new lines...
-                for(auto& c : message) {
-                    if (c == '\n') {
-                        serial->println();
-                        this->prefix(file, line, severity);
-                    } else
-                        serial->putc(c);
-                }
-            } else if constexpr (std::is_same<T, const char*>::value or std::is_same<T, char*>::value) {
-                // Iterate over message to find '\n', which trigger new lines...
-                for(auto& c : std::string_view(message)) {
-                    if (c == '\n') {
-                        serial->println();
-                        this->prefix(file, line, severity);
-                    } else
-                        serial->putc(c);
-                }
-            } else {
+            if constexpr (isString<T>())
+                this->printString(toStringView(message), file, line, severity, timestamp);
+            else
                 serial->print(message);
-            }
         } ...);
 
         serial->println();
     };
 
-    void prefix(const char* file, const unsigned int line, const severity_t severity) {
-        OswSerial* serial = OswSerial::getInstance();
-
-        switch(severity) {
-        case severity_t::D:
-            serial->print("D: ");
-            break;
-        case severity_t::I:
-            serial->print("I: ");
-            break;
-        case severity_t::W:
-            serial->print("W: ");
-            break;
-        case severity_t::E:
-            serial->print("E: ");
-            break;
-        default:
-            throw std::logic_error("Unknown severity level");
-        }
-
-#ifndef NDEBUG
-        serial->print(file);
-        serial->putc('@');
-        serial->print(line);
-        serial->print(": ");
-#endif
-    };
+    uint8_t* reserve(size_t size);
+    void drain();
+    void printRecord(const Record* record);
+    void printString(std::string_view message, const char* file, const unsigned int line, const severity_t severity, const uint32_t timestamp);
+    void prefix(const char* file, const unsigned int line, const severity_t severity, const uint32_t timestamp);
+    void flusherLoop();
 };
 
 // Following defines are used to quickly log something - and to optimize code in case of debug-compiles
-#ifndef NDEBUG
+#if OSW_LOG_LEVEL <= 0
 #define OSW_LOG_D(message...) OswLogger::getInstance()->debug(__FILE__, __LINE__, message)
 #else
 #define OSW_LOG_D(...)
 #endif
+#if OSW_LOG_LEVEL <= 1
 #define OSW_LOG_I(message...) OswLogger::getInstance()->info(__FILE__, __LINE__, message)
+#else
+#define OSW_LOG_I(...)
+#endif
+#if OSW_LOG_LEVEL <= 2
 #define OSW_LOG_W(message...) OswLogger::getInstance()->warning(__FILE__, __LINE__, message)
+#else
+#define OSW_LOG_W(...)
+#endif
+#if OSW_LOG_LEVEL <= 3
 #define OSW_LOG_E(message...) OswLogger::getInstance()->error(__FILE__, __LINE__, message)
+#else
+#define OSW_LOG_E(...)
+#endif
 
 #ifdef OSW_EMULATOR
 #define OSW_EMULATOR_THIS_IS_NOT_IMPLEMENTED OSW_LOG_W(__FUNCTION__, "() Not implemented!")
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include <Arduino.h>
+#include <WString.h>
+#include <ArduinoJson.h>
+
+/**
+ * Subsystems the heap usage is accounted to
+ */
+enum class OswMemoryTag : uint8_t {
+    OTHER,
+    DISPLAY, // Frame buffers of Graphics2D
+    JSON, // OswJsonDocument
+    NOTIFICATIONS,
+    TILES, // Map tiles
+    LUA,
+    COUNT
+};
+
+/**
+ * Accounts heap allocations per subsystem (current and peak bytes, number of allocations) and samples the heap itself
+ * (free bytes and the largest free block) over time.
+ *
+ * Allocations are attributed by tagged allocators (allocate(), OswJsonDocument, the Lua allocator, ...) or - for
+ * anything allocating through them without an explicit tag - by the innermost OswMemoryScope of the calling thread.
+ * In the emulator every operator new is hooked, so there the scope also catches all the containers and objects.
+ */
+class OswMemoryTracker {
+  public:
+    struct TagStats {
+        size_t current = 0; // Bytes
+        size_t peak = 0;
+        uint32_t allocations = 0; // Since the boot
+        uint32_t frees = 0;
+    };
+    struct HeapSample {
+        unsigned long time = 0; // millis()
+        uint32_t free = 0;
+        uint32_t largestBlock = 0;
+        size_t tracked = 0; // Bytes of all tags
+    };
+    static constexpr size_t historyLength = 32;
+
+    static OswMemoryTracker& getInstance() {
+        return instance;
+    };
+    static const char* getTagName(OswMemoryTag tag);
+
+    /**
+     * The tag of the innermost OswMemoryScope of this thread, or fallback outside of any
+     */
+    static OswMemoryTag getCurrentTag(OswMemoryTag fallback = OswMemoryTag::OTHER);
+
+    /**
+     * malloc() with accounting: a small header in front of the block remembers its size and tag, so reallocate() and
+     * release() need neither.
+     *
+     * @param psram Allocate from the PSRAM, if the platform has one
+     * @return nullptr if out of memory
+     */
+    static void* allocate(size_t size, OswMemoryTag tag, bool psram = false);
+    static void* reallocate(void* block, size_t size);
+    static void release(void* block);
+
+    /**
+     * Accounting only, for allocators which know the sizes themselves
+     */
+    void recordAllocation(OswMemoryTag tag, size_t size);
+    void recordRelease(OswMemoryTag tag, size_t size);
+
+    TagStats getStats(OswMemoryTag tag) const;
+    size_t getTrackedBytes() const;
+    void resetPeaks();
+
+    /**
+     * Stores the current heap state in the history - call this regularly (the memory monitor does)
+     */
+    void sampleHeap();
+    /**
+     * Copies the samples (oldest first) into samples
+     *
+     * @return The number of samples copied
+     */
+    size_t getHistory(HeapSample* samples, size_t max);
+    /**
+     * Fragmentation in percent: the share of the free heap outside of its largest block
+     */
+    static uint8_t getFragmentation(const HeapSample& sample);
+
+    /**
+     * Human readable table of the tags and the latest heap sample, for the console
+     */
+    String describe();
+    void toJson(JsonObject json);
+
+  private:
+    struct AtomicTagStats {
+        std::atomic<size_t> current{0};
+        std::atomic<size_t> peak{0};
+        std::atomic<uint32_t> allocations{0};
+        std::atomic<uint32_t> frees{0};
+    };
+
+    static OswMemoryTracker instance;
+
+    std::array<AtomicTagStats, (size_t) OswMemoryTag::COUNT> tags;
+    std::mutex historyLock;
+    std::array<HeapSample, historyLength> history;
+    size_t historyNext = 0;
+    size_t historyCount = 0;
+
+    friend class OswMemoryScope;
+    static thread_local OswMemoryTag scopeTag; // COUNT outside of any scope
+};
+
+/**
+ * Attributes all untagged allocations of this thread to tag, until it is destroyed
+ */
+class OswMemoryScope {
+  public:
+    OswMemoryScope(OswMemoryTag tag) : previous(OswMemoryTracker::scopeTag) {
+        OswMemoryTracker::scopeTag = tag;
+    };
+    ~OswMemoryScope() {
+        OswMemoryTracker::scopeTag = this->previous;
+    };
+    OswMemoryScope(const OswMemoryScope&) = delete;
+    OswMemoryScope& operator=(const OswMemoryScope&) = delete;
+
+  private:
+    const OswMemoryTag previous;
+};
+
+/**
+ * Allocator for the ArduinoJson documents, accounting them as JSON
+ */
+struct OswJsonAllocator {
+    void* allocate(size_t size) {
+        return OswMemoryTracker::allocate(size, OswMemoryTag::JSON);
+    }
+    void deallocate(void* block) {
+        OswMemoryTracker::release(block);
+    }
+    void* reallocate(void* block, size_t size) {
+        return OswMemoryTracker::reallocate(block, size);
+    }
+};
+typedef BasicJsonDocument<OswJsonAllocator> OswJsonDocument;
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/**
+ * @brief Fixed-capacity notification storage, which never allocates after its construction.
+ *
+ * - The publisher and message texts of all entries share one arena. Removing an entry only leaves a gap, which is
+ *   closed by an in-place compaction once the arena runs out of space. Texts are handed out as std::string_view, so
+ *   they are only valid until the store is modified the next time!
+ * - Entries are chained in insertion order and additionally hashed by their fire time into a timer wheel. Both
+ *   lists are intrusive (slot indices inside the entries), so there are no nodes to allocate.
+ *
+ * The store does no locking on its own - that is up to its owner.
+ *
+ * @tparam CAPACITY Maximum number of entries
+ * @tparam ARENA_SIZE Bytes available for the texts of all entries
+ * @tparam WHEEL_SIZE Number of timer wheel buckets
+ * @tparam TICK Time covered by one timer wheel bucket, in the unit used for the fire times
+ */
+template<uint16_t CAPACITY, uint16_t ARENA_SIZE, uint16_t WHEEL_SIZE, int64_t TICK>
+class OswNotificationStore {
+  public:
+    typedef uint16_t Index;
+    static constexpr Index NONE = 0xFFFF;
+
+    struct Entry {
+        uint32_t id;
+        int64_t fireTime;
+        uint8_t daysOfWeek; // Bit 0 is sunday, like std::tm::tm_wday
+        bool isPersistent;
+
+      private:
+        friend class OswNotificationStore;
+        uint16_t textOffset;
+        uint16_t publisherLength;
+        uint16_t messageLength;
+        uint16_t bucket;
+        Index orderPrev;
+        Index orderNext;
+        Index wheelPrev;
+        Index wheelNext;
+        bool used;
+    };
+
+    OswNotificationStore() {
+        this->clear();
+    }
+
+    void clear() {
+        for(Index i = 0; i < CAPACITY; i++) {
+            this->entries[i].used = false;
+            this->entries[i].orderNext = i + 1 < CAPACITY ? i + 1 : NONE; // Free slots are chained through orderNext
+        }
+        for(Index& bucket : this->wheel)
+            bucket = NONE;
+        this->freeHead = 0;
+        this->orderHead = NONE;
+        this->orderTail = NONE;
+        this->count = 0;
+        this->arenaUsed = 0;
+        this->arenaGarbage = 0;
+        this->wheelTickValid = false;
+    }
+
+    /**
+     * Stores a new entry. Texts which do not fit into the (compacted) arena anymore are truncated. The texts must not
+     * point into this store!
+     *
+     * @return The index of the new entry or NONE if all slots are in use
+     */
+    Index add(int64_t fireTime, std::string_view publisher, std::string_view message, uint8_t daysOfWeek = 0, bool isPersistent = false) {
+        if(this->freeHead == NONE)
+            return NONE;
+        if(publisher.size() + message.size() > (size_t) (ARENA_SIZE - this->arenaUsed) and this->arenaGarbage)
+            this->compact();
+        const size_t free = ARENA_SIZE - this->arenaUsed;
+        const uint16_t publisherLength = publisher.size() < free ? publisher.size() : free;
+        const uint16_t messageLength = message.size() < free - publisherLength ? message.size() : free - publisherLength;
+
+        const Index index = this->freeHead;
+        Entry& entry = this->entries[index];
+        this->freeHead = entry.orderNext;
+        entry.used = true;
+        entry.id = this->nextId++;
+        entry.fireTime = fireTime;
+        entry.daysOfWeek = daysOfWeek;
+        entry.isPersistent = isPersistent;
+        entry.textOffset = this->arenaUsed;
+        entry.publisherLength = publisherLength;
+        entry.messageLength = messageLength;
+        memcpy(this->arena + this->arenaUsed, publisher.data(), publisherLength);
+        memcpy(this->arena + this->arenaUsed + publisherLength, message.data(), messageLength);
+        this->arenaUsed += publisherLength + messageLength;
+
+        // Append to the insertion order, this also keeps the text offsets ascending along that list
+        entry.orderPrev = this->orderTail;
+        entry.orderNext = NONE;
+        if(this->orderTail != NONE)
+            this->entries[this->orderTail].orderNext = index;
+        else
+            this->orderHead = index;
+        this->orderTail = index;
+
+        this->linkWheel(index);
+        ++this->count;
+        return index;
+    }
+
+    void remove(Index index) {
+        Entry& entry = this->entries[index];
+        if(!entry.used)
+            return;
+        this->unlinkWheel(index);
+        if(entry.orderPrev != NONE)
+            this->entries[entry.orderPrev].orderNext = entry.orderNext;
+        else
+            this->orderHead = entry.orderNext;
+        if(entry.orderNext != NONE)
+            this->entries[entry.orderNext].orderPrev = entry.orderPrev;
+        else
+            this->orderTail = entry.orderPrev;
+
+        if(entry.textOffset + entry.publisherLength + entry.messageLength == this->arenaUsed)
+            this->arenaUsed = entry.textOffset; // Last text in the arena, no need to wait for the compaction
+        else
+            this->arenaGarbage += entry.publisherLength + entry.messageLength;
+
+        entry.used = false;
+        entry.orderNext = this->freeHead;
+        this->freeHead = index;
+        --this->count;
+    }
+
+    /**
+     * Moves an entry to a new fire time, without touching its id or texts.
+     */
+    void reschedule(Index index, int64_t fireTime) {
+        this->unlinkWheel(index);
+        this->entries[index].fireTime = fireTime;
+        this->linkWheel(index);
+    }
+
+    Index find(uint32_t id) const {
+        for(Index i = this->orderHead; i != NONE; i = this->entries[i].orderNext)
+            if(this->entries[i].id == id)
+                return i;
+        return NONE;
+    }
+
+    /**
+     * Returns the entry with the earliest fire time which is due at "now" (it is not removed), or NONE.
+     * Only the wheel buckets passed since the last call are inspected.
+     */
+    Index getDue(int64_t now) {
+        const int64_t nowTick = floorDiv(now, TICK);
+        int64_t tick = this->wheelTick;
+        if(!this->wheelTickValid or nowTick - tick >= WHEEL_SIZE)
+            tick = nowTick - WHEEL_SIZE + 1; // Time jumped (or first call) - just inspect every bucket once
+        else if(nowTick < tick)
+            tick = nowTick; // Time went backwards
+        this->wheelTickValid = true;
+
+        for(; tick <= nowTick; ++tick) {
+            Index due = NONE;
+            for(Index i = this->wheel[bucketOf(tick)]; i != NONE; i = this->entries[i].wheelNext)
+                if(this->entries[i].fireTime <= now and (due == NONE or this->entries[i].fireTime < this->entries[due].fireTime))
+                    due = i;
+            if(due != NONE) {
+                this->wheelTick = tick; // Continue here next time, there may be more due entries in this bucket
+                return due;
+            }
+        }
+        this->wheelTick = nowTick; // Keep the current bucket, entries may still be added to it
+        return NONE;
+    }
+
+    const Entry& operator[](Index index) const {
+        return this->entries[index];
+    }
+
+    std::string_view getPublisher(Index index) const {
+        const Entry& entry = this->entries[index];
+        return std::string_view(this->arena + entry.textOffset, entry.publisherLength);
+    }
+
+    std::string_view getMessage(Index index) const {
+        const Entry& entry = this->entries[index];
+        return std::string_view(this->arena + entry.textOffset + entry.publisherLength, entry.messageLength);
+    }
+
+    /**
+     * Iterate in insertion order: for(Index i = store.first(); i != store.NONE; i = store.next(i))
+     */
+    Index first() const {
+        return this->orderHead;
+    }
+
+    Index next(Index index) const {
+        return this->entries[index].orderNext;
+    }
+
+    uint16_t size() const {
+        return this->count;
+    }
+
+    bool empty() const {
+        return this->count == 0;
+    }
+
+    bool full() const {
+        return this->freeHead == NONE;
+    }
+
+    /**
+     * Text bytes available for new entries (after the next compaction)
+     */
+    uint16_t getFreeText() const {
+        return ARENA_SIZE - this->arenaUsed + this->arenaGarbage;
+    }
+
+  private:
+    Entry entries[CAPACITY];
+    Index wheel[WHEEL_SIZE];
+    char arena[ARENA_SIZE];
+    Index freeHead;
+    Index orderHead;
+    Index orderTail;
+    uint16_t count;
+    uint16_t arenaUsed;
+    uint16_t arenaGarbage;
+    uint32_t nextId = 0;
+    int64_t wheelTick = 0;
+    bool wheelTickValid;
+
+    static int64_t floorDiv(int64_t value, int64_t divisor) {
+        return value / divisor - (value % divisor < 0 ? 1 : 0);
+    }
+
+    static uint16_t bucketOf(int64_t tick) {
+        const int64_t bucket = tick % WHEEL_SIZE;
+        return bucket < 0 ? bucket + WHEEL_SIZE : bucket;
+    }
+
+    void linkWheel(Index index) {
+        Entry& entry = this->entries[index];
+        int64_t tick = floorDiv(entry.fireTime, TICK);
+        if(this->wheelTickValid and tick < this->wheelTick)
+            tick = this->wheelTick; // Already overdue, put it where the wheel will look next
+        entry.bucket = bucketOf(tick);
+        entry.wheelPrev = NONE;
+        entry.wheelNext = this->wheel[entry.bucket];
+        if(entry.wheelNext != NONE)
+            this->entries[entry.wheelNext].wheelPrev = index;
+        this->wheel[entry.bucket] = index;
+    }
+
+    void unlinkWheel(Index index) {
+        Entry& entry = this->entries[index];
+        if(entry.wheelPrev != NONE)
+            this->entries[entry.wheelPrev].wheelNext = entry.wheelNext;
+        else
+            this->wheel[entry.bucket] = entry.wheelNext;
+        if(entry.wheelNext != NONE)
+            this->entries[entry.wheelNext].wheelPrev = entry.wheelPrev;
+    }
+
+    /**
+     * Closes all gaps in the arena. As texts are always appended and the insertion order is never changed, moving
+     * them down in that order can never overwrite a text which was not moved yet.
+     */
+    void compact() {
+        uint16_t used = 0;
+        for(Index i = this->orderHead; i != NONE; i = this->entries[i].orderNext) {
+            Entry& entry = this->entries[i];
+            const uint16_t length = entry.publisherLength + entry.messageLength;
+            if(entry.textOffset != used)
+                memmove(this->arena + used, this->arena + entry.textOffset, length);
+            entry.textOffset = used;
+            used += length;
+        }
+        this->arenaUsed = used;
+        this->arenaGarbage = 0;
+    }
+};
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <Arduino.h>
+#include <OswSha256.h>
+#ifdef OSW_EMULATOR
+#include <thread>
+#endif
+
+/**
+ * Streams a firmware image into the flash: the network stage copies what it received into one of two buffers (and
+ * hashes it right away), while a writer task on core 0 writes the other one into the flash. So the network is only
+ * held up if the flash is slower - and the caller, e.g. a request handler, never waits for a single flash write.
+ *
+ * The image can come with a Manifest (size, SHA-256 and its signature, a HMAC-SHA256 with a key known to the watch).
+ * A wrong signature is refused before the flash is touched, a wrong image before it is committed.
+ *
+ * Both ends are only used through the Sink and Source interfaces, so the emulator can run it all against local files.
+ */
+class OswOta {
+  public:
+    static constexpr size_t defaultBufferSize = 4096; // A flash sector
+
+    /**
+     * Where the image goes to, e.g. the OTA partition - write() is called from the writer task
+     */
+    class Sink {
+      public:
+        virtual ~Sink() {};
+        /**
+         * @param size of the image, 0 if unknown
+         */
+        virtual bool begin(size_t size) = 0;
+        virtual bool write(const uint8_t* data, size_t length) = 0;
+        /**
+         * Makes the complete image the one to boot
+         */
+        virtual bool commit() = 0;
+        virtual void abort() = 0;
+        virtual std::string getError() = 0;
+    };
+
+    /**
+     * Where the image comes from, e.g. a download - pulled by receive()
+     */
+    class Source {
+      public:
+        virtual ~Source() {};
+        /**
+         * @return the bytes read, 0 if there are none right now or -1 if the source ended (or broke)
+         */
+        virtual int read(uint8_t* buffer, size_t length) = 0;
+    };
+
+    /**
+     * The text form is "<size>;<sha256 as hex>;<signature as hex>" - the signature is the HMAC-SHA256 of the part
+     * before it. Anything after the size may be left out (see scripts/ota/signManifest.py).
+     */
+    struct Manifest {
+        size_t size = 0; // 0 = unknown
+        bool hasHash = false;
+        OswSha256::Digest sha256 = {};
+        bool hasSignature = false;
+        OswSha256::Digest signature = {};
+
+        /**
+         * @return false if the text is malformed
+         */
+        bool parse(const std::string& text);
+        bool isSignedWith(const std::string& key) const;
+        std::string getSignedPart() const;
+    };
+
+    enum class State : uint8_t { IDLE, RECEIVING, COMMITTED, FAILED };
+
+    struct Progress {
+        State state = State::IDLE;
+        size_t total = 0; // 0 if unknown
+        size_t received = 0; // ...and hashed
+        size_t written = 0;
+        unsigned long elapsed = 0; // ms since begin()
+        unsigned long receiveWait = 0; // ms the network stage waited for the flash
+        unsigned long writeTime = 0; // ms the writer spent in Sink::write()
+
+        /**
+         * @return bytes per second which made it into the flash
+         */
+        uint32_t getThroughput() const {
+            return this->elapsed > 0 ? (uint32_t) ((uint64_t) this->written * 1000 / this->elapsed) : 0;
+        };
+    };
+
+    OswOta(Sink& sink, size_t bufferSize = defaultBufferSize);
+    ~OswOta(); // Aborts an unfinished update
+
+    /**
+     * @param key if not empty, only a manifest signed with it is accepted
+     * @param size of the image as announced by the source (e.g. its Content-Length), 0 if unknown - it fills in for
+     * a manifest without one, but does not change what was signed
+     */
+    bool begin(const Manifest& manifest, const std::string& key, size_t size = 0);
+    /**
+     * Takes the data of the network stage - blocks only while both buffers wait for the flash
+     */
+    bool write(const uint8_t* data, size_t length);
+    /**
+     * Reads from the source straight into the buffers, for up to sliceTime ms
+     *
+     * @return false if the update failed (see getError())
+     */
+    bool receive(Source& source, unsigned long sliceTime);
+    /**
+     * @return true if all of the image was received (only known with its size)
+     */
+    bool isComplete();
+    /**
+     * Waits for the writer, checks the image against the manifest and commits it
+     */
+    bool finish();
+    void abort(const std::string& reason);
+
+    Progress getProgress();
+    std::string getError();
+
+  private:
+    Sink& sink;
+    const size_t bufferSize;
+    std::array<std::unique_ptr<uint8_t[]>, 2> buffers;
+    std::array<size_t, 2> lengths = {};
+    // Ring of the buffers waiting for the writer, the others are free or being filled
+    std::array<uint8_t, 2> pending = {};
+    uint8_t pendingHead = 0;
+    uint8_t pendingCount = 0;
+    int8_t filling = -1; // Index of the buffer the network stage fills
+    uint8_t freeMask = 0b11;
+    bool writing = false;
+    bool stopping = false;
+    bool ended = false; // The source ended, which completes an image of unknown size
+    bool sinkOpen = false; // Begun, but neither committed nor aborted yet
+    Manifest manifest;
+    OswSha256 sha256; // Only used by the network stage
+    Progress progress;
+    unsigned long startedAt = 0;
+    std::string error;
+    std::mutex lock;
+    std::condition_variable changed;
+
+#ifndef OSW_EMULATOR
+    TaskHandle_t writer;
+    bool writerStarted = false; // Otherwise every begin() fails
+    bool writerStopped = false;
+    const unsigned writerStackSize = 4096;
+#else
+    std::unique_ptr<std::jthread> writer;
+#endif
+
+    uint8_t* acquire(std::unique_lock<std::mutex>& guard, unsigned long timeout);
+    void submit(std::unique_lock<std::mutex>& guard);
+    void waitIdle(std::unique_lock<std::mutex>& guard);
+    void fail(std::unique_lock<std::mutex>& guard, const std::string& reason);
+    void work();
+};
+
+#ifdef OSW_EMULATOR
+/**
+ * Writes the image into a file, which only appears under its name once committed
+ */
+class OswOtaFileSink : public OswOta::Sink {
+  public:
+    OswOtaFileSink(const std::string& path) : path(path) {};
+    ~OswOtaFileSink();
+    virtual bool begin(size_t size) override;
+    virtual bool write(const uint8_t* data, size_t length) override;
+    virtual bool commit() override;
+    virtual void abort() override;
+    virtual std::string getError() override;
+
+  private:
+    const std::string path;
+    FILE* file = nullptr;
+    std::string error;
+};
+
+class OswOtaFileSource : public OswOta::Source {
+  public:
+    OswOtaFileSource(const std::string& path);
+    ~OswOtaFileSource();
+    virtual int read(uint8_t* buffer, size_t length) override;
+    bool isOpen() const {
+        return this->file != nullptr;
+    };
+    size_t getSize() const {
+        return this->size;
+    };
+
+  private:
+    FILE* file = nullptr;
+    size_t size = 0;
+};
+#else
+/**
+ * Writes the image into the next OTA partition (through the Update of the Arduino core)
+ */
+class OswOtaFlashSink : public OswOta::Sink {
+  public:
+    /**
+     * Also checks the MD5 of the image (32 hex digits, empty = none) - set it before begin()
+     */
+    void setMD5(const String& md5) {
+        this->md5 = md5;
+    };
+    virtual bool begin(size_t size) override;
+    virtual bool write(const uint8_t* data, size_t length) override;
+    virtual bool commit() override;
+    virtual void abort() override;
+    virtual std::string getError() override;
+
+  private:
+    String md5;
+};
+#endif
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * A sensor trace is a text file with one timestamped sample per line, e.g.
+ *
+ *   # OSW sensor trace 1
+ *   0 utc 1700000000
+ *   20 acc 0.12 -0.03 -9.79
+ *   40 steps 1042
+ *   1000 button 0 1
+ *
+ * The time is in milliseconds since the start of the recording, the values depend on the kind of the sample (see
+ * getValueCount()). Lines starting with '#' are comments, unknown kinds are skipped - so newer traces stay readable.
+ */
+class OswSensorTrace {
+  public:
+    enum class Kind : uint8_t {
+        UTC, // Seconds since the epoch
+        ACCELERATION, // x, y, z in m/s^2
+        STEPS, // Steps of today
+        ACTIVITY, // OswAccelerationProvider::ActivityMode
+        PRESSURE, // Pa
+        TEMPERATURE, // °C
+        HUMIDITY, // %
+        MAGNETOMETER, // x, y, z, azimuth
+        GPS, // Latitude, longitude, altitude (m)
+        BUTTON, // Button id, 1 if down
+        COUNT
+    };
+    static constexpr uint8_t maxValues = 4;
+
+    struct Sample {
+        uint32_t time = 0; // ms
+        Kind kind = Kind::COUNT;
+        std::array<double, maxValues> values{}; // double, so the UTC and GPS values keep their precision
+    };
+
+    static const char* getKindName(Kind kind);
+    static uint8_t getValueCount(Kind kind);
+
+    /**
+     * Writes the sample as one line (including the newline) into line
+     *
+     * @return The length of the line, or 0 if it did not fit
+     */
+    static size_t format(const Sample& sample, char* line, size_t size);
+    /**
+     * @return false for comments, empty lines, unknown kinds and malformed lines
+     */
+    static bool parse(const char* line, Sample& sample);
+};
+
+/**
+ * Appends samples to a trace file - only the ones which changed, unless told otherwise
+ */
+class OswSensorTraceWriter {
+  public:
+    OswSensorTraceWriter() {};
+    ~OswSensorTraceWriter();
+    OswSensorTraceWriter(const OswSensorTraceWriter&) = delete;
+    OswSensorTraceWriter& operator=(const OswSensorTraceWriter&) = delete;
+
+    bool open(const char* path);
+    void close();
+    bool isOpen() const {
+        return this->file != nullptr;
+    };
+
+    /**
+     * @param time Milliseconds of any clock - the trace is relative to the first written sample
+     * @return true if the sample was written
+     */
+    bool write(uint32_t time, OswSensorTrace::Kind kind, double a, double b = 0, double c = 0, double d = 0, bool force = false);
+    uint32_t getWrittenSamples() const {
+        return this->written;
+    };
+
+  private:
+    FILE* file = nullptr;
+    bool started = false;
+    uint32_t startTime = 0;
+    uint32_t written = 0;
+    std::array<OswSensorTrace::Sample, (size_t) OswSensorTrace::Kind::COUNT> last;
+    std::array<bool, (size_t) OswSensorTrace::Kind::COUNT> hasLast{};
+};
+
+/**
+ * Reads the samples of a trace file in order
+ */
+class OswSensorTraceReader {
+  public:
+    OswSensorTraceReader() {};
+    ~OswSensorTraceReader();
+    OswSensorTraceReader(const OswSensorTraceReader&) = delete;
+    OswSensorTraceReader& operator=(const OswSensorTraceReader&) = delete;
+
+    bool open(const char* path);
+    void close();
+
+    /**
+     * @return false at the end of the trace
+     */
+    bool next(OswSensorTrace::Sample& sample);
+    uint32_t getSkippedLines() const {
+        return this->skipped;
+    };
+
+  private:
+    FILE* file = nullptr;
+    uint32_t skipped = 0; // Neither samples nor comments
+};
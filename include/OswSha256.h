@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef OSW_EMULATOR
+#include <mbedtls/sha256.h>
+#endif
+
+/**
+ * Incremental SHA-256 (FIPS 180-4) - through the hardware accelerated mbedtls on the ESP32, in plain C++ in the
+ * emulator. Also provides the HMAC (RFC 2104) on top of it, e.g. to check signed manifests.
+ */
+class OswSha256 {
+  public:
+    static constexpr size_t digestSize = 32;
+    static constexpr size_t blockSize = 64;
+    typedef std::array<uint8_t, digestSize> Digest;
+
+    OswSha256();
+    ~OswSha256();
+    OswSha256(const OswSha256&) = delete;
+    OswSha256& operator=(const OswSha256&) = delete;
+
+    /**
+     * Starts over, as if just constructed
+     */
+    void reset();
+    void update(const uint8_t* data, size_t length);
+    /**
+     * Afterwards only reset() is valid
+     */
+    Digest finish();
+
+    static Digest hash(const uint8_t* data, size_t length);
+    static Digest hmac(const uint8_t* key, size_t keyLength, const uint8_t* data, size_t length);
+    /**
+     * Compares in constant time, so a forged digest can not be guessed byte by byte
+     */
+    static bool equals(const Digest& a, const Digest& b);
+
+  private:
+#ifndef OSW_EMULATOR
+    mbedtls_sha256_context context;
+#else
+    std::array<uint32_t, 8> state;
+    std::array<uint8_t, blockSize> block;
+    size_t blockUsed;
+    uint64_t total;
+
+    void compress(const uint8_t* data);
+#endif
+};
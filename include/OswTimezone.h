@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+
+/**
+ * A timezone from a POSIX TZ string (like "CET-1CEST,M3.5.0,M10.5.0/3", see
+ * https://www.gnu.org/software/libc/manual/html_node/TZ-Variable.html), which is parsed once into a table of its
+ * transitions around the current time. Offset queries are then a binary search in that table - without touching the
+ * TZ environment variable (and therefore without any global state, which other tasks may use at the same time).
+ * The table is rebuilt and looked up under a lock, so update() may run on another task than the queries.
+ */
+class OswTimezone {
+  public:
+    struct Transition {
+        time_t at = 0; // UTC
+        int32_t offset = 0; // Seconds to add to UTC from here on
+    };
+    static constexpr size_t maxTransitions = 10; // Five years with daylight saving time
+
+    /**
+     * Parses the rule (if it changed) and rebuilds the table if it does not cover now anymore
+     *
+     * @param posix Empty for UTC
+     * @return true if the rule was parsed (again) - see isValid() for the result
+     */
+    bool update(const char* posix, time_t now);
+    /**
+     * An invalid rule is treated as UTC
+     */
+    bool isValid() const {
+        std::lock_guard<std::mutex> guard(this->lock);
+        return this->valid;
+    };
+    bool hasDaylightSavingTime() const {
+        std::lock_guard<std::mutex> guard(this->lock);
+        return this->valid and this->rule.hasDst;
+    };
+
+    /**
+     * @return Seconds to add to utc for the local time
+     */
+    int32_t getOffset(time_t utc) const;
+    /**
+     * @return The first transition after utc (or the end of the table) - until then getOffset() does not change
+     */
+    time_t getNextTransition(time_t utc) const;
+
+  private:
+    struct Date {
+        enum class Kind : uint8_t { JULIAN_1, JULIAN_0, MONTH_WEEK_DAY } kind = Kind::MONTH_WEEK_DAY;
+        uint16_t day = 0; // Day of the year for the julian kinds, otherwise the day of the week (0 = Sunday)
+        uint8_t month = 0;
+        uint8_t week = 0; // 5 = the last one in the month
+        int32_t time = 7200; // Local seconds after midnight, may be negative or beyond a day
+    };
+    struct Rule {
+        int32_t standardOffset = 0;
+        bool hasDst = false;
+        int32_t dstOffset = 0;
+        Date start;
+        Date end;
+    };
+
+    mutable std::mutex lock;
+    std::string posix;
+    bool parsed = false;
+    bool valid = false;
+    Rule rule;
+
+    std::array<Transition, maxTransitions> transitions;
+    uint8_t transitionCount = 0;
+    int32_t initialOffset = 0; // Before the first transition
+    time_t validFrom = 0;
+    time_t validUntil = 0;
+
+    static bool parse(const char* posix, Rule& rule);
+    static bool parseDate(const char*& posix, Date& date);
+    static int64_t getDay(const Date& date, int64_t year);
+    /**
+     * All transitions of the years firstYear to lastYear (two per year) in chronological order
+     *
+     * @return The number of transitions written to result
+     */
+    static size_t generate(const Rule& rule, int64_t firstYear, int64_t lastYear, Transition* result);
+    void build(time_t now);
+    int32_t computeOffset(time_t utc) const;
+};
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <WString.h>
+
+/**
+ * Connects the WiFi client to the best of the configured networks - as fast as possible, as the radio is one of the
+ * largest consumers of the watch.
+ *
+ * The BSSID and channel of the last good connection are remembered (in the History, which should survive the deep
+ * sleep), so the next connection can skip the scan entirely. Only if that fails, the networks around are scanned and
+ * the configured ones are tried in the order of their success history (and signal strength), hidden ones last. The
+ * timeouts of the authentication and DHCP follow how long these took before on the same network, and every phase of a
+ * connection is timed (see Profile).
+ *
+ * The connector only talks to the hardware through the Radio, so the whole state machine can run against a fake one.
+ */
+class OswWiFiConnector {
+  public:
+    struct Network {
+        String ssid;
+        String password; // Empty for open networks
+    };
+    struct ScanResult {
+        String ssid;
+        std::array<uint8_t, 6> bssid = {};
+        uint8_t channel = 0;
+        int32_t rssi = 0;
+    };
+    class Radio {
+      public:
+        enum class Status : uint8_t {
+            IDLE, // Nothing to do / disconnected
+            CONNECTING,
+            ASSOCIATED, // Authenticated, waiting for the DHCP
+            CONNECTED, // Got an IP address
+            NOT_FOUND,
+            FAILED // E.g. the password is wrong
+        };
+        virtual ~Radio() {};
+        /**
+         * @param channel 0 and bssid nullptr let the radio search the network by itself
+         */
+        virtual void begin(const Network& network, uint8_t channel, const uint8_t* bssid) = 0;
+        virtual void disconnect() = 0;
+        virtual Status getStatus() = 0;
+        /**
+         * The access point of the current connection (also if the radio searched it by itself)
+         */
+        virtual bool getAccessPoint(std::array<uint8_t, 6>& bssid, uint8_t& channel) = 0;
+        virtual void startScan() = 0;
+        /**
+         * @return false while the scan is still running (on errors it is done, with no results)
+         */
+        virtual bool getScanResults(std::vector<ScanResult>& results) = 0;
+    };
+
+    enum class State : uint8_t { IDLE, FAST_CONNECTING, SCANNING, CONNECTING, OBTAINING_IP, CONNECTED, FAILED };
+
+    /**
+     * What the networks did before, kept across connections (and ideally the deep sleep) - plain data without any
+     * initializers, so it can be RTC_DATA_ATTR (a zeroed one is empty)
+     */
+    struct History {
+        struct Record {
+            uint32_t ssidHash; // 0 = unused
+            std::array<uint8_t, 6> bssid;
+            uint8_t channel; // 0 = no known access point
+            uint16_t successes;
+            uint16_t failures;
+            uint16_t authTime; // ms, average of the past connections (0 = unknown)
+            uint16_t dhcpTime; // ms, average of the past connections (0 = unknown)
+            uint32_t lastSuccess; // Value of History::connections at that time
+        };
+        std::array<Record, 4> records;
+        uint32_t connections;
+    };
+
+    /**
+     * Duration of the phases of the last connection attempt (ms, 0 if skipped or not reached yet)
+     */
+    struct Profile {
+        bool fast = false; // Used the remembered access point, without a scan
+        unsigned long scan = 0;
+        unsigned long auth = 0;
+        unsigned long dhcp = 0;
+        unsigned long ntp = 0; // Reported by noteTimeSynchronized()
+        unsigned long total = 0; // From connect() until the IP (or the failure)
+        uint8_t attempts = 0;
+    };
+
+    static constexpr unsigned long defaultTimeout = 10000; // ms for each phase of an unknown network
+    static constexpr unsigned long minTimeout = 2000; // ms, adaptive timeouts never go below...
+    static constexpr unsigned long maxTimeout = 10000; // ...or above this
+    static constexpr unsigned long fastTimeout = 4000; // ms, upper limit of the attempt with the remembered access point
+    static constexpr unsigned long scanTimeout = 8000; // ms
+
+    OswWiFiConnector(Radio& radio, History& history) : radio(radio), history(history) {};
+
+    /**
+     * The configured networks in the order of preference (read them once, not on every attempt) - stops any connection
+     */
+    void setNetworks(const std::vector<Network>& networks);
+    /**
+     * Starts a connection, also if one is already established
+     */
+    void connect(unsigned long now);
+    void disconnect();
+    /**
+     * Drives the state machine, call this regularly (e.g. every 50 ms) - a lost connection is established again
+     */
+    void loop(unsigned long now);
+    /**
+     * Marks the time synchronization after the connection as done, for the profile
+     */
+    void noteTimeSynchronized(unsigned long now);
+
+    State getState() const {
+        return this->state;
+    };
+    bool isConnected() const {
+        return this->state == State::CONNECTED;
+    };
+    const Profile& getProfile() const {
+        return this->profile;
+    };
+    /**
+     * The network which is (being) connected to, nullptr if none
+     */
+    const Network* getNetwork() const;
+    /**
+     * Timeouts for the authentication and DHCP of the network
+     */
+    unsigned long getAuthTimeout(const Network& network) const;
+    unsigned long getDhcpTimeout(const Network& network) const;
+
+    static uint32_t hash(const String& ssid);
+
+  private:
+    struct Candidate {
+        size_t network = 0; // Index in networks
+        bool found = false; // In the scan, with the following access point
+        std::array<uint8_t, 6> bssid = {};
+        uint8_t channel = 0;
+        int32_t rssi = 0;
+    };
+
+    Radio& radio;
+    History& history;
+    std::vector<Network> networks;
+    std::vector<Candidate> candidates; // Still to try, the best one at the back
+    Candidate attempting;
+    bool hasAttempt = false;
+    State state = State::IDLE;
+    unsigned long startedAt = 0; // connect()
+    unsigned long phaseAt = 0; // Start of the current phase
+    unsigned long timeout = 0; // Of the current phase
+    unsigned long connectedAt = 0;
+    Profile profile;
+
+    History::Record* find(const Network& network);
+    const History::Record* find(const Network& network) const;
+    History::Record& findOrCreate(const Network& network);
+    static unsigned long adaptiveTimeout(uint16_t average, unsigned long limit);
+    static uint16_t average(uint16_t average, unsigned long sample);
+
+    void startScan(unsigned long now);
+    void orderCandidates(const std::vector<ScanResult>& results);
+    void tryNext(unsigned long now);
+    void attempt(const Candidate& candidate, unsigned long now);
+    void fail(unsigned long now);
+    void succeed(unsigned long now);
+};
@@ -3,30 +3,21 @@
 
 #include <Arduino.h>
 
-class Graphics2D;
+#include "animations/anim_particles.h"
 
-class Particle {
-  public:
-    Particle() {}
-    float locationX;
-    float locationY;
-    float speedX;
-    float speedY;
-    void tick(long ms, float friction, float gravity);
-};
+class Graphics2D;
 
 class Firework {
   private:
-    Particle* particles;
-    uint8_t numParticles;
+    static constexpr uint8_t numParticles = 53;
+    static constexpr uint16_t particleLife = 4000; // ms until the particles faded to black
+
+    ParticleSystem particles;
 
   public:
-    Firework() {
-        numParticles = 53;
-        particles = new Particle[numParticles];
-    }
-    ~Firework(void) {
-        delete[] particles;
+    Firework(): particles(numParticles) {
+        particles.gravityY = ParticleSystem::toFixed(9.8f);
+        particles.drag = ParticleSystem::toFixed(0.01f);
     }
 
     void init(uint16_t color, uint8_t radius, uint8_t rings,  //
@@ -34,6 +25,12 @@ class Firework {
     void tick(long ms, uint8_t launchSpeed);
 
     void draw(Graphics2D* gfx, int16_t offsetX, int16_t offsetY);
+    /**
+     * @brief The pixels written by the last draw().
+     */
+    inline const ParticleSystem::Rect& getDrawnBounds() {
+        return particles.getDrawnBounds();
+    }
     uint16_t height;
     uint16_t explHeight;
     uint16_t color;
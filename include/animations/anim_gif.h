@@ -0,0 +1,226 @@
+#ifndef ANIM_GIF_H
+#define ANIM_GIF_H
+
+#include <Arduino.h>
+
+#include <array>
+#include <functional>
+#include <vector>
+
+class Graphics2D;
+
+/**
+ * @brief Portable GIF87a/GIF89a decoder, working straight on the (embedded) file in memory.
+ *
+ * The frames are decoded row by row into palette indices - so besides its LZW tables (about 16 KB) it needs no more
+ * memory than one row of the frame.
+ */
+class GifDecoder {
+  public:
+    struct Frame {
+        uint16_t x;
+        uint16_t y;
+        uint16_t width;
+        uint16_t height;
+        uint16_t delay; // ms
+        uint8_t disposal; // 0/1: keep, 2: restore to background, 3: restore to previous
+        int16_t transparent; // Palette index, -1 if none
+        bool interlaced;
+    };
+
+    bool open(const uint8_t* data, size_t size);
+    /**
+     * @brief Start again with the first frame.
+     */
+    void rewind();
+    /**
+     * @brief Read everything up to (excluding) the image data of the next frame.
+     *
+     * @return false at the end of the file (or if it is broken)
+     */
+    bool nextFrame(Frame& frame);
+    /**
+     * @brief Decode the image data of the frame returned by nextFrame().
+     *
+     * @param row Called with the row (relative to the frame, already deinterlaced) and its frame.width palette indices
+     * @return false if the image data is broken - the rows decoded until then were passed on anyway
+     */
+    bool decodeFrame(const std::function<void(uint16_t row, const uint8_t* indices)>& row);
+
+    inline uint16_t getWidth() {
+        return width;
+    }
+    inline uint16_t getHeight() {
+        return height;
+    }
+    /**
+     * @brief The RGB565 palette of the current frame (the local one, if it has one).
+     */
+    inline const uint16_t* getPalette() {
+        return hasLocalPalette ? localPalette.data() : globalPalette.data();
+    }
+    inline uint16_t getBackgroundColor() {
+        return globalPalette[backgroundIndex];
+    }
+
+  private:
+    static constexpr uint16_t maxCodes = 4096;
+
+    const uint8_t* data = NULL;
+    size_t size = 0;
+    size_t pos = 0;
+    size_t firstFramePos = 0;
+    bool pendingImageData = false;
+
+    uint16_t width = 0;
+    uint16_t height = 0;
+    uint8_t backgroundIndex = 0;
+    bool hasLocalPalette = false;
+    Frame current = {};
+    std::array<uint16_t, 256> globalPalette = {};
+    std::array<uint16_t, 256> localPalette = {};
+
+    // LZW state
+    std::array<uint16_t, maxCodes> prefix;
+    std::array<uint8_t, maxCodes> suffix;
+    std::array<uint8_t, maxCodes> stack;
+    std::vector<uint8_t> rowBuffer;
+    size_t blockEnd = 0; // End of the current sub-block of the image data
+    bool blockTerminated = false; // The terminating (empty) sub-block was already read
+    uint32_t bitBuffer = 0;
+    uint8_t bitCount = 0;
+
+    inline uint8_t readByte() {
+        return pos < size ? data[pos++] : 0;
+    }
+    inline uint16_t readWord() {
+        uint16_t low = readByte();
+        return low | (readByte() << 8);
+    }
+    void readPalette(std::array<uint16_t, 256>& palette, uint16_t colors);
+    void skipSubBlocks();
+    int32_t readCode(uint8_t codeSize);
+};
+
+/**
+ * @brief Plays a GIF into its own RGB565 canvas, which is then copied row by row into a Graphics2D.
+ *
+ * Only the area changed by a frame (its own one and the one its predecessor asked to dispose of) is decoded, which is
+ * reported as dirty rectangle. So a buffer which still holds the previous frame only needs that area to be redrawn.
+ *
+ * For looping backgrounds the whole loop can be pre-decoded into a cache, which stores only the spans of pixels that
+ * changed against the previous frame - replaying them is much cheaper than decoding the LZW data again.
+ */
+class AnimGif {
+  public:
+    struct Rect {
+        uint16_t x;
+        uint16_t y;
+        uint16_t width;
+        uint16_t height;
+    };
+
+    AnimGif(const uint8_t* data, size_t size, bool allocatePsram = false);
+    ~AnimGif();
+
+    inline bool isValid() {
+        return canvas != NULL;
+    }
+    inline uint16_t getWidth() {
+        return decoder.getWidth();
+    }
+    inline uint16_t getHeight() {
+        return decoder.getHeight();
+    }
+
+    /**
+     * @brief Advance to the next frame, if the delay of the current one is over.
+     *
+     * @return true if the canvas changed (in getDirtyRect()) since the last call
+     */
+    bool update(unsigned long now);
+    /**
+     * @brief Copy the canvas (or only its dirty rectangle) to x/y of gfx.
+     */
+    void draw(Graphics2D* gfx, int16_t x, int16_t y, bool onlyDirty = false);
+    inline const Rect& getDirtyRect() {
+        return dirty;
+    }
+
+    /**
+     * @brief Pre-decode the whole loop into the delta cache and play from that.
+     *
+     * While building it, a second canvas is needed temporarily. Restarts the animation.
+     *
+     * @param maxBytes Upper bound of the cache size, it is not built if it would need more
+     * @return false if the cache would be too large (or the GIF is broken), the animation is then decoded as before
+     */
+    bool enableCache(size_t maxBytes);
+    void disableCache();
+    inline bool hasCache() {
+        return !cacheFrames.empty();
+    }
+    inline size_t getCacheSize() {
+        return cacheData.size() * sizeof(uint16_t) + cacheFrames.size() * sizeof(CachedFrame);
+    }
+
+    // Statistics, to find out what an animation costs
+    inline uint32_t getFrameCount() {
+        return frameCount;
+    }
+    /**
+     * @brief Average time (in us) it took to produce a frame in the canvas - decoding or replaying it from the cache.
+     */
+    inline uint32_t getAverageFrameTime() {
+        return frameCount > 0 ? frameTime / frameCount : 0;
+    }
+    inline uint32_t getLastFrameTime() {
+        return lastFrameTime;
+    }
+    inline void resetStatistics() {
+        frameCount = 0;
+        frameTime = 0;
+    }
+
+  private:
+    struct CachedFrame {
+        uint32_t offset; // Into cacheData, which holds the spans as (y, x, length, pixels...)
+        uint32_t length;
+        Rect dirty;
+        uint16_t delay;
+    };
+
+    GifDecoder decoder;
+    bool allocatePsram;
+    uint16_t* canvas = NULL;
+    Rect dirty = {};
+    unsigned long nextFrameAt = 0;
+    bool started = false;
+
+    // Disposal of the previous frame, applied before the next one is drawn
+    GifDecoder::Frame previous = {};
+    std::vector<uint16_t> previousPixels; // Only for disposal 3
+
+    std::vector<uint16_t> cacheData;
+    std::vector<CachedFrame> cacheFrames;
+    size_t cacheFrame = 0;
+
+    uint32_t frameCount = 0;
+    uint32_t frameTime = 0;
+    uint32_t lastFrameTime = 0;
+
+    uint16_t* allocateCanvas();
+    void freeCanvas(uint16_t* buffer);
+    /**
+     * @brief Decode the next frame into the canvas.
+     *
+     * @return Its delay in ms
+     */
+    uint16_t decodeFrame();
+    uint16_t replayFrame();
+    void restart();
+    static Rect unite(const Rect& a, const Rect& b);
+    Rect clip(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+};
+
+#endif
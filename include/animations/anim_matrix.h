@@ -1,6 +1,7 @@
 #ifndef ANIM_MATRIX_H
 #define ANIM_MATRIX_H
 #include "gfx_2d_print.h"
+#include "animations/anim_particles.h"
 
 #define MATRIX_STRING_MAX_LENGTH 16
 
@@ -12,15 +13,19 @@ class MatrixString {
         this->matrixChars = matrixChars;
         this->numMatrixChars = numMatrixChars;
         this->maxScale = maxScale;
-        randomize();
     }
-    void randomize(void) {
+    /**
+     * @brief Pick new characters and put the string above the screen.
+     */
+    void randomize(ParticleSystem& strings, uint16_t index, uint16_t frameRate) {
         length = random(MATRIX_STRING_MAX_LENGTH - 1) + 1;
-        x = 16 + random(gfx->getWidth() - 32);
+        const int16_t x = 16 + random(gfx->getWidth() - 32);
         scale = random(maxScale) + 1;
         gfx->setTextSize(scale);
-        y = 0 - (gfx->getTextOfsetRows(length)) - random(100);
-        speed = random(scale) + scale;
+        const int16_t y = 0 - (gfx->getTextOfsetRows(length)) - random(100);
+        const int16_t speed = random(scale) + scale; // px per frame
+        strings.reset(index, ParticleSystem::toFixed((int32_t) x), ParticleSystem::toFixed((int32_t) y), 0,
+                      ParticleSystem::toFixed((int32_t) (speed * frameRate)));
         for (uint8_t i = 0; i < length; i++) {
             s[i] = matrixChars[random(numMatrixChars)];
         }
@@ -28,17 +33,14 @@ class MatrixString {
 
     uint8_t length;
     char s[MATRIX_STRING_MAX_LENGTH];
-    int16_t x;
-    int16_t y;
     uint8_t scale;
-    int16_t speed;
     const char* matrixChars;
     uint8_t numMatrixChars;
     uint8_t maxScale;
 
     Graphics2DPrint* gfx;
 
-    void draw() {
+    void draw(int16_t x, int16_t y) {
         gfx->setTextSize(scale);
         gfx->setTextLeftAligned();
         gfx->setTextTopAligned();
@@ -48,15 +50,9 @@ class MatrixString {
             gfx->print(s[i]);
         }
 
-        y += speed;
-
         if (random(100) > 75) {
             s[random(length)] = matrixChars[random(numMatrixChars)];
         }
-
-        if (y > gfx->getHeight()) {
-            randomize();
-        }
     }
 };
 
@@ -64,7 +60,8 @@ class MatrixString {
 class AnimMatrix {
   public:
     AnimMatrix(Graphics2DPrint* gfx, const char* chars = "GATC", uint8_t charCount = 4, uint8_t stringCount = 32,
-               uint8_t maxScale = 3, uint16_t fgColor = rgb565(0, 255, 0), uint16_t maskColor = rgb565(255, 0, 0)) {
+               uint8_t maxScale = 3, uint16_t fgColor = rgb565(0, 255, 0), uint16_t maskColor = rgb565(255, 0, 0))
+        : strings(stringCount) {
         this->chars = chars;
         this->stringCount = stringCount;
         this->maxScale = maxScale;
@@ -73,8 +70,11 @@ class AnimMatrix {
 
         matrixStrings = new MatrixString*[stringCount];
 
+        // The strings never die (and keep their index), they are moved back up once they left the screen
         for (uint8_t i = 0; i < stringCount; i++) {
             matrixStrings[i] = new MatrixString(gfx, chars, charCount, maxScale);
+            strings.spawn(0, 0, 0, 0, 0);
+            matrixStrings[i]->randomize(strings, i, frameRate);
         }
     }
 
@@ -85,18 +85,30 @@ class AnimMatrix {
             gfx->setTextColor(rgb565(0, 32 + c * 64, 0), rgb565(255, 0, 0));
             for (uint8_t i = 0; i < stringCount; i++) {
                 if (matrixStrings[i]->scale == c) {
-                    matrixStrings[i]->draw();
+                    matrixStrings[i]->draw(ParticleSystem::toInt(strings.getX(i)), ParticleSystem::toInt(strings.getY(i)));
                 }
             }
         }
+
+        // The strings move by the same distance every frame
+        strings.update(1000 / frameRate);
+        for (uint8_t i = 0; i < stringCount; i++) {
+            if (ParticleSystem::toInt(strings.getY(i)) > gfx->getHeight()) {
+                matrixStrings[i]->randomize(strings, i, frameRate);
+            }
+        }
     }
 
     MatrixString** matrixStrings;
+    ParticleSystem strings;
     const char* chars;
     uint8_t stringCount;
     uint8_t maxScale;
     uint16_t fgColor;
     uint16_t maskColor;
+
+  private:
+    static constexpr uint16_t frameRate = 25; // Frames per second of the particle time, so a frame is exactly 40ms
 };
 
 #endif
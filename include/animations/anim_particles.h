@@ -0,0 +1,182 @@
+#ifndef ANIM_PARTICLES_H
+#define ANIM_PARTICLES_H
+
+#include <Arduino.h>
+
+#include <vector>
+
+class Graphics2D;
+
+/**
+ * @brief Particle system shared by the firework, matrix and autumn animations.
+ *
+ * The particles are kept as structure of arrays in 16.16 fixed point, so update() is a tight loop over integers - the
+ * only divisions happen once per call (or when a particle is spawned). A particle walks through its color ramp during
+ * its lifetime, and draw() writes all of them with a single Graphics2D::drawPixels().
+ */
+class ParticleSystem {
+  public:
+    typedef int32_t fixed; // 16.16
+
+    static inline fixed toFixed(int32_t value) {
+        return value * 65536;
+    }
+    static inline fixed toFixed(float value) {
+        return (fixed) (value * 65536.0f);
+    }
+    static inline int32_t toInt(fixed value) {
+        return value >> 16;
+    }
+    static inline fixed multiply(fixed a, fixed b) {
+        return (fixed) (((int64_t) a * b) >> 16);
+    }
+
+    enum class Edges : uint8_t {
+        NONE, // Particles may leave the bounds
+        KILL, // Particles leaving the bounds die
+        WRAP // Particles leaving the bounds come back on the other side
+    };
+
+    struct Rect {
+        int16_t x;
+        int16_t y;
+        uint16_t width;
+        uint16_t height;
+    };
+
+    struct Emitter {
+        fixed x;
+        fixed y;
+        fixed spread; // Random offset from x/y, in both directions
+        int16_t angleFrom; // Direction in degrees, 0 is right and 90 is down
+        int16_t angleTo;
+        fixed speedFrom; // px/s
+        fixed speedTo;
+        uint16_t lifeFrom; // ms, 0 lives forever
+        uint16_t lifeTo;
+        uint8_t ramp;
+        uint16_t rate; // Particles per second spawned by update(), 0 for bursts with emit() only
+    };
+
+    ParticleSystem(uint16_t capacity, uint8_t ramps = 1, uint8_t rampLength = 16);
+
+    // Forces, applied by update()
+    fixed gravityX = 0; // px/s²
+    fixed gravityY = 0;
+    fixed drag = 0; // Share of the speed lost per second
+    Edges edges = Edges::NONE;
+    Rect bounds = {0, 0, 240, 240};
+
+    /**
+     * @brief Set the rampLength colors a particle with this ramp shows from its birth to its death.
+     */
+    void setRamp(uint8_t ramp, const uint16_t* colors);
+    /**
+     * @brief Set a ramp which fades from one color to the other.
+     */
+    void setFadeRamp(uint8_t ramp, uint16_t from, uint16_t to);
+
+    /**
+     * @return false if the system is full
+     */
+    bool spawn(fixed x, fixed y, fixed speedX, fixed speedY, uint16_t life, uint8_t ramp = 0);
+    /**
+     * @brief Spawn a burst of count particles from the emitter.
+     *
+     * @return The number of particles spawned, less than count if the system is full
+     */
+    uint16_t emit(const Emitter& emitter, uint16_t count);
+    /**
+     * @brief Let update() spawn particles with the rate of the emitter.
+     *
+     * @return The id for getEmitter()
+     */
+    uint8_t addEmitter(const Emitter& emitter);
+    inline Emitter& getEmitter(uint8_t id) {
+        return emitters[id];
+    }
+    void removeEmitters();
+    void clear();
+
+    /**
+     * @brief Let ms pass: apply the forces, move, age and kill the particles, then run the emitters.
+     */
+    void update(uint16_t ms);
+    /**
+     * @brief Draw every particle as a pixel, offset by offsetX/offsetY.
+     */
+    void draw(Graphics2D* gfx, int16_t offsetX = 0, int16_t offsetY = 0);
+    /**
+     * @brief Dim the trails left by draw() on a target which is not cleared between the frames.
+     *
+     * Instead of dimming the whole frame, only the bounding box of the particles in the last frames is dimmed - for as
+     * many frames as it takes until the pixels drawn there are black.
+     */
+    void fadeTrails(Graphics2D* gfx, uint8_t amount);
+    /**
+     * @brief The bounding box of the pixels written by the last draw(), empty if there were none.
+     */
+    inline const Rect& getDrawnBounds() {
+        return drawnBounds;
+    }
+
+    inline uint16_t getCount() {
+        return count;
+    }
+    inline uint16_t getCapacity() {
+        return capacity;
+    }
+    inline fixed getX(uint16_t i) {
+        return x[i];
+    }
+    inline fixed getY(uint16_t i) {
+        return y[i];
+    }
+    inline fixed getSpeedX(uint16_t i) {
+        return speedX[i];
+    }
+    inline fixed getSpeedY(uint16_t i) {
+        return speedY[i];
+    }
+    inline uint16_t getAge(uint16_t i) {
+        return age[i];
+    }
+    /**
+     * @brief Place particle i somewhere else, e.g. to recycle it instead of letting it die.
+     */
+    void reset(uint16_t i, fixed x, fixed y, fixed speedX, fixed speedY);
+
+  private:
+    uint16_t capacity;
+    uint16_t count = 0;
+    std::vector<fixed> x;
+    std::vector<fixed> y;
+    std::vector<fixed> speedX;
+    std::vector<fixed> speedY;
+    std::vector<uint16_t> age;
+    std::vector<uint16_t> life;
+    std::vector<uint32_t> rampStep; // Ramp index per ms of age, in 8.24
+    std::vector<uint8_t> ramp;
+
+    uint8_t rampLength;
+    std::vector<uint16_t> rampColors;
+
+    std::vector<Emitter> emitters;
+    std::vector<uint32_t> emitterCarry; // Particles (in 1/1000) not spawned yet
+
+    // Scratch for draw()
+    std::vector<int16_t> pixelX;
+    std::vector<int16_t> pixelY;
+    std::vector<uint16_t> pixelColors;
+    Rect drawnBounds = {};
+
+    // Trails still to be faded: everything drawn in the current generation of frames and the one before that
+    Rect trailCurrent = {};
+    Rect trailPrevious = {};
+    uint8_t trailFrames = 0;
+
+    void kill(uint16_t i);
+    static Rect unite(const Rect& a, const Rect& b);
+};
+
+#endif
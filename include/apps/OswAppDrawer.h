@@ -28,6 +28,7 @@ class OswAppDrawer: public OswAppV2 {
 #endif
 
     const ViewFlags& getViewFlags() override;
+    uint8_t getCpuFrequency() override;
     bool getNeedsRedraw() override;
     void resetNeedsRedraw() override;
 
@@ -4,6 +4,7 @@
 #include <vector>
 #include <OswAppV1.h>
 #include "ArduinoJson.h"
+#include "OswMemoryTracker.h"
 #include "OswAppWeatherIconPrinter.h"
 
 class OswAppWeather : public OswApp {
@@ -41,7 +42,7 @@ class OswAppWeather : public OswApp {
     class WeatherParser {
       public:
         WeatherParser();
-        std::optional<String> encodeWeather(DynamicJsonDocument& doc);
+        std::optional<String> encodeWeather(OswJsonDocument& doc);
       private:
         int _getWCond(int weather_code);
         int cnt;
@@ -3,16 +3,34 @@
 
 #include <osw_hal.h>
 
-#include <OswAppV1.h>
+#include <animations/anim_firework.h>
+#include "apps/games/OswAppGame.h"
 
-class OswAppFireworks : public OswApp {
+class OswAppFireworks : public OswAppGame {
   public:
-    OswAppFireworks(void) {};
-    virtual void setup() override;
-    virtual void loop() override;
-    ~OswAppFireworks() {};
+    OswAppFireworks();
+    virtual ~OswAppFireworks() {};
+
+    const char* getAppId() override;
+    const char* getAppName() override;
+
+    void onStart() override;
+
+  protected:
+    bool onTick() override;
+    void onRender(float alpha) override;
 
   private:
+    static constexpr uint8_t numFireworks = 10;
+    static constexpr unsigned long tickTime = 1000 / 30; // ms
+
+    Firework fireworks[numFireworks];
+    int16_t offsets[numFireworks];
+    size_t sprites[numFireworks]; // Where each firework drew, so only those rows are flushed
+    uint8_t countdown = 10;
+    unsigned long countdownTicks = 0; // Until the next second of the countdown
+
+    void launch(uint8_t i, long minOffset);
 };
 
 #endif
@@ -5,6 +5,8 @@
 
 #include <OswAppV1.h>
 
+class AnimGif;
+
 class OswAppGifPlayer : public OswApp {
   public:
     OswAppGifPlayer() = default;
@@ -13,6 +15,10 @@ class OswAppGifPlayer : public OswApp {
     virtual void setup() override;
     virtual void loop() override;
     virtual void stop() override;
+
+  private:
+    AnimGif* gif = nullptr;
+    unsigned long statisticsSince = 0;
 };
 
 #endif
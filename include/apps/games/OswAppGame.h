@@ -0,0 +1,205 @@
+#pragma once
+
+#include <vector>
+
+#include <OswAppV2.h>
+
+/**
+ * Deterministic xorshift32 generator. Games draw all their randomness from here, so a game seeded with the same value
+ * replays the same way (given the same input) - which is what the headless tests rely on.
+ */
+class OswGameRandom {
+  public:
+    explicit OswGameRandom(uint32_t seed = 1) {
+        this->seed(seed);
+    }
+
+    void seed(uint32_t seed) {
+        this->state = seed == 0 ? 0x9E3779B9 : seed; // xorshift would stay at zero forever
+    }
+    uint32_t next() {
+        this->state ^= this->state << 13;
+        this->state ^= this->state >> 17;
+        this->state ^= this->state << 5;
+        return this->state;
+    }
+    /**
+     * Same as Arduinos random(max): 0 to max - 1
+     */
+    long random(long max) {
+        return max > 0 ? this->next() % max : 0;
+    }
+    /**
+     * Same as Arduinos random(min, max): min to max - 1
+     */
+    long random(long min, long max) {
+        return min < max ? min + this->random(max - min) : min;
+    }
+
+  private:
+    uint32_t state;
+};
+
+/**
+ * Keeps track of which part of the screen a game changed since the last frame.
+ *
+ * Sprites are placed again on every render - one that moved dirties its old and its new rectangle, one that was not
+ * placed anymore disappeared and dirties its old one. Tiles are set by the simulation, a tile that got another value
+ * dirties its rectangle. Everything else (score, texts, ...) has to be reported with markDirty().
+ */
+class OswGameLayer {
+  public:
+    struct Rect {
+        int16_t x;
+        int16_t y;
+        int16_t width;
+        int16_t height;
+
+        bool isEmpty() const {
+            return this->width <= 0 or this->height <= 0;
+        }
+        bool operator==(const Rect& other) const {
+            return this->x == other.x and this->y == other.y and this->width == other.width and this->height == other.height;
+        }
+        bool operator!=(const Rect& other) const {
+            return not (*this == other);
+        }
+        static Rect unite(const Rect& a, const Rect& b);
+    };
+
+    /**
+     * @return The id of the new (still hidden) sprite
+     */
+    size_t addSprite();
+    void placeSprite(size_t sprite, const Rect& rect);
+
+    /**
+     * Set up the tile grid (all tiles 0) at x/y of the screen - this dirties its whole area.
+     */
+    void setTiles(int16_t x, int16_t y, uint8_t columns, uint8_t rows, uint8_t tileWidth, uint8_t tileHeight);
+    void setTile(uint8_t column, uint8_t row, uint8_t value);
+    uint8_t getTile(uint8_t column, uint8_t row) const {
+        return this->tiles[row * this->columns + column];
+    }
+    Rect getTileRect(uint8_t column, uint8_t row) const {
+        return {(int16_t) (this->tilesX + column * this->tileWidth), (int16_t) (this->tilesY + row * this->tileHeight), this->tileWidth, this->tileHeight};
+    }
+    uint8_t getColumns() const {
+        return this->columns;
+    }
+    uint8_t getRows() const {
+        return this->rows;
+    }
+
+    void markDirty(const Rect& rect);
+    /**
+     * Redraw everything, e.g. because the screen was showing something else before
+     */
+    void markAllDirty() {
+        this->allDirty = true;
+    }
+    bool isAllDirty() const {
+        return this->allDirty;
+    }
+    /**
+     * The bounding box of everything that changed since the last commit(), including the sprites placed until now.
+     */
+    Rect getDirty() const;
+    /**
+     * The frame was drawn, forget the changes.
+     */
+    void commit();
+
+  private:
+    struct Sprite {
+        Rect shown; // As drawn in the last frame
+        Rect next; // As drawn in the current frame
+        bool placed;
+    };
+
+    std::vector<Sprite> sprites;
+    std::vector<uint8_t> tiles;
+    int16_t tilesX = 0;
+    int16_t tilesY = 0;
+    uint8_t columns = 0;
+    uint8_t rows = 0;
+    uint8_t tileWidth = 0;
+    uint8_t tileHeight = 0;
+    Rect dirty = {0, 0, 0, 0};
+    bool allDirty = true;
+};
+
+/**
+ * Base of the games: the simulation advances in fixed steps (onTick()), independent of how often the screen is drawn
+ * (onRender()). So the game plays at the same speed, no matter how long a frame takes - and the frames in between two
+ * ticks can interpolate the movement, or are not drawn at all if nothing changed.
+ *
+ * Only the rows of the screen the game reported as changed (see OswGameLayer) are sent to the display.
+ */
+class OswAppGame : public OswAppV2 {
+  public:
+    static constexpr uint8_t maxTicksPerLoop = 5; // If the loop stalls for longer, the game pauses instead of racing
+
+    OswAppGame(unsigned long tickInterval);
+    virtual ~OswAppGame() = default;
+
+    void onStart() override;
+    void onLoop() override;
+    void onDraw() override;
+    void onStop() override;
+
+    /**
+     * Run the ticks due after "elapsed" more ms, updates getAlpha()
+     *
+     * @return The number of ticks run
+     */
+    uint8_t advance(unsigned long elapsed);
+    /**
+     * How far (0 to 1) the time of the current frame is between the last tick and the next one
+     */
+    float getAlpha() const {
+        return (float) this->accumulator / this->tickInterval;
+    }
+    unsigned long getTickInterval() const {
+        return this->tickInterval;
+    }
+
+    static float lerp(float from, float to, float alpha) {
+        return from + (to - from) * alpha;
+    }
+
+  protected:
+    /**
+     * Advance the simulation by one tickInterval
+     *
+     * @return Whether something visible changed
+     */
+    virtual bool onTick() = 0;
+    /**
+     * Draw the current state, alpha is getAlpha() (always 1 if interpolate is off)
+     */
+    virtual void onRender(float alpha) = 0;
+    /**
+     * Called once per tick before onTick(), updates tiltX/tiltY from the accelerometer (if there is one)
+     */
+    virtual void sampleTilt();
+
+    float tiltX = 0; // Low-pass filtered acceleration (in g)
+    float tiltY = 0;
+    float tiltFilter = 0.5f; // Weight of a new sample
+    bool interpolate = false; // Redraw every loop while moving, between the ticks
+    OswGameRandom rng;
+    OswGameLayer layer;
+
+  private:
+    const unsigned long tickInterval;
+    unsigned long accumulator = 0;
+    unsigned long lastLoop = 0;
+    bool moving = false;
+
+    // Statistics
+    uint32_t ticks = 0;
+    uint32_t frames = 0;
+    uint32_t flushedRows = 0;
+    uint32_t droppedTicks = 0;
+};
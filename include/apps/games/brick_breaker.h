@@ -2,26 +2,32 @@
 #include OSW_TARGET_PLATFORM_HEADER
 #if OSW_PLATFORM_ENVIRONMENT_ACCELEROMETER == 1
 
+#include <array>
+
 #include <osw_hal.h>
 #include <osw_ui.h>
 
-#include <OswAppV1.h>
+#include "apps/games/OswAppGame.h"
 
-class OswAppBrickBreaker : public OswApp {
+class OswAppBrickBreaker : public OswAppGame {
   public:
-    OswAppBrickBreaker(void) {
-        ui = OswUI::getInstance();
-    };
-    virtual void setup() override;
-    virtual void loop() override;
-    virtual void stop() override;
-    ~OswAppBrickBreaker() {};
+    OswAppBrickBreaker();
+    virtual ~OswAppBrickBreaker() {};
+
+    const char* getAppId() override;
+    const char* getAppName() override;
+    const OswIcon& getAppIcon() override;
+
+    void onStart() override;
+    void onButton(Button id, bool up, OswAppV2::ButtonStateNames state) override;
+
+  protected:
+    bool onTick() override;
+    void onRender(float alpha) override;
 
   private:
-    OswUI* ui;
+    static constexpr unsigned long tickTime = 33; // ms
 
-#define cellSize 10
-#define snakeLength 30
     uint8_t buttonControllerMode = 0;
 
     // Change these values if sensitivity is too much/low
@@ -39,11 +45,14 @@ class OswAppBrickBreaker : public OswApp {
     int score = 0;
     int playerPos = 120;
     bool gameRunning = false;
-    unsigned long lastmove = 0;
-    int lastpos = 0;
+    std::array<bool, BTN_NUMBER> pressed = {}; // Since the last tick
+    size_t ballSprite = 0;
+    size_t playerSprite = 0;
 
     float ballPosx = 160;
     float ballPosy = 120;
+    float lastBallPosx = 160; // Before the last tick, to interpolate
+    float lastBallPosy = 120;
     float ballSpdx = -2;
     float ballSpdy = 4;
     float absspd = 0;
@@ -56,34 +65,21 @@ class OswAppBrickBreaker : public OswApp {
     float wallPosx = 0;
     float wallPosy = 0;
     float playerSpd = 0;
-
-    bool scoreUpdated = false;
-    bool grid[4][8] = {};
-    int hasbounced = 0;
-
-    int previousTime = 0;
-    int gameStart = 0;
     float spd = 1;
 
-    float deltaSeconds = 0;
-
-    void drawDirection(const int xDirection, const int yDirection);
-    void drawDirectionArrow(const int direction, const int topLeftX = 120, const int topLeftY = 13);
     void drawPlayer();
-    void blockHit();
     void drawGrid();
     void drawScore();
     void drawButtonHints();
-    void drawBall();
+    void drawBall(float alpha);
+    void drawWaitingRoom();
     void initGrid();
     void moveBall();
     void hitPlayer();
     void hitWall();
 
     // Game logics
-    void BrickBreaker();
-    void blockHit(const int x, const int y);
-    bool coordsInGame(const int xCoord, const int yCoord);
+    void blockHit(const int column, const int row);
     void resetGame(void);
 
     // Controls
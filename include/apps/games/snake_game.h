@@ -2,94 +2,102 @@
 #include OSW_TARGET_PLATFORM_HEADER
 #if OSW_PLATFORM_ENVIRONMENT_ACCELEROMETER == 1
 
+#include <array>
+
 #include <osw_hal.h>
 #include <osw_ui.h>
 
-#include <OswAppV1.h>
+#include "apps/games/OswAppGame.h"
 
-class OswAppSnakeGame : public OswApp {
+class OswAppSnakeGame : public OswAppGame {
   public:
-    OswAppSnakeGame(void) {
-        ui = OswUI::getInstance();
-    };
-    virtual void setup() override;
-    virtual void loop() override;
-    virtual void stop() override;
-    ~OswAppSnakeGame() {};
+    OswAppSnakeGame();
+    virtual ~OswAppSnakeGame() {};
+
+    const char* getAppId() override;
+    const char* getAppName() override;
+    const OswIcon& getAppIcon() override;
+
+    void onStart() override;
+    void onButton(Button id, bool up, OswAppV2::ButtonStateNames state) override;
+
+  protected:
+    bool onTick() override;
+    void onRender(float alpha) override;
 
   private:
-    OswUI* ui;
+    friend class TestSnakeGame;
 
-#define cellSize 10
-#define snakeLength 30
-    bool buttonControllerMode = false;
-    //#define demo 1
+    static constexpr int cellSize = 10;
+    static constexpr int snakeLength = 30;
+    static constexpr int gameWidth = 24; // Cells, in both directions
+    static constexpr unsigned long tickTime = 20; // ms
+    static constexpr unsigned long gameOverTime = 1000; // ms
+    static constexpr unsigned long fullScoreTime = 500; // ms
 
     // Change these values if sensitivity is too much/low
     const float xSensitivity = 0.75f;
     const float ySensitivity = 0.75f;
 
-    int score = 1;
-    int snake[snakeLength][2] = {{10, 10}};
-
-    bool gameRunning = false;
-    const int gameWidth = 30;
-
     enum direction_t: int {
         UP = 0,
         RIGHT = 1,
         DOWN = 2,
         LEFT = 3
     };
+    enum class State {
+        WAITING,
+        RUNNING,
+        GAME_OVER
+    };
+    // Tile values: which neighbours a body tile connects to, or what else is on it
+    enum Tile: uint8_t {
+        EMPTY = 0,
+        CONNECT_UP = 1,
+        CONNECT_RIGHT = 2,
+        CONNECT_DOWN = 4,
+        CONNECT_LEFT = 8,
+        BODY = 16,
+        HEAD = 32,
+        MEAL = 64
+    };
 
-    int lastDirection = direction_t::DOWN;
+    bool buttonControllerMode = false;
+    State state = State::WAITING;
+    unsigned long stateTicks = 0; // Until the game over is over
+    std::array<bool, BTN_NUMBER> pressed = {}; // Since the last tick
 
+    int score = 1;
+    int snake[snakeLength][2] = {{10, 10}};
+    int lastDirection = direction_t::DOWN;
     int xDirection = 0;
     int yDirection = 1;
-
     int mealXCoord = 10;
     int mealYCoord = 10;
-
-    bool scoreUpdated = false;
-
-    int nbTurns = 0;
-    int previousTime = 0;
-    int gameStart = 0;
-
-    const int yCells = gameWidth - 30 / cellSize;
-    const int squaredWidth = 110 * 110;
-    const int halfSize = cellSize / 2;
-
-    float deltaSeconds = 0;
+    unsigned long progress = 0; // The snake moves when this reaches 1000, it grows faster with the score
 
     void drawDirection(const int xDirection, const int yDirection);
     void drawDirectionArrow(const int direction, const int topLeftX = 120, const int topLeftY = 13);
-    void drawPlayer();
+    void drawTile(uint8_t column, uint8_t row);
     void drawGameState();
-    void drawLunch();
-    void drawGrid();
     void drawScore();
     void drawButtonHints();
+    void drawWaitingRoom();
 
     // Game logics
-    void snakeGame();
     void resetGame();
     void proceedEating();
     void spawnEat();
+    void updateTiles();
     bool coordsInGame(const int xCoord, const int yCoord);
+    void markHudDirty();
 
     // Controls
     void buttonController();
     void accelerometerController();
-    void autoController();
     void useLastDirection();
 
-    void waitingRoom();
-
-    void proceedSnakeCoords(const bool fastGame);
+    bool proceedSnakeCoords();
     bool touchItself();
-    bool isTimeFinish() {
-        return deltaSeconds * score > 1;
-    }
 };
 #endif
@@ -15,6 +15,12 @@
 #define lUA_LIB_SEARCH_PATH FS_MOUNT_POINT "/lua/libs/?.lua"
 #define LUA_PACKAGE_CMD "package.path = package.path .. ';" lUA_APP_SEARCH_PATH ";" lUA_LIB_SEARCH_PATH "'"
 
+#define LUA_SCRIPT_ROOT FS_MOUNT_POINT "/lua/"
+#define LUA_CACHE_PATH LUA_SCRIPT_ROOT "cache/" // Flat, as SPIFFS has no real directories
+
+#define LUA_GC_FRAME_BUDGET_US 2000 // Time spent on incremental collection after each frame
+#define LUA_GC_STEP_KB 4
+
 class OswLuaApp : public OswApp {
   public:
     OswLuaApp(const char* file) : file(file) {};
@@ -23,9 +29,12 @@ class OswLuaApp : public OswApp {
     virtual void stop() override;
     ~OswLuaApp() {};
 
+    static int loadScript(lua_State* L, const char* path);
+
   private:
     void cleanupState();
     void printLuaError();
+    void collectGarbage();
 
     lua_State* luaState = NULL;
 
@@ -3,8 +3,8 @@
 
 #include <OswAppV2.h>
 #include <osw_hal.h>
-#include <HTTPClient.h>
 #include <ArduinoJson.h>
+#include <OswSensorTrace.h>
 
 class OswAppSensorDataLogger : public OswAppV2 {
 public:
@@ -20,6 +20,7 @@ public:
     void onDraw() override;
     void onDrawOverlay() override;
     void onStop() override;
+    void onButton(Button id, bool up, ButtonStateNames state) override;
 
 private:
     // Sensor data structure - enhanced with all available sensors
@@ -52,11 +53,16 @@ private:
     unsigned long lastUpdateTime;
     unsigned long lastServerUpdate;
     
-    // Server communication
-    String serverUrl;
+    // Server communication (through the OswServiceTaskCommunication)
     bool serverConnected;
     int updateInterval; // milliseconds
     
+    // Sensor trace recording (for the replay in the emulator), toggled by BUTTON_UP
+    static constexpr unsigned long traceInterval = 20; // ms
+    OswSensorTraceWriter trace;
+    unsigned long lastTraceSample;
+    uint8_t traceButtons; // Bitmask of the buttons down in the trace
+
     // UI state
     int displayMode; // 0: sensors, 1: connection, 2: settings
     bool autoUpdate;
@@ -68,7 +74,8 @@ private:
     void drawConnectionStatus();
     void drawSettings();
     String formatSensorData();
-    bool connectToServer();
+    void toggleTrace();
+    void recordTrace();
 };
 
 #endif
@@ -28,6 +28,14 @@
 #define DISP_CHUNK_H_LD 3
 #endif
 
+// Low memory mode of the display: chunks kept in RAM and draw operations recorded per frame (see Graphics2D::enableStripBuffer())
+#ifndef DISP_STRIP_CHUNKS
+#define DISP_STRIP_CHUNKS 2
+#endif
+#ifndef DISP_DISPLAY_LIST_SIZE
+#define DISP_DISPLAY_LIST_SIZE 2048
+#endif
+
 /*
  * Language:
  * Here you can select the language of the compiled os. By compiling the language directly
@@ -275,6 +283,18 @@
 #define OPENWEATHERMAP_STATE_CODE "IT"
 #endif
 
+#ifndef OTA_SIGNING_KEY
+#define OTA_SIGNING_KEY "" // Updates need no signed manifest (see scripts/ota/signManifest.py)
+#endif
+
+#ifndef COMMUNICATION_SERVER_URL
+#ifdef OSW_EMULATOR
+#define COMMUNICATION_SERVER_URL "http://localhost:8080/messages" // See scripts/communication/standInServer.py
+#else
+#define COMMUNICATION_SERVER_URL "" // Messages are only queued
+#endif
+#endif
+
 // USERTrust RSA Root xSigned using AAA CA
 // this certificate is valid until 01/01/2029
 // source https://support.sectigo.com/articles/Knowledge/Sectigo-Intermediate-Certificates
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <set>
 
 #include <Arduino.h>
@@ -10,9 +11,40 @@ class OswDevice {
     virtual void update() = 0;
     virtual void reset() = 0;
     virtual void stop() = 0;
+    /**
+     * Light sleep: the device keeps its configuration and state, so resume() can continue without a new setup().
+     * Most devices do not need anything here, as they are kept running (e.g. for wakeup detection or time keeping).
+     */
+    virtual void suspend() {};
+    virtual void resume() {};
 
     virtual const char* getName() = 0;
 
+    /**
+     * How often update() should be called (in ms), this should match the output data rate of the sensor - polling it
+     * faster only costs bus time. 0 updates the device on every loop.
+     */
+    virtual unsigned long getUpdateInterval() {
+        return 0;
+    };
+    /**
+     * Rough duration of one update() (in µs), so the scheduler can spread the expensive ones over multiple loops
+     */
+    virtual unsigned int getUpdateCost() {
+        return 0;
+    };
+    /**
+     * Updates the device every interval ms for the next duration ms, if that is faster than its own interval (e.g.
+     * while a compass is shown) - call it again to extend it
+     */
+    void boost(unsigned long interval, unsigned long duration = 1000);
+    /**
+     * millis() of the last update(), the age of the cached values
+     */
+    unsigned long getLastUpdate() const {
+        return this->lastUpdate;
+    };
+
     static const std::set<OswDevice*>* getAllDevices() {
         return &allDevices;
     };
@@ -21,4 +53,12 @@ class OswDevice {
     virtual ~OswDevice();
   private:
     static std::set<OswDevice*> allDevices;
+
+    friend class OswDeviceScheduler;
+    // Only used by the scheduler (under its lock)
+    bool updateScheduled = false;
+    unsigned long updateSlot = 0; // When the last update was due, the next one is one interval later
+    std::atomic<unsigned long> lastUpdate = 0;
+    std::atomic<unsigned long> boostInterval = 0;
+    std::atomic<unsigned long> boostUntil = 0;
 };
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <Arduino.h>
+#include <devices/OswDevice.h>
+
+/**
+ * Decides which devices are updated when: every device is polled at its own interval (see
+ * OswDevice::getUpdateInterval()), the most overdue ones first - until the budget of one run is used up. The rest
+ * follows with the next run, unless it is already late by a whole interval (so nothing starves).
+ *
+ * On the watch the runs happen on a dedicated task on core 0, so the bus traffic no longer delays the UI loop.
+ */
+class OswDeviceScheduler {
+  public:
+    OswDeviceScheduler(unsigned int budget = 2000) : budget(budget) {};
+    ~OswDeviceScheduler();
+    OswDeviceScheduler(const OswDeviceScheduler&) = delete;
+    OswDeviceScheduler& operator=(const OswDeviceScheduler&) = delete;
+
+    /**
+     * Updates the devices which are due at now (ms)
+     *
+     * @return ms until the next device is due
+     */
+    unsigned long updateDue(unsigned long now);
+    /**
+     * Updates all devices right away, ignoring their intervals and the budget
+     */
+    void updateAll(unsigned long now);
+    /**
+     * Updates one device right away, e.g. to get a fresh reading of it
+     */
+    void updateNow(OswDevice* device, unsigned long now);
+
+    /**
+     * The interval of the device at now, considering its boost
+     */
+    static unsigned long getInterval(OswDevice* device, unsigned long now);
+
+    /**
+     * Runs updateDue() on its own task - does nothing in the emulator, where the main loop keeps calling updateDue()
+     */
+    void startTask();
+    void stopTask();
+    bool isTaskRunning() const {
+        return this->taskRunning;
+    };
+
+    /**
+     * Runs while holding this lock, so take it before talking to a device outside of its update()
+     */
+    std::mutex& getBusLock() {
+        return this->bus;
+    };
+    /**
+     * Updates which had to wait for the next run, as the budget was used up
+     */
+    uint32_t getDeferredUpdates() const {
+        return this->deferred;
+    };
+
+  private:
+    const unsigned int budget; // µs per run
+    std::mutex bus;
+    // Scratch space of the runs, so they do not allocate (guarded by the bus lock)
+    std::vector<OswDevice*> devices;
+    std::vector<std::pair<long, OswDevice*>> due; // How late, which device
+    std::atomic<uint32_t> deferred = 0;
+
+    std::atomic<bool> taskRunning = false;
+#ifndef OSW_EMULATOR
+    TaskHandle_t task = nullptr;
+    std::atomic<bool> taskStopped = false;
+    const unsigned taskStackSize = 4096;
+#endif
+    const unsigned long minTaskDelay = 2; // ms, lets the idle task (and its watchdog) run
+    const unsigned long maxTaskDelay = 50; // ms, so boosts are picked up quickly
+
+    void update(OswDevice* device, unsigned long now);
+    void taskLoop();
+};
@@ -21,6 +21,13 @@ class BMA400 : public OswTemperatureProvider, public OswAccelerationProvider {
     virtual inline const char* getName() override {
         return "BMA400";
     };
+    // Enough for the step counter (which runs on the sensor) and tilt based UIs
+    virtual inline unsigned long getUpdateInterval() override {
+        return 50;
+    };
+    virtual inline unsigned int getUpdateCost() override {
+        return 400;
+    };
 
     virtual float getTemperature() override;
     virtual inline unsigned char getTemperatureProviderPriority() override {
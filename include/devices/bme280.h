@@ -14,10 +14,19 @@ class BME280 : public OswTemperatureProvider, public OswHumidityProvider, public
     virtual void update() override;
     virtual void reset() override {};
     virtual void stop() override;
+    virtual void suspend() override;
+    virtual void resume() override;
 
     virtual inline const char* getName() override {
         return "BME280";
     };
+    // Matches the configured standby time
+    virtual inline unsigned long getUpdateInterval() override {
+        return 1000;
+    };
+    virtual inline unsigned int getUpdateCost() override {
+        return 800;
+    };
 
     virtual float getTemperature() override;
     virtual inline unsigned char getTemperatureProviderPriority() override {
@@ -21,6 +21,13 @@ class BMI270 : public OswAccelerationProvider, public OswTemperatureProvider {
     virtual inline const char* getName() override {
         return "BMI270";
     };
+    // Enough for the step counter (which runs on the sensor) and tilt based UIs
+    virtual inline unsigned long getUpdateInterval() override {
+        return 50;
+    };
+    virtual inline unsigned int getUpdateCost() override {
+        return 400;
+    };
     virtual float getAccelerationX() override;
     virtual float getAccelerationY() override;
     virtual float getAccelerationZ() override;
@@ -21,6 +21,12 @@ class BMP581 : public OswPressureProvider, public OswTemperatureProvider {
     virtual inline const char* getName() override {
         return "BMP581";
     };
+    virtual inline unsigned long getUpdateInterval() override {
+        return 200;
+    };
+    virtual inline unsigned int getUpdateCost() override {
+        return 400;
+    };
 
     virtual float getPressure() override;
     virtual unsigned char getPressureProviderPriority() override {
@@ -2,6 +2,8 @@
 #include OSW_TARGET_PLATFORM_HEADER
 #if OSW_PLATFORM_HARDWARE_DS3231MZ == 1
 
+#include <mutex>
+
 #include <Wire.h>
 #include <RtcDS3231.h>
 
@@ -22,6 +24,13 @@ class DS3231MZ : public OswTemperatureProvider, public OswTimeProvider {
     virtual inline const char* getName() override {
         return "DS3231MZ";
     };
+    // Only to discipline the OswClock, which keeps the time in between
+    virtual inline unsigned long getUpdateInterval() override {
+        return 60000;
+    };
+    virtual inline unsigned int getUpdateCost() override {
+        return 600;
+    };
 
     virtual float getTemperature() override;
     virtual inline unsigned char getTemperatureProviderPriority() override {
@@ -30,12 +39,17 @@ class DS3231MZ : public OswTemperatureProvider, public OswTimeProvider {
 
     virtual time_t getUTCTime() override;
     virtual void setUTCTime(const time_t& epoch) override;
+    virtual OswClock::Sample getUTCTimeSample() override;
     virtual inline unsigned char getTimeProviderPriority() override {
         return 100;
     }; // This is a specialized device!
   private:
     RtcDS3231<TwoWire> Rtc;
-    uint32_t _utcTime = 0;
+    // Written by update() on the task of the scheduler, read by everyone - so only ever as a whole
+    std::mutex _sampleLock;
+    OswClock::Sample _sample;
+
+    void publish(const OswClock::Sample& sample);
 };
 };
 #endif
@@ -17,6 +17,9 @@ class NativeESP32 : public OswTemperatureProvider, public OswTimeProvider {
     virtual inline const char* getName() override {
         return "ESP32";
     };
+    virtual inline unsigned long getUpdateInterval() override {
+        return 1000;
+    };
 
     bool isTemperatureSensorAvailable();
     virtual float getTemperature() override;
@@ -33,7 +36,6 @@ class NativeESP32 : public OswTemperatureProvider, public OswTimeProvider {
     virtual inline unsigned char getTimeProviderPriority() override {
         return 40;
     }; // This is a specialized (bad) device!
-    virtual time_t getTimezoneOffset(const time_t& timestamp, const String& timezone) override;
   private:
     const time_t successfulNTPTime = 1600000000; // This is the UNIX timestamp for the "Sunday, 13 September 2020 12:26:40" -> if the time of the ESP32 is at least this value, we consider the NTP update to be successful
     bool tempSensorIsBuiltIn = true;
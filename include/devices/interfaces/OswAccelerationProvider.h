@@ -18,6 +18,9 @@ class OswAccelerationProvider : public OswDevice {
     virtual float getAccelerationZ() = 0;
 
     virtual uint32_t getStepCount() = 0;
+    /**
+     * May talk to the device, so hold the bus lock (see OswHal::Devices::getBusLock())
+     */
     virtual void resetStepCount() = 0;
     virtual ActivityMode getActivityMode() = 0;
 
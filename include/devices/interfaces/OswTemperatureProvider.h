@@ -6,6 +6,9 @@
 
 class OswTemperatureProvider : public OswDevice {
   public:
+    /**
+     * May talk to the device, so hold the bus lock (see OswHal::Devices::getBusLock())
+     */
     virtual float getTemperature() = 0;
 
     virtual unsigned char getTemperatureProviderPriority() = 0;
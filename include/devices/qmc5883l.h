@@ -21,6 +21,12 @@ class QMC5883L : public OswMagnetometerProvider {
     virtual inline const char* getName() override {
         return "QMC5883L";
     };
+    virtual inline unsigned long getUpdateInterval() override {
+        return 100;
+    };
+    virtual inline unsigned int getUpdateCost() override {
+        return 300;
+    };
 
     virtual int getMagnetometerAzimuth() override;
     virtual inline unsigned char getMagnetometerProviderPriority() override {
@@ -7,6 +7,9 @@
 #include <devices/interfaces/OswMagnetometerProvider.h>
 #include <devices/interfaces/OswPressureProvider.h>
 #include <devices/interfaces/OswTimeProvider.h>
+#ifdef OSW_EMULATOR
+#include <FakeClock.h>
+#endif
 
 namespace OswDevices {
 class Virtual : public OswTemperatureProvider, public OswAccelerationProvider, public OswHumidityProvider,
@@ -102,6 +105,10 @@ class Virtual : public OswTemperatureProvider, public OswAccelerationProvider, p
     };
 
     virtual time_t getUTCTime() override {
+#ifdef OSW_EMULATOR
+        if(FakeClock::isEnabled())
+            return FakeClock::getUTCTime();
+#endif
         return time(nullptr);
     };
     virtual void setUTCTime(const time_t& epoch) {
@@ -110,9 +117,6 @@ class Virtual : public OswTemperatureProvider, public OswAccelerationProvider, p
     virtual unsigned char getTimeProviderPriority() override {
         return this->priority;
     };
-#ifdef OSW_EMULATOR
-    virtual time_t getTimezoneOffset(const time_t& timestamp, const String& timezone) override;
-#endif
   private:
     const unsigned char priority;
 };
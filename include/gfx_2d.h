@@ -16,6 +16,19 @@ class DrawPixel {
     virtual void drawPixelAA(int32_t x, int32_t y, uint16_t color, uint8_t alpha) {};
 };
 
+class Graphics2D;
+
+/**
+ * @brief Takes over a frame of the strip buffer, once its display list is full (see Graphics2D::setDisplayListSpill()).
+ */
+class DisplayListSpill : public DrawPixel {
+  public:
+    /**
+     * @brief Send the frame recorded so far - the rest of it is drawn with drawPixel() then.
+     */
+    virtual void begin(Graphics2D* gfx) {};
+};
+
 class Graphics2D {
   public:
     Graphics2D(uint16_t w_, uint16_t h_, uint8_t chunkHeightLd_, bool isRound_ = false, bool allocatePsram_ = false)
@@ -26,14 +39,99 @@ class Graphics2D {
         alphaEnabled = false;
     }
 
-    void enableBuffer();
+    /**
+     * @brief Keep all chunks in RAM.
+     *
+     * The chunks share one contiguous block, sized for the chunk widths of round displays and with every chunk 4 byte
+     * aligned. If there is not enough memory for a second frame, the buffer is single buffered; if there is not even
+     * enough for one, hasBuffer() stays false and all draw calls are dropped.
+     *
+     * @param doubleBuffered Keep a second frame, see swapBuffers()
+     */
+    void enableBuffer(bool doubleBuffered = false);
 
     inline bool hasBuffer() {
-        return drawPixelCallback == NULL;
+        return drawPixelCallback == NULL && displayList == NULL && buffer != NULL;
+    }
+    inline bool isDoubleBuffered() {
+        return frontBuffer != NULL;
+    }
+    /**
+     * @brief Make the frame drawn so far the front frame and continue drawing into the other one.
+     *
+     * The front frame can then be read (e.g. sent to the display) via getFrontChunk(), while the next frame is drawn.
+     * Note that the new back frame still holds the frame before the last one, so it has to be drawn completely again.
+     */
+    void swapBuffers();
+    inline uint16_t* getFrontChunk(uint8_t chunkId) {
+        return frontBuffer[chunkId];
+    }
+
+    /**
+     * @brief Keep the frame memory of enableBuffer() when switching to a strip buffer or no buffer at all.
+     *
+     * Switching back then neither touches the heap nor moves the chunks. If the reservation is dropped while there is
+     * no buffer, the memory is freed right away.
+     */
+    void setFrameMemoryReserved(bool reserved);
+    /**
+     * @return Bytes allocated for the frame(s) of enableBuffer(), including a reserved block while there is no buffer
+     */
+    inline size_t getFrameMemorySize() {
+        return frameMemorySize;
     }
 
     void disableBuffer(DrawPixel* callback);
 
+    /**
+     * @brief Only keep a strip of stripChunks chunks in RAM.
+     *
+     * All draw calls are recorded into a display list of up to displayListSize operations instead, which is replayed
+     * for every strip by renderStrip(). A frame starts with fillBuffer() (or fill()), which discards the previous
+     * list. Operations exceeding the list are counted in getDisplayListOverflows() and handed to the spill, see
+     * setDisplayListSpill() - without one they are dropped.
+     *
+     * @param stripChunks Number of chunks rendered per replay of the list
+     * @param displayListSize Maximum number of recorded operations per frame
+     */
+    void enableStripBuffer(uint8_t stripChunks, uint16_t displayListSize);
+
+    inline bool hasStripBuffer() {
+        return displayList != NULL;
+    }
+    inline uint8_t getStripChunks() {
+        return stripChunks;
+    }
+    inline uint16_t getDisplayListLength() {
+        return displayListLength;
+    }
+    inline uint32_t getDisplayListOverflows() {
+        return displayListOverflows;
+    }
+    /**
+     * @brief Once the display list is full, the spill sends the frame recorded so far and the rest of the frame is drawn
+     * through it, until the next frame starts.
+     *
+     * The spill draws straight to the display, so the pixels below are not known anymore: blending uses the background of
+     * the frame and dimming is dropped.
+     */
+    inline void setDisplayListSpill(DisplayListSpill* spill) {
+        displayListSpill = spill;
+    }
+    /**
+     * @return true if the current frame overflowed into the spill, so it must not be sent again
+     */
+    inline bool isDisplayListSpilled() {
+        return displayListSpilled;
+    }
+
+    /**
+     * @brief Replay the display list into the strip starting at firstChunk.
+     *
+     * Afterwards only the chunks of that strip are available via getChunk(), until the next call.
+     */
+    void renderStrip(uint16_t firstChunk);
+
     void fillBuffer(uint16_t color);
 
     ~Graphics2D();
@@ -45,6 +143,12 @@ class Graphics2D {
     inline uint16_t* getChunk(uint8_t chunkId) {
         return buffer[chunkId];
     }
+    /**
+     * @brief Like getShownPixel(), the chunk of the front frame if double buffered - otherwise getChunk().
+     */
+    inline uint16_t* getShownChunk(uint8_t chunkId) {
+        return frontBuffer != NULL ? frontBuffer[chunkId] : buffer[chunkId];
+    }
     inline uint8_t getChunkHeightLd() {
         return chunkHeightLd;
     }
@@ -108,6 +212,12 @@ class Graphics2D {
      * @param alpha alpha value to blend with color
      */
     void drawPixelAA(int32_t x, int32_t y, uint16_t color, uint8_t alpha) {
+        if (displayList != NULL && !replayingStrip) {
+            // The pixel below is not known before the replay
+            if (x < width && y < height && x >= 0 && y >= 0)
+                recordPixel(x, y, color, DISPLAY_LIST_BLEND, alpha);
+            return;
+        }
         uint16_t old_color = getPixel(x, y);
 
         uint16_t new_color = blend(old_color, color, alpha);
@@ -116,12 +226,47 @@ class Graphics2D {
 
     void drawPixelClipped(int32_t x, int32_t y, uint16_t color);
 
+    /**
+     * @brief The pixel of the frame being drawn - if double buffered, that is the back frame, which still holds the frame
+     * before the last one until it was drawn over.
+     */
     uint16_t getPixel(uint16_t x, uint16_t y);
+    /**
+     * @brief The pixel of the frame last made the front frame (see swapBuffers()), e.g. for screenshots - the same as
+     * getPixel() if not double buffered.
+     */
+    uint16_t getShownPixel(uint16_t x, uint16_t y);
 
     bool isInsideChunk(uint16_t x, uint16_t y);
 
     void drawHLine(int32_t x, int32_t y, uint16_t w, uint16_t color);
 
+    /**
+     * @brief Draw a row of w pixels with the given colors, starting at x/y.
+     *
+     * The visible part is copied into the chunk at once, unless a mask, alpha, a pixel callback or a display list
+     * needs every pixel on its own.
+     *
+     * @param x x axis coordinate of the first pixel
+     * @param y y axis coordinate of the row
+     * @param colors w color codes
+     * @param w number of pixels
+     */
+    void drawSpan(int32_t x, int32_t y, const uint16_t* colors, uint16_t w);
+
+    /**
+     * @brief Draw count single pixels at once, e.g. all particles of a frame.
+     *
+     * Like drawSpan(), the pixels are written straight into the chunks unless a mask, alpha, a pixel callback or a
+     * display list needs every pixel on its own.
+     *
+     * @param x x axis coordinates of the pixels
+     * @param y y axis coordinates of the pixels
+     * @param colors color codes of the pixels
+     * @param count number of pixels
+     */
+    void drawPixels(const int16_t* x, const int16_t* y, const uint16_t* colors, uint16_t count);
+
     void drawVLine(int32_t x, int32_t y, uint16_t h, uint16_t color);
 
     void drawFrame(int32_t x, int32_t y, uint16_t w, uint16_t h, uint16_t color);
@@ -312,6 +457,11 @@ class Graphics2D {
     void fill(uint16_t color);
 
     void dim(uint8_t amount);
+
+    /**
+     * @brief Dim only the pixels inside of the given rectangle, like dim() does for the whole frame.
+     */
+    void dimArea(int32_t x, int32_t y, uint16_t w, uint16_t h, uint8_t amount);
     void drawGraphics2D(int16_t offsetX, int16_t offsetY, Graphics2D* source);
 
     void drawGraphics2D(int16_t offsetX, int16_t offsetY, Graphics2D* source, int16_t sourceOffsetX,
@@ -334,11 +484,58 @@ class Graphics2D {
                                 float angle);
 
   protected:
-    uint16_t** buffer;
-    uint16_t numChunks;
+    /**
+     * @brief One recorded operation of the display list: a run of length pixels, starting at x/y.
+     */
+    struct DisplayListOp {
+        int16_t x;
+        int16_t y;
+        uint16_t length;
+        uint16_t color;
+        uint8_t flags;
+        uint8_t alpha;
+    };
+    enum DisplayListFlags : uint8_t {
+        DISPLAY_LIST_VERTICAL = 1, // The run goes down instead of right
+        DISPLAY_LIST_BLEND = 2,    // Blend color with alpha into the pixels below
+        DISPLAY_LIST_DIM = 4       // Dim by alpha: length columns and color rows from x/y, the whole frame if length is 0
+    };
+
+    uint16_t** buffer = NULL;
+    uint16_t** frontBuffer = NULL; // Only if double buffered
+    uint16_t numChunks = 0;
     DrawPixel* drawPixelCallback;
-    uint16_t* chunkXOffsets;
-    uint16_t* chunkWidths;
+    uint16_t* chunkXOffsets = NULL;
+    uint16_t* chunkWidths = NULL;
+
+    // All chunks of enableBuffer(), see allocateFrameMemory()
+    uint16_t* frameMemory = NULL;
+    size_t frameMemorySize = 0;
+    bool frameMemoryReserved = false;
+
+    // Strip rendering, see enableStripBuffer()
+    DisplayListOp* displayList = NULL;
+    uint16_t displayListSize = 0;
+    uint16_t displayListLength = 0;
+    uint32_t displayListOverflows = 0;
+    uint16_t* stripMemory = NULL;
+    uint8_t stripChunks = 0;
+    uint16_t stripBackground = 0;
+    bool replayingStrip = false;
+    int32_t renderedStrip = -1; // First chunk of the strip in the buffer, -1 if the display list changed since
+    DisplayListSpill* displayListSpill = NULL;
+    bool displayListSpilled = false;
+
+    void initChunkLayout();
+    size_t getFramePixels();
+    bool allocateFrameMemory(uint8_t frames);
+    void freeFrameMemory();
+    void mapFrames(uint8_t frames);
+    void releaseBuffers();
+    void recordPixel(int32_t x, int32_t y, uint16_t color, uint8_t flags, uint8_t alpha);
+    void recordOp(const DisplayListOp& op);
+    uint16_t readPixel(uint16_t** chunks, uint16_t x, uint16_t y);
+    void spillOp(const DisplayListOp& op);
 
     /**
      * @brief Width (in pixels) of the display frame
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 
 #include <osw_util.h>
 #include <osw_hal.h>
 #include <devices/OswDevice.h>
+#include <devices/OswDeviceScheduler.h>
 #include <devices/bma400.h>
 #include <devices/qmc5883l.h>
 #include <devices/bme280.h>
@@ -42,12 +44,23 @@ class OswHal::Devices {
 #endif
 
     void setup(const bool& fromLightSleep);
-    void update(); // Request devices to update their (cached) states
+    void update(); // Request all devices to update their (cached) states right now
+    void update(OswDevice* device); // Request one device to update its (cached) state right now
+    void updateDue(); // Update the devices which are due (see OswDeviceScheduler), unless the bus task does that already
     void stop(const bool& toLightSleep);
+    void suspend();
+    void resume();
+    /**
+     * Take it around any bus access outside of the device updates, which run on the task of the scheduler
+     */
+    std::mutex& getBusLock() {
+        return this->scheduler.getBusLock();
+    };
   protected:
     Devices();
     ~Devices();
     friend OswHal;
     friend std::unique_ptr<OswHal::Devices>::deleter_type;
   private:
+    OswDeviceScheduler scheduler;
 };
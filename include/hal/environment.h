@@ -33,6 +33,7 @@ class OswHal::Environment {
     int getMagnetometerY();
     int getMagnetometerZ();
     int getMagnetometerAzimuth();
+    void boostMagnetometer(unsigned long interval = 50, unsigned long duration = 1000); // See OswDevice::boost()
 #endif
 
 #if OSW_PLATFORM_ENVIRONMENT_ACCELEROMETER == 1
@@ -40,6 +41,7 @@ class OswHal::Environment {
     float getAccelerationY();
     float getAccelerationZ();
     OswAccelerationProvider::ActivityMode getActivityMode();
+    void boostAccelerometer(unsigned long interval = 20, unsigned long duration = 1000); // See OswDevice::boost()
     // Statistics: Steps
     uint32_t getStepsToday();
     void resetStepCount();
@@ -122,6 +122,7 @@
 #define LANG_IMGUI_BUTTONS "Tasten"
 #define LANG_IMGUI_VIRTUAL_SENSORS "Virtuelle Sensoren"
 #define LANG_IMGUI_VIRTUAL_SENSORS_NOPE "Die virtuellen Sensoren sind nur verfügbar, wenn das virtuelle Gerät aktiv ist."
+#define LANG_IMGUI_MEMORY "Speicher"
 #define LANG_IMGUI_CONFIGURATION "Konfiguration"
 #define LANG_IMGUI_CONFIGURATION_NOPE "Die Konfiguration wurde (noch) nicht geladen."
 #define LANG_EMULATOR_CPU_ACTIVE "Aktiv"
@@ -134,6 +135,7 @@
 #define LANG_EMULATOR_BTN "Taste"
 #define LANG_EMULATOR_BTN_PWR_HELP "Dies wird die Stromversorgung zur CPU unterbrechen und das Betriebssystem zurücksetzen (ähnlich zum " LANG_EMULATOR_CPU_DEEP_SLEEP ")."
 #define LANG_EMULATOR_MBTN "Loslassen nach Multi-Tasten-Klick"
+#define LANG_EMULATOR_BTN_KEYS "Tastatur: Enter = SELECT, Pfeil hoch = UP, Pfeil runter = DOWN"
 #define LANG_EMULATOR_MBTN_HELP "Wenn du eine beliebige Taste gedrückt hältst und dann eine andere Taste drückst, werden alle anderen gedrückten Tasten losgelassen."
 
 // At the very last: Include English as a fallback -> any keys not found in the current language, they will be defined in English
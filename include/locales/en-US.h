@@ -319,6 +319,9 @@
 #ifndef LANG_IMGUI_VIRTUAL_SENSORS_NOPE
 #define LANG_IMGUI_VIRTUAL_SENSORS_NOPE "The virtual sensors are only available, while the virtual device is active."
 #endif
+#ifndef LANG_IMGUI_MEMORY
+#define LANG_IMGUI_MEMORY "Memory"
+#endif
 #ifndef LANG_IMGUI_CONFIGURATION
 #define LANG_IMGUI_CONFIGURATION "Configuration"
 #endif
@@ -355,6 +358,9 @@
 #ifndef LANG_EMULATOR_MBTN
 #define LANG_EMULATOR_MBTN "Release after multi-press"
 #endif
+#ifndef LANG_EMULATOR_BTN_KEYS
+#define LANG_EMULATOR_BTN_KEYS "Keyboard: Enter = SELECT, Arrow Up = UP, Arrow Down = DOWN"
+#endif
 #ifndef LANG_EMULATOR_MBTN_HELP
 #define LANG_EMULATOR_MBTN_HELP "Whenever you press-and-hold any butten(s) by activating their checkbox(es) and then click-and-release any button normally, all other held buttons will also be released."
 #endif
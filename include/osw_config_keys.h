@@ -41,10 +41,14 @@ extern OswConfigKeyString fallbackWifiSsid1st;
 extern OswConfigKeyPassword fallbackWifiPass1st;
 extern OswConfigKeyString fallbackWifiSsid2nd;
 extern OswConfigKeyPassword fallbackWifiPass2nd;
+extern OswConfigKeyPassword otaSigningKey;
 #endif
 #ifdef OSW_FEATURE_BLE_SERVER
 extern OswConfigKeyBool bleBootEnabled;
 #endif
+#ifdef OSW_SERVICE_COMMUNICATION
+extern OswConfigKeyString communicationServerUrl;
+#endif
 extern OswConfigKeyRGB themeBackgroundColor;
 extern OswConfigKeyRGB themeBackgroundDimmedColor;
 extern OswConfigKeyRGB themeForegroundColor;
@@ -1,6 +1,7 @@
 #ifndef OSW_HAL_H
 #define OSW_HAL_H
 
+#include <atomic>
 #include <memory>
 #include <list>
 #include <optional>
@@ -18,6 +19,9 @@
 #include OSW_TARGET_PLATFORM_HEADER
 #include "hal/osw_filesystem.h"
 #include "hal/buttons.h"
+#include "OswButtonQueue.h"
+#include <OswClock.h>
+#include <OswTimezone.h>
 #include <devices/interfaces/OswTimeProvider.h>
 #include "osw_config_keys.h"
 #include "osw_pins.h"
@@ -90,6 +94,10 @@ class OswHal {
     void stopDisplay(bool toLightSleep);
     void stopPower();
 
+    // Light sleep (the state of devices, services and display is kept, unlike with stop() and setup())
+    void suspend();
+    void resume();
+
     // Buttons (Engine-Style)
     void checkButtons();
     bool btnIsDown(Button btn);
@@ -101,6 +109,20 @@ class OswHal {
     bool btnIsTopAligned(Button btn);
     bool btnIsLeftAligned(Button btn);
     void getButtonCoordinates(Button btn, int16_t& x, int16_t& y);
+    // The debounced edges drained by the last checkButtons() call, in the order (and with the time) they happened
+    uint8_t btnEdgeCount();
+    const OswButtonQueue::Edge& btnEdge(uint8_t index);
+    void updateButtonTimings(); // Reloads the cached press times from the config
+    // The press times of the config in ms, as cached by updateButtonTimings()
+    unsigned short btnDoublePressTimeout() {
+        return this->_btnDoublePressTimeout;
+    };
+    unsigned short btnLongPressTime() {
+        return this->_btnLongPressTime;
+    };
+    unsigned short btnVeryLongPressTime() {
+        return this->_btnVeryLongPressTime;
+    };
 
     // DEPRECATED button methods, use OswAppV2::onButton instead
     bool btnIsDoubleClick(Button btn);
@@ -122,6 +144,8 @@ class OswHal {
     void disableDisplayBuffer();
     void enableDisplayBuffer();
     bool displayBufferEnabled();
+    void enableDisplayStripBuffer();
+    bool displayStripBufferEnabled();
     unsigned long screenOnTime();
     unsigned long screenOffTime();
 
@@ -184,6 +208,11 @@ class OswHal {
     void handleWakeupFromLightSleep();
     void noteUserInteraction();
     void handleDisplayTimout();
+    /**
+     * While held (e.g. by an update), the watch does not go to sleep - neither after the display timeout nor on request
+     */
+    void holdSleep();
+    void releaseSleep();
 
     // Power: WakeUpConfigs
     size_t addWakeUpConfig(const WakeUpConfig& config);
@@ -192,11 +221,16 @@ class OswHal {
     // General time stuff
     void updateTimeProvider();
     void updateTimezoneOffsets();
+    time_t getNextTimezoneTransition(); // UTC time at which updateTimezoneOffsets() must be called again
 
     // UTC Time
     void setUTCTime(const time_t& epoch);
     time_t getUTCTime();
+    int64_t getUTCMicros(); // With sub-second resolution, e.g. for sweeping hands
     void getUTCTime(OswTime& oswTime);
+    const OswClock& getClock() const {
+        return this->_clock;
+    };
 
     // Offset getters for primary / secondary time (cached!)
     time_t getTimezoneOffsetPrimary();
@@ -209,24 +243,30 @@ class OswHal {
 
     // For backward compatibility: Local time functions (= primary timezone)
     inline void getLocalTime(OswTime& oswTime) {
-        this->getTime(this->timezoneOffsetPrimary, oswTime);
+        time_t offset = this->getTimezoneOffsetPrimary();
+        this->getTime(offset, oswTime);
     }
     inline uint32_t getLocalTime() {
-        return this->getTime(this->timezoneOffsetPrimary);
+        time_t offset = this->getTimezoneOffsetPrimary();
+        return this->getTime(offset);
     }
     inline void getLocalDate(OswDate& oswDate) {
-        this->getDate(this->timezoneOffsetPrimary, oswDate);
+        time_t offset = this->getTimezoneOffsetPrimary();
+        this->getDate(offset, oswDate);
     };
 
     // For backward compatibility: Dual time functions (= secondary timezone)
     inline void getDualTime(OswTime& oswTime) {
-        this->getTime(this->timezoneOffsetSecondary, oswTime);
+        time_t offset = this->getTimezoneOffsetSecondary();
+        this->getTime(offset, oswTime);
     }
     inline uint32_t getDualTime() {
-        return this->getTime(this->timezoneOffsetSecondary);
+        time_t offset = this->getTimezoneOffsetSecondary();
+        return this->getTime(offset);
     }
     inline void getDualDate(OswDate& oswDate) {
-        this->getDate(this->timezoneOffsetPrimary, oswDate);
+        time_t offset = this->getTimezoneOffsetPrimary();
+        this->getDate(offset, oswDate);
     };
 
     const std::array<const char*, 7> getWeekDay = {
@@ -249,10 +289,21 @@ class OswHal {
     OswTimeProvider* timeProvider = nullptr;
     unsigned long _screenOnSince = 0;
     unsigned long _screenOffSince = 0;
+    uint32_t _displayListOverflows = 0;
+    bool _displayListOverflowed = false;
     unsigned long _lastUserInteraction = 0;
+    std::atomic<uint8_t> _sleepHolds = 0;
 
     // array of available buttons for iteration (e.g. handling)
-    bool _btnLastState[BTN_NUMBER];
+    std::array<OswButtonQueue::Edge, OswButtonQueue::capacity> _btnEdges;
+    uint8_t _btnEdgeCount = 0;
+#if OSW_PLATFORM_IS_FLOW3R_BADGE == 1
+    bool _btnPolled[BTN_NUMBER];
+#endif
+    unsigned short _btnDoublePressTimeout = 0;
+    unsigned short _btnLongPressTime = 0;
+    unsigned short _btnVeryLongPressTime = 0;
+    const unsigned long _btnDoubleClickTime = 500;
     bool _btnIsDown[BTN_NUMBER];
     bool _btnGoneUp[BTN_NUMBER];
     bool _btnSuppressUntilUpAgain[BTN_NUMBER];
@@ -268,7 +319,21 @@ class OswHal {
     bool _hasGPS = false;
     bool _debugGPS = false;
     bool _isLightSleep = false;
-
+    time_t _suspendedAtSystemTime = 0;
+    time_t _suspendedAtUTCTime = 0;
+    const time_t _resumeMaxClockDrift = 2; // Seconds the time provider may differ from the system clock after a light sleep
+
+    OswClock _clock;
+    std::atomic<int64_t> _clockSampledAt = 0;
+    const int64_t _clockSampleInterval = 1000000; // µs between two samples of the time provider (which may return its cached time)
+    void disciplineClock(int64_t now);
+
+    // updateTimezoneOffsets() runs on both cores (e.g. after the NTP sync on core 0), so the offsets below are only
+    // written and read under this lock
+    std::mutex _timezoneLock;
+    OswTimezone _timezonePrimary;
+    OswTimezone _timezoneSecondary;
+    time_t _nextTimezoneTransition = 0;
     time_t timezoneOffsetPrimary = 0;
     time_t timezoneOffsetSecondary = 0;
 
@@ -7,5 +7,25 @@ extern "C" {
 #include <lualib.h>
 };
 
+/**
+ * Opcodes of the batched drawing API (see data/lua/libs/drawBuffer.lua). A command buffer is a flat Lua
+ * array of an opcode followed by its arguments, replayed by osw.submitDrawCommands() in a single call.
+ */
+enum OswLuaDrawCommand {
+    DRAWCMD_FILL = 1,        // color
+    DRAWCMD_PIXEL,           // x, y, color
+    DRAWCMD_LINE,            // x1, y1, x2, y2, color
+    DRAWCMD_HLINE,           // x, y, w, color
+    DRAWCMD_VLINE,           // x, y, h, color
+    DRAWCMD_FRAME,           // x, y, w, h, color
+    DRAWCMD_FILL_FRAME,      // x, y, w, h, color
+    DRAWCMD_CIRCLE,          // x, y, r, color
+    DRAWCMD_FILL_CIRCLE,     // x, y, r, color
+    DRAWCMD_TEXT_COLOR,      // color, background
+    DRAWCMD_TEXT_SIZE,       // size
+    DRAWCMD_TEXT_CURSOR,     // x, y
+    DRAWCMD_PRINT            // string
+};
+
 void halToLua(lua_State* L);
 #endif
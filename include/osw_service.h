@@ -1,16 +1,71 @@
 #ifndef OSW_SERVICE_H
 #define OSW_SERVICE_H
+#include <atomic>
+
 #include <OswAppV1.h>
 
+/**
+ * Service tasks share one worker (see OswServiceManager), so their loop() must never block: anything which takes
+ * longer is split into steps (a small state machine), and between the steps the task tells the worker when it wants
+ * to run again - at a time (sleepFor() / sleepUntil()) or on an event (sleepUntilWoken() and wakeUp()). Tasks which
+ * do not say anything run on every round of the worker, as before.
+ */
 class OswServiceTask : public OswApp {
   public:
+    struct Stats {
+        unsigned long loops = 0;
+        unsigned long time = 0; // µs spent in loop()
+        unsigned long maxTime = 0; // µs of the longest loop()
+        unsigned long overruns = 0; // loop() took longer than getLoopBudget()
+    };
+
     OswServiceTask() : OswApp() {}
     virtual void setup() override;
     bool isRunning();
     virtual void stop() override;
+    /**
+     * Light sleep: loop() is not called until resume(), but the task keeps its state (unlike stop() / setup()).
+     * Tasks owning radios or other hardware should release it here and restore it on resume().
+     */
+    virtual void suspend();
+    virtual void resume();
     virtual ~OswServiceTask() {};
 
+    /**
+     * µs a single loop() may take before the worker complains about it - everything above delays all other tasks
+     */
+    virtual unsigned long getLoopBudget() const {
+        return 10000;
+    };
+    const Stats& getStats() const {
+        return this->stats;
+    };
+
+    /**
+     * Makes the next loop() happen right away (e.g. because new data for it arrived), also if it sleeps without a time
+     * limit. May be called from any task, but not from interrupts.
+     */
+    void wakeUp();
+    /**
+     * @return true if loop() should be called at now (millis())
+     */
+    bool isDue(unsigned long now) const;
+
+  protected:
+    /**
+     * Only meant to be called from loop(): the next loop() happens at (or after) the given time - or earlier on wakeUp()
+     */
+    void sleepFor(unsigned long ms);
+    void sleepUntil(unsigned long at);
+    void sleepUntilWoken();
+
   private:
+    friend class OswServiceManager;
     bool taskEnabled = false;
+    std::atomic<bool> sleeping = false;
+    std::atomic<bool> sleepingForever = false;
+    std::atomic<unsigned long> wakeAt = 0;
+    std::atomic<bool> woken = false;
+    Stats stats;
 };
 #endif
@@ -1,10 +1,12 @@
 #ifndef OSW_UI_H
 #define OSW_UI_H
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 
 #include <osw_hal.h>
+#include <OswNotificationStore.h>
 
 class OswAppV2;
 class OswUI {
@@ -32,43 +34,6 @@ class OswUI {
         time_t endTime = 0;
     };
 
-    class OswUINotification {
-      public:
-        OswUINotification(std::string message, bool isPersistent);
-
-        void draw(unsigned y) const;
-
-        size_t getId() const {
-            return id;
-        }
-
-        String getMessage() const {
-            return message;
-        }
-
-        unsigned char getMessageLines() const {
-            return lines;
-        }
-
-        unsigned long getEndTime() const {
-            return endTime;
-        }
-
-        unsigned char getDrawHeight() const;
-
-      private:
-        unsigned char countLines(const std::string& message) const;
-
-        const unsigned long notificationDurationPerLinePersistant = 300'000;
-        const unsigned long notificationDurationPerLine = 5'000;
-
-        static size_t count;
-        const size_t id{};
-        const String message{};
-        const unsigned char lines;
-        const unsigned long endTime{};
-    };
-
     bool mEnableTargetFPS = true;
 
     OswUI();
@@ -94,7 +59,7 @@ class OswUI {
     OswUIProgress* getProgressBar();
     void stopProgress();
 
-    size_t showNotification(std::string message, bool isPersistent);
+    size_t showNotification(std::string_view message, bool isPersistent);
     void hideNotification(size_t id);
 
     void resetTextFont();
@@ -108,20 +73,57 @@ class OswUI {
     unsigned int getLastBackgroundFlush() const {
         return this->lastBGFlush;
     };
+    /**
+     * Called (possibly from another core) once the display received the last chunk of a frame - with the async
+     * flush this happens after getLastFlush(), otherwise it is the same.
+     */
+    static void onFlushDone();
+    static unsigned int getLastFlushDone() {
+        return lastFlushDone;
+    };
+    /**
+     * Microseconds spent rendering frames (from clearing the buffer until the flush returned) since the boot - the
+     * difference between two calls divided by the time passed is the share of the CPU the UI needs.
+     */
+    unsigned long getRenderTime() const {
+        return this->renderTime;
+    };
+    /**
+     * Snapshot of the view flags and requested CPU clock of the shown app, taken by loop() - so other tasks can read
+     * them without racing against an app switch.
+     */
+    char getAppViewFlags() const {
+        return this->appViewFlags;
+    };
+    uint8_t getAppCpuFrequency() const {
+        return this->appCpuFrequency;
+    };
 
     std::unique_ptr<std::mutex> drawLock;
 
   private:
     static std::unique_ptr<OswUI> instance;
+    static std::atomic<unsigned int> lastFlushDone;
     unsigned long mTargetFPS = 30;
     String mProgressText;
     OswUIProgress* mProgressBar = nullptr;
     unsigned int lastFlush = 0;
     unsigned int lastBGFlush = 0;
+    std::atomic<unsigned long> renderTime = 0;
+    std::atomic<char> appViewFlags = 0;
+    std::atomic<uint8_t> appCpuFrequency = 0;
+    // Visible notifications - their fire time is the millis() at which they are hidden again
+    typedef OswNotificationStore<8, 1024, 16, 1000> NotificationStore;
+    const unsigned long notificationDurationPerLinePersistant = 300'000;
+    const unsigned long notificationDurationPerLine = 5'000;
     std::mutex mNotificationsLock;
-    std::list<OswUINotification> mNotifications;
+    NotificationStore mNotifications;
     bool mSelfNeedsRedraw = false;
     OswAppV2* mRootApplication = nullptr;
+
+    static unsigned char getNotificationLines(std::string_view message);
+    static unsigned char getNotificationDrawHeight(unsigned char lines);
+    void drawNotification(NotificationStore::Index index, unsigned y);
 };
 
 #endif
@@ -31,6 +31,7 @@
 
 //#define OSW_DEVICE_ESP32_WIFI_LOWPWR 0
 #define OSW_DEVICE_DS3231MZ_RTCINT 32
+//#define OSW_DEVICE_DS3231MZ_USE_SQW 0
 #define OSW_DEVICE_BMA400_INT1 34
 #define OSW_DEVICE_BMA400_INT2 35
 #define OSW_DEVICE_I2C_SCL 22
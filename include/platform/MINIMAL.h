@@ -31,6 +31,7 @@
 
 //#define OSW_DEVICE_ESP32_WIFI_LOWPWR 0
 //#define OSW_DEVICE_DS3231MZ_RTCINT 0
+//#define OSW_DEVICE_DS3231MZ_USE_SQW 0 // 1 Hz interrupt on the RTCINT pin, to lock the clock to the exact second edges
 //#define OSW_DEVICE_BMA400_INT1 0
 //#define OSW_DEVICE_BMA400_INT2 0
 //#define OSW_DEVICE_I2C_SCL 0
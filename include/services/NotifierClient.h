@@ -11,12 +11,12 @@ class NotifierClient {
     NotifierClient(std::string publisher);
 
     NotificationData createNotification(std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds> timeToFire,
-                                        std::string message = {}, std::array<bool, 7> daysOfWeek = {}, bool isPersistent = {});
+                                        std::string_view message = {}, std::array<bool, 7> daysOfWeek = {}, bool isPersistent = {});
 
     NotificationData createNotification(int hours, int minutes,
-                                        std::string message = {}, std::array<bool, 7> daysOfWeek = {}, bool isPersistent = {});
+                                        std::string_view message = {}, std::array<bool, 7> daysOfWeek = {}, bool isPersistent = {});
 
-    NotificationData showToast(std::string message);
+    NotificationData showToast(std::string_view message);
 
     std::vector<NotificationData> readNotifications();
 
@@ -1,9 +1,13 @@
 #ifndef OSW_SERVICE_MANAGER_H
 #define OSW_SERVICE_MANAGER_H
+#include <atomic>
+
 #include "osw_hal.h"
 #include "osw_service.h"
 
 #ifdef OSW_EMULATOR
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 #endif
 
@@ -33,10 +37,32 @@ class OswServiceManager {
     const unsigned workerStackSize = 2048 + _ADDITIONAL_STACK_SIZE_FOR_WIFI + _ADDITIONAL_STACK_SIZE_FOR_BLE; // base stack size is 2k
     const unsigned workerStartupDelay = 2000;
     const unsigned workerLoopDelay = 10;
+    const unsigned workerMaxSleep = 1000; // While all tasks sleep, the worker still checks on them at least this often (ms)
 
     void setup();
-    void loop();
+    /**
+     * Runs the loop() of every running task which is due (see OswServiceTask::isDue())
+     *
+     * @return ms until the next task is due (0 if one is due already)
+     */
+    unsigned long loop();
+    unsigned long loop(OswServiceTask* const tasks[], unsigned char count, unsigned long now);
     void stop();
+    /**
+     * Pauses the worker and suspends all tasks (light sleep) - resume() continues right away, without the startup delay
+     */
+    void suspend();
+    void resume();
+    /**
+     * Microseconds the worker spent inside the loop() of the tasks since the boot
+     */
+    unsigned long getBusyTime() const {
+        return this->busyTime;
+    };
+    /**
+     * Cuts the current pause of the worker short, see OswServiceTask::wakeUp()
+     */
+    void notify();
 
   protected:
     ~OswServiceManager() {
@@ -47,13 +73,23 @@ class OswServiceManager {
   private:
     static std::unique_ptr<OswServiceManager> instance;
 #ifndef OSW_EMULATOR
-    TaskHandle_t core0worker;
+    portMUX_TYPE workerLock = portMUX_INITIALIZER_UNLOCKED; // Guards the handle, which only exists while the task runs
+    TaskHandle_t core0worker = nullptr;
+    std::atomic<bool> workerRunning = false;
 #else
     std::unique_ptr<std::jthread> core0worker;
+    std::mutex notifyLock;
+    std::condition_variable notifyCondition;
+    bool notified = false;
 #endif
-    bool active = false;
+    std::atomic<bool> active = false;
+    std::atomic<unsigned long> busyTime = 0;
+    bool suspended = false;
 
     OswServiceManager() {};
-    void worker();
+    void startWorker(bool delayed);
+    void stopWorker();
+    void worker(bool delayed);
+    void wait(unsigned long ms);
 };
 #endif
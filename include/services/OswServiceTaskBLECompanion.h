@@ -6,19 +6,18 @@
 #include <BLEDevice.h>
 #include <osw_hal.h>
 #include <functional>
-#include <string>
 
 #include "osw_service.h"
+#include "OswCompanionMessage.h"
 
 #define NOTIFICATION_SERVICE_UID "30412632-6339-46e3-ad9e-bcfa9a766854"
 
 #define NOTIFICATION_BRDCST_CHAR "23dac1dc-ca00-47ed-a5fa-e3b9da959685"
 
-struct NotificationDetails {
-    unsigned int uid;
-    std::string app;
-    std::string contents;
-};
+/**
+ * The texts point into the receive buffer, so they are only valid during the notification callback.
+ */
+typedef OswCompanionMessage NotificationDetails;
 
 class OswServiceTaskBLECompanion : public OswServiceTask {
   public:
@@ -38,8 +37,10 @@ class OswServiceTaskBLECompanion : public OswServiceTask {
     BLECharacteristic* notificationChar = NULL;
 
     std::function<void(NotificationDetails)> notificationCallback;
+    OswCompanionReceiver receiver;
 
     friend class NotificationCallback;
+    friend class CompanionServerCallbacks;
 };
 
 #endif
@@ -1,17 +1,24 @@
 #pragma once
 #ifdef OSW_FEATURE_BLE_SERVER
+#include <atomic>
+#include <mutex>
+
 #include "osw_service.h"
 #include "services/NotifierClient.h"
+#include "OswBLELiveData.h"
+#include "OswBLEBulkTransfer.h"
 
 #define CONFIG_BT_NIMBLE_ROLE_PERIPHERAL
 #include <NimBLEDevice.h>
 
 class OswServiceTaskBLEServer : public OswServiceTask {
   public:
-    OswServiceTaskBLEServer() {};
+    OswServiceTaskBLEServer();
     virtual void setup() override;
     virtual void loop() override;
     virtual void stop() override;
+    virtual void suspend() override;
+    virtual void resume() override;
     ~OswServiceTaskBLEServer() {};
 
     void enable();
@@ -26,7 +33,9 @@ class OswServiceTaskBLEServer : public OswServiceTask {
 
       private:
         void onConnect(BLEServer* pServer);
+        void onConnect(BLEServer* pServer, ble_gap_conn_desc* desc);
         void onDisconnect(BLEServer* pServer);
+        void onDisconnect(BLEServer* pServer, ble_gap_conn_desc* desc);
         uint32_t onPassKeyRequest();
         bool onConfirmPIN(uint32_t pass_key) {
             return false; // we only report display-only
@@ -34,13 +43,44 @@ class OswServiceTaskBLEServer : public OswServiceTask {
 
         OswServiceTaskBLEServer* task;
     };
-    class BatteryLevelCharacteristicCallbacks: public NimBLECharacteristicCallbacks {
+    /**
+     * Serves (and notifies) one of the values sampled into liveData
+     */
+    class LiveDataCharacteristicCallbacks: public NimBLECharacteristicCallbacks {
+      public:
+        LiveDataCharacteristicCallbacks(OswServiceTaskBLEServer* task, OswBLELiveData::Channel channel): task(task), channel(channel) {};
+
+      private:
         void onRead(NimBLECharacteristic* pCharacteristic);
-        uint8_t byte = 0; // will be read from
+        void onSubscribe(NimBLECharacteristic* pCharacteristic, ble_gap_conn_desc* desc, uint16_t subValue);
+
+        OswServiceTaskBLEServer* task;
+        OswBLELiveData::Channel channel;
     };
-    class BatteryLevelStatusCharacteristicCallbacks: public NimBLECharacteristicCallbacks {
-        void onRead(NimBLECharacteristic* pCharacteristic);
-        uint8_t bytes[1+2+1]; // will be read from (1 flag, 2 power-state, 1 battery-level)
+    class BulkControlCharacteristicCallbacks: public NimBLECharacteristicCallbacks {
+      public:
+        BulkControlCharacteristicCallbacks(OswServiceTaskBLEServer* task): task(task) {};
+
+      private:
+        void onWrite(NimBLECharacteristic* pCharacteristic, ble_gap_conn_desc* desc);
+
+        OswServiceTaskBLEServer* task;
+    };
+    /**
+     * Sends the frames of the bulk transfer as notifications to the phone which requested it
+     */
+    class BulkTransport: public OswBLEBulkTransfer::Transport {
+      public:
+        BulkTransport(OswServiceTaskBLEServer* task): task(task) {};
+
+        size_t getMaxNotificationSize();
+        bool sendData(const uint8_t* data, size_t length);
+        void sendControl(const uint8_t* data, size_t length);
+
+      private:
+        OswServiceTaskBLEServer* task;
+
+        bool notify(NimBLECharacteristic* characteristic, const uint8_t* data, size_t length);
     };
     class CurrentTimeCharacteristicCallbacks: public NimBLECharacteristicCallbacks {
         void onRead(NimBLECharacteristic* pCharacteristic);
@@ -67,30 +107,26 @@ class OswServiceTaskBLEServer : public OswServiceTask {
 
         OswServiceTaskBLEServer* task;
     };
-    class StepsTodayCharacteristicCallbacks: public NimBLECharacteristicCallbacks {
-        void onRead(NimBLECharacteristic* pCharacteristic);
-        uint8_t bytes[4]; // this is a 4-byte array of a uint_32_t number
-    };
-    class StepsTotalWeekCharacteristicCallbacks: public NimBLECharacteristicCallbacks {
-        void onRead(NimBLECharacteristic* pCharacteristic);
-        uint8_t bytes[4]; // this is a 4-byte array of a uint_32_t number
-    };
-    class StepsTotalCharacteristicCallbacks: public NimBLECharacteristicCallbacks {
-        void onRead(NimBLECharacteristic* pCharacteristic);
-        uint8_t bytes[4]; // this is a 4-byte array of a uint_32_t number
-    };
-    class StepsAverageCharacteristicCallbacks: public NimBLECharacteristicCallbacks {
-        void onRead(NimBLECharacteristic* pCharacteristic);
-        uint8_t bytes[4]; // this is a 4-byte array of a uint_32_t number
-    };
     class StepsDayHistoryCharacteristicCallbacks: public NimBLECharacteristicCallbacks {
+      public:
+        StepsDayHistoryCharacteristicCallbacks(OswServiceTaskBLEServer* task): task(task) {};
+
+      private:
         void onRead(NimBLECharacteristic* pCharacteristic);
         uint8_t bytes[4 * 7]; // this is a 28-byte array of seven uint_32_t numbers
+        OswServiceTaskBLEServer* task;
     };
 
 
     /// apply the desired BLE state
     void updateBLEConfig();
+    /// sample the live values and notify the changed ones
+    void updateLiveData();
+    /// ask the connected phones for the connection parameters of the current workload
+    void updateConnectionParameters();
+    NimBLECharacteristic* getCharacteristic(OswBLELiveData::Channel channel);
+    /// send the next frames of the bulk transfer, true while one is running
+    bool updateBulkTransfer();
 
     // ↓ managed by NimBLE
     NimBLEServer* server = nullptr; // if set, this is considered as "enabled"
@@ -105,6 +141,9 @@ class OswServiceTaskBLEServer : public OswServiceTask {
     NimBLECharacteristic* characteristicSoftRev = nullptr;
     NimBLEService* serviceOsw = nullptr;
     NimBLECharacteristic* characteristicToast = nullptr;
+    NimBLECharacteristic* characteristicLiveStatus = nullptr;
+    NimBLECharacteristic* characteristicBulkControl = nullptr;
+    NimBLECharacteristic* characteristicBulkData = nullptr;
 #if OSW_PLATFORM_ENVIRONMENT_ACCELEROMETER == 1
     NimBLECharacteristic* characteristicStepCountTotal = nullptr;
     NimBLECharacteristic* characteristicStepCountTotalWeek = nullptr;
@@ -119,6 +158,17 @@ class OswServiceTaskBLEServer : public OswServiceTask {
     NotifierClient notify = NotifierClient("osw.ble.server");
     bool bootDone = false;
     bool enabled = false;
+    bool resumeEnabled = false;
     char name[8]; // BLE advertising only support up to 8 bytes
+    std::mutex liveDataLock; // the characteristics are read from the NimBLE host task
+    OswBLELiveData liveData;
+    unsigned long lastSample = 0;
+    std::atomic<bool> hasSample = false; // the first one is taken before the advertising starts
+    OswBLELiveData::Workload workload = OswBLELiveData::Workload::IDLE;
+    std::atomic<bool> connectionsChanged = false; // the new ones do not know the parameters of the workload yet
+    std::mutex bulkLock; // the control point is written from the NimBLE host task
+    BulkTransport bulkTransport = BulkTransport(this);
+    OswBLEBulkTransfer bulk = OswBLEBulkTransfer(bulkTransport);
+    uint16_t bulkConnection = 0; // of the phone which started the transfer
 };
 #endif
@@ -0,0 +1,120 @@
+#pragma once
+#ifdef OSW_SERVICE_COMMUNICATION
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#ifdef OSW_EMULATOR
+#include <thread>
+#endif
+
+#include <ArduinoJson.h>
+#include <OswCommunication.h>
+#include <WString.h>
+
+#include "osw_service.h"
+
+/**
+ * The way for apps to send data to the server (see OswCommunication): messages are queued (also across the deep
+ * sleep) and sent as HTTP POSTs in batches - through the WiFi on the watch, which is only brought up for it if the
+ * queue is worth it, or to the configured (local) server in the emulator. Nothing of this blocks the caller: the
+ * batches are sent by a task of their own, so a slow server does not hold up the other services either.
+ */
+class OswServiceTaskCommunication : public OswServiceTask {
+  public:
+    typedef OswCommunication::MessageType MessageType;
+    typedef OswCommunication::Priority Priority;
+
+    static constexpr unsigned long sendTimeout = 5000; // ms for the server to answer
+
+    OswServiceTaskCommunication();
+    virtual void setup() override;
+    virtual void loop() override;
+    virtual void stop() override;
+    ~OswServiceTaskCommunication();
+
+    /**
+     * Overrides the configured server (an http:// URL, empty = only queue the messages)
+     */
+    void setServerUrl(const String& url);
+    void setDeviceId(const String& deviceId);
+    void setPolicy(const OswCommunication::Policy& policy);
+    /**
+     * Queues a SYSTEM_STATUS (uptime, battery) every interval ms, 0 = never - it is sent along with the others
+     */
+    void setHeartbeatInterval(unsigned long interval);
+
+    /**
+     * @param json a JSON value, sent as it is
+     * @return false if it was refused (too large or the queue is full of more important messages)
+     */
+    bool send(MessageType type, const String& json, Priority priority = Priority::NORMAL);
+    bool send(MessageType type, const JsonDocument& data, Priority priority = Priority::NORMAL);
+    bool sendSensorData(const JsonDocument& data) {
+        return this->send(MessageType::SENSOR_DATA, data);
+    };
+    bool sendSystemStatus(const JsonDocument& data) {
+        return this->send(MessageType::SYSTEM_STATUS, data);
+    };
+    bool sendCommand(const String& command, const JsonDocument& params);
+    /**
+     * Sends all queued messages as soon as possible
+     */
+    void processQueue();
+    size_t getQueueSize();
+    /**
+     * @return true if the last batch got through (false before the first one)
+     */
+    bool isServerReachable();
+    OswCommunication::Stats getStats();
+
+  private:
+    /**
+     * POSTs the batches: over the WiFi client on the watch, which is only enabled for it if nobody else uses the
+     * WiFi - in the emulator directly, with a simulated radio
+     */
+    class HttpTransport : public OswCommunication::Transport {
+      public:
+        void setUrl(const String& url);
+        void setDeviceId(const String& deviceId);
+        virtual const char* getName() const override {
+            return "HTTP";
+        };
+        virtual void bringUp() override;
+        virtual void bringDown() override;
+        virtual bool isUp() override;
+        virtual Result send(const uint8_t* data, size_t length, bool compressed) override;
+        bool hasUrl();
+
+      private:
+        std::mutex lock;
+        String url;
+        String deviceId;
+        bool owned = false; // We enabled the radio
+    };
+
+    HttpTransport http;
+    OswCommunication communication;
+    bool clockRestored = false;
+    unsigned long heartbeatInterval = 0;
+    unsigned long lastHeartbeat = 0;
+
+    // The sender drives the communication (and with it the blocking POSTs) off the service worker
+    std::mutex senderLock;
+    std::condition_variable senderWoken;
+    bool senderStopping = false;
+    bool senderKicked = false;
+#ifndef OSW_EMULATOR
+    TaskHandle_t sender = nullptr;
+    bool senderStopped = false;
+    const unsigned senderStackSize = 8192; // The HTTPClient is hungry
+#else
+    std::unique_ptr<std::jthread> sender;
+#endif
+
+    void startSender();
+    void stopSender();
+    void kickSender();
+    void work();
+};
+#endif
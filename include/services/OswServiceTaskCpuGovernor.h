@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+
+#include <OswAppV2.h>
+#include "osw_service.h"
+
+/**
+ * Picks the CPU clock from the load of the UI and the service worker, the radios and the shown app. A higher clock is
+ * chosen as soon as the load demands it, while a lower clock has to fit the load for a while before it is used - so
+ * a short pause (or a noisy load) does not make the clock oscillate.
+ */
+class OswServiceTaskCpuGovernor : public OswServiceTask {
+  public:
+    struct Sample {
+        float uiLoad = 0; // Share of the time the UI spent rendering, measured at the current clock
+        float serviceLoad = 0; // Share of the time the service worker was busy, measured at the current clock
+        bool radioActive = false; // WiFi or BLE are enabled
+        bool radioLowPower = false; // The WiFi needs the low power mode of this platform (which works only at 80 MHz)
+        char viewFlags = OswAppV2::ViewFlags::NONE; // Of the shown app
+        uint8_t appFrequency = 0; // Requested by the shown app, 0 if the governor may decide
+    };
+
+    static constexpr std::array<uint8_t, 3> frequencies = {80, 160, 240};
+    const uint8_t busyFrequency = 160; // Lower bound while a radio is active (its stack needs headroom) or the app has no FPS limit
+    const float upThreshold = 0.75f; // Clock up as soon as the load exceeds this...
+    const float downThreshold = 0.5f; // ...and down only if the load at the lower clock would stay below this...
+    const unsigned long downDelay = 3000; // ...for this many ms
+    const unsigned long sampleInterval = 500; // ms
+
+    OswServiceTaskCpuGovernor() {};
+    virtual void setup() override;
+    virtual void loop() override;
+    virtual void resume() override;
+    ~OswServiceTaskCpuGovernor() {};
+
+    /**
+     * Feeds one sample (taken at the time "now", in ms) into the governor and applies the clock it decided for
+     *
+     * @return The CPU clock in MHz
+     */
+    uint8_t update(const Sample& sample, unsigned long now);
+    uint8_t getFrequency() const {
+        return this->frequency;
+    };
+
+  private:
+    uint8_t frequency = 0; // 0 until the current clock was read
+    bool lowerPending = false;
+    unsigned long lowerSince = 0;
+    unsigned long lastSample = 0;
+    unsigned long lastRenderTime = 0;
+    unsigned long lastBusyTime = 0;
+
+    void resetSampling();
+    Sample measure(unsigned long now);
+    uint8_t fitting(float load, float threshold);
+};
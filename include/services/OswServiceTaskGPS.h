@@ -9,6 +9,8 @@ class OswServiceTaskGPS : public OswServiceTask {
     virtual void setup() override;
     virtual void loop() override;
     virtual void stop() override;
+    virtual void suspend() override;
+    virtual void resume() override;
     ~OswServiceTaskGPS() {};
 };
 
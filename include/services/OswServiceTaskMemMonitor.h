@@ -13,8 +13,21 @@ class OswServiceTaskMemMonitor : public OswServiceTask {
     ~OswServiceTaskMemMonitor() {};
 
   private:
+    struct HeapState {
+        uint32_t free = 0;
+        uint32_t largestBlock = 0;
+    };
+
     unsigned core0high;
     unsigned core1high;
     unsigned heapHigh;
+    static constexpr unsigned long heapSampleInterval = 1000; // ms
+    unsigned long lastHeapSample = 0;
     bool lowMemoryCondition = false;
+    // Around the last switch of the display buffer
+    HeapState beforeBufferSwitch;
+    HeapState afterBufferSwitch;
+
+    static HeapState getHeapState();
+    static void addHeapState(String& msg, const HeapState& state);
 };
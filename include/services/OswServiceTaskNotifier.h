@@ -2,29 +2,32 @@
 #define OSW_SERVICE_TASKNOTIFIER_H
 
 #include <algorithm>
-#include <map>
+#include <string_view>
 
 #include "../lib/date/date.h"
 #include "osw_service.h"
+#include "OswNotificationStore.h"
 #include "osw_ui.h"
 
+/**
+ * A notification as handed out by the OswServiceTaskNotifier. The texts are views into the storage of the notifier,
+ * so they are only valid until the notifier is modified the next time - copy them if you need them for longer!
+ */
 class Notification {
   public:
-    Notification(std::string publisher, std::string message = {}, std::array<bool, 7> daysOfWeek = {}, bool isPersistent = {})
-        : publisher{std::move(publisher)}, message{std::move(message)}, daysOfWeek{std::move(daysOfWeek)}, isPersistent{isPersistent} {
-        id = count;
-        ++count;
+    Notification(unsigned id, std::string_view publisher, std::string_view message = {}, std::array<bool, 7> daysOfWeek = {}, bool isPersistent = {})
+        : id{id}, publisher{publisher}, message{message}, daysOfWeek{std::move(daysOfWeek)}, isPersistent{isPersistent} {
     }
 
     unsigned getId() const {
         return id;
     }
 
-    std::string getMessage() const {
+    std::string_view getMessage() const {
         return message;
     }
 
-    std::string getPublisher() const {
+    std::string_view getPublisher() const {
         return publisher;
     }
 
@@ -37,10 +40,9 @@ class Notification {
     }
 
   private:
-    unsigned id{};
-    static unsigned count;
-    const std::string publisher{};
-    const std::string message{};
+    const unsigned id{};
+    const std::string_view publisher{};
+    const std::string_view message{};
     const std::array<bool, 7> daysOfWeek{};
     const bool isPersistent{};
 };
@@ -49,6 +51,9 @@ typedef std::pair<std::chrono::time_point<std::chrono::system_clock, std::chrono
 
 class OswServiceTaskNotifier : public OswServiceTask {
   public:
+    static constexpr uint16_t capacity = 32;
+    static constexpr uint16_t textArenaSize = 2048;
+
     OswServiceTaskNotifier() {};
     virtual void setup() override;
     virtual void loop() override;
@@ -58,19 +63,24 @@ class OswServiceTaskNotifier : public OswServiceTask {
   private:
     friend class NotifierClient;
 
-    NotificationData createNotification(std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds> timeToFire, std::string publisher,
-                                        std::string message = {}, std::array<bool, 7> daysOfWeek = {}, bool isPersistent = {});
+    // Fire times are in (local) seconds, a wheel revolution covers a bit more than one minute
+    typedef OswNotificationStore<capacity, textArenaSize, 64, 1> Store;
+
+    NotificationData createNotification(std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds> timeToFire, std::string_view publisher,
+                                        std::string_view message = {}, std::array<bool, 7> daysOfWeek = {}, bool isPersistent = {});
+
+    NotificationData createNotification(int hours, int minutes, std::string_view publisher,
+                                        std::string_view message = {}, std::array<bool, 7> daysOfWeek = {}, bool isPersistent = {});
 
-    NotificationData createNotification(int hours, int minutes, std::string publisher,
-                                        std::string message = {}, std::array<bool, 7> daysOfWeek = {}, bool isPersistent = {});
+    std::vector<NotificationData> readNotifications(std::string_view publisher);
 
-    std::vector<NotificationData> readNotifications(std::string publisher);
+    void deleteNotification(unsigned id, std::string_view publisher);
 
-    void deleteNotification(unsigned id, std::string publisher);
+    NotificationData toNotificationData(Store::Index index) const;
 
-    std::multimap<NotificationData::first_type, const NotificationData::second_type> scheduler{};
+    Store store{};
 
-    std::mutex mutlimapMutex{};
+    std::mutex storeMutex{};
 
     // For testing purposes (to access and test private members)
     friend class TestOswServiceTaskNotifier;
@@ -0,0 +1,58 @@
+#ifdef OSW_FEATURE_WIFI
+#ifdef RAW_SCREEN_SERVER
+#ifndef OSW_SERVICE_TASKSCREENSTREAM_H
+#define OSW_SERVICE_TASKSCREENSTREAM_H
+
+#include <memory>
+#include <WiFiServer.h>
+#include <WiFiClient.h>
+
+#include "osw_service.h"
+
+/**
+ * @brief Streams the display content to one connected TCP client.
+ *
+ * Every frame is snapshotted chunk by chunk (memcpy under the draw lock), then only the rows which changed since
+ * the last sent frame are transmitted as RLE-compressed RGB565. See scripts/screen_capture/streamScreen.py for the
+ * host-side decoder and the exact wire format.
+ */
+class OswServiceTaskScreenStream : public OswServiceTask {
+  public:
+    const uint16_t port = 8266;
+    const unsigned long minFrameInterval = 100; // Do not send more than 10 frames per second
+    const unsigned long keyFrameInterval = 10000; // Resends all rows, in case a row hash collided
+
+    OswServiceTaskScreenStream() {};
+    virtual void setup() override;
+    virtual void loop() override;
+    virtual void stop() override;
+    virtual void suspend() override; /// The loop() enables it again, once the wifi is connected
+    ~OswServiceTaskScreenStream() {};
+
+    bool hasClient();
+
+  private:
+    WiFiServer* m_server = nullptr;
+    WiFiClient m_client;
+    unsigned int m_lastFrameFlush = 0;
+    unsigned long m_lastFrameSent = 0;
+    unsigned long m_lastKeyFrame = 0;
+    uint32_t m_frameId = 0;
+    bool m_keyFrame = true;
+
+    std::unique_ptr<uint32_t[]> m_rowHashes; // One hash per display row of the last sent frame
+    std::unique_ptr<uint16_t[]> m_chunkSnapshot; // Copy of one display chunk
+    std::unique_ptr<uint8_t[]> m_outBuffer; // Encoded rows of one chunk
+    size_t m_outBufferSize = 0;
+
+    void enableServer();
+    void disableServer();
+    void acceptClient();
+    void dropClient();
+    bool sendFrame();
+    size_t encodeRow(uint8_t* out, uint16_t y, uint16_t xOffset, const uint16_t* pixels, uint16_t width);
+};
+
+#endif
+#endif
+#endif
@@ -4,14 +4,17 @@
 
 #include <functional>
 
+#include <OswOta.h>
+
 #include "Uri.h"
 #include "osw_service.h"
 
 class WebServer;
+class HTTPClient;
 
 class OswServiceTaskWebserver : public OswServiceTask {
   public:
-    const unsigned int apiVersion = 1;
+    const unsigned int apiVersion = 2;
 
     OswServiceTaskWebserver() {};
     ~OswServiceTaskWebserver() {};
@@ -19,6 +22,10 @@ class OswServiceTaskWebserver : public OswServiceTask {
     virtual void setup() override;
     virtual void loop() override;
     virtual void stop() override;
+    virtual void suspend() override; /// The loop() enables it again, once the wifi is connected
+    virtual unsigned long getLoopBudget() const override {
+        return 50000; // Sending an asset takes a while (and a slice of the OTA download, if the flash is slower)
+    };
 
     void enableWebserver();
     void disableWebserver();
@@ -47,12 +54,32 @@ class OswServiceTaskWebserver : public OswServiceTask {
     WebServer* m_webserver = nullptr;
     String m_uiPassword;
     bool m_restartRequest = false;
+    unsigned long m_restartAt = 0;
+
+    // The OTA streams the firmware through the OswOta into the flash - the active one downloads it in slices from the
+    // loop(), so the other tasks keep running meanwhile
+    const unsigned long otaSliceTime = 20; // ms per loop()
+    const unsigned long otaStallTimeout = 10000; // ms without any data
+    const unsigned long otaProgressInterval = 250; // ms between updates of the progress bar
+    OswOtaFlashSink m_otaSink;
+    OswOta* m_ota = nullptr;
+    HTTPClient* m_otaClient = nullptr; // Only for the active OTA
+    bool m_otaUploading = false; // The passive OTA is running
+    String m_otaError;
+    size_t m_otaLastReceived = 0;
+    unsigned long m_otaLastData = 0;
+    unsigned long m_otaLastProgress = 0;
 
     void handleAuthenticated(std::function<void(void)> handler);
     void handleUnauthenticated(std::function<void(void)> handler);
 
     void handlePassiveOTARequest();
     void handleActiveOTARequest();
+    void continueActiveOTA();
+    void handleOTAStatusJson();
+    bool beginOTA(size_t size, const String& md5);
+    void updateOTAProgress();
+    void endOTA(const String& error);
     void handleInfoJson();
     void handleOTAFile();
     void handleCategoriesJson();
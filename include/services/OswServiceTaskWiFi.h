@@ -2,7 +2,10 @@
 #ifndef OSW_SERVICE_TASKWIFI_H
 #define OSW_SERVICE_TASKWIFI_H
 
+#include <atomic>
+
 #include "osw_service.h"
+#include "OswWiFiConnector.h"
 
 #if defined(ESP8266)
 #include <ESP8266HTTPClient.h>
@@ -18,10 +21,12 @@ class WiFiClass;
 
 class OswServiceTaskWiFi : public OswServiceTask {
   public:
-    OswServiceTaskWiFi() {};
+    OswServiceTaskWiFi();
     virtual void setup() override;
     virtual void loop() override; /// Calls enableWiFi();
     virtual void stop() override; /// Calls disableWiFi();
+    virtual void suspend() override; /// Disables the radio, but remembers if it was enabled / connecting
+    virtual void resume() override;
 
     //General netowrking stuff
     void setHostname();
@@ -37,6 +42,10 @@ class OswServiceTaskWiFi : public OswServiceTask {
     void queueTimeUpdateViaNTP();
     int32_t getSignalStrength();
     uint8_t getSignalQuality();
+    /**
+     * How long the phases of the last connection took
+     */
+    const OswWiFiConnector::Profile& getConnectionProfile() const;
 
     //WiFi (client)
     bool isWiFiEnabled();
@@ -56,28 +65,52 @@ class OswServiceTaskWiFi : public OswServiceTask {
     ~OswServiceTaskWiFi() {};
 
   private:
+    /**
+     * The connector's view of the ESP32 WiFi
+     */
+    class Radio : public OswWiFiConnector::Radio {
+      public:
+        void setup();
+        virtual void begin(const OswWiFiConnector::Network& network, uint8_t channel, const uint8_t* bssid) override;
+        virtual void disconnect() override;
+        virtual Status getStatus() override;
+        virtual bool getAccessPoint(std::array<uint8_t, 6>& bssid, uint8_t& channel) override;
+        virtual void startScan() override;
+        virtual bool getScanResults(std::vector<OswWiFiConnector::ScanResult>& results) override;
+
+      private:
+        bool m_eventsRegistered = false;
+        std::atomic<bool> m_connecting = false;
+        std::atomic<bool> m_associated = false; // Set by the WiFi events
+        std::atomic<bool> m_gotIP = false;
+        std::atomic<Status> m_failure = Status::IDLE;
+    };
+
     bool m_bootDone = false; // This triggers the async setup inside the loop
+    bool m_bootDelayed = false; // The loop already waited before enabling the wifi on boot
     bool m_enableWiFi = false;
     bool m_enableClient = false;
     bool m_enableStation = false;
     bool m_enabledMDNS = false;
     time_t m_enabledStationByAutoAP = 0;
     const time_t m_enabledStationByAutoAPTimeout = 10 * 60; // Maximum allowed time for the auto ap to stay active - after that it ALWAYS WILL TRY to reconnect
+    const unsigned long m_retryDelay = 10000; // ms between two rounds over all networks, also while the station is active
     bool m_queuedNTPUpdate = false; //Will be set to true it this feature is active
     String m_hostname;
-    String m_clientSSID;
-    String m_clientPass;
     String m_stationPass;
-    time_t m_connectTimeout = 0;
-    uint8_t m_connectFailureCount = 0;
+    Radio m_radio;
+    OswWiFiConnector m_connector;
+    unsigned long m_retryAt = 0; // 0 = no retry pending
+    uint8_t m_connectFailureCount = 0; // Rounds over all networks without any success
+    bool m_resumeWiFi = false;
+    bool m_resumeClient = false;
 #if OSW_DEVICE_ESP32_WIFI_LOWPWR == 1
     bool m_lowPowerMode = false;
-    uint8_t m_lowPwrPrevFreq;
     wifi_power_t m_lowPwrPrevWifiPwr;
 #endif
 
     void updateWiFiConfig();
-    void selectCredentials();
+    void loopClient();
 };
 
 #endif
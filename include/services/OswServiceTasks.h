@@ -3,15 +3,22 @@
 #if SERVICE_BLE_COMPANION == 1
 class OswServiceTaskBLECompanion;
 #endif
+class OswServiceTaskCpuGovernor;
 class OswServiceTaskExample;
 class OswServiceTaskMemMonitor;
 class OswServiceTaskNotifier;
 #ifdef OSW_FEATURE_BLE_SERVER
 class OswServiceTaskBLEServer;
 #endif
+#ifdef OSW_SERVICE_COMMUNICATION
+class OswServiceTaskCommunication;
+#endif
 #ifdef OSW_FEATURE_WIFI
 class OswServiceTaskWiFi;
 class OswServiceTaskWebserver;
+#ifdef RAW_SCREEN_SERVER
+class OswServiceTaskScreenStream;
+#endif
 #endif
 namespace OswServiceAllTasks {
 #if SERVICE_BLE_COMPANION == 1
@@ -21,6 +28,9 @@ extern OswServiceTaskBLECompanion bleCompanion;
 #ifdef OSW_FEATURE_WIFI
 extern OswServiceTaskWiFi wifi;
 extern OswServiceTaskWebserver webserver;
+#ifdef RAW_SCREEN_SERVER
+extern OswServiceTaskScreenStream screenStream;
+#endif
 #endif
 #if OSW_SERVICE_NOTIFIER == 1
 extern OswServiceTaskNotifier notifier;
@@ -28,6 +38,10 @@ extern OswServiceTaskNotifier notifier;
 #ifdef OSW_FEATURE_BLE_SERVER
 extern OswServiceTaskBLEServer bleServer;
 #endif
+#ifdef OSW_SERVICE_COMMUNICATION
+extern OswServiceTaskCommunication communication;
+#endif
+extern OswServiceTaskCpuGovernor cpuGovernor;
 extern OswServiceTaskMemMonitor memory;
 }
 
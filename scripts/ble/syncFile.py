@@ -0,0 +1,119 @@
+#! /usr/bin/env python3
+
+# Client for the bulk transfer of the OswServiceTaskBLEServer (see include/OswBLEBulkTransfer.h for the protocol).
+# Fetches a file of the watch (e.g. the sensor trace) into a local file - and continues where it left off, if the
+# local file already exists (use --restart to fetch it all again).
+#
+# Needs bleak (pip install bleak) and a watch which is paired with this machine, as the control point is encrypted.
+
+import sys
+import time
+import struct
+import asyncio
+import argparse
+import binascii
+
+try:
+    from bleak import BleakClient, BleakScanner
+except ImportError:
+    print("This needs bleak: pip install bleak")
+    sys.exit(1)
+
+CONTROL_UUID = "e1a87f53-1c6d-4b7a-9f3e-5d2c8b4a6f01"
+DATA_UUID = "e1a87f54-1c6d-4b7a-9f3e-5d2c8b4a6f01"
+
+OPEN, ACK, REWIND, ABORT = 0x01, 0x02, 0x03, 0x04
+OPENED, DONE = 0x81, 0x82
+STATUS = ["OK", "NOT_FOUND", "BAD_OFFSET", "BAD_REQUEST", "IO_ERROR", "TIMEOUT", "ABORTED"]
+
+def statusName(status):
+    return STATUS[status] if status < len(STATUS) else str(status)
+
+class BulkTransfer:
+    def __init__(self, client, output, window):
+        self.client = client
+        self.output = output
+        self.window = window
+        self.events = asyncio.Queue()
+        self.expected = 0 # Next frame
+        self.unacked = 0
+        self.rewound = False
+        self.received = 0 # Bytes of this transfer
+        self.remaining = 0
+        self.retransmissions = 0
+
+    async def command(self, opcode, seq):
+        await self.client.write_gatt_char(CONTROL_UUID, struct.pack("<BH", opcode, seq & 0xFFFF), response=True)
+
+    async def handleFrame(self, frame):
+        seq = struct.unpack("<H", frame[:2])[0]
+        valid = len(frame) > 4 and struct.unpack("<H", frame[-2:])[0] == binascii.crc_hqx(frame[:-2], 0xFFFF)
+        if seq != self.expected & 0xFFFF or not valid:
+            # Lost (or broken) - ask for it again, but only once until it arrives
+            if not self.rewound:
+                await self.command(REWIND, self.expected)
+                self.rewound = True
+                self.retransmissions += 1
+            return
+        self.rewound = False
+        payload = frame[2:-2]
+        self.output.write(payload)
+        self.received += len(payload)
+        self.expected += 1
+        self.unacked += 1
+        if self.unacked >= max(self.window // 2, 1) or self.received >= self.remaining:
+            await self.command(ACK, self.expected - 1)
+            self.unacked = 0
+
+    async def run(self, name, offset):
+        await self.client.start_notify(CONTROL_UUID, lambda sender, data: self.events.put_nowait(("control", bytes(data))))
+        await self.client.start_notify(DATA_UUID, lambda sender, data: self.events.put_nowait(("data", bytes(data))))
+        request = struct.pack("<BIB", OPEN, offset, self.window) + name.encode()
+        await self.client.write_gatt_char(CONTROL_UUID, request, response=True)
+
+        started = time.time()
+        lastReport = started
+        while True:
+            kind, data = await asyncio.wait_for(self.events.get(), timeout=10)
+            if kind == "data":
+                await self.handleFrame(data)
+            elif data[0] == OPENED:
+                status, size, offset, payload = struct.unpack("<BIIH", data[1:12])
+                if status != 0:
+                    raise RuntimeError(f"The watch refused the transfer: {statusName(status)}")
+                self.remaining = size - offset
+                print(f"{name}: {size} bytes, {self.remaining} to go from offset {offset} ({payload} bytes per frame)")
+            elif data[0] == DONE:
+                if data[1] != 0:
+                    raise RuntimeError(f"The transfer failed: {statusName(data[1])} - run again to resume it")
+                break
+            if time.time() - lastReport >= 1:
+                print(f"{self.received}/{self.remaining} bytes, {self.received / (time.time() - started) / 1000:.1f} kB/s")
+                lastReport = time.time()
+        duration = max(time.time() - started, 0.001)
+        print(f"Done: {self.received} bytes in {duration:.1f} s ({self.received / duration / 1000:.1f} kB/s), {self.retransmissions} rewinds")
+
+async def main(args):
+    device = await BleakScanner.find_device_by_address(args.device, timeout=10) if ":" in args.device else \
+             await BleakScanner.find_device_by_name(args.device, timeout=10)
+    if device is None:
+        raise RuntimeError(f"Watch {args.device} not found")
+    mode = "wb" if args.restart else "ab"
+    with open(args.output or args.file.replace("/", "_"), mode) as output:
+        offset = output.tell()
+        async with BleakClient(device) as client:
+            print(f"Connected to {device.name} (MTU {client.mtu_size})")
+            await BulkTransfer(client, output, args.window).run(args.file, offset)
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Fetch a file of the watch over BLE (resumes partial downloads)")
+    parser.add_argument("device", help="name or address of the watch")
+    parser.add_argument("--file", default="sensors.trace", help="name of the file on the watch")
+    parser.add_argument("--output", help="local file (default: the name of the file on the watch)")
+    parser.add_argument("--window", type=int, default=8, help="frames in flight (1 - 32)")
+    parser.add_argument("--restart", action="store_true", help="fetch the whole file again, instead of resuming")
+    args = parser.parse_args()
+    try:
+        asyncio.run(main(args))
+    except KeyboardInterrupt:
+        pass
@@ -0,0 +1,109 @@
+#! /usr/bin/env python3
+
+# A stand-in for the server of the OswServiceTaskCommunication (see include/OswCommunication.h for the format), e.g.
+# for the emulator, which sends to http://localhost:8080/messages by default. It accepts the batches (plain or gzip),
+# checks them and prints what came in - and can play a flaky server (--fail, --delay) to see the queue cope with it.
+#
+# Only needs the standard library.
+
+import sys
+import gzip
+import json
+import time
+import random
+import argparse
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+TYPES = ["SENSOR_DATA", "SYSTEM_STATUS", "COMMAND", "RESPONSE", "ERROR"]
+PRIORITIES = ["BACKGROUND", "NORMAL", "IMPORTANT", "URGENT"]
+
+class Totals:
+    def __init__(self):
+        self.started = time.time()
+        self.batches = 0
+        self.failed = 0
+        self.messages = 0
+        self.duplicates = 0
+        self.wireBytes = 0
+        self.rawBytes = 0
+        self.seen = set()
+
+    def summary(self):
+        ratio = self.wireBytes / self.rawBytes if self.rawBytes else 1
+        return "{} batches ({} failed on purpose), {} messages ({} again), {} bytes sent for {} ({:.0%})".format(
+            self.batches, self.failed, self.messages, self.duplicates, self.wireBytes, self.rawBytes, ratio)
+
+class Handler(BaseHTTPRequestHandler):
+    def log_message(self, format, *args):
+        pass # We print our own
+
+    def answer(self, status, text=""):
+        body = text.encode()
+        self.send_response(status)
+        self.send_header("Content-Type", "text/plain")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def do_POST(self):
+        args = self.server.args
+        totals = self.server.totals
+        if self.path != args.path:
+            return self.answer(404, "unknown path")
+        body = self.rfile.read(int(self.headers.get("Content-Length", 0)))
+        if args.delay:
+            time.sleep(args.delay / 1000)
+        if random.random() < args.fail:
+            totals.failed += 1
+            return self.answer(503, "try again later")
+
+        wireBytes = len(body)
+        if self.headers.get("Content-Encoding") == "gzip":
+            try:
+                body = gzip.decompress(body)
+            except OSError as e:
+                print("Broken gzip: {}".format(e))
+                return self.answer(400, "broken gzip")
+        try:
+            batch = json.loads(body)
+            messages = batch["messages"]
+        except (ValueError, KeyError) as e:
+            print("Broken batch: {}".format(e))
+            return self.answer(400, "broken batch")
+
+        totals.batches += 1
+        totals.wireBytes += wireBytes
+        totals.rawBytes += len(body)
+        for message in messages:
+            key = (batch.get("device_id"), message["message_id"])
+            if key in totals.seen:
+                totals.duplicates += 1 # The answer to an earlier try got lost
+            totals.seen.add(key)
+            totals.messages += 1
+            if args.verbose:
+                print("  {} {} {}: {}".format(message["message_id"], TYPES[message["type"]], PRIORITIES[message["priority"]], json.dumps(message["data"])))
+        print("{} ({}): {} messages, {} of {} bytes - {}".format(batch.get("device_id"), self.headers.get("Device-ID"),
+              len(messages), wireBytes, len(body), totals.summary()))
+        self.answer(200, "ok")
+
+def main():
+    parser = argparse.ArgumentParser(description="Stand-in server for the communication of the watch")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--path", default="/messages")
+    parser.add_argument("--fail", type=float, default=0, help="Share of the requests to answer with 503 (0 - 1)")
+    parser.add_argument("--delay", type=int, default=0, help="ms to wait before answering")
+    parser.add_argument("--verbose", action="store_true", help="Print every message")
+    args = parser.parse_args()
+
+    server = ThreadingHTTPServer(("", args.port), Handler)
+    server.args = args
+    server.totals = Totals()
+    print("Waiting for batches on http://localhost:{}{}".format(args.port, args.path))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        print(server.totals.summary())
+        sys.exit(0)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,30 @@
+#! /usr/bin/env python3
+
+# Creates the manifest of a firmware image for the OTA of the watch (see include/OswOta.h for its format): the size, the
+# SHA-256 and - with the signing key set on the watch ("Update signing key") - the signature of both. The watch refuses
+# images which do not match it. Send it as the "x-UpdateManifest" header along with the update, e.g.
+#
+#   curl -u admin:<password> -H "x-UpdateManifest: $(scripts/ota/signManifest.py firmware.bin --key <key>)" \
+#        -F "file=@firmware.bin" http://<watch>/api/ota/passive
+#
+# Only needs the standard library.
+
+import hmac
+import hashlib
+import argparse
+
+def main():
+    parser = argparse.ArgumentParser(description="Creates the (signed) manifest of a firmware image for the OTA")
+    parser.add_argument("image", help="The firmware, e.g. .pio/build/<env>/firmware.bin")
+    parser.add_argument("--key", default="", help="The signing key of the watch (leave out for an unsigned manifest)")
+    args = parser.parse_args()
+
+    with open(args.image, "rb") as file:
+        image = file.read()
+    manifest = "{};{}".format(len(image), hashlib.sha256(image).hexdigest())
+    if args.key:
+        manifest += ";" + hmac.new(args.key.encode(), manifest.encode(), hashlib.sha256).hexdigest()
+    print(manifest)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,109 @@
+#! /usr/bin/env python3
+
+# Decoder for the screen stream of the OswServiceTaskScreenStream (enabled by the RAW_SCREEN_SERVER flag).
+#
+# Wire format (all integers little-endian):
+#   frame := "OSWF" u32:frameId u16:width u16:height u8:flags(bit0 = key frame) row* u16:0xFFFF
+#   row   := u16:y u16:x u16:width token*
+#   token := u8 with high bit set -> one u16 pixel, repeated ((token & 0x7F) + 1) times
+#            u8 without high bit -> (token + 1) literal u16 pixels
+# Rows not sent are unchanged since the previous frame. Pixels are RGB565.
+
+import time
+import socket
+import struct
+import argparse
+
+try:
+    from PIL import Image
+except ImportError:
+    Image = None
+
+def rgb565ToRgb888(pixel):
+    return (((pixel >> 11) & 0x1F) << 3, ((pixel >> 5) & 0x3F) << 2, (pixel & 0x1F) << 3)
+
+class ScreenStream:
+    def __init__(self, host, port):
+        self.sock = socket.create_connection((host, port), timeout=10)
+        self.width = 0
+        self.height = 0
+        self.pixels = bytearray()
+
+    def readExact(self, size):
+        data = bytearray()
+        while len(data) < size:
+            chunk = self.sock.recv(size - len(data))
+            if not chunk:
+                raise ConnectionError("Stream closed by the watch")
+            data += chunk
+        return bytes(data)
+
+    def readU16(self):
+        return struct.unpack("<H", self.readExact(2))[0]
+
+    def requestKeyFrame(self):
+        self.sock.sendall(b"K")
+
+    def readFrame(self):
+        magic = self.readExact(4)
+        if magic != b"OSWF":
+            raise ValueError(f"Lost frame sync (got {magic!r}), reconnect to resync")
+        frameId, width, height, flags = struct.unpack("<IHHB", self.readExact(9))
+        if (width, height) != (self.width, self.height):
+            self.width, self.height = width, height
+            self.pixels = bytearray(width * height * 3)
+        changedRows = 0
+        while True:
+            y = self.readU16()
+            if y == 0xFFFF:
+                break
+            x, rowWidth = struct.unpack("<HH", self.readExact(4))
+            offset = (y * self.width + x) * 3
+            decoded = 0
+            while decoded < rowWidth:
+                token = self.readExact(1)[0]
+                if token & 0x80:
+                    count = (token & 0x7F) + 1
+                    rgb = bytes(rgb565ToRgb888(self.readU16())) * count
+                else:
+                    count = token + 1
+                    raw = struct.unpack(f"<{count}H", self.readExact(count * 2))
+                    rgb = b"".join(bytes(rgb565ToRgb888(p)) for p in raw)
+                self.pixels[offset + decoded * 3:offset + (decoded + count) * 3] = rgb
+                decoded += count
+            changedRows += 1
+        return frameId, bool(flags & 1), changedRows
+
+    def save(self, path):
+        if Image is not None:
+            Image.frombytes("RGB", (self.width, self.height), bytes(self.pixels)).save(path)
+        else:
+            # No pillow available - fall back to a plain PPM
+            with open(path, "wb") as file:
+                file.write(f"P6 {self.width} {self.height} 255\n".encode())
+                file.write(self.pixels)
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Receive the live screen stream of a watch (RAW_SCREEN_SERVER)")
+    parser.add_argument("ip", help="IP of the watch")
+    parser.add_argument("--port", type=int, default=8266)
+    parser.add_argument("--output", default="stream.png", help="file to write the latest frame to (PPM if pillow is missing)")
+    parser.add_argument("--frames", type=int, default=0, help="stop after this many frames (0 = run until interrupted)")
+    args = parser.parse_args()
+
+    stream = ScreenStream(args.ip, args.port)
+    received = 0
+    statsStart = time.time()
+    statsFrames = 0
+    try:
+        while args.frames == 0 or received < args.frames:
+            frameId, keyFrame, changedRows = stream.readFrame()
+            stream.save(args.output)
+            received += 1
+            statsFrames += 1
+            if time.time() - statsStart >= 1:
+                print(f"frame {frameId}: {statsFrames / (time.time() - statsStart):.1f} FPS, {changedRows} rows changed{' (key frame)' if keyFrame else ''}")
+                statsStart = time.time()
+                statsFrames = 0
+    except KeyboardInterrupt:
+        pass
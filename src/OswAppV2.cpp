@@ -1,6 +1,5 @@
 #include <osw_hal.h>
 #include <osw_ui.h>
-#include <osw_config_keys.h>
 
 #include <OswAppV2.h>
 #include "assets/img/icons/app.png.h"
@@ -24,6 +23,10 @@ const OswAppV2::ViewFlags& OswAppV2::getViewFlags() {
     return this->viewFlags;
 }
 
+uint8_t OswAppV2::getCpuFrequency() {
+    return this->cpuFrequency;
+}
+
 bool OswAppV2::getNeedsRedraw() {
     return this->needsRedraw;
 }
@@ -51,61 +54,91 @@ void OswAppV2::clearKnownButtonStates() {
 void OswAppV2::onLoop() {
     const unsigned long now = millis();
     const unsigned short minPressTime = 10;
-    const unsigned short doublePressTimeout = OswConfigAllKeys::oswAppV2ButtonDoublePress.get();
-    const unsigned short longPressTime = OswConfigAllKeys::oswAppV2ButtonLongPress.get();
-    const unsigned short veryLongPressTime = OswConfigAllKeys::oswAppV2ButtonVeryLongPress.get();
-
-    const unsigned long indicatorMinTime = minPressTime + (longPressTime * 0.2f);
-    for(char i = 0; i < BTN_NUMBER; i++) {
-        if(hal->btnIsDownSince((Button) i) > 0) {
-            if(buttonDownSince[i] == 0) {
-                // Oh, the button just went down!
-                buttonDownSince[i] = now;
-                buttonLastSentState[i] = ButtonStateNames::UNDEFINED;
-                if(this->knownButtonStates[i] & buttonLastSentState[i])
-                    this->onButton((Button) i, false, buttonLastSentState[i]); // we can't decide the short/long press, as it just happend
+    // Cached by the HAL (and reloaded on config changes), as reading the config on every loop is expensive
+    const unsigned short doublePressTimeout = hal->btnDoublePressTimeout();
+    const unsigned short longPressTime = hal->btnLongPressTime();
+    const unsigned short veryLongPressTime = hal->btnVeryLongPressTime();
+
+    // Oh, the button just went down!
+    auto down = [&](char i, unsigned long time) {
+        buttonDownSince[i] = time;
+        buttonLastSentState[i] = ButtonStateNames::UNDEFINED;
+        if(this->knownButtonStates[i] & buttonLastSentState[i])
+            this->onButton((Button) i, false, buttonLastSentState[i]); // we can't decide the short/long press, as it just happend
+    };
+    // Send state updates, while the button is down
+    auto held = [&](char i, unsigned long time) {
+        ButtonStateNames maybeNewState = ButtonStateNames::UNDEFINED;
+        if(time - buttonDownSince[i] >= minPressTime and time - buttonDownSince[i] < longPressTime) {
+            maybeNewState = ButtonStateNames::SHORT_PRESS;
+        } else if(time - buttonDownSince[i] >= longPressTime && time - buttonDownSince[i] < veryLongPressTime) {
+            maybeNewState = ButtonStateNames::LONG_PRESS;
+        } else if(time - buttonDownSince[i] >= veryLongPressTime) {
+            maybeNewState = ButtonStateNames::VERY_LONG_PRESS;
+        }
+        if(maybeNewState != buttonLastSentState[i]) {
+            buttonLastSentState[i] = maybeNewState;
+            if(this->knownButtonStates[i] & buttonLastSentState[i])
+                this->onButton((Button) i, false, buttonLastSentState[i]);
+        }
+    };
+    // Oh, the button just went up!
+    auto up = [&](char i, unsigned long time) {
+        if(this->knownButtonStates[i] & ButtonStateNames::DOUBLE_PRESS and buttonLastSentState[i] == ButtonStateNames::SHORT_PRESS) {
+            if(buttonDoubleShortTimeout[i] > 0 and time - buttonDoubleShortTimeout[i] < doublePressTimeout) {
+                buttonLastSentState[i] = ButtonStateNames::DOUBLE_PRESS;
+                buttonDoubleShortTimeout[i] = 0;
             } else {
-                // Send state updates, while the button is down
-                ButtonStateNames maybeNewState = ButtonStateNames::UNDEFINED;
-                if(now - buttonDownSince[i] >= minPressTime and now - buttonDownSince[i] < longPressTime) {
-                    maybeNewState = ButtonStateNames::SHORT_PRESS;
-                } else if(now - buttonDownSince[i] >= longPressTime && now - buttonDownSince[i] < veryLongPressTime) {
-                    maybeNewState = ButtonStateNames::LONG_PRESS;
-                } else if(now - buttonDownSince[i] >= veryLongPressTime) {
-                    maybeNewState = ButtonStateNames::VERY_LONG_PRESS;
-                }
-                if(maybeNewState != buttonLastSentState[i]) {
-                    buttonLastSentState[i] = maybeNewState;
-                    if(this->knownButtonStates[i] & buttonLastSentState[i])
-                        this->onButton((Button) i, false, buttonLastSentState[i]);
-                }
+                // Do not send the short press event, as it may be a double press
+                buttonLastSentState[i] = ButtonStateNames::UNDEFINED;
+                buttonDoubleShortTimeout[i] = time;
             }
+        } else
+            buttonDoubleShortTimeout[i] = 0; // Reset the double press timeout on any other button state
+        // Special case handling: If the user pressed very long, but the app does not support very long presses, send out the long press event
+        if(this->knownButtonStates[i] & ButtonStateNames::LONG_PRESS and !(this->knownButtonStates[i] & ButtonStateNames::VERY_LONG_PRESS) and buttonLastSentState[i] == ButtonStateNames::VERY_LONG_PRESS)
+            buttonLastSentState[i] = ButtonStateNames::LONG_PRESS;
+        if(buttonLastSentState[i] != ButtonStateNames::UNDEFINED and this->knownButtonStates[i] & buttonLastSentState[i])
+            this->onButton((Button) i, true, buttonLastSentState[i]);
+        buttonDownSince[i] = 0;
+        buttonLastSentState[i] = ButtonStateNames::UNDEFINED;
+    };
+    // If the button is not down, check if the double press timeout is over
+    auto expire = [&](char i, unsigned long time) {
+        if(this->knownButtonStates[i] & ButtonStateNames::SHORT_PRESS and buttonDoubleShortTimeout[i] > 0 and time - buttonDoubleShortTimeout[i] >= doublePressTimeout) {
+            buttonDoubleShortTimeout[i] = 0; // Reset the double press timeout (if it is set and send out the short press event as no double press happend in time)
+            this->onButton((Button) i, true, ButtonStateNames::SHORT_PRESS);
+        }
+    };
+
+    // Replay all edges since the last loop at the time they happened, so the press durations do not depend on the frame time
+    for(uint8_t e = 0; e < hal->btnEdgeCount(); e++) {
+        const OswButtonQueue::Edge& edge = hal->btnEdge(e);
+        const char i = edge.button;
+        if(buttonDownSince[i] == 0)
+            expire(i, edge.timestamp);
+        if(edge.down) {
+            if(buttonDownSince[i] == 0)
+                down(i, edge.timestamp);
         } else if(buttonDownSince[i] > 0) {
-            // Oh, the button just went up!
-            if(this->knownButtonStates[i] & ButtonStateNames::DOUBLE_PRESS and buttonLastSentState[i] == ButtonStateNames::SHORT_PRESS) {
-                if(buttonDoubleShortTimeout[i] > 0 and now - buttonDoubleShortTimeout[i] < doublePressTimeout) {
-                    buttonLastSentState[i] = ButtonStateNames::DOUBLE_PRESS;
-                    buttonDoubleShortTimeout[i] = 0;
-                } else {
-                    // Do not send the short press event, as it may be a double press
-                    buttonLastSentState[i] = ButtonStateNames::UNDEFINED;
-                    buttonDoubleShortTimeout[i] = now;
-                }
-            } else
-                buttonDoubleShortTimeout[i] = 0; // Reset the double press timeout on any other button state
-            // Special case handling: If the user pressed very long, but the app does not support very long presses, send out the long press event
-            if(this->knownButtonStates[i] & ButtonStateNames::LONG_PRESS and !(this->knownButtonStates[i] & ButtonStateNames::VERY_LONG_PRESS) and buttonLastSentState[i] == ButtonStateNames::VERY_LONG_PRESS)
-                buttonLastSentState[i] = ButtonStateNames::LONG_PRESS;
-            if(buttonLastSentState[i] != ButtonStateNames::UNDEFINED and this->knownButtonStates[i] & buttonLastSentState[i])
-                this->onButton((Button) i, true, buttonLastSentState[i]);
-            buttonDownSince[i] = 0;
-            buttonLastSentState[i] = ButtonStateNames::UNDEFINED;
+            held(i, edge.timestamp);
+            up(i, edge.timestamp);
         }
-        if(hal->btnIsDownSince((Button) i) == 0 and this->knownButtonStates[i] & ButtonStateNames::SHORT_PRESS) // If the button is not down, check if the double press timeout is over
-            if(buttonDoubleShortTimeout[i] > 0 and now - buttonDoubleShortTimeout[i] >= doublePressTimeout) {
-                buttonDoubleShortTimeout[i] = 0; // Reset the double press timeout (if it is set and send out the short press event as no double press happend in time)
-                this->onButton((Button) i, true, ButtonStateNames::SHORT_PRESS);
-            }
+    }
+
+    const unsigned long indicatorMinTime = minPressTime + (longPressTime * 0.2f);
+    for(char i = 0; i < BTN_NUMBER; i++) {
+        // Follow the current state, in case it changed without an edge (app started during a press, press suppressed)
+        if(buttonDownSince[i] == 0 and hal->btnIsDownSince((Button) i) > 0)
+            down(i, hal->btnIsDownSince((Button) i));
+        else if(buttonDownSince[i] > 0 and hal->btnIsDownSince((Button) i) == 0) {
+            held(i, now);
+            up(i, now);
+        }
+        if(buttonDownSince[i] > 0)
+            held(i, now);
+        else
+            expire(i, now);
 
         // Now update the indicator-levels for the buttons
         if(hal->btnIsDownFor((Button) i) > indicatorMinTime) {
@@ -0,0 +1,214 @@
+#include <OswBLEBulkTransfer.h>
+
+#include <algorithm>
+
+#include <OswLogger.h>
+
+static uint16_t readUInt16(const uint8_t* data) {
+    return (uint16_t) (data[0] | (data[1] << 8));
+}
+
+static uint32_t readUInt32(const uint8_t* data) {
+    return (uint32_t) data[0] | ((uint32_t) data[1] << 8) | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24);
+}
+
+static void writeUInt16(uint16_t value, uint8_t* out) {
+    out[0] = (uint8_t) value;
+    out[1] = (uint8_t) (value >> 8);
+}
+
+static void writeUInt32(uint32_t value, uint8_t* out) {
+    out[0] = (uint8_t) value;
+    out[1] = (uint8_t) (value >> 8);
+    out[2] = (uint8_t) (value >> 16);
+    out[3] = (uint8_t) (value >> 24);
+}
+
+OswBLEBulkTransfer::~OswBLEBulkTransfer() {
+    this->cancel();
+}
+
+uint16_t OswBLEBulkTransfer::crc16(const uint8_t* data, size_t length, uint16_t crc) {
+    for(size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t) data[i] << 8;
+        for(uint8_t bit = 0; bit < 8; bit++)
+            crc = crc & 0x8000 ? (uint16_t) ((crc << 1) ^ 0x1021) : (uint16_t) (crc << 1);
+    }
+    return crc;
+}
+
+void OswBLEBulkTransfer::addFile(const std::string& name, const std::string& path) {
+    this->files.emplace_back(name, path);
+}
+
+void OswBLEBulkTransfer::cancel() {
+    if(this->file != nullptr)
+        fclose(this->file);
+    this->file = nullptr;
+}
+
+OswBLEBulkTransfer::Stats OswBLEBulkTransfer::getStats(unsigned long now) const {
+    Stats stats = this->stats;
+    if(this->isActive())
+        stats.duration = now - this->startedAt;
+    return stats;
+}
+
+void OswBLEBulkTransfer::sendOpened(Status status) {
+    uint8_t reply[12];
+    reply[0] = (uint8_t) Opcode::OPENED;
+    reply[1] = (uint8_t) status;
+    writeUInt32(this->size, reply + 2);
+    writeUInt32(this->offset, reply + 6);
+    writeUInt16(this->payload, reply + 10);
+    this->transport.sendControl(reply, sizeof(reply));
+}
+
+void OswBLEBulkTransfer::finish(Status status, unsigned long now) {
+    this->cancel();
+    this->stats.status = status;
+    this->stats.duration = now - this->startedAt;
+    const uint8_t reply[2] = {(uint8_t) Opcode::DONE, (uint8_t) status};
+    this->transport.sendControl(reply, sizeof(reply));
+    OSW_LOG_D("Bulk transfer done (", (int) status, "): ", this->stats.bytes, " bytes in ", this->stats.duration, " ms, ",
+              this->stats.retransmissions, " frames sent again");
+}
+
+void OswBLEBulkTransfer::open(const uint8_t* data, size_t length, unsigned long now) {
+    this->cancel();
+    this->size = 0;
+    this->offset = 0;
+    this->payload = 0;
+    this->stats = Stats();
+    this->startedAt = now;
+    if(length < 6) {
+        this->stats.status = Status::BAD_REQUEST;
+        this->sendOpened(Status::BAD_REQUEST);
+        return;
+    }
+    const uint32_t offset = readUInt32(data + 1);
+    const uint8_t window = data[5];
+    const std::string name((const char*) data + 6, length - 6);
+    auto entry = std::find_if(this->files.begin(), this->files.end(), [&name](const std::pair<std::string, std::string>& file) {
+        return file.first == name;
+    });
+    const size_t notification = std::min(this->transport.getMaxNotificationSize(), maxFrameSize);
+    Status status = Status::OK;
+    if(window == 0 or notification <= frameOverhead)
+        status = Status::BAD_REQUEST;
+    else if(entry == this->files.end() or (this->file = fopen(entry->second.c_str(), "rb")) == nullptr)
+        status = Status::NOT_FOUND;
+    else if(fseek(this->file, 0, SEEK_END) != 0 or ftell(this->file) < 0)
+        status = Status::IO_ERROR;
+    else {
+        this->size = (uint32_t) ftell(this->file);
+        if(offset > this->size)
+            status = Status::BAD_OFFSET;
+    }
+    if(status != Status::OK) {
+        this->cancel();
+        this->stats.status = status;
+        this->sendOpened(status);
+        return;
+    }
+
+    this->offset = offset;
+    this->payload = (uint16_t) (notification - frameOverhead);
+    this->window = std::min(window, maxWindow);
+    this->frameCount = (this->size - offset + this->payload - 1) / this->payload;
+    this->acked = 0;
+    this->next = 0;
+    this->sentMax = 0;
+    this->position = -1;
+    this->progressAt = now;
+    this->retries = 0;
+    this->stats.size = this->size;
+    this->stats.offset = offset;
+    this->sendOpened(Status::OK);
+    if(this->frameCount == 0)
+        this->finish(Status::OK, now); // Nothing left to send
+}
+
+bool OswBLEBulkTransfer::resolve(uint16_t seq, uint32_t& number) const {
+    const uint32_t distance = (uint16_t) (seq - (uint16_t) this->acked);
+    if(distance > this->sentMax - this->acked)
+        return false;
+    number = this->acked + distance;
+    return true;
+}
+
+void OswBLEBulkTransfer::onControl(const uint8_t* data, size_t length, unsigned long now) {
+    if(length == 0)
+        return;
+    switch((Opcode) data[0]) {
+    case Opcode::OPEN:
+        this->open(data, length, now);
+        break;
+    case Opcode::ACK:
+    case Opcode::REWIND: {
+        uint32_t number;
+        if(!this->isActive() or length < 3 or !this->resolve(readUInt16(data + 1), number))
+            break; // Late, duplicated or bogus - the timeout sorts it out
+        if((Opcode) data[0] == Opcode::ACK) {
+            if(number == this->sentMax)
+                break; // Acknowledges a frame which was not sent yet
+            number += 1;
+        } else if(number < this->next) {
+            this->next = number; // Go back N
+            this->progressAt = now;
+        }
+        if(number > this->acked) {
+            this->stats.bytes = std::min(number * this->payload, this->size - this->offset);
+            this->acked = number;
+            this->next = std::max(this->next, number);
+            this->progressAt = now;
+            this->retries = 0;
+        }
+        if(this->acked == this->frameCount)
+            this->finish(Status::OK, now);
+        break;
+    }
+    case Opcode::ABORT:
+        if(this->isActive())
+            this->finish(Status::ABORTED, now);
+        break;
+    default:
+        break;
+    }
+}
+
+void OswBLEBulkTransfer::loop(unsigned long now) {
+    if(!this->isActive())
+        return;
+    if(this->acked < this->sentMax and now - this->progressAt >= ackTimeout) {
+        if(++this->retries > maxRetries) {
+            this->finish(Status::TIMEOUT, now);
+            return;
+        }
+        this->next = this->acked;
+        this->progressAt = now;
+    }
+    while(this->next < this->frameCount and this->next < this->acked + this->window) {
+        const long position = (long) this->offset + (long) this->next * this->payload;
+        if(this->position != position and fseek(this->file, position, SEEK_SET) != 0) {
+            this->finish(Status::IO_ERROR, now);
+            return;
+        }
+        const size_t wanted = std::min<size_t>(this->payload, this->size - position);
+        const size_t read = fread(this->frame + 2, 1, wanted, this->file);
+        this->position = position + (long) read;
+        if(read != wanted) {
+            this->finish(Status::IO_ERROR, now); // E.g. truncated since the OPEN
+            return;
+        }
+        writeUInt16((uint16_t) this->next, this->frame);
+        writeUInt16(crc16(this->frame, 2 + read), this->frame + 2 + read);
+        if(!this->transport.sendData(this->frame, read + frameOverhead))
+            break;
+        ++this->stats.frames;
+        if(this->next < this->sentMax)
+            ++this->stats.retransmissions;
+        ++this->next;
+        this->sentMax = std::max(this->sentMax, this->next);
+    }
+}
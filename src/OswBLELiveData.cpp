@@ -0,0 +1,125 @@
+#include <OswBLELiveData.h>
+
+#include <algorithm>
+#include <cstring>
+
+void OswBLELiveData::set(Channel channel, const uint8_t* data, size_t length) {
+    Slot& slot = this->slots[(size_t) channel];
+    std::copy(data, data + length, slot.value.begin());
+    slot.length = (uint8_t) length;
+    slot.pending = slot.length != slot.sentLength or !std::equal(data, data + length, slot.sent.begin());
+}
+
+void OswBLELiveData::update(const Values& values) {
+    uint8_t buffer[maxPayload];
+    this->set(Channel::BATTERY_LEVEL, buffer, encodeBatteryLevel(values, buffer));
+    this->set(Channel::BATTERY_LEVEL_STATUS, buffer, encodeBatteryLevelStatus(values, buffer));
+    if(values.hasSteps) {
+        this->set(Channel::STEPS_TODAY, buffer, encodeUInt32(values.stepsToday, buffer));
+        this->set(Channel::STEPS_TOTAL_WEEK, buffer, encodeUInt32(values.stepsTotalWeek, buffer));
+        this->set(Channel::STEPS_TOTAL, buffer, encodeUInt32(values.stepsTotal, buffer));
+        this->set(Channel::STEPS_AVERAGE, buffer, encodeUInt32(values.stepsAverage, buffer));
+    }
+    this->set(Channel::LIVE_STATUS, buffer, encodeLiveStatus(values, buffer));
+}
+
+/**
+ * A new subscriber gets the current value right away (if there is one)
+ */
+void OswBLELiveData::setSubscribed(Channel channel, bool subscribed) {
+    Slot& slot = this->slots[(size_t) channel];
+    if(subscribed and !slot.subscribed) {
+        slot.pending = slot.length > 0;
+        slot.hasSent = false;
+    }
+    slot.subscribed = subscribed;
+}
+
+size_t OswBLELiveData::get(Channel channel, uint8_t* out) const {
+    const Slot& slot = this->slots[(size_t) channel];
+    std::copy(slot.value.begin(), slot.value.begin() + slot.length, out);
+    return slot.length;
+}
+
+void OswBLELiveData::noteSyncActivity(unsigned long now) {
+    this->hasSync = true;
+    this->lastSync = now;
+}
+
+OswBLELiveData::Workload OswBLELiveData::getWorkload(unsigned long now) const {
+    if(this->hasSync and now - this->lastSync < syncHold)
+        return Workload::SYNC;
+    for(const Slot& slot : this->slots)
+        if(slot.subscribed)
+            return Workload::LIVE;
+    return Workload::IDLE;
+}
+
+/**
+ * The phone has the final say on these, they are only the preferred ranges
+ */
+OswBLELiveData::ConnectionParameters OswBLELiveData::getConnectionParameters(Workload workload) {
+    switch(workload) {
+    case Workload::SYNC:
+        return {6, 12, 0, 400}; // 7.5 - 15 ms, every event, 4 s supervision timeout
+    case Workload::LIVE:
+        return {40, 80, 2, 600}; // 50 - 100 ms, may skip two events, 6 s
+    default:
+        return {320, 640, 2, 600}; // 400 - 800 ms, may skip two events, 6 s (must exceed twice the effective interval)
+    }
+}
+
+size_t OswBLELiveData::encodeUInt32(uint32_t value, uint8_t* out) {
+    out[0] = (uint8_t) value;
+    out[1] = (uint8_t) (value >> 8);
+    out[2] = (uint8_t) (value >> 16);
+    out[3] = (uint8_t) (value >> 24);
+    return 4;
+}
+
+size_t OswBLELiveData::encodeBatteryLevel(const Values& values, uint8_t* out) {
+    out[0] = values.charging ? 0xFF : values.batteryPercent; // Invalid while charging
+    return 1;
+}
+
+size_t OswBLELiveData::encodeBatteryLevelStatus(const Values& values, uint8_t* out) {
+    // see https://www.bluetooth.com/specifications/specs/gatt-specification-supplement-8-2/
+    // flags
+    if(values.charging) {
+        out[0] = 0b00000000; // No additional information
+    } else {
+        out[0] = 0b00000010; // Battery Level Present
+    }
+    // power-state
+    out[1] = 0b00000001; // Battery Present: Yes
+    out[2] = 0b00000000;
+    if(values.charging) {
+        out[1] |= 0b00000010; // Wired External Power Source Connected: Yes
+        out[1] |= 0b00100000; // Battery Charge State: Charging
+        return 3; // The battery-level is not sent while charging
+    }
+    out[1] |= 0b01000000; // Battery Charge State: Discharging: Active
+    if(values.batteryPercent > 50) {
+        out[1] |= 0b10000000; // Battery Charge Level: Good
+    } else if(values.batteryPercent > 25) {
+        // Battery Charge Level: Low
+        out[2] |= 0b00000001;
+    } else {
+        // Battery Charge Level: Critical
+        out[1] |= 0b10000000;
+        out[2] |= 0b00000001;
+    }
+    // battery-level
+    out[3] = values.batteryPercent;
+    return 4;
+}
+
+size_t OswBLELiveData::encodeLiveStatus(const Values& values, uint8_t* out) {
+    out[0] = liveStatusVersion;
+    out[1] = (values.charging ? 0b01 : 0) | (values.hasSteps ? 0b10 : 0);
+    out[2] = values.batteryPercent;
+    encodeUInt32(values.stepsToday, out + 3);
+    encodeUInt32(values.stepsTotalWeek, out + 7);
+    encodeUInt32(values.stepsTotal, out + 11);
+    return liveStatusSize;
+}
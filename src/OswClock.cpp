@@ -0,0 +1,149 @@
+#include <OswClock.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+#ifndef OSW_EMULATOR
+#include <esp_timer.h>
+#else
+#include <Arduino.h>
+#endif
+
+OswClock::OswClock() {
+    for(BrokenDownTime& entry : this->cache)
+        breakDown(0, entry);
+}
+
+int64_t OswClock::getMonotonicMicros() {
+#ifndef OSW_EMULATOR
+    return esp_timer_get_time();
+#else
+    return (int64_t) micros(); // Follows the FakeClock
+#endif
+}
+
+void OswClock::breakDown(time_t time, BrokenDownTime& result) {
+    // Days to civil date, see https://howardhinnant.github.io/date_algorithms.html#civil_from_days
+    int64_t days = time / 86400;
+    int64_t seconds = time % 86400;
+    if(seconds < 0) {
+        seconds += 86400;
+        --days;
+    }
+    const int64_t z = days + 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const int64_t dayOfEra = z - era * 146097;
+    const int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const int64_t monthIndex = (5 * dayOfYear + 2) / 153; // March = 0
+    const int64_t month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+
+    result.time = time;
+    result.year = (uint16_t) (yearOfEra + era * 400 + (month <= 2 ? 1 : 0));
+    result.month = (uint8_t) month;
+    result.day = (uint8_t) (dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+    result.weekDay = (uint8_t) (((days + 4) % 7 + 7) % 7); // 1970-01-01 was a Thursday
+    result.hour = (uint8_t) (seconds / 3600);
+    result.minute = (uint8_t) (seconds / 60 % 60);
+    result.second = (uint8_t) (seconds % 60);
+}
+
+bool OswClock::discipline(const Sample& sample) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    const int64_t sampleLow = (int64_t) sample.utc * 1000000;
+    const int64_t sampleHigh = sampleLow + (sample.atSecondEdge ? edgeTolerance : 999999);
+    if(this->synchronized) {
+        const int64_t elapsed = sample.at - this->anchor;
+        if(elapsed < 0)
+            return false; // Older than what we know already (e.g. the provider cached it)
+        const int64_t advanced = elapsed + (int64_t) (elapsed * (double) this->drift / 1000000);
+        const int64_t growth = elapsed * driftTolerance / 1000000 + 1;
+        const int64_t low = std::max(this->low + advanced - growth, sampleLow);
+        const int64_t high = std::min(this->high + advanced + growth, sampleHigh);
+        if(low <= high) {
+            this->anchor = sample.at;
+            this->low = low;
+            this->high = high;
+            this->updateDrift(sample.at, low + (high - low) / 2);
+            return false;
+        }
+    }
+    this->synchronized = true;
+    this->anchor = sample.at;
+    this->low = sampleLow;
+    this->high = sampleHigh;
+    this->hasDriftReference = false;
+    this->lastReturned = INT64_MIN;
+    ++this->steps;
+    this->updateDrift(sample.at, sampleLow + (sampleHigh - sampleLow) / 2);
+    return true;
+}
+
+void OswClock::updateDrift(int64_t at, int64_t utc) {
+    if(this->high - this->low > driftMaxUncertainty)
+        return;
+    if(this->hasDriftReference) {
+        const int64_t elapsed = at - this->driftReferenceAt;
+        if(elapsed < driftWindow)
+            return;
+        const float measured = (float) ((double) ((utc - this->driftReferenceUtc) - elapsed) * 1000000 / elapsed);
+        this->drift = this->hasDrift ? this->drift + (measured - this->drift) * driftSmoothing : measured;
+        this->drift = std::clamp(this->drift, -driftMax, driftMax);
+        this->hasDrift = true;
+    }
+    this->hasDriftReference = true;
+    this->driftReferenceAt = at;
+    this->driftReferenceUtc = utc;
+}
+
+void OswClock::reset() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->synchronized = false;
+    this->hasDriftReference = false;
+    this->lastReturned = INT64_MIN;
+}
+
+bool OswClock::isSynchronized() const {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->synchronized;
+}
+
+int64_t OswClock::getUTCMicros(int64_t now) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    const int64_t elapsed = now - this->anchor;
+    const int64_t utc = this->low + (this->high - this->low) / 2 + elapsed + (int64_t) (elapsed * (double) this->drift / 1000000);
+    // Small corrections of the phase may move the estimate back a bit - rather stand still for that long
+    this->lastReturned = std::max(this->lastReturned, utc);
+    return this->lastReturned;
+}
+
+time_t OswClock::getUTCTime(int64_t now) {
+    const int64_t utc = this->getUTCMicros(now);
+    return (time_t) (utc >= 0 ? utc / 1000000 : (utc - 999999) / 1000000);
+}
+
+OswClock::BrokenDownTime OswClock::getBrokenDown(time_t time) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    for(const BrokenDownTime& entry : this->cache)
+        if(entry.time == time)
+            return entry;
+    BrokenDownTime& entry = this->cache[this->nextCacheSlot];
+    this->nextCacheSlot = (this->nextCacheSlot + 1) % this->cache.size();
+    breakDown(time, entry);
+    return entry;
+}
+
+int64_t OswClock::getUncertainty() const {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->high - this->low;
+}
+
+float OswClock::getDrift() const {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->drift;
+}
+
+uint32_t OswClock::getSteps() const {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->steps;
+}
@@ -0,0 +1,416 @@
+#include <OswCommunication.h>
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdio>
+
+#include <OswLogger.h>
+
+static constexpr uint32_t storageMagic = 0x4F435131; // "OCQ1"
+
+static uint16_t readUInt16(const uint8_t* data) {
+    return (uint16_t) (data[0] | (data[1] << 8));
+}
+
+static uint32_t readUInt32(const uint8_t* data) {
+    return (uint32_t) data[0] | ((uint32_t) data[1] << 8) | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24);
+}
+
+static void writeUInt16(uint16_t value, uint8_t* out) {
+    out[0] = (uint8_t) value;
+    out[1] = (uint8_t) (value >> 8);
+}
+
+static void writeUInt32(uint32_t value, uint8_t* out) {
+    out[0] = (uint8_t) value;
+    out[1] = (uint8_t) (value >> 8);
+    out[2] = (uint8_t) (value >> 16);
+    out[3] = (uint8_t) (value >> 24);
+}
+
+/**
+ * The fields of a record at its offset in the Storage
+ */
+struct Record {
+    uint8_t type;
+    uint8_t priority;
+    uint16_t length;
+    uint32_t id;
+    uint32_t queuedAt;
+    uint32_t timestamp;
+    const uint8_t* payload;
+
+    Record(const uint8_t* data) {
+        this->type = data[0];
+        this->priority = data[1];
+        this->length = readUInt16(data + 2);
+        this->id = readUInt32(data + 4);
+        this->queuedAt = readUInt32(data + 8);
+        this->timestamp = readUInt32(data + 12);
+        this->payload = data + OswCommunication::recordHeaderSize;
+    };
+    size_t size() const {
+        return OswCommunication::recordHeaderSize + this->length;
+    };
+};
+
+OswCommunication::OswCommunication(Storage& storage) : storage(storage) {
+    // No logging here, this may well run before the logger exists
+    if(this->storage.magic != storageMagic or !this->isConsistent())
+        this->clear();
+    this->batchIds.reserve(storageSize / recordHeaderSize);
+}
+
+void OswCommunication::clear() {
+    this->storage.magic = storageMagic;
+    this->storage.used = 0;
+    this->storage.count = 0;
+}
+
+bool OswCommunication::isConsistent() const {
+    if(this->storage.used > storageSize)
+        return false;
+    size_t count = 0;
+    for(size_t offset = 0; offset < this->storage.used; ++count) {
+        if(this->storage.used - offset < recordHeaderSize)
+            return false;
+        const Record record(this->storage.data.data() + offset);
+        if(record.priority >= priorityCount or record.type > (uint8_t) MessageType::ERROR or record.length > maxPayloadSize)
+            return false;
+        offset += record.size();
+        if(offset > this->storage.used)
+            return false;
+    }
+    return count == this->storage.count;
+}
+
+void OswCommunication::addTransport(Transport& transport) {
+    this->transports.push_back(&transport);
+}
+
+void OswCommunication::setPolicy(const Policy& policy) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->policy = policy;
+}
+
+void OswCommunication::setDeviceId(const std::string& deviceId) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    // It ends up in the JSON as it is, so only the harmless characters are kept
+    this->deviceId.clear();
+    for(char c : deviceId)
+        if(this->deviceId.size() < maxDeviceIdLength and (isalnum((unsigned char) c) or c == '_' or c == '-' or c == '.'))
+            this->deviceId += c;
+}
+
+uint32_t OswCommunication::tick(unsigned long now) {
+    if(this->clockStarted)
+        this->storage.clock += (uint32_t) (now - this->lastNow);
+    this->clockStarted = true;
+    this->lastNow = now;
+    return this->storage.clock;
+}
+
+void OswCommunication::advanceClock(unsigned long ms) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->storage.clock += (uint32_t) ms;
+}
+
+void OswCommunication::remove(size_t offset) {
+    const size_t size = Record(this->storage.data.data() + offset).size();
+    std::copy(this->storage.data.begin() + offset + size, this->storage.data.begin() + this->storage.used, this->storage.data.begin() + offset);
+    this->storage.used -= (uint16_t) size;
+    --this->storage.count;
+}
+
+bool OswCommunication::removeId(uint32_t id) {
+    for(size_t offset = 0; offset < this->storage.used;) {
+        const Record record(this->storage.data.data() + offset);
+        if(record.id == id) {
+            this->remove(offset);
+            return true;
+        }
+        offset += record.size();
+    }
+    return false; // Evicted or expired in the meantime
+}
+
+bool OswCommunication::enqueue(MessageType type, Priority priority, const char* data, size_t length, uint32_t timestamp, unsigned long now) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    const uint32_t clock = this->tick(now);
+    if(length == 0 or length > maxPayloadSize or (size_t) priority >= priorityCount) {
+        ++this->stats.refused;
+        return false;
+    }
+    const size_t needed = recordHeaderSize + length;
+    while(this->storage.used + needed > storageSize) {
+        // The oldest of the least important messages makes room, if it is not more important than the new one
+        size_t victim = SIZE_MAX;
+        uint8_t victimPriority = UINT8_MAX;
+        for(size_t offset = 0; offset < this->storage.used;) {
+            const Record record(this->storage.data.data() + offset);
+            if(record.priority < victimPriority) {
+                victim = offset;
+                victimPriority = record.priority;
+            }
+            offset += record.size();
+        }
+        if(victim == SIZE_MAX or victimPriority > (uint8_t) priority) {
+            ++this->stats.refused;
+            return false;
+        }
+        this->remove(victim);
+        ++this->stats.evicted;
+    }
+
+    uint8_t* record = this->storage.data.data() + this->storage.used;
+    record[0] = (uint8_t) type;
+    record[1] = (uint8_t) priority;
+    writeUInt16((uint16_t) length, record + 2);
+    writeUInt32(++this->storage.nextId, record + 4);
+    writeUInt32(clock, record + 8);
+    writeUInt32(timestamp, record + 12);
+    std::copy(data, data + length, record + recordHeaderSize);
+    this->storage.used += (uint16_t) needed;
+    ++this->storage.count;
+    ++this->stats.queued;
+    return true;
+}
+
+void OswCommunication::flush() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->flushRequested = true;
+}
+
+void OswCommunication::expire(uint32_t clock) {
+    if(this->policy.maxAge == 0)
+        return;
+    for(size_t offset = 0; offset < this->storage.used;) {
+        const Record record(this->storage.data.data() + offset);
+        if(clock - record.queuedAt < this->policy.maxAge)
+            break; // All later ones are younger
+        OSW_LOG_W("Message ", record.id, " is too old, removing it from the queue");
+        this->remove(offset);
+        ++this->stats.dropped;
+    }
+}
+
+bool OswCommunication::isWorthFlushing(uint32_t clock) const {
+    if(this->flushRequested or this->storage.used >= this->policy.flushSize)
+        return true;
+    for(size_t offset = 0; offset < this->storage.used;) {
+        const Record record(this->storage.data.data() + offset);
+        if(clock - record.queuedAt >= this->policy.maxDelay[record.priority])
+            return true;
+        offset += record.size();
+    }
+    return false;
+}
+
+size_t OswCommunication::buildBatch() {
+    char* out = (char*) this->batch.data();
+    size_t length = (size_t) snprintf(out, maxBatchSize, "{\"device_id\":\"%s\",\"messages\":[", this->deviceId.c_str());
+    const size_t closing = 2; // "]}"
+    this->batchIds.clear();
+    // The most important messages first, the oldest first within a priority
+    for(int priority = (int) priorityCount - 1; priority >= 0; priority--) {
+        for(size_t offset = 0; offset < this->storage.used;) {
+            const Record record(this->storage.data.data() + offset);
+            offset += record.size();
+            if(record.priority != priority)
+                continue;
+            char header[96];
+            const size_t headerLength = (size_t) snprintf(header, sizeof(header), "%s{\"message_id\":%u,\"type\":%u,\"priority\":%u,\"timestamp\":%u,\"data\":",
+                                        this->batchIds.empty() ? "" : ",", (unsigned) record.id, (unsigned) record.type, (unsigned) record.priority, (unsigned) record.timestamp);
+            if(length + headerLength + record.length + 1 + closing > maxBatchSize)
+                continue; // Maybe a smaller one still fits
+            std::copy(header, header + headerLength, out + length);
+            length += headerLength;
+            std::copy(record.payload, record.payload + record.length, out + length);
+            length += record.length;
+            out[length++] = '}';
+            this->batchIds.push_back(record.id);
+        }
+    }
+    out[length++] = ']';
+    out[length++] = '}';
+    return length;
+}
+
+void OswCommunication::raise(size_t transport, unsigned long now) {
+    this->current = transport;
+    this->raised = true;
+    this->raisedAt = now;
+    this->since = now;
+    this->state = State::CONNECTING;
+    ++this->stats.radioRaises;
+    OSW_LOG_D("Bringing up ", this->transports[transport]->getName(), " for ", this->storage.count, " messages");
+    this->transports[transport]->bringUp();
+}
+
+void OswCommunication::lower(unsigned long now) {
+    if(!this->raised)
+        return; // Someone else owns it
+    this->transports[this->current]->bringDown();
+    this->stats.radioTime += now - this->raisedAt;
+    this->raised = false;
+}
+
+void OswCommunication::fail(unsigned long now) {
+    this->lower(now);
+    ++this->stats.failures;
+    ++this->consecutiveFailures;
+    this->backoff = this->policy.minBackoff;
+    for(uint32_t i = 1; i < this->consecutiveFailures and this->backoff < this->policy.maxBackoff; i++)
+        this->backoff *= 2;
+    this->backoff = std::min(this->backoff, this->policy.maxBackoff);
+    this->since = now;
+    this->state = State::BACKOFF;
+    OSW_LOG_W("Sending the queue failed (", this->consecutiveFailures, " in a row), trying again in ", this->backoff, " ms");
+}
+
+void OswCommunication::loop(unsigned long now) {
+    std::unique_lock<std::mutex> guard(this->lock);
+    const uint32_t clock = this->tick(now);
+    this->expire(clock);
+    if(this->transports.empty())
+        return;
+
+    if(this->state == State::BACKOFF and now - this->since >= this->backoff)
+        this->state = State::IDLE;
+    if(this->state == State::IDLE) {
+        if(this->storage.count == 0) {
+            this->flushRequested = false;
+            return;
+        }
+        auto up = std::find_if(this->transports.begin(), this->transports.end(), [](Transport* transport) {
+            return transport->isUp();
+        });
+        if(up != this->transports.end()) {
+            this->current = up - this->transports.begin(); // Sent along
+            this->raised = false;
+            this->state = State::SENDING;
+        } else if(this->isWorthFlushing(clock))
+            this->raise(0, now);
+        else
+            return;
+    }
+    if(this->state == State::CONNECTING) {
+        if(this->transports[this->current]->isUp())
+            this->state = State::SENDING;
+        else if(now - this->since >= this->policy.connectTimeout) {
+            OSW_LOG_W(this->transports[this->current]->getName(), " did not come up");
+            this->lower(now);
+            if(this->current + 1 < this->transports.size())
+                this->raise(this->current + 1, now);
+            else
+                this->fail(now);
+            return;
+        } else
+            return;
+    }
+    if(this->state != State::SENDING)
+        return;
+
+    Transport& transport = *this->transports[this->current];
+    if(this->storage.count == 0 or !transport.isUp()) {
+        if(this->storage.count == 0) {
+            this->lower(now);
+            this->flushRequested = false;
+            this->state = State::IDLE;
+        } else
+            this->fail(now); // Lost the connection
+        return;
+    }
+    const size_t length = this->buildBatch();
+    const uint8_t* data = this->batch.data();
+    size_t size = length;
+    bool compressed = false;
+    if(length >= this->policy.compressSize and transport.acceptsGzip()) {
+        const size_t compressedSize = this->gzip.compress(this->batch.data(), length, this->compressed.data(), this->compressed.size());
+        if(compressedSize > 0 and compressedSize < length) {
+            data = this->compressed.data();
+            size = compressedSize;
+            compressed = true;
+        }
+    }
+
+    // Messages may come in meanwhile - the batch and its ids are ours
+    guard.unlock();
+    const Transport::Result result = transport.send(data, size, compressed);
+    guard.lock();
+
+    if(result == Transport::Result::RETRY) {
+        this->fail(now);
+        return;
+    }
+    for(uint32_t id : this->batchIds)
+        this->removeId(id);
+    if(result == Transport::Result::OK) {
+        this->consecutiveFailures = 0;
+        ++this->stats.batches;
+        this->stats.sent += this->batchIds.size();
+        this->stats.bytes += size;
+        this->stats.rawBytes += length;
+    } else {
+        OSW_LOG_E("The server refused a batch of ", this->batchIds.size(), " messages, dropping them");
+        this->stats.dropped += this->batchIds.size();
+    }
+    if(this->storage.count == 0) {
+        this->lower(now); // Right away, the radio is not needed any longer
+        this->flushRequested = false;
+        this->state = State::IDLE;
+    }
+}
+
+unsigned long OswCommunication::getIdleTime(unsigned long now) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    switch(this->state) {
+    case State::CONNECTING:
+        return 100; // Polls the transport
+    case State::SENDING:
+        return 0;
+    case State::BACKOFF: {
+        const unsigned long passed = now - this->since;
+        return passed < this->backoff ? this->backoff - passed : 0;
+    }
+    default:
+        break;
+    }
+    if(this->storage.count == 0)
+        return ULONG_MAX;
+    if(this->flushRequested or this->storage.used >= this->policy.flushSize)
+        return 0;
+    const uint32_t clock = this->storage.clock + (uint32_t) (now - this->lastNow);
+    unsigned long idle = ULONG_MAX;
+    for(size_t offset = 0; offset < this->storage.used;) {
+        const Record record(this->storage.data.data() + offset);
+        const unsigned long age = clock - record.queuedAt;
+        const unsigned long delay = this->policy.maxDelay[record.priority];
+        idle = std::min(idle, age < delay ? delay - age : 0);
+        if(this->policy.maxAge > 0)
+            idle = std::min(idle, age < this->policy.maxAge ? this->policy.maxAge - age : 0);
+        offset += record.size();
+    }
+    return idle;
+}
+
+OswCommunication::State OswCommunication::getState() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->state;
+}
+
+uint32_t OswCommunication::getConsecutiveFailures() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->consecutiveFailures;
+}
+
+size_t OswCommunication::getQueueSize() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->storage.count;
+}
+
+OswCommunication::Stats OswCommunication::getStats() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->stats;
+}
@@ -0,0 +1,95 @@
+#include <OswCompanionMessage.h>
+
+#include <OswLogger.h>
+
+/**
+ * Cuts the text to at most max bytes, without splitting a UTF-8 sequence
+ */
+static std::string_view limit(std::string_view text, size_t max) {
+    if(text.size() <= max)
+        return text;
+    size_t length = max;
+    while(length > 0 and (text[length] & 0xC0) == 0x80)
+        --length;
+    return text.substr(0, length);
+}
+
+OswCompanionReceiver::OswCompanionReceiver() {
+    // Only keep the fields we are interested in, so unknown fields can not exhaust the document
+    this->filter["uid"] = true;
+    this->filter["app"] = true;
+    this->filter["title"] = true;
+    this->filter["contents"] = true;
+    this->filter["timestamp"] = true;
+    this->filter["actions"][0] = true;
+}
+
+bool OswCompanionReceiver::parse(const uint8_t* data, size_t length, OswCompanionMessage& message) {
+    if(length < headerSize or data[0] != magic or (size_t) (3 + (data[1] | (data[2] << 8))) != length)
+        return false;
+    message = OswCompanionMessage();
+    message.type = (OswCompanionMessage::Type) data[3];
+    if(message.type != OswCompanionMessage::Type::NOTIFICATION and message.type != OswCompanionMessage::Type::DISMISS)
+        return false;
+    message.uid = (uint32_t) data[4] | ((uint32_t) data[5] << 8) | ((uint32_t) data[6] << 16) | ((uint32_t) data[7] << 24);
+    message.timestamp = (uint32_t) data[8] | ((uint32_t) data[9] << 8) | ((uint32_t) data[10] << 16) | ((uint32_t) data[11] << 24);
+    for(size_t position = headerSize; position < length;) {
+        if(length - position < 2 or length - position - 2 < data[position + 1])
+            return false; // The field runs past the end
+        const std::string_view text((const char*) data + position + 2, data[position + 1]);
+        switch((Field) data[position]) {
+        case Field::APP:
+            message.app = limit(text, maxAppLength);
+            break;
+        case Field::TITLE:
+            message.title = limit(text, maxTitleLength);
+            break;
+        case Field::CONTENTS:
+            message.contents = limit(text, maxContentsLength);
+            break;
+        case Field::ACTION:
+            if(message.actionCount < OswCompanionMessage::maxActions)
+                message.actions[message.actionCount++] = limit(text, maxActionLength);
+            break;
+        default:
+            break; // Added by a newer app
+        }
+        position += 2 + data[position + 1];
+    }
+    return true;
+}
+
+bool OswCompanionReceiver::parseBuffer() {
+    if(!parse(this->buffer.data(), this->expected, this->message)) {
+        ++this->stats.dropped;
+        return false;
+    }
+    ++this->stats.messages;
+    return true;
+}
+
+bool OswCompanionReceiver::parseJson(const uint8_t* data, size_t length) {
+    if(length > bufferSize) {
+        ++this->stats.dropped;
+        return false;
+    }
+    // Parsed in zero-copy mode out of our buffer, the strings stay in there
+    std::copy(data, data + length, this->buffer.begin());
+    DeserializationError error = deserializeJson(this->json, (char*) this->buffer.data(), length, DeserializationOption::Filter(this->filter));
+    if(error) {
+        OSW_LOG_W("Failed to parse notification: ", error.c_str());
+        ++this->stats.dropped;
+        return false;
+    }
+    this->message = OswCompanionMessage();
+    this->message.uid = this->json["uid"] | 0u;
+    this->message.timestamp = this->json["timestamp"] | 0u;
+    this->message.app = limit(this->json["app"] | "", maxAppLength);
+    this->message.title = limit(this->json["title"] | "", maxTitleLength);
+    this->message.contents = limit(this->json["contents"] | "", maxContentsLength);
+    for(JsonVariantConst action : this->json["actions"].as<JsonArrayConst>())
+        if(this->message.actionCount < OswCompanionMessage::maxActions)
+            this->message.actions[this->message.actionCount++] = limit(action | "", maxActionLength);
+    ++this->stats.messages;
+    return true;
+}
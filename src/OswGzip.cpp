@@ -0,0 +1,125 @@
+#include <OswGzip.h>
+
+#include <algorithm>
+
+static const uint16_t lengthBase[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t lengthExtra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t distanceBase[] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t distanceExtra[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+static constexpr size_t minMatch = 3;
+static constexpr size_t maxMatch = 258;
+
+void OswGzip::BitWriter::write(uint32_t bits, uint8_t count) {
+    this->buffer |= bits << this->used;
+    this->used += count;
+    while(this->used >= 8) {
+        if(this->position < this->capacity)
+            this->out[this->position++] = (uint8_t) this->buffer;
+        else
+            this->overflow = true;
+        this->buffer >>= 8;
+        this->used -= 8;
+    }
+}
+
+void OswGzip::BitWriter::writeCode(uint32_t code, uint8_t length) {
+    uint32_t reversed = 0;
+    for(uint8_t bit = 0; bit < length; bit++)
+        reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+    this->write(reversed, length);
+}
+
+size_t OswGzip::BitWriter::finish() {
+    if(this->used > 0)
+        this->write(0, 8 - this->used);
+    return this->position;
+}
+
+uint32_t OswGzip::crc32(const uint8_t* data, size_t length, uint32_t crc) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    crc = ~crc;
+    for(size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+void OswGzip::writeLiteral(BitWriter& writer, uint16_t symbol) {
+    // The fixed literal / length code of deflate (RFC 1951, 3.2.6)
+    if(symbol < 144)
+        writer.writeCode(0x30 + symbol, 8);
+    else if(symbol < 256)
+        writer.writeCode(0x190 + symbol - 144, 9);
+    else if(symbol < 280)
+        writer.writeCode(symbol - 256, 7);
+    else
+        writer.writeCode(0xC0 + symbol - 280, 8);
+}
+
+void OswGzip::writeMatch(BitWriter& writer, size_t length, size_t distance) {
+    uint8_t code = 28;
+    while(lengthBase[code] > length)
+        --code;
+    writeLiteral(writer, 257 + code);
+    writer.write((uint32_t) (length - lengthBase[code]), lengthExtra[code]);
+    code = 29;
+    while(distanceBase[code] > distance)
+        --code;
+    writer.writeCode(code, 5);
+    writer.write((uint32_t) (distance - distanceBase[code]), distanceExtra[code]);
+}
+
+size_t OswGzip::compress(const uint8_t* data, size_t length, uint8_t* out, size_t capacity) {
+    if(length > maxInputSize or capacity < headerSize + trailerSize)
+        return 0;
+    static const uint8_t header[headerSize] = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF}; // Deflate, no name or time, unknown OS
+    std::copy(header, header + headerSize, out);
+
+    BitWriter writer(out + headerSize, capacity - headerSize - trailerSize);
+    writer.write(1, 1); // The last (and only) block...
+    writer.write(1, 2); // ...with the fixed codes
+    this->head.fill(0);
+    auto hash = [data](size_t position) {
+        const uint32_t value = data[position] | (data[position + 1] << 8) | (data[position + 2] << 16);
+        return (value * 2654435761u) >> (32 - hashBits);
+    };
+    for(size_t position = 0; position < length and !writer.overflowed();) {
+        size_t matchLength = 0;
+        size_t distance = 0;
+        if(length - position >= minMatch) {
+            const uint32_t key = hash(position);
+            const size_t candidate = this->head[key];
+            this->head[key] = (uint16_t) (position + 1);
+            if(candidate > 0) {
+                distance = position - (candidate - 1);
+                const size_t limit = std::min(maxMatch, length - position);
+                while(matchLength < limit and data[position + matchLength] == data[position - distance + matchLength])
+                    ++matchLength;
+            }
+        }
+        if(matchLength >= minMatch) {
+            writeMatch(writer, matchLength, distance);
+            // Let the rest of the match be found later on, too
+            for(size_t next = position + 1; next < position + matchLength and length - next >= minMatch; next++)
+                this->head[hash(next)] = (uint16_t) (next + 1);
+            position += matchLength;
+        } else
+            writeLiteral(writer, data[position++]);
+    }
+    writeLiteral(writer, 256); // End of the block
+    const size_t size = headerSize + writer.finish();
+    if(writer.overflowed())
+        return 0;
+
+    const uint32_t crc = crc32(data, length);
+    for(uint8_t i = 0; i < 4; i++) {
+        out[size + i] = (uint8_t) (crc >> (8 * i));
+        out[size + 4 + i] = (uint8_t) (length >> (8 * i));
+    }
+    return size + trailerSize;
+}
@@ -1,3 +1,232 @@
 #include <OswLogger.h>
 
+#include <cassert>
+
 std::unique_ptr<OswLogger> OswLogger::instance = nullptr;
+
+OswLogger::OswLogger(size_t bufferSize) : ringMemory(new uint64_t[bufferSize / sizeof(uint64_t)]()), ringSize(bufferSize) {
+    assert((bufferSize & (bufferSize - 1)) == 0 && bufferSize >= 64 && bufferSize <= 32768 && "The log buffer size must be a power of two");
+    this->ring = (uint8_t*) this->ringMemory.get();
+}
+
+OswLogger::~OswLogger() {
+    this->stopFlusher();
+}
+
+void OswLogger::startFlusher() {
+    this->deferred = true;
+    if(this->flusherRunning)
+        return;
+    this->flusherRunning = true;
+#ifndef OSW_EMULATOR
+    this->flusherStopped = false;
+    xTaskCreatePinnedToCore([](void* pvParameters) -> void { ((OswLogger*) pvParameters)->flusherLoop(); },
+                            "oswLogFlusher", this->flusherStackSize /*stack*/, this /*input*/, 0 /*prio*/,
+                            &this->flusher /*handle*/, 0);
+#else
+    this->flusher.reset(new std::jthread([this]() -> void { this->flusherLoop(); }));
+#endif
+}
+
+void OswLogger::stopFlusher() {
+    if(this->flusherRunning) {
+        this->flusherRunning = false;
+#ifndef OSW_EMULATOR
+        while(!this->flusherStopped)
+            delay(1);
+#else
+        this->flusher.reset(); // Joins the thread
+#endif
+    }
+    this->deferred = false;
+    this->flush();
+}
+
+void OswLogger::flusherLoop() {
+    while(this->flusherRunning) {
+        this->flush();
+        delay(this->flusherInterval);
+    }
+#ifndef OSW_EMULATOR
+    this->flusherStopped = true;
+    vTaskDelete(nullptr); // Inform FreeRTOS this task is done - otherwise the kernel will take that personally and crash!
+#endif
+}
+
+void OswLogger::flush() {
+    std::lock_guard<std::mutex> guard(this->m_lock);
+    this->drain();
+}
+
+uint8_t* OswLogger::reserve(size_t size) {
+    while(true) {
+        // The tail first, so it can never be ahead of the head we work with
+        const uint32_t tail = this->tail.load(std::memory_order_acquire);
+        uint32_t head = this->head.load(std::memory_order_relaxed);
+        const uint32_t offset = head & (this->ringSize - 1);
+        const uint32_t contiguous = this->ringSize - offset;
+        // Records never wrap around, the rest of the ring is skipped instead
+        const uint32_t needed = size <= contiguous ? size : contiguous + size;
+        if(head + needed - tail > this->ringSize)
+            return nullptr;
+        if(this->head.compare_exchange_weak(head, head + needed, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            if(needed == size)
+                return this->ring + offset;
+            RecordTag* skip = (RecordTag*) (this->ring + offset);
+            skip->size = contiguous;
+            skip->severity = RECORD_SKIP;
+            __atomic_store_n(&skip->committed, 1, __ATOMIC_RELEASE);
+            return this->ring;
+        }
+    }
+}
+
+void OswLogger::drain() {
+    uint32_t tail = this->tail.load(std::memory_order_relaxed);
+    while(tail != this->head.load(std::memory_order_acquire)) {
+        uint8_t* position = this->ring + (tail & (this->ringSize - 1));
+        RecordTag* tag = (RecordTag*) position;
+        if(!__atomic_load_n(&tag->committed, __ATOMIC_ACQUIRE))
+            break; // Still written by its producer, the following ones have to wait to keep the order
+        if(tag->severity != RECORD_SKIP)
+            this->printRecord((const Record*) position);
+        // Wipe the record, as its bytes may become the (not yet committed) header of a later one
+        const uint16_t size = tag->size;
+        memset(position, 0, size);
+        tail += size;
+        this->tail.store(tail, std::memory_order_release);
+    }
+
+    const uint32_t dropped = this->dropped;
+    if(dropped != this->droppedReported) {
+        OswSerial* serial = OswSerial::getInstance();
+        this->prefix(__FILE__, __LINE__, severity_t::W, millis());
+        serial->print("Dropped ");
+        serial->print(dropped - this->droppedReported);
+        serial->print(" log message(s), the buffer is full!");
+        serial->println();
+        this->droppedReported = dropped;
+    }
+}
+
+template<typename V>
+static const uint8_t* printValue(OswSerial* serial, const uint8_t* in) {
+    V value;
+    memcpy(&value, in, sizeof(V));
+    serial->print(value);
+    return in + sizeof(V);
+}
+
+void OswLogger::printRecord(const Record* record) {
+    OswSerial* serial = OswSerial::getInstance();
+    const severity_t severity = (severity_t) record->tag.severity;
+    this->prefix(record->file, record->line, severity, record->timestamp);
+
+    const uint8_t* in = (const uint8_t*) (record + 1);
+    const uint8_t* end = in + record->argumentsSize;
+    while(in < end) {
+        switch((argument_t) *in++) {
+        case argument_t::STRING: {
+            uint16_t length;
+            memcpy(&length, in, sizeof(length));
+            in += sizeof(length);
+            this->printString(std::string_view((const char*) in, length), record->file, record->line, severity, record->timestamp);
+            in += length;
+            break;
+        }
+        // Everything is printed again with its original type, so the output is the same as printing it directly
+        case argument_t::CHAR:
+            in = printValue<char>(serial, in);
+            break;
+        case argument_t::BOOL:
+            in = printValue<bool>(serial, in);
+            break;
+        case argument_t::SCHAR:
+            in = printValue<signed char>(serial, in);
+            break;
+        case argument_t::UCHAR:
+            in = printValue<unsigned char>(serial, in);
+            break;
+        case argument_t::SHORT:
+            in = printValue<short>(serial, in);
+            break;
+        case argument_t::USHORT:
+            in = printValue<unsigned short>(serial, in);
+            break;
+        case argument_t::INT:
+            in = printValue<int>(serial, in);
+            break;
+        case argument_t::UINT:
+            in = printValue<unsigned int>(serial, in);
+            break;
+        case argument_t::LONG:
+            in = printValue<long>(serial, in);
+            break;
+        case argument_t::ULONG:
+            in = printValue<unsigned long>(serial, in);
+            break;
+        case argument_t::LLONG:
+            in = printValue<long long>(serial, in);
+            break;
+        case argument_t::ULLONG:
+            in = printValue<unsigned long long>(serial, in);
+            break;
+        case argument_t::FLOAT:
+            in = printValue<float>(serial, in);
+            break;
+        case argument_t::DOUBLE:
+            in = printValue<double>(serial, in);
+            break;
+        default:
+            in = end; // Never written by log()
+        }
+    }
+
+    serial->println();
+}
+
+void OswLogger::printString(std::string_view message, const char* file, const unsigned int line, const severity_t severity, const uint32_t timestamp) {
+    OswSerial* serial = OswSerial::getInstance();
+    // Iterate over message to find '\n', which trigger new lines...
+    for(auto& c : message) {
+        if (c == '\n') {
+            serial->println();
+            this->prefix(file, line, severity, timestamp);
+        } else
+            serial->putc(c);
+    }
+}
+
+void OswLogger::prefix(const char* file, const unsigned int line, const severity_t severity, const uint32_t timestamp) {
+    OswSerial* serial = OswSerial::getInstance();
+
+#ifdef OSW_LOG_TIMESTAMPS
+    serial->putc('[');
+    serial->print(timestamp);
+    serial->print("] ");
+#endif
+
+    switch(severity) {
+    case severity_t::D:
+        serial->print("D: ");
+        break;
+    case severity_t::I:
+        serial->print("I: ");
+        break;
+    case severity_t::W:
+        serial->print("W: ");
+        break;
+    case severity_t::E:
+        serial->print("E: ");
+        break;
+    default:
+        throw std::logic_error("Unknown severity level");
+    }
+
+#ifndef NDEBUG
+    serial->print(file);
+    serial->putc('@');
+    serial->print(line);
+    serial->print(": ");
+#endif
+}
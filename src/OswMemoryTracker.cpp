@@ -0,0 +1,215 @@
+#include <OswMemoryTracker.h>
+
+#include <cstdlib>
+
+OswMemoryTracker OswMemoryTracker::instance;
+thread_local OswMemoryTag OswMemoryTracker::scopeTag = OswMemoryTag::COUNT;
+
+namespace {
+/**
+ * In front of every block of allocate(), padded to keep the block itself aligned like malloc() does
+ */
+struct alignas(std::max_align_t) BlockHeader {
+    size_t size;
+    OswMemoryTag tag;
+    bool psram;
+};
+
+void* rawAllocate(size_t size, bool psram) {
+#if defined(GPS_EDITION) || defined(GPS_EDITION_ROTATED)
+    if(psram)
+        return ps_malloc(size);
+#endif
+    return malloc(size);
+}
+
+void* rawReallocate(void* block, size_t size, bool psram) {
+#if defined(GPS_EDITION) || defined(GPS_EDITION_ROTATED)
+    if(psram)
+        return ps_realloc(block, size);
+#endif
+    return realloc(block, size);
+}
+}
+
+const char* OswMemoryTracker::getTagName(OswMemoryTag tag) {
+    switch(tag) {
+    case OswMemoryTag::OTHER:
+        return "other";
+    case OswMemoryTag::DISPLAY:
+        return "display";
+    case OswMemoryTag::JSON:
+        return "json";
+    case OswMemoryTag::NOTIFICATIONS:
+        return "notifications";
+    case OswMemoryTag::TILES:
+        return "tiles";
+    case OswMemoryTag::LUA:
+        return "lua";
+    default:
+        return "?";
+    }
+}
+
+OswMemoryTag OswMemoryTracker::getCurrentTag(OswMemoryTag fallback) {
+    return scopeTag != OswMemoryTag::COUNT ? scopeTag : fallback;
+}
+
+void* OswMemoryTracker::allocate(size_t size, OswMemoryTag tag, bool psram) {
+    BlockHeader* header = (BlockHeader*) rawAllocate(sizeof(BlockHeader) + size, psram);
+    if(header == nullptr)
+        return nullptr;
+    header->size = size;
+    header->tag = tag;
+    header->psram = psram;
+    instance.recordAllocation(tag, size);
+    return header + 1;
+}
+
+void* OswMemoryTracker::reallocate(void* block, size_t size) {
+    if(block == nullptr)
+        return allocate(size, getCurrentTag());
+    BlockHeader* header = (BlockHeader*) block - 1;
+    const size_t previousSize = header->size;
+    const OswMemoryTag tag = header->tag;
+    BlockHeader* moved = (BlockHeader*) rawReallocate(header, sizeof(BlockHeader) + size, header->psram);
+    if(moved == nullptr)
+        return nullptr; // The old block is still valid (and accounted)
+    moved->size = size;
+    instance.recordRelease(tag, previousSize);
+    instance.recordAllocation(tag, size);
+    return moved + 1;
+}
+
+void OswMemoryTracker::release(void* block) {
+    if(block == nullptr)
+        return;
+    BlockHeader* header = (BlockHeader*) block - 1;
+    instance.recordRelease(header->tag, header->size);
+    free(header);
+}
+
+void OswMemoryTracker::recordAllocation(OswMemoryTag tag, size_t size) {
+    AtomicTagStats& stats = this->tags[(size_t) tag];
+    const size_t current = stats.current.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = stats.peak.load(std::memory_order_relaxed);
+    while(current > peak and !stats.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+        ;
+    stats.allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void OswMemoryTracker::recordRelease(OswMemoryTag tag, size_t size) {
+    AtomicTagStats& stats = this->tags[(size_t) tag];
+    stats.current.fetch_sub(size, std::memory_order_relaxed);
+    stats.frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+OswMemoryTracker::TagStats OswMemoryTracker::getStats(OswMemoryTag tag) const {
+    const AtomicTagStats& stats = this->tags[(size_t) tag];
+    TagStats copy;
+    copy.current = stats.current.load(std::memory_order_relaxed);
+    copy.peak = stats.peak.load(std::memory_order_relaxed);
+    copy.allocations = stats.allocations.load(std::memory_order_relaxed);
+    copy.frees = stats.frees.load(std::memory_order_relaxed);
+    return copy;
+}
+
+size_t OswMemoryTracker::getTrackedBytes() const {
+    size_t total = 0;
+    for(const AtomicTagStats& stats : this->tags)
+        total += stats.current.load(std::memory_order_relaxed);
+    return total;
+}
+
+void OswMemoryTracker::resetPeaks() {
+    for(AtomicTagStats& stats : this->tags)
+        stats.peak.store(stats.current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void OswMemoryTracker::sampleHeap() {
+    HeapSample sample;
+    sample.time = millis();
+#ifndef OSW_EMULATOR
+    sample.free = ESP.getFreeHeap();
+    sample.largestBlock = ESP.getMaxAllocHeap();
+#endif
+    // The emulator has no heap of its own to inspect, so only the tracked bytes are known there
+    sample.tracked = this->getTrackedBytes();
+
+    std::lock_guard<std::mutex> guard(this->historyLock);
+    this->history[this->historyNext] = sample;
+    this->historyNext = (this->historyNext + 1) % historyLength;
+    if(this->historyCount < historyLength)
+        ++this->historyCount;
+}
+
+size_t OswMemoryTracker::getHistory(HeapSample* samples, size_t max) {
+    std::lock_guard<std::mutex> guard(this->historyLock);
+    const size_t count = max < this->historyCount ? max : this->historyCount;
+    // Skip the oldest ones, if there is not enough space for all
+    size_t index = (this->historyNext + historyLength - count) % historyLength;
+    for(size_t i = 0; i < count; i++) {
+        samples[i] = this->history[index];
+        index = (index + 1) % historyLength;
+    }
+    return count;
+}
+
+uint8_t OswMemoryTracker::getFragmentation(const HeapSample& sample) {
+    if(sample.free == 0)
+        return 0;
+    return 100 - (uint8_t) ((uint64_t) sample.largestBlock * 100 / sample.free);
+}
+
+String OswMemoryTracker::describe() {
+    String msg = "tag\t\tcurrent\tpeak\tallocs\tfrees\n";
+    for(size_t i = 0; i < (size_t) OswMemoryTag::COUNT; i++) {
+        const TagStats stats = this->getStats((OswMemoryTag) i);
+        msg += getTagName((OswMemoryTag) i);
+        msg += strlen(getTagName((OswMemoryTag) i)) < 8 ? "\t\t" : "\t";
+        msg += stats.current;
+        msg += "B\t";
+        msg += stats.peak;
+        msg += "B\t";
+        msg += stats.allocations;
+        msg += "\t";
+        msg += stats.frees;
+        msg += "\n";
+    }
+
+    HeapSample latest;
+    if(this->getHistory(&latest, 1) > 0 and latest.free > 0) {
+        msg += "heap:\t\t";
+        msg += latest.largestBlock;
+        msg += "B largest block of ";
+        msg += latest.free;
+        msg += "B free (";
+        msg += getFragmentation(latest);
+        msg += "% fragmented)\n";
+    }
+    return msg;
+}
+
+void OswMemoryTracker::toJson(JsonObject json) {
+    JsonObject tags = json.createNestedObject("tags");
+    for(size_t i = 0; i < (size_t) OswMemoryTag::COUNT; i++) {
+        const TagStats stats = this->getStats((OswMemoryTag) i);
+        JsonObject tag = tags.createNestedObject(getTagName((OswMemoryTag) i));
+        tag["current"] = stats.current;
+        tag["peak"] = stats.peak;
+        tag["allocations"] = stats.allocations;
+        tag["frees"] = stats.frees;
+    }
+
+    HeapSample samples[historyLength];
+    const size_t count = this->getHistory(samples, historyLength);
+    JsonArray history = json.createNestedArray("history");
+    for(size_t i = 0; i < count; i++) {
+        JsonObject sample = history.createNestedObject();
+        sample["time"] = samples[i].time;
+        sample["free"] = samples[i].free;
+        sample["largest"] = samples[i].largestBlock;
+        sample["fragmentation"] = getFragmentation(samples[i]);
+        sample["tracked"] = samples[i].tracked;
+    }
+}
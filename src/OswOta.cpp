@@ -0,0 +1,494 @@
+#include <OswOta.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#include <OswLogger.h>
+#ifndef OSW_EMULATOR
+#include <Update.h>
+#endif
+
+static bool parseHex(const std::string& text, OswSha256::Digest& digest) {
+    if(text.size() != digest.size() * 2)
+        return false;
+    for(size_t i = 0; i < text.size(); i++) {
+        const char c = text[i];
+        uint8_t nibble;
+        if(c >= '0' and c <= '9')
+            nibble = c - '0';
+        else if(c >= 'a' and c <= 'f')
+            nibble = c - 'a' + 10;
+        else if(c >= 'A' and c <= 'F')
+            nibble = c - 'A' + 10;
+        else
+            return false;
+        digest[i / 2] = (uint8_t) (i % 2 == 0 ? nibble << 4 : digest[i / 2] | nibble);
+    }
+    return true;
+}
+
+static std::string toHex(const OswSha256::Digest& digest) {
+    static const char digits[] = "0123456789abcdef";
+    std::string text;
+    for(uint8_t byte : digest) {
+        text += digits[byte >> 4];
+        text += digits[byte & 0xf];
+    }
+    return text;
+}
+
+bool OswOta::Manifest::parse(const std::string& text) {
+    *this = Manifest();
+    std::string fields[3];
+    size_t count = 0;
+    for(size_t start = 0; count < 3; count++) {
+        const size_t end = text.find(';', start);
+        fields[count] = text.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        if(end == std::string::npos) {
+            count++;
+            break;
+        }
+        start = end + 1;
+    }
+    if(fields[0].empty() or fields[0].size() > 9 or fields[0].find_first_not_of("0123456789") != std::string::npos)
+        return false;
+    this->size = (size_t) strtoul(fields[0].c_str(), nullptr, 10);
+    if(count > 1 and !fields[1].empty()) {
+        if(!parseHex(fields[1], this->sha256))
+            return false;
+        this->hasHash = true;
+    }
+    if(count > 2) {
+        if(!this->hasHash or !parseHex(fields[2], this->signature))
+            return false;
+        this->hasSignature = true;
+    }
+    return true;
+}
+
+std::string OswOta::Manifest::getSignedPart() const {
+    return std::to_string(this->size) + ";" + toHex(this->sha256);
+}
+
+bool OswOta::Manifest::isSignedWith(const std::string& key) const {
+    if(!this->hasSignature)
+        return false;
+    const std::string signedPart = this->getSignedPart();
+    return OswSha256::equals(OswSha256::hmac((const uint8_t*) key.data(), key.size(), (const uint8_t*) signedPart.data(), signedPart.size()), this->signature);
+}
+
+OswOta::OswOta(Sink& sink, size_t bufferSize) : sink(sink), bufferSize(bufferSize) {
+    for(auto& buffer : this->buffers)
+        buffer.reset(new uint8_t[this->bufferSize]);
+#ifndef OSW_EMULATOR
+    this->writerStarted = xTaskCreatePinnedToCore([](void* pvParameters) -> void { ((OswOta*) pvParameters)->work(); },
+                                                  "oswOtaWriter", this->writerStackSize /*stack*/, this /*input*/, 1 /*prio*/,
+                                                  &this->writer /*handle*/, 0) == pdPASS;
+    if(!this->writerStarted)
+        OSW_LOG_E("[OTA] Failed to start the writer task!");
+#else
+    this->writer.reset(new std::jthread([this]() -> void { this->work(); }));
+#endif
+}
+
+OswOta::~OswOta() {
+    {
+        std::unique_lock<std::mutex> guard(this->lock);
+        if(this->progress.state == State::RECEIVING)
+            this->fail(guard, "Update dropped.");
+        this->stopping = true;
+    }
+    this->changed.notify_all();
+#ifndef OSW_EMULATOR
+    if(this->writerStarted) {
+        std::unique_lock<std::mutex> guard(this->lock);
+        this->changed.wait(guard, [this]() {
+            return this->writerStopped;
+        });
+    }
+#else
+    this->writer.reset(); // Joins the thread
+#endif
+}
+
+bool OswOta::begin(const Manifest& manifest, const std::string& key, size_t size) {
+    std::unique_lock<std::mutex> guard(this->lock);
+    if(this->progress.state == State::RECEIVING) {
+        this->error = "Another update is already running.";
+        return false;
+    }
+    this->progress = Progress();
+    this->progress.total = manifest.size > 0 ? manifest.size : size;
+    this->manifest = manifest;
+    this->startedAt = millis();
+    this->error.clear();
+    this->sha256.reset();
+    this->filling = -1;
+    this->ended = false;
+#ifndef OSW_EMULATOR
+    if(!this->writerStarted) {
+        this->progress.state = State::FAILED;
+        this->error = "Writer task not started.";
+        return false;
+    }
+#endif
+    // Refused before the flash is touched
+    if(!key.empty() and !manifest.isSignedWith(key)) {
+        this->progress.state = State::FAILED;
+        this->error = manifest.hasSignature ? "Wrong signature." : "Unsigned update.";
+        OSW_LOG_E("[OTA] ", this->error);
+        return false;
+    }
+    if(manifest.size > 0 and size > 0 and manifest.size != size) {
+        this->progress.state = State::FAILED;
+        this->error = "Size differs from the manifest.";
+        OSW_LOG_E("[OTA] ", this->error);
+        return false;
+    }
+    if(key.empty())
+        OSW_LOG_W("[OTA] No signing key set, the update is not verified!");
+    this->progress.state = State::RECEIVING;
+    this->sinkOpen = true;
+    const size_t total = this->progress.total;
+
+    guard.unlock();
+    const bool begun = this->sink.begin(total);
+    guard.lock();
+    if(!begun) {
+        this->fail(guard, "Begin failed: " + this->sink.getError());
+        return false;
+    }
+    OSW_LOG_I("[OTA] Receiving ", total, " bytes...");
+    return true;
+}
+
+bool OswOta::write(const uint8_t* data, size_t length) {
+    std::unique_lock<std::mutex> guard(this->lock);
+    while(length > 0 and this->progress.state == State::RECEIVING) {
+        if(this->progress.total > 0 and this->progress.received + length > this->progress.total) {
+            this->fail(guard, "Image larger than announced.");
+            break;
+        }
+        uint8_t* buffer = this->acquire(guard, ULONG_MAX);
+        if(buffer == nullptr)
+            break;
+        const size_t taken = std::min(length, this->bufferSize - this->lengths[this->filling]);
+        // The buffer is only ours until it is submitted, so no need to hold the lock meanwhile
+        guard.unlock();
+        memcpy(buffer, data, taken);
+        this->sha256.update(buffer, taken);
+        guard.lock();
+        this->lengths[this->filling] += taken;
+        this->progress.received += taken;
+        data += taken;
+        length -= taken;
+        if(this->lengths[this->filling] == this->bufferSize)
+            this->submit(guard);
+    }
+    if(this->progress.state == State::FAILED)
+        this->fail(guard, this->error);
+    return this->progress.state == State::RECEIVING;
+}
+
+bool OswOta::receive(Source& source, unsigned long sliceTime) {
+    const unsigned long sliceStart = millis();
+    std::unique_lock<std::mutex> guard(this->lock);
+    while(this->progress.state == State::RECEIVING and !this->ended and millis() - sliceStart < sliceTime) {
+        if(this->progress.total > 0 and this->progress.received >= this->progress.total)
+            break;
+        uint8_t* buffer = this->acquire(guard, sliceTime - (millis() - sliceStart));
+        if(buffer == nullptr)
+            break;
+        size_t wanted = this->bufferSize - this->lengths[this->filling];
+        if(this->progress.total > 0)
+            wanted = std::min(wanted, this->progress.total - this->progress.received);
+        guard.unlock();
+        const int count = source.read(buffer, wanted);
+        if(count > 0)
+            this->sha256.update(buffer, count);
+        guard.lock();
+        if(count < 0) {
+            if(this->progress.total > 0)
+                this->fail(guard, "Connection lost.");
+            this->ended = true;
+            break;
+        }
+        if(count == 0)
+            break; // Nothing more for now
+        this->lengths[this->filling] += count;
+        this->progress.received += count;
+        if(this->lengths[this->filling] == this->bufferSize)
+            this->submit(guard);
+    }
+    if(this->progress.state == State::FAILED)
+        this->fail(guard, this->error);
+    return this->progress.state == State::RECEIVING;
+}
+
+bool OswOta::isComplete() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    if(this->progress.total > 0)
+        return this->progress.received >= this->progress.total;
+    return this->ended;
+}
+
+bool OswOta::finish() {
+    std::unique_lock<std::mutex> guard(this->lock);
+    if(this->progress.state == State::RECEIVING) {
+        this->submit(guard);
+        this->waitIdle(guard);
+    }
+    if(this->progress.state != State::RECEIVING) {
+        if(this->progress.state == State::IDLE)
+            this->error = "No update running.";
+        this->fail(guard, this->error);
+        return this->progress.state == State::COMMITTED;
+    }
+    if(this->progress.total > 0 and this->progress.received != this->progress.total) {
+        this->fail(guard, "Image incomplete.");
+        return false;
+    }
+    if(this->manifest.hasHash and !OswSha256::equals(this->sha256.finish(), this->manifest.sha256)) {
+        this->fail(guard, "SHA-256 mismatch.");
+        return false;
+    }
+
+    this->sinkOpen = false;
+    guard.unlock();
+    const bool committed = this->sink.commit();
+    guard.lock();
+    this->progress.elapsed = millis() - this->startedAt;
+    if(!committed) {
+        this->progress.state = State::FAILED;
+        this->error = "Commit failed: " + this->sink.getError();
+        OSW_LOG_E("[OTA] ", this->error);
+        return false;
+    }
+    this->progress.state = State::COMMITTED;
+    OSW_LOG_I("[OTA] Finished after ", this->progress.written, " bytes in ", this->progress.elapsed, " ms (",
+              this->progress.getThroughput() / 1024, " kB/s, waited ", this->progress.receiveWait, " ms for the flash)");
+    return true;
+}
+
+void OswOta::abort(const std::string& reason) {
+    std::unique_lock<std::mutex> guard(this->lock);
+    this->fail(guard, reason);
+}
+
+OswOta::Progress OswOta::getProgress() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    Progress progress = this->progress;
+    if(progress.state == State::RECEIVING)
+        progress.elapsed = millis() - this->startedAt;
+    return progress;
+}
+
+std::string OswOta::getError() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->error;
+}
+
+/**
+ * @return the free space of the buffer being filled (nullptr after the timeout or if the update failed)
+ */
+uint8_t* OswOta::acquire(std::unique_lock<std::mutex>& guard, unsigned long timeout) {
+    if(this->filling >= 0 and this->lengths[this->filling] < this->bufferSize)
+        return this->buffers[this->filling].get() + this->lengths[this->filling];
+    const unsigned long waitStart = millis();
+    auto ready = [this]() {
+        return this->freeMask != 0 or this->progress.state != State::RECEIVING;
+    };
+    bool acquired = true;
+    if(timeout == ULONG_MAX)
+        this->changed.wait(guard, ready);
+    else
+        acquired = this->changed.wait_for(guard, std::chrono::milliseconds(timeout), ready);
+    this->progress.receiveWait += millis() - waitStart;
+    if(!acquired or this->progress.state != State::RECEIVING)
+        return nullptr;
+    this->filling = (this->freeMask & 0b01) ? 0 : 1;
+    this->freeMask &= ~(1 << this->filling);
+    this->lengths[this->filling] = 0;
+    return this->buffers[this->filling].get();
+}
+
+void OswOta::submit(std::unique_lock<std::mutex>& guard) {
+    if(this->filling < 0)
+        return;
+    if(this->lengths[this->filling] == 0) {
+        this->freeMask |= 1 << this->filling;
+    } else {
+        this->pending[(this->pendingHead + this->pendingCount) % this->pending.size()] = this->filling;
+        ++this->pendingCount;
+    }
+    this->filling = -1;
+    this->changed.notify_all();
+}
+
+void OswOta::waitIdle(std::unique_lock<std::mutex>& guard) {
+    this->changed.wait(guard, [this]() {
+        return this->pendingCount == 0 and !this->writing;
+    });
+}
+
+/**
+ * Ends the update (also one the writer already failed) and aborts the sink - once the writer let go of it
+ */
+void OswOta::fail(std::unique_lock<std::mutex>& guard, const std::string& reason) {
+    if(this->progress.state == State::RECEIVING) {
+        this->progress.state = State::FAILED;
+        this->progress.elapsed = millis() - this->startedAt;
+        this->error = reason;
+        OSW_LOG_E("[OTA] ", reason);
+    }
+    this->pendingCount = 0;
+    this->filling = -1;
+    this->changed.wait(guard, [this]() {
+        return !this->writing;
+    });
+    this->freeMask = 0b11;
+    if(this->sinkOpen) {
+        this->sinkOpen = false;
+        guard.unlock();
+        this->sink.abort();
+        guard.lock();
+    }
+    this->changed.notify_all();
+}
+
+void OswOta::work() {
+    std::unique_lock<std::mutex> guard(this->lock);
+    while(true) {
+        this->changed.wait(guard, [this]() {
+            return this->pendingCount > 0 or this->stopping;
+        });
+        if(this->pendingCount == 0)
+            break; // Only reached when stopping
+        const uint8_t index = this->pending[this->pendingHead];
+        this->pendingHead = (this->pendingHead + 1) % this->pending.size();
+        --this->pendingCount;
+        this->writing = true;
+
+        // The network stage may fill the other buffer meanwhile
+        guard.unlock();
+        const unsigned long writeStart = millis();
+        const bool written = this->sink.write(this->buffers[index].get(), this->lengths[index]);
+        const unsigned long writeTime = millis() - writeStart;
+        const std::string reason = written ? "" : "Write failed: " + this->sink.getError();
+        guard.lock();
+
+        this->writing = false;
+        this->progress.writeTime += writeTime;
+        this->freeMask |= 1 << index;
+        if(written) {
+            this->progress.written += this->lengths[index];
+        } else if(this->progress.state == State::RECEIVING) {
+            // The rest is dropped, the network stage notices on its next call
+            this->progress.state = State::FAILED;
+            this->progress.elapsed = millis() - this->startedAt;
+            this->error = reason;
+            this->pendingCount = 0;
+            this->freeMask = this->filling >= 0 ? 0b11 & ~(1 << this->filling) : 0b11;
+            OSW_LOG_E("[OTA] ", reason);
+        }
+        this->changed.notify_all();
+    }
+#ifndef OSW_EMULATOR
+    this->writerStopped = true;
+    this->changed.notify_all(); // Still locked, so the destructor can not free us before this returns
+    guard.unlock();
+    vTaskDelete(nullptr); // Inform FreeRTOS this task is done - otherwise the kernel will take that personally and crash!
+#endif
+}
+
+#ifdef OSW_EMULATOR
+OswOtaFileSink::~OswOtaFileSink() {
+    if(this->file)
+        this->abort();
+}
+
+bool OswOtaFileSink::begin(size_t size) {
+    this->error.clear();
+    this->file = fopen((this->path + ".part").c_str(), "wb");
+    if(!this->file)
+        this->error = std::string("Can not create ") + this->path + ".part: " + strerror(errno);
+    return this->file != nullptr;
+}
+
+bool OswOtaFileSink::write(const uint8_t* data, size_t length) {
+    if(fwrite(data, 1, length, this->file) == length)
+        return true;
+    this->error = std::string("Can not write: ") + strerror(errno);
+    return false;
+}
+
+bool OswOtaFileSink::commit() {
+    const bool closed = fclose(this->file) == 0;
+    this->file = nullptr;
+    if(closed and rename((this->path + ".part").c_str(), this->path.c_str()) == 0)
+        return true;
+    this->error = std::string("Can not commit: ") + strerror(errno);
+    remove((this->path + ".part").c_str());
+    return false;
+}
+
+void OswOtaFileSink::abort() {
+    if(this->file)
+        fclose(this->file);
+    this->file = nullptr;
+    remove((this->path + ".part").c_str());
+}
+
+std::string OswOtaFileSink::getError() {
+    return this->error;
+}
+
+OswOtaFileSource::OswOtaFileSource(const std::string& path) {
+    this->file = fopen(path.c_str(), "rb");
+    if(!this->file)
+        return;
+    fseek(this->file, 0, SEEK_END);
+    this->size = (size_t) ftell(this->file);
+    fseek(this->file, 0, SEEK_SET);
+}
+
+OswOtaFileSource::~OswOtaFileSource() {
+    if(this->file)
+        fclose(this->file);
+}
+
+int OswOtaFileSource::read(uint8_t* buffer, size_t length) {
+    if(!this->file)
+        return -1;
+    const size_t count = fread(buffer, 1, length, this->file);
+    return count > 0 ? (int) count : -1;
+}
+#else
+bool OswOtaFlashSink::begin(size_t size) {
+    if(!Update.begin(size > 0 ? size : UPDATE_SIZE_UNKNOWN))
+        return false;
+    if(this->md5.length()) {
+        Update.setMD5(this->md5.c_str());
+        OSW_LOG_I("[OTA] MD5: ", this->md5);
+    }
+    return true;
+}
+
+bool OswOtaFlashSink::write(const uint8_t* data, size_t length) {
+    return Update.write((uint8_t*) data, length) == length;
+}
+
+bool OswOtaFlashSink::commit() {
+    return Update.end(true);
+}
+
+void OswOtaFlashSink::abort() {
+    Update.abort();
+}
+
+std::string OswOtaFlashSink::getError() {
+    return Update.errorString();
+}
+#endif
@@ -0,0 +1,155 @@
+#include <OswSensorTrace.h>
+
+#include <cstdlib>
+#include <cstring>
+
+static const char* const kindNames[] = {"utc", "acc", "steps", "activity", "pressure", "temp", "humidity", "mag", "gps", "button"};
+static const uint8_t kindValueCounts[] = {1, 3, 1, 1, 1, 1, 1, 4, 3, 2};
+static_assert(sizeof(kindNames) / sizeof(kindNames[0]) == (size_t) OswSensorTrace::Kind::COUNT, "Every kind needs a name");
+static_assert(sizeof(kindValueCounts) == (size_t) OswSensorTrace::Kind::COUNT, "Every kind needs a value count");
+
+const char* OswSensorTrace::getKindName(Kind kind) {
+    return kind < Kind::COUNT ? kindNames[(size_t) kind] : "?";
+}
+
+uint8_t OswSensorTrace::getValueCount(Kind kind) {
+    return kind < Kind::COUNT ? kindValueCounts[(size_t) kind] : 0;
+}
+
+/**
+ * Counters are written as integers and coordinates with ~1cm resolution, everything else with the precision of a float
+ */
+static const char* getValueFormat(OswSensorTrace::Kind kind) {
+    switch(kind) {
+    case OswSensorTrace::Kind::UTC:
+    case OswSensorTrace::Kind::STEPS:
+    case OswSensorTrace::Kind::ACTIVITY:
+    case OswSensorTrace::Kind::BUTTON:
+        return " %.0f";
+    case OswSensorTrace::Kind::GPS:
+        return " %.7f";
+    default:
+        return " %.7g";
+    }
+}
+
+size_t OswSensorTrace::format(const Sample& sample, char* line, size_t size) {
+    if(sample.kind >= Kind::COUNT)
+        return 0;
+    int length = snprintf(line, size, "%lu %s", (unsigned long) sample.time, getKindName(sample.kind));
+    const char* valueFormat = getValueFormat(sample.kind);
+    for(uint8_t i = 0; i < getValueCount(sample.kind) and length >= 0 and (size_t) length < size; i++)
+        length += snprintf(line + length, size - length, valueFormat, sample.values[i]);
+    if(length < 0 or (size_t) length + 1 >= size)
+        return 0;
+    line[length++] = '\n';
+    line[length] = '\0';
+    return length;
+}
+
+bool OswSensorTrace::parse(const char* line, Sample& sample) {
+    while(*line == ' ' or *line == '\t')
+        ++line;
+    if(*line == '#' or *line == '\0' or *line == '\n' or *line == '\r')
+        return false;
+
+    char* end;
+    const unsigned long time = strtoul(line, &end, 10);
+    if(end == line or *end != ' ')
+        return false;
+    line = end + 1;
+    const size_t nameLength = strcspn(line, " \r\n");
+    sample.kind = Kind::COUNT;
+    for(size_t i = 0; i < (size_t) Kind::COUNT; i++)
+        if(strlen(kindNames[i]) == nameLength and strncmp(line, kindNames[i], nameLength) == 0)
+            sample.kind = (Kind) i;
+    if(sample.kind == Kind::COUNT)
+        return false;
+    line += nameLength;
+
+    sample.time = time;
+    sample.values.fill(0);
+    for(uint8_t i = 0; i < getValueCount(sample.kind); i++) {
+        sample.values[i] = strtod(line, &end);
+        if(end == line)
+            return false;
+        line = end;
+    }
+    return true;
+}
+
+OswSensorTraceWriter::~OswSensorTraceWriter() {
+    this->close();
+}
+
+bool OswSensorTraceWriter::open(const char* path) {
+    this->close();
+    this->file = fopen(path, "w");
+    if(this->file == nullptr)
+        return false;
+    fputs("# OSW sensor trace 1\n", this->file);
+    this->started = false;
+    this->written = 0;
+    this->hasLast.fill(false);
+    return true;
+}
+
+void OswSensorTraceWriter::close() {
+    if(this->file != nullptr)
+        fclose(this->file);
+    this->file = nullptr;
+}
+
+bool OswSensorTraceWriter::write(uint32_t time, OswSensorTrace::Kind kind, double a, double b, double c, double d, bool force) {
+    if(this->file == nullptr or kind >= OswSensorTrace::Kind::COUNT)
+        return false;
+    if(!this->started) {
+        this->started = true;
+        this->startTime = time;
+    }
+    OswSensorTrace::Sample sample;
+    sample.time = time - this->startTime;
+    sample.kind = kind;
+    sample.values = {a, b, c, d};
+    if(!force and this->hasLast[(size_t) kind] and this->last[(size_t) kind].values == sample.values)
+        return false;
+    this->last[(size_t) kind] = sample;
+    this->hasLast[(size_t) kind] = true;
+
+    char line[128];
+    const size_t length = OswSensorTrace::format(sample, line, sizeof(line));
+    if(length == 0 or fwrite(line, 1, length, this->file) != length)
+        return false;
+    ++this->written;
+    return true;
+}
+
+OswSensorTraceReader::~OswSensorTraceReader() {
+    this->close();
+}
+
+bool OswSensorTraceReader::open(const char* path) {
+    this->close();
+    this->file = fopen(path, "r");
+    this->skipped = 0;
+    return this->file != nullptr;
+}
+
+void OswSensorTraceReader::close() {
+    if(this->file != nullptr)
+        fclose(this->file);
+    this->file = nullptr;
+}
+
+bool OswSensorTraceReader::next(OswSensorTrace::Sample& sample) {
+    if(this->file == nullptr)
+        return false;
+    char line[128];
+    while(fgets(line, sizeof(line), this->file) != nullptr) {
+        if(OswSensorTrace::parse(line, sample))
+            return true;
+        if(line[0] != '#' and line[0] != '\n' and line[0] != '\r')
+            ++this->skipped;
+    }
+    return false;
+}
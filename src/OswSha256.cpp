@@ -0,0 +1,169 @@
+#include <OswSha256.h>
+
+#include <algorithm>
+#include <cstring>
+
+OswSha256::OswSha256() {
+#ifndef OSW_EMULATOR
+    mbedtls_sha256_init(&this->context);
+#endif
+    this->reset();
+}
+
+OswSha256::~OswSha256() {
+#ifndef OSW_EMULATOR
+    mbedtls_sha256_free(&this->context);
+#endif
+}
+
+#ifndef OSW_EMULATOR
+void OswSha256::reset() {
+    mbedtls_sha256_starts_ret(&this->context, 0 /*not SHA-224*/);
+}
+
+void OswSha256::update(const uint8_t* data, size_t length) {
+    mbedtls_sha256_update_ret(&this->context, data, length);
+}
+
+OswSha256::Digest OswSha256::finish() {
+    Digest digest;
+    mbedtls_sha256_finish_ret(&this->context, digest.data());
+    return digest;
+}
+#else
+static const uint32_t roundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+static inline uint32_t rotateRight(uint32_t value, unsigned count) {
+    return (value >> count) | (value << (32 - count));
+}
+
+void OswSha256::reset() {
+    this->state = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    this->blockUsed = 0;
+    this->total = 0;
+}
+
+void OswSha256::compress(const uint8_t* data) {
+    uint32_t w[64];
+    for(int i = 0; i < 16; i++)
+        w[i] = (uint32_t) data[i * 4] << 24 | (uint32_t) data[i * 4 + 1] << 16 | (uint32_t) data[i * 4 + 2] << 8 | data[i * 4 + 3];
+    for(int i = 16; i < 64; i++) {
+        const uint32_t s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const uint32_t s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = this->state[0], b = this->state[1], c = this->state[2], d = this->state[3];
+    uint32_t e = this->state[4], f = this->state[5], g = this->state[6], h = this->state[7];
+    for(int i = 0; i < 64; i++) {
+        const uint32_t t1 = h + (rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25)) + ((e & f) ^ (~e & g)) + roundConstants[i] + w[i];
+        const uint32_t t2 = (rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    this->state[0] += a;
+    this->state[1] += b;
+    this->state[2] += c;
+    this->state[3] += d;
+    this->state[4] += e;
+    this->state[5] += f;
+    this->state[6] += g;
+    this->state[7] += h;
+}
+
+void OswSha256::update(const uint8_t* data, size_t length) {
+    if(length == 0)
+        return;
+    this->total += length;
+    if(this->blockUsed > 0) {
+        const size_t taken = std::min(length, blockSize - this->blockUsed);
+        memcpy(this->block.data() + this->blockUsed, data, taken);
+        this->blockUsed += taken;
+        data += taken;
+        length -= taken;
+        if(this->blockUsed < blockSize)
+            return;
+        this->compress(this->block.data());
+        this->blockUsed = 0;
+    }
+    // Whole blocks straight from the input
+    for(; length >= blockSize; data += blockSize, length -= blockSize)
+        this->compress(data);
+    memcpy(this->block.data(), data, length);
+    this->blockUsed = length;
+}
+
+OswSha256::Digest OswSha256::finish() {
+    const uint64_t bits = this->total * 8;
+    const uint8_t one = 0x80;
+    const uint8_t zero = 0x00;
+    this->update(&one, 1);
+    while(this->blockUsed != blockSize - 8)
+        this->update(&zero, 1);
+    uint8_t length[8];
+    for(int i = 0; i < 8; i++)
+        length[i] = (uint8_t) (bits >> (56 - i * 8));
+    this->update(length, sizeof(length));
+
+    Digest digest;
+    for(int i = 0; i < 8; i++) {
+        digest[i * 4] = (uint8_t) (this->state[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t) (this->state[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t) (this->state[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t) this->state[i];
+    }
+    return digest;
+}
+#endif
+
+OswSha256::Digest OswSha256::hash(const uint8_t* data, size_t length) {
+    OswSha256 sha;
+    sha.update(data, length);
+    return sha.finish();
+}
+
+OswSha256::Digest OswSha256::hmac(const uint8_t* key, size_t keyLength, const uint8_t* data, size_t length) {
+    // Keys longer than a block are hashed first, shorter ones padded with zeros
+    std::array<uint8_t, blockSize> padded = {};
+    if(keyLength > blockSize) {
+        const Digest hashed = hash(key, keyLength);
+        memcpy(padded.data(), hashed.data(), hashed.size());
+    } else if(keyLength > 0) {
+        memcpy(padded.data(), key, keyLength);
+    }
+
+    std::array<uint8_t, blockSize> pad;
+    for(size_t i = 0; i < blockSize; i++)
+        pad[i] = padded[i] ^ 0x36;
+    OswSha256 inner;
+    inner.update(pad.data(), pad.size());
+    inner.update(data, length);
+    const Digest innerDigest = inner.finish();
+
+    for(size_t i = 0; i < blockSize; i++)
+        pad[i] = padded[i] ^ 0x5c;
+    OswSha256 outer;
+    outer.update(pad.data(), pad.size());
+    outer.update(innerDigest.data(), innerDigest.size());
+    return outer.finish();
+}
+
+bool OswSha256::equals(const Digest& a, const Digest& b) {
+    uint8_t difference = 0;
+    for(size_t i = 0; i < digestSize; i++)
+        difference |= a[i] ^ b[i];
+    return difference == 0;
+}
@@ -0,0 +1,245 @@
+#include <OswTimezone.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <limits>
+
+#include <OswClock.h>
+
+/**
+ * See https://howardhinnant.github.io/date_algorithms.html#days_from_civil
+ */
+static int64_t daysFromCivil(int64_t year, int64_t month, int64_t day) {
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const int64_t yearOfEra = year - era * 400;
+    const int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+static bool isLeapYear(int64_t year) {
+    return year % 4 == 0 and (year % 100 != 0 or year % 400 == 0);
+}
+
+static int64_t getYear(time_t utc) {
+    OswClock::BrokenDownTime time;
+    OswClock::breakDown(utc, time);
+    return time.year;
+}
+
+static bool parseNumber(const char*& posix, int32_t& number, int32_t max) {
+    if(!isdigit((unsigned char) *posix))
+        return false;
+    number = 0;
+    while(isdigit((unsigned char) *posix)) {
+        number = number * 10 + (*posix++ - '0');
+        if(number > max)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Names are at least three letters, or anything in angle brackets (like "<+0545>")
+ */
+static bool parseName(const char*& posix) {
+    if(*posix == '<') {
+        const char* end = strchr(posix, '>');
+        if(end == nullptr or end - posix < 4)
+            return false;
+        posix = end + 1;
+        return true;
+    }
+    const char* start = posix;
+    while(isalpha((unsigned char) *posix))
+        ++posix;
+    return posix - start >= 3;
+}
+
+/**
+ * [+-]hh[:mm[:ss]]
+ */
+static bool parseTime(const char*& posix, int32_t& seconds, int32_t maxHours) {
+    int32_t sign = 1;
+    if(*posix == '+' or *posix == '-')
+        sign = *posix++ == '-' ? -1 : 1;
+    int32_t hours, minutes = 0, secs = 0;
+    if(!parseNumber(posix, hours, maxHours))
+        return false;
+    if(*posix == ':' and !parseNumber(++posix, minutes, 59))
+        return false;
+    if(*posix == ':' and !parseNumber(++posix, secs, 59))
+        return false;
+    seconds = sign * (hours * 3600 + minutes * 60 + secs);
+    return true;
+}
+
+bool OswTimezone::parseDate(const char*& posix, Date& date) {
+    int32_t value;
+    if(*posix == 'J') {
+        date.kind = Date::Kind::JULIAN_1;
+        if(!parseNumber(++posix, value, 365) or value < 1)
+            return false;
+        date.day = value;
+    } else if(*posix == 'M') {
+        date.kind = Date::Kind::MONTH_WEEK_DAY;
+        if(!parseNumber(++posix, value, 12) or value < 1 or *posix != '.')
+            return false;
+        date.month = value;
+        if(!parseNumber(++posix, value, 5) or value < 1 or *posix != '.')
+            return false;
+        date.week = value;
+        if(!parseNumber(++posix, value, 6))
+            return false;
+        date.day = value;
+    } else {
+        date.kind = Date::Kind::JULIAN_0;
+        if(!parseNumber(posix, value, 365))
+            return false;
+        date.day = value;
+    }
+    date.time = 7200;
+    if(*posix == '/' and !parseTime(++posix, date.time, 167)) // POSIX only allows 0-24h, but the zone database uses more
+        return false;
+    return true;
+}
+
+bool OswTimezone::parse(const char* posix, Rule& rule) {
+    rule = Rule();
+    if(*posix == '\0')
+        return true; // UTC
+    int32_t offset;
+    if(!parseName(posix) or !parseTime(posix, offset, 24))
+        return false;
+    rule.standardOffset = -offset; // POSIX counts westwards
+    if(*posix == '\0')
+        return true;
+
+    if(!parseName(posix))
+        return false;
+    rule.hasDst = true;
+    rule.dstOffset = rule.standardOffset + 3600;
+    if(*posix != ',' and *posix != '\0') {
+        if(!parseTime(posix, offset, 24))
+            return false;
+        rule.dstOffset = -offset;
+    }
+    if(*posix == '\0') {
+        // No rule given, use the same default as glibc
+        const char* fallback = "M3.2.0,M11.1.0";
+        return parseDate(fallback, rule.start) and parseDate(++fallback, rule.end);
+    }
+    if(*posix != ',' or !parseDate(++posix, rule.start) or *posix != ',' or !parseDate(++posix, rule.end))
+        return false;
+    return *posix == '\0';
+}
+
+int64_t OswTimezone::getDay(const Date& date, int64_t year) {
+    switch(date.kind) {
+    case Date::Kind::JULIAN_1:
+        return daysFromCivil(year, 1, 1) + date.day - 1 + (isLeapYear(year) and date.day >= 60 ? 1 : 0); // Never counts February 29
+    case Date::Kind::JULIAN_0:
+        return daysFromCivil(year, 1, 1) + date.day;
+    default:
+        const int64_t first = daysFromCivil(year, date.month, 1);
+        const int64_t next = date.month == 12 ? daysFromCivil(year + 1, 1, 1) : daysFromCivil(year, date.month + 1, 1);
+        const int64_t firstWeekDay = ((first + 4) % 7 + 7) % 7; // 1970-01-01 was a Thursday
+        int64_t day = first + (date.day - firstWeekDay + 7) % 7 + 7 * (date.week - 1);
+        while(day >= next) // The fifth week means the last one
+            day -= 7;
+        return day;
+    }
+}
+
+size_t OswTimezone::generate(const Rule& rule, int64_t firstYear, int64_t lastYear, Transition* result) {
+    size_t count = 0;
+    for(int64_t year = firstYear; year <= lastYear; year++) {
+        // The start is given in standard time, the end in daylight saving time
+        result[count].at = (time_t) (getDay(rule.start, year) * 86400 + rule.start.time - rule.standardOffset);
+        result[count++].offset = rule.dstOffset;
+        result[count].at = (time_t) (getDay(rule.end, year) * 86400 + rule.end.time - rule.dstOffset);
+        result[count++].offset = rule.standardOffset;
+    }
+    // Stable, so a transition of a year stays before the one of the next year on the same second (e.g. all-year DST)
+    std::stable_sort(result, result + count, [](const Transition& a, const Transition& b) -> bool { return a.at < b.at; });
+    return count;
+}
+
+void OswTimezone::build(time_t now) {
+    this->transitionCount = 0;
+    this->initialOffset = this->rule.standardOffset;
+    if(!this->rule.hasDst) {
+        this->validFrom = std::numeric_limits<time_t>::min();
+        this->validUntil = std::numeric_limits<time_t>::max();
+        return;
+    }
+    // The table covers the last year up to the end of the third next one, the years around it only provide the
+    // offset at its borders
+    const int64_t year = getYear(now);
+    this->validFrom = (time_t) (daysFromCivil(year - 1, 1, 1) * 86400);
+    this->validUntil = (time_t) (daysFromCivil(year + 4, 1, 1) * 86400);
+    Transition all[14];
+    const size_t count = generate(this->rule, year - 2, year + 4, all);
+    for(size_t i = 0; i < count; i++) {
+        if(all[i].at < this->validFrom)
+            this->initialOffset = all[i].offset;
+        else if(all[i].at < this->validUntil and this->transitionCount < maxTransitions)
+            this->transitions[this->transitionCount++] = all[i];
+    }
+}
+
+bool OswTimezone::update(const char* posix, time_t now) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    if(!this->parsed or this->posix != posix) {
+        this->posix = posix;
+        this->parsed = true;
+        this->valid = parse(posix, this->rule);
+        if(!this->valid)
+            this->rule = Rule();
+        this->build(now);
+        return true;
+    }
+    if(now < this->validFrom or now >= this->validUntil)
+        this->build(now);
+    return false;
+}
+
+int32_t OswTimezone::computeOffset(time_t utc) const {
+    const int64_t year = getYear(utc);
+    Transition all[6];
+    const size_t count = generate(this->rule, year - 1, year + 1, all);
+    int32_t offset = this->rule.standardOffset;
+    for(size_t i = 0; i < count and all[i].at <= utc; i++)
+        offset = all[i].offset;
+    return offset;
+}
+
+int32_t OswTimezone::getOffset(time_t utc) const {
+    std::lock_guard<std::mutex> guard(this->lock);
+    if(!this->rule.hasDst)
+        return this->rule.standardOffset;
+    if(utc < this->validFrom or utc >= this->validUntil)
+        return this->computeOffset(utc);
+    const Transition* end = this->transitions.data() + this->transitionCount;
+    const Transition* next = std::upper_bound(this->transitions.data(), end, utc, [](time_t at, const Transition& t) -> bool { return at < t.at; });
+    return next == this->transitions.data() ? this->initialOffset : (next - 1)->offset;
+}
+
+time_t OswTimezone::getNextTransition(time_t utc) const {
+    std::lock_guard<std::mutex> guard(this->lock);
+    if(!this->rule.hasDst)
+        return std::numeric_limits<time_t>::max();
+    if(utc < this->validFrom or utc >= this->validUntil) {
+        Transition all[6];
+        const size_t count = generate(this->rule, getYear(utc) - 1, getYear(utc) + 1, all);
+        for(size_t i = 0; i < count; i++)
+            if(all[i].at > utc)
+                return all[i].at;
+        return utc + 86400;
+    }
+    const Transition* end = this->transitions.data() + this->transitionCount;
+    const Transition* next = std::upper_bound(this->transitions.data(), end, utc, [](time_t at, const Transition& t) -> bool { return at < t.at; });
+    return next == end ? this->validUntil : next->at;
+}
@@ -0,0 +1,290 @@
+#include <OswWiFiConnector.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <OswLogger.h>
+
+/**
+ * FNV-1a, so the history does not have to store the SSIDs themselves
+ */
+uint32_t OswWiFiConnector::hash(const String& ssid) {
+    uint32_t hash = 2166136261u;
+    for(size_t i = 0; i < ssid.length(); i++) {
+        hash ^= (uint8_t) ssid[i];
+        hash *= 16777619u;
+    }
+    return hash == 0 ? 1 : hash; // 0 marks unused records
+}
+
+void OswWiFiConnector::setNetworks(const std::vector<Network>& networks) {
+    if(this->state != State::IDLE and this->state != State::FAILED)
+        this->disconnect();
+    this->networks.clear();
+    for(const Network& network : networks)
+        if(network.ssid.length() > 0)
+            this->networks.push_back(network);
+    this->candidates.clear();
+    this->hasAttempt = false;
+}
+
+OswWiFiConnector::History::Record* OswWiFiConnector::find(const Network& network) {
+    const uint32_t ssidHash = hash(network.ssid);
+    for(History::Record& record : this->history.records)
+        if(record.ssidHash == ssidHash)
+            return &record;
+    return nullptr;
+}
+
+const OswWiFiConnector::History::Record* OswWiFiConnector::find(const Network& network) const {
+    return const_cast<OswWiFiConnector*>(this)->find(network);
+}
+
+/**
+ * Replaces the record which had its last success the longest time ago, if all are in use
+ */
+OswWiFiConnector::History::Record& OswWiFiConnector::findOrCreate(const Network& network) {
+    History::Record* record = this->find(network);
+    if(record != nullptr)
+        return *record;
+    record = &this->history.records.front();
+    for(History::Record& other : this->history.records)
+        if(other.ssidHash == 0 or other.lastSuccess < record->lastSuccess) {
+            record = &other;
+            if(other.ssidHash == 0)
+                break;
+        }
+    *record = History::Record();
+    record->ssidHash = hash(network.ssid);
+    return *record;
+}
+
+unsigned long OswWiFiConnector::adaptiveTimeout(uint16_t average, unsigned long limit) {
+    if(average == 0)
+        return std::min(defaultTimeout, limit);
+    return std::min(std::max(3ul * average, minTimeout), std::min(maxTimeout, limit));
+}
+
+uint16_t OswWiFiConnector::average(uint16_t average, unsigned long sample) {
+    sample = std::min<unsigned long>(std::max<unsigned long>(sample, 1), std::numeric_limits<uint16_t>::max());
+    if(average == 0)
+        return (uint16_t) sample;
+    return (uint16_t) ((3ul * average + sample) / 4);
+}
+
+unsigned long OswWiFiConnector::getAuthTimeout(const Network& network) const {
+    const History::Record* record = this->find(network);
+    return adaptiveTimeout(record != nullptr ? record->authTime : 0, maxTimeout);
+}
+
+unsigned long OswWiFiConnector::getDhcpTimeout(const Network& network) const {
+    const History::Record* record = this->find(network);
+    return adaptiveTimeout(record != nullptr ? record->dhcpTime : 0, maxTimeout);
+}
+
+const OswWiFiConnector::Network* OswWiFiConnector::getNetwork() const {
+    if(!this->hasAttempt or this->attempting.network >= this->networks.size())
+        return nullptr;
+    return &this->networks[this->attempting.network];
+}
+
+void OswWiFiConnector::connect(unsigned long now) {
+    if(this->state != State::IDLE and this->state != State::FAILED)
+        this->radio.disconnect();
+    this->profile = Profile();
+    this->startedAt = now;
+    this->candidates.clear();
+    this->hasAttempt = false;
+    if(this->networks.empty()) {
+        this->state = State::FAILED;
+        return;
+    }
+
+    // The network of the last success goes first - right to its access point, if that is known
+    const History::Record* last = nullptr;
+    Candidate fast;
+    for(size_t i = 0; i < this->networks.size(); i++) {
+        const History::Record* record = this->find(this->networks[i]);
+        if(record == nullptr or record->channel == 0 or record->successes == 0)
+            continue;
+        if(last == nullptr or record->lastSuccess > last->lastSuccess) {
+            last = record;
+            fast.network = i;
+            fast.found = true;
+            fast.bssid = record->bssid;
+            fast.channel = record->channel;
+        }
+    }
+    if(last != nullptr) {
+        this->profile.fast = true;
+        this->attempt(fast, now);
+    } else
+        this->startScan(now);
+}
+
+void OswWiFiConnector::disconnect() {
+    this->radio.disconnect();
+    this->state = State::IDLE;
+    this->candidates.clear();
+    this->hasAttempt = false;
+}
+
+void OswWiFiConnector::startScan(unsigned long now) {
+    this->state = State::SCANNING;
+    this->phaseAt = now;
+    this->radio.startScan();
+}
+
+/**
+ * Networks seen in the scan first (by their success rate, then the signal), the others (hidden or away) last
+ */
+void OswWiFiConnector::orderCandidates(const std::vector<ScanResult>& results) {
+    this->candidates.clear();
+    for(size_t i = 0; i < this->networks.size(); i++) {
+        Candidate candidate;
+        candidate.network = i;
+        for(const ScanResult& result : results)
+            if(result.ssid == this->networks[i].ssid and (!candidate.found or result.rssi > candidate.rssi)) {
+                candidate.found = true;
+                candidate.bssid = result.bssid;
+                candidate.channel = result.channel;
+                candidate.rssi = result.rssi;
+            }
+        this->candidates.push_back(candidate);
+    }
+    auto successRate = [this](const Candidate& candidate) -> float {
+        const History::Record* record = this->find(this->networks[candidate.network]);
+        if(record == nullptr)
+            return 0.5f;
+        return (record->successes + 1.0f) / (record->successes + record->failures + 2.0f);
+    };
+    std::stable_sort(this->candidates.begin(), this->candidates.end(), [&](const Candidate& a, const Candidate& b) -> bool {
+        if(a.found != b.found)
+            return a.found;
+        const float rateA = successRate(a);
+        const float rateB = successRate(b);
+        if(rateA != rateB)
+            return rateA > rateB;
+        return a.found and a.rssi > b.rssi;
+    });
+    std::reverse(this->candidates.begin(), this->candidates.end());
+}
+
+void OswWiFiConnector::attempt(const Candidate& candidate, unsigned long now) {
+    this->attempting = candidate;
+    this->hasAttempt = true;
+    ++this->profile.attempts;
+    const Network& network = this->networks[candidate.network];
+    this->radio.begin(network, candidate.found ? candidate.channel : 0, candidate.found ? candidate.bssid.data() : nullptr);
+    this->phaseAt = now;
+    if(this->profile.fast and this->profile.attempts == 1) {
+        this->state = State::FAST_CONNECTING;
+        this->timeout = std::min(this->getAuthTimeout(network), fastTimeout);
+    } else {
+        this->state = State::CONNECTING;
+        this->timeout = this->getAuthTimeout(network);
+    }
+}
+
+void OswWiFiConnector::tryNext(unsigned long now) {
+    if(this->candidates.empty()) {
+        this->radio.disconnect();
+        this->state = State::FAILED;
+        this->hasAttempt = false;
+        this->profile.total = now - this->startedAt;
+        return;
+    }
+    const Candidate next = this->candidates.back();
+    this->candidates.pop_back();
+    this->attempt(next, now);
+}
+
+void OswWiFiConnector::fail(unsigned long now) {
+    History::Record& record = this->findOrCreate(this->networks[this->attempting.network]);
+    this->radio.disconnect();
+    if(this->profile.fast and this->profile.attempts == 1) {
+        // The access point may be gone (or moved to another channel), the scan finds the current one
+        OSW_LOG_D("[Client] Remembered access point of \"", this->networks[this->attempting.network].ssid, "\" failed, scanning...");
+        record.channel = 0;
+        this->startScan(now);
+        return;
+    }
+    if(record.failures == std::numeric_limits<uint16_t>::max()) {
+        record.successes /= 2;
+        record.failures /= 2;
+    }
+    ++record.failures;
+    this->tryNext(now);
+}
+
+void OswWiFiConnector::succeed(unsigned long now) {
+    History::Record& record = this->findOrCreate(this->networks[this->attempting.network]);
+    if(record.successes == std::numeric_limits<uint16_t>::max()) {
+        record.successes /= 2;
+        record.failures /= 2;
+    }
+    ++record.successes;
+    if(!this->radio.getAccessPoint(record.bssid, record.channel)) {
+        record.bssid = this->attempting.bssid;
+        record.channel = this->attempting.found ? this->attempting.channel : 0;
+    }
+    record.authTime = average(record.authTime, this->profile.auth);
+    record.dhcpTime = average(record.dhcpTime, this->profile.dhcp);
+    record.lastSuccess = ++this->history.connections;
+    this->candidates.clear();
+    this->state = State::CONNECTED;
+    this->connectedAt = now;
+    this->profile.total = now - this->startedAt;
+}
+
+void OswWiFiConnector::loop(unsigned long now) {
+    switch(this->state) {
+    case State::IDLE:
+    case State::FAILED:
+        break;
+    case State::SCANNING: {
+        std::vector<ScanResult> results;
+        const bool done = this->radio.getScanResults(results);
+        if(done or now - this->phaseAt >= scanTimeout) {
+            this->profile.scan = now - this->phaseAt;
+            this->orderCandidates(results);
+            this->tryNext(now);
+        }
+        break;
+    }
+    case State::FAST_CONNECTING:
+    case State::CONNECTING: {
+        const Radio::Status status = this->radio.getStatus();
+        if(status == Radio::Status::ASSOCIATED or status == Radio::Status::CONNECTED) {
+            this->profile.auth = now - this->phaseAt;
+            this->phaseAt = now;
+            this->timeout = this->getDhcpTimeout(this->networks[this->attempting.network]);
+            this->state = State::OBTAINING_IP;
+            if(status == Radio::Status::CONNECTED)
+                this->succeed(now); // Both at once, the DHCP took no measurable time
+        } else if(status == Radio::Status::NOT_FOUND or status == Radio::Status::FAILED or now - this->phaseAt >= this->timeout)
+            this->fail(now);
+        break;
+    }
+    case State::OBTAINING_IP: {
+        const Radio::Status status = this->radio.getStatus();
+        if(status == Radio::Status::CONNECTED) {
+            this->profile.dhcp = now - this->phaseAt;
+            this->succeed(now);
+        } else if(status == Radio::Status::IDLE or status == Radio::Status::NOT_FOUND or status == Radio::Status::FAILED or now - this->phaseAt >= this->timeout)
+            this->fail(now);
+        break;
+    }
+    case State::CONNECTED:
+        if(this->radio.getStatus() != Radio::Status::CONNECTED) {
+            OSW_LOG_D("[Client] Connection to \"", this->networks[this->attempting.network].ssid, "\" lost, reconnecting...");
+            this->connect(now);
+        }
+        break;
+    }
+}
+
+void OswWiFiConnector::noteTimeSynchronized(unsigned long now) {
+    if(this->state == State::CONNECTED and this->profile.ntp == 0)
+        this->profile.ntp = std::max(now - this->connectedAt, 1ul);
+}
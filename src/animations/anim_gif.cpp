@@ -0,0 +1,518 @@
+#include "animations/anim_gif.h"
+
+#include <string.h>
+
+#include "gfx_2d.h"
+#include "gfx_util.h"
+
+bool GifDecoder::open(const uint8_t* data_, size_t size_) {
+    data = data_;
+    size = size_;
+    pos = 0;
+    pendingImageData = false;
+    if (data == NULL || size < 13 || memcmp(data, "GIF8", 4) != 0) {
+        data = NULL;
+        return false;
+    }
+
+    // Logical screen descriptor
+    pos = 6;
+    width = readWord();
+    height = readWord();
+    uint8_t packed = readByte();
+    backgroundIndex = readByte();
+    readByte(); // Pixel aspect ratio
+    globalPalette.fill(0);
+    if (packed & 0x80) {
+        readPalette(globalPalette, 2 << (packed & 0x07));
+    }
+    if (width == 0 || height == 0 || pos >= size) {
+        data = NULL;
+        return false;
+    }
+    firstFramePos = pos;
+    return true;
+}
+
+void GifDecoder::rewind() {
+    pos = firstFramePos;
+    pendingImageData = false;
+}
+
+void GifDecoder::readPalette(std::array<uint16_t, 256>& palette, uint16_t colors) {
+    for (uint16_t i = 0; i < colors; i++) {
+        uint8_t red = readByte();
+        uint8_t green = readByte();
+        uint8_t blue = readByte();
+        palette[i] = rgb565(red, green, blue);
+    }
+}
+
+void GifDecoder::skipSubBlocks() {
+    for (uint8_t length = readByte(); length != 0 && pos < size; length = readByte()) {
+        pos += length;
+    }
+}
+
+bool GifDecoder::nextFrame(Frame& frame) {
+    if (data == NULL) {
+        return false;
+    }
+    if (pendingImageData) {
+        readByte(); // LZW minimum code size
+        skipSubBlocks();
+        pendingImageData = false;
+    }
+
+    Frame next = {};
+    next.transparent = -1;
+    while (pos < size) {
+        uint8_t block = readByte();
+        if (block == 0x21) {
+            uint8_t label = readByte();
+            if (label == 0xF9) {
+                // Graphic control extension, applies to the next image
+                uint8_t length = readByte();
+                size_t end = pos + length;
+                uint8_t packed = readByte();
+                next.delay = readWord() * 10;
+                uint8_t transparent = readByte();
+                next.disposal = (packed >> 2) & 0x07;
+                next.transparent = (packed & 0x01) ? transparent : -1;
+                pos = end;
+            }
+            skipSubBlocks(); // Comments, application extensions (looping) and plain text are ignored
+        } else if (block == 0x2C) {
+            next.x = readWord();
+            next.y = readWord();
+            next.width = readWord();
+            next.height = readWord();
+            uint8_t packed = readByte();
+            next.interlaced = packed & 0x40;
+            hasLocalPalette = packed & 0x80;
+            if (hasLocalPalette) {
+                readPalette(localPalette, 2 << (packed & 0x07));
+            }
+            if (pos >= size || next.width == 0 || next.height == 0) {
+                return false;
+            }
+            // Like the browsers do, frames without (or with a tiny) delay are played at 10 FPS
+            if (next.delay < 20) {
+                next.delay = 100;
+            }
+            current = next;
+            frame = next;
+            pendingImageData = true;
+            return true;
+        } else {
+            return false; // Trailer (or garbage)
+        }
+    }
+    return false;
+}
+
+int32_t GifDecoder::readCode(uint8_t codeSize) {
+    while (bitCount < codeSize) {
+        if (pos >= blockEnd) {
+            uint8_t length = readByte();
+            if (length == 0 || pos >= size) {
+                blockTerminated = true;
+                return -1;
+            }
+            blockEnd = pos + length;
+        }
+        if (pos >= size) {
+            blockTerminated = true;
+            return -1;
+        }
+        bitBuffer |= (uint32_t)data[pos++] << bitCount;
+        bitCount += 8;
+    }
+    int32_t code = bitBuffer & ((1 << codeSize) - 1);
+    bitBuffer >>= codeSize;
+    bitCount -= codeSize;
+    return code;
+}
+
+bool GifDecoder::decodeFrame(const std::function<void(uint16_t row, const uint8_t* indices)>& row) {
+    if (!pendingImageData) {
+        return false;
+    }
+    pendingImageData = false;
+
+    uint8_t minCodeSize = readByte();
+    if (minCodeSize < 1 || minCodeSize > 8) {
+        skipSubBlocks();
+        return false;
+    }
+    blockEnd = pos;
+    blockTerminated = false;
+    bitBuffer = 0;
+    bitCount = 0;
+    rowBuffer.resize(current.width);
+
+    // Rows are stored in four passes when interlaced
+    static const uint8_t passStart[] = {0, 4, 2, 1};
+    static const uint8_t passStep[] = {8, 8, 4, 2};
+    uint8_t pass = 0;
+    uint16_t x = 0;
+    uint16_t y = 0;
+    uint16_t rowsDone = 0;
+    auto emit = [&](uint8_t index) {
+        rowBuffer[x++] = index;
+        if (x < current.width) {
+            return true;
+        }
+        row(y, rowBuffer.data());
+        x = 0;
+        if (++rowsDone == current.height) {
+            return false;
+        }
+        if (current.interlaced) {
+            y += passStep[pass];
+            while (y >= current.height && pass < 3) {
+                y = passStart[++pass];
+            }
+        } else {
+            ++y;
+        }
+        return true;
+    };
+
+    const uint16_t clear = 1 << minCodeSize;
+    const uint16_t end = clear + 1;
+    uint8_t codeSize = minCodeSize + 1;
+    uint16_t next = clear + 2;
+    int32_t old = -1;
+    uint8_t first = 0;
+    bool valid = true;
+    while (true) {
+        int32_t code = readCode(codeSize);
+        if (code < 0) {
+            valid = false; // Truncated
+            break;
+        }
+        if (code == clear) {
+            codeSize = minCodeSize + 1;
+            next = clear + 2;
+            old = -1;
+            continue;
+        }
+        if (code == end) {
+            break;
+        }
+
+        uint16_t depth = 0;
+        if (old < 0) {
+            if (code > clear) {
+                valid = false;
+                break;
+            }
+            first = code;
+            stack[depth++] = code;
+        } else {
+            uint16_t c = code;
+            if (code >= next) {
+                if (code > next) {
+                    valid = false;
+                    break;
+                }
+                stack[depth++] = first; // The string of the previous code, followed by its own first index
+                c = old;
+            }
+            while (c > end) {
+                stack[depth++] = suffix[c];
+                c = prefix[c];
+            }
+            first = c;
+            stack[depth++] = c;
+            if (next < maxCodes) {
+                prefix[next] = old;
+                suffix[next] = first;
+                ++next;
+                if (next == (1 << codeSize) && codeSize < 12) {
+                    ++codeSize;
+                }
+            }
+        }
+        old = code;
+
+        bool more = true;
+        while (depth > 0 && more) {
+            more = emit(stack[--depth]);
+        }
+        if (!more) {
+            break; // All pixels are there, anything else is padding
+        }
+    }
+
+    if (!blockTerminated) {
+        pos = blockEnd;
+        skipSubBlocks();
+    }
+    return valid;
+}
+
+AnimGif::AnimGif(const uint8_t* data, size_t size, bool allocatePsram_) : allocatePsram(allocatePsram_) {
+    if (decoder.open(data, size)) {
+        canvas = allocateCanvas();
+    }
+    if (canvas != NULL) {
+        restart();
+    }
+}
+
+AnimGif::~AnimGif() {
+    freeCanvas(canvas);
+}
+
+uint16_t* AnimGif::allocateCanvas() {
+    size_t bytes = (size_t)getWidth() * getHeight() * sizeof(uint16_t);
+    if (allocatePsram) {
+#if defined(GPS_EDITION) || defined(GPS_EDITION_ROTATED)
+        return (uint16_t*)ps_malloc(bytes);
+#endif
+    }
+    return (uint16_t*)malloc(bytes);
+}
+
+void AnimGif::freeCanvas(uint16_t* buffer) {
+    free(buffer);
+}
+
+AnimGif::Rect AnimGif::unite(const Rect& a, const Rect& b) {
+    if (a.width == 0 || a.height == 0) {
+        return b;
+    }
+    if (b.width == 0 || b.height == 0) {
+        return a;
+    }
+    uint16_t x0 = a.x < b.x ? a.x : b.x;
+    uint16_t y0 = a.y < b.y ? a.y : b.y;
+    uint16_t x1 = a.x + a.width > b.x + b.width ? a.x + a.width : b.x + b.width;
+    uint16_t y1 = a.y + a.height > b.y + b.height ? a.y + a.height : b.y + b.height;
+    return {x0, y0, (uint16_t)(x1 - x0), (uint16_t)(y1 - y0)};
+}
+
+AnimGif::Rect AnimGif::clip(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+    if (x >= getWidth() || y >= getHeight()) {
+        return {};
+    }
+    if (x + width > getWidth()) {
+        width = getWidth() - x;
+    }
+    if (y + height > getHeight()) {
+        height = getHeight() - y;
+    }
+    return {x, y, width, height};
+}
+
+/**
+ * @brief Clear the canvas and play from the first frame again.
+ */
+void AnimGif::restart() {
+    decoder.rewind();
+    uint16_t background = decoder.getBackgroundColor();
+    for (size_t i = (size_t)getWidth() * getHeight(); i > 0; --i) {
+        canvas[i - 1] = background;
+    }
+    previous = {};
+    previousPixels.clear();
+    cacheFrame = 0;
+    dirty = {0, 0, getWidth(), getHeight()};
+    started = false;
+}
+
+uint16_t AnimGif::decodeFrame() {
+    GifDecoder::Frame frame;
+    Rect changed = {};
+    if (!decoder.nextFrame(frame)) {
+        restart(); // Loop
+        changed = dirty;
+        if (!decoder.nextFrame(frame)) {
+            return 1000; // Nothing to play
+        }
+    }
+
+    // Dispose of the previous frame
+    Rect disposed = clip(previous.x, previous.y, previous.width, previous.height);
+    if (previous.disposal == 2) {
+        uint16_t background = decoder.getBackgroundColor();
+        for (uint16_t y = disposed.y; y < disposed.y + disposed.height; y++) {
+            for (uint16_t x = disposed.x; x < disposed.x + disposed.width; x++) {
+                canvas[y * getWidth() + x] = background;
+            }
+        }
+        changed = unite(changed, disposed);
+    } else if (previous.disposal == 3 && previousPixels.size() == (size_t)disposed.width * disposed.height) {
+        for (uint16_t y = 0; y < disposed.height; y++) {
+            memcpy(canvas + (disposed.y + y) * getWidth() + disposed.x, previousPixels.data() + y * disposed.width, disposed.width * sizeof(uint16_t));
+        }
+        changed = unite(changed, disposed);
+    }
+
+    Rect area = clip(frame.x, frame.y, frame.width, frame.height);
+    if (frame.disposal == 3) {
+        previousPixels.resize((size_t)area.width * area.height);
+        for (uint16_t y = 0; y < area.height; y++) {
+            memcpy(previousPixels.data() + y * area.width, canvas + (area.y + y) * getWidth() + area.x, area.width * sizeof(uint16_t));
+        }
+    }
+
+    const uint16_t* palette = decoder.getPalette();
+    decoder.decodeFrame([&](uint16_t row, const uint8_t* indices) {
+        if (row >= area.height) {
+            return;
+        }
+        uint16_t* target = canvas + (area.y + row) * getWidth() + area.x;
+        for (uint16_t x = 0; x < area.width; x++) {
+            if (indices[x] != frame.transparent) {
+                target[x] = palette[indices[x]];
+            }
+        }
+    });
+
+    previous = frame;
+    dirty = unite(changed, area);
+    return frame.delay;
+}
+
+uint16_t AnimGif::replayFrame() {
+    const CachedFrame& frame = cacheFrames[cacheFrame];
+    cacheFrame = (cacheFrame + 1) % cacheFrames.size();
+    const uint16_t* span = cacheData.data() + frame.offset;
+    const uint16_t* end = span + frame.length;
+    while (span < end) {
+        uint16_t length = span[2];
+        memcpy(canvas + span[0] * getWidth() + span[1], span + 3, length * sizeof(uint16_t));
+        span += 3 + length;
+    }
+    dirty = frame.dirty;
+    return frame.delay;
+}
+
+bool AnimGif::update(unsigned long now) {
+    if (!isValid()) {
+        return false;
+    }
+    if (started && (long)(now - nextFrameAt) < 0) {
+        dirty = {};
+        return false;
+    }
+
+    unsigned long start = micros();
+    uint16_t delay = hasCache() ? replayFrame() : decodeFrame();
+    lastFrameTime = micros() - start;
+    frameTime += lastFrameTime;
+    ++frameCount;
+
+    // Keep the pace of the animation, unless it fell behind by more than a frame
+    if (started && now - nextFrameAt < delay) {
+        nextFrameAt += delay;
+    } else {
+        nextFrameAt = now + delay;
+    }
+    started = true;
+    return dirty.width > 0 && dirty.height > 0;
+}
+
+void AnimGif::draw(Graphics2D* gfx, int16_t x, int16_t y, bool onlyDirty) {
+    if (!isValid()) {
+        return;
+    }
+    Rect area = onlyDirty ? dirty : Rect{0, 0, getWidth(), getHeight()};
+    for (uint16_t row = area.y; row < area.y + area.height; row++) {
+        gfx->drawSpan(x + area.x, y + row, canvas + row * getWidth() + area.x, area.width);
+    }
+}
+
+bool AnimGif::enableCache(size_t maxBytes) {
+    disableCache();
+    if (!isValid()) {
+        return false;
+    }
+
+    // The first frame is stored as the difference to the last one, so a whole loop is played ahead
+    size_t frames = 0;
+    GifDecoder::Frame frame;
+    decoder.rewind();
+    while (decoder.nextFrame(frame)) {
+        ++frames;
+    }
+    if (frames == 0) {
+        restart();
+        return false;
+    }
+    uint16_t* reference = allocateCanvas();
+    if (reference == NULL) {
+        restart();
+        return false;
+    }
+    restart();
+    for (size_t i = 0; i < frames; i++) {
+        decodeFrame();
+    }
+    memcpy(reference, canvas, (size_t)getWidth() * getHeight() * sizeof(uint16_t));
+
+    // Spans are continued across a few unchanged pixels, as every span costs three words on its own
+    const uint16_t spanGap = 3;
+    bool fits = true;
+    for (size_t i = 0; i < frames && fits; i++) {
+        CachedFrame cached = {(uint32_t)cacheData.size(), 0, {}, decodeFrame()};
+        // Nothing outside of the dirty rectangle has changed
+        for (uint16_t y = dirty.y; y < dirty.y + dirty.height; y++) {
+            uint16_t* now = canvas + y * getWidth();
+            uint16_t* before = reference + y * getWidth();
+            uint16_t x = dirty.x;
+            while (x < dirty.x + dirty.width) {
+                if (now[x] == before[x]) {
+                    ++x;
+                    continue;
+                }
+                uint16_t start = x;
+                uint16_t last = x;
+                while (x < dirty.x + dirty.width && x - last <= spanGap) {
+                    if (now[x] != before[x]) {
+                        last = x;
+                    }
+                    ++x;
+                }
+                uint16_t length = last - start + 1;
+                cacheData.push_back(y);
+                cacheData.push_back(start);
+                cacheData.push_back(length);
+                cacheData.insert(cacheData.end(), now + start, now + start + length);
+                memcpy(before + start, now + start, length * sizeof(uint16_t));
+                cached.dirty = unite(cached.dirty, {start, y, length, 1});
+                x = last + 1;
+            }
+        }
+        cached.length = cacheData.size() - cached.offset;
+        cacheFrames.push_back(cached);
+        fits = getCacheSize() <= maxBytes;
+    }
+    freeCanvas(reference);
+
+    if (!fits) {
+        disableCache();
+        return false;
+    }
+    cacheData.shrink_to_fit();
+    cacheFrames.shrink_to_fit();
+    // The canvas holds the last frame again, which is where the cache starts
+    cacheFrame = 0;
+    dirty = {0, 0, getWidth(), getHeight()};
+    started = false;
+    return true;
+}
+
+void AnimGif::disableCache() {
+    bool hadCache = hasCache();
+    cacheData.clear();
+    cacheData.shrink_to_fit();
+    cacheFrames.clear();
+    cacheFrames.shrink_to_fit();
+    if (hadCache && isValid()) {
+        restart();
+    }
+}
@@ -0,0 +1,208 @@
+#include "animations/anim_particles.h"
+
+#include "gfx_2d.h"
+#include "gfx_util.h"
+
+ParticleSystem::ParticleSystem(uint16_t capacity, uint8_t ramps, uint8_t rampLength)
+    : capacity(capacity), x(capacity), y(capacity), speedX(capacity), speedY(capacity), age(capacity), life(capacity),
+      rampStep(capacity), ramp(capacity), rampLength(rampLength > 0 ? rampLength : 1), rampColors(ramps * this->rampLength),
+      pixelX(capacity), pixelY(capacity), pixelColors(capacity) {}
+
+void ParticleSystem::setRamp(uint8_t ramp, const uint16_t* colors) {
+    for (uint8_t i = 0; i < rampLength; i++) {
+        rampColors[ramp * rampLength + i] = colors[i];
+    }
+}
+
+void ParticleSystem::setFadeRamp(uint8_t ramp, uint16_t from, uint16_t to) {
+    const uint8_t steps = rampLength > 1 ? rampLength - 1 : 1;
+    for (uint8_t i = 0; i < rampLength; i++) {
+        rampColors[ramp * rampLength + i] = blend(from, to, (uint8_t) (i * 255 / steps));
+    }
+}
+
+bool ParticleSystem::spawn(fixed x, fixed y, fixed speedX, fixed speedY, uint16_t life, uint8_t ramp) {
+    if (count == capacity) {
+        return false;
+    }
+    this->x[count] = x;
+    this->y[count] = y;
+    this->speedX[count] = speedX;
+    this->speedY[count] = speedY;
+    this->age[count] = 0;
+    this->life[count] = life;
+    // Rounded up, so the last color is reached exactly at the end of the life
+    this->rampStep[count] = life > 0 ? (((uint32_t) (rampLength - 1) << 24) + life - 1) / life : 0;
+    this->ramp[count] = ramp;
+    ++count;
+    return true;
+}
+
+uint16_t ParticleSystem::emit(const Emitter& emitter, uint16_t count) {
+    uint16_t spawned = 0;
+    for (; spawned < count; spawned++) {
+        const float angle = random(emitter.angleFrom, emitter.angleTo + 1) * (PI / 180.0f);
+        const fixed speed = emitter.speedFrom + multiply(emitter.speedTo - emitter.speedFrom, random(0x10000));
+        fixed x = emitter.x;
+        fixed y = emitter.y;
+        if (emitter.spread > 0) {
+            x += multiply(emitter.spread, random(-0x10000, 0x10000));
+            y += multiply(emitter.spread, random(-0x10000, 0x10000));
+        }
+        const uint16_t life = emitter.lifeFrom + random(emitter.lifeTo - emitter.lifeFrom + 1);
+        if (!spawn(x, y, multiply(speed, toFixed(cosf(angle))), multiply(speed, toFixed(sinf(angle))), life, emitter.ramp)) {
+            break;
+        }
+    }
+    return spawned;
+}
+
+uint8_t ParticleSystem::addEmitter(const Emitter& emitter) {
+    emitters.push_back(emitter);
+    emitterCarry.push_back(0);
+    return emitters.size() - 1;
+}
+
+void ParticleSystem::removeEmitters() {
+    emitters.clear();
+    emitterCarry.clear();
+}
+
+void ParticleSystem::clear() {
+    count = 0;
+}
+
+void ParticleSystem::reset(uint16_t i, fixed x, fixed y, fixed speedX, fixed speedY) {
+    this->x[i] = x;
+    this->y[i] = y;
+    this->speedX[i] = speedX;
+    this->speedY[i] = speedY;
+    this->age[i] = 0;
+}
+
+void ParticleSystem::kill(uint16_t i) {
+    // The last one takes its place
+    --count;
+    x[i] = x[count];
+    y[i] = y[count];
+    speedX[i] = speedX[count];
+    speedY[i] = speedY[count];
+    age[i] = age[count];
+    life[i] = life[count];
+    rampStep[i] = rampStep[count];
+    ramp[i] = ramp[count];
+}
+
+void ParticleSystem::update(uint16_t ms) {
+    const fixed dt = toFixed((int32_t) ms) / 1000;
+    const fixed accelerationX = multiply(gravityX, dt);
+    const fixed accelerationY = multiply(gravityY, dt);
+    fixed damping = toFixed(1) - multiply(drag, dt);
+    if (damping < 0) {
+        damping = 0;
+    }
+    const fixed left = toFixed(bounds.x);
+    const fixed top = toFixed(bounds.y);
+    const fixed right = toFixed(bounds.x + bounds.width);
+    const fixed bottom = toFixed(bounds.y + bounds.height);
+
+    for (uint16_t i = 0; i < count;) {
+        age[i] = age[i] + ms < UINT16_MAX ? age[i] + ms : UINT16_MAX;
+        if (life[i] > 0 && age[i] >= life[i]) {
+            kill(i);
+            continue;  // Now i is the former last particle
+        }
+        if (drag != 0) {
+            speedX[i] = multiply(speedX[i], damping);
+            speedY[i] = multiply(speedY[i], damping);
+        }
+        speedX[i] += accelerationX;
+        speedY[i] += accelerationY;
+        x[i] += multiply(speedX[i], dt);
+        y[i] += multiply(speedY[i], dt);
+
+        if (edges == Edges::KILL) {
+            if (x[i] < left || x[i] >= right || y[i] < top || y[i] >= bottom) {
+                kill(i);
+                continue;
+            }
+        } else if (edges == Edges::WRAP) {
+            if (x[i] < left) {
+                x[i] += right - left;
+            } else if (x[i] >= right) {
+                x[i] -= right - left;
+            }
+            if (y[i] < top) {
+                y[i] += bottom - top;
+            } else if (y[i] >= bottom) {
+                y[i] -= bottom - top;
+            }
+        }
+        ++i;
+    }
+
+    for (size_t e = 0; e < emitters.size(); e++) {
+        emitterCarry[e] += (uint32_t) emitters[e].rate * ms;
+        emit(emitters[e], emitterCarry[e] / 1000);
+        emitterCarry[e] %= 1000;
+    }
+}
+
+void ParticleSystem::draw(Graphics2D* gfx, int16_t offsetX, int16_t offsetY) {
+    int16_t minX = INT16_MAX;
+    int16_t minY = INT16_MAX;
+    int16_t maxX = INT16_MIN;
+    int16_t maxY = INT16_MIN;
+    for (uint16_t i = 0; i < count; i++) {
+        const int16_t px = toInt(x[i]) + offsetX;
+        const int16_t py = toInt(y[i]) + offsetY;
+        uint32_t step = ((uint64_t) age[i] * rampStep[i]) >> 24;
+        if (step >= rampLength) {
+            step = rampLength - 1;
+        }
+        pixelX[i] = px;
+        pixelY[i] = py;
+        pixelColors[i] = rampColors[ramp[i] * rampLength + step];
+        minX = px < minX ? px : minX;
+        minY = py < minY ? py : minY;
+        maxX = px > maxX ? px : maxX;
+        maxY = py > maxY ? py : maxY;
+    }
+    gfx->drawPixels(pixelX.data(), pixelY.data(), pixelColors.data(), count);
+
+    if (count > 0) {
+        drawnBounds = {minX, minY, (uint16_t) (maxX - minX + 1), (uint16_t) (maxY - minY + 1)};
+    } else {
+        drawnBounds = {};
+    }
+    trailCurrent = unite(trailCurrent, drawnBounds);
+}
+
+void ParticleSystem::fadeTrails(Graphics2D* gfx, uint8_t amount) {
+    if (amount == 0) {
+        return;
+    }
+    // dimColor() takes amount from red and blue (and twice that from green), which are at most 248
+    const uint8_t framesToBlack = (248 + amount - 1) / amount;
+    if (++trailFrames >= framesToBlack) {
+        trailPrevious = trailCurrent;
+        trailCurrent = {};
+        trailFrames = 0;
+    }
+    const Rect area = unite(trailPrevious, trailCurrent);
+    gfx->dimArea(area.x, area.y, area.width, area.height, amount);
+}
+
+ParticleSystem::Rect ParticleSystem::unite(const Rect& a, const Rect& b) {
+    if (a.width == 0 || a.height == 0) {
+        return b;
+    }
+    if (b.width == 0 || b.height == 0) {
+        return a;
+    }
+    const int16_t left = a.x < b.x ? a.x : b.x;
+    const int16_t top = a.y < b.y ? a.y : b.y;
+    const int32_t right = a.x + a.width > b.x + b.width ? a.x + a.width : b.x + b.width;
+    const int32_t bottom = a.y + a.height > b.y + b.height ? a.y + a.height : b.y + b.height;
+    return {left, top, (uint16_t) (right - left), (uint16_t) (bottom - top)};
+}
@@ -257,6 +257,13 @@ const OswAppV2::ViewFlags& OswAppDrawer::getViewFlags() {
         return OswAppV2::getViewFlags();
 }
 
+uint8_t OswAppDrawer::getCpuFrequency() {
+    if(this->current)
+        return this->current->get()->getCpuFrequency(); // forward to the current app
+    else
+        return OswAppV2::getCpuFrequency();
+}
+
 bool OswAppDrawer::getNeedsRedraw() {
     if(this->current)
         return OswAppV2::getNeedsRedraw() or this->current->get()->getNeedsRedraw(); // still respect the redraw of the drawers overlays
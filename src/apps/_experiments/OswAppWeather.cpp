@@ -90,7 +90,7 @@ int OswAppWeather::WeatherDecoder::_str2wthr(const String& weather) {
 
 OswAppWeather::WeatherParser::WeatherParser() {}
 
-std::optional<String> OswAppWeather::WeatherParser::encodeWeather(DynamicJsonDocument& doc) {
+std::optional<String> OswAppWeather::WeatherParser::encodeWeather(OswJsonDocument& doc) {
     const char* code = nullptr;
     code = doc["cod"];
     if(strcmp("200",code)) {
@@ -259,7 +259,7 @@ bool OswAppWeather::_request() {
         this->dataLoaded = false;
         return false;
     }
-    DynamicJsonDocument doc(16432);
+    OswJsonDocument doc(16432);
     deserializeJson(doc,http.getStream());
     WeatherParser pars;
     std::optional<String> encoded = pars.encodeWeather(doc);
@@ -382,7 +382,7 @@ bool OswAppWeather::loadData() {
         std::string strW = strStream.str();
         OSW_LOG_D("json file raw:");
         OSW_LOG_D(strW);
-        DynamicJsonDocument doc(16432*2);// when in emulator more space is needed
+        OswJsonDocument doc(16432*2);// when in emulator more space is needed
         deserializeJson(doc,strW);
         WeatherParser pars;
         std::optional<String> encoded = pars.encodeWeather(doc);
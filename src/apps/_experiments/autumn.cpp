@@ -1,6 +1,7 @@
 
 #include "./apps/_experiments/autumn.h"
 
+#include <animations/anim_particles.h>
 #include <animations/anim_water_ripple.h>
 #include <gfx_util.h>
 #include <OswAppV1.h>
@@ -18,15 +19,9 @@ int8_t wbuf1[WATER_W * WATER_H];
 int8_t wbuf2[WATER_W * WATER_H];
 
 uint16_t maskColor = rgb565(255, 255, 255);
-int16_t lx1 = 30 + random(20), ly1 = 30 + (-30 + random(60));
-int16_t lx2 = 80 + random(20), ly2 = 30 + (-30 + random(60));
-int16_t lx3 = 30 + random(20), ly3 = 80 + (-30 + random(60));
-int16_t lx4 = 80 + random(10), ly4 = 80 + (-30 + random(60));
-
-int8_t mx1 = -3 + random(5), my1 = -3 + random(5);
-int8_t mx2 = -3 + random(5), my2 = -3 + random(5);
-int8_t mx3 = -3 + random(5), my3 = -3 + random(5);
-int8_t mx4 = -3 + random(5), my4 = -3 + random(5);
+// The leaves drift over the water and come back on the other side
+ParticleSystem leaves(4);
+unsigned long lastLoop = 0;
 
 // this is dirty:
 
@@ -60,48 +55,27 @@ void OswAppAutumn::setup() {
     hal->loadPNGfromSD(leaf2, "/leaf3.png");
     hal->loadPNGfromSD(leaf3, "/leaf4.png");
     waterBackground->enableMask(maskColor);
+
+    // A leaf moved by -3..1 px every 10 frames (at roughly 30 fps)
+    leaves.clear();
+    leaves.edges = ParticleSystem::Edges::WRAP;
+    leaves.bounds = {-16, -16, WATER_W + 32, WATER_H + 32};
+    const int16_t startX[] = {30, 80, 30, 80};
+    const int16_t startY[] = {30, 30, 80, 80};
+    for (uint8_t i = 0; i < 4; i++) {
+        leaves.spawn(ParticleSystem::toFixed((int32_t) (startX[i] + random(20))), ParticleSystem::toFixed((int32_t) (startY[i] - 30 + random(60))),
+                     ParticleSystem::toFixed((int32_t) (-3 + random(5))) * 3, ParticleSystem::toFixed((int32_t) (-3 + random(5))) * 3, 0);
+    }
+    lastLoop = millis();
 }
 
 void OswAppAutumn::loop() {
     static uint16_t counter = 0;
     counter++;
 
-    if (counter % 10 == 0) {
-        // this is ugly and not object oriented...
-        lx1 += mx1;
-        ly1 += my1;
-        lx2 += mx2;
-        ly2 += my2;
-        lx3 += mx3;
-        ly3 += my3;
-        lx4 += mx4;
-        ly4 += my4;
-
-        if (lx1 < -16) {
-            lx1 = 120 + 16;
-        }
-        if (ly1 < -16) {
-            ly1 = 120 + 16;
-        }
-        if (lx2 < -16) {
-            lx2 = 120 + 16;
-        }
-        if (ly2 < -16) {
-            ly2 = 120 + 16;
-        }
-        if (lx3 < -16) {
-            lx3 = 120 + 16;
-        }
-        if (ly3 < -16) {
-            ly3 = 120 + 16;
-        }
-        if (lx4 < -16) {
-            lx4 = 120 + 16;
-        }
-        if (ly4 < -16) {
-            ly4 = 120 + 16;
-        }
-    }
+    const unsigned long now = millis();
+    leaves.update(now - lastLoop);
+    lastLoop = now;
 
     if (counter % 5 == 0) {
         uint16_t r1 = random(WATER_W - 4);
@@ -118,10 +92,11 @@ void OswAppAutumn::loop() {
     waterBackground->fillFrame(0, 0, 240, 240, rgb565(1 << 4, 1 << 4, 1 << 4));
 
     // gfx2d.enableAlpha(.5);
-    waterBackground->drawGraphics2D_rotated(lx1, ly1, leaf0, 16, 16, counter / 50.0);
-    waterBackground->drawGraphics2D_rotated(lx2, ly2, leaf1, 16, 16, -counter / 50.0);
-    waterBackground->drawGraphics2D_rotated(lx3, ly3, leaf2, 16, 16, counter / 50.0);
-    waterBackground->drawGraphics2D_rotated(lx4, ly4, leaf3, 16, 16, -counter / 50.0);
+    Graphics2D* leafImages[] = {leaf0, leaf1, leaf2, leaf3};
+    for (uint8_t i = 0; i < leaves.getCount(); i++) {
+        waterBackground->drawGraphics2D_rotated(ParticleSystem::toInt(leaves.getX(i)), ParticleSystem::toInt(leaves.getY(i)), leafImages[i], 16, 16,
+                                                (i % 2 == 0 ? counter : -counter) / 50.0);
+    }
     // gfx2d.disableAlpha();
 
     calcWater(wbuf1, wbuf2, WATER_W, WATER_H, .9);
@@ -1,63 +1,77 @@
 
 #include "./apps/_experiments/fireworks.h"
 
-#include <animations/anim_firework.h>
 #include <gfx_util.h>
-#include <OswAppV1.h>
 #include <osw_hal.h>
 
-// OswAppHelloWorld::OswAppHelloWorld(void) : OswApp() {}
-#define NUM_FIREWORKS 10
-Firework fireworks[NUM_FIREWORKS];
-int16_t offsets[NUM_FIREWORKS];
+OswAppFireworks::OswAppFireworks(): OswAppGame(tickTime) {
+    for (uint8_t i = 0; i < numFireworks; i++)
+        this->sprites[i] = this->layer.addSprite();
+}
+
+const char* OswAppFireworks::getAppId() {
+    return "osw.exp.fwork";
+}
+
+const char* OswAppFireworks::getAppName() {
+    return "Fireworks";
+}
+
+void OswAppFireworks::onStart() {
+    OswAppGame::onStart();
+    this->countdown = 10;
+    this->countdownTicks = 1000 / tickTime;
+}
 
-void OswAppFireworks::setup() {
-    OswHal::getInstance()->gfx()->fill(0);  // bg black
-    for (uint8_t i = 0; i < NUM_FIREWORKS; i++) {
-        offsets[i] = random(40, 200);
+void OswAppFireworks::launch(uint8_t i, long minOffset) {
+    const uint16_t color = rgb565(this->rng.random(100, 255), this->rng.random(100, 255), this->rng.random(100, 255));
+    const uint8_t radius = this->rng.random(1, 8);
+    const uint8_t rings = this->rng.random(3, 6);
+    this->offsets[i] = this->rng.random(minOffset, 200);
+    this->fireworks[i].init(color, radius, rings, this->hal->gfx()->getWidth(), this->hal->gfx()->getHeight());
+}
+
+bool OswAppFireworks::onTick() {
+    if (this->countdown > 0) {
+        // "23:59:50" to "23:59:59", then the show starts
+        if (--this->countdownTicks > 0)
+            return false;
+        this->countdownTicks = 1000 / tickTime;
+        if (--this->countdown == 0)
+            for (uint8_t i = 0; i < numFireworks; i++)
+                this->launch(i, 40);
+        this->layer.markAllDirty();
+        return true;
+    }
+
+    for (uint8_t i = 0; i < numFireworks; i++) {
+        this->fireworks[i].tick(tickTime, 10);
+        if (this->fireworks[i].age > this->rng.random(3000, 12000))
+            this->launch(i, 4);
     }
+    return true;
 }
-void OswAppFireworks::loop() {
-    static uint8_t countdown = 10;
-    static long lastTick = millis();
-
-    OswHal* hal = OswHal::getInstance();
-    Graphics2D* gfx2d = hal->gfx();
-
-    if (countdown == 0) {
-        for (uint8_t i = 0; i < NUM_FIREWORKS; i++) {
-            fireworks[i].draw(gfx2d, offsets[i], gfx2d->getHeight());
-            fireworks[i].tick(millis() - lastTick, 10);
-
-            if (fireworks[i].age > random(3000, 12000)) {
-                uint16_t color = rgb565(random(100, 255), random(100, 255), random(100, 255));
-                uint8_t radius = random(1, 8);
-                uint8_t rings = random(3, 6);
-                offsets[i] = random(4, 200);
-                fireworks[i].init(color, radius, rings, gfx2d->getWidth(), gfx2d->getHeight());
+
+void OswAppFireworks::onRender(float alpha) {
+    Graphics2D* gfx2d = this->hal->gfx();
+    if (this->countdown == 0) {
+        // No need to dim the trails, the UI clears the buffer before every frame
+        for (uint8_t i = 0; i < numFireworks; i++) {
+            Firework& firework = this->fireworks[i];
+            firework.draw(gfx2d, this->offsets[i], gfx2d->getHeight());
+            if (firework.height < firework.explHeight) {
+                this->layer.placeSprite(this->sprites[i], {this->offsets[i], (int16_t) (gfx2d->getHeight() - firework.height), 1, 1});
+            } else {
+                const ParticleSystem::Rect& drawn = firework.getDrawnBounds();
+                this->layer.placeSprite(this->sprites[i], {drawn.x, drawn.y, (int16_t) drawn.width, (int16_t) drawn.height});
             }
         }
-        gfx2d->dim(10);
     } else {
-        hal->getCanvas()->fill(0);  // bg black
-        hal->getCanvas()->setTextColor(rgb565(255, 255, 255));
-        hal->getCanvas()->setTextSize(3);
-        hal->getCanvas()->setTextCursor(50, 110);
-        hal->getCanvas()->print("23:59:");
-        hal->getCanvas()->print(60 - countdown);
-        countdown--;
-        delay(1000);  // oops
-        if (countdown == 0) {
-            for (uint8_t i = 0; i < NUM_FIREWORKS; i++) {
-                uint16_t color = rgb565(random(100, 255), random(100, 255), random(100, 255));
-                uint8_t radius = random(1, 8);
-                uint8_t rings = random(3, 6);
-                offsets[i] = random(40, 200);
-                fireworks[i].init(color, radius, rings, gfx2d->getWidth(), gfx2d->getHeight());
-            }
-        }
+        this->hal->getCanvas()->fill(0);  // bg black
+        this->hal->getCanvas()->setTextColor(rgb565(255, 255, 255));
+        this->hal->getCanvas()->setTextSize(3);
+        this->hal->getCanvas()->setTextCursor(50, 110);
+        this->hal->getCanvas()->print("23:59:");
+        this->hal->getCanvas()->print(60 - this->countdown);
     }
-
-    lastTick = millis();
-    delay(1000 / 30);
 }
@@ -25,7 +25,7 @@ void OswAppMagnetometerCalibrate::loop() {
 
     // Read compass values
     OswHal* hal = OswHal::getInstance();
-    hal->devices()->qmc5883l->update();
+    hal->devices()->qmc5883l->boost(50); // Collect the extremes at 20 Hz
     hal->gfx()->fill(rgb888to565(OswConfigAllKeys::themeBackgroundColor.get()));
 
     hal->gfx()->setTextSize(3);
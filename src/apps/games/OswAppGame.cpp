@@ -0,0 +1,147 @@
+#include OSW_TARGET_PLATFORM_HEADER
+#include "apps/games/OswAppGame.h"
+
+#include <algorithm>
+
+#include <OswLogger.h>
+
+OswGameLayer::Rect OswGameLayer::Rect::unite(const Rect& a, const Rect& b) {
+    if (a.isEmpty())
+        return b;
+    if (b.isEmpty())
+        return a;
+    const int16_t x = std::min(a.x, b.x);
+    const int16_t y = std::min(a.y, b.y);
+    return {x, y, (int16_t) (std::max(a.x + a.width, b.x + b.width) - x), (int16_t) (std::max(a.y + a.height, b.y + b.height) - y)};
+}
+
+size_t OswGameLayer::addSprite() {
+    this->sprites.push_back({{0, 0, 0, 0}, {0, 0, 0, 0}, false});
+    return this->sprites.size() - 1;
+}
+
+void OswGameLayer::placeSprite(size_t sprite, const Rect& rect) {
+    this->sprites[sprite].next = rect;
+    this->sprites[sprite].placed = true;
+}
+
+void OswGameLayer::setTiles(int16_t x, int16_t y, uint8_t columns, uint8_t rows, uint8_t tileWidth, uint8_t tileHeight) {
+    this->tilesX = x;
+    this->tilesY = y;
+    this->columns = columns;
+    this->rows = rows;
+    this->tileWidth = tileWidth;
+    this->tileHeight = tileHeight;
+    this->tiles.assign(columns * rows, 0);
+    this->markDirty({x, y, (int16_t) (columns * tileWidth), (int16_t) (rows * tileHeight)});
+}
+
+void OswGameLayer::setTile(uint8_t column, uint8_t row, uint8_t value) {
+    uint8_t& tile = this->tiles[row * this->columns + column];
+    if (tile == value)
+        return;
+    tile = value;
+    this->markDirty(this->getTileRect(column, row));
+}
+
+void OswGameLayer::markDirty(const Rect& rect) {
+    this->dirty = Rect::unite(this->dirty, rect);
+}
+
+OswGameLayer::Rect OswGameLayer::getDirty() const {
+    Rect result = this->dirty;
+    for (const Sprite& sprite : this->sprites) {
+        if (not sprite.placed)
+            result = Rect::unite(result, sprite.shown);
+        else if (sprite.next != sprite.shown)
+            result = Rect::unite(result, Rect::unite(sprite.shown, sprite.next));
+    }
+    return result;
+}
+
+void OswGameLayer::commit() {
+    for (Sprite& sprite : this->sprites) {
+        sprite.shown = sprite.placed ? sprite.next : Rect{0, 0, 0, 0};
+        sprite.placed = false;
+    }
+    this->dirty = {0, 0, 0, 0};
+    this->allDirty = false;
+}
+
+OswAppGame::OswAppGame(unsigned long tickInterval): OswAppV2(), tickInterval(tickInterval) {
+    this->viewFlags = (OswAppV2::ViewFlags) (OswAppV2::ViewFlags::NO_OVERLAYS | OswAppV2::ViewFlags::KEEP_DISPLAY_ON);
+}
+
+void OswAppGame::onStart() {
+    OswAppV2::onStart();
+    this->rng.seed(micros());
+    this->layer.markAllDirty();
+    this->accumulator = 0;
+    this->lastLoop = millis();
+    this->moving = false;
+    this->ticks = 0;
+    this->frames = 0;
+    this->flushedRows = 0;
+    this->droppedTicks = 0;
+}
+
+void OswAppGame::onLoop() {
+    OswAppV2::onLoop(); // Buttons
+    const unsigned long now = millis();
+    const bool ticked = this->advance(now - this->lastLoop) > 0;
+    if (this->moving and (ticked or this->interpolate))
+        this->needsRedraw = true;
+    this->lastLoop = now;
+}
+
+uint8_t OswAppGame::advance(unsigned long elapsed) {
+    this->accumulator += elapsed;
+    uint8_t done = 0;
+    bool changed = false;
+    while (this->accumulator >= this->tickInterval) {
+        if (done == maxTicksPerLoop) {
+            // Drop the backlog, instead of spending even more time to catch up
+            this->droppedTicks += this->accumulator / this->tickInterval;
+            this->accumulator %= this->tickInterval;
+            break;
+        }
+        this->accumulator -= this->tickInterval;
+        this->sampleTilt();
+        changed = this->onTick() or changed;
+        ++done;
+    }
+    if (done > 0) {
+        this->moving = changed;
+        this->ticks += done;
+    }
+    return done;
+}
+
+void OswAppGame::sampleTilt() {
+#if OSW_PLATFORM_ENVIRONMENT_ACCELEROMETER == 1
+    this->tiltX += (this->hal->environment()->getAccelerationX() - this->tiltX) * this->tiltFilter;
+    this->tiltY += (this->hal->environment()->getAccelerationY() - this->tiltY) * this->tiltFilter;
+#endif
+}
+
+void OswAppGame::onDraw() {
+    OswAppV2::onDraw();
+    this->onRender(this->interpolate ? this->getAlpha() : 1.0f);
+
+    // While a button is held, the drawer may animate the long-press indicator around the edge
+    bool buttonDown = false;
+    for (uint8_t i = 0; i < BTN_NUMBER; i++)
+        buttonDown = buttonDown or this->hal->btnIsDown((Button) i);
+    const OswGameLayer::Rect dirty = this->layer.getDirty();
+    if (not this->layer.isAllDirty() and not buttonDown)
+        this->hal->getCanvas()->limitNextFlush(dirty.y, dirty.isEmpty() ? 0 : dirty.height);
+    this->layer.commit();
+    ++this->frames;
+    this->flushedRows += this->hal->getCanvas()->getLastFlushRows(); // Of the previous frame, which is good enough for the average
+}
+
+void OswAppGame::onStop() {
+    OswAppV2::onStop();
+    OSW_LOG_D(this->getAppId(), ": ", this->frames, " frames for ", this->ticks, " ticks (", this->droppedTicks, " dropped), ",
+              this->frames > 0 ? this->flushedRows * 100 / (this->frames * this->hal->getCanvas()->getHeight()) : 0, "% of the rows flushed");
+}
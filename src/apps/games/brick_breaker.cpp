@@ -2,55 +2,114 @@
 #if OSW_PLATFORM_ENVIRONMENT_ACCELEROMETER == 1
 
 #include "./apps/games/brick_breaker.h"
+#include "assets/img/icons/brickbreaker.png.h"
 
 #include <gfx_util.h>
-#include <OswAppV1.h>
-#include <osw_config.h>
-#include <osw_config_keys.h>
 #include <osw_hal.h>
 
-void OswAppBrickBreaker::setup() {}
+OswAppBrickBreaker::OswAppBrickBreaker(): OswAppGame(tickTime) {
+    this->interpolate = true; // The ball moves by a few pixels every tick
+    this->ballSprite = this->layer.addSprite();
+    this->playerSprite = this->layer.addSprite();
+}
 
-void OswAppBrickBreaker::loop() {
-    BrickBreaker();
+const char* OswAppBrickBreaker::getAppId() {
+    return "osw.game.brick";
 }
 
-void OswAppBrickBreaker::stop() {
+const char* OswAppBrickBreaker::getAppName() {
+    return "Brick Breaker";
+}
 
+const OswIcon& OswAppBrickBreaker::getAppIcon() {
+    return brickbreaker_png;
+}
+
+void OswAppBrickBreaker::onStart() {
+    OswAppGame::onStart();
+    this->knownButtonStates[Button::BUTTON_SELECT] = ButtonStateNames::SHORT_PRESS;
+    this->knownButtonStates[Button::BUTTON_UP] = ButtonStateNames::SHORT_PRESS;
+    this->knownButtonStates[Button::BUTTON_DOWN] = ButtonStateNames::SHORT_PRESS;
+    this->layer.setTiles(25, 20, gridW, gridH, 24, 10);
+    this->pressed = {};
+    this->resetGame();
+}
+
+void OswAppBrickBreaker::onButton(Button id, bool up, OswAppV2::ButtonStateNames state) {
+    OswAppGame::onButton(id, up, state);
+    if (!up and state == ButtonStateNames::SHORT_PRESS)
+        this->pressed[id] = true; // As soon as it went down, the next tick handles it
+}
+
+bool OswAppBrickBreaker::onTick() {
+    const int previousPlayerPos = this->playerPos;
+    const int previousScore = this->score;
+    bool changed = false;
+
+    if (buttonControllerMode == 0) {
+        accelerometerController();
+    } else if (buttonControllerMode == 1) {
+        gravityController();
+    } else {
+        buttonController();
+    }
+
+    if (gameRunning) {
+        moveBall();
+        changed = true;
+    } else {
+        waitingRoom();
+    }
+
+    if (this->score != previousScore)
+        this->layer.markDirty({0, 200, 240, 40});
+    this->pressed = {};
+    return changed or this->playerPos != previousPlayerPos or this->layer.isAllDirty();
+}
+
+void OswAppBrickBreaker::onRender(float alpha) {
+    hal->gfx()->setTextSize(2);
+    drawScore();
+    if (buttonControllerMode == 2)
+        drawButtonHints();
+    drawGrid();
+    drawBall(alpha);
+    drawPlayer();
+    if (!gameRunning)
+        drawWaitingRoom();
 }
 
 void OswAppBrickBreaker::drawPlayer() {
-    OswHal::getInstance()->gfx()->drawThickLine(playerPos - (playerWidth / 2), playerY, playerPos + (playerWidth / 2), playerY,
-            playerHeight, ui->getForegroundColor(), true);
+    hal->gfx()->drawThickLine(playerPos - (playerWidth / 2), playerY, playerPos + (playerWidth / 2), playerY,
+                              playerHeight, ui->getForegroundColor(), true);
+    this->layer.placeSprite(this->playerSprite, {(int16_t) (playerPos - playerWidth / 2 - playerHeight), (int16_t) (playerY - playerHeight),
+                                                 (int16_t) (playerWidth + 2 * playerHeight + 1), (int16_t) (2 * playerHeight + 1)});
 }
 
 void OswAppBrickBreaker::drawGrid() {
-    uint16_t color = 0;
-    for (int i = 0; i < gridH; i++) {
-        for (int j = 0; j < gridW; j++) {
-            if (grid[i][j] == true) {
-                color = ui->getForegroundColor();
-            } else {
-                color = ui->getBackgroundColor();
+    for (uint8_t i = 0; i < gridH; i++) {
+        for (uint8_t j = 0; j < gridW; j++) {
+            if (this->layer.getTile(j, i)) {
+                const OswGameLayer::Rect brick = this->layer.getTileRect(j, i);
+                hal->gfx()->fillFrame(brick.x, brick.y, 22, 8, ui->getForegroundColor());
             }
-            OswHal::getInstance()->gfx()->fillFrame((25 + (24 * j)), (20 + (10 * i)), 22, 8, color);
         }
     }
 }
 
-void OswAppBrickBreaker::drawBall() {
-    OswHal::getInstance()->gfx()->fillCircle(ballPosx, ballPosy, 4, ui->getForegroundColor());
-    // hal->gfx()->drawArc(120,120, 0, 360, 60, 80, 0.75f,ui->getForegroundColor(),false);
-    // hal->gfx()->drawFrame(18,18,203,250,ui->getForegroundColor());
+void OswAppBrickBreaker::drawBall(float alpha) {
+    const int x = lerp(lastBallPosx, ballPosx, alpha);
+    const int y = lerp(lastBallPosy, ballPosy, alpha);
+    hal->gfx()->fillCircle(x, y, 4, ui->getForegroundColor());
+    this->layer.placeSprite(this->ballSprite, {(int16_t) (x - 5), (int16_t) (y - 5), 11, 11});
 }
 
 void OswAppBrickBreaker::drawScore() {
-    OswHal::getInstance()->gfx()->setTextCursor(100, 220);
-    OswHal::getInstance()->gfx()->print(score);
+    hal->gfx()->setTextCursor(100, 220);
+    hal->gfx()->print(score);
 }
 
 void OswAppBrickBreaker::drawButtonHints() {
-    OswHal* hal = OswHal::getInstance();
     const int diameter = 4;
     hal->getCanvas()->drawArc(200, 240 - 48 + diameter, diameter + 1, diameter, 270, 360, ui->getDangerColor());
     hal->getCanvas()->drawTriangle(               //
@@ -67,51 +126,7 @@ void OswAppBrickBreaker::drawButtonHints() {
         ui->getDangerColor());                   //
 }
 
-void OswAppBrickBreaker::BrickBreaker() {
-    OswHal::getInstance()->gfx()->setTextSize(2);
-
-    drawScore();
-
-    if (buttonControllerMode == 0) {
-        accelerometerController();
-
-    } else if (buttonControllerMode == 1) {
-        gravityController();
-    } else {
-        drawButtonHints();
-        buttonController();
-    }
-
-    drawScore();
-
-    if (gameRunning) {
-        if (previousTime == 0) {
-            gameStart = millis();
-            previousTime = gameStart;
-        }
-
-        const int currentTime = millis();
-
-        deltaSeconds += (currentTime - previousTime) / 1000.0f;
-
-        previousTime = currentTime;
-
-        drawGrid();
-        moveBall();
-        drawBall();
-        drawPlayer();
-    } else {
-        waitingRoom();
-    }
-    // drawGameState();
-}
-
-void OswAppBrickBreaker::waitingRoom() {
-    OswHal* hal = OswHal::getInstance();
-    initGrid();
-    drawGrid();
-    drawBall();
-    drawPlayer();
+void OswAppBrickBreaker::drawWaitingRoom() {
     hal->gfx()->setTextSize(2);
     hal->gfx()->setTextCursor(150, 48);
     hal->gfx()->print("Start");
@@ -128,25 +143,29 @@ void OswAppBrickBreaker::waitingRoom() {
         hal->gfx()->print("Buttons");
         break;
     }
+}
 
-    if (hal->btnHasGoneDown(BUTTON_1)) {
+void OswAppBrickBreaker::waitingRoom() {
+    if (this->pressed[BUTTON_SELECT]) {
         buttonControllerMode = buttonControllerMode + 1;
         if (buttonControllerMode > 2) {
             buttonControllerMode = 0;
         }
+        this->layer.markAllDirty();
     }
 
-    if (hal->btnHasGoneDown(BUTTON_3)) {
+    if (this->pressed[BUTTON_UP]) {
         score = 0;
         resetGame();
         gameRunning = true;
+        this->layer.markAllDirty();
     }
 }
 
 void OswAppBrickBreaker::initGrid() {
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 8; j++) {
-            grid[i][j] = newGrid[i][j];
+    for (uint8_t i = 0; i < gridH; i++) {
+        for (uint8_t j = 0; j < gridW; j++) {
+            this->layer.setTile(j, i, newGrid[i][j]);
         }
     }
 }
@@ -264,22 +283,20 @@ void OswAppBrickBreaker::hitWall() {
 
 void OswAppBrickBreaker::resetGame(void) {
     gameRunning = false;
-    previousTime = 0;
     ballPosx = 160;
     ballPosy = 120;
+    lastBallPosx = ballPosx;
+    lastBallPosy = ballPosy;
     ballSpdx = -2;
     ballSpdy = 3;
     playerPos = 120;
-    hasbounced = 0;
     playerSpd = 0;
     initGrid();
-
-    gameStart = 0;
 }
 
 void OswAppBrickBreaker::buttonController() {
     // Bottom right
-    if (OswHal::getInstance()->btnHasGoneDown(BUTTON_2)) {
+    if (this->pressed[BUTTON_DOWN]) {
         playerPos = playerPos + 15;
         if (playerPos >= 207) {
             playerPos = 207;
@@ -287,7 +304,7 @@ void OswAppBrickBreaker::buttonController() {
 
     }
     // Bottom left
-    else if (OswHal::getInstance()->btnHasGoneDown(BUTTON_1)) {
+    else if (this->pressed[BUTTON_SELECT]) {
         playerPos = playerPos - 15;
         if (playerPos <= 30) {
             playerPos = 30;
@@ -296,8 +313,7 @@ void OswAppBrickBreaker::buttonController() {
 }
 
 void OswAppBrickBreaker::accelerometerController() {
-    float xAcceleration = OswHal::getInstance()->environment()->getAccelerationX();
-    playerPos = -(xAcceleration * 100) + 120;
+    playerPos = -(this->tiltX * 100) + 120;
     if (playerPos <= 30) {
         playerPos = 30;
     }
@@ -307,18 +323,20 @@ void OswAppBrickBreaker::accelerometerController() {
 }
 
 void OswAppBrickBreaker::gravityController() {
-    float xAcceleration = OswHal::getInstance()->environment()->getAccelerationX();
-    float realAcceleration = -xAcceleration * 59.3346774f;
-    playerSpd = playerSpd + (realAcceleration * (millis() - lastpos));
-    playerPos = playerPos + (playerSpd * (millis() - lastpos));
+    float realAcceleration = -this->tiltX * 59.3346774f;
+    playerSpd = playerSpd + (realAcceleration * tickTime);
+    playerPos = playerPos + (playerSpd * tickTime);
     if (playerPos <= 30) {
         playerPos = 30;
     }
     if (playerPos >= 207) {
         playerPos = 207;
     }
+}
 
-    lastpos = (millis());
+void OswAppBrickBreaker::blockHit(const int column, const int row) {
+    score = score + 1;
+    this->layer.setTile(column, row, 0);
 }
 
 void OswAppBrickBreaker::moveBall() {
@@ -327,64 +345,50 @@ void OswAppBrickBreaker::moveBall() {
         hitPlayer();
     } else if (ballPosy > playerY - 7) {
         resetGame();
+        this->layer.markAllDirty();
+        return;
     }
 
     if (((((ballPosx - 120) * (ballPosx - 120)) + ((ballPosy - 120) * (ballPosy - 120))) >= 13456)) {
         hitWall();
-        // if (ballPosx <= 22 || ballPosx >= 218){
-        //  ballSpdx = -ballSpdx;
-        //}
-        // if (ballPosy <= 22){
-        //  ballSpdy = -ballSpdy;
     }
-    for (int j = 0; j < 4; j++) {
+    for (int j = 0; j < gridH; j++) {
         if (ballPosy <= (28 + (10 * j)) && ballPosy > (20 + (10 * j))) {
-            for (int i = 0; i < 8; i++) {
+            for (int i = 0; i < gridW; i++) {
                 if (ballSpdx < 0) {  // right brick hit
-                    if (ballPosx <= (51 + (i * 24)) && ballPosx >= (48 + (i * 24)) && grid[j][i] == true) {
+                    if (ballPosx <= (51 + (i * 24)) && ballPosx >= (48 + (i * 24)) && this->layer.getTile(i, j)) {
                         ballSpdx = -ballSpdx;
-                        score = score + 1;
-                        grid[j][i] = false;
+                        blockHit(i, j);
                     }
                 } else {  // left brick hit
-                    if (ballPosx >= (21 + (i * 24)) && ballPosx <= (24 + (i * 24)) && grid[j][i] == true) {
+                    if (ballPosx >= (21 + (i * 24)) && ballPosx <= (24 + (i * 24)) && this->layer.getTile(i, j)) {
                         ballSpdx = -ballSpdx;
-                        score = score + 1;
-                        grid[j][i] = false;
+                        blockHit(i, j);
                     }
                 }
             }
         }
         if (ballPosy <= (32 + (10 * j)) && ballPosy > (28 + (10 * j)) && ballSpdy < 0) {
-            for (int i = 0; i < 8; i++) {
-                if (ballPosx >= (25 + (i * 24)) && ballPosx <= (47 + (i * 24)) && grid[j][i] == true) {  // bottom brick hit
+            for (int i = 0; i < gridW; i++) {
+                if (ballPosx >= (25 + (i * 24)) && ballPosx <= (47 + (i * 24)) && this->layer.getTile(i, j)) {  // bottom brick hit
                     ballSpdy = -ballSpdy;
-                    score = score + 1;
-                    grid[j][i] = false;
+                    blockHit(i, j);
                 }
             }
         }
         if (ballPosy >= (16 + (10 * j)) && ballPosy < (19 + (10 * j)) && ballSpdy > 0) {  // top brick hit
-            for (int i = 0; i < 8; i++) {
-                if (ballPosx >= (25 + (i * 24)) && ballPosx <= (47 + (i * 24)) && grid[j][i] == true) {
+            for (int i = 0; i < gridW; i++) {
+                if (ballPosx >= (25 + (i * 24)) && ballPosx <= (47 + (i * 24)) && this->layer.getTile(i, j)) {
                     ballSpdy = -ballSpdy;
-                    score = score + 1;
-                    grid[j][i] = false;
+                    blockHit(i, j);
                 }
             }
         }
     }
 
-    if (millis() >= lastmove + 33) {
-        ballPosy = ballPosy + ballSpdy * spd;
-        ballPosx = ballPosx + ballSpdx * spd;
-        lastmove = millis();
-        // if (hasbounced >= 1){
-        //   hasbounced++;
-        // }
-        // if (hasbounced >= 10){
-        //   hasbounced = 0;
-        //}
-    }
+    lastBallPosx = ballPosx;
+    lastBallPosy = ballPosy;
+    ballPosy = ballPosy + ballSpdy * spd;
+    ballPosx = ballPosx + ballSpdx * spd;
 }
-#endif
\ No newline at end of file
+#endif
@@ -2,24 +2,116 @@
 #if OSW_PLATFORM_ENVIRONMENT_ACCELEROMETER == 1
 
 #include "./apps/games/snake_game.h"
-// #define GIF_BG
+#include "assets/img/icons/snake.png.h"
 
 #include <gfx_util.h>
-#include <OswAppV1.h>
-#include <osw_config.h>
-#include <osw_config_keys.h>
 #include <osw_hal.h>
 
-void OswAppSnakeGame::setup() {
+OswAppSnakeGame::OswAppSnakeGame(): OswAppGame(tickTime) {
 
 }
 
-void OswAppSnakeGame::loop() {
-    snakeGame();
+const char* OswAppSnakeGame::getAppId() {
+    return "osw.game.snake";
 }
 
-void OswAppSnakeGame::stop() {
+const char* OswAppSnakeGame::getAppName() {
+    return "Snake";
+}
+
+const OswIcon& OswAppSnakeGame::getAppIcon() {
+    return snake_png;
+}
+
+void OswAppSnakeGame::onStart() {
+    OswAppGame::onStart();
+    this->knownButtonStates[Button::BUTTON_SELECT] = ButtonStateNames::SHORT_PRESS;
+    this->knownButtonStates[Button::BUTTON_UP] = ButtonStateNames::SHORT_PRESS;
+    this->knownButtonStates[Button::BUTTON_DOWN] = ButtonStateNames::SHORT_PRESS;
+    this->layer.setTiles(0, 0, gameWidth, gameWidth, cellSize, cellSize);
+    this->pressed = {};
+    this->resetGame();
+}
+
+void OswAppSnakeGame::onButton(Button id, bool up, OswAppV2::ButtonStateNames state) {
+    OswAppGame::onButton(id, up, state);
+    if (!up and state == ButtonStateNames::SHORT_PRESS)
+        this->pressed[id] = true; // As soon as it went down, the next tick handles it
+}
+
+bool OswAppSnakeGame::onTick() {
+    bool changed = false;
+    switch (this->state) {
+    case State::WAITING:
+        if (this->pressed[BUTTON_SELECT]) {
+            this->buttonControllerMode = !this->buttonControllerMode;
+            this->layer.markAllDirty();
+            changed = true;
+        }
+        if (this->pressed[BUTTON_UP]) {
+            this->resetGame();
+            this->state = State::RUNNING;
+            this->updateTiles();
+            this->layer.markAllDirty();
+            changed = true;
+        }
+        break;
+    case State::RUNNING: {
+        const int previousX = this->xDirection;
+        const int previousY = this->yDirection;
+        if (this->buttonControllerMode) {
+            this->buttonController();
+            this->useLastDirection();
+        } else {
+            this->accelerometerController();
+        }
+        if (this->xDirection != previousX or this->yDirection != previousY) {
+            this->markHudDirty();
+            changed = true;
+        }
+
+        this->progress += this->score * tickTime;
+        if (this->proceedSnakeCoords()) {
+            const int previousScore = this->score;
+            if (!this->coordsInGame(this->snake[0][0] * cellSize, this->snake[0][1] * cellSize) or this->touchItself()) {
+                this->state = State::GAME_OVER;
+                this->stateTicks = gameOverTime / tickTime;
+            } else {
+                this->proceedEating();
+            }
+            if (this->score != previousScore or this->state != State::RUNNING)
+                this->markHudDirty();
+            this->updateTiles();
+            changed = true;
+        }
+        break;
+    }
+    case State::GAME_OVER:
+        if (--this->stateTicks == 0) {
+            this->resetGame();
+            this->layer.markAllDirty();
+            changed = true;
+        }
+        break;
+    }
+    this->pressed = {};
+    return changed;
+}
 
+void OswAppSnakeGame::onRender(float alpha) {
+    this->hal->gfx()->setTextSize(1);
+    for (uint8_t row = 0; row < gameWidth; row++)
+        for (uint8_t column = 0; column < gameWidth; column++)
+            this->drawTile(column, row);
+
+    this->drawScore();
+    if (this->buttonControllerMode)
+        this->drawButtonHints();
+    if (this->state == State::RUNNING)
+        this->drawDirection(this->xDirection, this->yDirection);
+    else if (this->state == State::WAITING)
+        this->drawWaitingRoom();
+    this->drawGameState();
 }
 
 void OswAppSnakeGame::drawDirection(const int xDirection, const int yDirection) {
@@ -43,7 +135,6 @@ void OswAppSnakeGame::drawDirection(const int xDirection, const int yDirection)
 }
 
 void OswAppSnakeGame::drawDirectionArrow(const int direction, const int topLeftX, const int topLeftY) {
-    OswHal* hal = OswHal::getInstance();
     const int length = 8;
 
     if (direction == UP || direction == DOWN) {
@@ -73,43 +164,37 @@ void OswAppSnakeGame::drawDirectionArrow(const int direction, const int topLeftX
     }
 }
 
-void OswAppSnakeGame::drawPlayer() {
-    OswHal* hal = OswHal::getInstance();
-    if (gameRunning) {
-        for (int i = 1; i < snakeLength - 1; i++) {
-            if (snake[i][0] != 0 && snake[i][1] != 0) {
-                if (snake[i + 1][0] != 0 && snake[i + 1][1] != 0) {
-                    int xSize = snake[i][0] - snake[i + 1][0];
-                    int ySize = snake[i][1] - snake[i + 1][1];
-
-                    hal->getCanvas()->fillRFrame(min(snake[i][0], snake[i + 1][0]) * cellSize + 2,  //
-                                                 min(snake[i][1], snake[i + 1][1]) * cellSize + 2,  //
-                                                 cellSize * (1 + abs(xSize)) - 3,                   //
-                                                 cellSize * (1 + abs(ySize)) - 3,                   //
-                                                 3,                                                 //
-                                                 ui->getSuccessColor());
-                } else {
-                    hal->getCanvas()->fillRFrame(snake[i][0] * cellSize + 2,  //
-                                                 snake[i][1] * cellSize + 2,  //
-                                                 cellSize - 3,                //
-                                                 cellSize - 3,                //
-                                                 3,                           //
-                                                 ui->getSuccessColor());
-                }
-            }
-        }
-        hal->getCanvas()->fillRFrame(snake[0][0] * cellSize,  //
-                                     snake[0][1] * cellSize,  //
-                                     cellSize,                //
-                                     cellSize,                //
-                                     5,                       //
-                                     ui->getSuccessColor());
+void OswAppSnakeGame::drawTile(uint8_t column, uint8_t row) {
+    const int x = column * cellSize;
+    const int y = row * cellSize;
+    if (!coordsInGame(x, y))
+        return;
+    hal->getCanvas()->drawFrame(x, y, cellSize, cellSize, ui->getForegroundDimmedColor());
+
+    // Everything is drawn inside of the tile, so only the tiles that changed are different from the last frame
+    const uint8_t tile = this->layer.getTile(column, row);
+    if (tile & Tile::MEAL)
+        hal->getCanvas()->fillRFrame(x + 2, y + 2, cellSize - 2, cellSize - 2, 3, ui->getWarningColor());
+    if (tile & Tile::BODY) {
+        const int inner = cellSize - 3;
+        const int half = cellSize / 2;
+        hal->getCanvas()->fillRFrame(x + 2, y + 2, inner, inner, 3, ui->getSuccessColor());
+        // Half of the bridge to the next segment, the other half is drawn by that one
+        if (tile & Tile::CONNECT_UP)
+            hal->getCanvas()->fillFrame(x + 2, y, inner, half, ui->getSuccessColor());
+        if (tile & Tile::CONNECT_RIGHT)
+            hal->getCanvas()->fillFrame(x + half, y + 2, cellSize - half, inner, ui->getSuccessColor());
+        if (tile & Tile::CONNECT_DOWN)
+            hal->getCanvas()->fillFrame(x + 2, y + half, inner, cellSize - half, ui->getSuccessColor());
+        if (tile & Tile::CONNECT_LEFT)
+            hal->getCanvas()->fillFrame(x, y + 2, half, inner, ui->getSuccessColor());
     }
+    if (tile & Tile::HEAD)
+        hal->getCanvas()->fillRFrame(x, y, cellSize, cellSize, 5, ui->getSuccessColor());
 }
 
 void OswAppSnakeGame::drawGameState() {
-    OswHal* hal = OswHal::getInstance();
-    if (gameRunning) {
+    if (this->state == State::RUNNING) {
         hal->getCanvas()->drawTriangle(140, 5,   //
                                        140, 15,  //
                                        150, 10,  //
@@ -120,35 +205,14 @@ void OswAppSnakeGame::drawGameState() {
     }
 }
 
-void OswAppSnakeGame::drawLunch() {
-    OswHal::getInstance()->getCanvas()->fillRFrame(mealXCoord * cellSize + 2,  //
-            mealYCoord * cellSize + 2,  //
-            cellSize - 2,               //
-            cellSize - 2,               //
-            3,                          //
-            ui->getWarningColor());
-}
-
-void OswAppSnakeGame::drawGrid() {
-    for (int x = 0; x < gameWidth; x++) {
-        for (int y = 0; y < yCells; y++) {
-            int xTarget = x * cellSize;
-            int yTarget = y * cellSize + 20;
-
-            if (coordsInGame(xTarget, yTarget)) {
-                OswHal::getInstance()->getCanvas()->drawFrame(x * cellSize, 20 + y * cellSize, cellSize, cellSize, ui->getForegroundDimmedColor());
-            }
-        }
-    }
-}
-
 void OswAppSnakeGame::drawScore() {
-    OswHal::getInstance()->gfx()->setTextCursor(95, 15);
-    OswHal::getInstance()->gfx()->print(score);
+    hal->gfx()->setTextSize(this->state == State::GAME_OVER ? 2 : 1);
+    hal->gfx()->setTextCursor(95, 15);
+    hal->gfx()->print(score);
+    hal->gfx()->setTextSize(1);
 }
 
 void OswAppSnakeGame::drawButtonHints() {
-    OswHal* hal = OswHal::getInstance();
     const int diameter = 4;
     hal->getCanvas()->drawArc(200, 240 - 48 + diameter, diameter + 1, diameter, 270, 360, ui->getDangerColor());
     hal->getCanvas()->drawTriangle(               //
@@ -165,84 +229,18 @@ void OswAppSnakeGame::drawButtonHints() {
         ui->getDangerColor());                   //
 }
 
-void OswAppSnakeGame::snakeGame() {
-    OswHal::getInstance()->gfx()->setTextSize(1);
-
-    bool fastGame = false;
-
-    drawGrid();
-    drawScore();
-
-#ifdef demo
-    autoController();
-    fastGame = true;
-#else
-    if (buttonControllerMode) {
-        drawButtonHints();
-        buttonController();
-        useLastDirection();
-    } else {
-        accelerometerController();
-    }
-#endif
-
-    drawGrid();
-    drawScore();
-
-    if (gameRunning) {
-        drawDirection(xDirection, yDirection);
-
-        if (previousTime == 0) {
-            gameStart = millis();
-            previousTime = gameStart;
-        }
-
-        const int currentTime = millis();
-
-        deltaSeconds += (currentTime - previousTime) / 1000.0f;
-
-        proceedSnakeCoords(fastGame);
-
-        previousTime = currentTime;
-
-        const int xTarget = snake[0][0] * cellSize;
-        const int yTarget = snake[0][1] * cellSize;
-
-        if (!coordsInGame(xTarget, yTarget) || touchItself()) {
-            OswHal::getInstance()->gfx()->setTextSize(2);
-            OswHal::getInstance()->gfx()->setTextCursor(95, 15);
-            OswHal::getInstance()->gfx()->print(score);
-
-            delay(1000);
-            resetGame();
-        }
-
-        drawLunch();
-        drawPlayer();
-        proceedEating();
-    } else {
-        waitingRoom();
-    }
-    drawGameState();
-}
-
-void OswAppSnakeGame::waitingRoom() {
-    OswHal* hal = OswHal::getInstance();
+void OswAppSnakeGame::drawWaitingRoom() {
     hal->gfx()->setTextSize(2);
     hal->gfx()->setTextCursor(150, 48);
     hal->gfx()->print("Start");
 
     hal->gfx()->setTextCursor(240 - 180 - 30, 240 - 48);
     hal->gfx()->print(buttonControllerMode ? "Button" : "Accelerometer");
+    hal->gfx()->setTextSize(1);
+}
 
-    if (hal->btnHasGoneDown(BUTTON_1)) {
-        buttonControllerMode = !buttonControllerMode;
-    }
-
-    if (hal->btnHasGoneDown(BUTTON_3)) {
-        resetGame();
-        gameRunning = true;
-    }
+void OswAppSnakeGame::markHudDirty() {
+    this->layer.markDirty({0, 0, 240, 32}); // Score, direction and game state
 }
 
 void OswAppSnakeGame::resetGame() {
@@ -255,57 +253,97 @@ void OswAppSnakeGame::resetGame() {
     snake[0][1] = 10;
 
     score = 1;
-    gameRunning = false;
-    previousTime = 0;
+    state = State::WAITING;
+    progress = 0;
 
     lastDirection = DOWN;
 
     xDirection = 0;
     yDirection = 1;
 
-    gameStart = 0;
     spawnEat();
+    updateTiles();
 }
 
 void OswAppSnakeGame::proceedEating() {
-    if (!scoreUpdated && snake[0][0] == mealXCoord && snake[0][1] == mealYCoord) {
-        mealXCoord = -1;
-        mealYCoord = -1;
-
+    if (snake[0][0] == mealXCoord && snake[0][1] == mealYCoord) {
         score = score + 1;
-        scoreUpdated = true;
-
-        spawnEat();
 
         if (score == snakeLength) {
-            delay(500);
-            resetGame();
+            state = State::GAME_OVER;
+            stateTicks = fullScoreTime / tickTime;
+        } else {
+            spawnEat();
         }
     }
 }
 
 void OswAppSnakeGame::spawnEat() {
-    scoreUpdated = false;
+    do {
+        mealXCoord = this->rng.random(gameWidth);
+        mealYCoord = this->rng.random(gameWidth);
+    } while (!coordsInGame(mealXCoord * cellSize, mealYCoord * cellSize));
+}
 
-    mealXCoord = random(gameWidth);
-    mealYCoord = random(gameWidth);
-    if (!coordsInGame(mealXCoord * cellSize, mealYCoord * cellSize)) {
-        spawnEat();
+void OswAppSnakeGame::updateTiles() {
+    std::array<uint8_t, gameWidth * gameWidth> tiles = {};
+    auto inside = [](int column, int row) {
+        return column >= 0 and column < gameWidth and row >= 0 and row < gameWidth;
+    };
+    if (this->state != State::WAITING) {
+        if (inside(this->mealXCoord, this->mealYCoord))
+            tiles[this->mealYCoord * gameWidth + this->mealXCoord] |= Tile::MEAL;
+        for (int i = 1; i < this->score; i++) {
+            const int column = this->snake[i][0];
+            const int row = this->snake[i][1];
+            if (!inside(column, row) or (column == 0 and row == 0)) // Not moved there yet
+                continue;
+            tiles[row * gameWidth + column] |= Tile::BODY;
+            if (i + 1 >= this->score)
+                continue;
+            const int nextColumn = this->snake[i + 1][0];
+            const int nextRow = this->snake[i + 1][1];
+            if (!inside(nextColumn, nextRow) or (nextColumn == 0 and nextRow == 0))
+                continue;
+            uint8_t toNext = 0;
+            uint8_t toThis = 0;
+            if (nextColumn == column + 1) {
+                toNext = Tile::CONNECT_RIGHT;
+                toThis = Tile::CONNECT_LEFT;
+            } else if (nextColumn == column - 1) {
+                toNext = Tile::CONNECT_LEFT;
+                toThis = Tile::CONNECT_RIGHT;
+            } else if (nextRow == row + 1) {
+                toNext = Tile::CONNECT_DOWN;
+                toThis = Tile::CONNECT_UP;
+            } else if (nextRow == row - 1) {
+                toNext = Tile::CONNECT_UP;
+                toThis = Tile::CONNECT_DOWN;
+            }
+            tiles[row * gameWidth + column] |= toNext;
+            tiles[nextRow * gameWidth + nextColumn] |= toThis;
+        }
+        if (inside(this->snake[0][0], this->snake[0][1]))
+            tiles[this->snake[0][1] * gameWidth + this->snake[0][0]] |= Tile::HEAD;
     }
+    for (uint8_t row = 0; row < gameWidth; row++)
+        for (uint8_t column = 0; column < gameWidth; column++)
+            this->layer.setTile(column, row, tiles[row * gameWidth + column]);
 }
 
 bool OswAppSnakeGame::coordsInGame(const int xCoord, const int yCoord) {
-    return pow(120 - (xCoord + halfSize), 2) + pow(120 - (yCoord + halfSize), 2) <= squaredWidth &&
-           yCoord > 20;
+    const int dx = 120 - (xCoord + cellSize / 2);
+    const int dy = 120 - (yCoord + cellSize / 2);
+    return dx * dx + dy * dy <= 110 * 110 && yCoord > 20;
 }
 
 void OswAppSnakeGame::buttonController() {
     // Bottom right
-    if (OswHal::getInstance()->btnHasGoneDown(BUTTON_2)) {
+    if (this->pressed[BUTTON_DOWN]) {
         lastDirection++;
     }
     // Bottom left
-    else if (OswHal::getInstance()->btnHasGoneDown(BUTTON_1)) {
+    else if (this->pressed[BUTTON_SELECT]) {
         lastDirection--;
     }
 
@@ -317,27 +355,24 @@ void OswAppSnakeGame::buttonController() {
 }
 
 void OswAppSnakeGame::accelerometerController() {
-    float xAcceleration = OswHal::getInstance()->environment()->getAccelerationX();
-    float yAcceleration = OswHal::getInstance()->environment()->getAccelerationY();
-
-    if (xAcceleration >= -1 * xSensitivity && xAcceleration <= 1 * xSensitivity) {
+    if (this->tiltX >= -1 * xSensitivity && this->tiltX <= 1 * xSensitivity) {
         xDirection = 0;
 
-        if (yAcceleration >= 1 * ySensitivity && lastDirection != UP) {
+        if (this->tiltY >= 1 * ySensitivity && lastDirection != UP) {
             yDirection = 1;
 
-        } else if (yAcceleration <= -1 * ySensitivity && lastDirection != DOWN) {
+        } else if (this->tiltY <= -1 * ySensitivity && lastDirection != DOWN) {
             yDirection = -1;
         } else {
             useLastDirection();
         }
 
-    } else if (yAcceleration >= -1 * ySensitivity && yAcceleration <= 1 * ySensitivity) {
+    } else if (this->tiltY >= -1 * ySensitivity && this->tiltY <= 1 * ySensitivity) {
         yDirection = 0;
 
-        if (xAcceleration >= 1 * xSensitivity && lastDirection != RIGHT) {
+        if (this->tiltX >= 1 * xSensitivity && lastDirection != RIGHT) {
             xDirection = -1;
-        } else if (xAcceleration <= -1 * xSensitivity && lastDirection != LEFT) {
+        } else if (this->tiltX <= -1 * xSensitivity && lastDirection != LEFT) {
             xDirection = 1;
         } else {
             useLastDirection();
@@ -368,45 +403,25 @@ void OswAppSnakeGame::useLastDirection() {
     }
 }
 
-void OswAppSnakeGame::autoController() {
-    int snakeX = snake[0][0];
-    int snakeY = snake[0][1];
+bool OswAppSnakeGame::proceedSnakeCoords() {
+    // The longer the snake, the faster it moves
+    if (progress < 1000)
+        return false;
+    progress = 0;
 
-    if (lastDirection != UP && snakeY < mealYCoord) {
-        xDirection = 0;
-        yDirection = 1;
-
-    } else if (lastDirection != RIGHT && snakeX > mealXCoord) {
-        xDirection = -1;
-        yDirection = 0;
-
-    } else if (lastDirection != DOWN && snakeY > mealYCoord) {
-        xDirection = 0;
-        yDirection = -1;
-
-    } else if (lastDirection != LEFT && snakeX < mealXCoord) {
-        xDirection = 1;
-        yDirection = 0;
+    for (int i = score - 1; i > 0; i--) {
+        snake[i][0] = snake[i - 1][0];
+        snake[i][1] = snake[i - 1][1];
     }
-}
 
-void OswAppSnakeGame::proceedSnakeCoords(const bool fastGame) {
-    if (fastGame || isTimeFinish()) {
-        for (int i = score - 1; i > 0; i--) {
-            snake[i][0] = snake[i - 1][0];
-            snake[i][1] = snake[i - 1][1];
-        }
-
-        if (xDirection != 0) {
-            lastDirection = xDirection == -1 ? LEFT : RIGHT;
-            snake[0][0] += xDirection;
-        } else if (yDirection != 0) {
-            lastDirection = yDirection == -1 ? UP : DOWN;
-            snake[0][1] += yDirection;
-        }
-
-        deltaSeconds = 0;
+    if (xDirection != 0) {
+        lastDirection = xDirection == -1 ? LEFT : RIGHT;
+        snake[0][0] += xDirection;
+    } else if (yDirection != 0) {
+        lastDirection = yDirection == -1 ? UP : DOWN;
+        snake[0][1] += yDirection;
     }
+    return true;
 }
 
 bool OswAppSnakeGame::touchItself() {
@@ -418,4 +433,4 @@ bool OswAppSnakeGame::touchItself() {
     }
     return false;
 }
-#endif
\ No newline at end of file
+#endif
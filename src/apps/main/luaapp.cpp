@@ -2,21 +2,179 @@
 #include "./apps/main/luaapp.h"
 
 #include <OswAppV1.h>
+#include <OswMemoryTracker.h>
 #include <osw_hal.h>
+#include <stdio.h>
+#include <cstring>
 #include <string>
 
+/**
+ * Header in front of the bytecode in a cache file - the bytecode is only used if the source still matches
+ */
+struct LuaCacheHeader {
+    uint32_t magic;
+    uint32_t sourceHash;
+    uint32_t sourceSize;
+};
+static const uint32_t LUA_CACHE_MAGIC = 0x4C57534F; // "OSWL"
+
+struct LuaFileReader {
+    FILE* file;
+    char buffer[256];
+};
+
+static const char* readLuaFile(lua_State* L, void* data, size_t* size) {
+    LuaFileReader* reader = (LuaFileReader*) data;
+    *size = fread(reader->buffer, 1, sizeof(reader->buffer), reader->file);
+    return *size > 0 ? reader->buffer : nullptr;
+}
+
+/**
+ * The allocator of luaL_newstate(), but accounting everything of the state as LUA - Lua passes the old sizes itself
+ */
+static void* allocateLua(void* ud, void* block, size_t oldSize, size_t newSize) {
+    if(block == nullptr)
+        oldSize = 0;  // Then it is the type of the new object instead
+    if(newSize == 0) {
+        free(block);
+        if(block != nullptr)
+            OswMemoryTracker::getInstance().recordRelease(OswMemoryTag::LUA, oldSize);
+        return nullptr;
+    }
+    void* moved = realloc(block, newSize);
+    if(moved != nullptr) {
+        if(block != nullptr)
+            OswMemoryTracker::getInstance().recordRelease(OswMemoryTag::LUA, oldSize);
+        OswMemoryTracker::getInstance().recordAllocation(OswMemoryTag::LUA, newSize);
+    }
+    return moved;
+}
+
+static int writeLuaFile(lua_State* L, const void* data, size_t size, void* file) {
+    return fwrite(data, 1, size, (FILE*) file) == size ? 0 : 1;
+}
+
+/**
+ * FNV-1a of the whole source file, streamed so the source is never held in RAM
+ */
+static bool hashLuaSource(const char* path, uint32_t& hash, uint32_t& size) {
+    FILE* file = fopen(path, "rb");
+    if(!file)
+        return false;
+    char buffer[256];
+    size_t read;
+    hash = 2166136261u;
+    size = 0;
+    while((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        for(size_t i = 0; i < read; i++)
+            hash = (hash ^ (uint8_t) buffer[i]) * 16777619u;
+        size += read;
+    }
+    fclose(file);
+    return true;
+}
+
+/**
+ * "/data/lua/apps/stopwatch.lua" -> "/data/lua/cache/apps_stopwatch.luac"
+ */
+static std::string luaCachePathFor(const char* path) {
+    std::string name(path);
+    if(name.rfind(LUA_SCRIPT_ROOT, 0) == 0)
+        name.erase(0, strlen(LUA_SCRIPT_ROOT));
+    for(char& c : name)
+        if(c == '/')
+            c = '_';
+    return std::string(LUA_CACHE_PATH) + name + "c";
+}
+
+/**
+ * Replaces the default Lua file searcher of "require", so libraries are loaded from the bytecode cache too
+ */
+static int searchCachedLuaModule(lua_State* L) {
+    const char* name = luaL_checkstring(L, 1);
+    lua_getglobal(L, LUA_LOADLIBNAME);
+    lua_getfield(L, -1, "searchpath");
+    lua_pushstring(L, name);
+    lua_getfield(L, -3, "path");
+    lua_call(L, 2, 2);
+    if(lua_isnil(L, -2))
+        return 1; // Error message listing all tried files
+
+    const char* path = lua_tostring(L, -2);
+    if(OswLuaApp::loadScript(L, path) != LUA_OK)
+        return luaL_error(L, "error loading module '%s' from file '%s':\n\t%s", name, path, lua_tostring(L, -1));
+    lua_pushstring(L, path);
+    return 2;
+}
+
+/**
+ * Works like luaL_loadfile(), but uses the precompiled bytecode from the cache if the source did not change.
+ * On a cache miss the source is compiled as usual and the resulting function is dumped into the cache.
+ */
+int OswLuaApp::loadScript(lua_State* L, const char* path) {
+    LuaCacheHeader expected = {LUA_CACHE_MAGIC, 0, 0};
+    if(!hashLuaSource(path, expected.sourceHash, expected.sourceSize))
+        return luaL_loadfile(L, path); // Let Lua produce the error message
+
+    const std::string cachePath = luaCachePathFor(path);
+    const std::string chunkName = std::string("@") + path;
+    LuaFileReader reader;
+    reader.file = fopen(cachePath.c_str(), "rb");
+    if(reader.file) {
+        LuaCacheHeader header;
+        int status = LUA_ERRFILE;
+        if(fread(&header, sizeof(header), 1, reader.file) == 1 and memcmp(&header, &expected, sizeof(header)) == 0)
+            status = lua_load(L, readLuaFile, &reader, chunkName.c_str(), "b");
+        fclose(reader.file);
+        if(status == LUA_OK)
+            return LUA_OK;
+        if(status != LUA_ERRFILE)
+            lua_pop(L, 1); // Outdated or incompatible bytecode, just recompile it
+    }
+
+    int status = luaL_loadfilex(L, path, "t");
+    if(status != LUA_OK)
+        return status;
+
+    FILE* cache = fopen(cachePath.c_str(), "wb");
+    if(cache) {
+        // Keep the debug information, so errors still report the line numbers
+        bool written = fwrite(&expected, sizeof(expected), 1, cache) == 1 and lua_dump(L, writeLuaFile, cache, 0) == 0;
+        fclose(cache);
+        if(!written) {
+            OSW_LOG_W("Failed to cache bytecode of ", path);
+            remove(cachePath.c_str());
+        }
+    }
+    return LUA_OK;
+}
+
 void OswLuaApp::setup() {
-    luaState = luaL_newstate();
+    luaState = lua_newstate(allocateLua, nullptr);
 
     if (luaState) {
         luaL_openlibs(luaState);
         halToLua(luaState);
 
+#if LUA_VERSION_NUM >= 504
+        lua_gc(luaState, LUA_GCGEN, 0, 0);
+#else
+        //Collect a bit more eagerly than the default, most garbage is generated per frame anyway
+        lua_gc(luaState, LUA_GCSETPAUSE, 150);
+        lua_gc(luaState, LUA_GCSETSTEPMUL, 200);
+#endif
+
         //Include search paths
         luaL_dostring(luaState, LUA_PACKAGE_CMD);
 
+        lua_getglobal(luaState, LUA_LOADLIBNAME);
+        lua_getfield(luaState, -1, "searchers");
+        lua_pushcfunction(luaState, searchCachedLuaModule);
+        lua_rawseti(luaState, -2, 2);
+        lua_pop(luaState, 2);
+
         std::string filePath = (std::string(LUA_APP_PATH) + std::string(file));
-        if (luaL_dofile(luaState, filePath.c_str())) {
+        if (loadScript(luaState, filePath.c_str()) or lua_pcall(luaState, 0, LUA_MULTRET, 0)) {
             printLuaError();
             cleanupState();
             return;
@@ -36,8 +194,7 @@ void OswLuaApp::loop() {
             printLuaError();
         }
 
-        //Force GC to run after loop
-        lua_gc(luaState, LUA_GCCOLLECT, 0);
+        collectGarbage();
     }
 }
 
@@ -52,6 +209,18 @@ void OswLuaApp::stop() {
     cleanupState();
 }
 
+/**
+ * Advance the incremental collector in small steps after the frame, instead of a full (and frame-time
+ * dependent) collection. Stops early when the budget is used up or a cycle completed.
+ */
+void OswLuaApp::collectGarbage() {
+    const unsigned long start = micros();
+    do {
+        if (lua_gc(luaState, LUA_GCSTEP, LUA_GC_STEP_KB))
+            break;
+    } while (micros() - start < LUA_GC_FRAME_BUDGET_US);
+}
+
 void OswLuaApp::cleanupState() {
     if (luaState) {
         lua_close(luaState);
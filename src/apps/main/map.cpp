@@ -9,6 +9,7 @@
 #include <gfx_util.h>
 #include <osm_render.h>
 #include <OswAppV1.h>
+#include <OswMemoryTracker.h>
 #include <osw_hal.h>
 
 #ifdef PROGMEM_TILES
@@ -32,6 +33,7 @@ void OswAppMap::setup() {
     OSW_LOG_I("UsedBytes:", SD.usedBytes());
 
     // tileBuffer = new Graphics2D(240, 240, 4, true);
+    OswMemoryScope tiles(OswMemoryTag::TILES);
     tileBuffer = new BufferedTile*[BUF_LEN];
     for (uint8_t i = 0; i < BUF_LEN; i++) {
         tileBuffer[i] = new BufferedTile(true /* inPsram */);
@@ -2,6 +2,8 @@
 
 #include "./apps/tools/OswAppPrintDebug.h"
 
+#include <mutex>
+
 #include <gfx_util.h>
 #include <OswAppV1.h>
 #include <osw_hal.h>
@@ -48,8 +50,14 @@ void OswAppPrintDebug::loop() {
 #if OSW_PLATFORM_ENVIRONMENT == 1
 #if OSW_PLATFORM_ENVIRONMENT_TEMPERATURE == 1
     printStatus("Temperature", String(hal->environment()->getTemperature() + String("C")).c_str());
-    for(auto& d : *OswTemperatureProvider::getAllTemperatureDevices())
-        printStatus((String("  ") + d->getName()).c_str(), String(d->getTemperature() + String("C")).c_str());
+    for(auto& d : *OswTemperatureProvider::getAllTemperatureDevices()) {
+        float temperature;
+        {
+            std::lock_guard<std::mutex> guard(hal->devices()->getBusLock()); // Some read it from the sensor
+            temperature = d->getTemperature();
+        }
+        printStatus((String("  ") + d->getName()).c_str(), String(temperature + String("C")).c_str());
+    }
 #endif
 #if OSW_PLATFORM_ENVIRONMENT_PRESSURE == 1
     printStatus("Pressure", String(hal->environment()->getPressure() + String(" bar")).c_str());
@@ -82,6 +90,7 @@ void OswAppPrintDebug::loop() {
     printStatus("UTC Time", String(String(hal->getUTCTime()) + " sec").c_str());
     for(auto& d : *OswTimeProvider::getAllTimeDevices())
         printStatus((String("  ") + d->getName()).c_str(), String(d->getUTCTime() + String(" sec")).c_str());
+    printStatus("Clock", String("+-" + String((long) (hal->getClock().getUncertainty() / 2000)) + " ms, " + String(hal->getClock().getDrift(), 1) + " ppm").c_str());
 
     printStatus("Timezone (1st)", String(String(hal->getTimezoneOffsetPrimary()) + " sec").c_str());
     printStatus("Timezone (2nd)", String(String(hal->getTimezoneOffsetSecondary()) + " sec").c_str());
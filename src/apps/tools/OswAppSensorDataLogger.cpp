@@ -1,18 +1,28 @@
 #include "apps/tools/OswAppSensorDataLogger.h"
 #include "assets/img/icons/app.png.h"
 #include <OswLogger.h>
+#include <OswMemoryTracker.h>
 #include <gfx_util.h>
 #include <math_osm.h>
+#include <hal/osw_filesystem.h>
+#ifdef OSW_SERVICE_COMMUNICATION
+#include "services/OswServiceTasks.h"
+#include "services/OswServiceTaskCommunication.h"
+#endif
+#ifdef OSW_FEATURE_WIFI
+#include <WiFi.h>
+#endif
 
 OswAppSensorDataLogger::OswAppSensorDataLogger() : OswAppV2() {
     this->dataUpdated = false;
     this->lastUpdateTime = 0;
     this->lastServerUpdate = 0;
+    this->lastTraceSample = 0;
+    this->traceButtons = 0;
     this->serverConnected = false;
     this->updateInterval = 1000; // 1 second for faster updates
     this->displayMode = 0;
     this->autoUpdate = true;
-    this->serverUrl = "http://your-server.com/api/sensor-data";
 }
 
 const char* OswAppSensorDataLogger::getAppId() {
@@ -30,6 +40,7 @@ const OswIcon& OswAppSensorDataLogger::getAppIcon() {
 void OswAppSensorDataLogger::onStart() {
     OswAppV2::onStart();
     this->viewFlags = (OswAppV2::ViewFlags) (this->viewFlags | OswAppV2::ViewFlags::KEEP_DISPLAY_ON);
+    this->knownButtonStates[Button::BUTTON_UP] = ButtonStateNames::SHORT_PRESS;
     
     // Initialize sensor data
     this->updateSensorData();
@@ -40,6 +51,11 @@ void OswAppSensorDataLogger::onLoop() {
     OswAppV2::onLoop();
     
     unsigned long currentTime = millis();
+
+    if (this->trace.isOpen() && currentTime - this->lastTraceSample >= traceInterval) {
+        this->recordTrace();
+        this->lastTraceSample = currentTime;
+    }
     
     // Update sensor data every 2 seconds
     if (currentTime - this->lastUpdateTime > 2000) {
@@ -86,13 +102,95 @@ void OswAppSensorDataLogger::onDrawOverlay() {
         case 1: OswHal::getInstance()->gfx()->print("Network"); break;
         case 2: OswHal::getInstance()->gfx()->print("Settings"); break;
     }
+    if (this->trace.isOpen()) {
+        OswHal::getInstance()->gfx()->print(" REC");
+    }
 }
 
 void OswAppSensorDataLogger::onStop() {
     OswAppV2::onStop();
+    if (this->trace.isOpen()) {
+        this->toggleTrace();
+    }
     OSW_LOG_I("Sensor Data Logger stopped");
 }
 
+void OswAppSensorDataLogger::onButton(Button id, bool up, ButtonStateNames state) {
+    OswAppV2::onButton(id, up, state);
+    if (up && state == ButtonStateNames::SHORT_PRESS && id == Button::BUTTON_UP) {
+        this->toggleTrace();
+        this->needsRedraw = true;
+    }
+}
+
+void OswAppSensorDataLogger::toggleTrace() {
+    if (this->trace.isOpen()) {
+        OSW_LOG_I("Sensor trace stopped after ", this->trace.getWrittenSamples(), " samples");
+        this->trace.close();
+        return;
+    }
+    // On the SD card, if there is one - the flash is rather small
+    const char* path = FS_MOUNT_POINT "/sensors.trace";
+#if defined(GPS_EDITION) || defined(GPS_EDITION_ROTATED)
+    if (OswHal::getInstance()->isSDMounted()) {
+        path = "/sd/sensors.trace";
+    }
+#endif
+    if (!this->trace.open(path)) {
+        OSW_LOG_E("Failed to open the sensor trace ", path);
+        return;
+    }
+    this->lastTraceSample = 0;
+    this->traceButtons = 0;
+    OSW_LOG_I("Recording the sensors to ", path);
+}
+
+/**
+ * Appends everything which changed since the last call to the trace
+ */
+void OswAppSensorDataLogger::recordTrace() {
+    OswHal* hal = OswHal::getInstance();
+    const unsigned long now = millis();
+    this->trace.write(now, OswSensorTrace::Kind::UTC, hal->getUTCTime());
+
+    for (uint8_t i = 0; i < BTN_NUMBER; i++) {
+        const bool down = hal->btnIsDown((Button) i);
+        if (down != (bool) (this->traceButtons & (1 << i))) {
+            this->trace.write(now, OswSensorTrace::Kind::BUTTON, i, down, 0, 0, true);
+            this->traceButtons ^= 1 << i;
+        }
+    }
+
+#if OSW_PLATFORM_ENVIRONMENT == 1
+    OswHal::Environment* environment = hal->environment();
+#if OSW_PLATFORM_ENVIRONMENT_ACCELEROMETER == 1
+    this->trace.write(now, OswSensorTrace::Kind::ACCELERATION, environment->getAccelerationX(), environment->getAccelerationY(),
+                      environment->getAccelerationZ());
+    this->trace.write(now, OswSensorTrace::Kind::STEPS, environment->getStepsToday());
+    this->trace.write(now, OswSensorTrace::Kind::ACTIVITY, (int) environment->getActivityMode());
+#endif
+#if OSW_PLATFORM_ENVIRONMENT_PRESSURE == 1
+    this->trace.write(now, OswSensorTrace::Kind::PRESSURE, environment->getPressure());
+#endif
+#if OSW_PLATFORM_ENVIRONMENT_TEMPERATURE == 1
+    this->trace.write(now, OswSensorTrace::Kind::TEMPERATURE, environment->getTemperature());
+#endif
+#if OSW_PLATFORM_ENVIRONMENT_HUMIDITY == 1
+    this->trace.write(now, OswSensorTrace::Kind::HUMIDITY, environment->getHumidity());
+#endif
+#if OSW_PLATFORM_ENVIRONMENT_MAGNETOMETER == 1
+    this->trace.write(now, OswSensorTrace::Kind::MAGNETOMETER, environment->getMagnetometerX(), environment->getMagnetometerY(),
+                      environment->getMagnetometerZ(), environment->getMagnetometerAzimuth());
+#endif
+#endif
+
+#if defined(GPS_EDITION) || defined(GPS_EDITION_ROTATED)
+    if (hal->hasGPSFix()) {
+        this->trace.write(now, OswSensorTrace::Kind::GPS, hal->gpsLat(), hal->gpsLon(), hal->gpsFix()->altitude());
+    }
+#endif
+}
+
 void OswAppSensorDataLogger::updateSensorData() {
     OswHal* hal = OswHal::getInstance();
     
@@ -142,29 +240,14 @@ void OswAppSensorDataLogger::updateSensorData() {
 }
 
 void OswAppSensorDataLogger::sendDataToServer() {
-    if (!this->connectToServer()) {
-        OSW_LOG_E("Failed to connect to server");
-        return;
-    }
-    
-    HTTPClient http;
-    http.begin(this->serverUrl);
-    http.addHeader("Content-Type", "application/json");
-    
-    String jsonData = this->formatSensorData();
-    
-    int httpResponseCode = http.POST(jsonData);
-    
-    if (httpResponseCode > 0) {
-        String response = http.getString();
-        OSW_LOG_I("Server response: ", response);
-        this->serverConnected = true;
-    } else {
-        OSW_LOG_E("HTTP error: ", httpResponseCode);
-        this->serverConnected = false;
-    }
-    
-    http.end();
+#ifdef OSW_SERVICE_COMMUNICATION
+    // Only queued - the service sends it in batches, once it is worth bringing the WiFi up
+    OswServiceAllTasks::communication.send(OswCommunication::MessageType::SENSOR_DATA, this->formatSensorData());
+    this->serverConnected = OswServiceAllTasks::communication.isServerReachable();
+#else
+    OSW_LOG_W("Sending needs the communication service (OSW_SERVICE_COMMUNICATION)");
+    this->autoUpdate = false;
+#endif
 }
 
 void OswAppSensorDataLogger::drawSensorData() {
@@ -290,6 +373,7 @@ void OswAppSensorDataLogger::drawConnectionStatus() {
     
     yPos += lineHeight;
     
+#ifdef OSW_FEATURE_WIFI
     // WiFi status
     hal->gfx()->setTextCursor(20, yPos);
     hal->gfx()->setTextColor(ui->getInfoColor());
@@ -298,6 +382,17 @@ void OswAppSensorDataLogger::drawConnectionStatus() {
     hal->gfx()->print(WiFi.status() == WL_CONNECTED ? "Connected" : "Disconnected");
     
     yPos += lineHeight;
+#endif
+#ifdef OSW_SERVICE_COMMUNICATION
+    // Messages waiting for the next batch
+    hal->gfx()->setTextCursor(20, yPos);
+    hal->gfx()->setTextColor(ui->getInfoColor());
+    hal->gfx()->print("Queued: ");
+    hal->gfx()->setTextColor(ui->getForegroundColor());
+    hal->gfx()->print((unsigned) OswServiceAllTasks::communication.getQueueSize());
+    
+    yPos += lineHeight;
+#endif
     
     // Auto update status
     hal->gfx()->setTextCursor(20, yPos);
@@ -350,7 +445,7 @@ void OswAppSensorDataLogger::drawSettings() {
 }
 
 String OswAppSensorDataLogger::formatSensorData() {
-    DynamicJsonDocument doc(2048); // Increased size for more data
+    OswJsonDocument doc(2048); // Increased size for more data
     
     // Device info
     doc["device_id"] = "OSW_1";
@@ -380,8 +475,3 @@ String OswAppSensorDataLogger::formatSensorData() {
     serializeJson(doc, jsonString);
     return jsonString;
 }
-
-bool OswAppSensorDataLogger::connectToServer() {
-    // Basic connection check - you can enhance this
-    return WiFi.status() == WL_CONNECTED;
-}
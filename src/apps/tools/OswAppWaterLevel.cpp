@@ -114,6 +114,7 @@ void OswAppWaterLevel::barsDisplay() {
 
 void OswAppWaterLevel::loop() {
     OswHal* hal = OswHal::getInstance();
+    hal->environment()->boostAccelerometer(); // The bubble should follow the hand smoothly
 
     // to better understand the accelerometer values use the debug function
     // debug(hal);
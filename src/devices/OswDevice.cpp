@@ -9,3 +9,14 @@ OswDevice::OswDevice() {
 OswDevice::~OswDevice() {
     this->allDevices.erase(this);
 };
+
+void OswDevice::boost(unsigned long interval, unsigned long duration) {
+    const unsigned long until = millis() + duration;
+    // Devices with multiple interfaces are registered once per interface, the scheduler only looks at one of them
+    const void* object = dynamic_cast<const void*>(this);
+    for(OswDevice* device : allDevices)
+        if(dynamic_cast<const void*>(device) == object) {
+            device->boostInterval = interval;
+            device->boostUntil = until;
+        }
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <climits>
+#include <utility>
+#include <vector>
+
+#include <OswLogger.h>
+#include <devices/OswDeviceScheduler.h>
+
+OswDeviceScheduler::~OswDeviceScheduler() {
+    this->stopTask();
+}
+
+/**
+ * Devices with multiple interfaces are registered once per interface - but must still be updated only once. The set
+ * is ordered by address, so the interfaces of one device (all within its object) are next to each other.
+ */
+static void getUniqueDevices(std::vector<OswDevice*>& devices) {
+    devices.clear();
+    for(OswDevice* device : *OswDevice::getAllDevices())
+        if(devices.empty() or dynamic_cast<const void*>(devices.back()) != dynamic_cast<const void*>(device))
+            devices.push_back(device);
+}
+
+unsigned long OswDeviceScheduler::getInterval(OswDevice* device, unsigned long now) {
+    const unsigned long interval = device->getUpdateInterval();
+    const unsigned long boostInterval = device->boostInterval;
+    if(boostInterval > 0 and (long) (device->boostUntil - now) > 0 and (interval == 0 or boostInterval < interval))
+        return boostInterval;
+    return interval;
+}
+
+void OswDeviceScheduler::update(OswDevice* device, unsigned long now) {
+    const unsigned long interval = getInterval(device, now);
+    device->update();
+    device->lastUpdate = now;
+    // Keep the cadence, unless we are so late that catching up would only burst the bus
+    if(!device->updateScheduled or now - (device->updateSlot + interval) >= interval)
+        device->updateSlot = now;
+    else
+        device->updateSlot += interval;
+    device->updateScheduled = true;
+}
+
+unsigned long OswDeviceScheduler::updateDue(unsigned long now) {
+    std::lock_guard<std::mutex> guard(this->bus);
+    getUniqueDevices(this->devices);
+    std::vector<std::pair<long, OswDevice*>>& due = this->due;
+    due.clear();
+    for(OswDevice* device : this->devices) {
+        const long late = device->updateScheduled ? (long) (now - (device->updateSlot + getInterval(device, now))) : LONG_MAX;
+        if(late >= 0)
+            due.push_back({late, device});
+    }
+    std::stable_sort(due.begin(), due.end(), [](const auto& a, const auto& b) -> bool { return a.first > b.first; });
+
+    unsigned long spent = 0;
+    for(auto& [late, device] : due) {
+        const unsigned long interval = getInterval(device, now);
+        const bool starving = late == LONG_MAX or (interval > 0 and (unsigned long) late >= interval);
+        const unsigned int cost = device->getUpdateCost();
+        if(spent > 0 and spent + cost > this->budget and !starving) {
+            ++this->deferred;
+            continue;
+        }
+        this->update(device, now);
+        spent += cost;
+    }
+
+    unsigned long next = ULONG_MAX;
+    for(OswDevice* device : this->devices) {
+        const long until = device->updateScheduled ? (long) (device->updateSlot + getInterval(device, now) - now) : 0;
+        next = std::min(next, (unsigned long) std::max(until, 0l));
+    }
+    return next;
+}
+
+void OswDeviceScheduler::updateAll(unsigned long now) {
+    std::lock_guard<std::mutex> guard(this->bus);
+    getUniqueDevices(this->devices);
+    for(OswDevice* device : this->devices)
+        this->update(device, now);
+}
+
+void OswDeviceScheduler::updateNow(OswDevice* device, unsigned long now) {
+    std::lock_guard<std::mutex> guard(this->bus);
+    this->update(device, now);
+}
+
+void OswDeviceScheduler::startTask() {
+#ifndef OSW_EMULATOR
+    if(this->taskRunning)
+        return;
+    this->taskRunning = true;
+    this->taskStopped = false;
+    xTaskCreatePinnedToCore([](void* pvParameters) -> void { ((OswDeviceScheduler*) pvParameters)->taskLoop(); },
+                            "oswDevices", this->taskStackSize /*stack*/, this /*input*/, 1 /*prio*/,
+                            &this->task /*handle*/, 0);
+#endif
+}
+
+void OswDeviceScheduler::stopTask() {
+#ifndef OSW_EMULATOR
+    if(!this->taskRunning)
+        return;
+    this->taskRunning = false;
+    while(!this->taskStopped)
+        delay(1);
+#endif
+}
+
+void OswDeviceScheduler::taskLoop() {
+    while(this->taskRunning) {
+        unsigned long next = this->maxTaskDelay;
+        try {
+            next = this->updateDue(millis());
+        } catch(const std::exception& e) {
+            OSW_LOG_E("Device update failed: ", e.what());
+        }
+        delay(std::clamp(next, this->minTaskDelay, this->maxTaskDelay));
+    }
+#ifndef OSW_EMULATOR
+    this->taskStopped = true;
+    vTaskDelete(nullptr); // Inform FreeRTOS this task is done - otherwise the kernel will take that personally and crash!
+#endif
+}
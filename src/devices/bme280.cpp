@@ -27,6 +27,16 @@ void OswDevices::BME280::stop() {
     bme280.setSettings(settings);
 }
 
+void OswDevices::BME280::suspend() {
+    this->stop();
+}
+
+void OswDevices::BME280::resume() {
+    // The sensor still knows its calibration, so there is no need to begin() again
+    settings.mode = ::BME280::Mode_Forced;
+    bme280.setSettings(settings);
+}
+
 void OswDevices::BME280::update() {
     ::BME280::TempUnit tempUnit(::BME280::TempUnit_Celsius);
     ::BME280::PresUnit presUnit(::BME280::PresUnit_Pa);
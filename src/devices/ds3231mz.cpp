@@ -1,14 +1,33 @@
 #include OSW_TARGET_PLATFORM_HEADER
 #if OSW_PLATFORM_HARDWARE_DS3231MZ == 1
+#include <mutex>
 #include <stdexcept>
 
 #include <devices/ds3231mz.h>
 #include <OswLogger.h>
 
+#if OSW_DEVICE_DS3231MZ_USE_SQW == 1
+static volatile int64_t secondEdgeAt = 0;
+
+/**
+ * The seconds register of the DS3231 increments on the falling edge of its 1 Hz square wave
+ */
+static void IRAM_ATTR onSecondEdge() {
+    secondEdgeAt = OswClock::getMonotonicMicros();
+}
+#endif
+
 void OswDevices::DS3231MZ::setup() {
     Rtc.Enable32kHzPin(false);
     if (!Rtc.LastError()) {
+#if OSW_DEVICE_DS3231MZ_USE_SQW == 1
+        Rtc.SetSquareWavePin(DS3231SquareWavePin_ModeClock);
+        Rtc.SetSquareWavePinClockFrequency(DS3231SquareWaveClock_1Hz);
+        pinMode(OSW_DEVICE_DS3231MZ_RTCINT, INPUT_PULLUP); // Open drain
+        attachInterrupt(OSW_DEVICE_DS3231MZ_RTCINT, onSecondEdge, FALLING);
+#else
         Rtc.SetSquareWavePin(DS3231SquareWavePin_ModeNone);
+#endif
 
         RtcDateTime compiled = RtcDateTime(__DATE__, __TIME__);
         if (!Rtc.IsDateTimeValid())
@@ -36,38 +55,73 @@ void OswDevices::DS3231MZ::setup() {
 }
 
 void OswDevices::DS3231MZ::update() {
+    OswClock::Sample sample;
     uint32_t temp = Rtc.GetDateTime().Unix32Time();
     if (!Rtc.LastError()) {
         // success on first attempt
-        _utcTime = temp;
+        sample.utc = temp;
+        sample.at = OswClock::getMonotonicMicros(); // After the read, so the second surely started before
+#if OSW_DEVICE_DS3231MZ_USE_SQW == 1
+        int64_t edge;
+        do {
+            edge = secondEdgeAt; // Two halves, which the interrupt may change in between
+        } while (edge != secondEdgeAt);
+        if (edge != 0 and sample.at - edge < 990000) {
+            // This second started with the last edge
+            sample.at = edge;
+            sample.atSecondEdge = true;
+        }
+#endif
+        this->publish(sample);
         return;
     }
 
     // try harder
     uint8_t tries = 10;
-    while (_utcTime == 0 && tries > 0) {
+    while (this->getUTCTimeSample().utc == 0 && tries > 0) {
         temp = Rtc.GetDateTime().Unix32Time();
         if (!Rtc.LastError()) {
             // success on n-th attempt
-            _utcTime = temp;
+            sample.utc = temp;
+            sample.at = OswClock::getMonotonicMicros();
+            this->publish(sample);
             return;
         }
         tries--;
     }
 
     // fail, assume compile time as closest time in the past
-    _utcTime = RtcDateTime(__DATE__, __TIME__).Unix32Time();
+    sample.utc = RtcDateTime(__DATE__, __TIME__).Unix32Time();
+    sample.at = OswClock::getMonotonicMicros();
+    this->publish(sample);
+}
+
+void OswDevices::DS3231MZ::publish(const OswClock::Sample& sample) {
+    std::lock_guard<std::mutex> guard(this->_sampleLock);
+    this->_sample = sample;
 }
 
 time_t OswDevices::DS3231MZ::getUTCTime() {
-    // I2C access :(
-    return _utcTime;
+    // No I2C access, the last read is advanced by the timer
+    const OswClock::Sample sample = this->getUTCTimeSample();
+    return sample.utc + (OswClock::getMonotonicMicros() - sample.at) / 1000000;
+}
+
+OswClock::Sample OswDevices::DS3231MZ::getUTCTimeSample() {
+    std::lock_guard<std::mutex> guard(this->_sampleLock);
+    return this->_sample;
 }
 
 void OswDevices::DS3231MZ::setUTCTime(const time_t& epoch) {
     RtcDateTime t = RtcDateTime();
     t.InitWithUnix32Time(epoch);
     Rtc.SetDateTime(t);
+    // Writing the seconds restarts them
+    OswClock::Sample sample;
+    sample.utc = epoch;
+    sample.at = OswClock::getMonotonicMicros();
+    sample.atSecondEdge = true;
+    this->publish(sample);
 }
 
 float OswDevices::DS3231MZ::getTemperature() {
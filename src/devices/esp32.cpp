@@ -69,48 +69,6 @@ void OswDevices::NativeESP32::setUTCTime(const time_t& epoch) {
     settimeofday(&now, nullptr);
 }
 
-/**
- * @brief Works as described in OswTimeProvider - but this implementation
- * may change the output of the function std::localtime() temporarly!
- *
- * @throws std::logic_error if the provider does not support timezones
- * @param timestamp timestamp to transform
- * @param timezone based on this POSIX string
- * @return time_t transformed timestamp
- */
-time_t OswDevices::NativeESP32::getTimezoneOffset(const time_t& timestamp, const String& timezone) {
-    bool hasOldTimezone = getenv("TZ") != nullptr;
-    String oldTimezone; // Variable to hold local copy, as the value by getenv() may change after a setenv()
-    if(hasOldTimezone)
-        oldTimezone = getenv("TZ");
-
-    setenv("TZ", timezone.c_str(), 1); // overwrite the TZ environment variable
-    tzset();
-    std::tm localTm = *std::localtime(&timestamp);
-
-    setenv("TZ", "UTC0", 1); // overwrite the TZ environment variable
-    tzset();
-    std::tm utcTm = *std::localtime(&timestamp);
-    std::time_t utc = std::mktime(&utcTm);
-    std::time_t local = std::mktime(&localTm); // this removes the "local"/dst offsets by UTC from our localized timestamp -> we get the UTC timestamp INCLUDING the local offsets!
-
-    // Why not just use this ↓ ? Because the code below works with GMT to UTC and also
-    // gives the mktime() a non-localozed timestamp, causing the DST to be dropped.
-    // Therefore it works great in the winter, but breaks in the summer (...).
-    // setenv("TZ", timezone.c_str(), 1); // overwrite the TZ environment variable
-    // tzset();
-    // const time_t utc = mktime(std::gmtime(&timestamp));
-    // const time_t local = mktime(std::localtime(&timestamp));
-
-    if(hasOldTimezone) {
-        setenv("TZ", oldTimezone.c_str(), 1); // restore the TZ environment variable
-        tzset();
-    }
-    if(utc == -1 or local == -1)
-        throw std::logic_error("Could not represent times in std::time_t?!");
-    return local - utc;
-}
-
 float OswDevices::NativeESP32::getTemperature() {
 #if OSW_DEVICE_ESP32_USE_INTTEMP == 1
     const uint8_t temp = temprature_sens_read();
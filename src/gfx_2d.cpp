@@ -4,26 +4,36 @@
 #include "gfx_2d.h"
 #include "gfx_util.h"
 #include "math_angles.h"
+#include "OswMemoryTracker.h"
 
 #include <stdio.h>
+#include <string.h>
 
 #pragma GCC optimize("O2")
 
 void Graphics2D::fillBuffer(uint16_t color = rgb565(0, 0, 0)) {
+    if (displayList != NULL && !replayingStrip) {
+        // Everything recorded so far would be overdrawn anyway, so this starts a new frame
+        displayListLength = 0;
+        stripBackground = color;
+        renderedStrip = -1;
+        displayListSpilled = false;
+        return;
+    }
     if (!hasBuffer())
         return;
 
     for (int chunk = numChunks - 1; chunk >= 0; --chunk) {
-        for (int i = (chunkWidths[chunk] << chunkHeightLd) - 1; i >= 0; --i) {
+        for (int i = (getChunkWidth(chunk) << chunkHeightLd) - 1; i >= 0; --i) {
             buffer[chunk][i] = color;
         }
     }
 }
 
-void Graphics2D::enableBuffer() {
-    drawPixelCallback = NULL;
+void Graphics2D::initChunkLayout() {
+    if (numChunks != 0)
+        return;  // Computed once, so the layout never moves
     numChunks = height >> chunkHeightLd;
-    buffer = new uint16_t* [numChunks];
     if (isRound) {
         missingPixelColor = rgb565(128, 128, 128);
         chunkXOffsets = new uint16_t[numChunks];
@@ -46,43 +56,119 @@ void Graphics2D::enableBuffer() {
             // Serial.println(chunkHeight);
             // Serial.print("    Size: ");
             // Serial.println(chunkWidth * chunkHeight);
-            // buffer[i] = new uint16_t[chunkWidth * chunkHeight];
-            if (allocatePsram) {
-#if defined(GPS_EDITION) || defined(GPS_EDITION_ROTATED)
-                buffer[i] = (uint16_t*)ps_malloc((width << chunkHeightLd) * sizeof(uint16_t));
-#else
-                buffer[i] = new uint16_t[width << chunkHeightLd]();
-#endif
-            } else {
-                buffer[i] = new uint16_t[width << chunkHeightLd]();
-            }
         }
-    } else {
+    }
+}
+
+size_t Graphics2D::getFramePixels() {
+    size_t pixels = 0;
+    for (uint16_t i = 0; i < numChunks; i++) {
+        // Every chunk starts 4 byte aligned, so it can be handed to the display bus (and DMA) as it is
+        pixels += ((getChunkWidth(i) << chunkHeightLd) + 1) & ~1;
+    }
+    return pixels;
+}
+
+bool Graphics2D::allocateFrameMemory(uint8_t frames) {
+    const size_t size = getFramePixels() * frames * sizeof(uint16_t);
+    if (frameMemory != NULL && frameMemorySize == size)
+        return true;  // Still there from the last time
+    freeFrameMemory();
+    // Accounted as DISPLAY, unless a caller attributes the canvas to something else (e.g. a map tile)
+    frameMemory = (uint16_t*)OswMemoryTracker::allocate(size, OswMemoryTracker::getCurrentTag(OswMemoryTag::DISPLAY),
+                                                        allocatePsram);
+    if (frameMemory == NULL)
+        return false;
+    memset(frameMemory, 0, size);
+    frameMemorySize = size;
+    return true;
+}
+
+void Graphics2D::freeFrameMemory() {
+    OswMemoryTracker::release(frameMemory);
+    frameMemory = NULL;
+    frameMemorySize = 0;
+}
+
+void Graphics2D::mapFrames(uint8_t frames) {
+    uint16_t* chunk = frameMemory;
+    for (uint8_t frame = 0; frame < frames; frame++) {
+        uint16_t** chunks = frame == 0 ? buffer : frontBuffer;
         for (uint16_t i = 0; i < numChunks; i++) {
-            // buffer[i] = new uint16_t[width * chunkHeight];
-            // (uint8_t*) malloc( BufferSize * sizeof(uint8_t) )
-            if (allocatePsram) {
-#if defined(GPS_EDITION) || defined(GPS_EDITION_ROTATED)
-                buffer[i] = (uint16_t*)ps_malloc((width << chunkHeightLd) * sizeof(uint16_t));
-#else
-                buffer[i] = new uint16_t[width << chunkHeightLd]();
-#endif
-            } else {
-                buffer[i] = new uint16_t[width << chunkHeightLd]();
-            }
+            chunks[i] = chunk;
+            chunk += ((getChunkWidth(i) << chunkHeightLd) + 1) & ~1;
         }
     }
 }
 
+void Graphics2D::enableBuffer(bool doubleBuffered) {
+    releaseBuffers();
+    drawPixelCallback = NULL;
+    initChunkLayout();
+    const uint8_t frames = doubleBuffered ? 2 : 1;
+    if (!allocateFrameMemory(frames)) {
+        if (!doubleBuffered || !allocateFrameMemory(1))
+            return;  // Out of memory, every draw call is dropped
+        doubleBuffered = false;
+    }
+    buffer = new uint16_t* [numChunks];
+    if (doubleBuffered)
+        frontBuffer = new uint16_t* [numChunks];
+    mapFrames(doubleBuffered ? 2 : 1);
+}
+
+void Graphics2D::swapBuffers() {
+    if (frontBuffer == NULL)
+        return;
+    uint16_t** previous = buffer;
+    buffer = frontBuffer;
+    frontBuffer = previous;
+}
+
+void Graphics2D::enableStripBuffer(uint8_t stripChunks_, uint16_t displayListSize_) {
+    releaseBuffers();
+    drawPixelCallback = NULL;
+    initChunkLayout();
+    // All chunk pointers stay NULL, except the ones of the strip currently rendered
+    buffer = new uint16_t* [numChunks]();
+    stripChunks = stripChunks_ < 1 ? 1 : (stripChunks_ < numChunks ? stripChunks_ : numChunks);
+    stripMemory = new uint16_t[(width << chunkHeightLd) * stripChunks]();
+    displayListSize = displayListSize_;
+    displayListLength = 0;
+    displayList = new DisplayListOp[displayListSize];
+    renderedStrip = -1;
+    displayListSpilled = false;
+}
+
 void Graphics2D::disableBuffer(DrawPixel* callback) {
-    delay(1000);
+    releaseBuffers();
     drawPixelCallback = callback;
-    for (int32_t i = numChunks - 1; i >= 0; --i) {
-        delete[] buffer[i];
-        buffer[i] = NULL;
-    }
+}
+
+void Graphics2D::setFrameMemoryReserved(bool reserved) {
+    frameMemoryReserved = reserved;
+    if (!reserved && !hasBuffer())
+        freeFrameMemory();
+}
+
+void Graphics2D::releaseBuffers() {
     delete[] buffer;
     buffer = NULL;
+    delete[] frontBuffer;
+    frontBuffer = NULL;
+    if (!frameMemoryReserved)
+        freeFrameMemory();
+
+    delete[] stripMemory;
+    stripMemory = NULL;
+    delete[] displayList;
+    displayList = NULL;
+    displayListLength = 0;
+}
+
+Graphics2D::~Graphics2D() {
+    releaseBuffers();
+    freeFrameMemory();
 
     delete[] chunkXOffsets;
     chunkXOffsets = NULL;
@@ -91,19 +177,133 @@ void Graphics2D::disableBuffer(DrawPixel* callback) {
     chunkWidths = NULL;
 }
 
-Graphics2D::~Graphics2D() {
-    for (int32_t i = numChunks - 1; i >= 0; --i) {
-        delete[] buffer[i];
-        buffer[i] = NULL;
+void Graphics2D::recordOp(const DisplayListOp& op) {
+    if (displayListLength == displayListSize || displayListSpilled) {
+        ++displayListOverflows;
+        if (displayListSpill == NULL)
+            return;
+        if (!displayListSpilled) {
+            displayListSpilled = true;
+            displayListSpill->begin(this);
+        }
+        spillOp(op);
+        return;
     }
-    delete[] buffer;
-    buffer = NULL;
+    displayList[displayListLength++] = op;
+    renderedStrip = -1;
+}
 
-    delete[] chunkXOffsets;
-    chunkXOffsets = NULL;
+/**
+ * @brief Draw an operation which did not fit into the display list through the spill.
+ */
+void Graphics2D::spillOp(const DisplayListOp& op) {
+    if (op.flags & DISPLAY_LIST_DIM)
+        return; // The pixels on the display are not known
+    const uint16_t color = op.flags & DISPLAY_LIST_BLEND ? blend(stripBackground, op.color, op.alpha) : op.color;
+    for (int32_t j = 0; j < op.length; j++) {
+        const int32_t px = op.flags & DISPLAY_LIST_VERTICAL ? op.x : op.x + j;
+        const int32_t py = op.flags & DISPLAY_LIST_VERTICAL ? op.y + j : op.y;
+        if (px < width && py < height && px >= 0 && py >= 0)
+            displayListSpill->drawPixel(px, py, color);
+    }
+}
 
-    delete[] chunkWidths;
-    chunkWidths = NULL;
+/**
+ * @brief Record a single pixel, by extending the previous operation whenever possible.
+ *
+ * Lines, fills and text are drawn pixel by pixel in (mostly) rising or falling order, so they end up as runs.
+ */
+void Graphics2D::recordPixel(int32_t x, int32_t y, uint16_t color, uint8_t flags, uint8_t alpha) {
+    if (displayListLength > 0 && !displayListSpilled) {
+        renderedStrip = -1;
+        DisplayListOp& last = displayList[displayListLength - 1];
+        if (last.color == color && (last.flags & ~DISPLAY_LIST_VERTICAL) == flags && last.alpha == alpha && last.length < UINT16_MAX) {
+            bool vertical = last.flags & DISPLAY_LIST_VERTICAL;
+            if (last.length == 1 && last.x == x && (y == last.y + 1 || y == last.y - 1)) {
+                last.flags |= DISPLAY_LIST_VERTICAL; // A single pixel may still become a vertical run
+                vertical = true;
+            }
+            if (!vertical && last.y == y) {
+                if (x == last.x + last.length) {
+                    ++last.length;
+                    return;
+                } else if (x == last.x - 1) {
+                    --last.x;
+                    ++last.length;
+                    return;
+                }
+            } else if (vertical && last.x == x) {
+                if (y == last.y + last.length) {
+                    ++last.length;
+                    return;
+                } else if (y == last.y - 1) {
+                    --last.y;
+                    ++last.length;
+                    return;
+                }
+            }
+        }
+    }
+    recordOp({(int16_t) x, (int16_t) y, 1, color, flags, alpha});
+}
+
+void Graphics2D::renderStrip(uint16_t firstChunk) {
+    for (uint16_t i = 0; i < numChunks; i++)
+        buffer[i] = NULL;
+    const uint16_t lastChunk = firstChunk + stripChunks < numChunks ? firstChunk + stripChunks : numChunks;
+    for (uint16_t i = firstChunk; i < lastChunk; i++) {
+        buffer[i] = stripMemory + (i - firstChunk) * (width << chunkHeightLd);
+        for (int j = (getChunkWidth(i) << chunkHeightLd) - 1; j >= 0; --j)
+            buffer[i][j] = stripBackground;
+    }
+    const int32_t top = firstChunk << chunkHeightLd;
+    const int32_t bottom = lastChunk << chunkHeightLd;
+
+    // The mask and alpha were already applied while recording
+    const bool wasMaskEnabled = maskEnabled;
+    const bool wasAlphaEnabled = alphaEnabled;
+    maskEnabled = false;
+    alphaEnabled = false;
+    replayingStrip = true;
+    for (uint16_t i = 0; i < displayListLength; i++) {
+        const DisplayListOp& op = displayList[i];
+        if (op.flags & DISPLAY_LIST_DIM) {
+            if (op.length == 0)
+                dimArea(0, top, width, bottom - top, op.alpha);
+            else if (op.y < bottom && op.y + op.color > top) {
+                const int32_t from = op.y > top ? op.y : top;
+                const int32_t to = op.y + op.color < bottom ? op.y + op.color : bottom;
+                dimArea(op.x, from, op.length, to - from, op.alpha);
+            }
+            continue;
+        }
+        int32_t x = op.x;
+        int32_t y = op.y;
+        int32_t length = op.length;
+        if (op.flags & DISPLAY_LIST_VERTICAL) {
+            // Clip the run to the strip
+            if (y < top) {
+                length -= top - y;
+                y = top;
+            }
+            if (y + length > bottom)
+                length = bottom - y;
+        } else if (y < top || y >= bottom) {
+            continue;
+        }
+        for (int32_t j = 0; j < length; j++) {
+            const int32_t px = op.flags & DISPLAY_LIST_VERTICAL ? x : x + j;
+            const int32_t py = op.flags & DISPLAY_LIST_VERTICAL ? y + j : y;
+            if (op.flags & DISPLAY_LIST_BLEND)
+                drawPixelClipped(px, py, blend(getPixel(px, py), op.color, op.alpha));
+            else
+                drawPixelClipped(px, py, op.color);
+        }
+    }
+    replayingStrip = false;
+    maskEnabled = wasMaskEnabled;
+    alphaEnabled = wasAlphaEnabled;
+    renderedStrip = firstChunk;
 }
 
 void Graphics2D::drawPixelClipped(int32_t x, int32_t y, uint16_t color) {
@@ -120,6 +320,18 @@ void Graphics2D::drawPixelClipped(int32_t x, int32_t y, uint16_t color) {
         drawPixelCallback->drawPixel(x, y, color);
         return;
     }
+    if (displayList != NULL) {
+        if (!replayingStrip) {
+            // Pixels below are not known before the replay, so the alpha must be blended then
+            recordPixel(x, y, color, alphaEnabled ? DISPLAY_LIST_BLEND : 0, alphaEnabled ? alpha * 255 : 0);
+            return;
+        }
+        if (buffer[y >> chunkHeightLd] == NULL)
+            return; // Outside of the current strip
+    }
+    if (buffer == NULL) {
+        return;  // The frame memory could not be allocated
+    }
 
     uint8_t chunkId = y >> chunkHeightLd;
     int16_t chunkY = y - (chunkId << chunkHeightLd);
@@ -147,18 +359,39 @@ uint16_t Graphics2D::getPixel(uint16_t x, uint16_t y) {
         return 0;
     }
     uint8_t chunkId = y >> chunkHeightLd;
+    if (displayList != NULL && !replayingStrip && renderedStrip != chunkId - chunkId % stripChunks) {
+        renderStrip(chunkId - chunkId % stripChunks); // The pixel is only known after the operations recorded so far
+    }
+    return readPixel(buffer, x, y);
+}
+
+uint16_t Graphics2D::getShownPixel(uint16_t x, uint16_t y) {
+    if (frontBuffer == NULL) {
+        return getPixel(x, y);
+    }
+    if (x >= width || y >= height) {
+        return 0;
+    }
+    return readPixel(frontBuffer, x, y);
+}
+
+uint16_t Graphics2D::readPixel(uint16_t** chunks, uint16_t x, uint16_t y) {
+    uint8_t chunkId = y >> chunkHeightLd;
+    if (chunks == NULL || chunks[chunkId] == NULL) {
+        return 0; // Unbuffered or outside of the current strip
+    }
     uint16_t chunkY = y - (chunkId << chunkHeightLd);
     // printf("chunkid %d, offetY %d for y=%d and chunkHeight=%d\n", chunkId, chunkY, y, chunkHeight);
     if (isRound) {
         // TODO: check if inside chunk
         if (isInsideChunk(x, y)) {
             uint16_t chunkX = x - chunkXOffsets[chunkId];
-            return buffer[chunkId][chunkX + chunkY * chunkWidths[chunkId]];
+            return chunks[chunkId][chunkX + chunkY * chunkWidths[chunkId]];
         } else {
             return missingPixelColor;
         }
     } else {
-        return buffer[chunkId][x + chunkY * width];
+        return chunks[chunkId][x + chunkY * width];
     }
 }
 
@@ -186,6 +419,66 @@ void Graphics2D::drawHLine(int32_t x, int32_t y, uint16_t w, uint16_t color) {
     }
 }
 
+void Graphics2D::drawSpan(int32_t x, int32_t y, const uint16_t* colors, uint16_t w) {
+    if (buffer == NULL || drawPixelCallback != NULL || (displayList != NULL && !replayingStrip) || maskEnabled || alphaEnabled) {
+        for (uint16_t i = 0; i < w; i++) {
+            drawPixel(x + i, y, colors[i]);
+        }
+        return;
+    }
+    if (y < 0 || y >= height) {
+        return;
+    }
+    uint8_t chunkId = y >> chunkHeightLd;
+    if (buffer[chunkId] == NULL) {
+        return;  // Outside of the current strip
+    }
+    int32_t chunkY = y - (chunkId << chunkHeightLd);
+
+    // Same pixels as drawPixelClipped() would write
+    int32_t left = 0;
+    int32_t right = width;
+    uint16_t* row = buffer[chunkId] + chunkY * width;
+    if (isRound) {
+        left = chunkXOffsets[chunkId] + 1;
+        right = chunkXOffsets[chunkId] + chunkWidths[chunkId];
+        row = buffer[chunkId] + chunkY * chunkWidths[chunkId];
+    }
+    int32_t from = x > left ? x : left;
+    int32_t to = x + w < right ? x + w : right;
+    if (from < to) {
+        memcpy(row + (from - (isRound ? chunkXOffsets[chunkId] : 0)), colors + (from - x), (to - from) * sizeof(uint16_t));
+    }
+}
+
+void Graphics2D::drawPixels(const int16_t* x, const int16_t* y, const uint16_t* colors, uint16_t count) {
+    if (buffer == NULL || drawPixelCallback != NULL || (displayList != NULL && !replayingStrip) || maskEnabled || alphaEnabled) {
+        for (uint16_t i = 0; i < count; i++) {
+            drawPixel(x[i], y[i], colors[i]);
+        }
+        return;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        if (x[i] < 0 || y[i] < 0 || x[i] >= width || y[i] >= height) {
+            continue;
+        }
+        uint8_t chunkId = y[i] >> chunkHeightLd;
+        if (buffer[chunkId] == NULL) {
+            continue;  // Outside of the current strip
+        }
+        int32_t chunkY = y[i] - (chunkId << chunkHeightLd);
+        if (isRound) {
+            // Same pixels as drawPixelClipped() would write
+            int32_t chunkX = x[i] - chunkXOffsets[chunkId];
+            if (chunkX > 0 && chunkX < chunkWidths[chunkId]) {
+                buffer[chunkId][chunkX + chunkY * chunkWidths[chunkId]] = colors[i];
+            }
+        } else {
+            buffer[chunkId][x[i] + chunkY * width] = colors[i];
+        }
+    }
+}
+
 /**
  * @brief Draw a vertical line from the bottom point (x,y) to an other vertical point at h pixels
  *
@@ -1460,6 +1753,10 @@ void Graphics2D::drawBWBitmap(int16_t x0, int16_t y0, int16_t cnt, int16_t h, ui
  * @param color Color code
  */
 void Graphics2D::fill(uint16_t color) {
+    if (displayList != NULL && !replayingStrip && !alphaEnabled && !(maskEnabled && color == maskColor)) {
+        fillBuffer(color);
+        return;
+    }
     for (int16_t x = width-1; x >= 0; --x) {
         for (int16_t y = height-1; y >= 0 ; --y) {
             drawPixel(x, y, color);
@@ -1468,9 +1765,53 @@ void Graphics2D::fill(uint16_t color) {
 }
 
 void Graphics2D::dim(uint8_t amount) {
-    for (int16_t x = width-1; x >= 0; --x) {
-        for (int16_t y = height-1; y >= 0 ; --y) {
-            drawPixel(x, y, dimColor(getPixel(x, y), amount));
+    if (displayList != NULL && !replayingStrip) {
+        recordOp({0, 0, 0, 0, DISPLAY_LIST_DIM, amount});
+        return;
+    }
+    dimArea(0, 0, width, height, amount);
+}
+
+void Graphics2D::dimArea(int32_t x, int32_t y, uint16_t w, uint16_t h, uint8_t amount) {
+    if (w == 0 || h == 0) {
+        return;
+    }
+    if (displayList != NULL && !replayingStrip) {
+        recordOp({(int16_t) x, (int16_t) y, w, h, DISPLAY_LIST_DIM, amount});
+        return;
+    }
+    if (buffer == NULL || drawPixelCallback != NULL || maskEnabled || alphaEnabled) {
+        for (int32_t py = y; py < y + h; py++) {
+            for (int32_t px = x; px < x + w; px++) {
+                drawPixel(px, py, dimColor(getPixel(px, py), amount));
+            }
+        }
+        return;
+    }
+    const int32_t top = y > 0 ? y : 0;
+    const int32_t bottom = y + h < height ? y + h : height;
+    for (int32_t py = top; py < bottom; py++) {
+        uint8_t chunkId = py >> chunkHeightLd;
+        if (buffer[chunkId] == NULL) {
+            continue;  // Outside of the current strip
+        }
+        int32_t chunkY = py - (chunkId << chunkHeightLd);
+
+        // Same pixels as drawPixelClipped() would write
+        int32_t left = 0;
+        int32_t right = width;
+        int32_t offset = 0;
+        uint16_t* row = buffer[chunkId] + chunkY * width;
+        if (isRound) {
+            offset = chunkXOffsets[chunkId];
+            left = offset + 1;
+            right = offset + chunkWidths[chunkId];
+            row = buffer[chunkId] + chunkY * chunkWidths[chunkId];
+        }
+        int32_t from = x > left ? x : left;
+        int32_t to = x + w < right ? x + w : right;
+        for (int32_t px = from; px < to; px++) {
+            row[px - offset] = dimColor(row[px - offset], amount);
         }
     }
 }
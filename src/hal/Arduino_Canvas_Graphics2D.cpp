@@ -1,21 +1,122 @@
 #include "Arduino_Canvas_Graphics2D.h"
 
+#include <algorithm>
+#include <cstring>
+
 #ifndef OSW_EMULATOR
 #include <Arduino_DataBus.h>
 #endif
 #include <gfx_2d_print.h>
 
 Arduino_Canvas_Graphics2D::Arduino_Canvas_Graphics2D(int16_t w, int16_t h, Arduino_G* output, int16_t output_x, int16_t output_y)
-    : Graphics2DPrint(w, h, DISP_CHUNK_H_LD, true), _output(output), _output_x(output_x), _output_y(output_y)
-{}
+    : Graphics2DPrint(w, h, DISP_CHUNK_H_LD, true), _output(output), _output_x(output_x), _output_y(output_y), _spill(this) {
+    this->setDisplayListSpill(&this->_spill);
+}
 
 void Arduino_Canvas_Graphics2D::flush() {
+    // Only the chunks overlapping the limit (by default all of them)
+    const int16_t firstRow = std::max<int16_t>(this->_flushLimitStart, 0);
+    const int16_t lastRow = std::min<int16_t>(this->_flushLimitEnd, this->getHeight()) - 1;
+    this->resetFlushLimit();
+    this->_lastFlushRows = 0;
+    if (lastRow < firstRow) {
+        this->flushNothing();
+        return;
+    }
+    const uint16_t firstChunk = firstRow >> chunkHeightLd;
+    const uint16_t lastChunk = lastRow >> chunkHeightLd;
+
     // only flush if there is a buffer
     if (this->hasBuffer()) {
-        uint8_t chunkHeight = 1 << chunkHeightLd;
-        for (uint8_t chunk = 0; chunk < this->getNumChunks(); chunk++) {
-            _output->draw16bitRGBBitmap(this->getChunkOffset(chunk), chunk * chunkHeight, this->getChunk(chunk),
-                                        this->getChunkWidth(chunk), chunkHeight);
+        if (this->isDoubleBuffered()) {
+            // The front frame is sent as it is, but only after the previous one (now drawn over) is off the wire
+            this->waitForFlush();
+            this->swapBuffers();
+        }
+        for (uint16_t chunk = firstChunk; chunk <= lastChunk; chunk++)
+            this->flushChunk(chunk, chunk == lastChunk);
+    } else if (this->hasStripBuffer()) {
+        if (this->isDisplayListSpilled()) {
+            // The display list overflowed, so the whole frame is on the display already
+            this->_lastFlushRows = this->getHeight();
+            this->flushNothing();
+            return;
         }
+        this->flushStrips(firstChunk, lastChunk, true);
+    } else {
+        this->flushNothing(); // Drawn to the display directly
+    }
+}
+
+void Arduino_Canvas_Graphics2D::flushNothing() {
+    // Whoever waits for the frame to be done must still be told (without a queue, the caller reports it right away)
+    if (this->_flushQueue)
+        this->_flushQueue->submitFrameEnd();
+}
+
+void Arduino_Canvas_Graphics2D::flushStrips(uint16_t firstChunk, uint16_t lastChunk, bool endOfFrame) {
+    for (uint16_t strip = firstChunk - firstChunk % this->getStripChunks(); strip <= lastChunk; strip += this->getStripChunks()) {
+        this->renderStrip(strip);
+        for (uint16_t chunk = std::max(strip, firstChunk); chunk < strip + this->getStripChunks() and chunk <= lastChunk; chunk++)
+            this->flushChunk(chunk, endOfFrame and chunk == lastChunk);
     }
 }
+
+void Arduino_Canvas_Graphics2D::OutputSpill::begin(Graphics2D* gfx) {
+    this->canvas->flushStrips(0, this->canvas->getNumChunks() - 1, false);
+    this->canvas->waitForFlush(); // The pixels are written to the output directly from now on
+}
+
+void Arduino_Canvas_Graphics2D::OutputSpill::drawPixel(int32_t x, int32_t y, uint16_t color) {
+    this->canvas->_output->draw16bitRGBBitmap(x, y, &color, 1, 1);
+}
+
+void Arduino_Canvas_Graphics2D::limitNextFlush(int16_t y, uint16_t h) {
+    this->_flushLimitStart = y;
+    this->_flushLimitEnd = y + h;
+}
+
+void Arduino_Canvas_Graphics2D::resetFlushLimit() {
+    this->_flushLimitStart = 0;
+    this->_flushLimitEnd = INT16_MAX;
+}
+
+void Arduino_Canvas_Graphics2D::flushChunk(uint8_t chunk, bool lastOfFrame) {
+    uint8_t chunkHeight = 1 << chunkHeightLd;
+    this->_lastFlushRows += chunkHeight;
+    if (this->isDoubleBuffered()) {
+        uint16_t* front = this->getFrontChunk(chunk);
+        if (this->_flushQueue)
+            this->_flushQueue->submitUnowned(front, this->getChunkOffset(chunk), chunk * chunkHeight,
+                                             this->getChunkWidth(chunk), chunkHeight, lastOfFrame);
+        else
+            _output->draw16bitRGBBitmap(this->getChunkOffset(chunk), chunk * chunkHeight, front,
+                                        this->getChunkWidth(chunk), chunkHeight);
+    } else if (this->_flushQueue) {
+        // Snapshot the chunk, so the next frame (or strip) can be drawn while this one is still being sent
+        const uint16_t chunkWidth = this->getChunkWidth(chunk);
+        uint16_t* transfer = this->_flushQueue->acquire();
+        memcpy(transfer, this->getChunk(chunk), (chunkWidth << chunkHeightLd) * sizeof(uint16_t));
+        this->_flushQueue->submit(transfer, this->getChunkOffset(chunk), chunk * chunkHeight, chunkWidth,
+                                  chunkHeight, lastOfFrame);
+    } else
+        _output->draw16bitRGBBitmap(this->getChunkOffset(chunk), chunk * chunkHeight, this->getChunk(chunk),
+                                    this->getChunkWidth(chunk), chunkHeight);
+}
+
+void Arduino_Canvas_Graphics2D::enableAsyncFlush(uint8_t bufferCount) {
+    if (this->_flushQueue)
+        return;
+    // The widest chunk is the full display width - and a double buffered frame is queued at once
+    this->_flushQueue.reset(new OswDisplayFlushQueue(_output, bufferCount, (size_t) this->getWidth() << chunkHeightLd,
+                            this->getNumChunks()));
+}
+
+void Arduino_Canvas_Graphics2D::disableAsyncFlush() {
+    this->_flushQueue.reset(); // Finishes all pending transfers
+}
+
+void Arduino_Canvas_Graphics2D::waitForFlush() {
+    if (this->_flushQueue)
+        this->_flushQueue->waitIdle();
+}
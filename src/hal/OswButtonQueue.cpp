@@ -0,0 +1,72 @@
+#include "OswButtonQueue.h"
+
+#ifdef OSW_EMULATOR
+#define IRAM_ATTR
+#else
+#include <Arduino.h>
+#endif
+
+static_assert((OswButtonQueue::capacity & (OswButtonQueue::capacity - 1)) == 0, "The button queue capacity must be a power of two");
+
+OswButtonQueue OswButtonQueue::instance;
+
+void IRAM_ATTR OswButtonQueue::push(Button button, bool down, unsigned long timestamp) {
+#ifdef OSW_EMULATOR
+    std::lock_guard<std::mutex> guard(this->producerLock);
+#else
+    portENTER_CRITICAL_SAFE(&this->producerLock); // Works in both, the interrupt and the task
+#endif
+    const uint32_t head = this->head.load(std::memory_order_relaxed);
+    if(head - this->tail.load(std::memory_order_acquire) >= capacity) {
+        ++this->dropped;
+    } else {
+        this->ring[head & (capacity - 1)] = {timestamp, button, down};
+        this->head.store(head + 1, std::memory_order_release);
+    }
+#ifndef OSW_EMULATOR
+    portEXIT_CRITICAL_SAFE(&this->producerLock);
+#endif
+}
+
+size_t OswButtonQueue::drain(unsigned long now, Edge* edges, size_t max) {
+    size_t count = 0;
+    // Accepts every pending level, which was stable until "time" - the oldest first, to keep the order of the presses
+    auto acceptStable = [&](unsigned long time) {
+        while(true) {
+            int8_t oldest = -1;
+            for(uint8_t button = 0; button < BTN_NUMBER; button++)
+                if(this->pending[button] and (long) (time - this->pendingSince[button]) >= (long) debounceTime and
+                        (oldest < 0 or this->pendingSince[button] < this->pendingSince[oldest]))
+                    oldest = button;
+            if(oldest < 0)
+                return;
+            this->accepted[oldest] = !this->accepted[oldest];
+            this->pending[oldest] = false;
+            if(count < max)
+                edges[count++] = {this->pendingSince[oldest], (Button) oldest, this->accepted[oldest]};
+        }
+    };
+
+    uint32_t tail = this->tail.load(std::memory_order_relaxed);
+    const uint32_t head = this->head.load(std::memory_order_acquire);
+    for(; tail != head; ++tail) {
+        const Edge edge = this->ring[tail & (capacity - 1)];
+        acceptStable(edge.timestamp);
+        if(edge.down == this->accepted[edge.button]) {
+            this->pending[edge.button] = false; // Bounced back (or a duplicate)
+        } else if(!this->pending[edge.button]) {
+            this->pending[edge.button] = true;
+            this->pendingSince[edge.button] = edge.timestamp;
+        }
+    }
+    this->tail.store(tail, std::memory_order_release);
+
+    acceptStable(now);
+    return count;
+}
+
+void OswButtonQueue::reset(const std::array<bool, BTN_NUMBER>& down) {
+    this->tail.store(this->head.load(std::memory_order_acquire), std::memory_order_release);
+    this->accepted = down;
+    this->pending = {};
+}
@@ -0,0 +1,157 @@
+#include "OswDisplayFlushQueue.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include <OswLogger.h>
+#ifndef OSW_EMULATOR
+#include <esp_heap_caps.h>
+#endif
+
+OswDisplayFlushQueue::OswDisplayFlushQueue(Arduino_G* output, uint8_t bufferCount, size_t bufferPixels, uint8_t maxPending)
+    : output(output), bufferCount(bufferCount), bufferPixels(bufferPixels), maxPending(std::max(bufferCount, maxPending)),
+      buffers(new uint16_t*[bufferCount]), freeBuffers(new uint16_t*[bufferCount]), pending(new Transfer[this->maxPending]) {
+    for(uint8_t i = 0; i < this->bufferCount; i++) {
+#ifndef OSW_EMULATOR
+        // The bus driver can then hand the buffer to the SPI DMA without an extra bounce copy
+        this->buffers[i] = (uint16_t*) heap_caps_malloc(this->bufferPixels * sizeof(uint16_t), MALLOC_CAP_DMA);
+#else
+        this->buffers[i] = new uint16_t[this->bufferPixels];
+#endif
+        assert(this->buffers[i] != nullptr && "Failed to allocate display transfer buffer");
+        this->freeBuffers[i] = this->buffers[i];
+    }
+    this->freeCount = this->bufferCount;
+
+#ifndef OSW_EMULATOR
+    xTaskCreatePinnedToCore([](void* pvParameters) -> void { ((OswDisplayFlushQueue*) pvParameters)->work(); },
+                            "oswDisplayFlush", this->workerStackSize /*stack*/, this /*input*/, 2 /*prio*/,
+                            &this->worker /*handle*/, 0);
+#else
+    this->worker.reset(new std::jthread([this]() -> void { this->work(); }));
+#endif
+}
+
+OswDisplayFlushQueue::~OswDisplayFlushQueue() {
+    {
+        // The worker drains all pending transfers before it stops
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->stopping = true;
+    }
+    this->changed.notify_all();
+#ifndef OSW_EMULATOR
+    {
+        std::unique_lock<std::mutex> guard(this->lock);
+        this->changed.wait(guard, [this]() {
+            return this->workerStopped;
+        });
+    }
+#else
+    this->worker.reset(); // Joins the thread
+#endif
+
+    for(uint8_t i = 0; i < this->bufferCount; i++) {
+#ifndef OSW_EMULATOR
+        heap_caps_free(this->buffers[i]);
+#else
+        delete[] this->buffers[i];
+#endif
+    }
+}
+
+uint16_t* OswDisplayFlushQueue::acquire() {
+    std::unique_lock<std::mutex> guard(this->lock);
+    this->changed.wait(guard, [this]() {
+        return this->freeCount > 0;
+    });
+    uint16_t* buffer = this->freeBuffers[this->freeHead];
+    this->freeHead = (this->freeHead + 1) % this->bufferCount;
+    --this->freeCount;
+    return buffer;
+}
+
+void OswDisplayFlushQueue::submit(uint16_t* pixels, int16_t x, int16_t y, int16_t w, int16_t h, bool endOfFrame) {
+    assert((size_t) w * h <= this->bufferPixels && "Transfer exceeds the buffer size");
+    this->enqueue({pixels, x, y, w, h, endOfFrame, true});
+}
+
+void OswDisplayFlushQueue::submitUnowned(uint16_t* pixels, int16_t x, int16_t y, int16_t w, int16_t h, bool endOfFrame) {
+    this->enqueue({pixels, x, y, w, h, endOfFrame, false});
+}
+
+void OswDisplayFlushQueue::submitFrameEnd() {
+    this->enqueue({nullptr, 0, 0, 0, 0, true, false});
+}
+
+void OswDisplayFlushQueue::enqueue(const Transfer& transfer) {
+    {
+        // Only unowned transfers can fill the ring, the buffers alone never exceed it
+        std::unique_lock<std::mutex> guard(this->lock);
+        this->changed.wait(guard, [this]() {
+            return this->pendingCount < this->maxPending;
+        });
+        this->pending[(this->pendingHead + this->pendingCount) % this->maxPending] = transfer;
+        ++this->pendingCount;
+    }
+    this->changed.notify_all();
+}
+
+void OswDisplayFlushQueue::waitIdle() {
+    std::unique_lock<std::mutex> guard(this->lock);
+    this->changed.wait(guard, [this]() {
+        return this->pendingCount == 0 and !this->transferring;
+    });
+}
+
+void OswDisplayFlushQueue::setFrameDoneCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->frameDoneCallback = callback;
+}
+
+void OswDisplayFlushQueue::work() {
+    OSW_LOG_D("Display flush worker started.");
+    std::unique_lock<std::mutex> guard(this->lock);
+    while(true) {
+        this->changed.wait(guard, [this]() {
+            return this->pendingCount > 0 or this->stopping;
+        });
+        if(this->pendingCount == 0)
+            break; // Only reached when stopping
+        const Transfer transfer = this->pending[this->pendingHead];
+        this->pendingHead = (this->pendingHead + 1) % this->maxPending;
+        --this->pendingCount;
+        this->transferring = true;
+        std::function<void()> callback = transfer.endOfFrame ? this->frameDoneCallback : nullptr;
+
+        // The UI may fill the other buffers meanwhile
+        guard.unlock();
+        if(transfer.pixels)
+            this->output->draw16bitRGBBitmap(transfer.x, transfer.y, transfer.pixels, transfer.w, transfer.h);
+        if(transfer.endOfFrame) {
+            ++this->framesDone;
+            if(callback)
+                callback();
+#ifndef OSW_EMULATOR
+            const uint32_t headroom = uxTaskGetStackHighWaterMark(nullptr);
+            if(headroom < this->workerStackMargin and (this->workerStackHeadroom == 0 or headroom < this->workerStackHeadroom))
+                OSW_LOG_W("Display flush worker has only ", headroom, " bytes of stack left!");
+            this->workerStackHeadroom = headroom;
+#endif
+        }
+        guard.lock();
+
+        if(transfer.owned) {
+            this->freeBuffers[(this->freeHead + this->freeCount) % this->bufferCount] = transfer.pixels;
+            ++this->freeCount;
+        }
+        this->transferring = false;
+        this->changed.notify_all();
+    }
+    OSW_LOG_D("Display flush worker terminated!");
+#ifndef OSW_EMULATOR
+    this->workerStopped = true;
+    this->changed.notify_all(); // Still locked, so the destructor can not free us before this returns
+    guard.unlock();
+    vTaskDelete(nullptr); // Inform FreeRTOS this task is done - otherwise the kernel will take that personally and crash!
+#endif
+}
@@ -14,6 +14,13 @@ static int16_t buttonPositionsY[BTN_NUMBER] = BTN_POSY_ARRAY;
 static bool buttonIsTop[BTN_NUMBER] = BTN_POS_ISTOP_ARRAY;
 static bool buttonIsLeft[BTN_NUMBER] = BTN_POS_ISLEFT_ARRAY;
 
+#if OSW_PLATFORM_IS_FLOW3R_BADGE != 1 && !defined(OSW_EMULATOR)
+static void IRAM_ATTR isrButton(void* arg) {
+    const uint8_t i = (uintptr_t) arg;
+    OswButtonQueue::getInstance().push((Button) i, digitalRead(buttonPins[i]) == buttonClickStates[i], millis());
+}
+#endif
+
 void OswHal::setupButtons() {
 #if OSW_PLATFORM_IS_FLOW3R_BADGE != 1
     pinMode(BTN_1, INPUT);
@@ -25,13 +32,35 @@ void OswHal::setupButtons() {
 #endif
 
     // Buttons (Engine)
-    for (uint8_t i = 0; i < 3; i++) {
-        _btnLastState[i] = false;
+    std::array<bool, BTN_NUMBER> down = {};
+    for (uint8_t i = 0; i < BTN_NUMBER; i++) {
+#if OSW_PLATFORM_IS_FLOW3R_BADGE != 1
+        down[i] = digitalRead(buttonPins[i]) == buttonClickStates[i];
+#else
+        this->_btnPolled[i] = false;
+#endif
         _btnIsDown[i] = false;
         _btnGoneUp[i] = false;
+        _btnGoneDown[i] = false;
         _btnDoubleClick[i] = false;
         _btnDetectDoubleClickCount[i] = 0;
+        _btnSuppressUntilUpAgain[i] = false;
     }
+    _btnEdgeCount = 0;
+    OswButtonQueue::getInstance().reset(down);
+    this->updateButtonTimings();
+
+#if OSW_PLATFORM_IS_FLOW3R_BADGE != 1 && !defined(OSW_EMULATOR)
+    // Every edge is queued with its time, so short taps are not lost in long frames (the emulator queues them itself)
+    for (uint8_t i = 0; i < BTN_NUMBER; i++)
+        attachInterruptArg(buttonPins[i], isrButton, (void*) (uintptr_t) i, CHANGE);
+#endif
+}
+
+void OswHal::updateButtonTimings() {
+    this->_btnDoublePressTimeout = OswConfigAllKeys::oswAppV2ButtonDoublePress.get();
+    this->_btnLongPressTime = OswConfigAllKeys::oswAppV2ButtonLongPress.get();
+    this->_btnVeryLongPressTime = OswConfigAllKeys::oswAppV2ButtonVeryLongPress.get();
 }
 
 #if OSW_PLATFORM_HARDWARE_VIBRATE != 0
@@ -44,62 +73,74 @@ void OswHal::vibrate(long millis) {
 #endif
 
 void OswHal::checkButtons() {
+    const unsigned long now = millis();
+    OswButtonQueue& queue = OswButtonQueue::getInstance();
 #if OSW_PLATFORM_IS_FLOW3R_BADGE == 1
+    // These buttons are behind the GPIO extender, so they are polled - into the same queue
     uint8_t ur = ~this->readGpioExtender();
     bool r1 = ur & 0b00000001;
     bool l1 = ur & 0b10000000;
     bool r2 = ur & 0b00100000;
     bool l2 = ur & 0b00010000;
-    _btnIsDown[0] = !digitalRead(0) or !digitalRead(3);
-    _btnIsDown[1] = l1 or l2;
-    _btnIsDown[2] = r1 or r2;
-    if(_btnIsDown[0] or _btnIsDown[1] or _btnIsDown[2])
-        this->noteUserInteraction(); // Button pressing counts as user interaction
-#else
-    for (uint8_t i = 0; i < BTN_NUMBER; i++) {
-        _btnIsDown[i] = digitalRead(buttonPins[i]) == buttonClickStates[i];
-        if(_btnIsDown[i])
-            this->noteUserInteraction(); // Button pressing counts as user interaction
-    }
+    const bool polled[BTN_NUMBER] = {!digitalRead(0) or !digitalRead(3), l1 or l2, r1 or r2};
+    for (uint8_t i = 0; i < BTN_NUMBER; i++)
+        if(polled[i] != this->_btnPolled[i]) {
+            queue.push((Button) i, polled[i], now);
+            this->_btnPolled[i] = polled[i];
+        }
+#endif
+    _btnEdgeCount = queue.drain(now, _btnEdges.data(), _btnEdges.size());
+#if OSW_PLATFORM_IS_FLOW3R_BADGE != 1
+    // In case an edge got lost (e.g. the one waking us up from light sleep), the current level takes over
+    for (uint8_t i = 0; i < BTN_NUMBER; i++)
+        if(!queue.isPending((Button) i) and (digitalRead(buttonPins[i]) == buttonClickStates[i]) != queue.isDown((Button) i))
+            queue.push((Button) i, !queue.isDown((Button) i), now);
 #endif
 
     for (uint8_t i = 0; i < BTN_NUMBER; i++) {
-        _btnGoneUp[i] = _btnLastState[i] == true && _btnIsDown[i] == false;
-        _btnGoneDown[i] = _btnLastState[i] == false && _btnIsDown[i] == true;
+        _btnGoneUp[i] = false;
+        _btnGoneDown[i] = false;
         _btnDoubleClick[i] = false;
-        // store the time stamp since the button went down
-        if (_btnGoneDown[i]) {
-            _btnIsDownMillis[i] = millis();
-            if(_btnDetectDoubleClickCount[i]==0) {
-                _btnDoubleClickMillis[i] = millis();
-            }
+    }
+    uint8_t kept = 0;
+    for (uint8_t e = 0; e < _btnEdgeCount; e++) {
+        const OswButtonQueue::Edge edge = _btnEdges[e];
+        const uint8_t i = edge.button;
+        this->noteUserInteraction(); // Button pressing counts as user interaction
+        // ignore all changes until up
+        if (_btnSuppressUntilUpAgain[i]) {
+            if(!edge.down)
+                _btnSuppressUntilUpAgain[i] = false;
+            continue;
+        }
+        _btnEdges[kept++] = edge;
+        if (edge.down) {
+            _btnGoneDown[i] = true;
+            // store the time stamp since the button went down
+            _btnIsDownMillis[i] = edge.timestamp;
+            if(edge.timestamp - _btnDoubleClickMillis[i] > _btnDoubleClickTime)
+                _btnDetectDoubleClickCount[i] = 0;
+            if(_btnDetectDoubleClickCount[i] == 0)
+                _btnDoubleClickMillis[i] = edge.timestamp;
             _btnDetectDoubleClickCount[i] = _btnDetectDoubleClickCount[i] + 1;
-            _btnDoubleClick[i] = 2 == _btnDetectDoubleClickCount[i];
+            _btnDoubleClick[i] = _btnDoubleClick[i] or 2 == _btnDetectDoubleClickCount[i];
+        } else {
+            _btnGoneUp[i] = true;
         }
-        if(millis() - _btnDoubleClickMillis[i] > 500) {
+    }
+    _btnEdgeCount = kept;
+
+    for (uint8_t i = 0; i < BTN_NUMBER; i++) {
+        if(!queue.isDown((Button) i))
+            _btnSuppressUntilUpAgain[i] = false;
+        _btnIsDown[i] = queue.isDown((Button) i) and !_btnSuppressUntilUpAgain[i];
+        if(_btnIsDown[i])
+            this->noteUserInteraction(); // Button pressing counts as user interaction
+        if(now - _btnDoubleClickMillis[i] > _btnDoubleClickTime)
             _btnDetectDoubleClickCount[i] = 0;
-        }
 
         // check if the button has been down long enough
-        _btnLongPress[i] = _btnIsDown[i] == true and (millis() > _btnIsDownMillis[i] + OswConfigAllKeys::oswAppV2ButtonLongPress.get());
-
-        // store current button state
-        _btnLastState[i] = _btnIsDown[i];
-
-        // ignore all changes until up
-        if (_btnSuppressUntilUpAgain[i] == true && _btnIsDown[i]) {
-            _btnGoneUp[i] = false;
-            _btnGoneDown[i] = false;
-            _btnIsDownMillis[i] = millis();
-            _btnLongPress[i] = false;
-            _btnIsDown[i] = false;
-
-            _btnDetectDoubleClickCount[i] = 0;
-            _btnDoubleClickMillis[i] = millis();
-            _btnDoubleClick[i] = false;
-        } else {
-            _btnSuppressUntilUpAgain[i] = false;
-        }
+        _btnLongPress[i] = _btnIsDown[i] and now - _btnIsDownMillis[i] > _btnLongPressTime;
     }
 }
 
@@ -146,3 +187,9 @@ void OswHal::getButtonCoordinates(Button btn, int16_t& x, int16_t& y) {
     x = buttonPositionsX[btn];
     y = buttonPositionsY[btn];
 }
+uint8_t OswHal::btnEdgeCount() {
+    return _btnEdgeCount;
+}
+const OswButtonQueue::Edge& OswHal::btnEdge(uint8_t index) {
+    return _btnEdges[index];
+}
@@ -31,6 +31,7 @@ OswHal::Devices::Devices() {
 }
 
 OswHal::Devices::~Devices() {
+    this->scheduler.stopTask();
 #if OSW_PLATFORM_HARDWARE_ESP32 == 1
     delete this->esp32;
 #endif
@@ -57,14 +58,36 @@ OswHal::Devices::~Devices() {
 void OswHal::Devices::setup(const bool& fromLightSleep) {
     for(auto& d : *OswDevice::getAllDevices())
         d->setup();
+    this->scheduler.startTask();
 }
 
 void OswHal::Devices::update() {
-    for(auto& d : *OswDevice::getAllDevices())
-        d->update();
+    this->scheduler.updateAll(millis());
+}
+
+void OswHal::Devices::update(OswDevice* device) {
+    this->scheduler.updateNow(device, millis());
+}
+
+void OswHal::Devices::updateDue() {
+    if(!this->scheduler.isTaskRunning())
+        this->scheduler.updateDue(millis());
 }
 
 void OswHal::Devices::stop(const bool& toLightSleep) {
+    this->scheduler.stopTask();
     for(auto& d : *OswDevice::getAllDevices())
         d->stop();
 }
+
+void OswHal::Devices::suspend() {
+    this->scheduler.stopTask();
+    for(auto& d : *OswDevice::getAllDevices())
+        d->suspend();
+}
+
+void OswHal::Devices::resume() {
+    for(auto& d : *OswDevice::getAllDevices())
+        d->resume();
+    this->scheduler.startTask();
+}
@@ -12,6 +12,7 @@
 #include "config_defaults.h"
 #include "osw_hal.h"
 #include "osw_pins.h"
+#include "osw_ui.h"
 #include OSW_TARGET_PLATFORM_HEADER
 
 #if OSW_PLATFORM_HARDWARE_DISPLAY_RST == 0
@@ -44,6 +45,12 @@ class PixelPainter : public DrawPixel {
 };
 PixelPainter* pixelPainter = new PixelPainter();
 
+#ifdef OSW_DISPLAY_DOUBLE_BUFFER
+static const bool doubleBuffered = true; // Only pays off with OSW_DISPLAY_ASYNC_FLUSH, as the front frame is then sent while the next one is drawn
+#else
+static const bool doubleBuffered = false;
+#endif
+
 void OswHal::requestDisableDisplayBuffer() {
     _requestDisableBuffer = true;
 }
@@ -51,18 +58,33 @@ void OswHal::requestEnableDisplayBuffer() {
     _requestEnableBuffer = true;
 }
 void OswHal::disableDisplayBuffer() {
-    if(!this->displayBufferEnabled())
+    if(!this->displayBufferEnabled() and !this->displayStripBufferEnabled())
         return;
+    this->canvas->waitForFlush(); // The pixel painter writes to the display directly
     this->canvas->disableBuffer(pixelPainter);
 }
 void OswHal::enableDisplayBuffer() {
     if(this->displayBufferEnabled())
         return;
-    this->canvas->enableBuffer();
+    this->canvas->waitForFlush();
+    this->canvas->enableBuffer(doubleBuffered);
 }
 bool OswHal::displayBufferEnabled() {
     return this->canvas->hasBuffer();
 }
+/**
+ * Middle ground between the full buffer and no buffer at all: only a few chunks are kept in RAM and every frame is
+ * replayed from a display list for each of them (see Graphics2D::enableStripBuffer()).
+ */
+void OswHal::enableDisplayStripBuffer() {
+    if(this->displayStripBufferEnabled())
+        return;
+    this->canvas->waitForFlush();
+    this->canvas->enableStripBuffer(DISP_STRIP_CHUNKS, DISP_DISPLAY_LIST_SIZE);
+}
+bool OswHal::displayStripBufferEnabled() {
+    return this->canvas->hasStripBuffer();
+}
 
 void OswHal::setupDisplay(bool fromLightSleep) {
 #ifdef OSW_EMULATOR
@@ -82,8 +104,22 @@ void OswHal::setupDisplay(bool fromLightSleep) {
 #endif
 
     // Moved from static allocation to here, as new() operators are limited (size-wise) in that context
-    if(!this->canvas)
+    if(!this->canvas) {
         this->canvas = new Arduino_Canvas_Graphics2D(DISP_W, DISP_H, tft);
+#ifdef OSW_DISPLAY_RESERVE_BUFFER
+        // Switching between the buffer modes then never touches the heap again
+        this->canvas->setFrameMemoryReserved(true);
+#endif
+        if(doubleBuffered)
+            this->canvas->enableBuffer(true);
+    }
+#ifdef OSW_DISPLAY_ASYNC_FLUSH
+    if(!this->canvas->asyncFlushEnabled()) {
+        // Two buffers: one is sent, while the next chunk is copied into the other
+        this->canvas->enableAsyncFlush(2);
+        this->canvas->getFlushQueue()->setFrameDoneCallback(OswUI::onFlushDone);
+    }
+#endif
 
     if(!fromLightSleep) {
         this->canvas->begin();  // will not deconfigured upon light sleep, use default speed and default SPI mode
@@ -125,10 +161,19 @@ Graphics2DPrint* OswHal::gfx(void) {
 
 void OswHal::flushCanvas(void) {
     this->canvas->flush();
+    // Only warn once the frames start to spill over, not on every frame
+    const bool displayListOverflowed = this->canvas->getDisplayListOverflows() != this->_displayListOverflows;
+    if(displayListOverflowed and !this->_displayListOverflowed)
+        OSW_LOG_W("Display list too small, frames are partly drawn unbuffered! (see DISP_DISPLAY_LIST_SIZE)");
+    this->_displayListOverflowed = displayListOverflowed;
+    this->_displayListOverflows = this->canvas->getDisplayListOverflows();
+    if(!this->canvas->asyncFlushEnabled())
+        OswUI::onFlushDone(); // Otherwise the flush worker reports it
 }
 
 void OswHal::displayOff(void) {
     this->setBrightness(0, false);
+    this->canvas->waitForFlush();
     tft->displayOff();
     _screenOffSince = millis();
 }
@@ -142,6 +187,7 @@ unsigned long OswHal::screenOffTime() {
 
 void OswHal::displayOn() {
     _screenOnSince = millis();
+    this->canvas->waitForFlush();
     tft->displayOn(); // instruct display to show image, before enabling backlight
     this->setBrightness(OswConfigAllKeys::settingDisplayBrightness.get(), false);
 }
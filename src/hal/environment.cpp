@@ -1,5 +1,6 @@
 #include OSW_TARGET_PLATFORM_HEADER
 #if OSW_PLATFORM_ENVIRONMENT == 1
+#include <mutex>
 #include <stdexcept>
 #ifdef OSW_EMULATOR
 #include <cassert>
@@ -61,6 +62,7 @@ void OswHal::Environment::updateProviders() {
 float OswHal::Environment::getTemperature() {
     if(!this->tempSensor)
         throw std::runtime_error("No temperature provider!");
+    std::lock_guard<std::mutex> guard(OswHal::getInstance()->devices()->getBusLock()); // Some read it from the sensor
     return this->tempSensor->getTemperature();
 }
 #endif
@@ -90,6 +92,12 @@ OswAccelerationProvider::ActivityMode OswHal::Environment::getActivityMode() {
     return this->accelSensor->getActivityMode();
 }
 
+void OswHal::Environment::boostAccelerometer(unsigned long interval, unsigned long duration) {
+    if(!this->accelSensor)
+        throw std::runtime_error("No acceleration provider!");
+    this->accelSensor->boost(interval, duration);
+}
+
 uint32_t OswHal::Environment::getStepsToday() {
     if(!this->accelSensor)
         throw std::runtime_error("No acceleration provider!");
@@ -99,6 +107,7 @@ uint32_t OswHal::Environment::getStepsToday() {
 void OswHal::Environment::resetStepCount() {
     if(!this->accelSensor)
         throw std::runtime_error("No acceleration provider!");
+    std::lock_guard<std::mutex> guard(OswHal::getInstance()->devices()->getBusLock());
     return this->accelSensor->resetStepCount();
 }
 
@@ -277,5 +286,11 @@ int OswHal::Environment::getMagnetometerAzimuth() {
         throw std::runtime_error("No magnetometer provider!");
     return this->magSensor->getMagnetometerAzimuth();
 }
+
+void OswHal::Environment::boostMagnetometer(unsigned long interval, unsigned long duration) {
+    if(!this->magSensor)
+        throw std::runtime_error("No magnetometer provider!");
+    this->magSensor->boost(interval, duration);
+}
 #endif
 #endif
@@ -7,6 +7,7 @@
 #include "osw_ui.h"
 #include "osw_pins.h"
 #include "OswAppV2.h"
+#include "OswSerial.h"
 
 #include <services/OswServiceTaskWiFi.h>
 #include <services/OswServiceTasks.h>
@@ -233,7 +234,15 @@ void OswHal::doSleep(bool deepSleep) {
     this->noteUserInteraction(); // reset sleep timer
     return;
 #else
-    this->stop(!deepSleep);
+    if(this->_sleepHolds > 0) {
+        OSW_LOG_I("Sleeping is held off, e.g. by an update.");
+        this->noteUserInteraction(); // reset sleep timer
+        return;
+    }
+    if(deepSleep)
+        this->stop(false);
+    else
+        this->suspend();
 
     // register user wakeup sources
     if (OswConfigAllKeys::buttonToWakeEnabled.get())
@@ -268,7 +277,8 @@ void OswHal::doSleep(bool deepSleep) {
             OSW_LOG_E("Error while setting up wakeup timer: ", res);
     }
 
-    delay(100); // Make sure the Serial is flushed and any tasks are finished...
+    OswLogger::getInstance()->flush(); // The flusher task will not run again before the sleep
+    OswSerial::getInstance()->flush(); // Only waits until the UART sent the rest - the tasks were already stopped above
     if (deepSleep)
         esp_deep_sleep_start();
     else
@@ -297,7 +307,7 @@ void OswHal::handleWakeupFromLightSleep(void) {
     if (_isLightSleep) {
         // is there a better way to detect light sleep wakeups?
         _isLightSleep = false;
-        this->setup(true);
+        this->resume();
     }
 }
 
@@ -384,6 +394,14 @@ void OswHal::noteUserInteraction() {
     this->_lastUserInteraction = millis();
 }
 
+void OswHal::holdSleep() {
+    ++this->_sleepHolds;
+}
+
+void OswHal::releaseSleep() {
+    --this->_sleepHolds;
+}
+
 void OswHal::handleDisplayTimout() {
     // Did enough time pass since the last user interaction?
     const int lastDisplayTimeout = OswConfigAllKeys::settingDisplayTimeout.get();
@@ -1,20 +1,51 @@
+#include <algorithm>
+#include <mutex>
 #include <stdexcept>
 
-#include <RtcDS3231.h> // ONLY used for the RtcDateTime class, because direct include is buggy!
 #include <osw_config.h>
 
 #include <osw_hal.h>
 
+/**
+ * Feeds the clock with a new sample of the time provider - at most every _clockSampleInterval, as asking the provider
+ * is the expensive part (and the clock would not learn much from more samples anyways)
+ */
+void OswHal::disciplineClock(int64_t now) {
+    if(now < this->_clockSampledAt)
+        this->_clock.reset(); // The timer went back, only the FakeClock of the emulator can do that
+    if(this->_clock.isSynchronized() and now - this->_clockSampledAt < this->_clockSampleInterval)
+        return;
+    this->_clockSampledAt = now;
+    if(this->_clock.discipline(this->timeProvider->getUTCTimeSample()) and this->_clock.getSteps() > 1)
+        OSW_LOG_D("Clock stepped to the time of ", this->timeProvider->getName());
+}
+
+int64_t OswHal::getUTCMicros() {
+    if(!this->timeProvider)
+        throw std::runtime_error("No time provider!");
+    const int64_t now = OswClock::getMonotonicMicros();
+    this->disciplineClock(now);
+    return this->_clock.getUTCMicros(now);
+}
+
 time_t OswHal::getUTCTime() {
     if(!this->timeProvider)
         throw std::runtime_error("No time provider!");
-    return this->timeProvider->getUTCTime();
+    const int64_t now = OswClock::getMonotonicMicros();
+    this->disciplineClock(now);
+    return this->_clock.getUTCTime(now);
 }
 
 void OswHal::setUTCTime(const time_t& epoch) {
     if(!this->timeProvider)
         throw std::runtime_error("No time provider!");
-    this->timeProvider->setUTCTime(epoch);
+    {
+        std::lock_guard<std::mutex> guard(this->devices()->getBusLock());
+        this->timeProvider->setUTCTime(epoch);
+    }
+    this->_clock.reset(); // The provider started a new second with it
+    this->_clockSampledAt = 0;
+    this->updateTimezoneOffsets(); // We may have jumped over a transition
 }
 
 void OswHal::updateTimeProvider() {
@@ -24,97 +55,70 @@ void OswHal::updateTimeProvider() {
     }
     if(!this->timeProvider)
         OSW_LOG_D("No provider for Time is available!");
+    this->_clock.reset();
 }
 
 void OswHal::getUTCTime(OswTime& oswTime) {
-    RtcDateTime d = RtcDateTime();
-    d.InitWithUnix32Time(this->getUTCTime());
-    oswTime.hour = d.Hour();
-    oswTime.minute = d.Minute();
-    oswTime.second = d.Second();
+    const OswClock::BrokenDownTime d = this->_clock.getBrokenDown(this->getUTCTime());
+    oswTime.hour = d.hour;
+    oswTime.minute = d.minute;
+    oswTime.second = d.second;
 }
 
 void OswHal::getTime(time_t& offset, OswTime& oswTime) {
-    RtcDateTime d = RtcDateTime();
-    d.InitWithUnix32Time(this->getTime(offset));
+    const OswClock::BrokenDownTime d = this->_clock.getBrokenDown(this->getTime(offset));
     if (!OswConfigAllKeys::timeFormat.get()) {
-        if (d.Hour() > 12) {
-            oswTime.hour = d.Hour() - 12;
+        if (d.hour > 12) {
+            oswTime.hour = d.hour - 12;
             oswTime.afterNoon = true;
-        } else if (d.Hour() == 0) {
+        } else if (d.hour == 0) {
             oswTime.hour = 12;
             oswTime.afterNoon = false;
-        } else if (d.Hour() == 12) {
-            oswTime.hour = d.Hour();
+        } else if (d.hour == 12) {
+            oswTime.hour = d.hour;
             oswTime.afterNoon = true;
         } else {
-            oswTime.hour = d.Hour();
+            oswTime.hour = d.hour;
             oswTime.afterNoon = false;
         }
     } else {
-        oswTime.hour = d.Hour();
+        oswTime.hour = d.hour;
         oswTime.afterNoon = false;
     }
-    oswTime.minute = d.Minute();
-    oswTime.second = d.Second();
+    oswTime.minute = d.minute;
+    oswTime.second = d.second;
 }
 
 /**
- * @brief Tries to update the cached timezone offsets for the primary and secondary timezones.
- *
+ * @brief Updates the cached timezone offsets for the primary and secondary timezones - the rules are only parsed
+ * again if the config changed, otherwise this is just a lookup in their transition tables.
  */
 void OswHal::updateTimezoneOffsets() {
-    // Ask primary time provider for timezone offset
-    const String timezonePrimary = OswConfigAllKeys::timezonePrimary.get();
-    const String timezoneSecondary = OswConfigAllKeys::timezoneSecondary.get();
-    if(timezonePrimary.length() == 0)
-        this->timezoneOffsetPrimary = 0;
-    if(timezoneSecondary.length() == 0)
-        this->timezoneOffsetSecondary = 0;
-    if(timezonePrimary.length() == 0 and timezoneSecondary.length() == 0)
-        return; // No timezone != UTC is set -> no need to update
-    bool updated = false;
-    try {
-        if(this->timeProvider != nullptr) {
-            if(timezonePrimary.length() != 0)
-                this->timezoneOffsetPrimary = this->timeProvider->getTimezoneOffset(this->timeProvider->getUTCTime(), timezonePrimary);
-            if(timezoneSecondary.length() != 0)
-                this->timezoneOffsetSecondary = this->timeProvider->getTimezoneOffset(this->timeProvider->getUTCTime(), timezoneSecondary);
-            updated = true;
-        }
-    } catch(const std::logic_error& e) {
-        // Well, we tried...
-    }
-    // Okay, either we have no time provider or it failed to provide a timezone offset -> ask all remaining time providers to resolve it!
-    if(!updated) {
-        for(auto& d : *OswTimeProvider::getAllTimeDevices()) {
-            if(d != this->timeProvider) {
-                try {
-                    if(timezonePrimary.length() != 0)
-                        this->timezoneOffsetPrimary = d->getTimezoneOffset(d->getUTCTime(), timezonePrimary);
-                    if(timezoneSecondary.length() != 0)
-                        this->timezoneOffsetSecondary = d->getTimezoneOffset(d->getUTCTime(), timezoneSecondary);
-                    updated = true;
-                    break;
-                } catch(const std::logic_error& e) {
-                    // Well, we tried...
-                }
-            }
-        }
-    }
-    if(!updated) {
-        // Okay, we still don't have a timezone offset -> set it to 0
-        this->timezoneOffsetPrimary = 0;
-        this->timezoneOffsetSecondary = 0;
-        OSW_LOG_W("Could not resolve timezone offsets (no capable provider is available)!");
-    }
+    const time_t now = this->timeProvider ? this->getUTCTime() : 0;
+    const String primary = OswConfigAllKeys::timezonePrimary.get();
+    const String secondary = OswConfigAllKeys::timezoneSecondary.get();
+    std::lock_guard<std::mutex> guard(this->_timezoneLock);
+    if(this->_timezonePrimary.update(primary.c_str(), now) and !this->_timezonePrimary.isValid())
+        OSW_LOG_W("Invalid primary timezone, using UTC!");
+    if(this->_timezoneSecondary.update(secondary.c_str(), now) and !this->_timezoneSecondary.isValid())
+        OSW_LOG_W("Invalid secondary timezone, using UTC!");
+    this->timezoneOffsetPrimary = this->_timezonePrimary.getOffset(now);
+    this->timezoneOffsetSecondary = this->_timezoneSecondary.getOffset(now);
+    this->_nextTimezoneTransition = std::min(this->_timezonePrimary.getNextTransition(now), this->_timezoneSecondary.getNextTransition(now));
+}
+
+time_t OswHal::getNextTimezoneTransition() {
+    std::lock_guard<std::mutex> guard(this->_timezoneLock);
+    return this->_nextTimezoneTransition;
 }
 
 time_t OswHal::getTimezoneOffsetPrimary() {
+    std::lock_guard<std::mutex> guard(this->_timezoneLock);
     return this->timezoneOffsetPrimary;
 }
 
 time_t OswHal::getTimezoneOffsetSecondary() {
+    std::lock_guard<std::mutex> guard(this->_timezoneLock);
     return this->timezoneOffsetSecondary;
 }
 
@@ -123,10 +127,9 @@ time_t OswHal::getTime(time_t& offset) {
 }
 
 void OswHal::getDate(time_t& offset, OswDate& oswDate) {
-    RtcDateTime d = RtcDateTime();
-    d.InitWithUnix32Time(this->getTime(offset));
-    oswDate.year = d.Year();
-    oswDate.month = d.Month();
-    oswDate.day = d.Day();
-    oswDate.weekDay = d.DayOfWeek();
+    const OswClock::BrokenDownTime d = this->_clock.getBrokenDown(this->getTime(offset));
+    oswDate.year = d.year;
+    oswDate.month = d.month;
+    oswDate.day = d.day;
+    oswDate.weekDay = d.weekDay;
 }
\ No newline at end of file
@@ -30,9 +30,7 @@
 #ifdef OSW_FEATURE_LUA
 #include "./apps/main/luaapp.h"
 #endif
-#include "assets/img/icons/brickbreaker.png.h"
 #include "./apps/games/brick_breaker.h"
-#include "assets/img/icons/snake.png.h"
 #include "./apps/games/snake_game.h"
 #ifdef OSW_FEATURE_WIFI
 #include "assets/img/icons/settings.png.h"
@@ -102,6 +100,7 @@ using OswGlobals::main_tutorialApp;
 
 void setup() {
     OswSerial::getInstance()->begin(115200);
+    OswLogger::getInstance()->startFlusher();
     OSW_LOG_I("Welcome to the OSW-OS! This build is based on commit ", GIT_COMMIT_HASH, " from ", GIT_BRANCH_NAME,
               ". Compiled at ", __DATE__, " ", __TIME__, " for platform ", PIO_ENV_NAME, ".");
 
@@ -156,7 +155,6 @@ void setup() {
 
 void loop() {
     static time_t lastPowerUpdate = time(nullptr) + 2;  // We consider a run of at least 2 seconds as "success"
-    static time_t nextTimezoneUpdate = time(nullptr) + 60; // Already done after sleep -> revisit in a while
 
 // check possible interaction with ULP program
 #if USE_ULP == 1
@@ -167,7 +165,7 @@ void loop() {
         OswHal::getInstance()->handleDisplayTimout();
         OswHal::getInstance()->handleWakeupFromLightSleep();
         OswHal::getInstance()->checkButtons();
-        OswHal::getInstance()->devices()->update();
+        OswHal::getInstance()->devices()->updateDue();
         // update power statistics only when WiFi isn't used - fixing:
         // https://github.com/Open-Smartwatch/open-smartwatch-os/issues/163
         bool wifiDisabled = true;
@@ -179,10 +177,8 @@ void loop() {
             OswHal::getInstance()->updatePowerStatistics(OswHal::getInstance()->getBatteryRaw(20));
             lastPowerUpdate = time(nullptr);
         }
-        if(time(nullptr) > nextTimezoneUpdate) {
-            OswHal::getInstance()->updateTimezoneOffsets();
-            nextTimezoneUpdate = time(nullptr) + 60; // Update every minute
-        }
+        if(OswHal::getInstance()->getUTCTime() >= OswHal::getInstance()->getNextTimezoneTransition())
+            OswHal::getInstance()->updateTimezoneOffsets(); // Only on DST changes, the config updates them itself
     } catch(const std::exception& e) {
         OSW_LOG_E("CRITICAL ERROR AT UPDATES: ", e.what());
         sleep(_MAIN_CRASH_SLEEP);
@@ -277,12 +273,10 @@ void loop() {
 
         // Games
 #if GAME_SNAKE == 1
-        static OswAppSnakeGame gameSnake;
-        main_mainDrawer.registerApp(LANG_GAMES, new OswAppV2Compat("osw.game.snake", "Snake", gameSnake, true, snake_png));
+        main_mainDrawer.registerAppLazy<OswAppSnakeGame>(LANG_GAMES);
 #endif
 #if GAME_BRICK_BREAKER == 1
-        static OswAppBrickBreaker gameBrickBreaker;
-        main_mainDrawer.registerApp(LANG_GAMES, new OswAppV2Compat("osw.game.brick", "Brick Breaker", gameBrickBreaker, true, brickbreaker_png));
+        main_mainDrawer.registerAppLazy<OswAppBrickBreaker>(LANG_GAMES);
 #endif
 
 #ifdef OSW_FEATURE_LUA
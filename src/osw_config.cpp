@@ -8,6 +8,7 @@
 #endif
 
 #include <ArduinoJson.h>
+#include <OswMemoryTracker.h>
 #include "osw_config_keys.h"
 
 #include <osw_hal.h> // For timezone reloading
@@ -108,7 +109,7 @@ void OswConfig::reset(bool clearWholeNVS) {
 OswConfig::~OswConfig() {};
 
 String OswConfig::getCategoriesJson() {
-    DynamicJsonDocument config(4096);
+    OswJsonDocument config(4096);
 
     unsigned char i = 0;
     for (; i < oswConfigKeysCount; i++) {
@@ -124,7 +125,7 @@ String OswConfig::getCategoriesJson() {
 }
 
 String OswConfig::getFieldJson(String id) {
-    DynamicJsonDocument config(2048);
+    OswJsonDocument config(2048);
 
     unsigned char i = 0;
     for (; i < oswConfigKeysCount; i++) {
@@ -174,6 +175,7 @@ void OswConfig::notifyChange() {
     // Reload parts of the OS, which buffer values
     // OswUI::getInstance()->resetTextColors(); // nope - this is done by the ui itself
     OswHal::getInstance()->updateTimezoneOffsets();
+    OswHal::getInstance()->updateButtonTimings();
     OswAppWatchfaceDigital::refreshDateFormatCache();
 #ifdef OSW_FEATURE_BLE_SERVER
     OswServiceAllTasks::bleServer.updateName();
@@ -51,10 +51,14 @@ OswConfigKeyString fallbackWifiSsid1st("a1", "WiFi", "2nd SSID", "Leave empty to
 OswConfigKeyPassword fallbackWifiPass1st("b1", "WiFi", "2nd Password", nullptr, CONFIG_FALLBACK_1ST_WIFI_PASS);
 OswConfigKeyString fallbackWifiSsid2nd("a2", "WiFi", "3rd SSID", "Leave empty to disable", CONFIG_FALLBACK_2ND_WIFI_SSID);
 OswConfigKeyPassword fallbackWifiPass2nd("b2", "WiFi", "3rd Password", nullptr, CONFIG_FALLBACK_2ND_WIFI_PASS);
+OswConfigKeyPassword otaSigningKey("u1", "WiFi", "Update signing key", "Only updates with a manifest signed with it are installed (leave empty to allow unsigned ones)", OTA_SIGNING_KEY);
 #endif
 #ifdef OSW_FEATURE_BLE_SERVER
 OswConfigKeyBool bleBootEnabled("f", "System", "Enable BLE on boot", "This will drain your battery faster!", BLE_ON_BOOT);
 #endif
+#ifdef OSW_SERVICE_COMMUNICATION
+OswConfigKeyString communicationServerUrl("cu", "Communication", "Server URL", "Where the watch sends its data to (HTTP POST, leave empty to only queue it)", COMMUNICATION_SERVER_URL);
+#endif
 
 OswConfigKeyShort settingDisplayBrightness("s1", "Display", "Display Brightness", "From 0 to 255",
         DISPLAY_BRIGHTNESS);
@@ -145,9 +149,13 @@ OswConfigKey* oswConfigKeys[] = {
 #endif
     & OswConfigAllKeys::wifiAlwaysNTPEnabled, &OswConfigAllKeys::wifiAutoAP,
     & OswConfigAllKeys::hostPasswordEnabled, &OswConfigAllKeys::hostPass,
+    & OswConfigAllKeys::otaSigningKey,
 #endif
 #ifdef OSW_FEATURE_BLE_SERVER
     & OswConfigAllKeys::bleBootEnabled,
+#endif
+#ifdef OSW_SERVICE_COMMUNICATION
+    & OswConfigAllKeys::communicationServerUrl,
 #endif
     // display
     &OswConfigAllKeys::settingDisplayTimeout, &OswConfigAllKeys::settingDisplayBrightness,
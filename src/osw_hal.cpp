@@ -44,7 +44,8 @@ OswHal::OswHal(FileSystemHal* fs) : fileSystem(fs) {
 }
 
 OswHal::~OswHal() {
-
+    if(this->canvas)
+        this->canvas->disableAsyncFlush(); // Stops the flush worker
 };
 
 void OswHal::setup(bool fromLightSleep) {
@@ -103,6 +104,49 @@ void OswHal::stop(bool toLightSleep) {
     OSW_LOG_D(toLightSleep ? "-> light sleep" : "-> deep sleep");
 }
 
+void OswHal::suspend() {
+#if defined(GPS_EDITION) || defined(GPS_EDITION_ROTATED)
+    this->gpsBackupMode();
+    this->sdOff();
+#endif
+    this->devices()->suspend();
+
+    this->displayOff();
+    this->stopDisplay(true);
+    OswServiceManager::getInstance().suspend();
+
+    // The system clock keeps running during the light sleep, so it is used to detect a drift of the time provider
+    this->_suspendedAtSystemTime = time(nullptr);
+    this->_suspendedAtUTCTime = this->timeProvider ? this->getUTCTime() : 0;
+    OSW_LOG_D("-> light sleep (suspended)");
+}
+
+void OswHal::resume() {
+    this->setupPower(true);
+    this->setupDisplay(true); // Only restores the backlight, the canvas and its buffers were kept
+    this->devices()->resume();
+
+    if(this->timeProvider) {
+        // Read the provider itself - the clock and the cached time of the provider are both from before the sleep
+        this->devices()->update(this->timeProvider);
+        const time_t expected = this->_suspendedAtUTCTime + (time(nullptr) - this->_suspendedAtSystemTime);
+        const time_t drift = this->timeProvider->getUTCTime() - expected;
+        if(drift > this->_resumeMaxClockDrift or drift < -this->_resumeMaxClockDrift) {
+            OSW_LOG_D("Time provider drifted by ", drift, " seconds during the light sleep, refreshing the cached time data...");
+            this->devices()->update();
+            this->_clock.reset(); // Step to the provider with the next sample, instead of slewing towards it
+            this->_clockSampledAt = 0;
+            this->updateTimezoneOffsets();
+        }
+    }
+#if OSW_PLATFORM_ENVIRONMENT_ACCELEROMETER == 1 && defined(OSW_FEATURE_STATS_STEPS)
+    this->environment()->commitStepStatistics(false); // In case the day changed while sleeping
+#endif
+
+    OswServiceManager::getInstance().resume();
+    OSW_LOG_D("<- light sleep (resumed)");
+}
+
 #if OSW_PLATFORM_IS_FLOW3R_BADGE == 1
 uint8_t OswHal::readGpioExtender(uint8_t address) {
     Wire.beginTransmission(address);
@@ -1,12 +1,46 @@
 #include "osw_service.h"
 
+#include "services/OswServiceManager.h"
+
 void OswServiceTask::setup() {
     this->taskEnabled = true;
+    this->sleeping = false;
 }
 void OswServiceTask::stop() {
     this->taskEnabled = false;
 }
 
+void OswServiceTask::suspend() {}
+void OswServiceTask::resume() {}
+
 bool OswServiceTask::isRunning() {
     return this->taskEnabled;
 }
+
+void OswServiceTask::wakeUp() {
+    this->woken = true;
+    OswServiceManager::getInstance().notify();
+}
+
+bool OswServiceTask::isDue(unsigned long now) const {
+    if(this->woken or !this->sleeping)
+        return true;
+    if(this->sleepingForever)
+        return false;
+    return (long) (now - this->wakeAt) >= 0; // Also right across the overflow of millis()
+}
+
+void OswServiceTask::sleepFor(unsigned long ms) {
+    this->sleepUntil(millis() + ms);
+}
+
+void OswServiceTask::sleepUntil(unsigned long at) {
+    this->wakeAt = at;
+    this->sleepingForever = false;
+    this->sleeping = true;
+}
+
+void OswServiceTask::sleepUntilWoken() {
+    this->sleepingForever = true;
+    this->sleeping = true;
+}
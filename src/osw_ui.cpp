@@ -7,6 +7,7 @@
 #include <osw_ui.h>
 
 std::unique_ptr<OswUI> OswUI::instance = nullptr;
+std::atomic<unsigned int> OswUI::lastFlushDone = 0;
 OswUI::OswUI() {
     this->drawLock.reset(new std::mutex());
 };
@@ -21,6 +22,10 @@ void OswUI::resetInstance() {
     return OswUI::instance.reset();
 };
 
+void OswUI::onFlushDone() {
+    OswUI::lastFlushDone = millis();
+}
+
 uint16_t OswUI::getBackgroundColor(void) {
     return rgb888to565(OswConfigAllKeys::themeBackgroundColor.get());
 }
@@ -102,15 +107,12 @@ void OswUI::loop() {
                                       OswHal::getInstance()->btnHasGoneDown(BUTTON_2) ||
                                       OswHal::getInstance()->btnHasGoneDown(BUTTON_3));
         // Drop all timed out notifications
-        for (auto it = this->mNotifications.begin(); it != this->mNotifications.end();) {
-            if (it->getEndTime() <= millis() || notificationsDismissed) {
-                it = this->mNotifications.erase(it);
-                this->mSelfNeedsRedraw = true;
-            } else {
-                ++it;
-            }
+        for (auto index = this->mNotifications.getDue(millis()); index != NotificationStore::NONE; index = this->mNotifications.getDue(millis())) {
+            this->mNotifications.remove(index);
+            this->mSelfNeedsRedraw = true;
         }
         if (notificationsDismissed) {
+            this->mNotifications.clear();
             // Don't propagate the OswHall::btnHasGoneDown() event further
             this->mSelfNeedsRedraw = true;
             return;
@@ -123,6 +125,8 @@ void OswUI::loop() {
         return; // Early abort if no app is set
     }
     rootApp->onLoop();
+    this->appViewFlags = rootApp->getViewFlags();
+    this->appCpuFrequency = rootApp->getCpuFrequency();
 #ifdef OSW_EMULATOR
 #ifndef NDEBUG
     if(!OswEmulator::instance->isHeadless)
@@ -136,10 +140,11 @@ void OswUI::loop() {
         if(not (rootApp->getViewFlags() & OswAppV2::ViewFlags::NO_FPS_LIMIT) and this->mEnableTargetFPS and (millis() - lastFlush) < (1000 / this->mTargetFPS))
             return; // Early abort if we would draw too fast
         std::lock_guard<std::mutex> guard(*this->drawLock); // Make sure to not modify the notifications vector during drawing
+        const unsigned long renderStart = micros();
 
         // BG
-        if (OswHal::getInstance()->displayBufferEnabled())
-            OswHal::getInstance()->gfx()->fillBuffer(this->getBackgroundColor()); // this will not overwrite the whole screen, but only the buffer
+        if (OswHal::getInstance()->displayBufferEnabled() or OswHal::getInstance()->displayStripBufferEnabled())
+            OswHal::getInstance()->gfx()->fillBuffer(this->getBackgroundColor()); // this will not overwrite the whole screen, but only the buffer (or starts a new display list)
         else if (this->lastBGFlush < millis() - 10000) {
             // In case the buffering is inactive, only flush every 10 seconds the whole buffer
             OswHal::getInstance()->gfx()->fill(this->getBackgroundColor());
@@ -165,23 +170,30 @@ void OswUI::loop() {
         }
 
         this->resetTextColors();
+        bool notificationsShown;
         {
             std::lock_guard<std::mutex> notifyGuard(this->mNotificationsLock);
+            notificationsShown = !this->mNotifications.empty();
             // Draw all notifications
             auto y = DISP_H;
-            for (const auto& notification : this->mNotifications) {
-                y -= notification.getDrawHeight();
-                notification.draw(y);
+            for (auto index = this->mNotifications.first(); index != NotificationStore::NONE; index = this->mNotifications.next(index)) {
+                y -= getNotificationDrawHeight(getNotificationLines(this->mNotifications.getMessage(index)));
+                this->drawNotification(index, y);
             }
         }
 
         // Only draw overlays if enabled
-        if (OswConfigAllKeys::settingDisplayOverlays.get() and (not (rootApp->getViewFlags() & OswAppV2::ViewFlags::NO_OVERLAYS) or OswConfigAllKeys::settingDisplayOverlaysForced.get()))
+        const bool overlays = OswConfigAllKeys::settingDisplayOverlays.get() and (not (rootApp->getViewFlags() & OswAppV2::ViewFlags::NO_OVERLAYS) or OswConfigAllKeys::settingDisplayOverlaysForced.get());
+        if (overlays)
             drawOverlays();
+        // The app may have limited the flush to the area it changed, which is only enough if nothing else was drawn
+        if (overlays or this->mSelfNeedsRedraw or this->mProgressBar != nullptr or notificationsShown)
+            OswHal::getInstance()->getCanvas()->resetFlushLimit();
 
         // Handle display flushing
         OswHal::getInstance()->flushCanvas();
         lastFlush = millis();
+        this->renderTime += micros() - renderStart;
         rootApp->resetNeedsRedraw(); // indirect convention: we will clear the redraw flag after drawing (so if you set it again during onDraw(), you will need to move that to the onLoop())
         this->mSelfNeedsRedraw = false;
     }
@@ -197,22 +209,22 @@ void OswUI::startProgress(const char* text) {
     this->mProgressText = text;
 }
 
-size_t OswUI::showNotification(std::string message, bool isPersistent) {
-    std::lock_guard<std::mutex> guard(this->mNotificationsLock);  // Make sure to not modify the notifications vector during drawing
-    auto notification = OswUI::OswUINotification{std::move(message), isPersistent};
-    this->mNotifications.push_back(notification);
+size_t OswUI::showNotification(std::string_view message, bool isPersistent) {
+    std::lock_guard<std::mutex> guard(this->mNotificationsLock);  // Make sure to not modify the notifications during drawing
+    if (this->mNotifications.full())
+        this->mNotifications.remove(this->mNotifications.first()); // Make room by dropping the oldest one
+    const unsigned long endTime = millis() + (isPersistent ? notificationDurationPerLinePersistant : notificationDurationPerLine) * getNotificationLines(message);
+    auto index = this->mNotifications.add(endTime, {}, message, 0, isPersistent);
     this->mSelfNeedsRedraw = true;
-    return notification.getId();
+    return this->mNotifications[index].id;
 }
 
 void OswUI::hideNotification(size_t id) {
-    std::lock_guard<std::mutex> guard(this->mNotificationsLock);  // Make sure to not modify the notifications vector during drawing
-    for (auto it = this->mNotifications.begin(); it != this->mNotifications.end(); ++it) {
-        if (it->getId() == id) {
-            this->mNotifications.erase(it);
-            this->mSelfNeedsRedraw = true;
-            return;
-        }
+    std::lock_guard<std::mutex> guard(this->mNotificationsLock);  // Make sure to not modify the notifications during drawing
+    auto index = this->mNotifications.find(id);
+    if (index != NotificationStore::NONE) {
+        this->mNotifications.remove(index);
+        this->mSelfNeedsRedraw = true;
     }
 }
 
@@ -306,20 +318,7 @@ void OswUI::OswUIProgress::draw() {
         OswHal::getInstance()->gfx()->fillFrame(fgStart, this->y, fgBarWidth, barHeight, this->fgColor);
 }
 
-size_t OswUI::OswUINotification::count{};
-
-OswUI::OswUINotification::OswUINotification(std::string message, bool isPersistent)
-    : id(count), message{message.c_str()}, lines(countLines(message)), endTime{millis() + (isPersistent ? notificationDurationPerLinePersistant : notificationDurationPerLine) * lines} {
-    ++count;
-}
-
-/**
- * @brief This function is used in constructor to calculate the constant value
- *
- * @param message
- * @return unsigned char
- */
-unsigned char OswUI::OswUINotification::countLines(const std::string& message) const {
+unsigned char OswUI::getNotificationLines(std::string_view message) {
     unsigned char lines = 1;
     for (auto c: message) {
         if (c == '\n') {
@@ -334,19 +333,20 @@ unsigned char OswUI::OswUINotification::countLines(const std::string& message) c
  *
  * @return unsigned char
  */
-unsigned char OswUI::OswUINotification::getDrawHeight() const {
+unsigned char OswUI::getNotificationDrawHeight(unsigned char lines) {
     return 4 + 8 * lines + 4; // padding, line height, padding
 }
 
-void OswUI::OswUINotification::draw(unsigned y) const {
+void OswUI::drawNotification(NotificationStore::Index index, unsigned y) {
     // TODO handle too long texts by adding a scroll animation?
     Graphics2DPrint* gfx = OswHal::getInstance()->gfx();
-    auto height = this->getDrawHeight();
-    gfx->fillFrame(0, y, DISP_W, height, OswUI::getInstance()->getBackgroundColor());
-    gfx->drawHLine(0, y, DISP_W, OswUI::getInstance()->getInfoColor());
+    const std::string_view message = this->mNotifications.getMessage(index);
+    auto height = getNotificationDrawHeight(getNotificationLines(message));
+    gfx->fillFrame(0, y, DISP_W, height, this->getBackgroundColor());
+    gfx->drawHLine(0, y, DISP_W, this->getInfoColor());
     gfx->resetText();
     gfx->setTextCenterAligned();
     gfx->setTextSize(1.0f);
     gfx->setTextCursor(DISP_W * 0.5f, y + 4 + 8);  // To align the text, it is assumed that one char has a height of 8 pixels
-    gfx->print(this->message);
+    gfx->write((const uint8_t*) message.data(), message.size());
 }
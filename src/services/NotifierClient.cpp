@@ -4,13 +4,13 @@ NotifierClient::NotifierClient(std::string publisher) : publisher{std::move(publ
 }
 
 NotificationData NotifierClient::createNotification(std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds> timeToFire,
-        std::string message, std::array<bool, 7> daysOfWeek, bool isPersistent) {
-    return OswServiceAllTasks::notifier.createNotification(timeToFire, publisher, std::move(message), std::move(daysOfWeek), isPersistent);
+        std::string_view message, std::array<bool, 7> daysOfWeek, bool isPersistent) {
+    return OswServiceAllTasks::notifier.createNotification(timeToFire, publisher, message, std::move(daysOfWeek), isPersistent);
 }
 
 NotificationData NotifierClient::createNotification(int hours, int minutes,
-        std::string message, std::array<bool, 7> daysOfWeek, bool isPersistent) {
-    return OswServiceAllTasks::notifier.createNotification(hours, minutes, publisher, std::move(message), std::move(daysOfWeek), isPersistent);
+        std::string_view message, std::array<bool, 7> daysOfWeek, bool isPersistent) {
+    return OswServiceAllTasks::notifier.createNotification(hours, minutes, publisher, message, std::move(daysOfWeek), isPersistent);
 }
 
 /**
@@ -19,9 +19,9 @@ NotificationData NotifierClient::createNotification(int hours, int minutes,
  * @param message
  * @return NotificationData
  */
-NotificationData NotifierClient::showToast(std::string message) {
+NotificationData NotifierClient::showToast(std::string_view message) {
     auto now = std::chrono::system_clock::from_time_t(OswHal::getInstance()->getUTCTime());
-    return OswServiceAllTasks::notifier.createNotification(std::chrono::time_point_cast<std::chrono::seconds>(now), publisher, std::move(message), std::array<bool, 7> {true, true, true, true, true, true, true}, false);
+    return OswServiceAllTasks::notifier.createNotification(std::chrono::time_point_cast<std::chrono::seconds>(now), publisher, message, std::array<bool, 7> {true, true, true, true, true, true, true}, false);
 }
 
 std::vector<NotificationData> NotifierClient::readNotifications() {
@@ -1,5 +1,7 @@
 #include "./services/OswServiceManager.h"
 
+#include <algorithm>
+
 #include "./services/OswServiceTasks.h"
 #include "esp_task_wdt.h"
 
@@ -11,46 +13,163 @@ std::unique_ptr<OswServiceManager> OswServiceManager::instance = nullptr;
 void OswServiceManager::setup() {
     if (this->active) return;
     this->active = true;
+    this->suspended = false;
     for (unsigned char i = 0; i < oswServiceTasksCount; i++)
         if(oswServiceTasks[i])
             oswServiceTasks[i]->setup();
+    this->startWorker(true);
+}
+
+void OswServiceManager::startWorker(bool delayed) {
+#ifndef OSW_EMULATOR
+    TaskHandle_t worker = nullptr;
+    if(xTaskCreatePinnedToCore([](void* pvParameters) -> void { OswServiceManager::getInstance().worker(pvParameters != nullptr); },
+                               "oswServiceManager", this->workerStackSize /*stack*/, (void*) (uintptr_t) delayed /*input*/, 0 /*prio*/,
+                               &worker /*handle*/, 0) != pdPASS) {
+        OSW_LOG_E("Failed to start the background worker!");
+        return;
+    }
+    // Only published once it exists, notify() may use it from any task right away
+    portENTER_CRITICAL(&this->workerLock);
+    this->core0worker = worker;
+    this->workerRunning = true;
+    portEXIT_CRITICAL(&this->workerLock);
+#else
+    this->core0worker.reset(new std::jthread([delayed]() -> void { OswServiceManager::getInstance().worker(delayed); }));
+#endif
+}
+
+/**
+ * Waits until the worker finished its current loop() and terminated
+ */
+void OswServiceManager::stopWorker() {
+    this->active = false;
+    this->notify(); // Do not wait for the end of the current pause
 #ifndef OSW_EMULATOR
-    xTaskCreatePinnedToCore([](void* pvParameters) -> void { OswServiceManager::getInstance().worker(); },
-                            "oswServiceManager", this->workerStackSize /*stack*/, NULL /*input*/, 0 /*prio*/,
-                            &this->core0worker /*handle*/, 0);
+    while(this->workerRunning)
+        delay(1);
 #else
-    this->core0worker.reset(new std::jthread([]() -> void { OswServiceManager::getInstance().worker(); }));
+    this->core0worker.reset(); // Joins the thread
 #endif
 }
 
 /**
- * Waits this->workerStartupDelay and then starts the task loop
+ * Waits this->workerStartupDelay (if delayed) and then starts the task loop
  */
-void OswServiceManager::worker() {
-    delay(this->workerStartupDelay);  // Wait two seconds to give the rest of the OS time to boot (in case a service causes a system crash -
-    // wifi)
+void OswServiceManager::worker(bool delayed) {
+    // Wait two seconds to give the rest of the OS time to boot (in case a service causes a system crash - wifi)
+    for(unsigned waited = 0; delayed and waited < this->workerStartupDelay and this->active; waited += this->workerLoopDelay)
+        delay(this->workerLoopDelay);
     OSW_LOG_D("Background worker started.");
     while (this->active) {
-        this->loop();
+        const unsigned long loopStart = micros();
+        const unsigned long idle = this->loop();
+        this->busyTime += micros() - loopStart;
         delay(this->workerLoopDelay);  // Give the kernel time to do his stuff (as we are normally running this on his core 0)
+        if(idle > this->workerLoopDelay and this->active)
+            this->wait(idle - this->workerLoopDelay); // Nobody is due yet, unless someone wakes up a task
     }
     OSW_LOG_D("Background worker terminated!");
 #ifndef OSW_EMULATOR
+    // Withdrawn before the task is gone, so notify() never uses a deleted handle
+    portENTER_CRITICAL(&this->workerLock);
+    this->core0worker = nullptr;
+    this->workerRunning = false;
+    portEXIT_CRITICAL(&this->workerLock);
     vTaskDelete(nullptr); // Inform FreeRTOS this task is done - otherwise the kernel will take that personally and crash!
 #endif
 }
 
-void OswServiceManager::loop() {
-    for (unsigned char i = 0; i < oswServiceTasksCount; i++)
-        if (oswServiceTasks[i])
-            if (oswServiceTasks[i]->isRunning())
-                oswServiceTasks[i]->loop();
+/**
+ * Pauses the worker for up to ms, or until notify() is called
+ */
+void OswServiceManager::wait(unsigned long ms) {
+#ifndef OSW_EMULATOR
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms));
+#else
+    std::unique_lock<std::mutex> lock(this->notifyLock);
+    this->notifyCondition.wait_for(lock, std::chrono::milliseconds(ms), [this]() -> bool { return this->notified; });
+    this->notified = false;
+#endif
+}
+
+void OswServiceManager::notify() {
+#ifndef OSW_EMULATOR
+    portENTER_CRITICAL(&this->workerLock); // Called from other tasks, while the worker may just start or end
+    if(this->core0worker != nullptr)
+        xTaskNotifyGive(this->core0worker); // Never yields to the worker, it has the lowest priority
+    portEXIT_CRITICAL(&this->workerLock);
+#else
+    {
+        std::lock_guard<std::mutex> lock(this->notifyLock);
+        this->notified = true;
+    }
+    this->notifyCondition.notify_all();
+#endif
+}
+
+unsigned long OswServiceManager::loop() {
+    return this->loop(oswServiceTasks, oswServiceTasksCount, millis());
+}
+
+unsigned long OswServiceManager::loop(OswServiceTask* const tasks[], unsigned char count, unsigned long now) {
+    unsigned long idle = this->workerMaxSleep;
+    for (unsigned char i = 0; i < count; i++) {
+        OswServiceTask* task = tasks[i];
+        if (!task or !task->isRunning())
+            continue;
+        if (task->isDue(now)) {
+            // Cleared before the loop(), so a wakeUp() while it runs is not lost - and a task which does not go to sleep
+            // again runs on the next round
+            task->sleeping = false;
+            task->woken = false;
+            const unsigned long start = micros();
+            task->loop();
+            const unsigned long elapsed = micros() - start;
+
+            OswServiceTask::Stats& stats = task->stats;
+            ++stats.loops;
+            stats.time += elapsed;
+            if (elapsed > task->getLoopBudget()) {
+                ++stats.overruns;
+                // Only the first and every new worst overrun, otherwise a slow task would flood the log
+                if (stats.overruns == 1 or elapsed > stats.maxTime)
+                    OSW_LOG_W("Service task #", i, " took ", elapsed, " us (budget ", task->getLoopBudget(), " us, ", stats.overruns, " overruns so far) - it delayed all others!");
+            }
+            stats.maxTime = std::max(stats.maxTime, elapsed);
+        }
+        if (task->isDue(now))
+            idle = 0;
+        else if (!task->sleepingForever and !task->woken)
+            idle = std::min(idle, task->wakeAt - now);
+    }
+    return idle;
 }
 
 void OswServiceManager::stop() {
-    if(!this->active) return;
+    if(!this->active and !this->suspended) return;
     this->active = false;
+    this->suspended = false;
     for (unsigned char i = 0; i < oswServiceTasksCount; i++)
         if(oswServiceTasks[i])
             oswServiceTasks[i]->stop();
 }
+
+void OswServiceManager::suspend() {
+    if(!this->active) return;
+    this->stopWorker(); // No task may be inside its loop() while it is suspended
+    this->suspended = true;
+    for (unsigned char i = 0; i < oswServiceTasksCount; i++)
+        if(oswServiceTasks[i] and oswServiceTasks[i]->isRunning())
+            oswServiceTasks[i]->suspend();
+}
+
+void OswServiceManager::resume() {
+    if(!this->suspended) return;
+    this->suspended = false;
+    this->active = true;
+    for (unsigned char i = 0; i < oswServiceTasksCount; i++)
+        if(oswServiceTasks[i] and oswServiceTasks[i]->isRunning())
+            oswServiceTasks[i]->resume();
+    this->startWorker(false); // The tasks were already running before, no need to wait for the OS to settle
+}
@@ -8,7 +8,6 @@
 #include <BLEUtils.h>
 #include <BLEServer.h>
 #include <BLECharacteristic.h>
-#include <ArduinoJson.h>
 
 #include <string.h>
 #include "config_defaults.h"
@@ -23,36 +22,33 @@ class NotificationCallback: public BLECharacteristicCallbacks {
 
     virtual void onRead(BLECharacteristic* pCharacteristic) {};
     virtual void onWrite(BLECharacteristic* pCharacteristic) {
-        //Parse message as JSON object
-        OSW_LOG_D(pCharacteristic->getValue().c_str());
-        DynamicJsonDocument doc(5000); //ArduinoJSON no longer allows Dynamic allocation to grow
-
-        deserializeJson(doc, pCharacteristic->getValue());
-
-        //Pull values from JSON
-        const char* app = "", *contents = "";
-        unsigned int uid = 0;
-
-        if (doc.containsKey("app"))
-            app = doc["app"];
+        // Straight from the buffer of the characteristic (getValue() would copy it), the receiver parses it in its own
+        // fixed buffer - so a burst of notifications does not cause any heap allocations.
+        companion->receiver.feed(pCharacteristic->getData(), pCharacteristic->getLength(), [this](const OswCompanionMessage& message) {
+            // Notify our client about the new notification
+            if (companion->notificationCallback) {
+                companion->notificationCallback(message);
+            }
+        });
+    };
 
-        if (doc.containsKey("contents"))
-            contents = doc["contents"];
+    virtual void onNotify(BLECharacteristic* pCharacteristic) {};
+    virtual void onStatus(BLECharacteristic* pCharacteristic, Status s, uint32_t code) {};
 
-        if (doc.containsKey("uid"))
-            uid = doc["uid"];
+  private:
+    OswServiceTaskBLECompanion* companion;
+};
 
-        NotificationDetails details {uid, app, contents};
+class CompanionServerCallbacks: public BLEServerCallbacks {
+  public:
+    CompanionServerCallbacks(OswServiceTaskBLECompanion* comp) {
+        companion = comp;
+    }
 
-        // Notify our client about the new notification
-        if (companion->notificationCallback) {
-            companion->notificationCallback(details);
-        }
+    virtual void onDisconnect(BLEServer* pServer) {
+        companion->receiver.reset(); // A message cut off by the disconnect must not prefix the next one
     };
 
-    virtual void onNotify(BLECharacteristic* pCharacteristic) {};
-    virtual void onStatus(BLECharacteristic* pCharacteristic, Status s, uint32_t code) {};
-
   private:
     OswServiceTaskBLECompanion* companion;
 };
@@ -61,6 +57,7 @@ void OswServiceTaskBLECompanion::setup() {
     OswServiceTask::setup();
     BLEDevice::init(BLE_DEVICE_NAME);
     bleServer = BLEDevice::createServer();
+    bleServer->setCallbacks(new CompanionServerCallbacks(this));
     notificationService = bleServer->createService(NOTIFICATION_SERVICE_UID);
 
     notificationChar = notificationService->createCharacteristic(NOTIFICATION_BRDCST_CHAR, BLECharacteristic::PROPERTY_WRITE);
@@ -1,6 +1,7 @@
 #ifdef OSW_FEATURE_BLE_SERVER
 #include "./services/OswServiceTaskBLEServer.h"
 #include "osw_hal.h"
+#include "hal/osw_filesystem.h"
 
 #define BATTERY_SERVICE_UUID                         "0000180f-0000-1000-8000-00805f9b34fb"
 #define BATTERY_LEVEL_CHARACTERISTIC_UUID            "00002A19-0000-1000-8000-00805f9b34fb"
@@ -19,6 +20,21 @@
 #define STEP_COUNT_TOTAL_WEEK_CHARACTERISTIC_UUID    "0b97315f-883b-4e1e-a745-bc2dd14aedb4"
 #define STEP_COUNT_TODAY_CHARACTERISTIC_UUID         "143a6279-67ce-43c2-8db2-082a9fbca140"
 #define STEP_COUNT_DAY_HISTORY_CHARACTERISTIC_UUID   "6b078d24-79ae-4fff-bf3a-2b71dce2b2bb"
+#define LIVE_STATUS_CHARACTERISTIC_UUID              "e1a87f52-1c6d-4b7a-9f3e-5d2c8b4a6f01"
+#define BULK_CONTROL_CHARACTERISTIC_UUID             "e1a87f53-1c6d-4b7a-9f3e-5d2c8b4a6f01"
+#define BULK_DATA_CHARACTERISTIC_UUID                "e1a87f54-1c6d-4b7a-9f3e-5d2c8b4a6f01"
+
+static const unsigned long liveDataSampleInterval = 1000; // ms, same as the notification window
+static const uint16_t preferredMTU = 185; // the phone has the final say, larger ones cost more memory per connection
+static const unsigned long bulkTransferInterval = 5; // ms between the bursts of frames of a bulk transfer
+
+OswServiceTaskBLEServer::OswServiceTaskBLEServer() {
+    // The files the phone may fetch with the bulk transfer
+    this->bulk.addFile("sensors.trace", FS_MOUNT_POINT "/sensors.trace");
+#if defined(GPS_EDITION) || defined(GPS_EDITION_ROTATED)
+    this->bulk.addFile("sd/sensors.trace", "/sd/sensors.trace");
+#endif
+}
 
 void OswServiceTaskBLEServer::setup() {
     OswServiceTask::setup();
@@ -35,6 +51,14 @@ void OswServiceTaskBLEServer::loop() {
         this->bootDone = true;
     }
     this->updateBLEConfig();
+    bool transferring = false;
+    if(this->server != nullptr) {
+        transferring = this->updateBulkTransfer();
+        this->updateLiveData();
+        this->updateConnectionParameters();
+    }
+    // enable(), disable() and new connections, subscriptions or control point writes wake us up earlier
+    this->sleepFor(transferring ? bulkTransferInterval : liveDataSampleInterval);
 }
 
 void OswServiceTaskBLEServer::stop() {
@@ -43,12 +67,25 @@ void OswServiceTaskBLEServer::stop() {
     this->updateBLEConfig();
 }
 
+void OswServiceTaskBLEServer::suspend() {
+    this->resumeEnabled = this->enabled;
+    this->disable();
+    this->updateBLEConfig();
+}
+
+void OswServiceTaskBLEServer::resume() {
+    if(this->resumeEnabled)
+        this->enable(); // The next loop() brings the server up again
+}
+
 void OswServiceTaskBLEServer::enable() {
     this->enabled = true;
+    this->wakeUp();
 }
 
 void OswServiceTaskBLEServer::disable() {
     this->enabled = false;
+    this->wakeUp();
 }
 
 bool OswServiceTaskBLEServer::isEnabled() {
@@ -63,6 +100,7 @@ void OswServiceTaskBLEServer::updateBLEConfig() {
 
         NimBLEDevice::setSecurityAuth(true, true, true); // support bonding, with mitm-protection and secure pairing
         NimBLEDevice::setSecurityIOCap(BLE_HS_IO_DISPLAY_ONLY); // we can display yes/no with a given key to the user
+        NimBLEDevice::setMTU(preferredMTU);
 
         // Create the BLE Server
         this->server = NimBLEDevice::getServer();
@@ -79,16 +117,16 @@ void OswServiceTaskBLEServer::updateBLEConfig() {
             // Create a BLE Characteristic: "Battery Level"
             this->characteristicBat = serviceBat->createCharacteristic(
                                           BATTERY_LEVEL_CHARACTERISTIC_UUID,
-                                          NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_ENC | NIMBLE_PROPERTY::READ_AUTHEN
+                                          NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_ENC | NIMBLE_PROPERTY::READ_AUTHEN | NIMBLE_PROPERTY::NOTIFY
                                       );
-            this->characteristicBat->setCallbacks(new BatteryLevelCharacteristicCallbacks());
+            this->characteristicBat->setCallbacks(new LiveDataCharacteristicCallbacks(this, OswBLELiveData::Channel::BATTERY_LEVEL));
 
             // Create a BLE Characteristic: "Battery Level Status"
             this->characteristicBatStat = serviceBat->createCharacteristic(
                                               BATTERY_LEVEL_STATUS_CHARACTERISTIC_UUID,
-                                              NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_ENC | NIMBLE_PROPERTY::READ_AUTHEN
+                                              NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_ENC | NIMBLE_PROPERTY::READ_AUTHEN | NIMBLE_PROPERTY::NOTIFY
                                           );
-            this->characteristicBatStat->setCallbacks(new BatteryLevelStatusCharacteristicCallbacks());
+            this->characteristicBatStat->setCallbacks(new LiveDataCharacteristicCallbacks(this, OswBLELiveData::Channel::BATTERY_LEVEL_STATUS));
 
             // Start the service
             this->serviceBat->start();
@@ -149,42 +187,63 @@ void OswServiceTaskBLEServer::updateBLEConfig() {
                                         );
             this->characteristicToast->setCallbacks(new ToastCharacteristicCallbacks(this));
 
+            // Create a BLE Characteristic: "Live Status" (battery and steps in one notification, see OswBLELiveData)
+            this->characteristicLiveStatus = this->serviceOsw->createCharacteristic(
+                                                 LIVE_STATUS_CHARACTERISTIC_UUID,
+                                                 NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_ENC | NIMBLE_PROPERTY::READ_AUTHEN | NIMBLE_PROPERTY::NOTIFY
+                                             );
+            this->characteristicLiveStatus->setCallbacks(new LiveDataCharacteristicCallbacks(this, OswBLELiveData::Channel::LIVE_STATUS));
+
+            // Create the BLE Characteristics of the bulk transfer (see OswBLEBulkTransfer)
+            this->characteristicBulkControl = this->serviceOsw->createCharacteristic(
+                                                  BULK_CONTROL_CHARACTERISTIC_UUID,
+                                                  NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_ENC | NIMBLE_PROPERTY::WRITE_AUTHEN | NIMBLE_PROPERTY::NOTIFY
+                                              );
+            this->characteristicBulkControl->setCallbacks(new BulkControlCharacteristicCallbacks(this));
+            this->characteristicBulkData = this->serviceOsw->createCharacteristic(
+                                               BULK_DATA_CHARACTERISTIC_UUID,
+                                               NIMBLE_PROPERTY::NOTIFY
+                                           );
+
 #if OSW_PLATFORM_ENVIRONMENT_ACCELEROMETER == 1
             this->characteristicStepCountToday = this->serviceOsw->createCharacteristic(
                     STEP_COUNT_TODAY_CHARACTERISTIC_UUID,
-                    NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_ENC | NIMBLE_PROPERTY::READ_AUTHEN
+                    NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_ENC | NIMBLE_PROPERTY::READ_AUTHEN | NIMBLE_PROPERTY::NOTIFY
                                                  );
-            this->characteristicStepCountToday->setCallbacks(new StepsTodayCharacteristicCallbacks());
+            this->characteristicStepCountToday->setCallbacks(new LiveDataCharacteristicCallbacks(this, OswBLELiveData::Channel::STEPS_TODAY));
 
             this->characteristicStepCountTotal = this->serviceOsw->createCharacteristic(
                     STEP_COUNT_TOTAL_CHARACTERISTIC_UUID,
-                    NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_ENC | NIMBLE_PROPERTY::READ_AUTHEN
+                    NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_ENC | NIMBLE_PROPERTY::READ_AUTHEN | NIMBLE_PROPERTY::NOTIFY
                                                  );
-            this->characteristicStepCountTotal->setCallbacks(new StepsTotalCharacteristicCallbacks());
+            this->characteristicStepCountTotal->setCallbacks(new LiveDataCharacteristicCallbacks(this, OswBLELiveData::Channel::STEPS_TOTAL));
 
             this->characteristicStepCountTotalWeek = this->serviceOsw->createCharacteristic(
                         STEP_COUNT_TOTAL_WEEK_CHARACTERISTIC_UUID,
-                        NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_ENC | NIMBLE_PROPERTY::READ_AUTHEN
+                        NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_ENC | NIMBLE_PROPERTY::READ_AUTHEN | NIMBLE_PROPERTY::NOTIFY
                     );
-            this->characteristicStepCountTotalWeek->setCallbacks(new StepsTotalWeekCharacteristicCallbacks());
+            this->characteristicStepCountTotalWeek->setCallbacks(new LiveDataCharacteristicCallbacks(this, OswBLELiveData::Channel::STEPS_TOTAL_WEEK));
 #ifdef OSW_FEATURE_STATS_STEPS
             this->characteristicStepCountAverage = this->serviceOsw->createCharacteristic(
                     STEP_COUNT_AVERAGE_CHARACTERISTIC_UUID,
-                    NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_ENC | NIMBLE_PROPERTY::READ_AUTHEN
+                    NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_ENC | NIMBLE_PROPERTY::READ_AUTHEN | NIMBLE_PROPERTY::NOTIFY
                                                    );
-            this->characteristicStepCountAverage->setCallbacks(new StepsAverageCharacteristicCallbacks());
+            this->characteristicStepCountAverage->setCallbacks(new LiveDataCharacteristicCallbacks(this, OswBLELiveData::Channel::STEPS_AVERAGE));
 
             this->characteristicStepCountHistory = this->serviceOsw->createCharacteristic(
                     STEP_COUNT_DAY_HISTORY_CHARACTERISTIC_UUID,
                     NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_ENC | NIMBLE_PROPERTY::READ_AUTHEN
                                                    );
-            this->characteristicStepCountHistory->setCallbacks(new StepsDayHistoryCharacteristicCallbacks());
+            this->characteristicStepCountHistory->setCallbacks(new StepsDayHistoryCharacteristicCallbacks(this));
 #endif
 #endif
             // Start the service
             this->serviceOsw->start();
         }
 
+        // The first sample before anyone can connect, so the reads (on the NimBLE host task) never wait for the HAL
+        this->updateLiveData();
+
         // Start advertising
         {
             BLEAdvertising* pAdvertising = BLEDevice::getAdvertising();
@@ -210,6 +269,9 @@ void OswServiceTaskBLEServer::updateBLEConfig() {
         this->serviceDevice->removeCharacteristic(this->characteristicSoftRev, true);
         this->server->removeService(this->serviceDevice, true);
         this->serviceOsw->removeCharacteristic(this->characteristicToast, true);
+        this->serviceOsw->removeCharacteristic(this->characteristicLiveStatus, true);
+        this->serviceOsw->removeCharacteristic(this->characteristicBulkControl, true);
+        this->serviceOsw->removeCharacteristic(this->characteristicBulkData, true);
 #if OSW_PLATFORM_ENVIRONMENT_ACCELEROMETER == 1
         this->serviceOsw->removeCharacteristic(this->characteristicStepCountToday, true);
         this->serviceOsw->removeCharacteristic(this->characteristicStepCountTotal, true);
@@ -222,9 +284,118 @@ void OswServiceTaskBLEServer::updateBLEConfig() {
         this->server->removeService(this->serviceOsw, true);
         this->server = nullptr;
         NimBLEDevice::deinit(true);
+        this->hasSample = false;
+        std::lock_guard<std::mutex> guard(this->bulkLock);
+        this->bulk.cancel();
+    }
+}
+
+static OswBLELiveData::Values sampleLiveData() {
+    OswBLELiveData::Values values;
+    values.batteryPercent = OswHal::getInstance()->getBatteryPercent();
+    values.charging = OswHal::getInstance()->isCharging();
+#if OSW_PLATFORM_ENVIRONMENT_ACCELEROMETER == 1
+    values.hasSteps = true;
+    values.stepsToday = OswHal::getInstance()->environment()->getStepsToday();
+    values.stepsTotalWeek = OswHal::getInstance()->environment()->getStepsTotalWeek();
+    values.stepsTotal = OswHal::getInstance()->environment()->getStepsTotal();
+#ifdef OSW_FEATURE_STATS_STEPS
+    values.stepsAverage = OswHal::getInstance()->environment()->getStepsAverage();
+#endif
+#endif
+    return values;
+}
+
+NimBLECharacteristic* OswServiceTaskBLEServer::getCharacteristic(OswBLELiveData::Channel channel) {
+    switch(channel) {
+    case OswBLELiveData::Channel::BATTERY_LEVEL:
+        return this->characteristicBat;
+    case OswBLELiveData::Channel::BATTERY_LEVEL_STATUS:
+        return this->characteristicBatStat;
+#if OSW_PLATFORM_ENVIRONMENT_ACCELEROMETER == 1
+    case OswBLELiveData::Channel::STEPS_TODAY:
+        return this->characteristicStepCountToday;
+    case OswBLELiveData::Channel::STEPS_TOTAL_WEEK:
+        return this->characteristicStepCountTotalWeek;
+    case OswBLELiveData::Channel::STEPS_TOTAL:
+        return this->characteristicStepCountTotal;
+#ifdef OSW_FEATURE_STATS_STEPS
+    case OswBLELiveData::Channel::STEPS_AVERAGE:
+        return this->characteristicStepCountAverage;
+#endif
+#endif
+    case OswBLELiveData::Channel::LIVE_STATUS:
+        return this->characteristicLiveStatus;
+    default:
+        return nullptr;
     }
 }
 
+void OswServiceTaskBLEServer::updateLiveData() {
+    const unsigned long now = millis();
+    OswBLELiveData::Values values;
+    const bool sample = !this->hasSample or now - this->lastSample >= liveDataSampleInterval;
+    if(sample)
+        values = sampleLiveData(); // outside of the lock, so reads do not wait for the HAL
+    struct Notification {
+        NimBLECharacteristic* characteristic;
+        uint8_t data[OswBLELiveData::maxPayload];
+        size_t length;
+    };
+    Notification notifications[(size_t) OswBLELiveData::Channel::COUNT];
+    size_t count = 0;
+    {
+        std::lock_guard<std::mutex> guard(this->liveDataLock);
+        if(sample) {
+            this->liveData.update(values);
+            this->lastSample = now;
+            this->hasSample = true;
+        }
+        for(size_t i = 0; i < (size_t) OswBLELiveData::Channel::COUNT; i++) {
+            NimBLECharacteristic* characteristic = this->getCharacteristic((OswBLELiveData::Channel) i);
+            this->liveData.setSubscribed((OswBLELiveData::Channel) i, characteristic != nullptr and characteristic->getSubscribedCount() > 0);
+        }
+        this->liveData.flush(now, [&](OswBLELiveData::Channel channel, const uint8_t* data, size_t length) {
+            Notification& notification = notifications[count++];
+            notification.characteristic = this->getCharacteristic(channel);
+            memcpy(notification.data, data, length);
+            notification.length = length;
+        });
+    }
+    // The notifications go out without the lock, as NimBLE may call our onRead() in the meantime
+    for(size_t i = 0; i < count; i++) {
+        notifications[i].characteristic->setValue(notifications[i].data, notifications[i].length);
+        notifications[i].characteristic->notify();
+    }
+}
+
+bool OswServiceTaskBLEServer::updateBulkTransfer() {
+    std::lock_guard<std::mutex> guard(this->bulkLock);
+    if(!this->bulk.isActive())
+        return false;
+    this->bulk.loop(millis());
+    {
+        std::lock_guard<std::mutex> liveDataGuard(this->liveDataLock);
+        this->liveData.noteSyncActivity(millis()); // keeps the fast connection
+    }
+    return this->bulk.isActive();
+}
+
+void OswServiceTaskBLEServer::updateConnectionParameters() {
+    OswBLELiveData::Workload workload;
+    {
+        std::lock_guard<std::mutex> guard(this->liveDataLock);
+        workload = this->liveData.getWorkload(millis());
+    }
+    const bool connectionsChanged = this->connectionsChanged.exchange(false);
+    if(workload == this->workload and !connectionsChanged)
+        return;
+    this->workload = workload;
+    const OswBLELiveData::ConnectionParameters parameters = OswBLELiveData::getConnectionParameters(workload);
+    for(uint16_t connection : this->server->getPeerDevices())
+        this->server->updateConnParams(connection, parameters.minInterval, parameters.maxInterval, parameters.latency, parameters.timeout);
+}
+
 void OswServiceTaskBLEServer::updateName() {
     memset(this->name, 0, 8); // clear the name buffer
     strncpy(this->name, OswConfigAllKeys::hostname.get().c_str(), 8);
@@ -236,11 +407,22 @@ void OswServiceTaskBLEServer::ServerCallbacks::onConnect(BLEServer* pServer) {
     task->notify.showToast("BLE connected");
 }
 
+void OswServiceTaskBLEServer::ServerCallbacks::onConnect(BLEServer* pServer, ble_gap_conn_desc* desc) {
+    task->connectionsChanged = true;
+    task->wakeUp();
+}
+
 void OswServiceTaskBLEServer::ServerCallbacks::onDisconnect(BLEServer* pServer) {
     OSW_LOG_D("A client has disconnected (", pServer->getConnectedCount(), ")!");
     task->notify.showToast("BLE disconnected");
 }
 
+void OswServiceTaskBLEServer::ServerCallbacks::onDisconnect(BLEServer* pServer, ble_gap_conn_desc* desc) {
+    std::lock_guard<std::mutex> guard(task->bulkLock);
+    if(task->bulk.isActive() and desc->conn_handle == task->bulkConnection)
+        task->bulk.cancel(); // the phone resumes it with the next OPEN
+}
+
 uint32_t OswServiceTaskBLEServer::ServerCallbacks::onPassKeyRequest() {
     // roll a new passkey
     long passKey = random(100000, 999999);
@@ -250,53 +432,18 @@ uint32_t OswServiceTaskBLEServer::ServerCallbacks::onPassKeyRequest() {
     return passKey;
 }
 
-void OswServiceTaskBLEServer::BatteryLevelCharacteristicCallbacks::onRead(NimBLECharacteristic* pCharacteristic) {
-    // get the current battery level into the inner byte buffer
-    if(OswHal::getInstance()->isCharging()) {
-        byte = 0xFF; // invalid value
-    } else {
-        this->byte = OswHal::getInstance()->getBatteryPercent();
-    }
-    pCharacteristic->setValue(&this->byte, sizeof(this->byte));
-}
-
-void OswServiceTaskBLEServer::BatteryLevelStatusCharacteristicCallbacks::onRead(NimBLECharacteristic* pCharacteristic) {
-    // see https://www.bluetooth.com/specifications/specs/battery-service/
-    // see https://www.bluetooth.com/specifications/specs/gatt-specification-supplement-8-2/
-    bool isCharging = OswHal::getInstance()->isCharging();
-    // flags
-    if(isCharging) {
-        this->bytes[0] = 0b00000000; // No additional information
-    } else {
-        this->bytes[0] = 0b00000010; // Battery Level Present
-    }
-    // power-state
-    this->bytes[1] = 0b00000001; // Battery Present: Yes
-    this->bytes[2] = 0b00000000;
-    if(isCharging) {
-        this->bytes[1] |= 0b00000010; // Wired External Power Source Connected: Yes
-        this->bytes[1] |= 0b00100000; // Battery Charge State: Charging
-    } else {
-        this->bytes[1] |= 0b01000000; // Battery Charge State: Discharging: Active
-        if(OswHal::getInstance()->getBatteryPercent() > 50) {
-            this->bytes[1] |= 0b10000000; // Battery Charge Level: Good
-        } else if(OswHal::getInstance()->getBatteryPercent() > 25) {
-            // Battery Charge Level: Low
-            this->bytes[1] |= 0b00000000;
-            this->bytes[2] |= 0b00000001;
-        } else {
-            // Battery Charge Level: Critical
-            this->bytes[1] |= 0b10000000;
-            this->bytes[2] |= 0b00000001;
-        }
+void OswServiceTaskBLEServer::LiveDataCharacteristicCallbacks::onRead(NimBLECharacteristic* pCharacteristic) {
+    uint8_t bytes[OswBLELiveData::maxPayload];
+    size_t length;
+    {
+        std::lock_guard<std::mutex> guard(task->liveDataLock);
+        length = task->liveData.get(this->channel, bytes);
     }
-    // battery-level
-    if(isCharging) {
-        this->bytes[3] = 0xFF; // invalid value (should not be sent if charging)
-    } else {
-        this->bytes[3] = OswHal::getInstance()->getBatteryPercent();
-    }
-    pCharacteristic->setValue(this->bytes, isCharging ? (sizeof(this->bytes) - 1) : sizeof(this->bytes));
+    pCharacteristic->setValue(bytes, length);
+}
+
+void OswServiceTaskBLEServer::LiveDataCharacteristicCallbacks::onSubscribe(NimBLECharacteristic* pCharacteristic, ble_gap_conn_desc* desc, uint16_t subValue) {
+    task->wakeUp(); // the next loop() picks the subscription up and notifies the current value
 }
 
 void OswServiceTaskBLEServer::CurrentTimeCharacteristicCallbacks::onRead(NimBLECharacteristic* pCharacteristic) {
@@ -328,51 +475,14 @@ void OswServiceTaskBLEServer::HardwareRevisionCharacteristicCallbacks::onRead(Ni
     pCharacteristic->setValue((uint8_t*) this->value.c_str(), this->value.length());
 }
 #if OSW_PLATFORM_ENVIRONMENT_ACCELEROMETER == 1
-void OswServiceTaskBLEServer::StepsTodayCharacteristicCallbacks::onRead(NimBLECharacteristic* pCharacteristic) {
-    uint32_t stepsToday = OswHal::getInstance()->environment()->getStepsToday();
-
-    this->bytes[0] = (uint8_t) stepsToday;
-    this->bytes[1] = (uint8_t) (stepsToday >> 8);
-    this->bytes[2] = (uint8_t) (stepsToday >> 16);
-    this->bytes[3] = (uint8_t) (stepsToday >> 24);
-
-    pCharacteristic->setValue(this->bytes, sizeof(this->bytes));
-}
-
-void OswServiceTaskBLEServer::StepsTotalCharacteristicCallbacks::onRead(NimBLECharacteristic* pCharacteristic) {
-    uint32_t stepsTotal = OswHal::getInstance()->environment()->getStepsTotal();
-
-    this->bytes[0] = (uint8_t) stepsTotal;
-    this->bytes[1] = (uint8_t) (stepsTotal >> 8);
-    this->bytes[2] = (uint8_t) (stepsTotal >> 16);
-    this->bytes[3] = (uint8_t) (stepsTotal >> 24);
-
-    pCharacteristic->setValue(this->bytes, sizeof(this->bytes));
-}
-
-void OswServiceTaskBLEServer::StepsTotalWeekCharacteristicCallbacks::onRead(NimBLECharacteristic* pCharacteristic) {
-    uint32_t stepsTotalWeek = OswHal::getInstance()->environment()->getStepsTotalWeek();
-
-    this->bytes[0] = (uint8_t) stepsTotalWeek;
-    this->bytes[1] = (uint8_t) (stepsTotalWeek >> 8);
-    this->bytes[2] = (uint8_t) (stepsTotalWeek >> 16);
-    this->bytes[3] = (uint8_t) (stepsTotalWeek >> 24);
-
-    pCharacteristic->setValue(this->bytes, sizeof(this->bytes));
-}
 #ifdef OSW_FEATURE_STATS_STEPS
-void OswServiceTaskBLEServer::StepsAverageCharacteristicCallbacks::onRead(NimBLECharacteristic* pCharacteristic) {
-    uint32_t stepsAverage = OswHal::getInstance()->environment()->getStepsAverage();
-
-    this->bytes[0] = (uint8_t) stepsAverage;
-    this->bytes[1] = (uint8_t) (stepsAverage >> 8);
-    this->bytes[2] = (uint8_t) (stepsAverage >> 16);
-    this->bytes[3] = (uint8_t) (stepsAverage >> 24);
-
-    pCharacteristic->setValue(this->bytes, sizeof(this->bytes));
-}
-
 void OswServiceTaskBLEServer::StepsDayHistoryCharacteristicCallbacks::onRead(NimBLECharacteristic* pCharacteristic) {
+    {
+        std::lock_guard<std::mutex> guard(task->liveDataLock);
+        task->liveData.noteSyncActivity(millis()); // the phone syncs the history
+    }
+    task->connectionsChanged = true;
+    task->wakeUp();
 
     for (uint8_t indexOfWeek = 0; indexOfWeek < 7; indexOfWeek++) {
         uint32_t value = OswHal::getInstance()->environment()->getStepsOnDay(indexOfWeek, false);
@@ -391,6 +501,47 @@ void OswServiceTaskBLEServer::SoftwareRevisionCharacteristicCallbacks::onRead(Ni
     pCharacteristic->setValue((uint8_t*) this->value.c_str(), this->value.length());
 }
 
+void OswServiceTaskBLEServer::BulkControlCharacteristicCallbacks::onWrite(NimBLECharacteristic* pCharacteristic, ble_gap_conn_desc* desc) {
+    const std::string value = pCharacteristic->getValue();
+    {
+        std::lock_guard<std::mutex> guard(task->bulkLock);
+        task->bulkConnection = desc->conn_handle;
+        task->bulk.onControl((const uint8_t*) value.data(), value.length(), millis());
+    }
+    {
+        std::lock_guard<std::mutex> guard(task->liveDataLock);
+        task->liveData.noteSyncActivity(millis());
+    }
+    task->connectionsChanged = true; // switch to the fast connection parameters right away
+    task->wakeUp();
+}
+
+size_t OswServiceTaskBLEServer::BulkTransport::getMaxNotificationSize() {
+    const uint16_t mtu = task->server->getPeerMTU(task->bulkConnection);
+    return mtu > 23 ? mtu - 3 : 20; // the default MTU, if unknown
+}
+
+bool OswServiceTaskBLEServer::BulkTransport::sendData(const uint8_t* data, size_t length) {
+    return this->notify(task->characteristicBulkData, data, length); // a full stack holds the window until the next loop()
+}
+
+void OswServiceTaskBLEServer::BulkTransport::sendControl(const uint8_t* data, size_t length) {
+    task->characteristicBulkControl->setValue(data, length);
+    if(!this->notify(task->characteristicBulkControl, data, length))
+        OSW_LOG_W("Bulk control notification dropped."); // the phone asks again after its timeout
+}
+
+/**
+ * Only to the connection of the transfer - NimBLECharacteristic::notify() would send it to every subscriber (and
+ * hide whether the stack took it)
+ */
+bool OswServiceTaskBLEServer::BulkTransport::notify(NimBLECharacteristic* characteristic, const uint8_t* data, size_t length) {
+    os_mbuf* buffer = ble_hs_mbuf_from_flat(data, length);
+    if(buffer == nullptr)
+        return false; // out of buffers
+    return ble_gattc_notify_custom(task->bulkConnection, characteristic->getHandle(), buffer) == 0; // consumes the buffer
+}
+
 void OswServiceTaskBLEServer::ToastCharacteristicCallbacks::onWrite(NimBLECharacteristic* pCharacteristic) {
     std::string value = pCharacteristic->getValue();
     OSW_LOG_I("BLE Toast: ", value);
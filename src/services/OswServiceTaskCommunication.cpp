@@ -0,0 +1,381 @@
+#ifdef OSW_SERVICE_COMMUNICATION
+#include "./services/OswServiceTaskCommunication.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+#include <OswLogger.h>
+
+#include "osw_config_keys.h"
+#include "osw_hal.h"
+
+#ifdef OSW_EMULATOR
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // macOS
+#endif
+#else
+#ifndef OSW_FEATURE_WIFI
+#error The communication service needs OSW_FEATURE_WIFI
+#endif
+#include <HTTPClient.h>
+#include <WiFi.h>
+
+#include "services/OswServiceTasks.h"
+#include "services/OswServiceTaskWiFi.h"
+#endif
+
+// Both survive the deep sleep, so nothing queued before is lost
+RTC_DATA_ATTR static OswCommunication::Storage communicationQueue;
+RTC_DATA_ATTR static time_t communicationSavedAt; // UTC of the last loop(), to age the queue by the time asleep
+
+static constexpr unsigned long maxSleep = 1000; // ms, a WiFi brought up by someone else is used along within that
+
+/**
+ * What the answer of the server means for the batch
+ */
+static OswCommunication::Transport::Result toResult(int status) {
+    if(status >= 200 and status < 300)
+        return OswCommunication::Transport::Result::OK;
+    if(status >= 400 and status < 500 and status != 408 and status != 429)
+        return OswCommunication::Transport::Result::REJECTED;
+    return OswCommunication::Transport::Result::RETRY; // No answer, timeouts and the server's own problems
+}
+
+void OswServiceTaskCommunication::HttpTransport::setUrl(const String& url) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->url = url;
+}
+
+void OswServiceTaskCommunication::HttpTransport::setDeviceId(const String& deviceId) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->deviceId = deviceId;
+}
+
+bool OswServiceTaskCommunication::HttpTransport::hasUrl() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->url.length() > 0;
+}
+
+#ifdef OSW_EMULATOR
+void OswServiceTaskCommunication::HttpTransport::bringUp() {
+    this->owned = true; // There is no radio to wait for
+}
+
+void OswServiceTaskCommunication::HttpTransport::bringDown() {
+    this->owned = false;
+}
+
+bool OswServiceTaskCommunication::HttpTransport::isUp() {
+    return this->owned;
+}
+
+OswCommunication::Transport::Result OswServiceTaskCommunication::HttpTransport::send(const uint8_t* data, size_t length, bool compressed) {
+    std::string url;
+    std::string deviceId;
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        url = this->url.c_str();
+        deviceId = this->deviceId.c_str();
+    }
+    // Only plain http://host[:port][/path] - it is meant for a local server
+    if(url.rfind("http://", 0) != 0) {
+        OSW_LOG_E("Unsupported server URL: ", url);
+        return Result::RETRY;
+    }
+    const size_t hostStart = strlen("http://");
+    const size_t pathStart = std::min(url.find('/', hostStart), url.size());
+    std::string host = url.substr(hostStart, pathStart - hostStart);
+    std::string port = "80";
+    const std::string path = pathStart < url.size() ? url.substr(pathStart) : "/";
+    if(host.find(':') != std::string::npos) {
+        port = host.substr(host.find(':') + 1);
+        host = host.substr(0, host.find(':'));
+    }
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if(getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0)
+        return Result::RETRY;
+    int fd = -1;
+    for(addrinfo* address = addresses; address != nullptr and fd < 0; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if(fd < 0)
+            continue;
+        timeval timeout = {(time_t) (sendTimeout / 1000), (suseconds_t) (sendTimeout % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        if(connect(fd, address->ai_addr, address->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    if(fd < 0)
+        return Result::RETRY;
+
+    std::string request = "POST " + path + " HTTP/1.1\r\nHost: " + host + ":" + port + "\r\nContent-Type: application/json\r\nDevice-ID: " + deviceId +
+                          "\r\n" + (compressed ? "Content-Encoding: gzip\r\n" : "") + "Content-Length: " + std::to_string(length) + "\r\nConnection: close\r\n\r\n";
+    request.append((const char*) data, length);
+    bool written = true;
+    for(size_t sent = 0; written and sent < request.size();) {
+        const ssize_t count = ::send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        written = count > 0;
+        sent += written ? (size_t) count : 0;
+    }
+    // Only the status line is of interest, the rest is read to let the server finish
+    char answer[32] = {};
+    size_t received = 0;
+    char rest[256];
+    while(written) {
+        const ssize_t count = received < sizeof(answer) - 1 ? recv(fd, answer + received, sizeof(answer) - 1 - received, 0) : recv(fd, rest, sizeof(rest), 0);
+        if(count <= 0)
+            break;
+        if(received < sizeof(answer) - 1)
+            received += (size_t) count;
+    }
+    close(fd);
+    int status = 0;
+    if(sscanf(answer, "HTTP/%*d.%*d %d", &status) != 1)
+        return Result::RETRY;
+    return toResult(status);
+}
+#else
+void OswServiceTaskCommunication::HttpTransport::bringUp() {
+    // Someone else using the WiFi (e.g. for the webserver) is left alone - if it does not connect, the queue waits
+    if(OswServiceAllTasks::wifi.isEnabled())
+        return;
+    this->owned = true;
+    OswServiceAllTasks::wifi.enableWiFi();
+    OswServiceAllTasks::wifi.connectWiFi();
+}
+
+void OswServiceTaskCommunication::HttpTransport::bringDown() {
+    if(!this->owned)
+        return;
+    this->owned = false;
+    OswServiceAllTasks::wifi.disconnectWiFi();
+    OswServiceAllTasks::wifi.disableWiFi();
+}
+
+bool OswServiceTaskCommunication::HttpTransport::isUp() {
+    return OswServiceAllTasks::wifi.isWiFiEnabled() and WiFi.status() == WL_CONNECTED;
+}
+
+OswCommunication::Transport::Result OswServiceTaskCommunication::HttpTransport::send(const uint8_t* data, size_t length, bool compressed) {
+    String url;
+    String deviceId;
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        url = this->url;
+        deviceId = this->deviceId;
+    }
+    HTTPClient http;
+    http.setConnectTimeout(sendTimeout);
+    http.setTimeout(sendTimeout);
+    if(!http.begin(url)) {
+        OSW_LOG_E("Unsupported server URL: ", url);
+        return Result::RETRY;
+    }
+    http.addHeader("Content-Type", "application/json");
+    http.addHeader("Device-ID", deviceId);
+    if(compressed)
+        http.addHeader("Content-Encoding", "gzip");
+    const int status = http.POST((uint8_t*) data, length);
+    http.end();
+    if(status <= 0)
+        OSW_LOG_W("Sending to the server failed: ", HTTPClient::errorToString(status));
+    return toResult(status);
+}
+#endif
+
+OswServiceTaskCommunication::OswServiceTaskCommunication() : communication(communicationQueue) {
+    this->communication.addTransport(this->http);
+}
+
+OswServiceTaskCommunication::~OswServiceTaskCommunication() {
+    this->stopSender();
+}
+
+void OswServiceTaskCommunication::setup() {
+    OswServiceTask::setup();
+    this->http.setUrl(OswConfigAllKeys::communicationServerUrl.get());
+#if defined(OSW_FEATURE_WIFI) || defined(OSW_FEATURE_BLE_SERVER)
+    this->setDeviceId(OswConfigAllKeys::hostname.get());
+#else
+    this->setDeviceId(DEVICE_NAME);
+#endif
+    const time_t now = OswHal::getInstance()->getUTCTime();
+    if(!this->clockRestored and communicationSavedAt > 0 and now > communicationSavedAt)
+        this->communication.advanceClock((unsigned long) (now - communicationSavedAt) * 1000);
+    this->clockRestored = true;
+    this->startSender();
+}
+
+void OswServiceTaskCommunication::loop() {
+    // Only the heartbeat is left for the worker, the queue is up to the sender
+    if(this->heartbeatInterval == 0) {
+        this->sleepUntilWoken();
+        return;
+    }
+    const unsigned long now = millis();
+    if(now - this->lastHeartbeat >= this->heartbeatInterval) {
+        this->lastHeartbeat = now;
+        const String heartbeat = String("{\"uptime\":") + String(now) + ",\"battery\":" + String((int) OswHal::getInstance()->getBatteryPercent()) + "}";
+        this->communication.enqueue(MessageType::SYSTEM_STATUS, Priority::BACKGROUND, heartbeat.c_str(), heartbeat.length(),
+                                    (uint32_t) OswHal::getInstance()->getUTCTime(), now);
+        this->kickSender();
+    }
+    this->sleepUntil(this->lastHeartbeat + this->heartbeatInterval);
+}
+
+void OswServiceTaskCommunication::stop() {
+    // The queue stays, it is sent after the next start
+    this->stopSender();
+    this->http.bringDown();
+    OswServiceTask::stop();
+}
+
+void OswServiceTaskCommunication::startSender() {
+    std::lock_guard<std::mutex> guard(this->senderLock);
+    this->senderStopping = false;
+#ifndef OSW_EMULATOR
+    if(this->sender != nullptr)
+        return;
+    this->senderStopped = false;
+    if(xTaskCreatePinnedToCore([](void* pvParameters) -> void { ((OswServiceTaskCommunication*) pvParameters)->work(); },
+                               "oswCommunication", this->senderStackSize /*stack*/, this /*input*/, 1 /*prio*/, &this->sender /*handle*/,
+                               0) != pdPASS) {
+        this->sender = nullptr;
+        OSW_LOG_E("Failed to start the communication sender task!");
+    }
+#else
+    if(this->sender)
+        return;
+    this->sender.reset(new std::jthread([this]() -> void { this->work(); }));
+#endif
+}
+
+void OswServiceTaskCommunication::stopSender() {
+    {
+        std::lock_guard<std::mutex> guard(this->senderLock);
+        this->senderStopping = true;
+    }
+    this->senderWoken.notify_all();
+    // A batch on its way is finished first - at most the timeout of the transport
+#ifndef OSW_EMULATOR
+    std::unique_lock<std::mutex> guard(this->senderLock);
+    if(this->sender == nullptr)
+        return;
+    this->senderWoken.wait(guard, [this]() {
+        return this->senderStopped;
+    });
+    this->sender = nullptr;
+#else
+    this->sender.reset(); // Joins the thread
+#endif
+}
+
+void OswServiceTaskCommunication::kickSender() {
+    {
+        std::lock_guard<std::mutex> guard(this->senderLock);
+        this->senderKicked = true;
+    }
+    this->senderWoken.notify_all();
+}
+
+void OswServiceTaskCommunication::work() {
+    std::unique_lock<std::mutex> guard(this->senderLock);
+    while(!this->senderStopping) {
+        this->senderKicked = false;
+        guard.unlock();
+        unsigned long idle = maxSleep;
+        if(this->http.hasUrl()) {
+            this->communication.loop(millis());
+            idle = std::min(this->communication.getIdleTime(millis()), maxSleep);
+        }
+        communicationSavedAt = OswHal::getInstance()->getUTCTime();
+        guard.lock();
+        this->senderWoken.wait_for(guard, std::chrono::milliseconds(idle), [this]() {
+            return this->senderKicked or this->senderStopping;
+        });
+    }
+#ifndef OSW_EMULATOR
+    this->senderStopped = true;
+    this->senderWoken.notify_all(); // Still locked, so stopSender() can not return before this does
+    guard.unlock();
+    vTaskDelete(nullptr); // Inform FreeRTOS this task is done - otherwise the kernel will take that personally and crash!
+#endif
+}
+
+void OswServiceTaskCommunication::setServerUrl(const String& url) {
+    this->http.setUrl(url);
+}
+
+void OswServiceTaskCommunication::setDeviceId(const String& deviceId) {
+    this->http.setDeviceId(deviceId);
+    this->communication.setDeviceId(deviceId.c_str());
+}
+
+void OswServiceTaskCommunication::setPolicy(const OswCommunication::Policy& policy) {
+    this->communication.setPolicy(policy);
+}
+
+void OswServiceTaskCommunication::setHeartbeatInterval(unsigned long interval) {
+    this->heartbeatInterval = interval;
+    this->wakeUp();
+}
+
+bool OswServiceTaskCommunication::send(MessageType type, const String& json, Priority priority) {
+    const bool queued = this->communication.enqueue(type, priority, json.c_str(), json.length(), (uint32_t) OswHal::getInstance()->getUTCTime(), millis());
+    if(!queued)
+        OSW_LOG_W("Message of ", json.length(), " bytes not queued");
+    this->kickSender(); // It may make the queue worth sending
+    return queued;
+}
+
+bool OswServiceTaskCommunication::send(MessageType type, const JsonDocument& data, Priority priority) {
+    if(measureJson(data) > OswCommunication::maxPayloadSize) {
+        OSW_LOG_W("Message too large for the queue");
+        return false;
+    }
+    String json;
+    serializeJson(data, json);
+    return this->send(type, json, priority);
+}
+
+bool OswServiceTaskCommunication::sendCommand(const String& command, const JsonDocument& params) {
+    StaticJsonDocument<JSON_OBJECT_SIZE(1)> name;
+    name.set(command.c_str());
+    String json = "{\"command\":";
+    serializeJson(name, json); // Escaped as needed
+    json += ",\"params\":";
+    serializeJson(params, json);
+    json += "}";
+    return this->send(MessageType::COMMAND, json);
+}
+
+void OswServiceTaskCommunication::processQueue() {
+    this->communication.flush();
+    this->kickSender();
+}
+
+size_t OswServiceTaskCommunication::getQueueSize() {
+    return this->communication.getQueueSize();
+}
+
+bool OswServiceTaskCommunication::isServerReachable() {
+    return this->communication.getStats().batches > 0 and this->communication.getConsecutiveFailures() == 0;
+}
+
+OswCommunication::Stats OswServiceTaskCommunication::getStats() {
+    return this->communication.getStats();
+}
+#endif
@@ -1,6 +1,7 @@
 #include <OswSerial.h>
 #include "./services/OswServiceTaskConsole.h"
 #include "osw_hal.h"
+#include "OswMemoryTracker.h"
 #include <services/OswServiceTasks.h>
 #include <services/OswServiceTaskBLEServer.h>
 #include <services/NotifierClient.h>
@@ -110,6 +111,8 @@ void OswServiceTaskConsole::runPrompt() {
 #endif
         } else if (this->m_inputBuffer == "lock") {
             this->m_locked = true;
+        } else if (this->m_inputBuffer == "memory") {
+            serial->print(OswMemoryTracker::getInstance().describe());
 #ifndef OSW_EMULATOR
         } else if (this->m_inputBuffer == "reboot") {
             // this does not work in the emulator as it is running under an own thread, of which the shutdown-exception is not captured - populating here and crashing
@@ -229,6 +232,7 @@ void OswServiceTaskConsole::showHelp() {
         serial->println("  hostname    - show the device hostname");
 #endif
         serial->println("  lock        - lock the console");
+        serial->println("  memory      - show the heap usage per subsystem");
 #ifndef OSW_EMULATOR
         serial->println("  reboot      - warm-start the device forcefully");
 #endif
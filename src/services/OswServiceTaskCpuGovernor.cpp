@@ -0,0 +1,129 @@
+#include "./services/OswServiceTaskCpuGovernor.h"
+
+#include <algorithm>
+
+#include "osw_hal.h"
+#include "osw_ui.h"
+#include "services/OswServiceManager.h"
+#include "services/OswServiceTasks.h"
+#ifdef OSW_FEATURE_WIFI
+#include "services/OswServiceTaskWiFi.h"
+#endif
+#ifdef OSW_FEATURE_BLE_SERVER
+#include "services/OswServiceTaskBLEServer.h"
+#endif
+#if SERVICE_BLE_COMPANION == 1
+#include "services/OswServiceTaskBLECompanion.h"
+#endif
+
+void OswServiceTaskCpuGovernor::setup() {
+    OswServiceTask::setup();
+    this->resetSampling();
+}
+
+void OswServiceTaskCpuGovernor::loop() {
+    const unsigned long now = millis();
+    if(now - this->lastSample >= this->sampleInterval)
+        this->update(this->measure(now), now);
+    this->sleepUntil(this->lastSample + this->sampleInterval);
+}
+
+/**
+ * The time asleep would look like an idle system, so the sampling starts over
+ */
+void OswServiceTaskCpuGovernor::resume() {
+    OswServiceTask::resume();
+    this->resetSampling();
+    this->lowerPending = false;
+}
+
+void OswServiceTaskCpuGovernor::resetSampling() {
+    this->lastSample = millis();
+    this->lastRenderTime = OswUI::getInstance()->getRenderTime();
+    this->lastBusyTime = OswServiceManager::getInstance().getBusyTime();
+}
+
+OswServiceTaskCpuGovernor::Sample OswServiceTaskCpuGovernor::measure(unsigned long now) {
+    Sample sample;
+    const unsigned long renderTime = OswUI::getInstance()->getRenderTime();
+    const unsigned long busyTime = OswServiceManager::getInstance().getBusyTime();
+    const float elapsed = (now - this->lastSample) * 1000.0f; // us
+    if(elapsed > 0) {
+        sample.uiLoad = std::min(1.0f, (renderTime - this->lastRenderTime) / elapsed);
+        sample.serviceLoad = std::min(1.0f, (busyTime - this->lastBusyTime) / elapsed);
+    }
+    this->lastSample = now;
+    this->lastRenderTime = renderTime;
+    this->lastBusyTime = busyTime;
+
+#ifdef OSW_FEATURE_WIFI
+    sample.radioActive = OswServiceAllTasks::wifi.isEnabled();
+#if OSW_DEVICE_ESP32_WIFI_LOWPWR == 1
+    sample.radioLowPower = sample.radioActive;
+#endif
+#endif
+#ifdef OSW_FEATURE_BLE_SERVER
+    sample.radioActive = sample.radioActive or OswServiceAllTasks::bleServer.isEnabled();
+#endif
+#if SERVICE_BLE_COMPANION == 1
+    sample.radioActive = sample.radioActive or OswServiceAllTasks::bleCompanion.isRunning();
+#endif
+
+    sample.viewFlags = OswUI::getInstance()->getAppViewFlags();
+    sample.appFrequency = OswUI::getInstance()->getAppCpuFrequency();
+    return sample;
+}
+
+/**
+ * The lowest known clock at which the load (measured at the current clock) would stay below the threshold
+ */
+uint8_t OswServiceTaskCpuGovernor::fitting(float load, float threshold) {
+    for(uint8_t mhz : frequencies)
+        if(load * this->frequency / mhz <= threshold)
+            return mhz;
+    return frequencies.back();
+}
+
+uint8_t OswServiceTaskCpuGovernor::update(const Sample& sample, unsigned long now) {
+    // Always start from the real clock, someone else (e.g. the WiFi) may have changed it
+    this->frequency = OswHal::getInstance()->getCPUClock();
+    if(this->frequency == 0)
+        this->frequency = frequencies.back(); // Not known on this platform, assume the fastest one
+
+    uint8_t target = this->frequency;
+    if(sample.radioLowPower) {
+        target = frequencies.front();
+        this->lowerPending = false;
+    } else if(sample.appFrequency != 0) {
+        target = sample.appFrequency;
+        this->lowerPending = false;
+    } else {
+        // Apps without FPS limit render as often as they can, so their UI load tells nothing about what they need
+        const bool unlimited = sample.viewFlags & OswAppV2::ViewFlags::NO_FPS_LIMIT;
+        const float load = std::max(unlimited ? 0.0f : sample.uiLoad, sample.serviceLoad);
+        const uint8_t minimum = (sample.radioActive or unlimited) ? this->busyFrequency : frequencies.front();
+        if(load > this->upThreshold or this->frequency < minimum) {
+            target = std::max(this->fitting(load, this->upThreshold), minimum);
+            this->lowerPending = false;
+        } else {
+            const uint8_t lower = std::max(this->fitting(load, this->downThreshold), minimum);
+            if(lower < this->frequency) {
+                if(!this->lowerPending) {
+                    this->lowerPending = true;
+                    this->lowerSince = now;
+                }
+                if(now - this->lowerSince >= this->downDelay)
+                    target = lower;
+            } else
+                this->lowerPending = false;
+        }
+    }
+
+    if(target != this->frequency) {
+        OSW_LOG_D("CPU clock ", this->frequency, " -> ", target, " MHz (UI load ", sample.uiLoad, ", service load ", sample.serviceLoad, ")");
+        OswHal::getInstance()->setCPUClock(target);
+        this->frequency = target;
+        this->lowerPending = false;
+    }
+    return this->frequency;
+}
@@ -24,3 +24,15 @@ void OswServiceTaskGPS::stop() {
     OswHal::getInstance()->gpsBackupMode();
 #endif
 }
+
+void OswServiceTaskGPS::suspend() {
+#if defined(GPS_EDITION) || defined(GPS_EDITION_ROTATED)
+    OswHal::getInstance()->gpsBackupMode();
+#endif
+}
+
+void OswServiceTaskGPS::resume() {
+#if defined(GPS_EDITION) || defined(GPS_EDITION_ROTATED)
+    OswHal::getInstance()->setupGps();
+#endif
+}
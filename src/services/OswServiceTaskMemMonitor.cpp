@@ -2,6 +2,7 @@
 #include "./services/OswServiceTaskMemMonitor.h"
 
 #include "osw_hal.h"
+#include "OswMemoryTracker.h"
 #include "osw_ui.h"
 #include "services/OswServiceManager.h"
 #include "services/OswServiceTasks.h"
@@ -16,9 +17,15 @@ void OswServiceTaskMemMonitor::setup() {
 
 /**
  * Updates the current high water mark for the core on which this service is running on (core 0),
- * updates the high watermark for the heap and calls printStats() on changes
+ * updates the high watermark for the heap and calls printStats() on changes - and samples the heap for the history of the
+ * OswMemoryTracker
  */
 void OswServiceTaskMemMonitor::loop() {
+    if(millis() - this->lastHeapSample >= heapSampleInterval) {
+        this->lastHeapSample = millis();
+        OswMemoryTracker::getInstance().sampleHeap();
+    }
+
     unsigned core0 = uxTaskGetStackHighWaterMark(nullptr);
     unsigned high = xPortGetMinimumEverFreeHeapSize();
     if (core0 != this->core0high or this->heapHigh != high) {
@@ -50,18 +57,40 @@ void OswServiceTaskMemMonitor::loop() {
     if(this->lowMemoryCondition != nowLowMemoryCondition) {
         OswUI* ui = OswUI::getInstance();
         std::lock_guard<std::mutex> noRender(*ui->drawLock);
+        this->beforeBufferSwitch = getHeapState();
         if(nowLowMemoryCondition) {
-            OswHal::getInstance()->disableDisplayBuffer();
-            OSW_LOG_I("Disabled display buffering.");
+            OswHal::getInstance()->enableDisplayStripBuffer();
+            OSW_LOG_I("Switched display buffering to strips.");
         } else {
             OswHal::getInstance()->enableDisplayBuffer();
             OSW_LOG_I("Enabled display buffering.");
         }
+        this->afterBufferSwitch = getHeapState();
+        this->printStats();
     }
 
     this->lowMemoryCondition = nowLowMemoryCondition;
 }
 
+OswServiceTaskMemMonitor::HeapState OswServiceTaskMemMonitor::getHeapState() {
+    HeapState state;
+    state.free = ESP.getFreeHeap();
+    state.largestBlock = ESP.getMaxAllocHeap();
+    return state;
+}
+
+/**
+ * Appends the largest free block and the resulting fragmentation (the share of the free heap not in that block)
+ */
+void OswServiceTaskMemMonitor::addHeapState(String& msg, const HeapState& state) {
+    msg += state.largestBlock;
+    msg += "B largest block of ";
+    msg += state.free;
+    msg += "B free (";
+    msg += state.free > 0 ? 100 - (uint32_t) ((uint64_t) state.largestBlock * 100 / state.free) : 0;
+    msg += "% fragmented)\n";
+}
+
 bool OswServiceTaskMemMonitor::hasLowMemoryCondition() {
     return this->lowMemoryCondition;
 }
@@ -121,7 +150,28 @@ void OswServiceTaskMemMonitor::printStats() {
     msg += "B\n";
 #endif
 
-    // TODO Maybe fetch current largest available heap size and calc "fragmentation" percentage.
+    // The largest block shrinks as the free heap gets fragmented (e.g. by freeing and reallocating the display buffer)
+    msg += "heap (frag):\t";
+    addHeapState(msg, getHeapState());
+
+    msg += "framebuffer:\t";
+    msg += OswHal::getInstance()->getCanvas()->getFrameMemorySize();
+    msg += "B";
+    if(OswHal::getInstance()->getCanvas()->isDoubleBuffered())
+        msg += " (double buffered)";
+    msg += "\n";
+
+    if(this->beforeBufferSwitch.free > 0) {
+        msg += "last display buffer switch:\n";
+        msg += "  before:\t";
+        addHeapState(msg, this->beforeBufferSwitch);
+        msg += "  after:\t";
+        addHeapState(msg, this->afterBufferSwitch);
+    }
+
+    msg += "---------- per subsystem ----------\n";
+    msg += OswMemoryTracker::getInstance().describe();
+
     msg.trim();
     OSW_LOG_D(msg);
 }
@@ -1,14 +1,41 @@
 #include "./services/OswServiceTaskNotifier.h"
 
-unsigned Notification::count = 0;
+#include <OswMemoryTracker.h>
 
-NotificationData OswServiceTaskNotifier::createNotification(std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds> timeToFire, std::string publisher,
-        std::string message, std::array<bool, 7> daysOfWeek, bool isPersistent) {
-    const std::lock_guard<std::mutex> lock{mutlimapMutex};
-    auto notification = Notification{std::move(publisher), std::move(message), std::move(daysOfWeek), isPersistent};
-    auto pair = std::make_pair(timeToFire, notification);
-    scheduler.insert(pair);
-    return pair;
+static uint8_t toBitmask(const std::array<bool, 7>& daysOfWeek) {
+    uint8_t mask = 0;
+    for (size_t i = 0; i < daysOfWeek.size(); ++i) {
+        if (daysOfWeek[i]) {
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+}
+
+static std::array<bool, 7> fromBitmask(uint8_t mask) {
+    std::array<bool, 7> daysOfWeek{};
+    for (size_t i = 0; i < daysOfWeek.size(); ++i) {
+        daysOfWeek[i] = mask & (1 << i);
+    }
+    return daysOfWeek;
+}
+
+NotificationData OswServiceTaskNotifier::toNotificationData(Store::Index index) const {
+    const auto& entry = store[index];
+    return {std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds>{std::chrono::seconds{entry.fireTime}},
+            Notification{entry.id, store.getPublisher(index), store.getMessage(index), fromBitmask(entry.daysOfWeek), entry.isPersistent}};
+}
+
+NotificationData OswServiceTaskNotifier::createNotification(std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds> timeToFire, std::string_view publisher,
+        std::string_view message, std::array<bool, 7> daysOfWeek, bool isPersistent) {
+    OswMemoryScope scope(OswMemoryTag::NOTIFICATIONS);
+    const std::lock_guard<std::mutex> lock{storeMutex};
+    auto index = store.add(timeToFire.time_since_epoch().count(), publisher, message, toBitmask(daysOfWeek), isPersistent);
+    if (index == Store::NONE) {
+        OSW_LOG_W("Notification store is full, dropping notification of ", publisher);
+        return {timeToFire, Notification{static_cast<unsigned>(-1), publisher, message, daysOfWeek, isPersistent}};
+    }
+    return toNotificationData(index);
 }
 
 std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds> getTimeToFire(int hours, int minutes) {
@@ -36,11 +63,9 @@ std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds> getTime
     return timeToFire;
 }
 
-NotificationData OswServiceTaskNotifier::createNotification(int hours, int minutes, std::string publisher,
-        std::string message, std::array<bool, 7> daysOfWeek, bool isPersistent) {
-    const std::lock_guard<std::mutex> lock{mutlimapMutex};
+NotificationData OswServiceTaskNotifier::createNotification(int hours, int minutes, std::string_view publisher,
+        std::string_view message, std::array<bool, 7> daysOfWeek, bool isPersistent) {
     std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds> timeToFire{};
-    auto notification = Notification{std::move(publisher), std::move(message), std::move(daysOfWeek), isPersistent};
     if (std::any_of(daysOfWeek.begin(), daysOfWeek.end(), [](auto x) {
     return x;
 })) {
@@ -48,30 +73,37 @@ NotificationData OswServiceTaskNotifier::createNotification(int hours, int minut
     } else {
         timeToFire = getTimeToFire(hours, minutes);
     }
-    auto pair = std::make_pair(timeToFire, notification);
-    scheduler.insert(pair);
-    return pair;
+    return createNotification(timeToFire, publisher, message, daysOfWeek, isPersistent);
 }
 
-std::vector<NotificationData> OswServiceTaskNotifier::readNotifications(const std::string publisher) {
-    const std::lock_guard<std::mutex> lock{mutlimapMutex};
-    std::vector<NotificationData> result{};
-    result.reserve(scheduler.size());
-    for (auto it = scheduler.begin(); it != scheduler.end(); ++it) {
-        if (it->second.getPublisher() == publisher) {
-            result.push_back({it->first, it->second});
+std::vector<NotificationData> OswServiceTaskNotifier::readNotifications(std::string_view publisher) {
+    OswMemoryScope scope(OswMemoryTag::NOTIFICATIONS);
+    const std::lock_guard<std::mutex> lock{storeMutex};
+    // Sort the (few) matching entries by their fire time, as the store itself is not ordered by time
+    std::array<Store::Index, capacity> matches{};
+    size_t count = 0;
+    for (auto i = store.first(); i != Store::NONE; i = store.next(i)) {
+        if (store.getPublisher(i) == publisher) {
+            matches[count++] = i;
         }
     }
+    std::stable_sort(matches.begin(), matches.begin() + count, [this](Store::Index a, Store::Index b) {
+        return store[a].fireTime < store[b].fireTime;
+    });
+
+    std::vector<NotificationData> result{};
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        result.push_back(toNotificationData(matches[i]));
+    }
     return result;
 }
 
-void OswServiceTaskNotifier::deleteNotification(const unsigned id, const std::string publisher) {
-    const std::lock_guard<std::mutex> lock{mutlimapMutex};
-    for (auto it = scheduler.begin(); it != scheduler.end(); ++it) {
-        if (it->second.getId() == id && it->second.getPublisher() == publisher) {
-            scheduler.erase(it);
-            return;
-        }
+void OswServiceTaskNotifier::deleteNotification(const unsigned id, std::string_view publisher) {
+    const std::lock_guard<std::mutex> lock{storeMutex};
+    auto index = store.find(id);
+    if (index != Store::NONE && store.getPublisher(index) == publisher) {
+        store.remove(index);
     }
 }
 
@@ -80,30 +112,31 @@ void OswServiceTaskNotifier::setup() {
 }
 
 void OswServiceTaskNotifier::loop() {
-    const std::lock_guard<std::mutex> lock{mutlimapMutex};
+    OswMemoryScope scope(OswMemoryTag::NOTIFICATIONS);
+    const std::lock_guard<std::mutex> lock{storeMutex};
     auto utcTime = std::chrono::system_clock::from_time_t(OswHal::getInstance()->getUTCTime());
     auto currentTime = utcTime + std::chrono::seconds{static_cast<int>(OswHal::getInstance()->getTimezoneOffsetPrimary())};
-    if (auto it = scheduler.begin();
-            it != scheduler.end() && currentTime >= it->first) {
-        auto timeToFire = it->first;
-        const auto& notification = it->second;
+    if (auto index = store.getDue(std::chrono::time_point_cast<std::chrono::seconds>(currentTime).time_since_epoch().count());
+            index != Store::NONE) {
+        const auto& entry = store[index];
+        std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds> timeToFire{std::chrono::seconds{entry.fireTime}};
 #ifdef OSW_EMULATOR
         OSW_LOG_D("Fired a notification");
         auto t = std::chrono::system_clock::to_time_t(timeToFire);
-        OSW_LOG_D(std::put_time(std::localtime(&t), "%F %T.\n"));
-        OSW_LOG_D(notification.getMessage());
+        OSW_LOG_D(std::put_time(std::localtime(&t), "%F %T.\n"));
+        OSW_LOG_D(store.getMessage(index));
 #endif
-        OswUI::getInstance()->showNotification(std::move(notification.getMessage()), notification.getPersistence());
-        auto daysOfWeek = notification.getDaysOfWeek();
-        if (std::any_of(daysOfWeek.begin(), daysOfWeek.end(), [](auto x) {
-        return x;
-    })) {
+        OswUI::getInstance()->showNotification(store.getMessage(index), entry.isPersistent);
+        if (entry.daysOfWeek) {
+            // Repeating notifications keep their slot (and id), they are just moved to their next occurrence
             date::hh_mm_ss time{floor<std::chrono::seconds>(timeToFire - floor<date::days>(timeToFire))};
-            timeToFire = getTimeToFire(time.hours().count(), time.minutes().count(), daysOfWeek);
-            scheduler.insert({timeToFire, Notification{notification.getPublisher(), notification.getMessage(), notification.getDaysOfWeek()}});
+            timeToFire = getTimeToFire(time.hours().count(), time.minutes().count(), fromBitmask(entry.daysOfWeek));
+            store.reschedule(index, timeToFire.time_since_epoch().count());
+        } else {
+            store.remove(index);
         }
-        scheduler.erase(it);
-    }
+    } else
+        this->sleepFor(250); // Fire times are whole seconds, so there is nothing to do until (about) the next one
 }
 
 void OswServiceTaskNotifier::stop() {
@@ -0,0 +1,243 @@
+#ifdef OSW_FEATURE_WIFI
+#ifdef RAW_SCREEN_SERVER
+#include "services/OswServiceTaskScreenStream.h"
+
+#include <cstring>
+
+#include "osw_hal.h"
+#include <osw_ui.h>
+#include "services/OswServiceTasks.h"
+#include "services/OswServiceTaskWiFi.h"
+
+static inline uint8_t* putU16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+    return out + 2;
+}
+
+static inline uint8_t* putU32(uint8_t* out, uint32_t value) {
+    out = putU16(out, value & 0xFFFF);
+    return putU16(out, value >> 16);
+}
+
+/**
+ * FNV-1a over the pixels of one row - only used to detect changed rows. A collision hides the change of that row until
+ * it changes again, so a key frame is sent every keyFrameInterval regardless.
+ */
+static uint32_t hashRow(const uint16_t* pixels, uint16_t width) {
+    uint32_t hash = 2166136261u;
+    for(uint16_t i = 0; i < width; i++) {
+        hash = (hash ^ (pixels[i] & 0xFF)) * 16777619u;
+        hash = (hash ^ (pixels[i] >> 8)) * 16777619u;
+    }
+    return hash;
+}
+
+void OswServiceTaskScreenStream::setup() {
+    OswServiceTask::setup();
+}
+
+void OswServiceTaskScreenStream::loop() {
+    if(OswServiceAllTasks::wifi.isConnected())
+        this->enableServer();
+    else
+        this->disableServer();
+    if(!this->m_server)
+        return;
+
+    this->acceptClient();
+    if(!this->hasClient())
+        return;
+
+    // The client may request a full frame at any time (e.g. after it dropped some data)
+    while(this->m_client.available()) {
+        if(this->m_client.read() == 'K')
+            this->m_keyFrame = true;
+    }
+    if(millis() - this->m_lastKeyFrame >= this->keyFrameInterval)
+        this->m_keyFrame = true; // Even if nothing changed - a row with a colliding hash would stay stale otherwise
+
+    const unsigned int lastFlush = OswUI::getInstance()->getLastFlush();
+    if(lastFlush == this->m_lastFrameFlush and !this->m_keyFrame)
+        return; // Nothing new on the screen
+    if(millis() - this->m_lastFrameSent < this->minFrameInterval)
+        return;
+    if(this->sendFrame()) {
+        this->m_lastFrameFlush = lastFlush;
+        this->m_lastFrameSent = millis();
+    }
+}
+
+void OswServiceTaskScreenStream::stop() {
+    this->disableServer();
+    OswServiceTask::stop();
+}
+
+void OswServiceTaskScreenStream::suspend() {
+    this->disableServer();
+}
+
+bool OswServiceTaskScreenStream::hasClient() {
+    return this->m_client and this->m_client.connected();
+}
+
+void OswServiceTaskScreenStream::enableServer() {
+    if(this->m_server)
+        return;
+    this->m_server = new WiFiServer(this->port);
+    this->m_server->begin();
+    this->m_server->setNoDelay(true);
+    OSW_LOG_D("Started screen stream under ", OswServiceAllTasks::wifi.getIP().toString(), ":", this->port);
+    OSW_LOG_W("The screen stream does NOT require any authentication, please make sure to use it in trusted environments only!");
+}
+
+void OswServiceTaskScreenStream::disableServer() {
+    if(!this->m_server)
+        return;
+    this->dropClient();
+    this->m_server->end();
+    delete this->m_server;
+    this->m_server = nullptr;
+    OSW_LOG_D("Stopped screen stream.");
+}
+
+void OswServiceTaskScreenStream::acceptClient() {
+    if(!this->m_server->hasClient())
+        return;
+    WiFiClient client = this->m_server->available();
+    if(this->hasClient()) {
+        client.stop(); // Only one viewer at a time, as every viewer would need its own frame history
+        return;
+    }
+    this->dropClient(); // Release the remains of a disconnected client
+
+    // Buffers are bound to the connection, so there is no heap usage while nobody is watching
+    Graphics2D* gfx = OswHal::getInstance()->gfx();
+    const uint16_t chunkHeight = 1 << gfx->getChunkHeightLd();
+    this->m_outBufferSize = chunkHeight * (6 + 2 * gfx->getWidth() + gfx->getWidth() / 64 + 2);
+    this->m_rowHashes.reset(new uint32_t[gfx->getHeight()]);
+    this->m_chunkSnapshot.reset(new uint16_t[gfx->getWidth() * chunkHeight]);
+    this->m_outBuffer.reset(new uint8_t[this->m_outBufferSize]);
+
+    this->m_client = client;
+    this->m_client.setNoDelay(true);
+    this->m_keyFrame = true;
+    this->m_frameId = 0;
+    OSW_LOG_I("Screen stream client connected from ", this->m_client.remoteIP().toString());
+}
+
+void OswServiceTaskScreenStream::dropClient() {
+    if(this->m_client) {
+        this->m_client.stop();
+        OSW_LOG_I("Screen stream client disconnected.");
+    }
+    this->m_client = WiFiClient();
+    this->m_rowHashes.reset();
+    this->m_chunkSnapshot.reset();
+    this->m_outBuffer.reset();
+    this->m_outBufferSize = 0;
+}
+
+/**
+ * Encodes one row as: y, x, width (all u16) followed by RLE tokens. A token byte with the high bit set is
+ * followed by one pixel repeated ((token & 0x7F) + 1) times, otherwise by (token + 1) literal pixels.
+ */
+size_t OswServiceTaskScreenStream::encodeRow(uint8_t* out, uint16_t y, uint16_t xOffset, const uint16_t* pixels, uint16_t width) {
+    uint8_t* pos = out;
+    pos = putU16(pos, y);
+    pos = putU16(pos, xOffset);
+    pos = putU16(pos, width);
+
+    uint16_t i = 0;
+    while(i < width) {
+        uint16_t run = 1;
+        while(i + run < width and run < 128 and pixels[i + run] == pixels[i])
+            ++run;
+        if(run >= 3) {
+            *pos++ = 0x80 | (run - 1);
+            pos = putU16(pos, pixels[i]);
+            i += run;
+            continue;
+        }
+
+        // Collect literals until the next run worth encoding starts
+        uint8_t* token = pos++;
+        uint16_t count = 0;
+        while(i < width and count < 128) {
+            if(i + 2 < width and pixels[i] == pixels[i + 1] and pixels[i] == pixels[i + 2])
+                break;
+            pos = putU16(pos, pixels[i]);
+            ++i;
+            ++count;
+        }
+        *token = count - 1;
+    }
+    return pos - out;
+}
+
+bool OswServiceTaskScreenStream::sendFrame() {
+    Graphics2D* gfx = OswHal::getInstance()->gfx();
+    if(!OswHal::getInstance()->displayBufferEnabled())
+        return false; // Nothing to snapshot - the panel is written directly
+
+    const uint8_t chunkHeightLd = gfx->getChunkHeightLd();
+    const uint16_t chunkHeight = 1 << chunkHeightLd;
+    const bool keyFrame = this->m_keyFrame;
+    this->m_keyFrame = false;
+    if(keyFrame)
+        this->m_lastKeyFrame = millis();
+
+    // Frame header: magic, frame id, width, height, flags
+    uint8_t header[4 + 4 + 2 + 2 + 1];
+    memcpy(header, "OSWF", 4);
+    uint8_t* pos = putU32(header + 4, this->m_frameId++);
+    pos = putU16(pos, gfx->getWidth());
+    pos = putU16(pos, gfx->getHeight());
+    *pos = keyFrame ? 1 : 0;
+    if(this->m_client.write(header, sizeof(header)) != sizeof(header)) {
+        this->dropClient();
+        return false;
+    }
+
+    for(uint16_t chunk = 0; chunk < gfx->getNumChunks(); chunk++) {
+        uint16_t chunkWidth;
+        uint16_t chunkOffset;
+        {
+            // Only hold the lock for the copy, the encoding and sending is done without blocking the UI
+            std::lock_guard<std::mutex> noRender(*OswUI::getInstance()->drawLock);
+            if(!gfx->hasBuffer()) {
+                this->m_keyFrame = true; // We sent a partial frame, so the next one must be complete
+                break;
+            }
+            chunkWidth = gfx->getChunkWidth(chunk);
+            chunkOffset = gfx->getChunkOffset(chunk);
+            memcpy(this->m_chunkSnapshot.get(), gfx->getShownChunk(chunk), (chunkWidth << chunkHeightLd) * sizeof(uint16_t));
+        }
+
+        size_t used = 0;
+        for(uint16_t row = 0; row < chunkHeight; row++) {
+            const uint16_t y = (chunk << chunkHeightLd) + row;
+            const uint16_t* pixels = this->m_chunkSnapshot.get() + row * chunkWidth;
+            const uint32_t hash = hashRow(pixels, chunkWidth);
+            if(!keyFrame and this->m_rowHashes[y] == hash)
+                continue;
+            this->m_rowHashes[y] = hash;
+            used += this->encodeRow(this->m_outBuffer.get() + used, y, chunkOffset, pixels, chunkWidth);
+        }
+        if(used and this->m_client.write(this->m_outBuffer.get(), used) != used) {
+            this->dropClient();
+            return false;
+        }
+    }
+
+    // End of frame marker
+    uint8_t footer[2];
+    putU16(footer, 0xFFFF);
+    if(this->m_client.write(footer, sizeof(footer)) != sizeof(footer)) {
+        this->dropClient();
+        return false;
+    }
+    return true;
+}
+#endif
+#endif
@@ -1,12 +1,15 @@
 #ifdef OSW_FEATURE_WIFI
+#include <algorithm>
+
 #include <WebServer.h>
-#include <Update.h> // OTA by file upload
 #include <HTTPClient.h> // OTA by uri
 #include <ArduinoJson.h>
+#include <OswMemoryTracker.h>
 
 #include "osw_hal.h"
 #include <osw_ui.h>
 #include <osw_config.h>
+#include <osw_config_keys.h>
 #include "services/OswServiceTasks.h"
 #include "services/OswServiceTaskWiFi.h"
 #include "services/OswServiceManager.h"
@@ -32,6 +35,24 @@ void OswServiceTaskWebserver::handleUnauthenticated(std::function<void(void)> ha
     handler();
 }
 
+/**
+ * The download of the active OTA - nothing available yet only ends it once the connection is gone
+ */
+class OswOtaDownload : public OswOta::Source {
+  public:
+    OswOtaDownload(HTTPClient* client) : client(client) {};
+    virtual int read(uint8_t* buffer, size_t length) override {
+        WiFiClient* stream = this->client->getStreamPtr();
+        const size_t available = stream->available();
+        if(available == 0)
+            return this->client->connected() ? 0 : -1;
+        return (int) stream->readBytes(buffer, std::min(available, length));
+    };
+
+  private:
+    HTTPClient* client;
+};
+
 void OswServiceTaskWebserver::handleActiveOTARequest() {
     // Check if config was received
     if (this->m_webserver->hasArg("plain")== false) {
@@ -55,112 +76,195 @@ void OswServiceTaskWebserver::handleActiveOTARequest() {
     }
     OSW_LOG_I("[OTA] URL: ", updateURL);
 
-    // Perform the update
-    HTTPClient http;
-    http.begin(updateURL);
-    http.useHTTP10(true); //To prevent any encodings
+    if(this->m_ota) {
+        this->m_webserver->send(409, "text/plain", "Another update is already running.");
+        return;
+    }
 
-    int code = http.GET();
-    int size = http.getSize();
+    // Only start the update here, the download itself continues in the loop()
+    HTTPClient* client = new HTTPClient();
+    client->begin(updateURL);
+    client->useHTTP10(true); //To prevent any encodings
 
-    if(code != 200 or size == 0) {
-        OSW_LOG_E("[OTA] Fetch failed: ", http.errorToString(code));
-        this->m_webserver->send(400, "text/plain", http.errorToString(code));
+    int code = client->GET();
+    int size = client->getSize();
+
+    if(code != 200 or size <= 0) {
+        OSW_LOG_E("[OTA] Fetch failed: ", HTTPClient::errorToString(code));
+        this->m_webserver->send(400, "text/plain", HTTPClient::errorToString(code));
+        client->end();
+        delete client;
         return;
     }
 
-    OswUI::getInstance()->startProgress("OTA Update");
-    OswUI::getInstance()->getProgressBar()->setColor(OswUI::getInstance()->getDangerColor());
-
-    if(!Update.begin(size)) {
-        OSW_LOG_E("[OTA] Begin failed: ", Update.errorString());
-        this->m_webserver->send(400, "text/plain", Update.errorString());
-        OswUI::getInstance()->stopProgress();
+    if(!this->beginOTA(size, updateMD5)) {
+        this->m_webserver->send(400, "text/plain", this->m_otaError);
+        client->end();
+        delete client;
         return;
     }
+    this->m_otaClient = client;
+    this->m_otaLastReceived = 0;
+    this->m_otaLastData = millis();
+    this->m_webserver->send(202, "text/plain", "Update started."); // Poll /api/ota/status for its end
+}
 
-    if(updateMD5.length()) {
-        Update.setMD5(updateMD5.c_str());
-        OSW_LOG_I("[OTA] MD5: ", updateMD5);
+void OswServiceTaskWebserver::handleOTAStatusJson() {
+    OswJsonDocument status(256);
+    if(this->m_ota) {
+        const OswOta::Progress progress = this->m_ota->getProgress();
+        status["state"] = "running";
+        status["total"] = progress.total;
+        status["received"] = progress.received;
+        status["written"] = progress.written;
+    } else if(this->m_restartRequest) {
+        status["state"] = "committed";
+    } else if(this->m_otaError.length()) {
+        status["state"] = "failed";
+        status["error"] = this->m_otaError;
+    } else {
+        status["state"] = "idle";
     }
 
-    if(Update.writeStream(*http.getStreamPtr()) != size) {
-        OSW_LOG_E("[OTA] Write failed: ", Update.errorString());
-        this->m_webserver->send(400, "text/plain", Update.errorString());
-        OswUI::getInstance()->stopProgress();
+    String returnme;
+    serializeJson(status, returnme);
+    this->m_webserver->send(200, "application/json", returnme);
+}
+
+/**
+ * Receives whatever the download got so far (for up to this->otaSliceTime) and finishes the update at its end
+ */
+void OswServiceTaskWebserver::continueActiveOTA() {
+    OswOtaDownload download(this->m_otaClient);
+    if(!this->m_ota->receive(download, this->otaSliceTime)) {
+        this->endOTA(this->m_ota->getError().c_str());
         return;
     }
-
-    if(!Update.end()) {
-        OSW_LOG_E("[OTA] Finish failed: ", Update.errorString());
-        this->m_webserver->send(400, "text/plain", Update.errorString());
-        OswUI::getInstance()->stopProgress();
+    const size_t received = this->m_ota->getProgress().received;
+    if(received != this->m_otaLastReceived) {
+        this->m_otaLastReceived = received;
+        this->m_otaLastData = millis();
+    } else if(millis() - this->m_otaLastData > this->otaStallTimeout) {
+        this->endOTA("Download stalled.");
         return;
     }
+    if(this->m_ota->isComplete())
+        this->endOTA(this->m_ota->finish() ? "" : this->m_ota->getError().c_str());
+}
+
+/**
+ * Starts streaming an update into the flash - checked against the manifest of the request (x-UpdateManifest), which
+ * has to be signed once a signing key is set
+ *
+ * @param size of the image, 0 if unknown
+ */
+bool OswServiceTaskWebserver::beginOTA(size_t size, const String& md5) {
+    this->m_otaError = "";
+    OswOta::Manifest manifest;
+    const String manifestText = this->m_webserver->header("x-UpdateManifest");
+    if(manifestText.length() and !manifest.parse(manifestText.c_str())) {
+        this->m_otaError = "Malformed manifest.";
+        OSW_LOG_E("[OTA] ", this->m_otaError);
+        return false;
+    }
 
-    OswUI::getInstance()->getProgressBar()->setProgress(1.0f);
-    OSW_LOG_I("[OTA] Finished!");
-    this->m_webserver->send(200, "text/plain", "OK");
-    this->m_restartRequest = true;
+    this->m_otaSink.setMD5(md5);
+    this->m_ota = new OswOta(this->m_otaSink);
+    // The manifest stays as signed, the size of the request only fills in for a missing one
+    if(!this->m_ota->begin(manifest, OswConfigAllKeys::otaSigningKey.get().c_str(), size)) {
+        this->m_otaError = this->m_ota->getError().c_str();
+        delete this->m_ota;
+        this->m_ota = nullptr;
+        return false;
+    }
+    OswHal::getInstance()->holdSleep(); // The sleep would abort it
+    OswUI::getInstance()->startProgress("OTA Update");
+    OswUI::getInstance()->getProgressBar()->setColor(OswUI::getInstance()->getDangerColor());
+    this->m_otaLastProgress = millis();
+    return true;
 }
 
-void OswServiceTaskWebserver::handlePassiveOTARequest() {
-    if(!Update.hasError()) {
+/**
+ * Only every this->otaProgressInterval, the bar can not show more anyways
+ */
+void OswServiceTaskWebserver::updateOTAProgress() {
+    if(millis() - this->m_otaLastProgress < this->otaProgressInterval)
+        return;
+    this->m_otaLastProgress = millis();
+    const OswOta::Progress progress = this->m_ota->getProgress();
+    if(progress.total > 0)
+        OswUI::getInstance()->getProgressBar()->setProgress((float) progress.written / progress.total);
+}
+
+/**
+ * @param error empty if the update was committed
+ */
+void OswServiceTaskWebserver::endOTA(const String& error) {
+    if(error.length()) {
+        this->m_otaError = error;
+        this->m_ota->abort(error.c_str());
+        OswUI::getInstance()->stopProgress();
+    } else {
         OswUI::getInstance()->getProgressBar()->setProgress(1.0f);
-        this->m_webserver->send(200, "text/plain", "OK");
         this->m_restartRequest = true;
+    }
+    delete this->m_ota; // Also ends its writer task
+    this->m_ota = nullptr;
+    OswHal::getInstance()->releaseSleep();
+    this->m_otaUploading = false;
+    if(this->m_otaClient) {
+        this->m_otaClient->end();
+        delete this->m_otaClient;
+        this->m_otaClient = nullptr;
+    }
+}
+
+void OswServiceTaskWebserver::handlePassiveOTARequest() {
+    if(this->m_restartRequest) {
+        this->m_webserver->send(200, "text/plain", "OK");
     } else {
-        this->m_webserver->send(400, "text/plain", Update.errorString());
+        this->m_webserver->send(400, "text/plain", this->m_otaError.length() ? this->m_otaError : String("No update received."));
     }
 }
 
 void OswServiceTaskWebserver::handleOTAFile() {
-    try {
-        HTTPUpload& upload = this->m_webserver->upload();
-        switch(upload.status) {
-        case UPLOAD_FILE_START:
-            OSW_LOG_I("[OTA] Name: ", upload.filename);
-            if (!Update.begin(UPDATE_SIZE_UNKNOWN))
-                throw false;
-            {
-                String updateMD5 = this->m_webserver->header("x-UpdateHash");
-                if(updateMD5.length()) {
-                    Update.setMD5(updateMD5.c_str());
-                    OSW_LOG_I("[OTA] MD5: ", updateMD5);
-                }
-            }
-            OswUI::getInstance()->startProgress("OTA Update");
-            OswUI::getInstance()->getProgressBar()->setColor(OswUI::getInstance()->getDangerColor());
-            break;
-        case UPLOAD_FILE_WRITE:
-            // This is maybe not the best indicator for a defective update, but it works well enough...
-            if(upload.currentSize == 0)
-                throw true;
-            OSW_LOG_D("[OTA] Next chunk: ", upload.currentSize);
-            if (Update.write(upload.buf, upload.currentSize) != upload.currentSize)
-                throw true;
-            break;
-        case UPLOAD_FILE_END:
-            if (Update.end(true))
-                OSW_LOG_I("[OTA] Finished after ", upload.totalSize, " bytes!");
-            else
-                throw false;
-            break;
-        default:
-            // Oh... What?!
+    HTTPUpload& upload = this->m_webserver->upload();
+    switch(upload.status) {
+    case UPLOAD_FILE_START:
+        OSW_LOG_I("[OTA] Name: ", upload.filename);
+        if(this->m_ota) {
+            this->m_otaError = "Another update is already running.";
             break;
         }
-    } catch (bool abortUpdate) {
-        if(abortUpdate)
-            Update.abort();
-        OSW_LOG_E("[OTA] Failed: ", Update.errorString());
-        OswUI::getInstance()->stopProgress();
-        return;
+        this->m_otaUploading = this->beginOTA(0, this->m_webserver->header("x-UpdateHash"));
+        break;
+    case UPLOAD_FILE_WRITE:
+        if(!this->m_otaUploading)
+            break; // Refused at its start
+        // This is maybe not the best indicator for a defective update, but it works well enough...
+        if(upload.currentSize == 0)
+            this->endOTA("Upload broken.");
+        else if(!this->m_ota->write(upload.buf, upload.currentSize))
+            this->endOTA(this->m_ota->getError().c_str());
+        else
+            this->updateOTAProgress();
+        break;
+    case UPLOAD_FILE_END:
+        if(this->m_otaUploading)
+            this->endOTA(this->m_ota->finish() ? "" : this->m_ota->getError().c_str());
+        break;
+    case UPLOAD_FILE_ABORTED:
+        if(this->m_otaUploading)
+            this->endOTA("Upload aborted.");
+        break;
+    default:
+        // Oh... What?!
+        break;
     }
 }
 
 void OswServiceTaskWebserver::handleInfoJson() {
-    DynamicJsonDocument config(1024);
+    OswJsonDocument config(6144); // Most of it for the memory history
     config["X"] = String(this->apiVersion);
     config["t"] = String(__DATE__) + ", " + __TIME__;
     config["v"] = String(__VERSION__);
@@ -169,6 +273,7 @@ void OswServiceTaskWebserver::handleInfoJson() {
     config["gb"] = String(GIT_BRANCH_NAME);
     config["bc"] = OswConfig::getInstance()->getBootCount();
     config["pe"] = String(PIO_ENV_NAME);
+    OswMemoryTracker::getInstance().toJson(config.createNestedObject("mem"));
 
     String returnme;
     serializeJson(config, returnme);
@@ -217,6 +322,7 @@ void OswServiceTaskWebserver::handleFieldSetter() {
 void OswServiceTaskWebserver::handleScreenServer() {
     // Note that we are using the screen buffer here, but is could be inactive right now -> activate and wait a while if it is
     bool disableBufferAgain = false;
+    bool stripBufferBefore = OswHal::getInstance()->displayStripBufferEnabled();
     if(!OswHal::getInstance()->displayBufferEnabled()) {
         disableBufferAgain = true;
         {
@@ -235,25 +341,28 @@ void OswServiceTaskWebserver::handleScreenServer() {
     this->m_webserver->client().write("\r\nConnection: close");
     this->m_webserver->client().write("\r\n\r\n");  // empty line for header<->body delimiter
 
-    // Fetch the screenshot itself
-    {
-        std::lock_guard<std::mutex> noRender(*OswUI::getInstance()->drawLock);
-        for (int y = 0; y < DISP_H; y++) {
+    // Fetch the screenshot itself - only lock the UI while copying a row, not while sending it
+    for (int y = 0; y < DISP_H; y++) {
+        {
+            std::lock_guard<std::mutex> noRender(*OswUI::getInstance()->drawLock);
             for (int x = 0; x < DISP_W; x++) {
-                uint16_t rgb = OswHal::getInstance()->gfx()->getPixel(x, y);
+                uint16_t rgb = OswHal::getInstance()->gfx()->getShownPixel(x, y); // Not the frame being drawn
                 buf[x * 3 + 0] = rgb565_red(rgb);
                 buf[x * 3 + 1] = rgb565_green(rgb);
                 buf[x * 3 + 2] = rgb565_blue(rgb);
             }
-            this->m_webserver->client().write(buf, 3 * DISP_W);
-            yield();
         }
+        this->m_webserver->client().write(buf, 3 * DISP_W);
+        yield();
     }
 
     // Disable the buffer if it was inactive before
     if(disableBufferAgain) {
         std::lock_guard<std::mutex> noRender(*OswUI::getInstance()->drawLock);
-        OswHal::getInstance()->disableDisplayBuffer();
+        if(stripBufferBefore)
+            OswHal::getInstance()->enableDisplayStripBuffer();
+        else
+            OswHal::getInstance()->disableDisplayBuffer();
     }
     OSW_LOG_D("Sent RAW screenshot!");
 }
@@ -290,18 +399,31 @@ void OswServiceTaskWebserver::loop() {
     else
         this->disableWebserver();
     if (this->m_webserver) this->m_webserver->handleClient();
-    if(this->m_restartRequest) {
+    if(this->m_otaClient)
+        this->continueActiveOTA();
+    if(this->m_ota)
+        this->updateOTAProgress();
+    if(this->m_restartRequest and !this->m_restartAt) {
         OSW_LOG_W("REBOOT REQUEST RECEIVED. REBOOT IN 2 SECONDS!");
-        sleep(2); // Just to make sure all web requests are finished...
-        ESP.restart();
+        this->m_restartAt = millis() + 2000; // Keep serving until then, just to make sure all web requests are finished...
     }
+    if(this->m_restartAt and (long) (millis() - this->m_restartAt) >= 0)
+        ESP.restart();
 }
 
 void OswServiceTaskWebserver::stop() {
+    if(this->m_ota)
+        this->endOTA("Service stopped.");
     this->disableWebserver(); //Make sure the webserver is also stopped
     OswServiceTask::stop();
 }
 
+void OswServiceTaskWebserver::suspend() {
+    if(this->m_ota)
+        this->endOTA("Going to sleep."); // Not reached while the update holds the sleep off (see beginOTA()), just in case
+    this->disableWebserver();
+}
+
 void OswServiceTaskWebserver::enableWebserver() {
     if(this->m_webserver)
         return;
@@ -344,6 +466,7 @@ void OswServiceTaskWebserver::enableWebserver() {
     OSW_LOG_D("Started RAW ScreenServer under http://", OswServiceAllTasks::wifi.getIP().toString(), "/api/screenserver");
     OSW_LOG_W("The RAW ScreenServer is enabled does NOT require any authentication, please make sure to use it in trusted environments only!");
 #endif
+    this->m_webserver->on("/api/ota/status", HTTP_GET, [this] { this->handleAuthenticated([this] { this->handleOTAStatusJson(); }); });
     this->m_webserver->on("/api/ota/active", HTTP_POST, [this] { this->handleAuthenticated([this] { this->handleActiveOTARequest(); }); });
     this->m_webserver->on("/api/ota/passive", HTTP_POST, [this] { this->handleAuthenticated([this] { this->handlePassiveOTARequest(); }); }, [this] { this->handleAuthenticated([this] { this->handleOTAFile(); }); });
     this->m_webserver->begin();
@@ -351,10 +474,10 @@ void OswServiceTaskWebserver::enableWebserver() {
     /**
      * We also have to make sure to collect the following headers on any request.
      * We are using headers, as post keys could be processed after the file upload,
-     * therefore we would receive the md5 AFTER the update is already complete.
+     * therefore we would receive the md5 (or manifest) AFTER the update is already complete.
      */
-    const char* headers[] = { "x-UpdateHash" };
-    this->m_webserver->collectHeaders(headers, 1);
+    const char* headers[] = { "x-UpdateHash", "x-UpdateManifest" };
+    this->m_webserver->collectHeaders(headers, 2);
 
     OSW_LOG_D("Active (password is ", this->m_uiPassword, ").");
 }
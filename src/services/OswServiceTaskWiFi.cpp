@@ -6,10 +6,16 @@
 #include "services/OswServiceManager.h"
 #include <ESPmDNS.h>
 
+RTC_DATA_ATTR static OswWiFiConnector::History wifiHistory; // Survives the deep sleep, so the watch reconnects fast
+
+OswServiceTaskWiFi::OswServiceTaskWiFi() : m_connector(m_radio, wifiHistory) {}
+
 void OswServiceTaskWiFi::setup() {
     OswServiceTask::setup();
+    this->m_radio.setup();
     this->disableStation(); // Never enable station mode after boot
     this->m_bootDone = false;
+    this->m_bootDelayed = false;
 }
 
 /**
@@ -19,7 +25,12 @@ void OswServiceTaskWiFi::loop() {
     if(!this->m_bootDone) {
 #ifdef OSW_FEATURE_WIFI_ONBOOT
         if(OswConfigAllKeys::wifiBootEnabled.get()) {
-            delay(2000); // Give the user some time to take a look at the battery level (as it is unavailable with enabled wifi)
+            if(!this->m_bootDelayed) {
+                // Give the user some time to take a look at the battery level (as it is unavailable with enabled wifi)
+                this->m_bootDelayed = true;
+                this->sleepFor(2000);
+                return;
+            }
             this->enableWiFi();
             this->connectWiFi();
         } else {
@@ -31,51 +42,8 @@ void OswServiceTaskWiFi::loop() {
         this->m_bootDone = true;
     }
 
-    if(this->m_enableClient) {
-        if(this->m_connectTimeout and WiFi.status() == WL_CONNECTED) {
-            // Nice - reset timeout
-            this->m_connectTimeout = 0;
-            this->m_connectFailureCount = 0;
-        } else if(!this->m_connectTimeout and WiFi.status() != WL_CONNECTED) {
-            // Wifi is either disconnected or unavailable...
-            // -> start timeout
-            this->m_connectTimeout = time(nullptr);
-            OSW_LOG_D("[Connection] Timeout activated: 10 seconds");
-        }
-
-        // Handling in case of 10 seconds without a successful connect
-        if(this->m_connectTimeout and this->m_connectTimeout < time(nullptr) - 10) {
-            ++this->m_connectFailureCount;
-            OSW_LOG_D("[Connection] Timeout expired. Looking for alternatives (", this->m_connectFailureCount, ")...");
-            this->m_connectTimeout = 0; // Disable connection timeout, we will re-enable it with the next iteration, if we still want to connect (and are not in AutoAP mode)
-
-            // We have four options if our connection times out; the fourth is the auto-ap, which is may not available
-            if(this->m_connectFailureCount % 4 == 3) {
-                if(OswConfigAllKeys::wifiAutoAP.get()) {
-                    if(!this->m_enableStation) {
-                        if (OswConfigAllKeys::hostPasswordEnabled.get()) {
-                            this->enableStation(OswConfigAllKeys::hostPass.get().c_str());
-                        } else {
-                            this->enableStation();
-                        }
-                        this->m_enabledStationByAutoAP = time(nullptr);
-                        OSW_LOG_D("[AutoAP] Active for ", this->m_enabledStationByAutoAPTimeout, " seconds (password is ", this->m_stationPass.isEmpty() ? "-" : this->m_stationPass, ").");
-                    }
-                } else {
-                    OSW_LOG_D("[AutoAP] Is disabled; no action taken.");
-                }
-            } else
-                this->connectWiFi();
-        }
-
-        if(this->m_queuedNTPUpdate and WiFi.status() == WL_CONNECTED) {
-            OswHal::getInstance()->devices()->esp32->triggerNTPUpdate();
-            this->m_queuedNTPUpdate = false;
-        }
-
-        if (OswHal::getInstance()->devices()->esp32->checkNTPUpdate())
-            OswHal::getInstance()->setUTCTime(OswHal::getInstance()->devices()->esp32->getUTCTime()); // And apply the ESP32's time to the watches primary time provider (whatever this may be)
-    }
+    if(this->m_enableWiFi and this->m_enableClient)
+        this->loopClient(); // Also next to the station, so the client keeps retrying (and ends the auto-ap once connected)
 
     // Disable the auto-ap in case we connected successfully, disabled client or after this->m_enabledStationByAutoAPTimeout seconds
     const bool autoAPTimedOut = (time(nullptr) - this->m_enabledStationByAutoAP) >= this->m_enabledStationByAutoAPTimeout;
@@ -83,7 +51,7 @@ void OswServiceTaskWiFi::loop() {
         String dbgInactRsn;
         if(WiFi.status() == WL_CONNECTED)
             dbgInactRsn = "WiFi connected.";
-        else if(WiFi.status() == WL_CONNECTED)
+        else if(!this->m_enableClient)
             dbgInactRsn = "WiFi disabled.";
         else if(autoAPTimedOut)
             dbgInactRsn = "Expired.";
@@ -111,22 +79,48 @@ void OswServiceTaskWiFi::loop() {
         this->m_enabledMDNS = false;
         OSW_LOG_D("[mDNS] Inactive.");
     }
+
+    // The connector needs a close look while it is connecting, afterwards it is enough to check now and then
+    const OswWiFiConnector::State state = this->m_connector.getState();
+    this->sleepFor(state == OswWiFiConnector::State::IDLE or state == OswWiFiConnector::State::CONNECTED or state == OswWiFiConnector::State::FAILED ? 250 : 50);
 }
 
-void OswServiceTaskWiFi::selectCredentials() {
-    if(this->m_connectFailureCount % 4 == 0 and !OswConfigAllKeys::wifiSsid.get().isEmpty()) {
-        this->m_clientSSID = OswConfigAllKeys::wifiSsid.get();
-        this->m_clientPass = OswConfigAllKeys::wifiPass.get();
-    } else if(this->m_connectFailureCount % 4 == 1 and !OswConfigAllKeys::fallbackWifiSsid1st.get().isEmpty()) {
-        this->m_clientSSID = OswConfigAllKeys::fallbackWifiSsid1st.get();
-        this->m_clientPass = OswConfigAllKeys::fallbackWifiPass1st.get();
-    } else if(this->m_connectFailureCount % 4 == 2 and !OswConfigAllKeys::fallbackWifiSsid2nd.get().isEmpty()) {
-        this->m_clientSSID = OswConfigAllKeys::fallbackWifiSsid2nd.get();
-        this->m_clientPass = OswConfigAllKeys::fallbackWifiPass2nd.get();
-    } else if(this->m_connectFailureCount % 4 == 3) {
-        // Huh? AutoAP should be active now. If not, we can reuse the previous credentials.
+void OswServiceTaskWiFi::loopClient() {
+    const OswWiFiConnector::State before = this->m_connector.getState();
+    this->m_connector.loop(millis());
+    const OswWiFiConnector::State state = this->m_connector.getState();
+    const OswWiFiConnector::Profile& profile = this->m_connector.getProfile();
+
+    if(state == OswWiFiConnector::State::CONNECTED and before != OswWiFiConnector::State::CONNECTED) {
+        this->m_connectFailureCount = 0;
+        OSW_LOG_I("[Client] Connected to \"", this->m_connector.getNetwork()->ssid, "\" after ", profile.total, " ms (", profile.fast ? "remembered access point, " : "",
+                  "scan ", profile.scan, " ms, auth ", profile.auth, " ms, DHCP ", profile.dhcp, " ms, ", profile.attempts, " attempt(s)).");
+    } else if(state == OswWiFiConnector::State::FAILED and before != OswWiFiConnector::State::FAILED) {
+        ++this->m_connectFailureCount;
+        OSW_LOG_D("[Connection] No network reachable after ", profile.total, " ms (", this->m_connectFailureCount, "); retrying in ", this->m_retryDelay, " ms.");
+        this->m_retryAt = millis() + this->m_retryDelay;
+        if(OswConfigAllKeys::wifiAutoAP.get() and !this->m_enableStation) {
+            if (OswConfigAllKeys::hostPasswordEnabled.get()) {
+                this->enableStation(OswConfigAllKeys::hostPass.get().c_str());
+            } else {
+                this->enableStation();
+            }
+            this->m_enabledStationByAutoAP = time(nullptr);
+            OSW_LOG_D("[AutoAP] Active for ", this->m_enabledStationByAutoAPTimeout, " seconds (password is ", this->m_stationPass.isEmpty() ? "-" : this->m_stationPass, ").");
+        }
+    } else if(state == OswWiFiConnector::State::FAILED and this->m_retryAt and (long) (millis() - this->m_retryAt) >= 0)
+        this->connectWiFi();
+
+    if(this->m_queuedNTPUpdate and state == OswWiFiConnector::State::CONNECTED) {
+        OswHal::getInstance()->devices()->esp32->triggerNTPUpdate();
+        this->m_queuedNTPUpdate = false;
+    }
+
+    if (OswHal::getInstance()->devices()->esp32->checkNTPUpdate()) {
+        OswHal::getInstance()->setUTCTime(OswHal::getInstance()->devices()->esp32->getUTCTime()); // And apply the ESP32's time to the watches primary time provider (whatever this may be)
+        this->m_connector.noteTimeSynchronized(millis());
+        OSW_LOG_D("[Client] Time synchronized ", profile.ntp, " ms after the connection.");
     }
-    // Note, in case an SSID is empty we will just retry the previous one...
 }
 
 void OswServiceTaskWiFi::stop() {
@@ -134,6 +128,21 @@ void OswServiceTaskWiFi::stop() {
     OswServiceTask::stop();
 }
 
+void OswServiceTaskWiFi::suspend() {
+    // The station is not restored, as nobody could connect to it during the sleep anyways
+    this->m_resumeWiFi = this->m_enableWiFi;
+    this->m_resumeClient = this->m_enableClient;
+    this->disableWiFi();
+}
+
+void OswServiceTaskWiFi::resume() {
+    if(!this->m_resumeWiFi)
+        return;
+    this->enableWiFi();
+    if(this->m_resumeClient)
+        this->connectWiFi();
+}
+
 /**
  * Enables wifi with the configured properties (caches the SSID/Pwd NOW)
  */
@@ -148,6 +157,8 @@ void OswServiceTaskWiFi::enableWiFi() {
  */
 void OswServiceTaskWiFi::disableWiFi() {
     this->m_enableWiFi = false;
+    this->m_connector.disconnect();
+    this->m_retryAt = 0;
     this->updateWiFiConfig();
 }
 
@@ -193,23 +204,26 @@ bool OswServiceTaskWiFi::isWiFiEnabled() {
  */
 void OswServiceTaskWiFi::connectWiFi() {
     this->m_hostname = OswConfigAllKeys::hostname.get();
-    this->m_connectTimeout = 0; //First reset to avoid racing conditions
+    this->m_retryAt = 0;
     this->m_enableClient = true;
     this->updateWiFiConfig();
-    this->selectCredentials();
-    if (this->m_clientPass.isEmpty()) {  // If public Wi-Fi without a password
-        WiFi.begin(this->m_clientSSID.c_str());
-    } else {
-        WiFi.begin(this->m_clientSSID.c_str(), this->m_clientPass.c_str());
-    }
+    // Read the credentials only here, the connector keeps them for all of its attempts
+    this->m_connector.setNetworks({
+        {OswConfigAllKeys::wifiSsid.get(), OswConfigAllKeys::wifiPass.get()},
+        {OswConfigAllKeys::fallbackWifiSsid1st.get(), OswConfigAllKeys::fallbackWifiPass1st.get()},
+        {OswConfigAllKeys::fallbackWifiSsid2nd.get(), OswConfigAllKeys::fallbackWifiPass2nd.get()}
+    });
+    this->m_connector.connect(millis());
     if(!this->m_queuedNTPUpdate)
         this->m_queuedNTPUpdate = OswConfigAllKeys::wifiAlwaysNTPEnabled.get();
-    OSW_LOG_D("[Client] Connecting to SSID \"", this->m_clientSSID, "\"...");
+    OSW_LOG_D("[Client] Connecting...");
+    this->wakeUp();
 }
 
 void OswServiceTaskWiFi::disconnectWiFi() {
     this->m_enableClient = false;
-    WiFi.disconnect(false);
+    this->m_retryAt = 0;
+    this->m_connector.disconnect();
     this->updateWiFiConfig();
     OSW_LOG_D("[Client] Disconnected.");
 }
@@ -287,21 +301,22 @@ void OswServiceTaskWiFi::updateWiFiConfig() {
 #if OSW_DEVICE_ESP32_WIFI_LOWPWR == 1
     if(this->m_enableWiFi and !this->m_lowPowerMode) {
         OSW_LOG_D("[Mode] This platform has the low power wifi mode enabled, probably due to hardware limitations. This will seriously impact your cpu performance and connection quality, but should prevent your device from crashing.");
-        this->m_lowPwrPrevFreq = OswHal::getInstance()->getCPUClock();
         this->m_lowPwrPrevWifiPwr = WiFi.getTxPower();
         WiFi.setTxPower(WIFI_POWER_MINUS_1dBm); // https://github.com/Open-Smartwatch/open-smartwatch-os/issues/264#issue-1301361379
-        OswHal::getInstance()->setCPUClock(80); // https://github.com/Open-Smartwatch/open-smartwatch-os/issues/264#issuecomment-1181386357
+        OswHal::getInstance()->setCPUClock(80); // https://github.com/Open-Smartwatch/open-smartwatch-os/issues/264#issuecomment-1181386357 - the governor keeps it there while the wifi is enabled
         this->m_lowPowerMode = true;
     } else if(!this->m_enableWiFi and this->m_lowPowerMode) {
         OSW_LOG_D("[Mode] Reverting low power wifi mode...");
-        WiFi.setTxPower(this->m_lowPwrPrevWifiPwr);
-        OswHal::getInstance()->setCPUClock(this->m_lowPwrPrevFreq);
+        WiFi.setTxPower(this->m_lowPwrPrevWifiPwr); // The governor raises the CPU clock again
         this->m_lowPowerMode = false;
     }
 #endif
 
-    // How about "WiFi.mode(WIFI_MODE_APSTA)"? Well, so far every ESP was unable to work with this properly. So we removed it.
-    if(this->m_enableWiFi and this->m_enableStation) {
+    // Both only while the client retries next to the station - the station follows the channel of the client then
+    if(this->m_enableWiFi and this->m_enableStation and this->m_enableClient) {
+        WiFi.mode(WIFI_MODE_APSTA);
+        OSW_LOG_D("[Mode] Station and client");
+    } else if(this->m_enableWiFi and this->m_enableStation) {
         WiFi.mode(WIFI_MODE_AP);
         OSW_LOG_D("[Mode] Station");
     } else if(this->m_enableWiFi and this->m_enableClient) {
@@ -313,6 +328,10 @@ void OswServiceTaskWiFi::updateWiFiConfig() {
     }
 }
 
+const OswWiFiConnector::Profile& OswServiceTaskWiFi::getConnectionProfile() const {
+    return this->m_connector.getProfile();
+}
+
 int32_t OswServiceTaskWiFi::getSignalStrength() {
     //Shamelessly copied from the MiniWiFi library
     return WiFi.RSSI();
@@ -330,4 +349,95 @@ uint8_t OswServiceTaskWiFi::getSignalQuality() {
     }
     return quality;
 }
+
+void OswServiceTaskWiFi::Radio::setup() {
+    if(this->m_eventsRegistered)
+        return;
+    this->m_eventsRegistered = true;
+    WiFi.setAutoReconnect(false); // The connector decides where to reconnect to
+    WiFi.onEvent([this](arduino_event_id_t event, arduino_event_info_t info) -> void {
+        switch(event) {
+        case ARDUINO_EVENT_WIFI_STA_CONNECTED:
+            this->m_associated = true;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            this->m_gotIP = true;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+            this->m_gotIP = false;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            this->m_associated = false;
+            this->m_gotIP = false;
+            switch(info.wifi_sta_disconnected.reason) {
+            case WIFI_REASON_NO_AP_FOUND:
+                this->m_failure = Status::NOT_FOUND;
+                break;
+            case WIFI_REASON_AUTH_FAIL:
+            case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
+            case WIFI_REASON_HANDSHAKE_TIMEOUT:
+                this->m_failure = Status::FAILED;
+                break;
+            default:
+                break; // Keeps trying until the connector's timeout
+            }
+            break;
+        default:
+            break;
+        }
+    });
+}
+
+void OswServiceTaskWiFi::Radio::begin(const OswWiFiConnector::Network& network, uint8_t channel, const uint8_t* bssid) {
+    this->m_associated = false;
+    this->m_gotIP = false;
+    this->m_failure = Status::IDLE;
+    this->m_connecting = true;
+    WiFi.begin(network.ssid.c_str(), network.password.isEmpty() ? nullptr : network.password.c_str(), channel, bssid);
+}
+
+void OswServiceTaskWiFi::Radio::disconnect() {
+    this->m_connecting = false;
+    WiFi.disconnect(false);
+}
+
+OswWiFiConnector::Radio::Status OswServiceTaskWiFi::Radio::getStatus() {
+    if(!this->m_connecting)
+        return Status::IDLE;
+    if(this->m_gotIP and WiFi.status() == WL_CONNECTED)
+        return Status::CONNECTED;
+    if(this->m_failure != Status::IDLE)
+        return this->m_failure;
+    return this->m_associated ? Status::ASSOCIATED : Status::CONNECTING;
+}
+
+bool OswServiceTaskWiFi::Radio::getAccessPoint(std::array<uint8_t, 6>& bssid, uint8_t& channel) {
+    const uint8_t* current = WiFi.BSSID();
+    if(WiFi.status() != WL_CONNECTED or current == nullptr)
+        return false;
+    std::copy(current, current + bssid.size(), bssid.begin());
+    channel = WiFi.channel();
+    return true;
+}
+
+void OswServiceTaskWiFi::Radio::startScan() {
+    WiFi.scanDelete();
+    WiFi.scanNetworks(true /* async */);
+}
+
+bool OswServiceTaskWiFi::Radio::getScanResults(std::vector<OswWiFiConnector::ScanResult>& results) {
+    const int16_t count = WiFi.scanComplete();
+    if(count == WIFI_SCAN_RUNNING)
+        return false;
+    for(int16_t i = 0; i < count; i++) {
+        OswWiFiConnector::ScanResult result;
+        result.ssid = WiFi.SSID(i);
+        std::copy(WiFi.BSSID(i), WiFi.BSSID(i) + result.bssid.size(), result.bssid.begin());
+        result.channel = WiFi.channel(i);
+        result.rssi = WiFi.RSSI(i);
+        results.push_back(result);
+    }
+    WiFi.scanDelete();
+    return true; // Also if it failed, then without any results
+}
 #endif
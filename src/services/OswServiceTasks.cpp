@@ -2,6 +2,8 @@
 
 #include "services/OswServiceTaskBLECompanion.h"
 #include "services/OswServiceTaskBLEServer.h"
+#include "services/OswServiceTaskCommunication.h"
+#include "services/OswServiceTaskCpuGovernor.h"
 #include "services/OswServiceTaskExample.h"
 #include "services/OswServiceTaskGPS.h"
 #include "services/OswServiceTaskMemMonitor.h"
@@ -10,6 +12,9 @@
 #ifdef OSW_FEATURE_WIFI
 #include "services/OswServiceTaskWiFi.h"
 #include "services/OswServiceTaskWebserver.h"
+#ifdef RAW_SCREEN_SERVER
+#include "services/OswServiceTaskScreenStream.h"
+#endif
 #endif
 #include "osw_util.h"
 
@@ -28,13 +33,20 @@ OswServiceTaskGPS gps;
 #ifdef OSW_FEATURE_WIFI
 OswServiceTaskWiFi wifi;
 OswServiceTaskWebserver webserver;
+#ifdef RAW_SCREEN_SERVER
+OswServiceTaskScreenStream screenStream;
+#endif
 #endif
 #ifdef OSW_FEATURE_BLE_SERVER
 OswServiceTaskBLEServer bleServer;
 #endif
+#ifdef OSW_SERVICE_COMMUNICATION
+OswServiceTaskCommunication communication;
+#endif
 #if OSW_SERVICE_NOTIFIER == 1
 OswServiceTaskNotifier notifier;
 #endif
+OswServiceTaskCpuGovernor cpuGovernor;
 #ifndef OSW_EMULATOR
 OswServiceTaskMemMonitor memory;
 #endif
@@ -56,16 +68,23 @@ OswServiceTask* oswServiceTasks[] = {
 #endif
 #ifdef OSW_FEATURE_WIFI
             & OswServiceAllTasks::wifi, &OswServiceAllTasks::webserver,
+#ifdef RAW_SCREEN_SERVER
+    & OswServiceAllTasks::screenStream,
+#endif
 #endif
 #ifdef OSW_FEATURE_BLE_SERVER
     & OswServiceAllTasks::bleServer,
 #endif
+#ifdef OSW_SERVICE_COMMUNICATION
+    & OswServiceAllTasks::communication,
+#endif
 #if OSW_SERVICE_NOTIFIER == 1
     & OswServiceAllTasks::notifier,
 #endif
 #ifdef OSW_SERVICE_CONSOLE
     & OswServiceAllTasks::console,
 #endif
+    & OswServiceAllTasks::cpuGovernor,
 #ifndef OSW_EMULATOR
 #ifndef NDEBUG
     & OswServiceAllTasks::memory
@@ -44,19 +44,126 @@
 %ignore println(unsigned int,int);
 %ignore println(long long,int);
 
+%ignore halToLua;
+
 %{
 #include <osw_hal.h>
+#include <osw_lua.h>
 
 void halToLua(lua_State *L) {
     //Pass HAL to Lua
     SWIG_NewPointerObj(L, OswHal::getInstance(), SWIGTYPE_p_OswHal, 0);
     lua_setglobal(L, "hal");
 }
+
+//Command buffer helpers, non-integral numbers (e.g. "120 - w / 2") are truncated like a C cast would do
+static lua_Integer drawCommandNumber(lua_State *L, lua_Integer index) {
+    lua_rawgeti(L, 1, index);
+    lua_Integer value = (lua_Integer) lua_tonumber(L, -1);
+    lua_pop(L, 1);
+    return value;
+}
+
+/**
+ * osw.submitDrawCommands(commands [, count])
+ *
+ * Replays a whole command buffer (see OswLuaDrawCommand) onto the canvas, so a frame only crosses the
+ * Lua/C boundary once instead of once per primitive. The optional count allows reusing the same table
+ * every frame without clearing it.
+ */
+static int submitDrawCommands(lua_State *L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    const lua_Integer count = luaL_optinteger(L, 2, (lua_Integer) lua_rawlen(L, 1));
+    Graphics2DPrint* gfx = OswHal::getInstance()->gfx();
+
+    lua_Integer i = 1;
+    auto next = [&]() {
+        return drawCommandNumber(L, i++);
+    };
+    while(i <= count) {
+        const lua_Integer command = next();
+        switch(command) {
+        case DRAWCMD_FILL: {
+            gfx->fill(next());
+            break;
+        }
+        case DRAWCMD_PIXEL: {
+            const lua_Integer x = next(), y = next();
+            gfx->drawPixel(x, y, next());
+            break;
+        }
+        case DRAWCMD_LINE: {
+            const lua_Integer x1 = next(), y1 = next(), x2 = next(), y2 = next();
+            gfx->drawLine(x1, y1, x2, y2, next());
+            break;
+        }
+        case DRAWCMD_HLINE: {
+            const lua_Integer x = next(), y = next(), w = next();
+            gfx->drawHLine(x, y, w, next());
+            break;
+        }
+        case DRAWCMD_VLINE: {
+            const lua_Integer x = next(), y = next(), h = next();
+            gfx->drawVLine(x, y, h, next());
+            break;
+        }
+        case DRAWCMD_FRAME: {
+            const lua_Integer x = next(), y = next(), w = next(), h = next();
+            gfx->drawFrame(x, y, w, h, next());
+            break;
+        }
+        case DRAWCMD_FILL_FRAME: {
+            const lua_Integer x = next(), y = next(), w = next(), h = next();
+            gfx->fillFrame(x, y, w, h, next());
+            break;
+        }
+        case DRAWCMD_CIRCLE: {
+            const lua_Integer x = next(), y = next(), r = next();
+            gfx->drawCircle(x, y, r, next());
+            break;
+        }
+        case DRAWCMD_FILL_CIRCLE: {
+            const lua_Integer x = next(), y = next(), r = next();
+            gfx->fillCircle(x, y, r, next());
+            break;
+        }
+        case DRAWCMD_TEXT_COLOR: {
+            const lua_Integer color = next();
+            gfx->setTextColor(color, next());
+            break;
+        }
+        case DRAWCMD_TEXT_SIZE: {
+            gfx->setTextSize(next());
+            break;
+        }
+        case DRAWCMD_TEXT_CURSOR: {
+            const lua_Integer x = next();
+            gfx->setTextCursor(x, next());
+            break;
+        }
+        case DRAWCMD_PRINT: {
+            lua_rawgeti(L, 1, i++);
+            size_t length = 0;
+            const char* text = lua_tolstring(L, -1, &length);
+            if(text)
+                gfx->write((const uint8_t*) text, length);
+            lua_pop(L, 1);
+            break;
+        }
+        default:
+            return luaL_error(L, "unknown draw command %d at index %d", (int) command, (int) (i - 1));
+        }
+    }
+    return 0;
+}
 %}
 
+%native(submitDrawCommands) int submitDrawCommands(lua_State *L);
+
 #define __attribute__(x)
 
 %include <std_string.i>
 %include "stdint.i"
 %include "Print.h"
 %include "osw_hal.h"
+%include "osw_lua.h"